@@ -0,0 +1,862 @@
+/*
+ *  NASA Docket No. GSC-18,370-1, and identified as "Operating System Abstraction Layer"
+ *
+ *  Copyright (c) 2019 United States Government as represented by
+ *  the Administrator of the National Aeronautics and Space Administration.
+ *  All Rights Reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/*
+ * Filename: benchmark-test.c
+ *
+ * Latency and throughput benchmarks of the FreeRTOS port.
+ *
+ * Every result is printed as one INFO line that starts with "BENCH,", so the
+ * numbers can be collected from the output of any run:
+ *
+ *   BENCH,<name>,<unit>,<samples>,<min>,<p50>,<p90>,<p99>,<max>   (latencies)
+ *   BENCH,<name>,<unit>,<value>                                   (rates)
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osapi-os-freertos.h"
+#include "utassert.h"
+#include "uttest.h"
+#include "utbsp.h"
+
+#define BENCH_SAMPLES           1000
+#define BENCH_TIMER_SAMPLES     200
+#define BENCH_TIMER_INTERVAL    10000       /* usec */
+#define BENCH_FILE_BYTES        (1024 * 1024)
+#define BENCH_FILE_CHUNK        4096
+#define BENCH_NET_BYTES         (1024 * 1024)
+#define BENCH_NET_CHUNK         1024
+#define BENCH_QUEUE_MAX_SIZE    512
+
+#define BENCH_PRIORITY          50          /* helper tasks */
+#define TASK_STACK_SIZE         16384
+
+uint32 helper_stack[TASK_STACK_SIZE];
+uint32 spawn_stack[TASK_STACK_SIZE];
+
+/* Latency samples of the benchmark running, in nsec */
+static uint64 samples[BENCH_SAMPLES];
+
+static uint32 partner_task_id;
+static uint32 request_queue_id;
+static uint32 response_queue_id;
+static uint32 mutex_id;
+static uint32 go_sem_id;
+static uint32 done_sem_id;
+
+static volatile uint64 handoff_nsec;
+static volatile uint32 timer_count;
+static uint64 timer_stamps[BENCH_TIMER_SAMPLES + 1];
+
+static uint32 net_socket_id;
+static volatile uint32 net_bytes;
+
+/*****************************************************************************
+ *
+ * Result reporting
+ *
+ *****************************************************************************/
+
+static int BenchCompare(const void *a, const void *b)
+{
+    uint64 x = *(const uint64 *)a;
+    uint64 y = *(const uint64 *)b;
+
+    return (x > y) - (x < y);
+}
+
+/* Sorts the samples and prints their percentiles in usec */
+static void BenchReportLatency(const char *name, uint64 *values, uint32 count)
+{
+    if (count == 0)
+    {
+        UtAssert_MIR("%s: no samples", name);
+        return;
+    }
+
+    qsort(values, count, sizeof(values[0]), BenchCompare);
+
+    UtPrintf("BENCH,%s,usec,%lu,%.3f,%.3f,%.3f,%.3f,%.3f", name, (unsigned long)count,
+             values[0] / 1000.0,
+             values[count / 2] / 1000.0,
+             values[(count * 90) / 100] / 1000.0,
+             values[(count * 99) / 100] / 1000.0,
+             values[count - 1] / 1000.0);
+}
+
+static void BenchReportRate(const char *name, const char *unit, double value)
+{
+    UtPrintf("BENCH,%s,%s,%.3f", name, unit, value);
+}
+
+/* Megabytes per second for a transfer of "bytes" that took "nsec" */
+static double BenchMBps(uint32 bytes, uint64 nsec)
+{
+    if (nsec == 0)
+    {
+        return 0.0;
+    }
+
+    return (bytes / (1024.0 * 1024.0)) / (nsec / 1e9);
+}
+
+/*****************************************************************************
+ *
+ * Queue round trip
+ *
+ *****************************************************************************/
+
+void QueueEcho_Fn(void)
+{
+    char   buffer[BENCH_QUEUE_MAX_SIZE];
+    uint32 size;
+
+    while (OS_QueueGet(request_queue_id, buffer, sizeof(buffer), &size, OS_PEND) == OS_SUCCESS)
+    {
+        OS_QueuePut(response_queue_id, buffer, size, 0);
+    }
+
+} /* end QueueEcho_Fn */
+
+void BenchQueueRoundTrip_Setup(void)
+{
+    int32 status;
+
+    status = OS_QueueCreate(&request_queue_id, "BenchReq", 4, BENCH_QUEUE_MAX_SIZE, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_QueueCreate() (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_QueueCreate(&response_queue_id, "BenchRsp", 4, BENCH_QUEUE_MAX_SIZE, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_QueueCreate() (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_TaskCreate(&partner_task_id, "BenchEcho", QueueEcho_Fn, helper_stack, sizeof(helper_stack), BENCH_PRIORITY, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_TaskCreate() (%ld) == OS_SUCCESS", (long)status);
+
+} /* end BenchQueueRoundTrip_Setup */
+
+void BenchQueueRoundTrip(void)
+{
+    static const uint32 sizes[] = { 4, 64, BENCH_QUEUE_MAX_SIZE };
+    char   message[BENCH_QUEUE_MAX_SIZE];
+    char   reply[BENCH_QUEUE_MAX_SIZE];
+    char   name[32];
+    uint32 size;
+    uint32 s;
+    uint32 i;
+    uint32 count;
+    uint64 start;
+
+    memset(message, 0xA5, sizeof(message));
+
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s)
+    {
+        count = 0;
+        for (i = 0; i < BENCH_SAMPLES; ++i)
+        {
+            start = OS_GetMonotonicNsec();
+            if (OS_QueuePut(request_queue_id, message, sizes[s], 0) != OS_SUCCESS ||
+                OS_QueueGet(response_queue_id, reply, sizeof(reply), &size, 1000) != OS_SUCCESS)
+            {
+                break;
+            }
+            samples[count++] = OS_GetMonotonicNsec() - start;
+        }
+
+        UtAssert_True(count == BENCH_SAMPLES, "queue round trip %lu bytes: %lu of %lu",
+                      (unsigned long)sizes[s], (unsigned long)count, (unsigned long)BENCH_SAMPLES);
+
+        snprintf(name, sizeof(name), "queue_rtt_%lu", (unsigned long)sizes[s]);
+        BenchReportLatency(name, samples, count);
+    }
+
+} /* end BenchQueueRoundTrip */
+
+void BenchQueueRoundTrip_Teardown(void)
+{
+    OS_TaskDelete(partner_task_id);
+
+    OS_QueueDelete(request_queue_id);
+    OS_QueueDelete(response_queue_id);
+
+} /* end BenchQueueRoundTrip_Teardown */
+
+/*****************************************************************************
+ *
+ * Mutex ping-pong
+ *
+ *****************************************************************************/
+
+void MutexPartner_Fn(void)
+{
+    while (OS_BinSemTake(go_sem_id) == OS_SUCCESS)
+    {
+        /* Blocks until the test task hands the mutex over */
+        if (OS_MutSemTake(mutex_id) != OS_SUCCESS)
+        {
+            break;
+        }
+        handoff_nsec = OS_GetMonotonicNsec();
+        OS_MutSemGive(mutex_id);
+
+        OS_BinSemGive(done_sem_id);
+    }
+
+} /* end MutexPartner_Fn */
+
+void BenchMutexPingPong_Setup(void)
+{
+    int32 status;
+
+    status = OS_MutSemCreate(&mutex_id, "BenchMutex", 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_MutSemCreate() (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_BinSemCreate(&go_sem_id, "BenchGo", 0, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_BinSemCreate() (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_BinSemCreate(&done_sem_id, "BenchDone", 0, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_BinSemCreate() (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_TaskCreate(&partner_task_id, "BenchPartner", MutexPartner_Fn, helper_stack, sizeof(helper_stack), BENCH_PRIORITY, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_TaskCreate() (%ld) == OS_SUCCESS", (long)status);
+
+} /* end BenchMutexPingPong_Setup */
+
+void BenchMutexPingPong(void)
+{
+    uint32 i;
+    uint32 count = 0;
+    uint64 start;
+
+    for (i = 0; i < BENCH_SAMPLES; ++i)
+    {
+        OS_MutSemTake(mutex_id);
+
+        /* Let the partner block on the mutex, whatever its priority */
+        OS_BinSemGive(go_sem_id);
+        OS_TaskDelay(1);
+
+        start = OS_GetMonotonicNsec();
+        OS_MutSemGive(mutex_id);
+
+        if (OS_BinSemTimedWait(done_sem_id, 1000) != OS_SUCCESS)
+        {
+            break;
+        }
+        samples[count++] = handoff_nsec - start;
+    }
+
+    UtAssert_True(count == BENCH_SAMPLES, "mutex handoffs: %lu of %lu", (unsigned long)count, (unsigned long)BENCH_SAMPLES);
+    BenchReportLatency("mutex_handoff", samples, count);
+
+} /* end BenchMutexPingPong */
+
+void BenchMutexPingPong_Teardown(void)
+{
+    OS_TaskDelete(partner_task_id);
+
+    OS_MutSemDelete(mutex_id);
+    OS_BinSemDelete(go_sem_id);
+    OS_BinSemDelete(done_sem_id);
+
+} /* end BenchMutexPingPong_Teardown */
+
+/*****************************************************************************
+ *
+ * Counting semaphore, kernel and OS_SEM_TASK_NOTIFY
+ *
+ *****************************************************************************/
+
+void CountSemPartner_Fn(void)
+{
+    while (OS_CountSemTake(go_sem_id) == OS_SUCCESS)
+    {
+        handoff_nsec = OS_GetMonotonicNsec();
+        OS_CountSemGive(done_sem_id);
+    }
+
+} /* end CountSemPartner_Fn */
+
+/* Uncontended give/take pairs, then handoffs to a task pending on the semaphore */
+static void BenchCountSemRun(const char *label, uint32 options)
+{
+    char   name[40];
+    uint32 i;
+    uint32 count = 0;
+    uint64 start;
+    int32  status;
+
+    status = OS_CountSemCreate(&go_sem_id, "BenchCountGo", 0, options);
+    UtAssert_True(status == OS_SUCCESS, "OS_CountSemCreate() (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_CountSemCreate(&done_sem_id, "BenchCountDone", 0, options);
+    UtAssert_True(status == OS_SUCCESS, "OS_CountSemCreate() (%ld) == OS_SUCCESS", (long)status);
+
+    for (i = 0; i < BENCH_SAMPLES; ++i)
+    {
+        start = OS_GetMonotonicNsec();
+        OS_CountSemGive(done_sem_id);
+        OS_CountSemTake(done_sem_id);
+        samples[i] = OS_GetMonotonicNsec() - start;
+    }
+    snprintf(name, sizeof(name), "%s_give_take", label);
+    BenchReportLatency(name, samples, BENCH_SAMPLES);
+
+    status = OS_TaskCreate(&partner_task_id, "BenchCountPartner", CountSemPartner_Fn, helper_stack, sizeof(helper_stack), BENCH_PRIORITY, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_TaskCreate() (%ld) == OS_SUCCESS", (long)status);
+
+    for (i = 0; i < BENCH_SAMPLES; ++i)
+    {
+        /* Let the partner block on the semaphore, whatever its priority */
+        OS_TaskDelay(1);
+
+        start = OS_GetMonotonicNsec();
+        OS_CountSemGive(go_sem_id);
+
+        if (OS_CountSemTimedWait(done_sem_id, 1000) != OS_SUCCESS)
+        {
+            break;
+        }
+        samples[count++] = handoff_nsec - start;
+    }
+
+    UtAssert_True(count == BENCH_SAMPLES, "%s handoffs: %lu of %lu", label, (unsigned long)count, (unsigned long)BENCH_SAMPLES);
+    snprintf(name, sizeof(name), "%s_handoff", label);
+    BenchReportLatency(name, samples, count);
+
+    OS_TaskDelete(partner_task_id);
+    OS_CountSemDelete(go_sem_id);
+    OS_CountSemDelete(done_sem_id);
+
+} /* end BenchCountSemRun */
+
+void BenchCountSem(void)
+{
+    BenchCountSemRun("count_sem_kernel", 0);
+
+#ifdef OS_FREERTOS_SEM_NOTIFY
+    BenchCountSemRun("count_sem_notify", OS_SEM_TASK_NOTIFY);
+#else
+    UtAssert_NA("OS_SEM_TASK_NOTIFY needs the port built with OS_FREERTOS_SEM_NOTIFY");
+#endif
+
+} /* end BenchCountSem */
+
+/*****************************************************************************
+ *
+ * Task spawn and delete
+ *
+ *****************************************************************************/
+
+void Spawned_Fn(void)
+{
+    while (1)
+    {
+        OS_TaskDelay(1000);
+    }
+
+} /* end Spawned_Fn */
+
+void BenchTaskSpawn(void)
+{
+    uint32 task_id;
+    uint32 i;
+    uint32 count = 0;
+    uint64 start;
+    uint64 total = 0;
+
+    for (i = 0; i < BENCH_SAMPLES; ++i)
+    {
+        start = OS_GetMonotonicNsec();
+
+        if (OS_TaskCreate(&task_id, "BenchSpawn", Spawned_Fn, spawn_stack, sizeof(spawn_stack), BENCH_PRIORITY, 0) != OS_SUCCESS)
+        {
+            break;
+        }
+        if (OS_TaskDelete(task_id) != OS_SUCCESS)
+        {
+            break;
+        }
+
+        samples[count] = OS_GetMonotonicNsec() - start;
+        total += samples[count++];
+    }
+
+    UtAssert_True(count == BENCH_SAMPLES, "task spawn/delete: %lu of %lu", (unsigned long)count, (unsigned long)BENCH_SAMPLES);
+
+    if (total > 0)
+    {
+        BenchReportRate("task_spawn_rate", "per_sec", count / (total / 1e9));
+    }
+    BenchReportLatency("task_spawn_delete", samples, count);
+
+} /* end BenchTaskSpawn */
+
+/*****************************************************************************
+ *
+ * Module startup
+ *
+ * The startup table in simplestaticloader.inc has a base module, two modules
+ * that depend on it and an application that depends on both.  Each init
+ * function takes BENCH_MODULE_INIT_MSEC, so one worker needs four of those
+ * and several workers three.
+ *
+ *****************************************************************************/
+
+#define BENCH_MODULE_BASE       0
+#define BENCH_MODULE_TLM        1
+#define BENCH_MODULE_CMD        2
+#define BENCH_MODULE_APP        3
+#define BENCH_MODULE_COUNT      4
+#define BENCH_MODULE_INIT_MSEC  20
+
+static uint64 module_start_nsec[BENCH_MODULE_COUNT];
+static uint64 module_end_nsec[BENCH_MODULE_COUNT];
+
+static int32 BenchStartupModule(uint32 module)
+{
+    module_start_nsec[module] = OS_GetMonotonicNsec();
+    OS_TaskDelay(BENCH_MODULE_INIT_MSEC);
+    module_end_nsec[module] = OS_GetMonotonicNsec();
+
+    return OS_SUCCESS;
+}
+
+int32 BenchStartup_Base(void)
+{
+    return BenchStartupModule(BENCH_MODULE_BASE);
+}
+
+int32 BenchStartup_Tlm(void)
+{
+    return BenchStartupModule(BENCH_MODULE_TLM);
+}
+
+int32 BenchStartup_Cmd(void)
+{
+    return BenchStartupModule(BENCH_MODULE_CMD);
+}
+
+int32 BenchStartup_App(void)
+{
+    return BenchStartupModule(BENCH_MODULE_APP);
+}
+
+/* Runs the startup table once, checks the order and returns the time it took */
+static uint64 BenchModuleStartupRun(uint32 workers)
+{
+    uint64 start;
+    uint64 elapsed;
+    int32  status;
+
+    memset(module_start_nsec, 0, sizeof(module_start_nsec));
+    memset(module_end_nsec, 0, sizeof(module_end_nsec));
+
+    start   = OS_GetMonotonicNsec();
+    status  = OS_ModuleStartup(workers);
+    elapsed = OS_GetMonotonicNsec() - start;
+
+    UtAssert_True(status == OS_SUCCESS, "OS_ModuleStartup(%lu) = %ld", (unsigned long)workers, (long)status);
+    UtAssert_True(module_end_nsec[BENCH_MODULE_BASE] != 0 && module_end_nsec[BENCH_MODULE_TLM] != 0 &&
+                  module_end_nsec[BENCH_MODULE_CMD] != 0 && module_end_nsec[BENCH_MODULE_APP] != 0,
+                  "every module started with %lu workers", (unsigned long)workers);
+    UtAssert_True(module_start_nsec[BENCH_MODULE_TLM] >= module_end_nsec[BENCH_MODULE_BASE] &&
+                  module_start_nsec[BENCH_MODULE_CMD] >= module_end_nsec[BENCH_MODULE_BASE],
+                  "dependents of the base module started after it");
+    UtAssert_True(module_start_nsec[BENCH_MODULE_APP] >= module_end_nsec[BENCH_MODULE_TLM] &&
+                  module_start_nsec[BENCH_MODULE_APP] >= module_end_nsec[BENCH_MODULE_CMD],
+                  "the application started after both of its dependencies");
+
+    return elapsed;
+}
+
+void BenchModuleStartup(void)
+{
+    uint64 serial;
+    uint64 parallel;
+
+    serial   = BenchModuleStartupRun(1);
+    parallel = BenchModuleStartupRun(0);
+
+    BenchReportRate("module_startup_1_worker", "usec", serial / 1000.0);
+    BenchReportRate("module_startup_max_workers", "usec", parallel / 1000.0);
+
+} /* end BenchModuleStartup */
+
+/*****************************************************************************
+ *
+ * Timer jitter
+ *
+ *****************************************************************************/
+
+void BenchTimer_Callback(uint32 timer_id)
+{
+    if (timer_count <= BENCH_TIMER_SAMPLES)
+    {
+        timer_stamps[timer_count++] = OS_GetMonotonicNsec();
+    }
+
+} /* end BenchTimer_Callback */
+
+void BenchTimerJitter(void)
+{
+    uint32 timer_id;
+    uint32 accuracy;
+    uint32 i;
+    uint32 loopcnt = 0;
+    uint64 period;
+    int32  status;
+
+    timer_count = 0;
+
+    status = OS_TimerCreate(&timer_id, "BenchTimer", &accuracy, BenchTimer_Callback);
+    UtAssert_True(status == OS_SUCCESS, "OS_TimerCreate() (%ld) == OS_SUCCESS", (long)status);
+    if (status != OS_SUCCESS)
+    {
+        return;
+    }
+
+    OS_TimerSet(timer_id, BENCH_TIMER_INTERVAL, BENCH_TIMER_INTERVAL);
+
+    while (timer_count <= BENCH_TIMER_SAMPLES && loopcnt < 2 * BENCH_TIMER_SAMPLES)
+    {
+        OS_TaskDelay(BENCH_TIMER_INTERVAL / 1000);
+        ++loopcnt;
+    }
+
+    OS_TimerDelete(timer_id);
+
+    UtAssert_True(timer_count > BENCH_TIMER_SAMPLES, "timer expiries: %lu of %lu",
+                  (unsigned long)timer_count, (unsigned long)BENCH_TIMER_SAMPLES + 1);
+
+    /* Deviation of every period from the nominal interval */
+    for (i = 0; i + 1 < timer_count; ++i)
+    {
+        period = timer_stamps[i + 1] - timer_stamps[i];
+        if (period > BENCH_TIMER_INTERVAL * 1000ULL)
+        {
+            samples[i] = period - BENCH_TIMER_INTERVAL * 1000ULL;
+        }
+        else
+        {
+            samples[i] = BENCH_TIMER_INTERVAL * 1000ULL - period;
+        }
+    }
+
+    UtPrintf("Timer accuracy %lu usec", (unsigned long)accuracy);
+    BenchReportLatency("timer_jitter", samples, (timer_count > 0) ? timer_count - 1 : 0);
+
+} /* end BenchTimerJitter */
+
+/*****************************************************************************
+ *
+ * File throughput
+ *
+ *****************************************************************************/
+
+static void BenchFileThroughput(const char *label, const char *path)
+{
+    static char chunk[BENCH_FILE_CHUNK];
+    char   name[32];
+    int32  fd;
+    uint32 done;
+    uint64 start;
+
+    memset(chunk, 0x5A, sizeof(chunk));
+
+    fd = OS_creat(path, OS_READ_WRITE);
+    UtAssert_True(fd >= 0, "OS_creat(%s) (%ld) >= 0", path, (long)fd);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    start = OS_GetMonotonicNsec();
+    for (done = 0; done < BENCH_FILE_BYTES; done += sizeof(chunk))
+    {
+        if (OS_write(fd, chunk, sizeof(chunk)) != sizeof(chunk))
+        {
+            break;
+        }
+    }
+    OS_close(fd);
+
+    UtAssert_True(done == BENCH_FILE_BYTES, "%s bytes written (%lu)", label, (unsigned long)done);
+    snprintf(name, sizeof(name), "file_write_%s", label);
+    BenchReportRate(name, "MBps", BenchMBps(done, OS_GetMonotonicNsec() - start));
+
+    fd = OS_open(path, OS_READ_ONLY, 0);
+    UtAssert_True(fd >= 0, "OS_open(%s) (%ld) >= 0", path, (long)fd);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    start = OS_GetMonotonicNsec();
+    for (done = 0; done < BENCH_FILE_BYTES; done += sizeof(chunk))
+    {
+        if (OS_read(fd, chunk, sizeof(chunk)) != sizeof(chunk))
+        {
+            break;
+        }
+    }
+    OS_close(fd);
+
+    UtAssert_True(done == BENCH_FILE_BYTES, "%s bytes read (%lu)", label, (unsigned long)done);
+    snprintf(name, sizeof(name), "file_read_%s", label);
+    BenchReportRate(name, "MBps", BenchMBps(done, OS_GetMonotonicNsec() - start));
+
+    OS_remove(path);
+
+} /* end BenchFileThroughput */
+
+void BenchFile_Setup(void)
+{
+    int32 status;
+
+    /* FreeRTOS+FAT needs about 5000 blocks, the file takes another 2048 */
+    status = OS_mkfs(0, "/ramdev0", "RAM0", 512, 8192);
+    UtAssert_True(status == OS_SUCCESS, "OS_mkfs(/ramdev0) (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_mount("/ramdev0", "/bench_ram");
+    UtAssert_True(status == OS_SUCCESS, "OS_mount(/ramdev0) (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_mkfs(0, "/fsdev0", "FS0", 512, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_mkfs(/fsdev0) (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_mount("/fsdev0", "/bench_fs");
+    UtAssert_True(status == OS_SUCCESS, "OS_mount(/fsdev0) (%ld) == OS_SUCCESS", (long)status);
+
+} /* end BenchFile_Setup */
+
+void BenchFile(void)
+{
+    BenchFileThroughput("ram_disk", "/bench_ram/bench.dat");
+    BenchFileThroughput("fs_based", "/bench_fs/bench.dat");
+
+} /* end BenchFile */
+
+void BenchFile_Teardown(void)
+{
+    OS_unmount("/bench_ram");
+    OS_rmfs("/ramdev0");
+    OS_unmount("/bench_fs");
+    OS_rmfs("/fsdev0");
+
+} /* end BenchFile_Teardown */
+
+/*****************************************************************************
+ *
+ * Network loopback throughput
+ *
+ *****************************************************************************/
+
+static int32 BenchAddr(OS_SockAddr_t *addr, uint16 port)
+{
+    int32 status;
+
+    status = OS_SocketAddrInit(addr, OS_SocketDomain_INET);
+    if (status == OS_SUCCESS)
+    {
+        status = OS_SocketAddrSetPort(addr, port);
+    }
+    if (status == OS_SUCCESS)
+    {
+        status = OS_SocketAddrFromString(addr, "192.168.0.4");
+    }
+
+    return status;
+}
+
+void UdpReceiver_Fn(void)
+{
+    char          buffer[BENCH_NET_CHUNK];
+    OS_SockAddr_t addr;
+    int32         length;
+
+    /* Stops once the sender has been quiet for a while */
+    while ((length = OS_SocketRecvFrom(net_socket_id, buffer, sizeof(buffer), &addr, 500)) > 0)
+    {
+        net_bytes += length;
+    }
+
+    OS_BinSemGive(done_sem_id);
+
+} /* end UdpReceiver_Fn */
+
+void TcpServer_Fn(void)
+{
+    char          buffer[BENCH_NET_CHUNK];
+    OS_SockAddr_t addr;
+    uint32        connsock_id;
+    int32         length;
+
+    if (OS_SocketAccept(net_socket_id, &connsock_id, &addr, 2000) == OS_SUCCESS)
+    {
+        while ((length = OS_TimedRead(connsock_id, buffer, sizeof(buffer), 500)) > 0)
+        {
+            net_bytes += length;
+            if (net_bytes >= BENCH_NET_BYTES)
+            {
+                break;
+            }
+        }
+        OS_close(connsock_id);
+    }
+
+    OS_BinSemGive(done_sem_id);
+
+} /* end TcpServer_Fn */
+
+void BenchNet_Setup(void)
+{
+    int32 status;
+
+    status = OS_BinSemCreate(&done_sem_id, "BenchDone", 0, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_BinSemCreate() (%ld) == OS_SUCCESS", (long)status);
+
+} /* end BenchNet_Setup */
+
+void BenchUdp(void)
+{
+    static char   buffer[BENCH_NET_CHUNK];
+    OS_SockAddr_t rx_addr;
+    OS_SockAddr_t tx_addr;
+    uint32        tx_socket_id;
+    uint32        sent;
+    uint64        start;
+    uint64        elapsed;
+    int32         status;
+
+    net_bytes = 0;
+
+    status = OS_SocketOpen(&net_socket_id, OS_SocketDomain_INET, OS_SocketType_DATAGRAM);
+    UtAssert_True(status == OS_SUCCESS, "OS_SocketOpen() (%ld) == OS_SUCCESS", (long)status);
+    status = OS_SocketOpen(&tx_socket_id, OS_SocketDomain_INET, OS_SocketType_DATAGRAM);
+    UtAssert_True(status == OS_SUCCESS, "OS_SocketOpen() (%ld) == OS_SUCCESS", (long)status);
+
+    BenchAddr(&rx_addr, 9899);
+    BenchAddr(&tx_addr, 9898);
+    status = OS_SocketBind(net_socket_id, &rx_addr);
+    UtAssert_True(status == OS_SUCCESS, "OS_SocketBind() (%ld) == OS_SUCCESS", (long)status);
+    status = OS_SocketBind(tx_socket_id, &tx_addr);
+    UtAssert_True(status == OS_SUCCESS, "OS_SocketBind() (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_TaskCreate(&partner_task_id, "BenchUdpRx", UdpReceiver_Fn, helper_stack, sizeof(helper_stack), BENCH_PRIORITY, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_TaskCreate() (%ld) == OS_SUCCESS", (long)status);
+
+    start = OS_GetMonotonicNsec();
+    for (sent = 0; sent < BENCH_NET_BYTES; sent += sizeof(buffer))
+    {
+        if (OS_SocketSendTo(tx_socket_id, buffer, sizeof(buffer), &rx_addr) != sizeof(buffer))
+        {
+            break;
+        }
+    }
+
+    /* The receiver gives up 500 msec after the last datagram, which is not counted */
+    OS_BinSemTimedWait(done_sem_id, 5000);
+    elapsed = OS_GetMonotonicNsec() - start;
+    elapsed = (elapsed > 500000000ULL) ? elapsed - 500000000ULL : elapsed;
+
+    UtAssert_True(net_bytes > 0, "UDP bytes received (%lu) of %lu sent", (unsigned long)net_bytes, (unsigned long)sent);
+    BenchReportRate("udp_loopback", "MBps", BenchMBps(net_bytes, elapsed));
+    BenchReportRate("udp_loopback_delivered", "percent", sent ? (100.0 * net_bytes) / sent : 0.0);
+
+    OS_close(tx_socket_id);
+    OS_close(net_socket_id);
+
+} /* end BenchUdp */
+
+void BenchTcp(void)
+{
+    static char   buffer[BENCH_NET_CHUNK];
+    OS_SockAddr_t s_addr;
+    uint32        c_socket_id;
+    uint32        sent;
+    uint64        start;
+    int32         status;
+
+    net_bytes = 0;
+
+    status = OS_SocketOpen(&net_socket_id, OS_SocketDomain_INET, OS_SocketType_STREAM);
+    UtAssert_True(status == OS_SUCCESS, "OS_SocketOpen() (%ld) == OS_SUCCESS", (long)status);
+    status = OS_SocketOpen(&c_socket_id, OS_SocketDomain_INET, OS_SocketType_STREAM);
+    UtAssert_True(status == OS_SUCCESS, "OS_SocketOpen() (%ld) == OS_SUCCESS", (long)status);
+
+    BenchAddr(&s_addr, 9897);
+    status = OS_SocketBind(net_socket_id, &s_addr);
+    UtAssert_True(status == OS_SUCCESS, "OS_SocketBind() (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_TaskCreate(&partner_task_id, "BenchTcpRx", TcpServer_Fn, helper_stack, sizeof(helper_stack), BENCH_PRIORITY, 0);
+    UtAssert_True(status == OS_SUCCESS, "OS_TaskCreate() (%ld) == OS_SUCCESS", (long)status);
+
+    status = OS_SocketConnect(c_socket_id, &s_addr, 2000);
+    UtAssert_True(status == OS_SUCCESS, "OS_SocketConnect() (%ld) == OS_SUCCESS", (long)status);
+
+    start = OS_GetMonotonicNsec();
+    for (sent = 0; status == OS_SUCCESS && sent < BENCH_NET_BYTES; sent += sizeof(buffer))
+    {
+        if (OS_TimedWrite(c_socket_id, buffer, sizeof(buffer), 1000) != sizeof(buffer))
+        {
+            break;
+        }
+    }
+
+    /* Done once the server has read everything */
+    OS_BinSemTimedWait(done_sem_id, 5000);
+
+    UtAssert_True(net_bytes == sent, "TCP bytes received (%lu) == sent (%lu)", (unsigned long)net_bytes, (unsigned long)sent);
+    BenchReportRate("tcp_loopback", "MBps", BenchMBps(net_bytes, OS_GetMonotonicNsec() - start));
+
+    OS_close(c_socket_id);
+    OS_close(net_socket_id);
+
+} /* end BenchTcp */
+
+void BenchNet_Teardown(void)
+{
+    OS_BinSemDelete(done_sem_id);
+
+} /* end BenchNet_Teardown */
+
+void OS_Application_Startup(void)
+{
+    if (OS_API_Init() != OS_SUCCESS)
+    {
+        UtAssert_Abort("OS_API_Init() failed");
+    }
+
+    /*
+     * Register the benchmarks in UT assert
+     */
+    UtTest_Add(BenchQueueRoundTrip, BenchQueueRoundTrip_Setup, BenchQueueRoundTrip_Teardown, "BenchQueueRoundTrip");
+    UtTest_Add(BenchMutexPingPong, BenchMutexPingPong_Setup, BenchMutexPingPong_Teardown, "BenchMutexPingPong");
+    UtTest_Add(BenchCountSem, NULL, NULL, "BenchCountSem");
+    UtTest_Add(BenchTaskSpawn, NULL, NULL, "BenchTaskSpawn");
+    UtTest_Add(BenchModuleStartup, NULL, NULL, "BenchModuleStartup");
+    UtTest_Add(BenchTimerJitter, NULL, NULL, "BenchTimerJitter");
+    UtTest_Add(BenchFile, BenchFile_Setup, BenchFile_Teardown, "BenchFile");
+    UtTest_Add(BenchUdp, BenchNet_Setup, BenchNet_Teardown, "BenchUdp");
+    UtTest_Add(BenchTcp, BenchNet_Setup, BenchNet_Teardown, "BenchTcp");
+}
@@ -22,6 +22,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/types.h>
@@ -29,9 +30,11 @@
 
 #include "FreeRTOS.h"
 #include "task.h"
+#include "osapi-os-freertos.h"
 
 #include "utbsp.h"
 #include "uttest.h"
+#include "bsp_ut_common.h"
 
 /*
  **  External Declarations
@@ -48,7 +51,7 @@ void UT_BSP_ParseCommandLine(int argc, char *argv[]) {
 	int opt;
 
 	UserShift = UTASSERT_CASETYPE_NONE;
-	while ((opt = getopt(argc, argv, "v:qd")) != -1) {
+	while ((opt = getopt(argc, argv, "v:qdr:o:")) != -1) {
 		switch (opt) {
 		case 'd':
 			UserShift = UTASSERT_CASETYPE_DEBUG;
@@ -59,8 +62,14 @@ void UT_BSP_ParseCommandLine(int argc, char *argv[]) {
 		case 'v':
 			UserShift = atoi(optarg);
 			break;
+		case 'o':
+		case 'r':
+			if (UT_BSP_ReportOption(opt, optarg)) {
+				break;
+			}
+			/* Unknown format, show the usage */
 		default: /* '?' */
-			fprintf(stderr, "Usage: %s [-v verbosity] [-d] [-q]\n", argv[0]);
+			fprintf(stderr, "Usage: %s [-v verbosity] [-d] [-q] [-r json|csv] [-o report file]\n", argv[0]);
 			exit(EXIT_FAILURE);
 		}
 		if (UserShift > 0 && UserShift < UTASSERT_CASETYPE_MAX) {
@@ -68,6 +77,8 @@ void UT_BSP_ParseCommandLine(int argc, char *argv[]) {
 		}
 	}
 
+	UT_BSP_ReportStart(argv[0]);
+
 }
 
 void UT_BSP_Setup(const char *Name) {
@@ -88,6 +99,8 @@ void UT_BSP_StartTestSegment(uint32 SegmentNumber, const char *SegmentName) {
 	snprintf(ReportBuffer, sizeof(ReportBuffer), "%02u %s",
 			(unsigned int) SegmentNumber, SegmentName);
 	UT_BSP_DoText(UTASSERT_CASETYPE_BEGIN, ReportBuffer);
+
+	UT_BSP_ReportSegmentStart(SegmentNumber);
 }
 
 void UT_BSP_DoText(uint8 MessageType, const char *OutputMessage) {
@@ -168,6 +181,8 @@ void UT_BSP_DoReport(const char *File, uint32 LineNum, uint32 SegmentNum,
 			(unsigned int) LineNum, ShortDesc);
 
 	UT_BSP_DoText(MessageType, ReportBuffer);
+
+	UT_BSP_ReportText(MessageType, ShortDesc);
 }
 
 void UT_BSP_DoTestSegmentReport(const char *SegmentName,
@@ -185,6 +200,8 @@ void UT_BSP_DoTestSegmentReport(const char *SegmentName,
 			(unsigned int) TestCounters->CaseCount[UTASSERT_CASETYPE_NA]);
 
 	UT_BSP_DoText(UTASSERT_CASETYPE_END, ReportBuffer);
+
+	UT_BSP_ReportSegment(SegmentName, TestCounters);
 }
 
 void UT_BSP_EndTest(const UtAssert_TestCounter_t *TestCounters) {
@@ -193,6 +210,8 @@ void UT_BSP_EndTest(const UtAssert_TestCounter_t *TestCounters) {
 	rmdir("./fs0");
 	rmdir("./fs1");
 
+	UT_BSP_ReportFinish(TestCounters);
+
 	/*
 	 * Only output a "summary" if there is more than one test Segment.
 	 * Otherwise it is a duplicate of the report already given.
@@ -249,6 +268,8 @@ void Run_Test(void *parm) {
 	/*
 	 ** In unit test mode, call the UtTest_Run function (part of UT Assert library)
 	 */
+	UT_BSP_TestStarting();
+
 	UtTest_Run();
 
 	UT_BSP_EndTest(UtAssert_GetCounters());
@@ -258,13 +279,16 @@ void Run_Test(void *parm) {
 
 int main(int argc, char *argv[]) {
 	BaseType_t status;
+	uint32 phase;
 
 	UT_BSP_Setup("PC-LINUX UNIT TEST");
 
 	/*
 	 ** Call application specific entry point.
 	 */
+	phase = OS_StartupPhaseBegin("OS_Application_Startup");
 	OS_Application_Startup();
+	OS_StartupPhaseEnd(phase);
 
 	UT_BSP_ParseCommandLine(argc, argv);
 
@@ -274,6 +298,7 @@ int main(int argc, char *argv[]) {
 	if (status == pdFAIL) {
 		fprintf(stderr, "ERROR: Could not spawn main task\n");
 	} else {
+		UT_BSP_SchedulerStarting();
 		vTaskStartScheduler();
 	}
 
@@ -22,6 +22,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <sys/types.h>
@@ -34,6 +35,7 @@
 
 #include "utbsp.h"
 #include "uttest.h"
+#include "bsp_ut_common.h"
 
 
 #include "common_types.h"
@@ -58,12 +60,21 @@ extern const uint8_t ucMACAddress[ 6 ];
  */
 static uint32 CurrVerbosity = (2 << UTASSERT_CASETYPE_PASS) - 1;
 
+/*
+ **  Addresses of this instance, the defaults unless given with -a and -m, so
+ **  several instances can share a virtual network (see OS_FREERTOS_NET_SHM)
+ */
+static uint8_t IPAddress[ 4 ];
+static uint8_t MACAddress[ 6 ];
+
 void UT_BSP_ParseCommandLine(int argc, char *argv[]) {
 	uint8 UserShift;
 	int opt;
 
 	UserShift = UTASSERT_CASETYPE_NONE;
-	while ((opt = getopt(argc, argv, "v:qd")) != -1) {
+	memcpy(IPAddress, ucIPAddress, sizeof(IPAddress));
+	memcpy(MACAddress, ucMACAddress, sizeof(MACAddress));
+	while ((opt = getopt(argc, argv, "v:qdr:o:a:m:")) != -1) {
 		switch (opt) {
 		case 'd':
 			UserShift = UTASSERT_CASETYPE_DEBUG;
@@ -74,8 +85,26 @@ void UT_BSP_ParseCommandLine(int argc, char *argv[]) {
 		case 'v':
 			UserShift = atoi(optarg);
 			break;
+		case 'a':
+			if (OS_NetAddressParse(optarg, IPAddress, sizeof(IPAddress)) != OS_SUCCESS) {
+				fprintf(stderr, "%s: bad IP address %s\n", argv[0], optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'm':
+			if (OS_NetAddressParse(optarg, MACAddress, sizeof(MACAddress)) != OS_SUCCESS) {
+				fprintf(stderr, "%s: bad MAC address %s\n", argv[0], optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'o':
+		case 'r':
+			if (UT_BSP_ReportOption(opt, optarg)) {
+				break;
+			}
+			/* Unknown format, show the usage */
 		default: /* '?' */
-			fprintf(stderr, "Usage: %s [-v verbosity] [-d] [-q]\n", argv[0]);
+			fprintf(stderr, "Usage: %s [-v verbosity] [-d] [-q] [-r json|csv] [-o report file] [-a IP address] [-m MAC address]\n", argv[0]);
 			exit(EXIT_FAILURE);
 		}
 		if (UserShift > 0 && UserShift < UTASSERT_CASETYPE_MAX) {
@@ -83,6 +112,8 @@ void UT_BSP_ParseCommandLine(int argc, char *argv[]) {
 		}
 	}
 
+	UT_BSP_ReportStart(argv[0]);
+
 }
 
 void UT_BSP_Setup(const char *Name) {
@@ -103,6 +134,8 @@ void UT_BSP_StartTestSegment(uint32 SegmentNumber, const char *SegmentName) {
 	snprintf(ReportBuffer, sizeof(ReportBuffer), "%02u %s",
 			(unsigned int) SegmentNumber, SegmentName);
 	UT_BSP_DoText(UTASSERT_CASETYPE_BEGIN, ReportBuffer);
+
+	UT_BSP_ReportSegmentStart(SegmentNumber);
 }
 
 void UT_BSP_DoText(uint8 MessageType, const char *OutputMessage) {
@@ -183,6 +216,8 @@ void UT_BSP_DoReport(const char *File, uint32 LineNum, uint32 SegmentNum,
 			(unsigned int) LineNum, ShortDesc);
 
 	UT_BSP_DoText(MessageType, ReportBuffer);
+
+	UT_BSP_ReportText(MessageType, ShortDesc);
 }
 
 void UT_BSP_DoTestSegmentReport(const char *SegmentName,
@@ -200,6 +235,8 @@ void UT_BSP_DoTestSegmentReport(const char *SegmentName,
 			(unsigned int) TestCounters->CaseCount[UTASSERT_CASETYPE_NA]);
 
 	UT_BSP_DoText(UTASSERT_CASETYPE_END, ReportBuffer);
+
+	UT_BSP_ReportSegment(SegmentName, TestCounters);
 }
 
 void UT_BSP_EndTest(const UtAssert_TestCounter_t *TestCounters) {
@@ -208,6 +245,8 @@ void UT_BSP_EndTest(const UtAssert_TestCounter_t *TestCounters) {
 	rmdir("./fs0");
 	rmdir("./fs1");
 
+	UT_BSP_ReportFinish(TestCounters);
+
 	/*
 	 * Only output a "summary" if there is more than one test Segment.
 	 * Otherwise it is a duplicate of the report already given.
@@ -265,6 +304,8 @@ void Run_Test(void *parm) {
 	 ** In unit test mode, call the UtTest_Run function (part of UT Assert library)
 	 */
 
+	UT_BSP_TestStarting();
+
 	//TODO: Figure out why this is needed
 	OS_TaskDelay(100);
 
@@ -276,13 +317,16 @@ void Run_Test(void *parm) {
 }
 
 int main(int argc, char *argv[]) {
+	uint32 phase;
 
 	UT_BSP_Setup("PC-LINUX UNIT TEST");
 
 	/*
 	 ** Call application specific entry point.
 	 */
+	phase = OS_StartupPhaseBegin("OS_Application_Startup");
 	OS_Application_Startup();
+	OS_StartupPhaseEnd(phase);
 
 	UT_BSP_ParseCommandLine(argc, argv);
 
@@ -295,8 +339,11 @@ int main(int argc, char *argv[]) {
 	  are used if ipconfigUSE_DHCP is set to 0, or if ipconfigUSE_DHCP is set to 1
 	  but a DHCP server cannot be contacted.
 	 */
-	FreeRTOS_IPInit( ucIPAddress, ucNetMask, ucGatewayAddress, ucDNSServerAddress, ucMACAddress );
+	phase = OS_StartupPhaseBegin("FreeRTOS_IPInit");
+	FreeRTOS_IPInit( IPAddress, ucNetMask, ucGatewayAddress, ucDNSServerAddress, MACAddress );
+	OS_StartupPhaseEnd(phase);
 
+	UT_BSP_SchedulerStarting();
 	vTaskStartScheduler();
 
 	/* Should typically never get here */
@@ -40,6 +40,13 @@
 
 #define MAX_BUFFER_LOOP 1000000
 
+/*
+ * Sockets and iterations of the fully populated OS_SelectMultiple benchmark.
+ * As many sockets are opened as the stream table allows.
+ */
+#define BENCH_SOCKETS   OS_MAX_NUM_OPEN_FILES
+#define BENCH_LOOPS     1000
+
 #define TASK_STACK_SIZE 16384
 uint32 task_stack[TASK_STACK_SIZE];
 
@@ -498,6 +505,76 @@ void TestSelectMultipleWrite(void)
     }
 }
 
+void TestSelectMultipleBenchmark(void)
+{
+    /*
+     * Benchmark for:
+     * int32 OS_SelectMultiple(OS_FdSet *ReadSet, OS_FdSet *WriteSet, int32 msecs);
+     *
+     * Polls a fully populated read set of idle sockets, so the time per call is
+     * the cost of converting the OS_FdSet in and out plus one FreeRTOS_select.
+     */
+    uint32        sock_ids[BENCH_SOCKETS];
+    uint32        count;
+    uint32        i;
+    OS_SockAddr_t addr;
+    OS_FdSet      FullSet;
+    OS_FdSet      ReadSet;
+    OS_time_t     start;
+    OS_time_t     end;
+    int32         actual;
+    int32         timeouts;
+    uint32        elapsed;
+
+    OS_SelectFdZero(&FullSet);
+    for (count = 0; count < BENCH_SOCKETS; ++count)
+    {
+        if (OS_SocketOpen(&sock_ids[count], OS_SocketDomain_INET, OS_SocketType_DATAGRAM) != OS_SUCCESS)
+        {
+            break;
+        }
+
+        OS_SocketAddrInit(&addr, OS_SocketDomain_INET);
+        OS_SocketAddrSetPort(&addr, 9100 + count);
+        OS_SocketAddrFromString(&addr, "192.168.0.4");
+        if (OS_SocketBind(sock_ids[count], &addr) != OS_SUCCESS)
+        {
+            OS_close(sock_ids[count]);
+            break;
+        }
+
+        OS_SelectFdAdd(&FullSet, sock_ids[count]);
+    }
+
+    UtAssert_True(count > 0, "Benchmark sockets opened (%u)", (unsigned int)count);
+
+    timeouts = 0;
+    OS_GetLocalTime(&start);
+    for (i = 0; i < BENCH_LOOPS; ++i)
+    {
+        ReadSet = FullSet;
+        actual  = OS_SelectMultiple(&ReadSet, NULL, OS_CHECK);
+        if (actual == OS_ERROR_TIMEOUT)
+        {
+            ++timeouts;
+        }
+    }
+    OS_GetLocalTime(&end);
+
+    UtAssert_True(timeouts == BENCH_LOOPS, "OS_SelectMultiple() on idle sockets timed out %ld of %d times",
+                  (long)timeouts, BENCH_LOOPS);
+
+    elapsed = (end.seconds - start.seconds) * 1000000 + end.microsecs - start.microsecs;
+    UtPrintf("OS_SelectMultiple, %u sockets: %u usec for %d calls, %u.%03u usec per call\n", (unsigned int)count,
+             (unsigned int)elapsed, BENCH_LOOPS, (unsigned int)(elapsed / BENCH_LOOPS),
+             (unsigned int)((elapsed % BENCH_LOOPS) * 1000 / BENCH_LOOPS));
+
+    for (i = 0; i < count; ++i)
+    {
+        OS_close(sock_ids[i]);
+    }
+}
+
 void OS_Application_Startup(void)
 {
     if (OS_API_Init() != OS_SUCCESS)
@@ -513,4 +590,5 @@ void OS_Application_Startup(void)
     UtTest_Add(TestSelectMultipleRead, Setup_Multi, Teardown_Multi, "TestSelectMultipleRead");
 //    UtTest_Add(TestSelectSingleWrite, Setup_Single, Teardown_Single, "TestSelectSingleWrite");
 //    UtTest_Add(TestSelectMultipleWrite, Setup_Multi, Teardown_Multi, "TestSelectMultipleWrite");
+    UtTest_Add(TestSelectMultipleBenchmark, NULL, NULL, "TestSelectMultipleBenchmark");
 }
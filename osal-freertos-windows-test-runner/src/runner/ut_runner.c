@@ -0,0 +1,149 @@
+/*
+ * ut_runner.c
+ *
+ * Runs any set of the OSAL test suites in one executable.  The OSAL and the
+ * FreeRTOS scheduler are brought up once; the selected suites then register
+ * their tests with UT assert in table order and UtTest_Run runs them back to
+ * back, each test still one segment of the report.
+ *
+ * The suites were written to run alone, so a suite that leaves objects
+ * behind can use up OSAL table entries a later suite needs.  Run such a suite
+ * on its own with -s.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "common_types.h"
+#include "osapi.h"
+#include "utassert.h"
+#include "uttest.h"
+
+#include "ut_runner.h"
+
+/*
+ **  Suite startups, defined by the wrappers in src/suites
+ */
+void UT_RUNNER_STARTUP(bin_sem_test)(void);
+void UT_RUNNER_STARTUP(bin_sem_flush_test)(void);
+void UT_RUNNER_STARTUP(bin_sem_timeout_test)(void);
+void UT_RUNNER_STARTUP(count_sem_test)(void);
+void UT_RUNNER_STARTUP(mutex_test)(void);
+void UT_RUNNER_STARTUP(queue_timeout_test)(void);
+void UT_RUNNER_STARTUP(sem_speed_test)(void);
+void UT_RUNNER_STARTUP(timer_test)(void);
+void UT_RUNNER_STARTUP(osal_core_test)(void);
+void UT_RUNNER_STARTUP(file_api_test)(void);
+void UT_RUNNER_STARTUP(symbol_api_test)(void);
+void UT_RUNNER_STARTUP(network_test)(void);
+void UT_RUNNER_STARTUP(select_test)(void);
+void UT_RUNNER_STARTUP(benchmark_test)(void);
+
+typedef struct
+{
+    const char *name;
+    void      (*startup)(void);
+    bool        selected;
+} UT_Runner_Suite_t;
+
+static UT_Runner_Suite_t UT_Runner_Suites[] =
+{
+    { "bin-sem-test",         UT_RUNNER_STARTUP(bin_sem_test),         false },
+    { "bin-sem-flush-test",   UT_RUNNER_STARTUP(bin_sem_flush_test),   false },
+    { "bin-sem-timeout-test", UT_RUNNER_STARTUP(bin_sem_timeout_test), false },
+    { "count-sem-test",       UT_RUNNER_STARTUP(count_sem_test),       false },
+    { "mutex-test",           UT_RUNNER_STARTUP(mutex_test),           false },
+    { "queue-timeout-test",   UT_RUNNER_STARTUP(queue_timeout_test),   false },
+    { "sem-speed-test",       UT_RUNNER_STARTUP(sem_speed_test),       false },
+    { "timer-test",           UT_RUNNER_STARTUP(timer_test),           false },
+    { "osal-core-test",       UT_RUNNER_STARTUP(osal_core_test),       false },
+    { "file-api-test",        UT_RUNNER_STARTUP(file_api_test),        false },
+    { "symbol-api-test",      UT_RUNNER_STARTUP(symbol_api_test),      false },
+    { "network-test",         UT_RUNNER_STARTUP(network_test),         false },
+    { "select-test",          UT_RUNNER_STARTUP(select_test),          false },
+    { "benchmark-test",       UT_RUNNER_STARTUP(benchmark_test),       false }
+};
+
+#define UT_RUNNER_SUITE_COUNT   (sizeof(UT_Runner_Suites) / sizeof(UT_Runner_Suites[0]))
+
+static bool   UT_Runner_AnySelected = false;
+static bool   UT_Runner_Initialized = false;
+static int32  UT_Runner_InitStatus;
+
+int32 UT_Runner_APIInit(void)
+{
+    /* Only the first suite really initializes the OSAL */
+    if (!UT_Runner_Initialized)
+    {
+        UT_Runner_InitStatus = OS_API_Init();
+        UT_Runner_Initialized = true;
+    }
+
+    return UT_Runner_InitStatus;
+}
+
+bool UT_Runner_SelectSuites(const char *names)
+{
+    const char *next;
+    size_t length;
+    uint32 i;
+
+    while (*names != '\0')
+    {
+        next = strchr(names, ',');
+        length = (next != NULL) ? (size_t)(next - names) : strlen(names);
+
+        for (i = 0; i < UT_RUNNER_SUITE_COUNT; ++i)
+        {
+            if (strlen(UT_Runner_Suites[i].name) == length &&
+                strncmp(UT_Runner_Suites[i].name, names, length) == 0)
+            {
+                UT_Runner_Suites[i].selected = true;
+                UT_Runner_AnySelected = true;
+                break;
+            }
+        }
+
+        if (i == UT_RUNNER_SUITE_COUNT)
+        {
+            fprintf(stderr, "Unknown suite %.*s\n", (int)length, names);
+            return false;
+        }
+
+        names += length;
+        if (*names == ',')
+        {
+            ++names;
+        }
+    }
+
+    return true;
+}
+
+void UT_Runner_ListSuites(void)
+{
+    uint32 i;
+
+    for (i = 0; i < UT_RUNNER_SUITE_COUNT; ++i)
+    {
+        printf("%s\n", UT_Runner_Suites[i].name);
+    }
+}
+
+void OS_Application_Startup(void)
+{
+    uint32 i;
+
+    if (UT_Runner_APIInit() != OS_SUCCESS)
+    {
+        UtAssert_Abort("OS_API_Init() failed");
+    }
+
+    for (i = 0; i < UT_RUNNER_SUITE_COUNT; ++i)
+    {
+        if (UT_Runner_Suites[i].selected || !UT_Runner_AnySelected)
+        {
+            UT_Runner_Suites[i].startup();
+        }
+    }
+}
@@ -0,0 +1,33 @@
+/*
+ * ut_runner.h
+ *
+ * Test runner that links every OSAL test suite into one executable, see
+ * ut_runner.c.
+ */
+
+#ifndef UT_RUNNER_H_
+#define UT_RUNNER_H_
+
+#include "common_types.h"
+
+/*
+ * Each suite is compiled through a wrapper in src/suites that renames its
+ * OS_Application_Startup to UT_RUNNER_STARTUP(name) and routes its
+ * OS_API_Init to UT_Runner_APIInit, so every suite registers its tests on the
+ * one OSAL and scheduler the runner brings up.  The names the suites share
+ * are made local to each suite by ut_runner_local.h.
+ */
+#define UT_RUNNER_STARTUP(name)     UT_Suite_##name##_Startup
+
+int32 UT_Runner_APIInit(void);
+
+/*
+ * Select the suites to run, a comma separated list of names (see -l).  All
+ * suites run when nothing is selected.  Returns false for an unknown name.
+ */
+bool UT_Runner_SelectSuites(const char *names);
+
+/* Print the suite names */
+void UT_Runner_ListSuites(void);
+
+#endif /* UT_RUNNER_H_ */
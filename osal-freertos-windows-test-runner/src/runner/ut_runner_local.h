@@ -0,0 +1,63 @@
+/*
+ * ut_runner_local.h
+ *
+ * The test suites were written as separate programs and reuse the same
+ * global names (task_1, bin_sem_id, BinSemSetup, Server_Fn, ...).  A suite
+ * wrapper defines UT_RUNNER_SUITE and includes this file before the suite,
+ * which gives each of those names the suite as a prefix.
+ *
+ * The list holds every file scope name, other than static ones, that more
+ * than one suite defines.  Names used by a single suite (p1_socket_id,
+ * Server_Fn2, BenchStartup_Base, ...) keep their own name, so the runner's
+ * symbol table can still find them.  A suite added to the runner is checked
+ * against this list the same way, and a name it shares with another suite is
+ * added here.
+ */
+
+#ifndef UT_RUNNER_SUITE
+#error UT_RUNNER_SUITE must be defined by the suite wrapper
+#endif
+
+#define UT_RUNNER_LOCAL(name)           UT_RUNNER_LOCAL_PASTE(UT_RUNNER_SUITE, name)
+#define UT_RUNNER_LOCAL_PASTE(s, n)     UT_RUNNER_LOCAL_PASTE2(s, n)
+#define UT_RUNNER_LOCAL_PASTE2(s, n)    UT_Suite_##s##_##n
+
+/* Tasks */
+#define task_1                  UT_RUNNER_LOCAL(task_1)
+#define task_2                  UT_RUNNER_LOCAL(task_2)
+#define task_3                  UT_RUNNER_LOCAL(task_3)
+#define task_1_id               UT_RUNNER_LOCAL(task_1_id)
+#define task_2_id               UT_RUNNER_LOCAL(task_2_id)
+#define task_3_id               UT_RUNNER_LOCAL(task_3_id)
+#define task_1_stack            UT_RUNNER_LOCAL(task_1_stack)
+#define task_2_stack            UT_RUNNER_LOCAL(task_2_stack)
+#define task_3_stack            UT_RUNNER_LOCAL(task_3_stack)
+#define task_1_failures         UT_RUNNER_LOCAL(task_1_failures)
+#define task_2_failures         UT_RUNNER_LOCAL(task_2_failures)
+#define task_3_failures         UT_RUNNER_LOCAL(task_3_failures)
+#define task_1_work             UT_RUNNER_LOCAL(task_1_work)
+#define task_2_work             UT_RUNNER_LOCAL(task_2_work)
+#define task_3_work             UT_RUNNER_LOCAL(task_3_work)
+#define task_stack              UT_RUNNER_LOCAL(task_stack)
+#define s_task_id               UT_RUNNER_LOCAL(s_task_id)
+
+/* Semaphores, queues and timers */
+#define bin_sem_id              UT_RUNNER_LOCAL(bin_sem_id)
+#define count_sem_id            UT_RUNNER_LOCAL(count_sem_id)
+#define mut_sem_id              UT_RUNNER_LOCAL(mut_sem_id)
+#define msgq_id                 UT_RUNNER_LOCAL(msgq_id)
+#define counter                 UT_RUNNER_LOCAL(counter)
+#define timer_id                UT_RUNNER_LOCAL(timer_id)
+#define timer_counter           UT_RUNNER_LOCAL(timer_counter)
+#define timer_start             UT_RUNNER_LOCAL(timer_start)
+#define timer_interval          UT_RUNNER_LOCAL(timer_interval)
+#define timer_accuracy          UT_RUNNER_LOCAL(timer_accuracy)
+#define TimerFunction           UT_RUNNER_LOCAL(TimerFunction)
+#define BinSemSetup             UT_RUNNER_LOCAL(BinSemSetup)
+
+/* Sockets */
+#define s_socket_id             UT_RUNNER_LOCAL(s_socket_id)
+#define c_socket_id             UT_RUNNER_LOCAL(c_socket_id)
+#define s_addr                  UT_RUNNER_LOCAL(s_addr)
+#define c_addr                  UT_RUNNER_LOCAL(c_addr)
+#define Server_Fn               UT_RUNNER_LOCAL(Server_Fn)
@@ -0,0 +1,15 @@
+/*
+ * benchmark-test.c
+ *
+ * Builds benchmark-test/benchmark-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         benchmark_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(benchmark_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "benchmark-test/benchmark-test.c"
@@ -0,0 +1,15 @@
+/*
+ * bin-sem-test.c
+ *
+ * Builds bin-sem-test/bin-sem-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         bin_sem_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(bin_sem_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "bin-sem-test/bin-sem-test.c"
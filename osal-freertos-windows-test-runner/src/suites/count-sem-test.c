@@ -0,0 +1,15 @@
+/*
+ * count-sem-test.c
+ *
+ * Builds count-sem-test/count-sem-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         count_sem_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(count_sem_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "count-sem-test/count-sem-test.c"
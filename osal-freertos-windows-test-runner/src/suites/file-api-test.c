@@ -0,0 +1,15 @@
+/*
+ * file-api-test.c
+ *
+ * Builds file-api-test/file-api-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         file_api_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(file_api_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "file-api-test/file-api-test.c"
@@ -0,0 +1,15 @@
+/*
+ * mutex-test.c
+ *
+ * Builds mutex-test/mutex-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         mutex_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(mutex_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "mutex-test/mutex-test.c"
@@ -0,0 +1,15 @@
+/*
+ * network-test.c
+ *
+ * Builds network-test/network-api-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         network_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(network_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "network-test/network-api-test.c"
@@ -0,0 +1,15 @@
+/*
+ * osal-core-test.c
+ *
+ * Builds osal-core-test/osal-core-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         osal_core_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(osal_core_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "osal-core-test/osal-core-test.c"
@@ -0,0 +1,15 @@
+/*
+ * queue-timeout-test.c
+ *
+ * Builds queue-timeout-test/queue-timeout-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         queue_timeout_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(queue_timeout_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "queue-timeout-test/queue-timeout-test.c"
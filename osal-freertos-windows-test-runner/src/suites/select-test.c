@@ -0,0 +1,15 @@
+/*
+ * select-test.c
+ *
+ * Builds select-test/select-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         select_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(select_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "select-test/select-test.c"
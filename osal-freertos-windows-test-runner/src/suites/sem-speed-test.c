@@ -0,0 +1,15 @@
+/*
+ * sem-speed-test.c
+ *
+ * Builds sem-speed-test/sem-speed-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         sem_speed_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(sem_speed_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "sem-speed-test/sem-speed-test.c"
@@ -0,0 +1,15 @@
+/*
+ * symbol-api-test.c
+ *
+ * Builds symbol-api-test/symbol-api-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         symbol_api_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(symbol_api_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "symbol-api-test/symbol-api-test.c"
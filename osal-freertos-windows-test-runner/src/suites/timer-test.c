@@ -0,0 +1,15 @@
+/*
+ * timer-test.c
+ *
+ * Builds timer-test/timer-test.c into the test runner, see ut_runner.h.
+ */
+
+#include "ut_runner.h"
+
+#define UT_RUNNER_SUITE         timer_test
+#include "ut_runner_local.h"
+
+#define OS_Application_Startup  UT_RUNNER_STARTUP(timer_test)
+#define OS_API_Init             UT_Runner_APIInit
+
+#include "timer-test/timer-test.c"
@@ -0,0 +1,16 @@
+/*
+ * simplestaticloaderstubs.c
+ *
+ *  Created on: Feb 1, 2019
+ *      Author: Jonathan Brandenburg
+ */
+
+#include "simplestaticloaderstubs.h"
+
+void stub1() {
+
+}
+
+void stub2() {
+
+}
@@ -0,0 +1,15 @@
+/*
+ * simplestaticloaderstubs.h
+ *
+ *  Created on: Feb 1, 2019
+ *      Author: Jonathan Brandenburg
+ */
+
+#ifndef OSAL_CORE_SRC_OS_FREERTOS_WINDOWS_SIMPLESTATICLOADERSTUBS_H_
+#define OSAL_CORE_SRC_OS_FREERTOS_WINDOWS_SIMPLESTATICLOADERSTUBS_H_
+
+void stub1();
+
+void stub2();
+
+#endif /* OSAL_CORE_SRC_OS_FREERTOS_WINDOWS_SIMPLESTATICLOADERSTUBS_H_ */
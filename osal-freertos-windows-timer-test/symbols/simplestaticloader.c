@@ -11,26 +11,100 @@
 
 #include "simplestaticloader.inc"
 
-unsigned char SimpleStaticLoadFile(char *translated_path, static_load_file_header_t *symbol_entry) {
-	/*
-	 * Determine the number of known symbols
-	 */
-	int symbol_count = sizeof(known_symbols) / sizeof(known_symbols[0]);
+/*
+ * known_symbols[] is included above, so its size is a compile time constant
+ * and the hash indexes below can be sized from it.  A module may have any
+ * number of rows; its first row is the module header (entry point and
+ * segment addresses), every row adds one symbol to the module.
+ */
+#define SYMBOL_COUNT	(sizeof(known_symbols) / sizeof(known_symbols[0]))
+#define HASH_SLOTS		(2 * SYMBOL_COUNT)
 
+/*
+ * Open addressing indexes, a slot holds a known_symbols[] row + 1, 0 is empty.
+ * module_hash has one slot per distinct module name (pointing at its first
+ * row), symbol_hash one per distinct symbol name.  Rows that repeat a symbol
+ * name of another module are chained through symbol_next.
+ */
+static int module_hash[HASH_SLOTS];
+static int symbol_hash[HASH_SLOTS];
+static int symbol_next[SYMBOL_COUNT];
+static int module_first[SYMBOL_COUNT];
+static int module_refs[SYMBOL_COUNT];
+
+static unsigned long SimpleStaticHash(const char *name) {
 	/*
-	 * Find the desired file path in the list of known symbols
+	 * FNV-1a
 	 */
-	int i;
-	for (i = 0; i < symbol_count; ++i) {
-		if (strcmp (translated_path, known_symbols[i].module_name) == 0) {
+	unsigned long hash = 2166136261UL;
+
+	while (*name != '\0') {
+		hash ^= (unsigned char) *name++;
+		hash *= 16777619UL;
+	}
+
+	return hash;
+}
+
+/*
+ * Return the slot that holds "name" or the empty slot where it belongs.
+ * "module" selects which of the two names of a row is the key.
+ */
+static int *SimpleStaticFindSlot(int *table, const char *name, int module) {
+	unsigned long slot = SimpleStaticHash(name) % HASH_SLOTS;
+	const char *key;
+
+	while (table[slot] != 0) {
+		key = module ? known_symbols[table[slot] - 1].module_name : known_symbols[table[slot] - 1].entry_point_name;
+		if (strcmp(name, key) == 0) {
 			break;
 		}
+		slot = (slot + 1) % HASH_SLOTS;
 	}
 
+	return &table[slot];
+}
+
+void SimpleStaticLoaderInit(void) {
+	int i;
+	int *slot;
+
+	memset(module_hash, 0, sizeof(module_hash));
+	memset(symbol_hash, 0, sizeof(symbol_hash));
+	memset(module_refs, 0, sizeof(module_refs));
+
+	/*
+	 * Insert in reverse so the first row of a module and the first row of
+	 * a repeated symbol name end up at the head of their entries.
+	 */
+	for (i = (int) SYMBOL_COUNT - 1; i >= 0; --i) {
+		slot = SimpleStaticFindSlot(module_hash, known_symbols[i].module_name, 1);
+		*slot = i + 1;
+
+		slot = SimpleStaticFindSlot(symbol_hash, known_symbols[i].entry_point_name, 0);
+		symbol_next[i] = *slot - 1;
+		*slot = i + 1;
+	}
+
+	for (i = 0; i < (int) SYMBOL_COUNT; ++i) {
+		module_first[i] = *SimpleStaticFindSlot(module_hash, known_symbols[i].module_name, 1) - 1;
+	}
+}
+
+uint32 GetSymbolCount() {
+	return SYMBOL_COUNT;
+}
+
+unsigned char SimpleStaticLoadFile(char *translated_path, static_load_file_header_t *symbol_entry) {
+	/*
+	 * Find the desired file path in the list of known symbols
+	 */
+	int i = *SimpleStaticFindSlot(module_hash, translated_path, 1) - 1;
+
 	/*
 	 * If file path was not found...
 	 */
-	if (i >= symbol_count) {
+	if (i < 0) {
 		return 0;
 	}
 
@@ -49,5 +123,80 @@ unsigned char SimpleStaticLoadFile(char *translated_path, static_load_file_heade
 	symbol_entry->bss_target = known_symbols[i].bss_target;
 	symbol_entry->bss_size = known_symbols[i].bss_size;
 	symbol_entry->flags = known_symbols[i].flags;
+
+	/*
+	 * The symbols of the module can be looked up from now on
+	 */
+	++module_refs[i];
+	return 1;
+}
+
+void SimpleStaticUnloadFile(const char *module_name) {
+	int i = *SimpleStaticFindSlot(module_hash, module_name, 1) - 1;
+
+	if (i >= 0 && module_refs[i] > 0) {
+		--module_refs[i];
+	}
+}
+
+unsigned char SimpleStaticLookupSymbol(const char *symbol_name, cpuaddr *symbol_address) {
+	/*
+	 * Walk the rows with this symbol name until one belongs to a loaded module
+	 */
+	int i = *SimpleStaticFindSlot(symbol_hash, symbol_name, 0) - 1;
+
+	while (i >= 0) {
+		if (module_refs[module_first[i]] > 0) {
+			*symbol_address = known_symbols[i].entry_point;
+			return 1;
+		}
+		i = symbol_next[i];
+	}
+
+	return 0;
+}
+
+unsigned char SimpleStaticGetSymbol(uint32 index, const char **symbol_name, cpuaddr *symbol_address) {
+	/*
+	 * Enumerate every row of known_symbols[], loaded or not
+	 */
+	if (index >= SYMBOL_COUNT) {
+		return 0;
+	}
+
+	*symbol_name = known_symbols[index].entry_point_name;
+	*symbol_address = known_symbols[index].entry_point;
 	return 1;
 }
+
+unsigned char SimpleStaticFindSymbol(const char *module_name, const char *symbol_name, cpuaddr *symbol_address) {
+	/*
+	 * Like SimpleStaticLookupSymbol, but for one module whether it is loaded or not
+	 */
+	int module = *SimpleStaticFindSlot(module_hash, module_name, 1) - 1;
+	int i = *SimpleStaticFindSlot(symbol_hash, symbol_name, 0) - 1;
+
+	while (module >= 0 && i >= 0) {
+		if (module_first[i] == module) {
+			*symbol_address = known_symbols[i].entry_point;
+			return 1;
+		}
+		i = symbol_next[i];
+	}
+
+	return 0;
+}
+
+uint32 SimpleStaticGetStartup(const static_startup_entry_t **entries) {
+	/*
+	 * The startup table is optional, a .inc that has one also defines
+	 * SIMPLE_STATIC_STARTUP
+	 */
+#ifdef SIMPLE_STATIC_STARTUP
+	*entries = known_startup;
+	return sizeof(known_startup) / sizeof(known_startup[0]);
+#else
+	*entries = NULL;
+	return 0;
+#endif
+}
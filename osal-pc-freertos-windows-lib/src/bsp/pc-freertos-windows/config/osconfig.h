@@ -50,6 +50,25 @@
  */
 #define OS_MAX_API_NAME     configMAX_TASK_NAME_LEN
 
+/*
+ ** Size of the buffer of streams opened with OS_FILE_FLAG_BUFFERED.  Must be a multiple of the
+ ** 512 byte RAM disk sector size.
+ */
+#define OS_FREERTOS_FILE_BUFFER_SIZE    4096
+
+/*
+ ** OS_writev gathers runs of elements up to this many bytes into one write, and OS_readv reads
+ ** requests up to this size with one read.  The staging buffer is on the caller's stack.
+ */
+#define OS_FREERTOS_IOV_STAGE_SIZE      512
+
+/*
+ ** OS_FileCopy, and OS_FileMove between volumes, move data in chunks of up to this many bytes,
+ ** rounded down to whole clusters of the RAM disks involved.  The chunk is taken from the heap
+ ** for the duration of the copy.  Copies between host (FS_BASED) files are left to the host.
+ */
+#define OS_FREERTOS_FILE_COPY_CHUNK     (64 * 1024)
+
 /*
  * Because the names used in cFS are often longer than expected by FreeRTOS
  * we use a "mapping" to shorter FreeRTOS object names.
@@ -104,6 +123,21 @@
 /* some room is left for other lower priority tasks */
 #define OS_UTILITYTASK_PRIORITY   (configMAX_PRIORITIES - 5)
 
+/*
+ ** OSAL task priorities (0 highest .. 255 lowest) are mapped to FreeRTOS priorities through a
+ ** lookup table.  By default the OSAL range is spread linearly over the FreeRTOS levels from
+ ** OS_FREERTOS_LOWEST_TASK_PRIORITY up to configMAX_PRIORITIES - 1, less the number of levels
+ ** reserved at the top by OS_FREERTOS_RESERVED_PRIORITIES.  Reserved levels are never given to
+ ** OSAL tasks, so they stay free for the timer service task and the port's own utility tasks.
+ **
+ ** Define OS_FREERTOS_BSP_PRIORITY_MAP to supply the whole table from the BSP instead, as
+ **     const uint8 OS_BSP_PriorityMap[256];
+ ** indexed by the OSAL priority.
+ */
+#define OS_FREERTOS_LOWEST_TASK_PRIORITY    0
+#define OS_FREERTOS_RESERVED_PRIORITIES     0
+/* #define OS_FREERTOS_BSP_PRIORITY_MAP */
+
 /* 
  ** the size of a command that can be passed to the underlying OS
  */
@@ -116,6 +150,49 @@
  */
 #undef OS_INCLUDE_NETWORK
 
+/*
+ ** The number of persistent event sets that can exist at a time, see OS_EventSetCreate.
+ ** Only used with OS_INCLUDE_NETWORK.
+ */
+#define OS_FREERTOS_MAX_EVENT_SETS  4
+
+/*
+ ** How long OS_EventSetWait stays in FreeRTOS_select at a time, in milliseconds.  A
+ ** delete of the set ends the waits on it within this time.  Only used with
+ ** OS_INCLUDE_NETWORK.
+ */
+#define OS_FREERTOS_EVENT_SET_POLL_MSEC  100
+
+/*
+ ** The number of memory pools that can exist at a time, see OS_MemPoolCreate.
+ */
+#define OS_FREERTOS_MAX_MEMPOOLS    8
+
+/*
+ ** The number of event flags objects that can exist at a time, see OS_EventFlagsCreate.
+ */
+#define OS_FREERTOS_MAX_EVENT_FLAGS 16
+
+/*
+ ** The number of pipes that can exist at a time, see OS_PipeCreate.  At most 32, since
+ ** OS_SelectMultiple keeps them in a 32 bit mask; ospipe.c stops the build otherwise.
+ ** Each pipe is also an open stream, counted in OS_MAX_NUM_OPEN_FILES.
+ */
+#define OS_FREERTOS_MAX_PIPES       8
+
+/*
+ ** How often OS_SelectMultiple checks the pipes in its sets while it waits for
+ ** sockets as well, in milliseconds.  Only used with OS_INCLUDE_NETWORK.
+ */
+#define OS_FREERTOS_PIPE_SELECT_POLL_MSEC  10
+
+/*
+ ** The number of wait sets that can exist at a time, and the number of queues
+ ** and semaphores each can hold, see OS_WaitSetCreate.
+ */
+#define OS_FREERTOS_MAX_WAIT_SETS         4
+#define OS_FREERTOS_WAIT_SET_MAX_MEMBERS  16
+
 /* 
  ** This is the maximum number of open file descriptors allowed at a time
  */
@@ -155,6 +232,14 @@
  */
 /* #define OS_STATIC_LOADER */
 
+/*
+ ** OS_ModuleStartup runs the init functions of the startup table in simplestaticloader.inc on
+ ** up to OS_FREERTOS_STARTUP_MAX_WORKERS tasks, each with a stack of
+ ** OS_FREERTOS_STARTUP_STACK_SIZE words.
+ */
+#define OS_FREERTOS_STARTUP_MAX_WORKERS     8
+#define OS_FREERTOS_STARTUP_STACK_SIZE      ( configMINIMAL_STACK_SIZE * 8 )
+
 #endif
 
 /*
@@ -183,10 +268,156 @@
  */
 #define OS_MAX_TIMERS         5
 
+/*
+ ** Simulated timebases are normally driven by one FreeRTOS software timer each, expiring in
+ ** the timer service task.  Define OS_FREERTOS_TIMEBASE_DISPATCH to drive all of them from a
+ ** single dispatch task instead, which keeps the armed timebases in expiry order and sleeps
+ ** until the earliest one is due.  No software timer is created per timebase, which suits
+ ** configurations with a large OS_MAX_TIMEBASES.
+ **
+ ** Every timebase still has its own servicing task, since that is where the OSAL calls the
+ ** timer callbacks.  OS_FREERTOS_TIMEBASE_STACK_SIZE sets its stack size.
+ */
+/* #define OS_FREERTOS_TIMEBASE_DISPATCH */
+#define OS_FREERTOS_TIMEBASE_STACK_SIZE     configTIMER_TASK_STACK_DEPTH
+
+/*
+ ** Simulated timebases run on whole FreeRTOS ticks, so e.g. a 250 usec interval becomes one
+ ** tick.  Define OS_FREERTOS_TIMEBASE_HIRES to drive them from a Win32 thread with a high
+ ** resolution waitable timer instead, which releases the servicing tasks through the simulated
+ ** interrupt OS_FREERTOS_TIMEBASE_HIRES_INTERRUPT (2 and up, not used by anything else).  The
+ ** thread sleeps until OS_FREERTOS_TIMEBASE_HIRES_SPIN_USEC before an expiry and spins on the
+ ** performance counter for the rest, trading host CPU for precision.
+ **
+ ** Cannot be combined with OS_FREERTOS_TIMEBASE_DISPATCH, nor used when running in lockstep
+ ** with a simulation driver, where time has to follow the tick.
+ */
+/* #define OS_FREERTOS_TIMEBASE_HIRES */
+#define OS_FREERTOS_TIMEBASE_HIRES_INTERRUPT    8
+#define OS_FREERTOS_TIMEBASE_HIRES_SPIN_USEC    200
+
+/*
+ ** Define OS_FREERTOS_TIMEBASE_EXTERNAL to enable OS_TimeBaseCreateExternal, which makes a
+ ** timebase follow a clock outside the application, e.g. a simulator or hardware-in-the-loop
+ ** driver: one expiry per signal of a named Win32 event, or per increment of a 32 bit
+ ** counter in a named shared memory section.  A Win32 thread waits on the events and reads
+ ** the counters every OS_FREERTOS_TIMEBASE_EXTERNAL_POLL_MSEC, and releases the servicing
+ ** tasks through the simulated interrupt OS_FREERTOS_TIMEBASE_EXTERNAL_INTERRUPT (2 and up,
+ ** not used by anything else).  Can be combined with either timebase option above, which
+ ** only concern the simulated timebases.  The thread waits on all the events at once, so
+ ** OS_MAX_TIMEBASES must stay below MAXIMUM_WAIT_OBJECTS (64); ostimer.c stops the build
+ ** otherwise.
+ */
+/* #define OS_FREERTOS_TIMEBASE_EXTERNAL */
+#define OS_FREERTOS_TIMEBASE_EXTERNAL_INTERRUPT 11
+#define OS_FREERTOS_TIMEBASE_EXTERNAL_POLL_MSEC 1
+
+/*
+ ** Host (FS_BASED) files are accessed with Win32 overlapped I/O.  A Win32 thread takes the
+ ** completions off a completion port and releases the waiting tasks through the simulated
+ ** interrupt OS_FREERTOS_HOSTFILE_INTERRUPT (2 and up, not used by anything else).
+ */
+#define OS_FREERTOS_HOSTFILE_INTERRUPT          9
+
+/*
+ ** Define OS_FREERTOS_NET_SHM to build the shared memory virtual network interface in
+ ** osvnic.c, and leave the WinPCap NetworkInterface.c of FreeRTOS+TCP out of the build.
+ ** The instances on one host then exchange Ethernet frames through the shared memory
+ ** section OS_FREERTOS_NET_SHM_NAME, needing neither an adapter nor admin rights.  Each
+ ** instance receives on a ring of OS_FREERTOS_NET_SHM_RING_FRAMES frames, signalled
+ ** through the simulated interrupt OS_FREERTOS_NET_SHM_INTERRUPT (2 and up, not used by
+ ** anything else), and at most OS_FREERTOS_NET_SHM_MAX_NODES instances can attach.  Every
+ ** instance needs its own MAC and IP address, see the -a and -m options of the test BSPs.
+ */
+/* #define OS_FREERTOS_NET_SHM */
+#define OS_FREERTOS_NET_SHM_NAME                "Local\\OSAL_FreeRTOS_VNIC"
+#define OS_FREERTOS_NET_SHM_MAX_NODES           8
+#define OS_FREERTOS_NET_SHM_RING_FRAMES         64
+#define OS_FREERTOS_NET_SHM_INTERRUPT           10
+
+/*
+ ** The remaining simulated interrupts, 2 to 31 less the ones above, are free for
+ ** OS_IntAttachHandler.
+ */
+
+/*
+ ** Define OS_FREERTOS_FILE_ASYNC to enable OS_FileAsyncSubmit.  Up to OS_FREERTOS_FILE_ASYNC_DEPTH
+ ** requests wait for a single worker task running at FreeRTOS priority
+ ** OS_FREERTOS_FILE_ASYNC_PRIORITY with a stack of OS_FREERTOS_FILE_ASYNC_STACK_SIZE words.
+ */
+/* #define OS_FREERTOS_FILE_ASYNC */
+#define OS_FREERTOS_FILE_ASYNC_DEPTH            16
+#define OS_FREERTOS_FILE_ASYNC_PRIORITY         1
+#define OS_FREERTOS_FILE_ASYNC_STACK_SIZE       ( configMINIMAL_STACK_SIZE * 4 )
+
+/*
+ ** OS_ShellOutputToFile runs each command in a worker task at FreeRTOS priority
+ ** OS_FREERTOS_SHELL_PRIORITY with a stack of OS_FREERTOS_SHELL_STACK_SIZE words, which writes
+ ** the output into the file OS_FREERTOS_SHELL_CHUNK bytes at most at a time as it comes.  The
+ ** caller pends meanwhile, for at most OS_FREERTOS_SHELL_TIMEOUT_MSEC, after which the command
+ ** is stopped and OS_FS_ERROR returned.  The commands help, tasks, queues, heap and cpu are
+ ** built in; define OS_FREERTOS_SHELL_HOST to run any other command with cmd.exe on the host.
+ */
+/* #define OS_FREERTOS_SHELL_HOST */
+#define OS_FREERTOS_SHELL_PRIORITY              1
+#define OS_FREERTOS_SHELL_STACK_SIZE            ( configMINIMAL_STACK_SIZE * 4 )
+#define OS_FREERTOS_SHELL_CHUNK                 4096
+#define OS_FREERTOS_SHELL_TIMEOUT_MSEC          10000
+
+/*
+ ** The first RAM disk formatted with a given geometry (sector count, sector size and the
+ ** OS_ramdisk_params_t cluster options) is kept as a template of its formatted sectors, and
+ ** RAM disks with the same geometry made later are stamped from it instead of being formatted.
+ ** Up to OS_FREERTOS_RAMDISK_TEMPLATES geometries are kept, 0 formats every RAM disk.
+ */
+#define OS_FREERTOS_RAMDISK_TEMPLATES           4
+
+/*
+ ** Default FreeRTOS+FAT cache of a RAM disk, in bytes, for devices not set up with
+ ** OS_FileSysRamDiskConfigure.
+ */
+#define OS_FREERTOS_RAMDISK_CACHE_SIZE          1024
+
+/*
+ ** RAM disk storage comes from the FreeRTOS heap unless OS_FREERTOS_FS_ARENA_SIZE is defined.
+ ** It is then taken from the host with VirtualAlloc, up to that many bytes for all RAM disks,
+ ** and configTOTAL_HEAP_SIZE only has to cover kernel objects and their buffers.  Define
+ ** OS_FREERTOS_FS_ARENA_LARGE_PAGES as well to use large pages where the process holds
+ ** SeLockMemoryPrivilege.
+ */
+/* #define OS_FREERTOS_FS_ARENA_SIZE               (256 * 1024 * 1024) */
+/* #define OS_FREERTOS_FS_ARENA_LARGE_PAGES */
+
 /*
  ** This define sets the maximum number of open directories
  */
-#define OS_MAX_NUM_OPEN_DIRS  4
+#define OS_MAX_NUM_OPEN_DIRS  16
+
+/*
+ ** RAM disk directories are listed once into a heap snapshot that OS_DirRead and OS_DirRewind
+ ** are served from, and that later opens of the same directory share.  A create, remove or
+ ** rename in the directory invalidates it.  OS_FREERTOS_DIR_SNAPSHOTS is the number of
+ ** snapshots kept, at least OS_MAX_NUM_OPEN_DIRS.  Without it every open directory carries a
+ ** FreeRTOS+FAT search state of several hundred bytes and reads the disk on each entry.
+ */
+#define OS_FREERTOS_DIR_SNAPSHOTS   16
+
+/*
+ ** Read-only opens can be served from a cache of whole file contents, on RAM disks and host
+ ** (FS_BASED) volumes alike.  An entry is kept by local path and used while the file's size and
+ ** modification time match; remove, rename and write opens through OSAL invalidate it at once,
+ ** and a file is not cached while a stream has it open for writing.  Files are loaded on the
+ ** first read-only open, if no larger than OS_FREERTOS_FILE_CACHE_MAX_FILE bytes.  At most
+ ** OS_FREERTOS_FILE_CACHE_ENTRIES files and OS_FREERTOS_FILE_CACHE_BYTES bytes of contents are
+ ** kept; the least recently opened entries that no stream is reading make room for new ones.
+ */
+/* #define OS_FREERTOS_FILE_CACHE */
+
+#ifdef OS_FREERTOS_FILE_CACHE
+#define OS_FREERTOS_FILE_CACHE_ENTRIES      16
+#define OS_FREERTOS_FILE_CACHE_BYTES        (1024 * 1024)
+#define OS_FREERTOS_FILE_CACHE_MAX_FILE     (256 * 1024)
+#endif
 
 /*
  ** This define sets the maximum depth of an OSAL message queue.  On some implementations this may
@@ -195,6 +426,229 @@
  */
 #define OS_QUEUE_MAX_DEPTH    50
 
+/*
+ ** This define sets how many buffers a queue allocates beyond its depth.  The spare
+ ** buffers let producers fill a message, and consumers hold one, while the queue itself
+ ** is full.  Copy-mode queues use them for the messages being copied in and out.
+ */
+#define OS_QUEUE_SPARE_BUFFERS    4
+
+/*
+ ** Static object allocation is optional.  When defined, queues, semaphores, mutexes and
+ ** the OSAL table locks are created with the FreeRTOS *Static() calls, using control blocks
+ ** and storage reserved in the OSAL tables at link time.  Object creation then never touches
+ ** the FreeRTOS heap.
+ */
+/* #define OS_FREERTOS_STATIC_OBJECTS */
+
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+/*
+ ** This define sets the largest message size that a queue can be created with when static
+ ** object allocation is used.  Every queue reserves room for
+ ** (OS_QUEUE_MAX_DEPTH + OS_QUEUE_SPARE_BUFFERS) messages of this size.
+ */
+#define OS_QUEUE_STATIC_MAX_SIZE    256
+
+/*
+ ** This define sets the largest pipe that can be created with static object allocation.
+ ** Every pipe reserves this many bytes.
+ */
+#define OS_FREERTOS_PIPE_STATIC_MAX_SIZE    4096
+
+#endif
+
+/*
+ ** Static task allocation is optional.  When defined, tasks are created with xTaskCreateStatic
+ ** from a pool of OS_MAX_TASKS task control blocks and stacks reserved at link time, so that
+ ** creating and deleting tasks does not allocate from or fragment the FreeRTOS heap.
+ ** A task that asks for a larger stack than the pool provides, or that is created while every
+ ** pool slot is still in use, falls back to a heap allocated stack.
+ */
+/* #define OS_FREERTOS_STATIC_TASKS */
+
+#ifdef OS_FREERTOS_STATIC_TASKS
+/*
+ ** This define sets the stack size of each task pool slot, in the same units as the stack
+ ** size passed to OS_TaskCreate.  On the Windows simulator the tasks run on their own Win32
+ ** thread stacks, so this only has to cover what the FreeRTOS kernel itself keeps there.
+ */
+#define OS_TASK_STATIC_STACK_SIZE   16384
+
+#endif
+
+/*
+ ** Task recycling is optional.  When defined, a task that returns from its entry point or
+ ** calls OS_TaskExit is parked instead of deleted, and a later OS_TaskCreate with the same
+ ** stack size hands the parked task the new entry point instead of creating one, so respawning
+ ** a worker costs a task notification rather than a TCB and stack allocation.  A task pool
+ ** task from OS_FREERTOS_STATIC_TASKS can take any stack size up to OS_TASK_STATIC_STACK_SIZE.
+ ** A parked task is still a FreeRTOS task, keeps the name it was first created with in kernel
+ ** listings, and holds its task pool slot while parked.  Tasks deleted with OS_TaskDelete are
+ ** never parked.  Tasks that exit while the park is full, and tasks that delete themselves, are
+ ** deleted from the timer service task, so their memory goes back to the heap straight away
+ ** rather than whenever the idle task next runs.
+ */
+/* #define OS_FREERTOS_TASK_RECYCLE */
+
+#ifdef OS_FREERTOS_TASK_RECYCLE
+/*
+ ** This define sets the most tasks that can be parked at once
+ */
+#define OS_FREERTOS_TASK_RECYCLE_PARKED     8
+
+#endif
+
+/*
+ ** Length of the window over which OS_TaskGetStats reports the CPU usage of a task, in
+ ** milliseconds of run time counter time.  A new window starts on the first poll after the
+ ** previous one has run this long, so the housekeeping poll rate should be at least this fast.
+ */
+#define OS_FREERTOS_CPU_WINDOW_MSEC     1000
+
+/*
+ ** Length of the window over which OS_CpuLoadGet reports the load of the whole CPU, in
+ ** milliseconds of run time counter time, and the number of windows its peak load covers.
+ */
+#define OS_FREERTOS_CPU_LOAD_WINDOW_MSEC    1000
+#define OS_FREERTOS_CPU_LOAD_PEAK_WINDOWS   60
+
+/*
+ ** Tasks run on the stacks of their Win32 threads, so FreeRTOS stack overflow checking cannot
+ ** work in this port.  Define OS_FREERTOS_STACK_MONITOR to paint the OSAL stack size of every
+ ** task on its thread stack when the task starts, and report the peak use in OS_TaskGetStats.
+ ** A monitor task at FreeRTOS priority OS_FREERTOS_STACK_MONITOR_PRIORITY samples all tasks
+ ** every OS_FREERTOS_STACK_MONITOR_MSEC and prints a warning when a task passes
+ ** OS_FREERTOS_STACK_MONITOR_WARN_PERCENT of its stack size, and another when it uses all of it.
+ */
+/* #define OS_FREERTOS_STACK_MONITOR */
+#define OS_FREERTOS_STACK_MONITOR_MSEC          1000
+#define OS_FREERTOS_STACK_MONITOR_PRIORITY      1
+#define OS_FREERTOS_STACK_MONITOR_STACK_SIZE    ( configMINIMAL_STACK_SIZE * 4 )
+#define OS_FREERTOS_STACK_MONITOR_WARN_PERCENT  90
+
+/*
+ ** Number of FreeRTOS tasks OS_TaskProfileSnapshot can capture in one snapshot.  Besides the
+ ** OSAL tasks this has to cover the kernel's idle and timer service tasks and the port's own
+ ** utility tasks.
+ */
+#define OS_FREERTOS_PROFILE_MAX_TASKS   (OS_MAX_TASKS + 8)
+
+/*
+ ** Sizing of the console output path.  OS_ConsoleWriteFast copies each message into one slot of
+ ** a lock-free ring of OS_FREERTOS_CONSOLE_FAST_SLOTS slots (a power of two) of
+ ** OS_FREERTOS_CONSOLE_SLOT_SIZE bytes; longer messages are cut to fit and a full ring drops the
+ ** message instead of blocking.  The console task gathers everything pending into writes of up
+ ** to OS_FREERTOS_CONSOLE_WRITE_SIZE bytes.
+ */
+#define OS_FREERTOS_CONSOLE_FAST_SLOTS  256
+#define OS_FREERTOS_CONSOLE_SLOT_SIZE   128
+#define OS_FREERTOS_CONSOLE_WRITE_SIZE  4096
+
+/*
+ ** The console task is woken once per burst of output rather than once per message.  When
+ ** OS_FREERTOS_CONSOLE_FLUSH_MSEC is above 0 it also waits that long after a wakeup before
+ ** draining, so that chatty output is gathered into fewer, larger writes at the cost of that
+ ** much extra latency.
+ */
+#define OS_FREERTOS_CONSOLE_FLUSH_MSEC  0
+
+/*
+ ** Binary log channel, see OS_ConsoleLog.  Records are queued in a lock-free ring of
+ ** OS_FREERTOS_CONSOLE_LOG_SLOTS entries (a power of two) and format ids below
+ ** OS_FREERTOS_CONSOLE_LOG_FORMATS can be given a format.  When OS_FREERTOS_CONSOLE_LOG_OFFLINE is
+ ** defined the console task leaves the records alone and the application collects them with
+ ** OS_ConsoleLogRead.
+ */
+#define OS_FREERTOS_CONSOLE_LOG_SLOTS   256
+#define OS_FREERTOS_CONSOLE_LOG_FORMATS 64
+/* #define OS_FREERTOS_CONSOLE_LOG_OFFLINE */
+
+/*
+ ** Console sinks, see OS_ConsoleSinkAdd.  Each of the at most OS_FREERTOS_CONSOLE_MAX_SINKS sinks
+ ** buffers OS_FREERTOS_CONSOLE_SINK_BUFFER bytes (a power of two) for its drain task; a shared
+ ** memory sink maps OS_FREERTOS_CONSOLE_SHM_SIZE bytes of text.
+ */
+#define OS_FREERTOS_CONSOLE_MAX_SINKS   4
+#define OS_FREERTOS_CONSOLE_SINK_BUFFER 16384
+#define OS_FREERTOS_CONSOLE_SHM_SIZE    65536
+
+/*
+ ** Semaphore contention statistics are optional.  When defined, binary and counting semaphores
+ ** count the takes that had to block and time the waits with the run time stats counter.
+ ** The figures are read with OS_BinSemGetStats/OS_CountSemGetStats.
+ */
+/* #define OS_FREERTOS_SEM_STATS */
+
+/*
+ ** Binary semaphores keep their value and a list of waiting tasks, so OS_BinSemFlush can release
+ ** all the waiters at once.  A waiter sleeps on a kernel binary semaphore on its own stack.
+ ** Define OS_FREERTOS_SEM_NOTIFY to have it sleep on task notification index
+ ** OS_FREERTOS_NOTIFY_SEM_INDEX instead, which needs FreeRTOS V10.4 or later.  It also enables the
+ ** OS_SEM_TASK_NOTIFY option of OS_CountSemCreate, which is ignored otherwise.
+ */
+/* #define OS_FREERTOS_SEM_NOTIFY */
+
+/*
+ ** Timebase latency statistics are optional.  When defined, every simulated timebase compares
+ ** the time its servicing task wakes up with the nominal expiry time and keeps the latency
+ ** range, mean and a histogram, plus the number of expiries that were coalesced because the
+ ** previous one had not been serviced yet.  The figures are read with OS_TimeBaseGetStats.
+ */
+/* #define OS_FREERTOS_TIMEBASE_STATS */
+
+/*
+ ** Table lock profiling is optional.  When defined, every exclusive acquire of an OSAL table
+ ** lock (one per object type) is counted and the waits are timed with the run time stats
+ ** counter.  The figures are read with OS_GlobalLockGetStats or printed with
+ ** OS_GlobalLockStatsDump.
+ */
+/* #define OS_FREERTOS_LOCK_PROFILING */
+
+/*
+ ** OSAL call statistics are optional.  When defined, the *_Impl functions of the task, queue,
+ ** semaphore, mutex, file, directory and socket APIs count their calls and errors and time
+ ** them with OS_GetMonotonicNsec.  The first OS_FREERTOS_API_STATS_ERRORS different error
+ ** codes of each call are counted separately.  The figures are read with OS_ApiStatsGet or
+ ** printed with OS_ApiStatsDump.
+ */
+/* #define OS_FREERTOS_API_STATS */
+#define OS_FREERTOS_API_STATS_ERRORS    4
+
+/*
+ ** Heap attribution is optional and is switched on with configFREERTOS_SIM_HEAP_ATTRIBUTION in
+ ** FreeRTOSConfig.h.  The heap blocks allocated while creating tasks, queues, semaphores, file
+ ** systems, sockets and timebases are then remembered in a table of OS_FREERTOS_HEAP_TRACK_SLOTS
+ ** entries (a power of two) so OS_HeapGetStats can report the bytes held by each object type.
+ ** Blocks that do not fit in the table are reported as other.
+ */
+#define OS_FREERTOS_HEAP_TRACK_SLOTS    4096
+
+/*
+ ** Crash records are optional and are switched on with configFREERTOS_SIM_CRASH_RECORD in
+ ** FreeRTOSConfig.h.  Each record is printed and appended to OS_FREERTOS_CRASH_RECORD_PATH,
+ ** which has to be on a FS_BASED volume so it outlives the run.  It lists the last
+ ** OS_FREERTOS_CRASH_HISTORY heap operations.
+ */
+#define OS_FREERTOS_CRASH_RECORD_PATH   "./cf/crash-record.txt"
+#define OS_FREERTOS_CRASH_HISTORY       16
+
+/*
+ ** The startup trace is optional, see OS_StartupPhaseBegin.  When OS_FREERTOS_STARTUP_TRACE is
+ ** defined the last OS_FREERTOS_STARTUP_TRACE_SLOTS phases are kept and printed by
+ ** OS_StartupReport.
+ */
+/* #define OS_FREERTOS_STARTUP_TRACE */
+#define OS_FREERTOS_STARTUP_TRACE_SLOTS 64
+
+/*
+ ** Event tracing is optional and is switched on with configFREERTOS_SIM_EVENT_TRACE in
+ ** FreeRTOSConfig.h.  The last OS_FREERTOS_TRACE_EVENTS events (a power of two, 32 bytes each)
+ ** are kept for OS_TraceDump, older ones are overwritten.  The names of the last
+ ** OS_FREERTOS_TRACE_TASK_NAMES tasks created (a power of two) are kept to label the tasks.
+ */
+#define OS_FREERTOS_TRACE_EVENTS        65536
+#define OS_FREERTOS_TRACE_TASK_NAMES    128
+
 /*
  * If OS_DEBUG_PRINTF is defined, this will enable the "OS_DEBUG" statements in the code
  * This should be left disabled in a normal build as it may affect real time performance as
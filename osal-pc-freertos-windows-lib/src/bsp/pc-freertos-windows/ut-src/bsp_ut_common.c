@@ -0,0 +1,281 @@
+/******************************************************************************
+ ** File:  bsp_ut_common.c
+ **
+ ** Purpose:
+ ** Code shared by the unit test BSPs (bsp_ut.c) of the FreeRTOS test projects
+ ******************************************************************************/
+
+/*
+ * NOTE - This entire source file is only relevant for unit testing.
+ * Nothing in it is referenced by a "normal" BSP build, so it is not linked in.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "FreeRTOS.h"
+
+#include "common_types.h"
+#include "osapi.h"
+#include "osapi-os-freertos.h"
+#include "utassert.h"
+
+#include "bsp_ut_common.h"
+
+/*
+ **  Local Variables
+ */
+static uint32 SchedulerPhase = OS_STARTUP_PHASE_NONE;
+static bool StartupReported = false;
+
+/*
+ **  Machine readable report, selected with -r json or -r csv, so runs can be
+ **  compared without scraping the console.  One record per line in CSV, the
+ **  first column names the record and JSON uses the same keys:
+ **    host,<program>,<host>,<cpus>,<tick_hz>,<osal>,<date>
+ **    segment,<segment>,<name>,<usec>,<total>,<pass>,<fail>,<mir>,<tsf>,<na>
+ **    bench,<segment>,<name>,<unit>,<value>...    (the "BENCH," lines of a test)
+ **    summary,<segments>,<usec>,<total>,<pass>,<fail>,<mir>,<tsf>,<na>
+ */
+#define UT_BSP_REPORT_NONE	0
+#define UT_BSP_REPORT_JSON	1
+#define UT_BSP_REPORT_CSV	2
+
+static uint32 ReportFormat = UT_BSP_REPORT_NONE;
+static const char *ReportPath = NULL;
+static const char *ReportProgram = "";
+static FILE *ReportFile = NULL;
+static uint32 ReportRecords;
+static uint32 ReportSegment;
+static uint64 ReportSegmentStart;
+static uint64 ReportTestStart;
+
+static void UT_BSP_ReportString(const char *Text) {
+	/* JSON string, CSV fields are quoted the same way less the escapes */
+	fputc('"', ReportFile);
+	while (*Text != '\0') {
+		if (*Text == '"' || (*Text == '\\' && ReportFormat == UT_BSP_REPORT_JSON)) {
+			fputc(ReportFormat == UT_BSP_REPORT_JSON ? '\\' : '"', ReportFile);
+			fputc(*Text, ReportFile);
+		} else if ((unsigned char) *Text >= ' ') {
+			fputc(*Text, ReportFile);
+		}
+		++Text;
+	}
+	fputc('"', ReportFile);
+}
+
+static void UT_BSP_ReportBegin(const char *Type) {
+	if (ReportFormat == UT_BSP_REPORT_JSON) {
+		fprintf(ReportFile, "%s\n    {\"type\": \"%s\"", (ReportRecords > 0) ? "," : "", Type);
+	} else {
+		fprintf(ReportFile, "%s", Type);
+	}
+	++ReportRecords;
+}
+
+static void UT_BSP_ReportField(const char *Key, const char *Value) {
+	if (ReportFormat == UT_BSP_REPORT_JSON) {
+		fprintf(ReportFile, ", \"%s\": ", Key);
+	} else {
+		fputc(',', ReportFile);
+	}
+	UT_BSP_ReportString(Value);
+}
+
+static void UT_BSP_ReportNumber(const char *Key, const char *Value) {
+	if (ReportFormat == UT_BSP_REPORT_JSON) {
+		fprintf(ReportFile, ", \"%s\": %s", Key, Value);
+	} else {
+		fprintf(ReportFile, ",%s", Value);
+	}
+}
+
+static void UT_BSP_ReportUnsigned(const char *Key, unsigned long Value) {
+	char Number[24];
+
+	snprintf(Number, sizeof(Number), "%lu", Value);
+	UT_BSP_ReportNumber(Key, Number);
+}
+
+static void UT_BSP_ReportCounters(const UtAssert_TestCounter_t *TestCounters) {
+	UT_BSP_ReportUnsigned("total", (unsigned long) TestCounters->TotalTestCases);
+	UT_BSP_ReportUnsigned("pass", (unsigned long) TestCounters->CaseCount[UTASSERT_CASETYPE_PASS]);
+	UT_BSP_ReportUnsigned("fail", (unsigned long) TestCounters->CaseCount[UTASSERT_CASETYPE_FAILURE]);
+	UT_BSP_ReportUnsigned("mir", (unsigned long) TestCounters->CaseCount[UTASSERT_CASETYPE_MIR]);
+	UT_BSP_ReportUnsigned("tsf", (unsigned long) TestCounters->CaseCount[UTASSERT_CASETYPE_TSF]);
+	UT_BSP_ReportUnsigned("na", (unsigned long) TestCounters->CaseCount[UTASSERT_CASETYPE_NA]);
+}
+
+static void UT_BSP_ReportEnd(void) {
+	fprintf(ReportFile, (ReportFormat == UT_BSP_REPORT_JSON) ? "}" : "\n");
+}
+
+static void UT_BSP_ReportOpen(void) {
+	char Stamp[32];
+	char Version[32];
+	time_t Now = time(NULL);
+	const char *Host = getenv("COMPUTERNAME");
+	const char *Cpus = getenv("NUMBER_OF_PROCESSORS");
+
+	if (ReportPath == NULL) {
+		ReportPath = (ReportFormat == UT_BSP_REPORT_JSON) ? "ut_report.json" : "ut_report.csv";
+	}
+
+	ReportFile = fopen(ReportPath, "w");
+	if (ReportFile == NULL) {
+		fprintf(stderr, "ERROR: Could not open report file %s\n", ReportPath);
+		ReportFormat = UT_BSP_REPORT_NONE;
+		return;
+	}
+
+	strftime(Stamp, sizeof(Stamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&Now));
+
+	if (ReportFormat == UT_BSP_REPORT_JSON) {
+		fprintf(ReportFile, "{\n  \"records\": [");
+	}
+
+	UT_BSP_ReportBegin("host");
+	UT_BSP_ReportField("program", ReportProgram);
+	UT_BSP_ReportField("host", (Host != NULL) ? Host : "");
+	UT_BSP_ReportNumber("cpus", (Cpus != NULL) ? Cpus : "0");
+	UT_BSP_ReportUnsigned("tick_hz", (unsigned long) configTICK_RATE_HZ);
+	snprintf(Version, sizeof(Version), "%d.%d.%d", OS_MAJOR_VERSION, OS_MINOR_VERSION, OS_REVISION);
+	UT_BSP_ReportField("osal", Version);
+	UT_BSP_ReportField("date", Stamp);
+	UT_BSP_ReportEnd();
+
+	fflush(ReportFile);
+}
+
+static void UT_BSP_ReportBench(const char *Line) {
+	char Field[64];
+	const char *Next;
+	uint32 Index = 0;
+	size_t Length;
+
+	/* BENCH,<name>,<unit>,<value>[,<value>...] */
+	UT_BSP_ReportBegin("bench");
+	UT_BSP_ReportUnsigned("segment", (unsigned long) ReportSegment);
+	if (ReportFormat == UT_BSP_REPORT_JSON) {
+		Line += 6;
+	} else {
+		/* Everything after "BENCH" is already CSV */
+		fprintf(ReportFile, "%s\n", Line + 5);
+		return;
+	}
+
+	while (*Line != '\0') {
+		Next = strchr(Line, ',');
+		Length = (Next != NULL) ? (size_t) (Next - Line) : strlen(Line);
+		if (Length >= sizeof(Field)) {
+			Length = sizeof(Field) - 1;
+		}
+		memcpy(Field, Line, Length);
+		Field[Length] = '\0';
+
+		if (Index == 0) {
+			UT_BSP_ReportField("name", Field);
+		} else if (Index == 1) {
+			UT_BSP_ReportField("unit", Field);
+			fprintf(ReportFile, ", \"values\": [");
+		} else {
+			fprintf(ReportFile, "%s%s", (Index > 2) ? ", " : "", Field);
+		}
+		++Index;
+
+		Line += Length;
+		if (*Line == ',') {
+			++Line;
+		}
+	}
+
+	fprintf(ReportFile, (Index > 1) ? "]}" : "}");
+}
+
+/*
+ **  Report hooks, called by the BSPs
+ */
+bool UT_BSP_ReportOption(int Option, const char *Argument) {
+	if (Option == 'o') {
+		ReportPath = Argument;
+		return true;
+	}
+
+	if (strcmp(Argument, "json") == 0) {
+		ReportFormat = UT_BSP_REPORT_JSON;
+		return true;
+	}
+	if (strcmp(Argument, "csv") == 0) {
+		ReportFormat = UT_BSP_REPORT_CSV;
+		return true;
+	}
+
+	return false;
+}
+
+void UT_BSP_ReportStart(const char *Program) {
+	ReportProgram = Program;
+	if (ReportFormat != UT_BSP_REPORT_NONE) {
+		UT_BSP_ReportOpen();
+	}
+}
+
+void UT_BSP_ReportSegmentStart(uint32 SegmentNumber) {
+	ReportSegment = SegmentNumber;
+	ReportSegmentStart = OS_GetMonotonicNsec();
+	if (ReportTestStart == 0) {
+		ReportTestStart = ReportSegmentStart;
+	}
+}
+
+void UT_BSP_ReportText(uint8 MessageType, const char *ShortDesc) {
+	if (ReportFile != NULL && MessageType == UTASSERT_CASETYPE_INFO
+			&& strncmp(ShortDesc, "BENCH,", 6) == 0) {
+		UT_BSP_ReportBench(ShortDesc);
+	}
+}
+
+void UT_BSP_ReportSegment(const char *SegmentName,
+		const UtAssert_TestCounter_t *TestCounters) {
+	if (ReportFile != NULL) {
+		UT_BSP_ReportBegin("segment");
+		UT_BSP_ReportUnsigned("segment", (unsigned long) TestCounters->TestSegmentCount);
+		UT_BSP_ReportField("name", SegmentName);
+		UT_BSP_ReportUnsigned("usec", (unsigned long) ((OS_GetMonotonicNsec() - ReportSegmentStart) / 1000));
+		UT_BSP_ReportCounters(TestCounters);
+		UT_BSP_ReportEnd();
+		fflush(ReportFile);
+	}
+}
+
+void UT_BSP_ReportFinish(const UtAssert_TestCounter_t *TestCounters) {
+	/* Closed before the console summary, which is not a segment of its own */
+	if (ReportFile != NULL) {
+		UT_BSP_ReportBegin("summary");
+		UT_BSP_ReportUnsigned("segments", (unsigned long) TestCounters->TestSegmentCount);
+		UT_BSP_ReportUnsigned("usec", (unsigned long) ((OS_GetMonotonicNsec() - ReportTestStart) / 1000));
+		UT_BSP_ReportCounters(TestCounters);
+		UT_BSP_ReportEnd();
+		if (ReportFormat == UT_BSP_REPORT_JSON) {
+			fprintf(ReportFile, "\n  ]\n}\n");
+		}
+		fclose(ReportFile);
+		ReportFile = NULL;
+	}
+}
+
+void UT_BSP_SchedulerStarting(void) {
+	/* Ended by the test task once it runs */
+	SchedulerPhase = OS_StartupPhaseBegin("scheduler start");
+}
+
+void UT_BSP_TestStarting(void) {
+	if (!StartupReported) {
+		StartupReported = true;
+		OS_StartupPhaseEnd(SchedulerPhase);
+		OS_StartupReport();
+	}
+}
@@ -0,0 +1,39 @@
+/******************************************************************************
+ ** File:  bsp_ut_common.h
+ **
+ ** Purpose:
+ ** Code shared by the unit test BSPs (bsp_ut.c) of the FreeRTOS test projects
+ ******************************************************************************/
+
+#ifndef BSP_UT_COMMON_H_
+#define BSP_UT_COMMON_H_
+
+#include "common_types.h"
+#include "utassert.h"
+
+/*
+ * Startup trace, see OS_StartupPhaseBegin.  The BSP calls
+ * UT_BSP_SchedulerStarting right before vTaskStartScheduler and
+ * UT_BSP_TestStarting first thing in its test task.  The time in between is
+ * the "scheduler start" phase, and the startup report is printed once, by
+ * the first UT_BSP_TestStarting.
+ */
+void UT_BSP_SchedulerStarting(void);
+void UT_BSP_TestStarting(void);
+
+/*
+ * Machine readable report, see the record layout in bsp_ut_common.c.  The
+ * BSP passes its -o and -r options to UT_BSP_ReportOption, which returns
+ * false for a format it does not know, and calls UT_BSP_ReportStart once the
+ * command line is parsed.  The other calls mirror the UT_BSP_ hooks of the
+ * same name and do nothing when no report was asked for.
+ */
+bool UT_BSP_ReportOption(int Option, const char *Argument);
+void UT_BSP_ReportStart(const char *Program);
+void UT_BSP_ReportSegmentStart(uint32 SegmentNumber);
+void UT_BSP_ReportText(uint8 MessageType, const char *ShortDesc);
+void UT_BSP_ReportSegment(const char *SegmentName,
+		const UtAssert_TestCounter_t *TestCounters);
+void UT_BSP_ReportFinish(const UtAssert_TestCounter_t *TestCounters);
+
+#endif /* BSP_UT_COMMON_H_ */
@@ -47,6 +47,7 @@
 /* Standard includes. */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <conio.h>
 
 /* FreeRTOS kernel includes. */
@@ -62,6 +63,12 @@ static TickType_t elapsed_ticks = 0;
 #if configFREERTOS_RUN_AS_SIM == 1
 extern HANDLE freertos_sync_pipe;
 #endif
+#if configUSE_TICKLESS_IDLE == 2 && configFREERTOS_RUN_AS_SIM == 1 && configFREERTOS_SIM_ACCELERATED == 0
+#error Tickless idle can only be used in accelerated mode when synchronizing with a simulation driver
+#endif
+#if configFREERTOS_SIM_ACCELERATED == 1 && configUSE_TICKLESS_IDLE != 2
+#error configFREERTOS_SIM_ACCELERATED needs configUSE_TICKLESS_IDLE set to 2
+#endif
 
 /*
  * Prototypes for the standard FreeRTOS application hook (callback) functions
@@ -76,6 +83,15 @@ void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
 void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
 		StackType_t **ppxTimerTaskStackBuffer, uint32_t *pulTimerTaskStackSize);
 
+/* OSAL port routine run from the idle hook, see osapi.c */
+void OS_FreeRTOS_CpuLoadIdleHook(void);
+
+static void prvFailurePolicy(void);
+
+#if configFREERTOS_SIM_FAILURE_POLICY < 0 || configFREERTOS_SIM_FAILURE_POLICY > 2
+#error configFREERTOS_SIM_FAILURE_POLICY must be 0, 1 or 2
+#endif
+
 /*-----------------------------------------------------------*/
 
 /* When configSUPPORT_STATIC_ALLOCATION is set to 1 the application writer can
@@ -100,7 +116,11 @@ void vApplicationMallocFailedHook(void) {
 	 (although it does not provide information on how the remaining heap might be
 	 fragmented).  See http://www.freertos.org/a00111.html for more
 	 information. */
-	vAssertCalled( __LINE__, __FILE__);
+#if configFREERTOS_SIM_CRASH_RECORD
+	OS_FreeRTOS_CrashRecord("malloc failed", NULL, 0);
+#endif
+
+	prvFailurePolicy();
 }
 /*-----------------------------------------------------------*/
 
@@ -115,20 +135,8 @@ void vApplicationIdleHook(void) {
 	 because it is the responsibility of the idle task to clean up memory
 	 allocated by the kernel to any task that has since deleted itself. */
 
-	/* Uncomment the following code to allow the trace to be stopped with any
-	 key press.  The code is commented out by default as the kbhit() function
-	 interferes with the run time behaviour. */
-	/*
-	 if( _kbhit() != pdFALSE )
-	 {
-	 if( xTraceRunning == pdTRUE )
-	 {
-	 vTraceStop();
-	 prvSaveTraceFile();
-	 xTraceRunning = pdFALSE;
-	 }
-	 }
-	 */
+	/* Closes the CPU load window, see OS_CpuLoadGet */
+	OS_FreeRTOS_CpuLoadIdleHook();
 }
 /*-----------------------------------------------------------*/
 
@@ -149,8 +157,6 @@ void vApplicationStackOverflowHook(TaskHandle_t pxTask, char *pcTaskName) {
 #error configFREERTOS_RUN_AS_SIM must be set to 0 or 1 in FreeRTOSConfig.h
 #endif
 #if configFREERTOS_RUN_AS_SIM == 1
-void vApplicationSyncHook(void) {
-
 #ifndef configFREERTOS_SIM_WARMUP_MS
 #error configFREERTOS_SIM_WARMUP_MS must be set in FreeRTOSConfig.h
 #endif
@@ -158,6 +164,236 @@ void vApplicationSyncHook(void) {
 #error configFREERTOS_SIM_MS_BETWEEN_SYNCS must be set in FreeRTOSConfig.h
 #endif
 
+#if configFREERTOS_SIM_SYNC_PROTOCOL == 2
+#include "freertos-sim-sync.h"
+#elif configFREERTOS_SIM_SYNC_PROTOCOL != 1
+#error configFREERTOS_SIM_SYNC_PROTOCOL must be 1 or 2
+#endif
+#if configFREERTOS_SIM_COORDINATED == 1 && configFREERTOS_SIM_SYNC_PROTOCOL != 2
+#error configFREERTOS_SIM_COORDINATED needs configFREERTOS_SIM_SYNC_PROTOCOL set to 2
+#endif
+
+/* Protocol 2 drivers can change the period at run time */
+static TickType_t sim_ticks_between_syncs = configFREERTOS_SIM_MS_BETWEEN_SYNCS / portTICK_PERIOD_MS;
+#define SIM_TICKS_BETWEEN_SYNCS	sim_ticks_between_syncs
+
+static TickType_t last_sync_tick = 0;
+static HANDLE sync_pipe_event = NULL;
+static BaseType_t sync_pipe_connected = pdFALSE;
+
+/*
+ * Wait for an overlapped operation on the sync pipe to finish.  The pipe is
+ * opened for overlapped I/O so this blocks on an event instead of polling.
+ */
+static BOOL prvSyncPipeComplete(BOOL xStarted, OVERLAPPED *pxOverlapped,
+		DWORD *pdwTransferred) {
+	if (!xStarted && GetLastError() != ERROR_IO_PENDING) {
+		return FALSE;
+	}
+
+	return GetOverlappedResult(freertos_sync_pipe, pxOverlapped,
+			pdwTransferred, TRUE);
+}
+
+/*
+ * Make the peer connect again.  A coordinated node is the client, so it
+ * cannot wait for the coordinator to come back; it runs on unsynchronized.
+ */
+static void prvSyncPipeDrop(void) {
+#if configFREERTOS_SIM_COORDINATED == 1
+	printf("Lost the simulation coordinator, running unsynchronized\n");
+	CloseHandle(freertos_sync_pipe);
+	freertos_sync_pipe = INVALID_HANDLE_VALUE;
+#else
+	DisconnectNamedPipe(freertos_sync_pipe);
+#endif
+	sync_pipe_connected = pdFALSE;
+}
+
+static BOOL prvSyncPipeTransfer(BOOL xWrite, void *pvBuffer, DWORD dwSize) {
+	OVERLAPPED xOverlapped;
+	DWORD dwTransferred;
+	BOOL xStarted;
+
+	if (sync_pipe_event == NULL) {
+		sync_pipe_event = CreateEvent(NULL, TRUE, FALSE, NULL);
+		if (sync_pipe_event == NULL) {
+			return FALSE;
+		}
+	}
+
+	memset(&xOverlapped, 0, sizeof(xOverlapped));
+	xOverlapped.hEvent = sync_pipe_event;
+
+	/* Wait for the driver to connect before the first exchange */
+	if (sync_pipe_connected == pdFALSE && configFREERTOS_SIM_COORDINATED == 0) {
+		xStarted = ConnectNamedPipe(freertos_sync_pipe, &xOverlapped);
+		if (!xStarted && GetLastError() == ERROR_PIPE_CONNECTED) {
+			xStarted = TRUE;
+		} else if (!prvSyncPipeComplete(xStarted, &xOverlapped, &dwTransferred)) {
+			return FALSE;
+		}
+		sync_pipe_connected = pdTRUE;
+	}
+
+	if (xWrite) {
+		xStarted = WriteFile(freertos_sync_pipe, pvBuffer, dwSize, NULL, &xOverlapped);
+	} else {
+		xStarted = ReadFile(freertos_sync_pipe, pvBuffer, dwSize, NULL, &xOverlapped);
+	}
+
+	if (!prvSyncPipeComplete(xStarted, &xOverlapped, &dwTransferred)) {
+		/* A driver that went away has to connect again */
+		if (GetLastError() == ERROR_BROKEN_PIPE || GetLastError() == ERROR_NO_DATA) {
+			prvSyncPipeDrop();
+		}
+		return FALSE;
+	}
+
+	return dwTransferred == dwSize;
+}
+
+#if configFREERTOS_SIM_ACCELERATED == 1
+/*
+ * The number of ticks that can be skipped without stepping over the next
+ * synchronization point, which has to be reached by a real tick so that
+ * vApplicationSyncHook() runs.
+ */
+static TickType_t prvTicksBeforeNextSync(TickType_t xNow) {
+	TickType_t xNextSync = last_sync_tick + SIM_TICKS_BETWEEN_SYNCS;
+
+	if (xNextSync - xNow <= 1 || xNextSync - xNow > SIM_TICKS_BETWEEN_SYNCS) {
+		return 0;
+	}
+
+	return xNextSync - xNow - 1;
+}
+#endif
+
+#if configFREERTOS_SIM_SYNC_PROTOCOL == 2
+/*
+ * One sync point of protocol 2, see freertos-sim-sync.h.
+ */
+static void prvSyncProtocol2(TickType_t xTicks) {
+	static uint32_t grant_until_ms = 0;
+	static uint32_t report_every = 0;
+	static uint32_t sequence = 0;
+	static uint16_t syncs_since_grant = 0;
+	SimSyncStatus_t xStatus;
+	SimSyncGrant_t xGrant;
+	DWORD execution_ms = xTicks * portTICK_PERIOD_MS;
+
+	syncs_since_grant++;
+
+	memset(&xStatus, 0, sizeof(xStatus));
+	xStatus.magic = SIM_SYNC_MAGIC;
+	xStatus.version = SIM_SYNC_VERSION;
+	if (execution_ms >= grant_until_ms) {
+		xStatus.flags |= SIM_SYNC_STATUS_WAITING;
+	} else if (report_every == 0 || (syncs_since_grant % report_every) != 0) {
+		/* Inside the grant and no status due, so no pipe traffic at all */
+		return;
+	}
+	if (xTaskGetCurrentTaskHandle() == xTaskGetIdleTaskHandle()) {
+		xStatus.flags |= SIM_SYNC_STATUS_IDLE;
+	}
+	xStatus.sequence = ++sequence;
+	xStatus.tick_count = xTicks;
+	xStatus.execution_ms = execution_ms;
+	xStatus.run_time = ulGetRunTimeCounterValue();
+	xStatus.task_count = (uint16_t) uxTaskGetNumberOfTasks();
+	xStatus.syncs_since_grant = syncs_since_grant;
+
+	if (!prvSyncPipeTransfer(TRUE, &xStatus, sizeof(xStatus))
+			|| (xStatus.flags & SIM_SYNC_STATUS_WAITING) == 0) {
+		return;
+	}
+
+	if (!prvSyncPipeTransfer(FALSE, &xGrant, sizeof(xGrant))) {
+		return;
+	}
+
+	if (xGrant.magic != SIM_SYNC_MAGIC || xGrant.version != SIM_SYNC_VERSION
+			|| xGrant.sequence != xStatus.sequence) {
+		/* Out of step with the driver; make it connect again */
+		prvSyncPipeDrop();
+		return;
+	}
+
+	grant_until_ms = xGrant.grant_until_ms;
+	report_every = xGrant.report_every;
+	syncs_since_grant = 0;
+	if (xGrant.sync_period_ms >= portTICK_PERIOD_MS && portTICK_PERIOD_MS > 0) {
+		sim_ticks_between_syncs = xGrant.sync_period_ms / portTICK_PERIOD_MS;
+	}
+}
+#endif
+
+#if configFREERTOS_SIM_COORDINATED == 1
+/*
+ * Connect to the simulation coordinator and register this node, called by
+ * OS_API_Impl_Init before the scheduler starts.  Waits for the coordinator
+ * to come up.  The FREERTOS_SIM_COORDINATOR environment variable overrides
+ * configFREERTOS_SYNC_COORDINATOR_PIPE, e.g. \\host\pipe\name for a
+ * coordinator on another host, and FREERTOS_SIM_NODE names the node.
+ */
+HANDLE xSimSyncRegister(void) {
+	const char *pcPipeName = getenv("FREERTOS_SIM_COORDINATOR");
+	const char *pcNodeName = getenv("FREERTOS_SIM_NODE");
+	char cHostName[MAX_COMPUTERNAME_LENGTH + 1];
+	DWORD dwHostNameLength = sizeof(cHostName);
+	SimSyncHello_t xHello;
+	HANDLE xPipe;
+
+	if (pcPipeName == NULL) {
+		pcPipeName = configFREERTOS_SYNC_COORDINATOR_PIPE;
+	}
+
+	while (1) {
+		xPipe = CreateFileA(pcPipeName, GENERIC_READ | GENERIC_WRITE, 0, NULL,
+				OPEN_EXISTING, FILE_FLAG_OVERLAPPED, NULL);
+		if (xPipe != INVALID_HANDLE_VALUE) {
+			break;
+		}
+		if (GetLastError() == ERROR_PIPE_BUSY) {
+			WaitNamedPipeA(pcPipeName, NMPWAIT_WAIT_FOREVER);
+		} else {
+			/* Not up yet */
+			Sleep(100);
+		}
+	}
+
+	memset(&xHello, 0, sizeof(xHello));
+	xHello.magic = SIM_SYNC_HELLO_MAGIC;
+	xHello.version = SIM_SYNC_VERSION;
+	xHello.sync_period_ms = SIM_TICKS_BETWEEN_SYNCS * portTICK_PERIOD_MS;
+	xHello.warmup_ms = configFREERTOS_SIM_WARMUP_MS;
+	xHello.process_id = GetCurrentProcessId();
+	if (pcNodeName != NULL) {
+		strncpy(xHello.node_name, pcNodeName, sizeof(xHello.node_name) - 1);
+	} else {
+		if (!GetComputerNameA(cHostName, &dwHostNameLength)) {
+			strcpy(cHostName, "node");
+		}
+		snprintf(xHello.node_name, sizeof(xHello.node_name), "%s:%lu",
+				cHostName, (unsigned long) xHello.process_id);
+	}
+
+	freertos_sync_pipe = xPipe;
+	sync_pipe_connected = pdTRUE;
+	if (!prvSyncPipeTransfer(TRUE, &xHello, sizeof(xHello))) {
+		CloseHandle(xPipe);
+		freertos_sync_pipe = INVALID_HANDLE_VALUE;
+		sync_pipe_connected = pdFALSE;
+		return INVALID_HANDLE_VALUE;
+	}
+
+	return xPipe;
+}
+#endif
+
+void vApplicationSyncHook(void) {
+
 	/*
 	 * The following functionality is used to "pause" each tick to synchronize
 	 * execution with an external application, such as a simulation driver
@@ -169,20 +405,22 @@ void vApplicationSyncHook(void) {
 	 * are other plausible reasons not to begin synchronizing the application
 	 * until it has been running a certain period of time
 	 */
-	static TickType_t last_sync_tick = 0;
-
 	TickType_t current_ticks = xTaskGetTickCountFromISR();
 	if (current_ticks
-			>= last_sync_tick + configFREERTOS_SIM_MS_BETWEEN_SYNCS / portTICK_PERIOD_MS) {
-		last_sync_tick += configFREERTOS_SIM_MS_BETWEEN_SYNCS / portTICK_PERIOD_MS;
+			>= last_sync_tick + SIM_TICKS_BETWEEN_SYNCS) {
+		last_sync_tick += SIM_TICKS_BETWEEN_SYNCS;
 
 		if (current_ticks >= configFREERTOS_SIM_WARMUP_MS / portTICK_PERIOD_MS) {
 			/*
-			 * Must NOT block in this section. Otherwise, other threads might execute.
-			 * This is particularly a risk in the Windows simulator in which tasks
-			 * are emulated with threads.
+			 * This runs in the simulated interrupt thread, so waiting here holds
+			 * off every task until the driver lets the application continue.
 			 */
 
+#if configFREERTOS_SIM_SYNC_PROTOCOL == 2
+			if (freertos_sync_pipe != INVALID_HANDLE_VALUE) {
+				prvSyncProtocol2(current_ticks);
+			}
+#else
 			if (freertos_sync_pipe != INVALID_HANDLE_VALUE) {
 				static DWORD target_execution_progress_ms = 0;
 				/*
@@ -201,30 +439,62 @@ void vApplicationSyncHook(void) {
 					 * If the write fails, just proceed and hope the synchronization
 					 * is successful next time.
 					 */
-					WriteFile(freertos_sync_pipe, &current_execution_ms, sizeof(current_execution_ms), NULL, NULL);
-
-					/*
-					 * Now wait for the synchronizing application to tell us to proceed.
-					 * To synchronize, we wait for an acknowledgment of our current progress.
-					 * The value we read from the pipe is the desired millisecond count we should
-					 * execute to. The FreeRTOS application will advance to just that point.
-					 * We will overshoot if the sync resolution is larger than 1.
-					 */
-					for (;;) {
-						DWORD bytesRead;
-						if (ReadFile(freertos_sync_pipe, &target_execution_progress_ms, sizeof(target_execution_progress_ms), &bytesRead, NULL)) {
-							if (bytesRead > 0) {
-								break;
-							}
-						}
+					if (prvSyncPipeTransfer(TRUE, &current_execution_ms, sizeof(current_execution_ms))) {
+						/*
+						 * Now wait for the synchronizing application to tell us to proceed.
+						 * To synchronize, we wait for an acknowledgment of our current progress.
+						 * The value we read from the pipe is the desired millisecond count we should
+						 * execute to. The FreeRTOS application will advance to just that point.
+						 * We will overshoot if the sync resolution is larger than 1.
+						 */
+						prvSyncPipeTransfer(FALSE, &target_execution_progress_ms, sizeof(target_execution_progress_ms));
 					}
 				}
 			}
+#endif
 		}
 	}
 }
 #endif
 
+static void prvAdvanceElapsedTime(TickType_t xTicks) {
+	// Keep a clock that won't rollover as quickly as just keeping a count of
+	// ticks.
+	// Thus, keep a separate count of elapsed seconds and elapsed_ticks
+	// is the number of ticks since the last full second.
+	// Ticks skipped by tickless idle are added here as well.
+	elapsed_ticks += xTicks;
+	while (elapsed_ticks >= configTICK_RATE_HZ) {
+		elapsed_ticks -= configTICK_RATE_HZ;
+		elapsed_seconds++;
+	}
+}
+
+/*-----------------------------------------------------------*/
+
+#if configFREERTOS_SIM_CORE_MASK != 0 || configFREERTOS_SIM_TIME_CRITICAL == 1
+static void prvConfigureSimThreads(void) {
+	/* The tick hook runs on the port's simulated interrupt thread, which is
+	 the only place the thread can be reached from.  The tick thread itself is
+	 private to port.c, so it is only covered by the process affinity mask. */
+#if configFREERTOS_SIM_CORE_MASK != 0
+	if (SetProcessAffinityMask(GetCurrentProcess(),
+			(DWORD_PTR) configFREERTOS_SIM_CORE_MASK) == 0) {
+		printf("Could not set process affinity mask 0x%llx, error %lu\n",
+				(unsigned long long) configFREERTOS_SIM_CORE_MASK,
+				GetLastError());
+	}
+#endif
+
+#if configFREERTOS_SIM_TIME_CRITICAL == 1
+	SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL);
+	SetThreadPriorityBoost(GetCurrentThread(), TRUE);
+#endif
+}
+
+/*-----------------------------------------------------------*/
+#endif
+
 void vApplicationTickHook(void) {
 	/* This function will be called by each tick interrupt if
 	 configUSE_TICK_HOOK is set to 1 in FreeRTOSConfig.h.  User code can be
@@ -232,20 +502,78 @@ void vApplicationTickHook(void) {
 	 code must not attempt to block, and only the interrupt safe FreeRTOS API
 	 functions can be used (those that end in FromISR()). */
 
+#if configFREERTOS_SIM_CORE_MASK != 0 || configFREERTOS_SIM_TIME_CRITICAL == 1
+	static BaseType_t sim_threads_configured = pdFALSE;
+
+	if (sim_threads_configured == pdFALSE) {
+		prvConfigureSimThreads();
+		sim_threads_configured = pdTRUE;
+	}
+#endif
+
 #if configFREERTOS_RUN_AS_SIM == 1
 		vApplicationSyncHook();
 #endif
 
-	// Keep a clock that won't rollover as quickly as just keeping a count of
-	// ticks.
-	// Thus, keep a separate count of elapsed seconds and elapsed_ticks
-	// is the number of ticks since the last full second.
-	elapsed_ticks++;
-	while (elapsed_ticks >= configTICK_RATE_HZ) {
-		elapsed_ticks -= configTICK_RATE_HZ;
-		elapsed_seconds++;
+	prvAdvanceElapsedTime(1);
+}
+
+#if configUSE_TICKLESS_IDLE == 2
+void vApplicationSuppressTicksAndSleep(unsigned long ulExpectedIdleTime) {
+	LARGE_INTEGER liFrequency, liStart, liEnd;
+	TickType_t xSleepTicks, xElapsedTicks;
+
+	/* Called by the idle task with the scheduler suspended.  Leave the last
+	 tick of the idle period to the real tick interrupt, so the task that
+	 unblocks then is made ready by the kernel in the normal way. */
+	if (ulExpectedIdleTime > configSIM_MAX_SUPPRESSED_TICKS) {
+		ulExpectedIdleTime = configSIM_MAX_SUPPRESSED_TICKS;
+	}
+	xSleepTicks = (TickType_t) ulExpectedIdleTime - 1;
+
+	/* In the Win32 port disabling interrupts takes the simulated interrupt
+	 mutex, which the tick thread has to get before it can raise the next
+	 tick.  Holding it while asleep is what suppresses the tick. */
+	portDISABLE_INTERRUPTS();
+
+	if (xSleepTicks == 0 || eTaskConfirmSleepModeStatus() == eAbortSleep) {
+		portENABLE_INTERRUPTS();
+		return;
+	}
+
+#if configFREERTOS_SIM_ACCELERATED == 1
+	/* Virtual time: nothing can happen before the next wake up, so go
+	 straight there, but stop short of the next synchronization point. */
+	(void) liFrequency;
+	(void) liStart;
+	(void) liEnd;
+	xElapsedTicks = xSleepTicks;
+#if configFREERTOS_RUN_AS_SIM == 1
+	if (xElapsedTicks > prvTicksBeforeNextSync(xTaskGetTickCount())) {
+		xElapsedTicks = prvTicksBeforeNextSync(xTaskGetTickCount());
+	}
+#endif
+#else
+	QueryPerformanceFrequency(&liFrequency);
+	QueryPerformanceCounter(&liStart);
+	Sleep((DWORD) (((unsigned long long) xSleepTicks * 1000) / configTICK_RATE_HZ));
+	QueryPerformanceCounter(&liEnd);
+
+	xElapsedTicks = (TickType_t) (((liEnd.QuadPart - liStart.QuadPart)
+			* configTICK_RATE_HZ) / liFrequency.QuadPart);
+	if (xElapsedTicks > xSleepTicks) {
+		xElapsedTicks = xSleepTicks;
 	}
+#endif
+
+	if (xElapsedTicks > 0) {
+		vTaskStepTick(xElapsedTicks);
+		prvAdvanceElapsedTime(xElapsedTicks);
+	}
+
+	portENABLE_INTERRUPTS();
 }
+#endif
 
 TickType_t getElapsedSeconds() {
 	return elapsed_seconds;
@@ -274,28 +602,16 @@ void vApplicationDaemonTaskStartupHook(void) {
 }
 /*-----------------------------------------------------------*/
 
-void vAssertCalled(unsigned long ulLine, const char * const pcFileName) {
-	static BaseType_t xPrinted = pdFALSE;
+/*
+ * What happens after a failed allocation or assertion, see
+ * configFREERTOS_SIM_FAILURE_POLICY in FreeRTOSConfig.h.
+ */
+static void prvFailurePolicy(void) {
+#if configFREERTOS_SIM_FAILURE_POLICY == 0
 	volatile uint32_t ulSetToNonZeroInDebuggerToContinue = 0;
 
-	/* Called if an assertion passed to configASSERT() fails.  See
-	 http://www.freertos.org/a00110.html#configASSERT for more information. */
-
-	/* Parameters are not used. */
-	(void) ulLine;
-	(void) pcFileName;
-
 	taskENTER_CRITICAL();
 	{
-		/* Stop the trace recording. */
-		if (xPrinted == pdFALSE) {
-			xPrinted = pdTRUE;
-			//			if( xTraceRunning == pdTRUE )
-			//			{
-			//				prvSaveTraceFile();
-			//			}
-		}
-
 		/* You can step out of this function to debug the assertion by using
 		 the debugger to set ulSetToNonZeroInDebuggerToContinue to a non-zero
 		 value. */
@@ -305,33 +621,40 @@ void vAssertCalled(unsigned long ulLine, const char * const pcFileName) {
 		}
 	}
 	taskEXIT_CRITICAL();
+#elif configFREERTOS_SIM_FAILURE_POLICY == 2
+	fflush(stdout);
+	ExitProcess(configFREERTOS_SIM_FAILURE_EXIT_CODE);
+#endif
 }
 /*-----------------------------------------------------------*/
 
-//static void prvSaveTraceFile( void )
-//{
-//	/* Tracing is not used when code coverage analysis is being performed. */
-//	#if( projCOVERAGE_TEST != 1 )
-//	{
-//		FILE* pxOutputFile;
-//
-//		vTraceStop();
-//
-//		pxOutputFile = fopen( "Trace.dump", "wb");
-//
-//		if( pxOutputFile != NULL )
-//		{
-//			fwrite( RecorderDataPtr, sizeof( RecorderDataType ), 1, pxOutputFile );
-//			fclose( pxOutputFile );
-//			printf( "\r\nTrace output saved to Trace.dump\r\n" );
-//		}
-//		else
-//		{
-//			printf( "\r\nFailed to create trace dump file\r\n" );
-//		}
-//	}
-//	#endif
-//}
+void vAssertCalled(unsigned long ulLine, const char * const pcFileName) {
+	static BaseType_t xPrinted = pdFALSE;
+
+	/* Called if an assertion passed to configASSERT() fails.  See
+	 http://www.freertos.org/a00110.html#configASSERT for more information. */
+
+	taskENTER_CRITICAL();
+	{
+		/* Stop the trace recording. */
+		if (xPrinted == pdFALSE) {
+			xPrinted = pdTRUE;
+#if configFREERTOS_SIM_EVENT_TRACE
+			OS_FreeRTOS_TraceSave();
+#endif
+		}
+
+#if configFREERTOS_SIM_CRASH_RECORD
+		OS_FreeRTOS_CrashRecord("assert", pcFileName, ulLine);
+#else
+		(void) ulLine;
+		(void) pcFileName;
+#endif
+	}
+	taskEXIT_CRITICAL();
+
+	prvFailurePolicy();
+}
 /*-----------------------------------------------------------*/
 
 /* configUSE_STATIC_ALLOCATION is set to 1, so the application must provide an
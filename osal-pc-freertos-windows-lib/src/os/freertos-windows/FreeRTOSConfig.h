@@ -60,7 +60,7 @@
 //#define configTICK_RATE_HZ						( 100 ) /* In this non-real time simulated environment the tick frequency has to be at least a multiple of the Win32 tick frequency, and therefore very slow. */
 
 #define configMINIMAL_STACK_SIZE				( ( unsigned short ) 70 ) /* In this simulated case, the stack only has to hold one small structure as the real stack is part of the win32 thread. */
-#define configTOTAL_HEAP_SIZE					( ( size_t ) ( 16384 * 1024 ) ) /* If creating a FAT filesystem, 2M is required for each instance */
+#define configTOTAL_HEAP_SIZE					( ( size_t ) ( 16384 * 1024 ) ) /* If creating a FAT filesystem, 2M is required for each instance, unless OS_FREERTOS_FS_ARENA_SIZE holds RAM disk storage */
 #define configMAX_TASK_NAME_LEN					( 25 )
 #define configUSE_TRACE_FACILITY				1
 #define configUSE_16_BIT_TICKS					0
@@ -74,7 +74,8 @@
 #define configUSE_ALTERNATIVE_API				0
 #define configUSE_QUEUE_SETS					1
 #define configUSE_TASK_NOTIFICATIONS			1
-#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 10
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES	2	/* index 1 is OS_FREERTOS_NOTIFY_SEM_INDEX */
+#define configNUM_THREAD_LOCAL_STORAGE_POINTERS 10	/* 0-1 FreeRTOS+FAT and task id, 2-3 OS_FREERTOS_TLS_xxx */
 #define configSUPPORT_STATIC_ALLOCATION			1
 
 /* Software timer related configuration options.  The maximum possible task
@@ -83,6 +84,23 @@
  configMAX_PRIORITIES - 1. */
 #define configUSE_TIMERS						1
 #define configTIMER_TASK_PRIORITY				( configMAX_PRIORITIES - 1 )
+/*
+ * Set configUSE_TICKLESS_IDLE to 2 to stop the tick while every task is blocked.
+ * The Win32 port has no tickless support of its own, so the idle task sleeps in
+ * vApplicationSuppressTicksAndSleep() (FreeRTOS.c) while holding off the
+ * simulated tick interrupt, then steps the tick count on by the time that passed.
+ * A suppressed period is capped at configSIM_MAX_SUPPRESSED_TICKS, since other
+ * simulated interrupts (e.g. the network) are held off for that long as well.
+ * When running in lockstep with a simulation driver it is only available in
+ * accelerated mode, see configFREERTOS_SIM_ACCELERATED.
+ */
+#define configUSE_TICKLESS_IDLE					0
+#if configUSE_TICKLESS_IDLE == 2
+void vApplicationSuppressTicksAndSleep(unsigned long ulExpectedIdleTime);
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) vApplicationSuppressTicksAndSleep( xExpectedIdleTime )
+#define configSIM_MAX_SUPPRESSED_TICKS			( 100 )
+#endif
+
 #define configTIMER_QUEUE_LENGTH				20
 #define configTIMER_TASK_STACK_DEPTH			( configMINIMAL_STACK_SIZE * 2 )
 
@@ -147,6 +165,91 @@ extern void vAssertCalled(unsigned long ulLine, const char * const pcFileName);
 
 #define configUSE_MALLOC_FAILED_HOOK			1
 
+/*
+ * Set configFREERTOS_SIM_CRASH_RECORD to 1 to have vApplicationMallocFailedHook()
+ * and vAssertCalled() write a crash record with the failed request, the calling
+ * task, the heap statistics and the last heap operations, see
+ * OS_FreeRTOS_CrashRecord() and OS_FREERTOS_CRASH_RECORD_PATH in osconfig.h.
+ * Costs one history entry on every pvPortMalloc() and vPortFree().
+ *
+ * configFREERTOS_SIM_FAILURE_POLICY sets what happens after a failed allocation or
+ * assertion:
+ *   0 halt in a loop that a debugger can step out of
+ *   1 carry on; pvPortMalloc() returns NULL and configASSERT() returns
+ *   2 exit the process with configFREERTOS_SIM_FAILURE_EXIT_CODE
+ */
+#define configFREERTOS_SIM_CRASH_RECORD		1
+#define configFREERTOS_SIM_FAILURE_POLICY	0
+#define configFREERTOS_SIM_FAILURE_EXIT_CODE	3
+#if configFREERTOS_SIM_CRASH_RECORD
+extern void OS_FreeRTOS_CrashRecord(const char *pcReason, const char *pcFileName, unsigned long ulLine);
+#endif
+
+/*
+ * Set configFREERTOS_SIM_HEAP_ATTRIBUTION to 1 to have the OSAL port track which
+ * kind of object (task, queue, semaphore, file system, socket, timebase) every
+ * heap block was allocated for, see OS_HeapGetStats().  Costs a table lookup on
+ * every pvPortMalloc() and vPortFree().
+ */
+#define configFREERTOS_SIM_HEAP_ATTRIBUTION	0
+#if configFREERTOS_SIM_HEAP_ATTRIBUTION || configFREERTOS_SIM_CRASH_RECORD
+extern void OS_FreeRTOS_HeapTraceMalloc(void *pvAddress, size_t xSize);
+extern void OS_FreeRTOS_HeapTraceFree(void *pvAddress, size_t xSize);
+#define traceMALLOC( pvAddress, uiSize ) OS_FreeRTOS_HeapTraceMalloc( ( pvAddress ), ( uiSize ) )
+#define traceFREE( pvAddress, uiSize ) OS_FreeRTOS_HeapTraceFree( ( pvAddress ), ( uiSize ) )
+#endif
+
+/*
+ * Set configFREERTOS_SIM_EVENT_TRACE to 1 to have the OSAL port record context
+ * switches, queue, semaphore and notification operations, interrupts and the
+ * blocking OSAL calls in a ring of time stamped events, see OS_TraceDump().
+ * Costs a performance counter read and an interlocked increment per event.
+ * Needs configUSE_TRACE_FACILITY, the hooks read the task and queue numbers
+ * that it adds to the kernel objects.
+ */
+#define configFREERTOS_SIM_EVENT_TRACE		0
+#if configFREERTOS_SIM_EVENT_TRACE
+#define OS_FREERTOS_TRACE_TASK_SWITCH		1
+#define OS_FREERTOS_TRACE_TASK_CREATE		2
+#define OS_FREERTOS_TRACE_TASK_DELETE		3
+#define OS_FREERTOS_TRACE_TASK_DELAY		4
+#define OS_FREERTOS_TRACE_QUEUE_SEND		5
+#define OS_FREERTOS_TRACE_QUEUE_SEND_FAIL	6
+#define OS_FREERTOS_TRACE_QUEUE_SEND_BLOCK	7
+#define OS_FREERTOS_TRACE_QUEUE_RECV		8
+#define OS_FREERTOS_TRACE_QUEUE_RECV_FAIL	9
+#define OS_FREERTOS_TRACE_QUEUE_RECV_BLOCK	10
+#define OS_FREERTOS_TRACE_NOTIFY_GIVE		11
+#define OS_FREERTOS_TRACE_NOTIFY_TAKE		12
+#define OS_FREERTOS_TRACE_NOTIFY_TAKE_BLOCK	13
+#define OS_FREERTOS_TRACE_ISR_ENTER			14
+#define OS_FREERTOS_TRACE_ISR_EXIT			15
+#define OS_FREERTOS_TRACE_API_ENTER			16
+#define OS_FREERTOS_TRACE_API_EXIT			17
+#define OS_FREERTOS_TRACE_MARK				18
+extern void OS_FreeRTOS_TraceTaskSwitch(void *pxTCB, unsigned long ulTaskNumber);
+extern void OS_FreeRTOS_TraceTaskCreate(void *pxTCB, unsigned long ulTaskNumber, const char *pcName);
+extern void OS_FreeRTOS_TraceEvent(unsigned int uiType, const void *pvObject, unsigned long ulValue);
+extern void OS_FreeRTOS_TraceSave(void);
+#define traceTASK_SWITCHED_IN() OS_FreeRTOS_TraceTaskSwitch( pxCurrentTCB, pxCurrentTCB->uxTCBNumber )
+#define traceTASK_CREATE( pxNewTCB ) OS_FreeRTOS_TraceTaskCreate( ( pxNewTCB ), ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pcTaskName )
+#define traceTASK_DELETE( pxTCB ) OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_TASK_DELETE, ( pxTCB ), ( pxTCB )->uxTCBNumber )
+#define traceTASK_DELAY() OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_TASK_DELAY, NULL, xTicksToDelay )
+#define traceTASK_DELAY_UNTIL( xTimeToWake ) OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_TASK_DELAY, NULL, ( xTimeToWake ) - xConstTickCount )
+#define traceQUEUE_SEND( pxQueue ) OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_QUEUE_SEND, ( pxQueue ), ( pxQueue )->ucQueueType )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue ) OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_QUEUE_SEND, ( pxQueue ), ( pxQueue )->ucQueueType )
+#define traceQUEUE_SEND_FAILED( pxQueue ) OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_QUEUE_SEND_FAIL, ( pxQueue ), ( pxQueue )->ucQueueType )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue ) OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_QUEUE_SEND_BLOCK, ( pxQueue ), ( pxQueue )->ucQueueType )
+#define traceQUEUE_RECEIVE( pxQueue ) OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_QUEUE_RECV, ( pxQueue ), ( pxQueue )->ucQueueType )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue ) OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_QUEUE_RECV, ( pxQueue ), ( pxQueue )->ucQueueType )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue ) OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_QUEUE_RECV_FAIL, ( pxQueue ), ( pxQueue )->ucQueueType )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue ) OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_QUEUE_RECV_BLOCK, ( pxQueue ), ( pxQueue )->ucQueueType )
+#define traceTASK_NOTIFY() OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_NOTIFY_GIVE, xTaskToNotify, 0 )
+#define traceTASK_NOTIFY_GIVE_FROM_ISR() OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_NOTIFY_GIVE, xTaskToNotify, 1 )
+#define traceTASK_NOTIFY_TAKE() OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_NOTIFY_TAKE, NULL, 0 )
+#define traceTASK_NOTIFY_TAKE_BLOCK() OS_FreeRTOS_TraceEvent( OS_FREERTOS_TRACE_NOTIFY_TAKE_BLOCK, NULL, 0 )
+#endif
+
 
 /* Application specific definitions follow. **********************************/
 
@@ -264,10 +367,57 @@ ipconfigUSE_DNS is set to 1 but a DNS server cannot be contacted. */
 #error Period between synchronization events must be a multiple of tick resolution
 #endif
 
+/*
+ * The message format used on the sync pipe, see freertos-sim-sync.h. Protocol 1
+ * is the original single DWORD exchange per sync point.  Protocol 2 lets the
+ * driver grant several sync windows at once, stream status without waiting and
+ * change the sync period at run time; configFREERTOS_SIM_MS_BETWEEN_SYNCS is
+ * then only the initial period.
+ */
+#define configFREERTOS_SIM_SYNC_PROTOCOL 1
+
+/*
+ * Set configFREERTOS_SIM_ACCELERATED to 1 to run faster than real time. While
+ * every task is blocked the tick count jumps straight to the next wake up, or
+ * to the next synchronization point if that comes first, instead of waiting for
+ * the host clock.  The driver still gates progress through the sync pipe.
+ * Needs configUSE_TICKLESS_IDLE set to 2.
+ */
+#define configFREERTOS_SIM_ACCELERATED 0
+
 /*
  * The name of the named pipe used to communicate with an external application
  * and synchronize execution
  */
 #define configFREERTOS_SYNC_PIPE_NAME "\\\\.\\pipe\\freertos_sync_pipe"
 
+/*
+ * Set configFREERTOS_SIM_COORDINATED to 1 to run as one node of a multi-node
+ * simulation.  Instead of serving configFREERTOS_SYNC_PIPE_NAME to a single
+ * driver, the application connects to the coordinator at
+ * configFREERTOS_SYNC_COORDINATOR_PIPE (see tools/freertos-sim-coordinator),
+ * which advances every registered node in lockstep windows.  The pipe name can
+ * point to another host, and is overridden at run time by the
+ * FREERTOS_SIM_COORDINATOR environment variable.  Needs protocol 2.
+ */
+#define configFREERTOS_SIM_COORDINATED 0
+#define configFREERTOS_SYNC_COORDINATOR_PIPE "\\\\.\\pipe\\freertos_sim_coordinator"
+
+/*
+ * Placement of the Win32 threads that make up the simulation.
+ *
+ * configFREERTOS_SIM_CORE_MASK restricts the whole process, including the
+ * port's tick and interrupt threads, to the given set of cores.  0 leaves the
+ * process affinity as Windows set it.  Individual OSAL tasks can be pinned
+ * further with the OS_TASK_CORE() creation flag.
+ *
+ * Set configFREERTOS_SIM_TIME_CRITICAL to 1 to run the simulated interrupt
+ * thread, which processes every tick, at THREAD_PRIORITY_TIME_CRITICAL with
+ * priority boosting disabled.
+ *
+ * Both are applied on the first tick, see vApplicationTickHook().
+ */
+#define configFREERTOS_SIM_CORE_MASK 0
+#define configFREERTOS_SIM_TIME_CRITICAL 0
+
 #endif /* FREERTOS_CONFIG_H */
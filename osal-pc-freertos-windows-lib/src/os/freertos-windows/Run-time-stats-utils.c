@@ -43,7 +43,7 @@
 /* Variables used in the creation of the run time stats time base.  Run time
  stats record how much time each task spends in the Running state. */
 static long long llInitialRunTimeCounterValue = 0LL,
-llTicksPerHundedthMillisecond = 0LL;
+llTicksPerHundedthMillisecond = 0LL, llPerformanceCounterFrequency = 0LL;
 
 /*-----------------------------------------------------------*/
 
@@ -66,6 +66,7 @@ void vConfigureTimerForRunTimeStats(void) {
 		 from readings taken at run time. */
 		QueryPerformanceCounter(&liInitialRunTimeValue);
 		llInitialRunTimeCounterValue = liInitialRunTimeValue.QuadPart;
+		llPerformanceCounterFrequency = liPerformanceCounterFrequency.QuadPart;
 	}
 }
 /*-----------------------------------------------------------*/
@@ -94,3 +95,28 @@ unsigned long ulGetRunTimeCounterValue(void) {
 	return ulReturn;
 }
 /*-----------------------------------------------------------*/
+
+BaseType_t xGetMonotonicNanoseconds(unsigned long long *pullNanoseconds) {
+	LARGE_INTEGER liCurrentCount;
+	unsigned long long ullCount;
+
+	/* Time since the scheduler started, with the full resolution of the
+	 performance counter.  Not available until vConfigureTimerForRunTimeStats()
+	 has run, or if the host has no performance counter; the caller then falls
+	 back to the tick count. */
+	if (llPerformanceCounterFrequency == 0) {
+		return pdFALSE;
+	}
+
+	QueryPerformanceCounter(&liCurrentCount);
+	ullCount = (unsigned long long) (liCurrentCount.QuadPart
+			- llInitialRunTimeCounterValue);
+
+	/* Split the conversion so the intermediate product cannot overflow */
+	*pullNanoseconds = (ullCount / llPerformanceCounterFrequency) * 1000000000ULL
+			+ ((ullCount % llPerformanceCounterFrequency) * 1000000000ULL)
+					/ llPerformanceCounterFrequency;
+
+	return pdTRUE;
+}
+/*-----------------------------------------------------------*/
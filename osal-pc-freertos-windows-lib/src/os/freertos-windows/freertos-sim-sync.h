@@ -0,0 +1,82 @@
+/*
+ * Message formats of the synchronization pipe (configFREERTOS_SYNC_PIPE_NAME)
+ * between a FreeRTOS application run as a simulation and the external
+ * simulation driver.  The driver side can include this file as is; it only
+ * depends on <stdint.h>.
+ *
+ * Protocol 1 (configFREERTOS_SIM_SYNC_PROTOCOL == 1) is the original one: at
+ * every sync point the application writes its execution time in milliseconds
+ * as a 4-byte DWORD and waits for a 4-byte reply giving the execution time it
+ * may run to.
+ *
+ * Protocol 2 exchanges the structures below.  At a sync point the application
+ * sends a SimSyncStatus_t.  If SIM_SYNC_STATUS_WAITING is set it then blocks
+ * until the driver answers with a SimSyncGrant_t.  A grant lets the
+ * application run up to grant_until_ms without waiting again, optionally
+ * streaming a status every report_every sync points on the way, and may change
+ * the sync period.  Both sides check magic and version, and a peer that sees an
+ * unknown version should drop the connection.
+ *
+ * A node of a multi-node simulation (configFREERTOS_SIM_COORDINATED) is the
+ * client of the coordinator instead, and registers with a SimSyncHello_t as
+ * soon as it has connected.  The exchange is protocol 2 from then on.
+ *
+ * All fields are little endian.
+ */
+
+#ifndef FREERTOS_SIM_SYNC_H
+#define FREERTOS_SIM_SYNC_H
+
+#include <stdint.h>
+
+#define SIM_SYNC_MAGIC				0x59535246UL	/* "FRSY" */
+#define SIM_SYNC_HELLO_MAGIC		0x4C485246UL	/* "FRHL" */
+#define SIM_SYNC_VERSION			2
+
+/* SimSyncStatus_t flags */
+#define SIM_SYNC_STATUS_WAITING		0x0001	/* the application waits for a grant */
+#define SIM_SYNC_STATUS_IDLE		0x0002	/* the idle task was running at the sync point */
+
+#pragma pack(push, 1)
+
+/* Application -> driver, once per reported sync point */
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t flags;
+	uint32_t sequence;			/* counts every status sent */
+	uint32_t tick_count;
+	uint32_t execution_ms;
+	uint32_t run_time;			/* host run time counter, 10 us units */
+	uint16_t task_count;		/* FreeRTOS tasks in existence */
+	uint16_t syncs_since_grant;	/* sync points passed since the last grant */
+} SimSyncStatus_t;
+
+/* Driver -> application, in answer to a status with SIM_SYNC_STATUS_WAITING */
+typedef struct
+{
+	uint32_t magic;
+	uint16_t version;
+	uint16_t reserved;
+	uint32_t sequence;			/* sequence of the status being answered */
+	uint32_t grant_until_ms;	/* run to this execution time before waiting again */
+	uint32_t report_every;		/* 0 = no status until the grant is used up, N = every Nth sync point */
+	uint32_t sync_period_ms;	/* new time between sync points, 0 = unchanged */
+} SimSyncGrant_t;
+
+/* Node -> coordinator, once after connecting */
+typedef struct
+{
+	uint32_t magic;				/* SIM_SYNC_HELLO_MAGIC */
+	uint16_t version;
+	uint16_t reserved;
+	uint32_t sync_period_ms;	/* the node's initial time between sync points */
+	uint32_t warmup_ms;			/* execution time of the first sync point */
+	uint32_t process_id;
+	char     node_name[32];		/* NUL terminated, for the reports */
+} SimSyncHello_t;
+
+#pragma pack(pop)
+
+#endif /* FREERTOS_SIM_SYNC_H */
@@ -37,6 +37,7 @@
 #include "common_types.h"
 #include "osapi.h"
 #include "os-impl.h"
+#include "osapi-os-freertos.h"
 
 #ifdef OS_INCLUDE_NETWORK
 #include "FreeRTOS_sockets.h"
@@ -48,6 +49,80 @@
  DEFINES
  ***************************************************************************************/
 
+/*
+ * Thread local storage slots used by the port.  Slot 0 holds the OSAL task id,
+ * see OS_TaskRegister_Impl.  FreeRTOS+FAT keeps the working directory in the
+ * two slots from ffconfigCWD_THREAD_LOCAL_INDEX, so slot 1 is not free either.
+ */
+#define OS_FREERTOS_TLS_SOCKET_SET		2		/* socket set reused by OS_SelectMultiple */
+#define OS_FREERTOS_TLS_HEAP_CATEGORY	3		/* OS_HEAP_CATEGORY_xxx charged for new heap blocks */
+
+#if configNUM_THREAD_LOCAL_STORAGE_POINTERS <= OS_FREERTOS_TLS_HEAP_CATEGORY
+#error configNUM_THREAD_LOCAL_STORAGE_POINTERS too small for the port's thread local storage slots
+#endif
+
+/*
+ * Task notification index the semaphore waiters sleep on when the port is
+ * built with OS_FREERTOS_SEM_NOTIFY.  Index 0 is left to the port's other
+ * wakeups, see configTASK_NOTIFICATION_ARRAY_ENTRIES.
+ */
+#define OS_FREERTOS_NOTIFY_SEM_INDEX	1
+
+/*
+ * Ids of the port's own object tables (event flags, memory pools).  The low
+ * 16 bits hold the table index + 1 and the high 16 bits a generation bumped
+ * each time the entry is reused, so an id kept past its delete is refused
+ * rather than taken for the next object created in the same entry.
+ */
+#define OS_FREERTOS_EXT_ID(index, gen)	((((uint32)(gen) & 0xFFFF) << 16) | ((uint32)(index) + 1))
+#define OS_FREERTOS_EXT_ID_INDEX(id)	(((uint32)(id) & 0xFFFF) - 1)
+#define OS_FREERTOS_EXT_ID_GEN(id)		((uint16)((uint32)(id) >> 16))
+
+/*
+ * The probed OSAL calls, one entry per *_Impl function of the task, queue,
+ * semaphore, mutex, file, directory and socket APIs.  Each one starts with
+ * OS_FREERTOS_API_ENTER and wraps every value it returns in
+ * OS_FREERTOS_API_EXIT.
+ */
+#define OS_FREERTOS_API_LIST(X) \
+	X(TaskCreate) X(TaskMatch) X(TaskDelete) X(TaskDelay) X(TaskSetPriority) X(TaskRegister) \
+	X(TaskGetInfo) X(TaskGetStats) X(QueueCreate) X(QueueDelete) X(QueueGet) X(QueuePut) \
+	X(QueuePutTimed) X(QueueGetInfo) X(QueueGetStats) X(QueueBufferAlloc) X(QueuePutBuffer) \
+	X(QueueGetBuffer) X(QueueBufferRelease) X(QueuePutBatch) X(QueueGetBatch) X(BinSemCreate) \
+	X(BinSemDelete) X(BinSemGive) X(BinSemFlush) X(BinSemTake) X(BinSemTimedWait) \
+	X(BinSemGetInfo) X(BinSemGetStats) X(CountSemCreate) X(CountSemDelete) X(CountSemGive) \
+	X(CountSemTake) X(CountSemTimedWait) X(CountSemGetInfo) X(CountSemGetStats) X(MutSemCreate) \
+	X(MutSemDelete) X(MutSemGive) X(MutSemTake) X(MutSemTimedTake) X(MutSemGetInfo) \
+	X(MutSemGetStats) X(HeapGetInfo) X(GenericClose) X(GenericSeek) X(GenericRead) \
+	X(GenericWrite) X(GenericWritev) X(GenericReadv) X(GenericPread) X(GenericPwrite) X(FileMap) \
+	X(FileUnmap) X(FileOpen) X(FileStat) X(FileRemove) X(FileRename) X(DirCreate) X(DirOpen) \
+	X(DirClose) X(DirRead) X(DirReadAttributes) X(DirRewind) X(DirRemove) X(SocketOpen) \
+	X(SocketBind) X(SocketConnect) X(SocketAccept) X(SocketRecvFrom) X(SocketSendTo) \
+	X(SocketBufferAlloc) X(SocketSendToBuffer) X(SocketRecvFromBuffer) X(SocketBufferRelease) \
+	X(SocketRecvFromBatch) X(SocketSendToBatch) X(SocketSetOption) X(SocketAddrInit) \
+	X(SocketAddrToString) X(SocketAddrFromString) X(SocketAddrGetPort) X(SocketAddrSetPort)
+
+#define OS_FREERTOS_API_ID(api)				OS_FREERTOS_API_##api,
+enum
+{
+	OS_FREERTOS_API_LIST(OS_FREERTOS_API_ID)
+	OS_FREERTOS_API_COUNT
+};
+
+/*
+ * The probes count and time the call when OS_FREERTOS_API_STATS is defined
+ * (osconfig.h) and record it in the event trace when configFREERTOS_SIM_EVENT_TRACE
+ * is set, see ostrace.c.  Otherwise they compile to nothing.  The exit probe
+ * evaluates to the status so it can wrap the value returned.
+ */
+#if defined(OS_FREERTOS_API_STATS) || configFREERTOS_SIM_EVENT_TRACE
+#define OS_FREERTOS_API_ENTER(api)			uint64 os_api_start = OS_FreeRTOS_ApiEnter(OS_FREERTOS_API_##api)
+#define OS_FREERTOS_API_EXIT(api, status)	OS_FreeRTOS_ApiExit(OS_FREERTOS_API_##api, os_api_start, (status))
+#else
+#define OS_FREERTOS_API_ENTER(api)			do { } while(0)
+#define OS_FREERTOS_API_EXIT(api, status)	(status)
+#endif
+
 /****************************************************************************************
  TYPEDEFS
  ***************************************************************************************/
@@ -58,13 +133,60 @@ typedef struct
 	TaskHandle_t	IdleTaskId;
 } FreeRTOS_GlobalVars_t;
 
+/*
+ * Per-stream operations, chosen when the stream is opened so that the
+ * generic I/O calls do not have to look at the stream type again.  The
+ * whence passed to Seek is already translated to SEEK_SET/CUR/END.  An
+ * operation a stream does not support is left NULL.
+ */
+typedef struct
+{
+	int32 (*Read)(uint32 local_id, void *buffer, uint32 nbytes, int32 timeout);
+	int32 (*Write)(uint32 local_id, const void *buffer, uint32 nbytes, int32 timeout);
+	int32 (*Seek)(uint32 local_id, int32 offset, int whence);
+	int32 (*Close)(uint32 local_id);
+	int32 (*Sync)(uint32 local_id);
+} OS_FreeRTOS_stream_ops_t;
+
+/* State of the buffer of a stream opened with OS_FILE_FLAG_BUFFERED */
+typedef enum
+{
+	OS_FREERTOS_BUFFER_IDLE,
+	OS_FREERTOS_BUFFER_WRITING,		/* holds data not written to the backend yet */
+	OS_FREERTOS_BUFFER_READING		/* holds data read ahead from the backend */
+} OS_FreeRTOS_buffer_state_t;
+
+/*
+ * Bits of OS_impl_filehandle_flags.  The handle, volume type and flags of a
+ * stream live in parallel arrays beside OS_impl_filehandle_table, so the
+ * select conversion loops only walk a few bytes per stream.
+ */
+#define OS_FREERTOS_STREAM_SELECTABLE	0x01
+#define OS_FREERTOS_STREAM_CONNECTED	0x02
+#define OS_FREERTOS_STREAM_DISCONNECTED	0x04	/* was connected until select saw eSELECT_EXCEPT */
+#define OS_FREERTOS_STREAM_PIPE			0x08	/* OS_FreeRTOS_PipeStreamOps, fd is not a socket */
+
 typedef struct
 {
-	int32 VolumeType;
-	void * fd;
-	bool selectable;
-	bool connected;
-	bool disconnected;
+	const OS_FreeRTOS_stream_ops_t *ops;
+	const OS_FreeRTOS_stream_ops_t *base_ops;	/* backend under the buffering layer */
+	uint8 *buffer;
+	uint32 buffer_len;							/* valid bytes in buffer */
+	uint32 buffer_pos;							/* read cursor within buffer */
+	OS_FreeRTOS_buffer_state_t buffer_state;
+	SemaphoreHandle_t lock;						/* serializes transfers on seekable streams */
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	StaticSemaphore_t lock_cb;
+#endif
+	const void *map_addr;						/* current OS_FileMap view, or NULL */
+	void *map_copy;								/* heap snapshot behind map_addr, if any */
+	TickType_t recv_timeout;					/* FREERTOS_SO_RCVTIMEO last set on a socket */
+#ifdef OS_INCLUDE_NETWORK
+	SocketSet_t select_set;						/* set reused by OS_SelectSingle on this socket */
+	uint32 listen_backlog;						/* OS_SOCKET_OPT_BACKLOG, 0 for the default */
+	uint32 event_set;							/* OS_EventSetAdd set id, 0 if none */
+	BaseType_t event_bits;						/* eSELECT_xxx registered with event_set */
+#endif
 } OS_FreeRTOS_filehandle_entry_t;
 
 /****************************************************************************************
@@ -74,6 +196,17 @@ typedef struct
 extern FreeRTOS_GlobalVars_t FreeRTOS_GlobalVars;
 
 extern OS_FreeRTOS_filehandle_entry_t OS_impl_filehandle_table[OS_MAX_NUM_OPEN_FILES];
+extern void *OS_impl_filehandle_fd[OS_MAX_NUM_OPEN_FILES];		/* FF_FILE, HANDLE, Socket_t or pipe */
+extern int8 OS_impl_filehandle_type[OS_MAX_NUM_OPEN_FILES];		/* volume type, -1 if not a file */
+extern uint8 OS_impl_filehandle_flags[OS_MAX_NUM_OPEN_FILES];		/* OS_FREERTOS_STREAM_xxx */
+
+/* Set by the FromISR calls when a simulated interrupt made a higher priority task ready */
+extern BaseType_t OS_impl_int_woken;
+
+#ifdef OS_INCLUDE_NETWORK
+extern const OS_FreeRTOS_stream_ops_t OS_FreeRTOS_SocketStreamOps;
+#endif
+extern const OS_FreeRTOS_stream_ops_t OS_FreeRTOS_PipeStreamOps;
 
 /****************************************************************************************
  FreeRTOS IMPLEMENTATION FUNCTION PROTOTYPES
@@ -89,8 +222,75 @@ int32 OS_FreeRTOS_TimeBaseAPI_Impl_Init(void);
 int32 OS_FreeRTOS_StreamAPI_Impl_Init(void);
 int32 OS_FreeRTOS_DirAPI_Impl_Init(void);
 int32 OS_FreeRTOS_FileSysAPI_Impl_Init(void);
+int32 OS_FreeRTOS_EventFlagsAPI_Impl_Init(void);
+int32 OS_FreeRTOS_PipeAPI_Impl_Init(void);
+
+int32 OS_Lock_Global_Shared_Impl(uint32 idtype);
+int32 OS_Unlock_Global_Shared_Impl(uint32 idtype);
 
 int32 OS_GetVolumeType(const char *VirtualPath);
+void  OS_FreeRTOS_VolumeIndexInvalidate(void);
+void  OS_FreeRTOS_DirSnapshotInvalidate(const char *local_path);
+void  OS_FreeRTOS_FileCacheInvalidate(const char *local_path);
+
+/*
+ * Select support of pipes, see ospipe.c.  A pipe mask has one bit per pipe
+ * table entry.  OS_FreeRTOS_PipeSetMask returns the open pipes of an OS_FdSet
+ * (which may be NULL); OS_FreeRTOS_PipeSetUpdate removes from the set the
+ * pipes of mask that are not in ready.  OS_FreeRTOS_PipeWait waits until any
+ * pipe of read_mask is readable or any of write_mask writable, and returns
+ * the ready pipes.
+ */
+uint32 OS_FreeRTOS_PipeSetMask(const OS_FdSet *set);
+void   OS_FreeRTOS_PipeSetUpdate(OS_FdSet *set, uint32 mask, uint32 ready);
+int32  OS_FreeRTOS_PipeWait(uint32 read_mask, uint32 write_mask, uint32 *ready_read, uint32 *ready_write, TickType_t ticks);
+int32  OS_FreeRTOS_PipeSelectSingle(uint32 local_id, uint32 *SelectFlags, TickType_t ticks);
+
+int32 OS_GenericWritev_Impl(uint32 local_id, const OS_iovec_t *iov, uint32 iovcnt, int32 timeout);
+int32 OS_GenericReadv_Impl(uint32 local_id, const OS_iovec_t *iov, uint32 iovcnt, int32 timeout);
+int32 OS_GenericPread_Impl(uint32 local_id, void *buffer, uint32 nbytes, int32 offset);
+int32 OS_GenericPwrite_Impl(uint32 local_id, const void *buffer, uint32 nbytes, int32 offset);
+int32 OS_DirReadAttributes_Impl(uint32 local_id, OS_dirent_attr_t *entries, uint32 max_entries, uint32 *count);
+int32 OS_FileMap_Impl(uint32 local_id, const void **addr, uint32 *size);
+int32 OS_FileUnmap_Impl(uint32 local_id, const void *addr);
 void  OS_UsecsToTicks(uint32 usecs, TickType_t *ticks);
 
+uint64 OS_FreeRTOS_ApiEnter(uint32 api);
+int32  OS_FreeRTOS_ApiExit(uint32 api, uint64 start, int32 status);
+
+uint32 OS_FreeRTOS_HeapCategorySet(uint32 category);
+void   OS_FreeRTOS_SocketSetRelease(TaskHandle_t task);
+void   OS_FreeRTOS_SemWaitRelease(TaskHandle_t task);
+void   OS_FreeRTOS_EventSetDetach(uint32 local_id);
+void   OS_FreeRTOS_WaitSetDetach(uint32 idtype, uint32 local_id);
+uint32 OS_FreeRTOS_RamDiskWriters(const void *io_manager);
+
+int32 OS_TimeBaseGetStats_Impl(uint32 timer_id, OS_timebase_stats_t *timebase_stats);
+void  OS_FreeRTOS_OverrunReport(uint32 object_id, uint32 elapsed_usec, uint32 period_usec);
+int32 OS_TaskGetStats_Impl(uint32 task_id, OS_task_stats_t *task_stats);
+
+int32 OS_BinSemGetStats_Impl(uint32 sem_id, OS_sem_stats_t *sem_stats);
+int32 OS_CountSemGetStats_Impl(uint32 sem_id, OS_sem_stats_t *sem_stats);
+int32 OS_MutSemTimedTake_Impl(uint32 sem_id, uint32 msecs);
+int32 OS_MutSemGetStats_Impl(uint32 sem_id, OS_mut_sem_stats_t *mut_stats);
+
+int32 OS_QueuePutTimed_Impl(uint32 queue_id, const void *data, uint32 size, uint32 flags, int32 timeout);
+int32 OS_QueueGetStats_Impl(uint32 queue_id, OS_queue_stats_t *queue_stats);
+int32 OS_QueueBufferAlloc_Impl(uint32 queue_id, void **buffer, int32 timeout);
+int32 OS_QueuePutBuffer_Impl(uint32 queue_id, void *buffer, uint32 size, uint32 flags);
+int32 OS_QueueGetBuffer_Impl(uint32 queue_id, void **buffer, uint32 *size, int32 timeout);
+int32 OS_QueueBufferRelease_Impl(uint32 queue_id, void *buffer);
+int32 OS_QueuePutBatch_Impl(uint32 queue_id, const void *data, uint32 size, uint32 count, uint32 *count_put, uint32 flags);
+int32 OS_QueueGetBatch_Impl(uint32 queue_id, void *data, uint32 size, uint32 *sizes, uint32 count, uint32 *count_copied, int32 timeout);
+
+#ifdef OS_INCLUDE_NETWORK
+int32 OS_SocketBufferAlloc_Impl(uint32 sock_id, void **buffer, uint32 size, int32 timeout);
+int32 OS_SocketSendToBuffer_Impl(uint32 sock_id, void *buffer, uint32 size, const OS_SockAddr_t *RemoteAddr);
+int32 OS_SocketRecvFromBuffer_Impl(uint32 sock_id, void **buffer, OS_SockAddr_t *RemoteAddr, int32 timeout);
+int32 OS_SocketBufferRelease_Impl(uint32 sock_id, void *buffer);
+int32 OS_SocketRecvFromBatch_Impl(uint32 sock_id, OS_socket_msg_t *msgs, uint32 count, uint32 *count_received, int32 timeout);
+int32 OS_SocketSendToBatch_Impl(uint32 sock_id, const OS_socket_msg_t *msgs, uint32 count, uint32 *count_sent);
+int32 OS_SocketSetOption_Impl(uint32 sock_id, uint32 option, const void *value, uint32 size);
+#endif
+
 
@@ -0,0 +1,2272 @@
+/*
+ *  NASA Docket No. GSC-18,370-1, and identified as "Operating System Abstraction Layer"
+ *
+ *  Copyright (c) 2019 United States Government as represented by
+ *  the Administrator of the National Aeronautics and Space Administration.
+ *  All Rights Reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * \file   osapi-os-freertos.h
+ *
+ * Purpose: This file contains the public extensions to the OSAL API that are
+ *          specific to the FreeRTOS port.  Applications that want to use these
+ *          calls include this file in addition to osapi.h.
+ *
+ *          Nothing in this file depends on FreeRTOS headers, so it is safe to
+ *          include from application code.
+ */
+
+#ifndef _osapi_os_freertos_
+#define _osapi_os_freertos_
+
+#include "common_types.h"
+#include "osapi.h"
+
+/****************************************************************************************
+ GLOBAL TABLE LOCK EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Table lock profile, see OS_GlobalLockGetStats()
+ *
+ * Only kept when the port is built with OS_FREERTOS_LOCK_PROFILING defined in
+ * osconfig.h.  Covers the exclusive acquires made through OS_Lock_Global_Impl.
+ */
+typedef struct
+{
+    uint32 acquire_count;      /**< Exclusive acquires of the lock */
+    uint32 wait_count;         /**< Acquires that found the lock taken and had to wait */
+    uint64 total_wait_usec;    /**< Total time spent waiting */
+    uint32 max_wait_usec;      /**< Longest single wait */
+    uint32 holder_id;          /**< OSAL task id of the current holder, 0 if free or not an OSAL task */
+    char   holder_name[OS_MAX_API_NAME]; /**< Task name of the current holder, empty if free */
+} OS_lock_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the profile of the table lock of one object type
+ *
+ * @param[in]  idtype     The object type, e.g. OS_OBJECT_TYPE_OS_QUEUE
+ * @param[out] lock_stats Filled with the lock profile
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INCORRECT_OBJ_TYPE if idtype has no table lock
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port was built without OS_FREERTOS_LOCK_PROFILING
+ */
+int32 OS_GlobalLockGetStats(uint32 idtype, OS_lock_stats_t *lock_stats);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Print the profile of every table lock to the console
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port was built without OS_FREERTOS_LOCK_PROFILING
+ */
+int32 OS_GlobalLockStatsDump(void);
+
+/****************************************************************************************
+ CALL STATISTICS EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Statistics of one OSAL call, see OS_ApiStatsGet()
+ *
+ * Only kept when the port is built with OS_FREERTOS_API_STATS defined in
+ * osconfig.h.  A call is an error when it returns a negative status.
+ */
+typedef struct
+{
+    char   name[OS_MAX_API_NAME];   /**< Call name, e.g. "QueueGet" for OS_QueueGet_Impl */
+    uint32 call_count;              /**< Calls made */
+    uint32 error_count;             /**< Calls that returned an error */
+    uint64 total_nsec;              /**< Total time spent in the call, blocking included */
+    uint64 max_nsec;                /**< Longest single call */
+    int32  error_code[OS_FREERTOS_API_STATS_ERRORS];        /**< Error codes returned, 0 for unused entries */
+    uint32 error_code_count[OS_FREERTOS_API_STATS_ERRORS];  /**< Times each error code was returned */
+} OS_api_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the statistics of one OSAL call
+ *
+ * The calls are numbered from 0, so an application can list all of them by
+ * counting up until OS_ERR_INVALID_ID is returned.
+ *
+ * @param[in]  index     Number of the call
+ * @param[out] api_stats Filled with the statistics
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_INVALID_POINTER if api_stats is NULL
+ * @retval #OS_ERR_INVALID_ID if index is past the last call
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port was built without OS_FREERTOS_API_STATS
+ */
+int32 OS_ApiStatsGet(uint32 index, OS_api_stats_t *api_stats);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Clear the statistics of every OSAL call
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port was built without OS_FREERTOS_API_STATS
+ */
+int32 OS_ApiStatsReset(void);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Print the statistics of every OSAL call made so far to the console
+ *
+ * Calls that were never made are left out.
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port was built without OS_FREERTOS_API_STATS
+ */
+int32 OS_ApiStatsDump(void);
+
+/****************************************************************************************
+ TASK EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Task creation flags (passed in the "flags" argument of OS_TaskCreate)
+ *
+ * In the Windows port every task runs on its own Win32 thread.  OS_TASK_CORE(n)
+ * pins that thread to logical processor n (0 to 63) before the task entry point
+ * is called, so the task does not migrate between cores.  Tasks created without
+ * it may run on any core the process is allowed to use, see
+ * configFREERTOS_SIM_CORE_MASK in FreeRTOSConfig.h.
+ */
+#define OS_TASK_CORE_PINNED             0x00010000
+#define OS_TASK_CORE_SHIFT              24
+#define OS_TASK_CORE_MASK               0x3F
+#define OS_TASK_CORE(n)                 (OS_TASK_CORE_PINNED | (((uint32)(n) & OS_TASK_CORE_MASK) << OS_TASK_CORE_SHIFT))
+
+/*
+ * Task run time and stack usage, see OS_TaskGetStats()
+ *
+ * Times come from the run time stats counter, see Run-time-stats-utils.c.  The
+ * counter wraps after about 11 hours, so a task has to be polled at least that
+ * often for run_time_usec to stay exact.
+ *
+ * A task really runs on the stack of its Win32 thread, which is far larger
+ * than the stack FreeRTOS allocates, so stack_free_min says little about it.
+ * With OS_FREERTOS_STACK_MONITOR defined in osconfig.h, the OSAL stack size is
+ * painted on the thread stack when the task starts and stack_used_peak tells
+ * how much of it the task has used; it is 0 otherwise.
+ *
+ * The period fields are 0 for a task that has not called OS_TaskPeriodSet.
+ */
+typedef struct
+{
+    uint64 run_time_usec;      /**< Time the task has spent running since it was created */
+    uint32 cpu_usage;          /**< Share of the CPU over the last window, in hundredths of a percent */
+    uint32 window_usec;        /**< Length of the window cpu_usage covers */
+    uint32 stack_size;         /**< Stack reserved for the task in bytes */
+    uint32 stack_free_min;     /**< Least free stack seen so far in bytes (high-water mark) */
+    uint32 freertos_priority;  /**< Current FreeRTOS priority, including any inherited priority */
+    uint32 stack_used_peak;    /**< Most of its OSAL stack size the task has used in bytes, see below */
+    bool   stack_overflow;     /**< The task has used all of its OSAL stack size */
+    uint32 period_usec;        /**< Release period, see OS_TaskPeriodSet() */
+    uint32 release_count;      /**< Releases the task has waited for since its period was set */
+    uint32 overrun_count;      /**< Releases that had passed before the task was ready for them */
+    uint32 max_lateness_usec;  /**< Most time a release had passed when the task came to wait for it */
+} OS_task_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the run time and stack usage of a task
+ *
+ * The CPU usage is measured over windows of OS_FREERTOS_CPU_WINDOW_MSEC (see
+ * osconfig.h).  Until the first window of a task has completed, it covers the
+ * time since the task was created.
+ *
+ * @param[in]  task_id    The task id
+ * @param[out] task_stats Filled with the task statistics
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_TaskGetStats(uint32 task_id, OS_task_stats_t *task_stats);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Make the calling task periodic
+ *
+ * Starts the releases of the calling task, the first one period_msec from
+ * now, and clears its period statistics.  A periodic task does its work, then
+ * calls OS_TaskPeriodWait, which waits for the next release through
+ * vTaskDelayUntil, so the period does not drift by the time the work takes
+ * the way it does with OS_TaskDelay.  The period is rounded up to whole ticks.
+ *
+ * @param[in] period_msec The period in milliseconds, 0 to stop the releases
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the caller is not an OSAL task
+ */
+int32 OS_TaskPeriodSet(uint32 period_msec);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Wait for the next release of the calling task
+ *
+ * When the task comes to wait after its next release has already passed,
+ * the releases it missed are counted as overruns and it waits for the first
+ * release still to come, so it keeps its phase rather than running the
+ * missed cycles back to back.  The overruns and the worst lateness are
+ * reported by OS_TaskGetStats.
+ *
+ * @param[out] missed Set to the releases missed since the previous wait, may be NULL
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the caller is not an OSAL task
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the task has no period set
+ */
+int32 OS_TaskPeriodWait(uint32 *missed);
+
+/*
+ * One task of a system profile snapshot, see OS_TaskProfileSnapshot()
+ *
+ * Covers every FreeRTOS task, not just the OSAL ones.  Kernel and port tasks
+ * have a task_id of 0 and are told apart by task_number.  cpu_delta_usec and
+ * elapsed_usec stop at 0xFFFFFFFF (about 71 minutes) rather than wrap.
+ */
+typedef struct
+{
+    uint32 task_id;            /**< OSAL task id, 0 if the task was not created through OSAL */
+    uint32 task_number;        /**< FreeRTOS task number, unique for the life of the application */
+    uint32 cpu_delta_usec;     /**< Run time since the previous snapshot, or since creation for a new task */
+    uint16 stack_free_min;     /**< Least free stack seen so far, in stack words */
+    uint8  priority;           /**< Current FreeRTOS priority */
+    uint8  state;              /**< FreeRTOS eTaskState: 0 running, 1 ready, 2 blocked, 3 suspended, 4 deleted */
+} OS_task_profile_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Take a profile snapshot of every task in the system
+ *
+ * The snapshot is taken in one go with the scheduler suspended, so all records
+ * are consistent with each other.  Run times are reported as the difference
+ * from the previous snapshot taken by any caller.
+ *
+ * @param[out] records      Filled with one record per task
+ * @param[in]  max_records  Number of records the array can hold; further tasks are left out
+ * @param[out] count        Set to the number of records filled in
+ * @param[out] elapsed_usec Set to the time since the previous snapshot
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERROR if the system has more than OS_FREERTOS_PROFILE_MAX_TASKS tasks
+ */
+int32 OS_TaskProfileSnapshot(OS_task_profile_t *records, uint32 max_records, uint32 *count, uint32 *elapsed_usec);
+
+/*
+ * CPU load of the whole system, see OS_CpuLoadGet()
+ *
+ * The load is the share of each window the kernel idle task did not run.
+ */
+typedef struct
+{
+    uint32 cpu_load;           /**< Load over the last completed window, in hundredths of a percent */
+    uint32 cpu_load_peak;      /**< Highest load of the last OS_FREERTOS_CPU_LOAD_PEAK_WINDOWS windows */
+    uint32 window_usec;        /**< Length of the window cpu_load covers */
+    uint32 window_count;       /**< Windows completed since the scheduler started */
+} OS_cpu_load_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the CPU load of the system
+ *
+ * The kernel idle hook closes a window every OS_FREERTOS_CPU_LOAD_WINDOW_MSEC (see
+ * osconfig.h), so no task has to poll for the figures to stay current.  A CPU too
+ * busy to run the idle task has its window closed by this call instead.  All
+ * fields are 0 until the first window has completed.
+ *
+ * @param[out] cpu_load Filled with the CPU load
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_CpuLoadGet(OS_cpu_load_t *cpu_load);
+
+/****************************************************************************************
+ MESSAGE QUEUE EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Queue creation flag (passed in the "flags" argument of OS_QueueCreate)
+ *
+ * A zero-copy queue only passes a buffer pointer and a length through the
+ * FreeRTOS queue.  The payload lives in a buffer pool that is allocated when the
+ * queue is created.  Producers obtain a buffer with OS_QueueBufferAlloc(), fill it
+ * and hand ownership to the queue with OS_QueuePutBuffer().  Consumers receive the
+ * buffer with OS_QueueGetBuffer() and must give it back with OS_QueueBufferRelease().
+ *
+ * The normal OS_QueuePut()/OS_QueueGet() calls still work on a zero-copy queue,
+ * they just copy into and out of a pool buffer internally.
+ */
+#define OS_QUEUE_ZERO_COPY              0x00010000
+
+/*
+ * Queue statistics, see OS_QueueGetStats()
+ *
+ * The counters are cumulative from the time the queue was created.
+ */
+typedef struct
+{
+    uint32 depth;              /**< Messages currently on the queue */
+    uint32 free_slots;         /**< Slots currently free */
+    uint32 max_depth;          /**< Depth the queue was created with */
+    uint32 max_size;           /**< Maximum message size the queue was created with */
+    uint32 peak_depth;         /**< Highest number of messages seen on the queue */
+    uint32 put_count;          /**< Messages put on the queue */
+    uint32 get_count;          /**< Messages taken off the queue */
+    uint32 full_count;         /**< Puts rejected because the queue was full */
+    uint32 timeout_count;      /**< Gets that timed out without a message */
+} OS_queue_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the live depth and the usage counters of a queue
+ *
+ * Meant for sizing OS_QUEUE_MAX_DEPTH and queue depths: run the application
+ * under load, then compare peak_depth and full_count against max_depth.
+ *
+ * @param[in]  queue_id    The queue id
+ * @param[out] queue_stats Filled with the queue statistics
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_QueueGetStats(uint32 queue_id, OS_queue_stats_t *queue_stats);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Put a message on a queue, waiting for room if the queue is full
+ *
+ * Same as OS_QueuePut, except the caller can block until a slot frees up
+ * instead of getting OS_QUEUE_FULL back straight away.
+ *
+ * @param[in] queue_id The queue id
+ * @param[in] data     The message to copy onto the queue
+ * @param[in] size     The size of the message, at most the queue's max_size
+ * @param[in] flags    Reserved, pass 0
+ * @param[in] timeout  OS_PEND, OS_CHECK or a number of milliseconds to wait
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS on success
+ * @retval #OS_QUEUE_FULL if the queue is full (OS_CHECK)
+ * @retval #OS_QUEUE_TIMEOUT if no room became available in time
+ */
+int32 OS_QueuePutTimed(uint32 queue_id, const void *data, uint32 size, uint32 flags, int32 timeout);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Obtain an empty message buffer from a zero-copy queue's pool
+ *
+ * The buffer is max_size bytes long (the data_size given to OS_QueueCreate).
+ * The caller owns the buffer until it is passed to OS_QueuePutBuffer or
+ * returned with OS_QueueBufferRelease.
+ *
+ * @param[in]  queue_id The queue id
+ * @param[out] buffer   Set to the address of the buffer
+ * @param[in]  timeout  OS_PEND, OS_CHECK or a number of milliseconds to wait
+ *                      for a buffer to become available
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS on success
+ * @retval #OS_QUEUE_FULL if no buffer is available (OS_CHECK)
+ * @retval #OS_QUEUE_TIMEOUT if no buffer became available in time
+ * @retval #OS_ERR_INCORRECT_OBJ_TYPE if the queue is not a zero-copy queue
+ */
+int32 OS_QueueBufferAlloc(uint32 queue_id, void **buffer, int32 timeout);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Put a pool buffer on a zero-copy queue without copying it
+ *
+ * On success ownership of the buffer passes to the queue (and from there to the
+ * consumer).  On failure the caller still owns the buffer.
+ *
+ * @param[in] queue_id The queue id
+ * @param[in] buffer   A buffer obtained from OS_QueueBufferAlloc on this queue
+ * @param[in] size     The number of valid bytes in the buffer
+ * @param[in] flags    Reserved, pass 0
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_BAD_ADDRESS if the buffer does not belong to this queue
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the buffer is not currently allocated
+ */
+int32 OS_QueuePutBuffer(uint32 queue_id, void *buffer, uint32 size, uint32 flags);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Receive a buffer from a zero-copy queue without copying it
+ *
+ * On success the caller owns the buffer and must release it with
+ * OS_QueueBufferRelease once the data has been consumed.
+ *
+ * @param[in]  queue_id The queue id
+ * @param[out] buffer   Set to the address of the received buffer
+ * @param[out] size     Set to the number of valid bytes in the buffer
+ * @param[in]  timeout  OS_PEND, OS_CHECK or a number of milliseconds
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_QueueGetBuffer(uint32 queue_id, void **buffer, uint32 *size, int32 timeout);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Return a buffer to a zero-copy queue's pool
+ *
+ * @param[in] queue_id The queue id
+ * @param[in] buffer   A buffer obtained from OS_QueueBufferAlloc or OS_QueueGetBuffer
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_BAD_ADDRESS if the buffer does not belong to this queue
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the buffer was already released
+ */
+int32 OS_QueueBufferRelease(uint32 queue_id, void *buffer);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Put several messages on a queue in one call
+ *
+ * The messages are packed back to back in "data", each "size" bytes long.
+ * The call never blocks.  It stops at the first message that does not fit,
+ * and messages already queued stay queued.
+ *
+ * @param[in]  queue_id  The queue id
+ * @param[in]  data      Array of "count" messages
+ * @param[in]  size      The size of each message, at most the queue's max_size
+ * @param[in]  count     The number of messages in "data"
+ * @param[out] count_put Set to the number of messages actually queued
+ * @param[in]  flags     Reserved, pass 0
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS if all messages were queued
+ * @retval #OS_QUEUE_FULL if the queue filled up before all messages were queued
+ */
+int32 OS_QueuePutBatch(uint32 queue_id, const void *data, uint32 size, uint32 count, uint32 *count_put, uint32 flags);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Receive several messages from a queue in one call
+ *
+ * Waits up to "timeout" for the first message, then takes whatever else is
+ * already queued (up to "count" messages in total) without waiting again.
+ * Message n is copied to data + n * size.
+ *
+ * @param[in]  queue_id     The queue id
+ * @param[out] data         Buffer of "count" slots of "size" bytes each
+ * @param[in]  size         The size of each slot, at least the queue's max_size
+ * @param[out] sizes        Optional array of "count" entries set to the length of
+ *                          each received message, may be NULL
+ * @param[in]  count        The number of slots in "data"
+ * @param[out] count_copied Set to the number of messages received
+ * @param[in]  timeout      OS_PEND, OS_CHECK or a number of milliseconds
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS if at least one message was received
+ * @retval #OS_QUEUE_EMPTY if no message was available (OS_CHECK)
+ * @retval #OS_QUEUE_TIMEOUT if no message arrived in time
+ */
+int32 OS_QueueGetBatch(uint32 queue_id, void *data, uint32 size, uint32 *sizes, uint32 count, uint32 *count_copied, int32 timeout);
+
+/****************************************************************************************
+ SEMAPHORE EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Counting semaphore creation option (passed in the "options" argument of
+ * OS_CountSemCreate)
+ *
+ * The semaphore is kept as a plain count plus a list of waiting tasks, and a
+ * waiting task sleeps on its FreeRTOS task notification instead of a kernel
+ * queue.  Give and take without contention never enter the kernel, and no
+ * kernel object is allocated.  Any number of tasks may wait at the same time.
+ *
+ * Only honoured when the port is built with OS_FREERTOS_SEM_NOTIFY defined in
+ * osconfig.h.  Otherwise the option is ignored and the semaphore is a kernel
+ * counting semaphore, as without it.
+ */
+#define OS_SEM_TASK_NOTIFY              0x00010000
+
+/*
+ * Semaphore contention statistics, see OS_BinSemGetStats() and OS_CountSemGetStats()
+ *
+ * Only kept when the port is built with OS_FREERTOS_SEM_STATS defined in osconfig.h.
+ * The counters are cumulative from the time the semaphore was created.
+ */
+typedef struct
+{
+    uint32 take_count;         /**< Successful takes */
+    uint32 blocked_count;      /**< Takes that had to wait, including those that timed out */
+    uint64 total_wait_usec;    /**< Total time spent waiting */
+    uint32 max_wait_usec;      /**< Longest single wait */
+} OS_sem_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the contention statistics of a binary semaphore
+ *
+ * @param[in]  sem_id    The binary semaphore id
+ * @param[out] sem_stats Filled with the semaphore statistics
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port was built without OS_FREERTOS_SEM_STATS
+ */
+int32 OS_BinSemGetStats(uint32 sem_id, OS_sem_stats_t *sem_stats);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the contention statistics of a counting semaphore
+ *
+ * @param[in]  sem_id    The counting semaphore id
+ * @param[out] sem_stats Filled with the semaphore statistics
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port was built without OS_FREERTOS_SEM_STATS
+ */
+int32 OS_CountSemGetStats(uint32 sem_id, OS_sem_stats_t *sem_stats);
+
+/*
+ * Mutex holder information and statistics, see OS_MutSemGetStats()
+ *
+ * The holder fields are always filled in.  The wait and hold times are only
+ * kept when the port is built with OS_FREERTOS_SEM_STATS defined in osconfig.h.
+ */
+typedef struct
+{
+    uint32 holder_id;          /**< OSAL task id of the holder, 0 if free or not an OSAL task */
+    char   holder_name[OS_MAX_API_NAME]; /**< Task name of the holder, empty if free */
+    uint32 holder_priority;    /**< Current FreeRTOS priority of the holder, including any inherited priority */
+    uint32 depth;              /**< Recursion depth of the holder */
+    uint32 hold_count;         /**< Completed (outermost) holds */
+    uint32 take_count;         /**< Successful takes, including recursive ones */
+    uint32 blocked_count;      /**< Takes that had to wait, including those that timed out */
+    uint64 total_wait_usec;    /**< Total time spent waiting for the mutex */
+    uint32 max_wait_usec;      /**< Longest single wait */
+    uint64 total_hold_usec;    /**< Total time the mutex was held */
+    uint32 max_hold_usec;      /**< Longest single hold */
+} OS_mut_sem_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Take a mutex, giving up after a timeout
+ *
+ * Same as OS_MutSemTake, except that the caller gets control back if the
+ * mutex is not available in time, e.g. because a lower priority holder is
+ * being held off the CPU.
+ *
+ * @param[in] sem_id The mutex id
+ * @param[in] msecs  The maximum time to wait, in milliseconds
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS on success
+ * @retval #OS_SEM_TIMEOUT if the mutex was not available in time
+ */
+int32 OS_MutSemTimedTake(uint32 sem_id, uint32 msecs);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the holder and the usage statistics of a mutex
+ *
+ * @param[in]  sem_id    The mutex id
+ * @param[out] mut_stats Filled with the mutex information
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_MutSemGetStats(uint32 sem_id, OS_mut_sem_stats_t *mut_stats);
+
+/****************************************************************************************
+ CONSOLE EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Console output statistics, see OS_ConsoleGetStats()
+ */
+typedef struct
+{
+    uint32 fast_count;         /**< Messages queued with OS_ConsoleWriteFast */
+    uint32 overflow_count;     /**< Messages dropped because the fast ring was full */
+    uint32 truncated_count;    /**< Messages cut to the slot size */
+    uint32 log_count;          /**< Records queued with OS_ConsoleLog */
+    uint32 log_overflow_count; /**< Records dropped because the log ring was full */
+    uint32 write_count;        /**< write() batches issued by the console task */
+    uint32 wake_count;         /**< Times the console task was woken to drain */
+    uint64 byte_count;         /**< Bytes written to the console device */
+} OS_console_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Queue text for the console without taking any lock
+ *
+ * Unlike OS_printf this never blocks: the text is copied into a slot of a
+ * lock-free ring that the console task drains, batched with other pending
+ * output.  Text longer than the slot (OS_FREERTOS_CONSOLE_SLOT_SIZE in
+ * osconfig.h, less a small header) is truncated, and a full ring drops the
+ * message and counts it.  Output from OS_printf and from this call are each
+ * kept in order but may interleave with each other.
+ *
+ * Must not be called from an interrupt.
+ *
+ * @param[in] text The text to output, need not be terminated
+ * @param[in] size Number of bytes of text
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_QUEUE_FULL if the ring was full; the message was dropped
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the console is not created yet
+ */
+int32 OS_ConsoleWriteFast(const char *text, uint32 size);
+
+/* Most arguments a binary log record can carry */
+#define OS_CONSOLE_LOG_MAX_ARGS         6
+
+/*
+ * Binary log record, see OS_ConsoleLog()
+ */
+typedef struct
+{
+    uint64 timestamp_nsec;     /**< OS_GetMonotonicNsec when the record was queued */
+    uint32 task_id;            /**< OSAL id of the task that queued it, 0 for other tasks */
+    uint16 format_id;
+    uint16 arg_count;
+    uint32 args[OS_CONSOLE_LOG_MAX_ARGS];
+} OS_console_log_record_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Queue a binary log record without formatting it
+ *
+ * The hot path of a log statement is reduced to copying a compact record
+ * (timestamp, task id, format id and the raw arguments) into a lock-free ring.
+ * Normally the console task formats the records later with the format
+ * registered by OS_ConsoleLogRegisterFormat, or hex dumps them if none is
+ * registered.  When the port is built with OS_FREERTOS_CONSOLE_LOG_OFFLINE
+ * defined in osconfig.h the records are left in the ring for the application
+ * to collect with OS_ConsoleLogRead, e.g. to ship them to an offline tool.
+ * This holds for a synchronous console too; otherwise, with no console task,
+ * the record is formatted and written right away.
+ *
+ * Like OS_ConsoleWriteFast this never blocks and must not be called from an
+ * interrupt.
+ *
+ * @param[in] format_id Identifies the message format
+ * @param[in] arg_count Number of arguments, at most OS_CONSOLE_LOG_MAX_ARGS
+ * @param[in] args      The raw arguments
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_QUEUE_FULL if the ring was full; the record was dropped
+ */
+int32 OS_ConsoleLog(uint16 format_id, uint32 arg_count, const uint32 *args);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Register the printf format the console task uses for a format id
+ *
+ * The format receives the record arguments as uint32 values, so it may only
+ * use 32 bit conversions such as %u, %d and %x.  The string is not copied and
+ * must stay valid.  Passing NULL reverts to the hex dump.
+ *
+ * @param[in] format_id Identifies the message format, below OS_FREERTOS_CONSOLE_LOG_FORMATS
+ * @param[in] format    The format string
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_ConsoleLogRegisterFormat(uint16 format_id, const char *format);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Collect unformatted binary log records
+ *
+ * Only available when the port is built with OS_FREERTOS_CONSOLE_LOG_OFFLINE.
+ * The records are removed from the ring; only one task may read it.
+ *
+ * @param[out] records     Filled with the oldest records
+ * @param[in]  max_records Number of entries in records
+ * @param[out] count       Set to the number of records returned
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the console task formats the records
+ */
+int32 OS_ConsoleLogRead(OS_console_log_record_t *records, uint32 max_records, uint32 *count);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the console output statistics
+ *
+ * @param[out] console_stats Filled with the console statistics
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_ConsoleGetStats(OS_console_stats_t *console_stats);
+
+/* Console sink types, see OS_ConsoleSinkAdd() */
+#define OS_CONSOLE_SINK_FILE            1
+#define OS_CONSOLE_SINK_UDP             2
+#define OS_CONSOLE_SINK_SHM             3
+
+/* Value of OS_console_shm_header_t.magic once a shared memory sink is initialized */
+#define OS_CONSOLE_SHM_MAGIC            0x4E43534F
+
+/*
+ * Layout of the shared memory console sink
+ *
+ * The header is followed by size bytes of text.  Byte n of the console stream
+ * is stored at offset n % size of the text, and written counts the bytes
+ * stored so far, so a viewer tails the stream by polling written and copying
+ * what it has not seen yet.  The port never waits for the viewer; text the
+ * viewer falls more than size bytes behind on is lost.
+ */
+typedef struct
+{
+    uint32          magic;
+    uint32          size;
+    volatile uint64 written;
+} OS_console_shm_header_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Send the console output to an additional sink
+ *
+ * Everything the console writes (OS_printf, OS_ConsoleWriteFast and formatted
+ * OS_ConsoleLog records) is copied to each sink.  Every sink has its own
+ * buffer of OS_FREERTOS_CONSOLE_SINK_BUFFER bytes and its own drain task, so a
+ * slow sink drops its own output rather than holding up the console.
+ *
+ * The target depends on the sink type:
+ *  - #OS_CONSOLE_SINK_FILE: OSAL path of a file on an FS_BASED volume, appended to
+ *  - #OS_CONSOLE_SINK_UDP:  "a.b.c.d" or "a.b.c.d:port", sent through the
+ *    FreeRTOS+TCP stack; the port defaults to configPRINT_PORT.  Only available
+ *    when OS_INCLUDE_NETWORK is defined.
+ *  - #OS_CONSOLE_SINK_SHM:  name of a Win32 file mapping, see OS_console_shm_header_t
+ *
+ * @param[in]  sink_type One of the OS_CONSOLE_SINK_* types
+ * @param[in]  target    Where the sink writes to
+ * @param[out] sink_id   Set to the id of the new sink
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NO_FREE_IDS if OS_FREERTOS_CONSOLE_MAX_SINKS sinks are open
+ */
+int32 OS_ConsoleSinkAdd(uint32 sink_type, const char *target, uint32 *sink_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Close a console sink
+ *
+ * Output already buffered for the sink is still written before its task
+ * closes the device.
+ *
+ * @param[in] sink_id The sink id returned by OS_ConsoleSinkAdd
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_ConsoleSinkRemove(uint32 sink_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the number of bytes a console sink has dropped
+ *
+ * @param[in]  sink_id The sink id returned by OS_ConsoleSinkAdd
+ * @param[out] dropped Set to the bytes that did not fit the sink buffer or failed to write
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_ConsoleSinkGetDropped(uint32 sink_id, uint32 *dropped);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Turn output to the console window on or off
+ *
+ * Writing to a Windows console window is slow; with a sink open the window
+ * can be turned off so that only the sinks receive the output.
+ *
+ * @param[in] enable false to stop writing to the standard output
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_ConsoleStdoutEnable(bool enable);
+
+/****************************************************************************************
+ FILE EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Additional OS_open/OS_creat flag: give the stream an OSAL managed buffer of
+ * OS_FREERTOS_FILE_BUFFER_SIZE bytes.  Small writes are gathered and handed to
+ * the file system in whole buffers (write-behind) and small reads are served
+ * from a read-ahead of the same size, which avoids a FAT sector
+ * read-modify-write per call on RAM disks.  Buffered data is written out by
+ * OS_FileFlush, by a seek and on close.
+ */
+#define OS_FILE_FLAG_BUFFERED           0x00010000
+
+/**
+ * @brief Open hints for host file (FS_BASED) streams
+ *
+ * Host files are accessed with Win32 overlapped I/O, so a task waiting for
+ * the host disk blocks like on any other FreeRTOS object and the other tasks
+ * keep running.  OS_FILE_FLAG_SEQUENTIAL tells the host cache the file is
+ * read front to back (FILE_FLAG_SEQUENTIAL_SCAN).  OS_FILE_FLAG_UNBUFFERED
+ * makes every write go through the host cache to disk (FILE_FLAG_WRITE_THROUGH);
+ * FILE_FLAG_NO_BUFFERING is not used as it requires sector aligned buffers,
+ * offsets and sizes.  Both hints are ignored on RAM disks.
+ */
+#define OS_FILE_FLAG_SEQUENTIAL         0x00020000
+#define OS_FILE_FLAG_UNBUFFERED         0x00040000
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Write out the buffered data of a stream
+ *
+ * Writes out the buffer of a stream opened with #OS_FILE_FLAG_BUFFERED and
+ * flushes the file system's own cache of the file.
+ *
+ * @param[in] filedes The file descriptor
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the stream type cannot be flushed, e.g. a socket
+ */
+int32 OS_FileFlush(uint32 filedes);
+
+/* Most elements OS_readv and OS_writev accept */
+#define OS_IOV_MAX                      16
+
+/*
+ * One element of a scatter/gather request, see OS_writev()
+ */
+typedef struct
+{
+    void   *base;
+    uint32  len;
+} OS_iovec_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Write several buffers to a stream in one call
+ *
+ * Equivalent to an OS_write of the concatenated buffers.  Small elements are
+ * gathered so that, for example, a record header, payload and trailer reach
+ * the file system or socket as a single write.
+ *
+ * @param[in] filedes The file descriptor
+ * @param[in] iov     The buffers to write, in order
+ * @param[in] iovcnt  Number of elements in iov, at most OS_IOV_MAX
+ *
+ * @return The number of bytes written, or an error status, see @ref OSReturnCodes
+ */
+int32 OS_writev(uint32 filedes, const OS_iovec_t *iov, uint32 iovcnt);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Read from a stream into several buffers in one call
+ *
+ * Equivalent to an OS_read of the total length, scattered over the buffers
+ * in order.  As with OS_read fewer bytes than requested may be returned.
+ *
+ * @param[in] filedes The file descriptor
+ * @param[in] iov     The buffers to fill, in order
+ * @param[in] iovcnt  Number of elements in iov, at most OS_IOV_MAX
+ *
+ * @return The number of bytes read, or an error status, see @ref OSReturnCodes
+ */
+int32 OS_readv(uint32 filedes, const OS_iovec_t *iov, uint32 iovcnt);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Read from a file at a given offset
+ *
+ * Seeks, reads and restores the file position as one operation on the
+ * descriptor, so several tasks can share a descriptor for random access
+ * without their own locking.  The file position is not changed.
+ *
+ * @param[in]  filedes The file descriptor
+ * @param[out] buffer  Filled with the data read
+ * @param[in]  nbytes  Number of bytes to read
+ * @param[in]  offset  Offset from the start of the file
+ *
+ * @return The number of bytes read, or an error status, see @ref OSReturnCodes
+ */
+int32 OS_pread(uint32 filedes, void *buffer, uint32 nbytes, int32 offset);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Write to a file at a given offset
+ *
+ * The writing counterpart of OS_pread.  The file position is not changed.
+ *
+ * @param[in] filedes The file descriptor
+ * @param[in] buffer  The data to write
+ * @param[in] nbytes  Number of bytes to write
+ * @param[in] offset  Offset from the start of the file
+ *
+ * @return The number of bytes written, or an error status, see @ref OSReturnCodes
+ */
+int32 OS_pwrite(uint32 filedes, const void *buffer, uint32 nbytes, int32 offset);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Get a read-only view of the contents of an open file
+ *
+ * Only files on RAM_DISK volumes, and files served from the file content
+ * cache, see OS_FileCacheGetStats, can be mapped.  When the file's clusters
+ * are contiguous the view points straight into the RAM disk; otherwise it is
+ * a heap snapshot taken at the time of the call.  In the direct case later
+ * writes through any descriptor show in the view, so the view is meant for
+ * read-mostly files such as tables.  A descriptor holds at most one view,
+ * which is released by OS_FileUnmap or on close.  An empty file maps to a
+ * NULL view of size 0.  The view of a cached file is the cached copy, which
+ * does not change while the descriptor is open.
+ *
+ * @param[in]  filedes The file descriptor
+ * @param[out] addr    Set to the start of the file data
+ * @param[out] size    Set to the file size in bytes
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the file is not on a RAM disk and not cached
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the descriptor already has a view
+ */
+int32 OS_FileMap(uint32 filedes, const void **addr, uint32 *size);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Release a view obtained from OS_FileMap
+ *
+ * @param[in] filedes The file descriptor
+ * @param[in] addr    The view returned by OS_FileMap
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_FileUnmap(uint32 filedes, const void *addr);
+
+/**
+ * @brief Statistics of the file content cache, see OS_FileCacheGetStats
+ */
+typedef struct
+{
+	uint32 hits;            /**< read-only opens served from the cache */
+	uint32 misses;          /**< read-only opens of files that were not cached */
+	uint32 invalidations;   /**< entries dropped because the file changed */
+	uint32 evictions;       /**< entries dropped to make room */
+	uint32 entries;         /**< files cached now */
+	uint32 bytes;           /**< bytes of file contents held now */
+	uint32 budget;          /**< most bytes of file contents held, OS_FREERTOS_FILE_CACHE_BYTES */
+} OS_file_cache_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Get the statistics of the file content cache
+ *
+ * With OS_FREERTOS_FILE_CACHE defined in osconfig.h, read-only opens of small
+ * files are served from a copy of the file kept in memory, as long as the
+ * file's size and modification time are unchanged.  Such a stream can be
+ * mapped with OS_FileMap whatever its volume, without a copy.
+ *
+ * @param[out] stats Filled with the statistics
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if OS_FREERTOS_FILE_CACHE is not defined
+ */
+int32 OS_FileCacheGetStats(OS_file_cache_stats_t *stats);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Copy a file without passing it through caller buffers
+ *
+ * Unlike OS_cp, which reads and writes the file through the stream calls:
+ * - between host (FS_BASED) volumes the host copies the file with CopyFileEx,
+ *   on a thread of its own while the calling task waits tick by tick;
+ * - to or from a RAM disk the file moves in chunks of whole clusters of up to
+ *   OS_FREERTOS_FILE_COPY_CHUNK bytes, bypassing the FreeRTOS+FAT sector cache.
+ * An existing destination is replaced.  A destination left incomplete by an
+ * error is removed.
+ *
+ * @param[in] src  Virtual path of the file to copy
+ * @param[in] dest Virtual path of the copy
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_FS_ERR_PATH_INVALID if either path is not on a RAM disk or host volume
+ */
+int32 OS_FileCopy(const char *src, const char *dest);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Move a file, between volumes as well
+ *
+ * A rename where the file system can do one: within a RAM disk and between
+ * host paths, across host drives too (MoveFileEx).  Otherwise, as between a
+ * RAM disk and a host volume, the file is copied as by OS_FileCopy and the
+ * source removed once the copy is complete.  OS_rename moves files between
+ * RAM disk and host volumes the same way.
+ *
+ * @param[in] src  Virtual path of the file to move
+ * @param[in] dest Virtual path to move it to
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_FS_ERR_PATH_INVALID if either path is not on a RAM disk or host volume
+ */
+int32 OS_FileMove(const char *src, const char *dest);
+
+/**
+ * @brief Asynchronous file I/O
+ *
+ * Requests are served in submission order by a worker task of configurable
+ * priority (OS_FREERTOS_FILE_ASYNC in osconfig.h), so the submitting task
+ * never waits for storage.  The request structure belongs to the caller and
+ * must stay valid, untouched, until done is set.
+ */
+#define OS_FILE_ASYNC_READ              1   /**< read nbytes into buffer */
+#define OS_FILE_ASYNC_WRITE             2   /**< write nbytes from buffer */
+#define OS_FILE_ASYNC_FLUSH             3   /**< like OS_FileFlush */
+
+#define OS_FILE_ASYNC_NOTIFY_NONE       0   /**< caller polls done */
+#define OS_FILE_ASYNC_NOTIFY_CALLBACK   1   /**< callback runs in the worker task */
+#define OS_FILE_ASYNC_NOTIFY_SEMAPHORE  2   /**< binary semaphore notify_id is given */
+#define OS_FILE_ASYNC_NOTIFY_TASK       3   /**< submitting task is notified, see OS_FileAsyncWait */
+
+typedef struct OS_file_async_request OS_file_async_request_t;
+
+typedef void (*OS_FileAsyncCallback_t)(OS_file_async_request_t *request);
+
+struct OS_file_async_request
+{
+	uint32 filedes;
+	uint32 op;                          /**< OS_FILE_ASYNC_READ, _WRITE or _FLUSH */
+	void *buffer;
+	uint32 nbytes;
+	int32 offset;                       /**< file offset, or -1 for the current position */
+	uint32 notify;                      /**< one of OS_FILE_ASYNC_NOTIFY_* */
+	OS_FileAsyncCallback_t callback;
+	uint32 notify_id;
+	void *arg;                          /**< for the caller's use */
+
+	/* set by the implementation */
+	volatile int32 status;              /**< result of the transfer, as from OS_read/OS_write */
+	volatile bool done;
+	void *submitter;
+};
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Queue a file request for the asynchronous I/O worker
+ *
+ * Does not block.  The outcome is in the request's status once done is set.
+ *
+ * @param[in,out] request The request, see OS_file_async_request_t
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_QUEUE_FULL if OS_FREERTOS_FILE_ASYNC_DEPTH requests are already waiting
+ * @retval #OS_ERR_NOT_IMPLEMENTED if OS_FREERTOS_FILE_ASYNC is not defined
+ */
+int32 OS_FileAsyncSubmit(OS_file_async_request_t *request);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Wait for a request submitted with OS_FILE_ASYNC_NOTIFY_TASK
+ *
+ * Must be called by the submitting task.  Uses the task's FreeRTOS
+ * notification value.
+ *
+ * @param[in] request The request
+ * @param[in] msecs   Time to wait, or OS_PEND to wait forever
+ *
+ * @return The request's status, or an error status, see @ref OSReturnCodes
+ * @retval #OS_ERROR_TIMEOUT if the request did not complete in time
+ */
+int32 OS_FileAsyncWait(OS_file_async_request_t *request, int32 msecs);
+
+/**
+ * @brief A directory entry with its attributes, see OS_DirReadAttributes
+ *
+ * FileModeBits, FileTime and FileSize are in the form OS_stat reports them;
+ * FileTime is the modification time in seconds since 1970, or 0 on RAM disks
+ * built without ffconfigTIME_SUPPORT.
+ */
+typedef struct
+{
+	char FileName[OS_MAX_PATH_LEN];
+	uint32 FileModeBits;
+	int32 FileTime;
+	uint32 FileSize;
+} OS_dirent_attr_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Read the next directory entries together with their attributes
+ *
+ * The attributes come from the directory search itself, so no OS_stat per
+ * entry is needed.  Reads continue where OS_DirectoryRead left off and vice
+ * versa.
+ *
+ * @param[in]  dir_id      The directory, from OS_DirectoryOpen
+ * @param[out] entries     Filled with up to max_entries entries
+ * @param[in]  max_entries Size of entries
+ * @param[out] count       Set to the number of entries filled in
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_FS_ERROR at the end of the directory, when no entry was read
+ */
+int32 OS_DirReadAttributes(uint32 dir_id, OS_dirent_attr_t *entries, uint32 max_entries, uint32 *count);
+
+/****************************************************************************************
+ FILE SYSTEM EXTENSIONS
+ ***************************************************************************************/
+
+/**
+ * @brief RAM disk (OS_FILESYS_TYPE_VOLATILE_DISK) parameters
+ *
+ * The sector size is the block size given to OS_mkfs: 512 to 4096, a power
+ * of two, anything else gives 512.  FreeRTOS+FAT picks the cluster size
+ * itself; small_clusters and prefer_fat16 steer its choice.
+ * A disk with the same sector count, sector size and cluster options as one
+ * formatted before is stamped from a copy of that format instead, see
+ * OS_FREERTOS_RAMDISK_TEMPLATES in osconfig.h.
+ *
+ * When image_path names a host file, such as one written by
+ * OS_FileSysRamDiskSave, the disk is mapped from it instead of being
+ * allocated and formatted.  The file must hold at least numblocks sectors.
+ * Changes stay in memory unless image_write_back is set, in which case they
+ * are written back to the file.
+ */
+typedef struct
+{
+	uint32 cache_size;                  /**< I/O manager cache, bytes; rounded up to whole sectors */
+	bool small_clusters;
+	bool prefer_fat16;
+	char image_path[OS_MAX_LOCAL_PATH_LEN];
+	bool image_write_back;
+} OS_ramdisk_params_t;
+
+/**
+ * @brief RAM disk cache counters, see OS_FileSysGetCacheStats
+ *
+ * The block driver is only called for sectors that are not in the cache, so
+ * the read counts are the cache misses and the write counts the write-backs.
+ */
+typedef struct
+{
+	uint32 sector_size;
+	uint32 cache_size;
+	uint32 read_requests;
+	uint32 read_sectors;
+	uint32 write_requests;
+	uint32 write_sectors;
+} OS_filesys_cache_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Set the parameters of a RAM disk before it is made
+ *
+ * Applies to OS_mkfs and OS_initfs calls for the device from then on.
+ * Devices that are not configured get OS_FREERTOS_RAMDISK_CACHE_SIZE of
+ * cache and small FAT16 clusters.
+ *
+ * @param[in] devname The device name given to OS_mkfs
+ * @param[in] params  The parameters
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_FileSysRamDiskConfigure(const char *devname, const OS_ramdisk_params_t *params);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Save the contents of a RAM disk to a host file
+ *
+ * Writes the whole storage, after flushing the FreeRTOS+FAT cache, so the
+ * file can later be given as image_path of OS_ramdisk_params_t.  Path
+ * operations on any file system wait until the copy is done.  A file open
+ * for writing on the disk could be saved half written, so the save is
+ * refused until it is closed.
+ *
+ * @param[in] devname   The device name given to OS_mkfs
+ * @param[in] host_path Path of the image file in the host file system
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if a file on the disk is open for writing
+ */
+int32 OS_FileSysRamDiskSave(const char *devname, const char *host_path);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Get the cache counters of a RAM disk
+ *
+ * @param[in]  devname The device name given to OS_mkfs
+ * @param[out] stats   Filled with the counters
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_FS_ERR_DRIVE_NOT_CREATED if there is no such RAM disk
+ */
+int32 OS_FileSysGetCacheStats(const char *devname, OS_filesys_cache_stats_t *stats);
+
+/****************************************************************************************
+ MODULE EXTENSIONS
+ ***************************************************************************************/
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Start the modules of the static loader's startup table
+ *
+ * Runs the init function of every module listed in the startup table of
+ * simplestaticloader.inc (known_startup[]).  A module is started once all the
+ * modules it depends on have started successfully; modules that do not
+ * depend on each other are started concurrently on up to worker_count tasks
+ * running at the caller's priority, lower priority numbers first.  A module
+ * whose dependency failed is not started.  A timing report is printed when
+ * all are done.
+ *
+ * The init functions are found in known_symbols[] whether the module was
+ * loaded with OS_ModuleLoad or not.
+ *
+ * @param[in] worker_count Number of worker tasks, 0 for OS_FREERTOS_STARTUP_MAX_WORKERS
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS if every module was started, or there is no startup table
+ * @retval #OS_ERROR if a module failed, was not started, or the table names an unknown dependency
+ */
+int32 OS_ModuleStartup(uint32 worker_count);
+
+/****************************************************************************************
+ SOCKET EXTENSIONS
+ ***************************************************************************************/
+
+#ifdef OS_INCLUDE_NETWORK
+
+/*
+ * Zero-copy datagrams
+ *
+ * A datagram socket can hand payloads to and from FreeRTOS+TCP without
+ * copying them.  Get a network buffer with OS_SocketBufferAlloc(), fill it and
+ * pass it to OS_SocketSendToBuffer(), which gives it to the stack.  On the
+ * receive side OS_SocketRecvFromBuffer() hands over the stack's own buffer;
+ * give it back with OS_SocketBufferRelease() once done with it.  The example
+ * of a zero-copy queue applies: do not hold network buffers longer than
+ * needed, the stack only has ipconfigNUM_NETWORK_BUFFER_DESCRIPTORS of them.
+ */
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Get a network buffer to send a datagram from
+ *
+ * @param[in]  sock_id The datagram socket the buffer will be sent on
+ * @param[out] buffer  Set to the payload area of the buffer
+ * @param[in]  size    The payload size needed, at most the UDP payload of one frame
+ * @param[in]  timeout OS_PEND, OS_CHECK or a number of milliseconds to wait
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS on success
+ * @retval #OS_ERROR_TIMEOUT if no buffer of that size became available in time
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the socket is not a datagram socket
+ */
+int32 OS_SocketBufferAlloc(uint32 sock_id, void **buffer, uint32 size, int32 timeout);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Send a datagram from a network buffer
+ *
+ * On success the buffer belongs to the stack again.  On failure it still
+ * belongs to the caller, who can retry or release it.
+ *
+ * @param[in] sock_id    The datagram socket
+ * @param[in] buffer     A buffer from OS_SocketBufferAlloc or OS_SocketRecvFromBuffer
+ * @param[in] size       The payload length, at most the size it was allocated with
+ * @param[in] RemoteAddr The destination
+ *
+ * @return The number of bytes sent, or an error code, see @ref OSReturnCodes
+ */
+int32 OS_SocketSendToBuffer(uint32 sock_id, void *buffer, uint32 size, const OS_SockAddr_t *RemoteAddr);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Receive a datagram without copying it
+ *
+ * @param[in]  sock_id    The datagram socket
+ * @param[out] buffer     Set to the payload of the received datagram
+ * @param[out] RemoteAddr Set to the sender address, may be NULL
+ * @param[in]  timeout    OS_PEND, OS_CHECK or a number of milliseconds to wait
+ *
+ * @return The payload length, or an error code, see @ref OSReturnCodes
+ * @retval #OS_ERROR_TIMEOUT if no datagram arrived in time
+ */
+int32 OS_SocketRecvFromBuffer(uint32 sock_id, void **buffer, OS_SockAddr_t *RemoteAddr, int32 timeout);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Give a network buffer back to the stack
+ *
+ * @param[in] sock_id The socket the buffer was obtained for
+ * @param[in] buffer  A buffer from OS_SocketBufferAlloc or OS_SocketRecvFromBuffer
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_SocketBufferRelease(uint32 sock_id, void *buffer);
+
+/*
+ * One datagram of a batch, see OS_SocketRecvFromBatch() and OS_SocketSendToBatch()
+ */
+typedef struct
+{
+    void         *buffer;      /**< Payload */
+    uint32        size;        /**< Receive: in the buffer size, out the datagram length.  Send: the payload length */
+    OS_SockAddr_t addr;        /**< Receive: set to the sender.  Send: the destination */
+} OS_socket_msg_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Receive several datagrams in one call
+ *
+ * Waits up to "timeout" for the first datagram, then takes whatever else is
+ * already queued on the socket, up to "count" datagrams, without waiting.
+ * The socket is looked up once for the whole batch.
+ *
+ * @param[in]     sock_id        The datagram socket
+ * @param[in,out] msgs           Array of "count" messages, see OS_socket_msg_t
+ * @param[in]     count          The number of messages in "msgs"
+ * @param[out]    count_received Set to the number of datagrams received
+ * @param[in]     timeout        OS_PEND, OS_CHECK or a number of milliseconds to wait for the first datagram
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS if at least one datagram was received
+ * @retval #OS_ERROR_TIMEOUT if no datagram arrived in time
+ */
+int32 OS_SocketRecvFromBatch(uint32 sock_id, OS_socket_msg_t *msgs, uint32 count, uint32 *count_received, int32 timeout);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Send several datagrams in one call
+ *
+ * Sends the messages in order and stops at the first one that fails.
+ *
+ * @param[in]  sock_id    The datagram socket
+ * @param[in]  msgs       Array of "count" messages, see OS_socket_msg_t
+ * @param[in]  count      The number of messages in "msgs"
+ * @param[out] count_sent Set to the number of datagrams sent
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS if all datagrams were sent
+ * @return The error of the first datagram that could not be sent otherwise
+ */
+int32 OS_SocketSendToBatch(uint32 sock_id, const OS_socket_msg_t *msgs, uint32 count, uint32 *count_sent);
+
+/*
+ * Socket options, see OS_SocketSetOption()
+ *
+ * Unless noted otherwise the value is a uint32.  The buffer and window sizes
+ * of a TCP socket are fixed when the connection is set up, so set them before
+ * OS_SocketConnect, or before OS_SocketBind for a listening socket (accepted
+ * connections inherit them).
+ */
+#define OS_SOCKET_OPT_RCVBUF            1   /**< Receive buffer size in bytes */
+#define OS_SOCKET_OPT_SNDBUF            2   /**< Send buffer size in bytes */
+#define OS_SOCKET_OPT_WINDOW            3   /**< TCP buffer and window sizes, value is an OS_socket_window_t */
+#define OS_SOCKET_OPT_BACKLOG           4   /**< Pending connections a listening socket queues, 10 by default; set before OS_SocketBind */
+#define OS_SOCKET_OPT_NODELAY           5   /**< Non-zero to send TCP data at once instead of waiting for full segments */
+#define OS_SOCKET_OPT_SNDTIMEO          6   /**< Milliseconds a send waits for buffer space, OS_PEND to wait forever */
+
+/*
+ * TCP buffer and window sizes, see OS_SOCKET_OPT_WINDOW
+ *
+ * The window sizes are counted in maximum sized segments (MSS) as in
+ * FreeRTOS+TCP, the buffer sizes in bytes.
+ */
+typedef struct
+{
+    uint32 tx_buffer_size;
+    uint32 tx_window_size;
+    uint32 rx_buffer_size;
+    uint32 rx_window_size;
+} OS_socket_window_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Set a socket option
+ *
+ * @param[in] sock_id The socket
+ * @param[in] option  One of the OS_SOCKET_OPT_xxx values
+ * @param[in] value   The option value, see the option
+ * @param[in] size    Size of the value in bytes
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS on success
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the option is unknown or does not apply to the socket type
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if OS_SOCKET_OPT_BACKLOG is set on a socket that is
+ *                   already bound, and so listening, or connected
+ * @retval #OS_ERROR if the size does not match the option, or FreeRTOS+TCP refused the
+ *                   value, e.g. because the connection is already set up
+ */
+int32 OS_SocketSetOption(uint32 sock_id, uint32 option, const void *value, uint32 size);
+
+/*
+ * Persistent event sets
+ *
+ * An event set is an alternative to OS_SelectMultiple for loops that serve
+ * many sockets.  Sockets are registered once with OS_EventSetAdd and stay in
+ * the set until removed or closed; OS_EventSetWait then only has to look at
+ * the registered sockets and returns the ready ones as a list.  A socket can
+ * be in one event set at a time.  Reading from a registered socket is fine,
+ * it goes back into its set after any OS_SelectSingle the read does.
+ */
+
+/* One ready socket, see OS_EventSetWait() */
+typedef struct
+{
+    uint32 stream_id;          /**< The socket id */
+    uint32 events;             /**< OS_STREAM_STATE_READABLE and/or OS_STREAM_STATE_WRITABLE */
+} OS_stream_ready_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Create an empty event set
+ *
+ * @param[out] set_id Set to the id of the new set, used with the other OS_EventSet calls
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NO_FREE_IDS if OS_FREERTOS_MAX_EVENT_SETS sets already exist
+ */
+int32 OS_EventSetCreate(uint32 *set_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Delete an event set, removing all its sockets
+ *
+ * Tasks still waiting on the set return #OS_ERROR_TIMEOUT, within
+ * OS_FREERTOS_EVENT_SET_POLL_MSEC.  The id is not reused by the next set
+ * created in its place.
+ *
+ * @param[in] set_id The event set id
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_EventSetDelete(uint32 set_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Register a socket with an event set, or change its events
+ *
+ * A closed TCP connection is reported as readable, so the next read sees
+ * the end of the stream.
+ *
+ * @param[in] set_id    The event set id
+ * @param[in] stream_id The socket id
+ * @param[in] events    OS_STREAM_STATE_READABLE and/or OS_STREAM_STATE_WRITABLE
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the socket is in another event set
+ */
+int32 OS_EventSetAdd(uint32 set_id, uint32 stream_id, uint32 events);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Remove a socket from an event set
+ *
+ * @param[in] set_id    The event set id
+ * @param[in] stream_id The socket id
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the socket is not in the set
+ */
+int32 OS_EventSetRemove(uint32 set_id, uint32 stream_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Wait until sockets of an event set are ready
+ *
+ * @param[in]  set_id    The event set id
+ * @param[out] ready     Array of "max_ready" entries, filled with the ready sockets
+ * @param[in]  max_ready The number of entries in "ready"; further ready sockets are
+ *                       reported by the next call
+ * @param[out] count     Set to the number of entries filled in
+ * @param[in]  msecs     OS_PEND, OS_CHECK or a number of milliseconds to wait
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS if at least one socket is ready
+ * @retval #OS_ERROR_TIMEOUT if none became ready in time
+ */
+int32 OS_EventSetWait(uint32 set_id, OS_stream_ready_t *ready, uint32 max_ready, uint32 *count, int32 msecs);
+
+#endif /* OS_INCLUDE_NETWORK */
+
+/****************************************************************************************
+ VIRTUAL NETWORK EXTENSIONS
+ ***************************************************************************************/
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Parse an IP or MAC address given on the command line
+ *
+ * Lets a BSP give each instance its own addresses before FreeRTOS_IPInit, so
+ * several instances can share the shared memory network (OS_FREERTOS_NET_SHM
+ * in osconfig.h) or a physical one.
+ *
+ * @param[in]  text  "a.b.c.d" in decimal when count is 4, "xx:xx:xx:xx:xx:xx"
+ *                   in hex when count is 6
+ * @param[out] bytes Set to the address, left alone if the text is not valid
+ * @param[in]  count 4 for an IP address, 6 for a MAC address
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_INVALID_POINTER if an argument is NULL
+ * @retval #OS_ERROR if the text is not a valid address or count is not 4 or 6
+ */
+int32 OS_NetAddressParse(const char *text, uint8 *bytes, uint32 count);
+
+/****************************************************************************************
+ TIMEBASE EXTENSIONS
+ ***************************************************************************************/
+
+/* Number of latency histogram bins, see OS_timebase_stats_t */
+#define OS_TIMEBASE_LATENCY_BINS        16
+
+/*
+ * Timebase statistics, see OS_TimeBaseGetStats()
+ *
+ * Only kept for simulated timebases and those of OS_TimeBaseCreateExternal,
+ * not for timebases with an application sync function.  An external timebase
+ * has no nominal expiry time, so its latency fields and histogram stay 0; its
+ * expiry_count counts the wake ups of the servicing task, and the ticks of the
+ * source that arrived before the previous callbacks were done count as
+ * coalesced and dropped.
+ *
+ * The callback time runs from the servicing task being released for an expiry
+ * until it comes back to wait for the next one, so it covers every callback
+ * of the timebase.  Callbacks that take longer than the timebase interval are
+ * an overrun: the next expiry is serviced late, and an expiry that falls due
+ * while the previous one is still waiting to be serviced is dropped, since
+ * expiries are not queued.
+ *
+ * The latency fields are only kept when the port is built with
+ * OS_FREERTOS_TIMEBASE_STATS defined in osconfig.h, and are 0 otherwise.  The latency is the time from the nominal expiry to the servicing
+ * task waking up; it can be slightly negative since the timer runs on whole
+ * ticks.  Bin 0 of the histogram counts latencies below 1 usec, bin n those from
+ * 2^(n-1) up to 2^n usec, and the last bin everything longer.
+ */
+typedef struct
+{
+    uint32 expiry_count;       /**< Expiries serviced */
+    uint32 coalesced_count;    /**< Expiries merged into the next because the previous one was not serviced yet */
+    int32  min_latency_usec;
+    int32  max_latency_usec;
+    int32  mean_latency_usec;
+    uint32 histogram[OS_TIMEBASE_LATENCY_BINS];
+    uint32 overrun_count;      /**< Expiries whose callbacks took longer than the interval */
+    uint32 dropped_count;      /**< Expiries lost because the previous one was not serviced yet */
+    uint32 last_callback_usec; /**< Time the callbacks of the last expiry took */
+    uint32 max_callback_usec;  /**< Most time the callbacks of one expiry took */
+} OS_timebase_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the overrun and latency statistics of a timebase
+ *
+ * The statistics restart whenever the timebase is set with OS_TimeBaseSet.
+ *
+ * @param[in]  timebase_id    The timebase id
+ * @param[out] timebase_stats Filled with the timebase statistics
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the timebase uses an application sync function
+ */
+int32 OS_TimeBaseGetStats(uint32 timebase_id, OS_timebase_stats_t *timebase_stats);
+
+/* External tick sources, see OS_TimeBaseCreateExternal() */
+#define OS_TIMEBASE_SOURCE_EVENT        1   /**< Named Win32 event, one expiry per signal */
+#define OS_TIMEBASE_SOURCE_COUNTER      2   /**< Named shared memory section holding a 32 bit tick counter */
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Create a timebase driven by a tick source outside the application
+ *
+ * The timebase expires once for every tick of the source instead of on a
+ * simulated timer, so its timers follow the clock of e.g. a simulator or a
+ * hardware-in-the-loop driver.  The source is a Win32 auto-reset event the
+ * driver sets once per tick, or a shared memory section whose first 4 bytes
+ * hold a little endian tick count the driver increments.  Either is created
+ * if it does not exist yet, so the driver may start before or after the
+ * application.  Ticks counted while the servicing task was busy are all
+ * delivered on its next wake up; signals of an event can merge.
+ *
+ * tick_usec is the time one tick stands for.  It is what the timebase
+ * advances per tick, and thus what the intervals of its timers are measured
+ * in.  OS_TimeBaseSet has no effect on such a timebase.  It is deleted with
+ * OS_TimeBaseDelete like any other.
+ *
+ * Only available when the port is built with OS_FREERTOS_TIMEBASE_EXTERNAL
+ * defined in osconfig.h.
+ *
+ * @param[out] timebase_id   Set to the id of the new timebase
+ * @param[in]  timebase_name The name of the timebase
+ * @param[in]  source_type   #OS_TIMEBASE_SOURCE_EVENT or #OS_TIMEBASE_SOURCE_COUNTER
+ * @param[in]  source_name   Win32 name of the event or section, e.g. "Local\\SimClock"
+ * @param[in]  tick_usec     Time per tick in microseconds
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port is built without OS_FREERTOS_TIMEBASE_EXTERNAL
+ * @retval #OS_TIMER_ERR_INVALID_ARGS if the source type is unknown or tick_usec is 0
+ * @retval #OS_TIMER_ERR_INTERNAL if the source cannot be opened
+ */
+int32 OS_TimeBaseCreateExternal(uint32 *timebase_id, const char *timebase_name, uint32 source_type,
+                                const char *source_name, uint32 tick_usec);
+
+/*
+ * Called for each overrun, see OS_OverrunHookSet().  object_id is the
+ * timebase or task id, elapsed_usec the time the callbacks or the cycle
+ * took, and period_usec the time they had.
+ */
+typedef void (*OS_overrun_hook_t)(uint32 object_id, uint32 elapsed_usec, uint32 period_usec);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Set the function called for every overrun
+ *
+ * The hook is called from the servicing task of a timebase whose callbacks
+ * took longer than its interval, and from a periodic task whose next release
+ * had already passed when it called OS_TaskPeriodWait.  It runs before that
+ * task goes on, so it should only record or signal the overrun.
+ *
+ * @param[in] hook The hook, NULL for none
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_OverrunHookSet(OS_overrun_hook_t hook);
+
+/****************************************************************************************
+ INTERRUPT EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * OS_IntAttachHandler attaches a handler to one of the Win32 port's simulated
+ * interrupts, 2 to 31 except those the port uses itself (see osconfig.h).  A
+ * Win32 thread standing in for a device raises the interrupt with OS_IntRaise();
+ * the handler then runs with the scheduler held off and may only use the
+ * FromISR calls below.  A task one of them makes ready runs as soon as the
+ * handler returns if it has a higher priority than the interrupted task.
+ *
+ * The objects a handler uses must not be deleted while it is attached.
+ */
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Give a binary semaphore from an interrupt handler
+ *
+ * @param[in] sem_id The binary semaphore id
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ */
+int32 OS_BinSemGiveFromISR(uint32 sem_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Give a counting semaphore from an interrupt handler
+ *
+ * @param[in] sem_id The counting semaphore id
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SEM_FAILURE if the semaphore is already at its maximum value
+ */
+int32 OS_CountSemGiveFromISR(uint32 sem_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Put a message on a queue from an interrupt handler
+ *
+ * Never waits, like OS_QueuePut().
+ *
+ * @param[in] queue_id The queue id
+ * @param[in] data     The message
+ * @param[in] size     The size of the message
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_QUEUE_FULL if the queue has no room for the message
+ */
+int32 OS_QueuePutFromISR(uint32 queue_id, const void *data, uint32 size);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Raise a simulated interrupt
+ *
+ * May be called from a Win32 thread or from a task.
+ *
+ * @param[in] InterruptNumber A simulated interrupt with a handler attached
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_INVALID_INT_NUM if the number cannot be used by the application
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if no handler is attached
+ */
+int32 OS_IntRaise(uint32 InterruptNumber);
+
+/****************************************************************************************
+ HEAP EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Object types the heap usage is broken down by, see OS_heap_stats_t
+ */
+#define OS_HEAP_CATEGORY_OTHER          0   /**< Anything not listed below, including heap overhead */
+#define OS_HEAP_CATEGORY_TASK           1   /**< Task control blocks and stacks */
+#define OS_HEAP_CATEGORY_QUEUE          2   /**< Message queues, pipes and their buffers */
+#define OS_HEAP_CATEGORY_SEMAPHORE      3   /**< Semaphores, mutexes and event flags */
+#define OS_HEAP_CATEGORY_FILESYS        4   /**< RAM disk storage and FreeRTOS+FAT caches */
+#define OS_HEAP_CATEGORY_NETWORK        5   /**< FreeRTOS+TCP sockets */
+#define OS_HEAP_CATEGORY_TIMER          6   /**< Timebases and their servicing tasks */
+#define OS_HEAP_CATEGORY_COUNT          7
+
+/*
+ * FreeRTOS heap statistics, see OS_HeapGetStats()
+ *
+ * A largest_free_block well below free_bytes means the free space is
+ * fragmented.  The per-type figures are only kept when the port is built with
+ * configFREERTOS_SIM_HEAP_ATTRIBUTION set in FreeRTOSConfig.h, otherwise all
+ * the allocated bytes are reported as OS_HEAP_CATEGORY_OTHER.  With a kernel
+ * older than FreeRTOS V10.2.0 only free_bytes, min_free_bytes and the per-type
+ * figures are filled in, the others are 0.
+ */
+typedef struct
+{
+    uint32 free_bytes;           /**< Bytes currently free */
+    uint32 free_blocks;          /**< Number of separate free blocks */
+    uint32 largest_free_block;   /**< Largest single free block, the largest allocation that can still succeed */
+    uint32 smallest_free_block;  /**< Smallest single free block */
+    uint32 min_free_bytes;       /**< Lowest free_bytes seen since the heap was initialized */
+    uint32 alloc_count;          /**< Successful pvPortMalloc calls */
+    uint32 free_count;           /**< vPortFree calls */
+    uint32 category_bytes[OS_HEAP_CATEGORY_COUNT]; /**< Allocated bytes by object type, including block headers */
+} OS_heap_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve detailed statistics of the FreeRTOS heap
+ *
+ * Extends OS_HeapGetInfo with the low water mark, the allocation counts and
+ * a breakdown of the used heap by object type.
+ *
+ * @param[out] heap_stats Filled with the heap statistics
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_SUCCESS on success
+ * @retval #OS_INVALID_POINTER if heap_stats is NULL
+ */
+int32 OS_HeapGetStats(OS_heap_stats_t *heap_stats);
+
+/****************************************************************************************
+ MEMORY POOL EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Fixed size block pools
+ *
+ * A pool hands out blocks of one size from storage taken from the FreeRTOS
+ * heap when the pool is created.  Allocating and freeing a block take constant
+ * time and no lock, so they may also be called from simulated interrupts.
+ * Blocks are aligned for any type.
+ */
+
+/* Statistics of a memory pool, see OS_MemPoolGetStats() */
+typedef struct
+{
+    uint32 block_size;         /**< Block size given to OS_MemPoolCreate */
+    uint32 block_count;        /**< Blocks in the pool */
+    uint32 free_blocks;        /**< Blocks currently free */
+    uint32 min_free_blocks;    /**< Fewest free blocks seen since the pool was created */
+    uint32 alloc_count;        /**< Successful allocations */
+    uint32 fail_count;         /**< Allocations that found the pool empty */
+} OS_mempool_stats_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Create a pool of fixed size blocks
+ *
+ * @param[out] pool_id     Set to the id of the new pool, used with the other OS_MemPool calls
+ * @param[in]  block_size  Size of each block in bytes
+ * @param[in]  block_count Number of blocks in the pool
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_INVALID_POINTER if pool_id is NULL
+ * @retval #OS_ERROR if a size is 0 or the storage cannot be allocated
+ * @retval #OS_ERR_NO_FREE_IDS if OS_FREERTOS_MAX_MEMPOOLS pools already exist
+ */
+int32 OS_MemPoolCreate(uint32 *pool_id, uint32 block_size, uint32 block_count);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Delete a memory pool and release its storage
+ *
+ * No other call may use the pool while it is deleted.
+ *
+ * @param[in] pool_id The pool id
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the pool does not exist
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if blocks of the pool are still allocated
+ */
+int32 OS_MemPoolDelete(uint32 pool_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Allocate a block from a memory pool
+ *
+ * Never blocks.
+ *
+ * @param[in]  pool_id The pool id
+ * @param[out] block   Set to the block, or NULL if none was allocated
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the pool does not exist
+ * @retval #OS_QUEUE_EMPTY if every block of the pool is allocated
+ */
+int32 OS_MemPoolAlloc(uint32 pool_id, void **block);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Return a block to its memory pool
+ *
+ * @param[in] pool_id The pool id
+ * @param[in] block   A block allocated from the pool
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the pool does not exist
+ * @retval #OS_ERR_BAD_ADDRESS if block is not the start of a block of the pool
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the block is already free
+ */
+int32 OS_MemPoolFree(uint32 pool_id, void *block);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the statistics of a memory pool
+ *
+ * @param[in]  pool_id    The pool id
+ * @param[out] pool_stats Filled with the pool statistics
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the pool does not exist
+ */
+int32 OS_MemPoolGetStats(uint32 pool_id, OS_mempool_stats_t *pool_stats);
+
+/****************************************************************************************
+ EVENT FLAGS EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Event flags
+ *
+ * An event flags object holds OS_EVENT_FLAGS_BITS independent flags, kept in
+ * a FreeRTOS event group.  A task can wait for any or all of a set of flags
+ * with one call, in place of a binary semaphore per flag, and every task
+ * whose wait a set satisfies is released by it.
+ */
+
+#define OS_EVENT_FLAGS_BITS         24          /**< Flags in an object, the event group bits left by the kernel */
+#define OS_EVENT_FLAGS_ALL          0x00FFFFFF  /**< Mask of every flag */
+
+/* Options of OS_EventFlagsWait() */
+#define OS_EVENT_FLAGS_WAIT_ANY     0x00        /**< Return when any of the flags is set */
+#define OS_EVENT_FLAGS_WAIT_ALL     0x01        /**< Return only when all of the flags are set */
+#define OS_EVENT_FLAGS_CLEAR        0x02        /**< Clear the waited flags when the wait is met */
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Create an event flags object with every flag clear
+ *
+ * @param[out] flags_id   Set to the id of the new object
+ * @param[in]  flags_name A name unique among the event flags objects
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_INVALID_POINTER if an argument is NULL
+ * @retval #OS_ERR_NAME_TOO_LONG if the name does not fit in OS_MAX_API_NAME
+ * @retval #OS_ERR_NAME_TAKEN if the name is already used
+ * @retval #OS_ERR_NO_FREE_IDS if OS_FREERTOS_MAX_EVENT_FLAGS objects already exist
+ */
+int32 OS_EventFlagsCreate(uint32 *flags_id, const char *flags_name);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Delete an event flags object
+ *
+ * Tasks still waiting on the object return #OS_ERROR_TIMEOUT.
+ *
+ * @param[in] flags_id The event flags id
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the object does not exist
+ */
+int32 OS_EventFlagsDelete(uint32 flags_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Find an event flags object by name
+ *
+ * @param[out] flags_id   Set to the id of the object
+ * @param[in]  flags_name The name given to OS_EventFlagsCreate
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NAME_NOT_FOUND if no object has the name
+ */
+int32 OS_EventFlagsGetIdByName(uint32 *flags_id, const char *flags_name);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Set flags, releasing the tasks whose wait is now met
+ *
+ * @param[in] flags_id The event flags id
+ * @param[in] flags    The flags to set, within #OS_EVENT_FLAGS_ALL
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the object does not exist
+ * @retval #OS_ERROR if flags is 0 or outside #OS_EVENT_FLAGS_ALL
+ */
+int32 OS_EventFlagsSet(uint32 flags_id, uint32 flags);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Set flags from an interrupt handler
+ *
+ * The flags are set by the timer service task once the handler returns, so
+ * a task reading them in the meantime may still see them clear.
+ *
+ * @param[in] flags_id The event flags id
+ * @param[in] flags    The flags to set, within #OS_EVENT_FLAGS_ALL
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERROR if flags is invalid or the timer command queue is full
+ */
+int32 OS_EventFlagsSetFromISR(uint32 flags_id, uint32 flags);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Clear flags
+ *
+ * @param[in] flags_id The event flags id
+ * @param[in] flags    The flags to clear, within #OS_EVENT_FLAGS_ALL
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the object does not exist
+ */
+int32 OS_EventFlagsClear(uint32 flags_id, uint32 flags);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Read the flags without waiting
+ *
+ * @param[in]  flags_id The event flags id
+ * @param[out] flags    Set to the flags currently set
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the object does not exist
+ */
+int32 OS_EventFlagsGet(uint32 flags_id, uint32 *flags);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Wait for any or all of a set of flags
+ *
+ * @param[in]  flags_id  The event flags id
+ * @param[in]  flags     The flags to wait for, within #OS_EVENT_FLAGS_ALL
+ * @param[in]  options   #OS_EVENT_FLAGS_WAIT_ANY or #OS_EVENT_FLAGS_WAIT_ALL,
+ *                       optionally with #OS_EVENT_FLAGS_CLEAR
+ * @param[in]  msecs     OS_PEND, OS_CHECK or a timeout in milliseconds
+ * @param[out] flags_out If not NULL, set to all the flags as they were when
+ *                       the wait ended, before any were cleared
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the object does not exist
+ * @retval #OS_ERROR if flags, options or msecs are invalid
+ * @retval #OS_ERROR_TIMEOUT if the wait was not met in time
+ */
+int32 OS_EventFlagsWait(uint32 flags_id, uint32 flags, uint32 options, int32 msecs, uint32 *flags_out);
+
+/****************************************************************************************
+ PIPE EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Byte stream pipes
+ *
+ * A pipe carries a stream of bytes from its writers to its readers through a
+ * FreeRTOS stream buffer, with no per-message slots.  The id OS_PipeCreate
+ * returns is an OSAL stream id: bytes are written with OS_write or
+ * OS_TimedWrite, read with OS_read or OS_TimedRead, the pipe is deleted with
+ * OS_close, and it can be waited for with OS_SelectSingle and
+ * OS_SelectMultiple, also without OS_INCLUDE_NETWORK.  Pipes cannot be added
+ * to an event set.
+ *
+ * A read returns as soon as any bytes are buffered, up to the count asked
+ * for.  A reader kept waiting is only woken once the trigger level is
+ * buffered, and select reports a pipe readable from that level on.  A write
+ * returns once all its bytes are in the pipe, or with the count written when
+ * the timeout expires first.  Each side is serialized, so several tasks may
+ * read, or write, the same pipe.
+ */
+
+/* Properties of a pipe, see OS_PipeGetInfo() */
+typedef struct
+{
+    uint32 size;               /**< Buffer size given to OS_PipeCreate */
+    uint32 trigger_level;      /**< Bytes buffered before a waiting reader is woken */
+    uint32 bytes_available;    /**< Bytes currently buffered */
+} OS_pipe_prop_t;
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Create a pipe
+ *
+ * @param[out] pipe_id       Set to the stream id of the new pipe
+ * @param[in]  pipe_name     A name unique among the open streams
+ * @param[in]  size          Bytes the pipe can buffer
+ * @param[in]  trigger_level Bytes buffered before a waiting reader is woken,
+ *                           0 for 1
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_INVALID_POINTER if an argument is NULL
+ * @retval #OS_ERR_NAME_TOO_LONG if the name does not fit in OS_MAX_PATH_LEN
+ * @retval #OS_ERROR if size is 0 or less than trigger_level, or the buffer
+ *                   cannot be allocated
+ * @retval #OS_ERR_NO_FREE_IDS if OS_FREERTOS_MAX_PIPES pipes already exist
+ */
+int32 OS_PipeCreate(uint32 *pipe_id, const char *pipe_name, uint32 size, uint32 trigger_level);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Retrieve the properties of a pipe
+ *
+ * @param[in]  pipe_id   The pipe (stream) id
+ * @param[out] pipe_prop Filled with the pipe properties
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the stream does not exist
+ * @retval #OS_ERR_INCORRECT_OBJ_TYPE if the stream is not a pipe
+ */
+int32 OS_PipeGetInfo(uint32 pipe_id, OS_pipe_prop_t *pipe_prop);
+
+/****************************************************************************************
+ WAIT SET EXTENSIONS
+ ***************************************************************************************/
+
+/*
+ * Wait sets
+ *
+ * A wait set lets one task block on several message queues and semaphores at
+ * once, built on a FreeRTOS queue set.  OS_WaitSetWait returns the id of a
+ * member that is ready; the caller then reads it with OS_QueueGet,
+ * OS_BinSemTake or OS_CountSemTake, with OS_CHECK if another task may read it
+ * too.  Each report of a queue stands for one message, so a member must only
+ * be read after the set reported it, once per report, or later waits report
+ * queues that are already empty.  A semaphore is reported for as long as it
+ * can be taken, so it may be taken any time.
+ *
+ * Queues are added to the queue set directly and use as many of its
+ * max_events as they have slots.  The port's binary and notification
+ * semaphores have no kernel object to add, and a kernel counting semaphore
+ * counts too high for a queue set, so each semaphore member gets a binary
+ * kernel semaphore that every give signals, and uses one event.  An object
+ * can be in one wait set at a time, and deleting it removes it from its set.
+ */
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Create a wait set
+ *
+ * @param[out] set_id     Set to the id of the new wait set
+ * @param[in]  max_events Events the set can hold, at least the sum of the
+ *                        queue depths plus one per semaphore that will be added
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_INVALID_POINTER if set_id is NULL
+ * @retval #OS_ERROR if max_events is 0 or the set cannot be allocated
+ * @retval #OS_ERR_NO_FREE_IDS if OS_FREERTOS_MAX_WAIT_SETS sets already exist
+ */
+int32 OS_WaitSetCreate(uint32 *set_id, uint32 max_events);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Delete a wait set
+ *
+ * @param[in] set_id The wait set id
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the set does not exist
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the set still has members
+ */
+int32 OS_WaitSetDelete(uint32 set_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Add a message queue or semaphore to a wait set
+ *
+ * A queue must be empty when it is added.  A semaphore that can already be
+ * taken is reported by the next wait.
+ *
+ * @param[in] set_id    The wait set id
+ * @param[in] object_id A queue, binary semaphore or counting semaphore id
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the set or the object does not exist
+ * @retval #OS_ERR_INCORRECT_OBJ_TYPE if the object is of another type
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the object is already in a wait set,
+ *                                     or the queue is not empty
+ * @retval #OS_QUEUE_FULL if the set has OS_FREERTOS_WAIT_SET_MAX_MEMBERS
+ *                        members, or not enough of max_events left
+ */
+int32 OS_WaitSetAdd(uint32 set_id, uint32 object_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Remove a message queue or semaphore from a wait set
+ *
+ * @param[in] set_id    The wait set id
+ * @param[in] object_id The member to remove
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_INVALID_ID if the set does not exist
+ * @retval #OS_ERR_NAME_NOT_FOUND if the object is not in the set
+ * @retval #OS_ERR_INCORRECT_OBJ_STATE if the queue still holds messages
+ * @retval #OS_ERROR if the kernel would not take the semaphore out of the set
+ */
+int32 OS_WaitSetRemove(uint32 set_id, uint32 object_id);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Wait until a member of a wait set is ready
+ *
+ * @param[in]  set_id    The wait set id
+ * @param[out] object_id Set to the id of the ready member
+ * @param[in]  msecs     Milliseconds to wait, or OS_PEND or OS_CHECK
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_INVALID_POINTER if object_id is NULL
+ * @retval #OS_ERR_INVALID_ID if the set does not exist
+ * @retval #OS_ERROR_TIMEOUT if no member was ready in time
+ */
+int32 OS_WaitSetWait(uint32 set_id, uint32 *object_id, int32 msecs);
+
+/****************************************************************************************
+ STARTUP EXTENSIONS
+ ***************************************************************************************/
+
+/* Returned by OS_StartupPhaseBegin when there is no trace, ignored by OS_StartupPhaseEnd */
+#define OS_STARTUP_PHASE_NONE           0xFFFFFFFF
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Start timing a startup phase
+ *
+ * The port already times every OS_API_Impl_Init call, the simulation sync
+ * pipe, each file system volume start and RAM disk creation; the BSP and the
+ * application can add their own phases, for example the network coming up,
+ * which is ended from vApplicationIPNetworkEventHook.  Phases may nest and
+ * may run in different tasks.  They are timed with the host performance
+ * counter, so this can be called before OS_API_Init and before the scheduler
+ * starts.  The last OS_FREERTOS_STARTUP_TRACE_SLOTS phases are kept.
+ *
+ * The trace is only kept when the port is built with OS_FREERTOS_STARTUP_TRACE
+ * defined in osconfig.h.  Otherwise this returns OS_STARTUP_PHASE_NONE and
+ * the other startup calls do nothing.
+ *
+ * @param[in] name Phase name, shortened to OS_MAX_API_NAME - 1 characters
+ *
+ * @return The phase to give to OS_StartupPhaseEnd
+ */
+uint32 OS_StartupPhaseBegin(const char *name);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Stop timing a startup phase
+ *
+ * @param[in] phase The value returned by OS_StartupPhaseBegin
+ */
+void OS_StartupPhaseEnd(uint32 phase);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Print the startup phases
+ *
+ * Lists every phase with its start, relative to the first phase, and its
+ * duration, phases indented under the ones they ran in.
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port is built without OS_FREERTOS_STARTUP_TRACE
+ */
+int32 OS_StartupReport(void);
+
+/****************************************************************************************
+ TRACE EXTENSIONS
+ ***************************************************************************************/
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Clear the event trace and start recording
+ *
+ * Only available when the port is built with configFREERTOS_SIM_EVENT_TRACE
+ * set in FreeRTOSConfig.h.  Recording is then already on from the first task
+ * creation; this drops what was recorded so far, for example to trace one
+ * test case only.  The trace keeps the last OS_FREERTOS_TRACE_EVENTS events.
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port was built without configFREERTOS_SIM_EVENT_TRACE
+ */
+int32 OS_TraceStart(void);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Stop recording, keeping the events recorded so far for OS_TraceDump
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port was built without configFREERTOS_SIM_EVENT_TRACE
+ */
+int32 OS_TraceStop(void);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Record a named instant in the event trace
+ *
+ * Shows up on the track of the calling task.  Only the pointer is recorded,
+ * so the name has to stay valid until the trace is dumped, normally it is a
+ * string literal.  Does nothing when the port was built without
+ * configFREERTOS_SIM_EVENT_TRACE.
+ *
+ * @param[in] name Name of the mark
+ */
+void OS_TraceMark(const char *name);
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Write the event trace to a host file
+ *
+ * The file is in the JSON trace event format that chrome://tracing and
+ * https://ui.perfetto.dev load.  One track shows which task ran on the
+ * simulated CPU, one the simulated interrupts, and every task has a track
+ * with its OSAL calls as slices and its kernel object operations as instants.
+ * Recording is paused while the file is written.
+ *
+ * @param[in] host_path Path of the file on the host, it is overwritten
+ *
+ * @return Execution status, see @ref OSReturnCodes
+ * @retval #OS_INVALID_POINTER if host_path is NULL
+ * @retval #OS_ERROR if the file could not be written
+ * @retval #OS_ERR_NOT_IMPLEMENTED if the port was built without configFREERTOS_SIM_EVENT_TRACE
+ */
+int32 OS_TraceDump(const char *host_path);
+
+/****************************************************************************************
+ TIME EXTENSIONS
+ ***************************************************************************************/
+
+/*-------------------------------------------------------------------------------------*/
+/**
+ * @brief Read a monotonic clock for profiling
+ *
+ * Counts from the start of the scheduler and is not affected by
+ * OS_SetLocalTime.  On the Windows simulator it has the resolution of the host
+ * performance counter; when the application runs in lockstep with a simulation
+ * driver (configFREERTOS_RUN_AS_SIM) it follows the simulated tick instead.
+ * Safe to call from any task, cheap enough for hot paths.
+ *
+ * @return Nanoseconds since the scheduler started
+ */
+uint64 OS_GetMonotonicNsec(void);
+
+#endif /* _osapi_os_freertos_ */
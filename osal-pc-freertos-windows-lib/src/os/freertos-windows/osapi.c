@@ -31,7 +31,10 @@
  ****************************************************************************************/
 
 #include "os-FreeRTOS.h"
+#include "timers.h"
 #include <fcntl.h>
+#include <stdarg.h>
+#include <setjmp.h>
 #ifndef configFREERTOS_RUN_AS_SIM
 #error configFREERTOS_RUN_AS_SIM must be set to 0 or 1 in FreeRTOSConfig.h
 #endif
@@ -61,6 +64,35 @@
 #define OS_CONSOLE_TASK_PRIORITY        OS_UTILITYTASK_PRIORITY
 #define OS_CONSOLE_TASK_STACKSIZE       OS_UTILITYTASK_STACK_SIZE
 
+/*
+ * Stack painting, see OS_FREERTOS_STACK_MONITOR.  The paint starts a little
+ * below the frame of the task entry wrapper and stops short of the bottom of
+ * the thread's reserved stack, where Windows keeps its guard pages.
+ */
+#define OS_FREERTOS_STACK_PAINT_WORD        0xA5A5A5A5
+#define OS_FREERTOS_STACK_PAINT_MARGIN      256
+#define OS_FREERTOS_STACK_PAINT_RESERVE     0x10000
+
+#if (OS_FREERTOS_CONSOLE_FAST_SLOTS & (OS_FREERTOS_CONSOLE_FAST_SLOTS - 1)) != 0
+#error OS_FREERTOS_CONSOLE_FAST_SLOTS must be a power of two
+#endif
+#if (OS_FREERTOS_CONSOLE_LOG_SLOTS & (OS_FREERTOS_CONSOLE_LOG_SLOTS - 1)) != 0
+#error OS_FREERTOS_CONSOLE_LOG_SLOTS must be a power of two
+#endif
+#if (OS_FREERTOS_CONSOLE_SINK_BUFFER & (OS_FREERTOS_CONSOLE_SINK_BUFFER - 1)) != 0
+#error OS_FREERTOS_CONSOLE_SINK_BUFFER must be a power of two
+#endif
+
+/*
+ * vPortGetHeapStats() came with FreeRTOS V10.2.0.  Older kernels only give
+ * the free and the lowest free heap size.
+ */
+#if tskKERNEL_VERSION_MAJOR > 10 || (tskKERNEL_VERSION_MAJOR == 10 && tskKERNEL_VERSION_MINOR >= 2)
+#define OS_FREERTOS_HEAP_STATS      1
+#else
+#define OS_FREERTOS_HEAP_STATS      0
+#endif
+
 /****************************************************************************************
  GLOBAL DATA
  ****************************************************************************************/
@@ -71,36 +103,378 @@
 typedef struct
 {
 	TaskHandle_t id;
+	UBaseType_t  freertos_priority;	/* OSAL priority mapped through OS_FreeRTOS_PriorityMap */
+	uint32       flags;				/* creation flags, see OS_TASK_CORE */
+	uint64       run_time;			/* accumulated run time counter units */
+	uint32       run_time_seen;		/* last raw FreeRTOS run time counter of the task */
+	uint64       window_run_time;	/* run_time at the start of the current CPU window */
+	uint32       window_start;		/* run time counter at the start of the current CPU window */
+	uint32       cpu_usage;			/* hundredths of a percent over the last completed window */
+	uint32       window_len;		/* length of the last completed window, 0 if none yet */
+	TickType_t   period;			/* release period in ticks, 0 if not periodic, see OS_TaskPeriodSet */
+	TickType_t   last_release;		/* tick of the last release, only changed by the task itself */
+	uint32       release_count;
+	uint32       overrun_count;		/* releases that had passed before the task was ready for them */
+	TickType_t   max_lateness;		/* most ticks a release was passed when the task came to wait */
+#ifdef OS_FREERTOS_STACK_MONITOR
+	volatile uint32 *stack_paint;	/* lowest painted word of the thread stack, NULL if none */
+	uint32       stack_paint_words;	/* words painted, the OSAL stack size */
+	uint32       stack_used_peak;	/* bytes of the paint overwritten at the last scan */
+	uint8        stack_reported;	/* warnings printed by OS_FreeRTOS_StackMonitor_Entry */
+#endif
+#ifdef OS_FREERTOS_STATIC_TASKS
+	int32        static_slot;	/* index into OS_impl_task_pool, or -1 if heap allocated */
+#endif
+#ifdef OS_FREERTOS_TASK_RECYCLE
+	int32        recycle_slot;	/* index into OS_impl_task_recycle, or -1 if the task cannot park */
+#endif
 } OS_impl_task_internal_record_t;
 
+#ifdef OS_FREERTOS_STATIC_TASKS
+/* Task control block and stack reserved for one task */
+typedef struct
+{
+	StaticTask_t   tcb;
+	StackType_t    stack[OS_TASK_STATIC_STACK_SIZE];
+	volatile bool  in_use;
+} OS_impl_task_pool_entry_t;
+#endif
+
+#ifdef OS_FREERTOS_TASK_RECYCLE
+/* FreeRTOS task that can run another OSAL task once its current one exits, see OS_FreeRTOS_TaskPark */
+typedef struct
+{
+	TaskHandle_t    task;
+	uint32          stack_size;		/* OSAL stack size the task was created with */
+#ifdef OS_FREERTOS_STATIC_TASKS
+	int32           static_slot;	/* task pool slot held while parked */
+#endif
+	volatile uint32 next_id;		/* OSAL task id handed over by OS_TaskCreate_Impl */
+	jmp_buf         restart;		/* OS_FreeRTOSEntry frame a parked task goes back to */
+	bool            in_use;
+	volatile bool   parked;
+} OS_impl_task_recycle_t;
+#endif
+
+/* Message descriptor carried by the FreeRTOS queue of a zero-copy queue */
+typedef struct
+{
+	void   *buffer;
+	uint32 size;
+} OS_impl_queue_msg_t;
+
 /* queues */
 typedef struct
 {
 	QueueHandle_t id;
+	uint32        flags;
+	QueueHandle_t free_list;		/* buffers of a zero-copy queue available to producers */
+	uint8         *pool_base;
+	uint32        pool_stride;
+	uint32        pool_count;
+	uint8         *in_use;			/* one flag per pool buffer, set while it is off the free list */
+	uint32        full_count;		/* puts rejected because the queue was full */
+	uint32        put_count;
+	uint32        get_count;
+	uint32        timeout_count;	/* gets that timed out */
+	uint32        peak_depth;		/* high-water mark of queued messages */
+	uint32        wait_set;			/* OS_WaitSetAdd set the queue is in, 0 if none */
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	StaticQueue_t       queue_cb;
+	StaticQueue_t       free_list_cb;
+	OS_impl_queue_msg_t msg_storage[OS_QUEUE_MAX_DEPTH];
+	void                *free_list_storage[OS_QUEUE_MAX_DEPTH + OS_QUEUE_SPARE_BUFFERS];
+	uint8               in_use_storage[OS_QUEUE_MAX_DEPTH + OS_QUEUE_SPARE_BUFFERS];
+#endif
 } OS_impl_queue_internal_record_t;
 
-/* Binary Semaphores, Counting Semaphores, and Mutexes */
+/*
+ * Semaphores kept as a value and a list of waiting tasks, see
+ * OS_FreeRTOS_NotifySemWait.  A waiter sleeps on its own kernel binary
+ * semaphore, or on notification OS_FREERTOS_NOTIFY_SEM_INDEX when the port is
+ * built with OS_FREERTOS_SEM_NOTIFY.
+ */
+typedef struct OS_impl_sem_waiter
+{
+	TaskHandle_t              task;
+	UBaseType_t               priority;
+	volatile bool             released;
+	volatile bool             deleted;	/* released by a delete of the semaphore, not a give */
+#ifndef OS_FREERTOS_SEM_NOTIFY
+	SemaphoreHandle_t         wake;
+	StaticSemaphore_t         wake_cb;
+#endif
+	struct OS_impl_sem_waiter *next;
+} OS_impl_sem_waiter_t;
+
 typedef struct
 {
-	SemaphoreHandle_t id;
+	volatile uint32      value;
+	uint32               max_value;
+	OS_impl_sem_waiter_t *waiters;	/* tasks pending on the semaphore, highest priority first */
+} OS_impl_notify_sem_t;
+
+/* Semaphore contention statistics, in run time counter units (see Run-time-stats-utils.c) */
+typedef struct
+{
+	uint32 take_count;
+	uint32 blocked_count;		/* takes that had to wait */
+	uint64 total_wait;
+	uint32 max_wait;
+} OS_impl_sem_stats_t;
+
+/*
+ * A semaphore in a wait set is stood in for by a kernel binary semaphore in
+ * the FreeRTOS queue set, given along with the semaphore.  The proxy is
+ * created when the semaphore is first added to a wait set and kept until the
+ * semaphore is deleted, so a give never races with its removal.
+ */
+typedef struct
+{
+	uint32            wait_set;			/* OS_WaitSetAdd set, 0 if none */
+	SemaphoreHandle_t proxy;
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	StaticSemaphore_t proxy_cb;
+#endif
+} OS_impl_sem_wait_link_t;
+
+/* Binary Semaphores */
+typedef struct
+{
+	OS_impl_notify_sem_t    sem;
+	OS_impl_sem_stats_t     stats;
+	OS_impl_sem_wait_link_t wait;
+} OS_impl_binsem_internal_record_t;
+
+/* Counting Semaphores */
+typedef struct
+{
+	SemaphoreHandle_t       id;			/* NULL when the notification backend is used */
+	OS_impl_notify_sem_t    notify;
+	OS_impl_sem_stats_t     stats;
+	OS_impl_sem_wait_link_t wait;
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	StaticSemaphore_t       sem_cb;
+#endif
+} OS_impl_countsem_internal_record_t;
+
+/* Mutexes */
+typedef struct
+{
+	SemaphoreHandle_t   id;
+	uint32              depth;			/* recursion depth, only changed by the holder */
+	OS_impl_sem_stats_t stats;
+	unsigned long       hold_start;		/* run time counter when the outermost take succeeded */
+	uint32              hold_count;
+	uint64              total_hold;
+	uint32              max_hold;
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	StaticSemaphore_t   sem_cb;
+#endif
 } OS_impl_internal_record_t;
 
+/* One slot of the console fast ring, see OS_ConsoleWriteFast */
+#define OS_CONSOLE_SLOT_TEXT_SIZE       (OS_FREERTOS_CONSOLE_SLOT_SIZE - 2 * sizeof(LONG))
+
+/* Longest line a binary log record is formatted into */
+#define OS_CONSOLE_LOG_LINE_SIZE        160
+
+typedef struct
+{
+    volatile LONG		seq;		/* slot is free when seq == position, filled when seq == position + 1 */
+    LONG				len;
+    char				text[OS_CONSOLE_SLOT_TEXT_SIZE];
+} OS_impl_console_slot_t;
+
+/* One slot of the console binary log ring, see OS_ConsoleLog */
+typedef struct
+{
+    volatile LONG			seq;
+    LONG					reserved;
+    OS_console_log_record_t	record;
+} OS_impl_console_log_slot_t;
+
 /* Console device */
 typedef struct
 {
     bool				is_async;
-    SemaphoreHandle_t	data_sem;
+    TaskHandle_t		task;
+    volatile LONG		wake_pending;	/* set from the first wakeup until the console task starts draining */
+    uint32				wake_count;
     int					out_fd;
+    volatile bool		fast_ready;
+    volatile bool		stdout_enabled;
+    volatile LONG		fast_head;		/* next position to reserve, shared by all producers */
+    LONG				fast_tail;		/* next position to drain, console task only */
+    volatile LONG		fast_count;
+    volatile LONG		overflow_count;
+    volatile LONG		truncated_count;
+    uint32				write_count;
+    uint64				byte_count;
+    uint32				stage_len;
+    char				stage[OS_FREERTOS_CONSOLE_WRITE_SIZE];
+    OS_impl_console_slot_t fast_ring[OS_FREERTOS_CONSOLE_FAST_SLOTS];
+    volatile LONG		log_head;
+    LONG				log_tail;
+    volatile LONG		log_count;
+    volatile LONG		log_overflow_count;
+    OS_impl_console_log_slot_t log_ring[OS_FREERTOS_CONSOLE_LOG_SLOTS];
 } OS_impl_console_internal_record_t;
 
+/* Formats registered with OS_ConsoleLogRegisterFormat, indexed by format id */
+static const char *OS_impl_console_log_formats[OS_FREERTOS_CONSOLE_LOG_FORMATS];
+
+/* Largest datagram a UDP console sink sends */
+#define OS_CONSOLE_SINK_UDP_CHUNK       1024
+
+/*
+ * Additional console output sink, see OS_ConsoleSinkAdd.  The console task
+ * copies every batch it writes into the byte ring of each open sink; the
+ * sink's own task drains it to the device, so a slow device only ever drops
+ * its own output.
+ */
+typedef struct
+{
+    uint32				type;			/* 0 when the entry is free */
+    bool				closing;
+    SemaphoreHandle_t	wake;
+    volatile LONG		head;			/* written by the console task */
+    volatile LONG		tail;			/* written by the sink task */
+    volatile LONG		dropped;
+    FILE				*fp;
+#ifdef OS_INCLUDE_NETWORK
+    Socket_t			sock;
+    struct freertos_sockaddr addr;
+#endif
+    HANDLE				map;
+    OS_console_shm_header_t *view;
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+    StaticSemaphore_t	wake_cb;
+#endif
+    char				buffer[OS_FREERTOS_CONSOLE_SINK_BUFFER];
+} OS_impl_console_sink_t;
+
+static OS_impl_console_sink_t		OS_impl_console_sinks[OS_FREERTOS_CONSOLE_MAX_SINKS];
+static SemaphoreHandle_t			OS_impl_console_sink_mutex;
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+static StaticSemaphore_t			OS_impl_console_sink_mutex_cb;
+#endif
+
 /* Tables where the OS object information is stored */
 OS_impl_task_internal_record_t		OS_impl_task_table[OS_MAX_TASKS];
 OS_impl_queue_internal_record_t		OS_impl_queue_table[OS_MAX_QUEUES];
-OS_impl_internal_record_t			OS_impl_bin_sem_table[OS_MAX_BIN_SEMAPHORES];
-OS_impl_internal_record_t			OS_impl_count_sem_table[OS_MAX_COUNT_SEMAPHORES];
+OS_impl_binsem_internal_record_t	OS_impl_bin_sem_table[OS_MAX_BIN_SEMAPHORES];
+OS_impl_countsem_internal_record_t	OS_impl_count_sem_table[OS_MAX_COUNT_SEMAPHORES];
 OS_impl_internal_record_t			OS_impl_mut_sem_table[OS_MAX_MUTEXES];
 OS_impl_console_internal_record_t	OS_impl_console_table[OS_MAX_CONSOLES];
 
+/*
+ * Wait sets, see OS_WaitSetCreate.  "lock" protects the member list and is
+ * not held while waiting.  Queues are members of the FreeRTOS queue set
+ * themselves, semaphores through their proxy (OS_impl_sem_wait_link_t).
+ */
+typedef struct
+{
+	uint32                 object_id;		/* OSAL id */
+	uint32                 idtype;
+	uint32                 local_id;
+	QueueSetMemberHandle_t handle;			/* queue or proxy in the queue set */
+	uint32                 events;			/* room reserved in the queue set */
+} OS_impl_wait_member_t;
+
+typedef struct
+{
+	bool                  in_use;
+	QueueSetHandle_t      set;
+	SemaphoreHandle_t     lock;
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	StaticSemaphore_t     lock_cb;
+#endif
+	uint32                max_events;
+	uint32                reserved;
+	uint32                count;
+	uint32                next;				/* semaphore member to check first, for fairness */
+	OS_impl_wait_member_t members[OS_FREERTOS_WAIT_SET_MAX_MEMBERS];
+} OS_impl_wait_set_t;
+
+static OS_impl_wait_set_t			OS_impl_wait_set_table[OS_FREERTOS_MAX_WAIT_SETS];
+
+#ifdef OS_FREERTOS_STATIC_TASKS
+static OS_impl_task_pool_entry_t	OS_impl_task_pool[OS_MAX_TASKS];
+#endif
+
+#ifdef OS_FREERTOS_TASK_RECYCLE
+/* Every live OSAL task can hold an entry on top of the parked ones */
+static OS_impl_task_recycle_t		OS_impl_task_recycle[OS_MAX_TASKS + OS_FREERTOS_TASK_RECYCLE_PARKED];
+#endif
+
+#ifdef OS_FREERTOS_STACK_MONITOR
+static TaskHandle_t					OS_impl_stack_monitor = NULL;
+#endif
+
+/* Working storage of OS_TaskProfileSnapshot, protected by the task table lock */
+typedef struct
+{
+	UBaseType_t task_number;
+	uint32      run_time;
+} OS_impl_task_profile_prev_t;
+
+static TaskStatus_t					OS_impl_profile_status[OS_FREERTOS_PROFILE_MAX_TASKS];
+static OS_impl_task_profile_prev_t	OS_impl_profile_prev[OS_FREERTOS_PROFILE_MAX_TASKS];
+static uint32						OS_impl_profile_prev_count;
+static uint32						OS_impl_profile_prev_time;
+
+/*
+ * CPU load meter, fed by the kernel idle hook and OS_CpuLoadGet.  Times are in
+ * run time counter units; history holds the load of the last completed windows
+ * for the rolling peak.  Protected by a critical section, as the idle task
+ * cannot take the table locks.
+ */
+typedef struct
+{
+	volatile uint32 window_start;
+	uint32          idle_start;
+	uint32          load;
+	uint32          window_len;
+	uint32          window_count;
+	uint32          history[OS_FREERTOS_CPU_LOAD_PEAK_WINDOWS];
+} OS_impl_cpu_load_t;
+
+static OS_impl_cpu_load_t			OS_impl_cpu_load;
+
+/*
+ * OSAL priority (0 highest .. 255 lowest) to FreeRTOS priority (higher is more
+ * important).  Unless the BSP provides its own table, the OSAL range is spread
+ * linearly over the FreeRTOS levels between OS_FREERTOS_LOWEST_TASK_PRIORITY and
+ * the levels reserved at the top by OS_FREERTOS_RESERVED_PRIORITIES.
+ */
+#ifdef OS_FREERTOS_BSP_PRIORITY_MAP
+extern const uint8 OS_BSP_PriorityMap[256];
+#define OS_FreeRTOS_PriorityMap     OS_BSP_PriorityMap
+#else
+#define OS_FREERTOS_TASK_PRIORITY_LEVELS	(configMAX_PRIORITIES - OS_FREERTOS_RESERVED_PRIORITIES - OS_FREERTOS_LOWEST_TASK_PRIORITY)
+#define OS_PRIO_1(p)	(OS_FREERTOS_LOWEST_TASK_PRIORITY + ((255 - (p)) * OS_FREERTOS_TASK_PRIORITY_LEVELS) / 256)
+#define OS_PRIO_4(p)	OS_PRIO_1(p), OS_PRIO_1((p) + 1), OS_PRIO_1((p) + 2), OS_PRIO_1((p) + 3)
+#define OS_PRIO_16(p)	OS_PRIO_4(p), OS_PRIO_4((p) + 4), OS_PRIO_4((p) + 8), OS_PRIO_4((p) + 12)
+#define OS_PRIO_64(p)	OS_PRIO_16(p), OS_PRIO_16((p) + 16), OS_PRIO_16((p) + 32), OS_PRIO_16((p) + 48)
+
+static const uint8 OS_FreeRTOS_PriorityMap[256] =
+      {
+            OS_PRIO_64(0), OS_PRIO_64(64), OS_PRIO_64(128), OS_PRIO_64(192)
+      };
+#endif
+
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+/*
+ * Message buffer pools, sized for the largest queue the configuration allows.
+ * Declared as uint64 to get the same alignment as a heap allocation.
+ */
+#define OS_QUEUE_STATIC_POOL_WORDS	((((OS_QUEUE_STATIC_MAX_SIZE + portBYTE_ALIGNMENT_MASK) & ~portBYTE_ALIGNMENT_MASK) * \
+                                      (OS_QUEUE_MAX_DEPTH + OS_QUEUE_SPARE_BUFFERS) + sizeof(uint64) - 1) / sizeof(uint64))
+
+static uint64						OS_impl_queue_pool_storage[OS_MAX_QUEUES][OS_QUEUE_STATIC_POOL_WORDS];
+#endif
+
 SemaphoreHandle_t	OS_task_table_sem;
 SemaphoreHandle_t	OS_queue_table_sem;
 SemaphoreHandle_t	OS_count_sem_table_sem;
@@ -134,6 +508,30 @@ enum
    MUTEX_TABLE_SIZE = (sizeof(MUTEX_TABLE) / sizeof(MUTEX_TABLE[0]))
 };
 
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+static StaticSemaphore_t OS_table_mutex_cb[MUTEX_TABLE_SIZE];
+#endif
+
+/*
+ * Shared holders of each table lock, see OS_Lock_Global_Shared_Impl.
+ * The table mutex itself is the exclusive lock.
+ */
+typedef struct
+{
+	volatile uint32 readers;
+	TaskHandle_t    writer;		/* exclusive holder waiting for the readers to leave */
+#ifdef OS_FREERTOS_LOCK_PROFILING
+	/* Exclusive acquires only, in run time counter units (see Run-time-stats-utils.c) */
+	uint32          acquire_count;
+	uint32          wait_count;	/* acquires that found the lock taken */
+	uint64          total_wait;
+	uint32          max_wait;
+	TaskHandle_t    holder;
+#endif
+} OS_impl_table_lock_t;
+
+static OS_impl_table_lock_t OS_table_lock[MUTEX_TABLE_SIZE];
+
 const OS_ErrorTable_Entry_t OS_IMPL_ERROR_NAME_TABLE[] = { { 0, NULL } };
 
 /* A named pipe used to control the progress of the FreeRTOS application */
@@ -142,10 +540,48 @@ const OS_ErrorTable_Entry_t OS_IMPL_ERROR_NAME_TABLE[] = { { 0, NULL } };
 #endif
 #if configFREERTOS_RUN_AS_SIM == 1
 HANDLE freertos_sync_pipe = INVALID_HANDLE_VALUE;
+#if configFREERTOS_SIM_COORDINATED == 1
+HANDLE xSimSyncRegister(void);
+#endif
 #endif
 
 FreeRTOS_GlobalVars_t FreeRTOS_GlobalVars = { 0 };
 
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_CountsToUsec
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Converts run time counter units (10 usec) to a 32 bit
+ *           microsecond figure, saturated rather than wrapped.
+ *
+ *-----------------------------------------------------------------*/
+static uint32 OS_FreeRTOS_CountsToUsec(uint64 counts)
+{
+	uint64 usec = counts * 10;
+
+	return (usec > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32) usec;
+} /* end OS_FreeRTOS_CountsToUsec */
+
+#ifdef OS_FREERTOS_LOCK_PROFILING
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_LockStatsWaited
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_LockStatsWaited(OS_impl_table_lock_t *lock, unsigned long wait)
+{
+	++lock->wait_count;
+	lock->total_wait += wait;
+	if(wait > lock->max_wait)
+	{
+		lock->max_wait = wait;
+	}
+} /* end OS_FreeRTOS_LockStatsWaited */
+#endif
+
 /*----------------------------------------------------------------
  *
  * Function: OS_Lock_Global_Impl
@@ -157,6 +593,10 @@ FreeRTOS_GlobalVars_t FreeRTOS_GlobalVars = { 0 };
 int32 OS_Lock_Global_Impl(uint32 idtype)
 {
 	SemaphoreHandle_t *mut;
+#ifdef OS_FREERTOS_LOCK_PROFILING
+	unsigned long start;
+	bool waited = false;
+#endif
 
 	if(idtype < MUTEX_TABLE_SIZE)
 	{
@@ -172,10 +612,56 @@ int32 OS_Lock_Global_Impl(uint32 idtype)
 		return OS_ERROR;
 	}
 
+#ifdef OS_FREERTOS_LOCK_PROFILING
+	start = ulGetRunTimeCounterValue();
+
+	/* Try without blocking first so only the acquires that wait are counted */
+	if(xSemaphoreTake(*mut, 0) != pdTRUE)
+	{
+		waited = true;
+		if(xSemaphoreTake(*mut, portMAX_DELAY) != pdTRUE)
+		{
+			return OS_ERROR;
+		}
+	}
+#else
 	if(xSemaphoreTake(*mut, portMAX_DELAY) != pdTRUE)
 	{
 			return OS_ERROR;
 	}
+#endif
+
+	/*
+	 * Holding the mutex keeps new shared holders out, now wait for the
+	 * ones already in to leave.
+	 */
+	while(1)
+	{
+		taskENTER_CRITICAL();
+		if(OS_table_lock[idtype].readers == 0)
+		{
+			OS_table_lock[idtype].writer = NULL;
+			taskEXIT_CRITICAL();
+			break;
+		}
+		OS_table_lock[idtype].writer = xTaskGetCurrentTaskHandle();
+		taskEXIT_CRITICAL();
+
+#ifdef OS_FREERTOS_LOCK_PROFILING
+		waited = true;
+#endif
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+
+#ifdef OS_FREERTOS_LOCK_PROFILING
+	/* The counters are only touched while holding the lock they describe */
+	++OS_table_lock[idtype].acquire_count;
+	if(waited)
+	{
+		OS_FreeRTOS_LockStatsWaited(&OS_table_lock[idtype], ulGetRunTimeCounterValue() - start);
+	}
+	OS_table_lock[idtype].holder = xTaskGetCurrentTaskHandle();
+#endif
 
 	return OS_SUCCESS;
 } /* end OS_Lock_Global_Impl */
@@ -206,6 +692,10 @@ int32 OS_Unlock_Global_Impl(uint32 idtype)
 		return OS_ERROR;
 	}
 
+#ifdef OS_FREERTOS_LOCK_PROFILING
+	OS_table_lock[idtype].holder = NULL;
+#endif
+
 	if(xSemaphoreGive(*mut) != pdTRUE)
 	{
 		return OS_ERROR;
@@ -214,1316 +704,6924 @@ int32 OS_Unlock_Global_Impl(uint32 idtype)
 	return OS_SUCCESS;
 } /* end OS_Unlock_Global_Impl */
 
-/****************************************************************************************
- INITIALIZATION FUNCTION
- ****************************************************************************************/
-
-/*---------------------------------------------------------------------------------------
- Name: OS_API_Impl_Init
-
- Purpose: Initialize the tables that the OS API uses to keep track of information
- about objects
-
- returns: OS_SUCCESS or OS_ERROR
- ---------------------------------------------------------------------------------------*/
-int32 OS_API_Impl_Init(uint32 idtype)
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Lock_Global_Shared_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes the table lock of idtype for reading only.
+ *
+ *           Any number of tasks can hold the lock shared at the same time,
+ *           they only exclude OS_Lock_Global_Impl.  The table mutex is only
+ *           held for as long as it takes to register as a reader.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_Lock_Global_Shared_Impl(uint32 idtype)
 {
-	int32 return_code = OS_SUCCESS;
+	if(idtype >= MUTEX_TABLE_SIZE || MUTEX_TABLE[idtype] == NULL)
+	{
+		return OS_ERROR;
+	}
 
-	do
+	if(xSemaphoreTake(*MUTEX_TABLE[idtype], portMAX_DELAY) != pdTRUE)
 	{
-	  /* Initialize the table mutex for the given idtype */
-	  if(idtype < MUTEX_TABLE_SIZE && MUTEX_TABLE[idtype] != NULL)
-	  {
-		  *MUTEX_TABLE[idtype] = xSemaphoreCreateMutex();
-		  if(*MUTEX_TABLE[idtype] == NULL)
-		  {
-			  return_code = OS_ERROR;
-			  break;
-		  }
-	  }
+		return OS_ERROR;
+	}
 
-	  switch(idtype)
-	  {
-	  case OS_OBJECT_TYPE_OS_TASK:
-		 return_code = OS_FreeRTOS_TaskAPI_Impl_Init();
-		 break;
-	  case OS_OBJECT_TYPE_OS_QUEUE:
-		 return_code = OS_FreeRTOS_QueueAPI_Impl_Init();
-		 break;
-	  case OS_OBJECT_TYPE_OS_BINSEM:
-		 return_code = OS_FreeRTOS_BinSemAPI_Impl_Init();
-		 break;
-	  case OS_OBJECT_TYPE_OS_COUNTSEM:
-		 return_code = OS_FreeRTOS_CountSemAPI_Impl_Init();
-		 break;
-	  case OS_OBJECT_TYPE_OS_MUTEX:
-		 return_code = OS_FreeRTOS_MutexAPI_Impl_Init();
-		 break;
-	  case OS_OBJECT_TYPE_OS_MODULE:
-		 return_code = OS_FreeRTOS_ModuleAPI_Impl_Init();
-		 break;
-	  case OS_OBJECT_TYPE_OS_TIMEBASE:
-		 return_code = OS_FreeRTOS_TimeBaseAPI_Impl_Init();
-		 break;
-	  case OS_OBJECT_TYPE_OS_STREAM:
-		 return_code = OS_FreeRTOS_StreamAPI_Impl_Init();
-		 break;
-	  case OS_OBJECT_TYPE_OS_DIR:
-		 return_code = OS_FreeRTOS_DirAPI_Impl_Init();
-		 break;
-	  case OS_OBJECT_TYPE_OS_FILESYS:
-		 return_code = OS_FreeRTOS_FileSysAPI_Impl_Init();
-		 break;
-	  default:
-		 break;
-	  }
-   }
-	while(0);
+	taskENTER_CRITICAL();
+	++OS_table_lock[idtype].readers;
+	taskEXIT_CRITICAL();
 
-#ifndef configFREERTOS_RUN_AS_SIM
-#error configFREERTOS_RUN_AS_SIM must be set to 0 or 1 in FreeRTOSConfig.h
-#endif
-#if configFREERTOS_RUN_AS_SIM == 1
-	freertos_sync_pipe = CreateNamedPipeA(configFREERTOS_SYNC_PIPE_NAME,
-			PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE,
-			PIPE_NOWAIT | PIPE_REJECT_REMOTE_CLIENTS,
-			1, 16, 16, 0, NULL);
-	if(freertos_sync_pipe == INVALID_HANDLE_VALUE) {
-		return_code = OS_ERROR;
-		return return_code;
-	}
-#endif
+	xSemaphoreGive(*MUTEX_TABLE[idtype]);
 
-	return return_code;
-} /* end OS_API_Impl_Init */
+	return OS_SUCCESS;
+} /* end OS_Lock_Global_Shared_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_IdleLoop_Impl
+ * Function: OS_Unlock_Global_Shared_Impl
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
  *
  *-----------------------------------------------------------------*/
-void OS_IdleLoop_Impl(void)
+int32 OS_Unlock_Global_Shared_Impl(uint32 idtype)
 {
-	FreeRTOS_GlobalVars.IdleTaskId = xTaskGetCurrentTaskHandle();
-	vTaskSuspend(FreeRTOS_GlobalVars.IdleTaskId);
-} /* end OS_IdleLoop_Impl */
-
-/*----------------------------------------------------------------
- *
- * Function: OS_ApplicationShutdown_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-void OS_ApplicationShutdown_Impl(void)
-{
-	vTaskResume(FreeRTOS_GlobalVars.IdleTaskId);
-} /* end OS_ApplicationShutdown_Impl */
-
-/*---------------------------------------------------------------------------------------
-   Name: OS_FreeRTOSEntry
-
-   Purpose: A Simple FreeRTOS-compatible entry point that calls the common task entry function
-
-   NOTES: This wrapper function is only used locally by OS_TaskCreate below
-
----------------------------------------------------------------------------------------*/
-static void OS_FreeRTOSEntry(int arg)
-{
-    OS_TaskEntryPoint((uint32)arg);
-} /* end OS_FreeRTOSEntry */
-
-/****************************************************************************************
- TASK API
- ****************************************************************************************/
+	if(idtype >= MUTEX_TABLE_SIZE || MUTEX_TABLE[idtype] == NULL)
+	{
+		return OS_ERROR;
+	}
 
-/*----------------------------------------------------------------
- *
- * Function: OS_FreeRTOS_TaskAPI_Impl_Init
- *
- *  Purpose: Local helper routine, not part of OSAL API.
- *
- *-----------------------------------------------------------------*/
-int32 OS_FreeRTOS_TaskAPI_Impl_Init(void)
-{
-	memset(OS_impl_task_table, 0, sizeof(OS_impl_task_table));
+	taskENTER_CRITICAL();
+	--OS_table_lock[idtype].readers;
+	if(OS_table_lock[idtype].readers == 0 && OS_table_lock[idtype].writer != NULL)
+	{
+		xTaskNotifyGive(OS_table_lock[idtype].writer);
+		OS_table_lock[idtype].writer = NULL;
+	}
+	taskEXIT_CRITICAL();
 
 	return OS_SUCCESS;
-} /* end OS_FreeRTOS_TaskAPI_Impl_Init */
+} /* end OS_Unlock_Global_Shared_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_TaskCreate_Impl
+ * Function: OS_GlobalLockGetStats
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_TaskCreate_Impl(uint32 task_id, uint32 flags)
+int32 OS_GlobalLockGetStats(uint32 idtype, OS_lock_stats_t *lock_stats)
 {
-	BaseType_t status;
+#ifdef OS_FREERTOS_LOCK_PROFILING
+	OS_impl_table_lock_t *lock;
+	TaskHandle_t holder;
+#endif
 
-	/* Because all of cFS and OSAL have been written with the assumption that
-	 * priorities range from 0 (highest priority) to 255 (lowest priority)
-	 * Let's normalize that range into FreeRTOS priorities
-	 */
-	OS_task_table[task_id].priority = (255 - OS_task_table[task_id].priority) / (256/configMAX_PRIORITIES);
+	if(lock_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
 
-	status = xTaskCreate((TaskFunction_t) OS_FreeRTOSEntry,
-			OS_task_table[task_id].task_name,
-			OS_task_table[task_id].stack_size,
-			(void *)OS_global_task_table[task_id].active_id,
-			OS_task_table[task_id].priority,
-			&OS_impl_task_table[task_id].id);
+	memset(lock_stats, 0, sizeof(OS_lock_stats_t));
 
-	if(status != pdPASS)
+	if(idtype >= MUTEX_TABLE_SIZE || MUTEX_TABLE[idtype] == NULL)
 	{
-		return OS_ERROR;
+		return OS_ERR_INCORRECT_OBJ_TYPE;
 	}
 
-	return OS_SUCCESS;
-} /* end OS_TaskCreate_Impl */
+#ifdef OS_FREERTOS_LOCK_PROFILING
+	lock = &OS_table_lock[idtype];
 
-/*----------------------------------------------------------------
- *
- * Function: OS_TaskMatch_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-int32 OS_TaskMatch_Impl(uint32 task_id)
-{
-	if(xTaskGetCurrentTaskHandle() != OS_impl_task_table[task_id].id)
+	/*
+	 * Read without taking the lock, so a dump never waits behind the
+	 * contention it is looking at.  The figures may be slightly torn.
+	 */
+	lock_stats->acquire_count   = lock->acquire_count;
+	lock_stats->wait_count      = lock->wait_count;
+	lock_stats->total_wait_usec = lock->total_wait * 10;
+	lock_stats->max_wait_usec   = OS_FreeRTOS_CountsToUsec(lock->max_wait);
+
+	holder = lock->holder;
+	if(holder != NULL)
 	{
-	   return OS_ERROR;
+		lock_stats->holder_id = (uint32)pvTaskGetThreadLocalStoragePointer(holder, 0);
+		strncpy(lock_stats->holder_name, pcTaskGetName(holder), sizeof(lock_stats->holder_name) - 1);
 	}
 
-   return OS_SUCCESS;
-}/* end OS_TaskMatch_Impl */
+	return OS_SUCCESS;
+#else
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_GlobalLockGetStats */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_TaskDelete_Impl
+ * Function: OS_GlobalLockStatsDump
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_TaskDelete_Impl(uint32 task_id)
+int32 OS_GlobalLockStatsDump(void)
 {
-	/*
-	** Try to delete the task
-	** If this fails, not much recourse - the only potential cause of failure
-	** to cancel here is that the thread ID is invalid because it already exited itself,
-	** and if that is true there is nothing wrong - everything is OK to continue normally.
-	*/
-	vTaskDelete(OS_impl_task_table[task_id].id);
-	OS_impl_task_table[task_id].id = (TaskHandle_t)0xFFFF;
+#ifdef OS_FREERTOS_LOCK_PROFILING
+	static const char * const LOCK_NAME[] =
+	      {
+	            [OS_OBJECT_TYPE_OS_TASK] = "task",
+	            [OS_OBJECT_TYPE_OS_QUEUE] = "queue",
+	            [OS_OBJECT_TYPE_OS_COUNTSEM] = "countsem",
+	            [OS_OBJECT_TYPE_OS_BINSEM] = "binsem",
+	            [OS_OBJECT_TYPE_OS_MUTEX] = "mutex",
+	            [OS_OBJECT_TYPE_OS_STREAM] = "stream",
+	            [OS_OBJECT_TYPE_OS_DIR] = "dir",
+	            [OS_OBJECT_TYPE_OS_TIMEBASE] = "timebase",
+	            [OS_OBJECT_TYPE_OS_MODULE] = "module",
+	            [OS_OBJECT_TYPE_OS_FILESYS] = "filesys",
+	            [OS_OBJECT_TYPE_OS_CONSOLE] = "console",
+	      };
+	OS_lock_stats_t lock_stats;
+	uint32 idtype;
+
+	OS_printf("%-10s %10s %10s %14s %10s %s\n", "table", "acquires", "waits", "total_us", "max_us", "holder");
+	for(idtype = 0; idtype < MUTEX_TABLE_SIZE; idtype++)
+	{
+		if(OS_GlobalLockGetStats(idtype, &lock_stats) != OS_SUCCESS)
+		{
+			continue;
+		}
+
+		OS_printf("%-10s %10lu %10lu %14llu %10lu %s\n",
+				(idtype < (sizeof(LOCK_NAME) / sizeof(LOCK_NAME[0])) && LOCK_NAME[idtype] != NULL) ? LOCK_NAME[idtype] : "?",
+				(unsigned long)lock_stats.acquire_count,
+				(unsigned long)lock_stats.wait_count,
+				(unsigned long long)lock_stats.total_wait_usec,
+				(unsigned long)lock_stats.max_wait_usec,
+				lock_stats.holder_name);
+	}
 
 	return OS_SUCCESS;
-}/* end OS_TaskDelete_Impl */
+#else
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_GlobalLockStatsDump */
 
-/*----------------------------------------------------------------
- *
- * Function: OS_TaskExit_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-void OS_TaskExit_Impl(void)
+/****************************************************************************************
+ STARTUP TRACE
+ ****************************************************************************************/
+
+/*
+ * Startup phases, see OS_StartupPhaseBegin.  The times are read straight from
+ * the host performance counter, so phases before the scheduler and the OSAL
+ * are up can be timed as well.  Phases get consecutive numbers from an
+ * interlocked increment and the table is a ring indexed by that number, so
+ * the last OS_FREERTOS_STARTUP_TRACE_SLOTS phases are kept.  "phase" tells
+ * OS_StartupPhaseEnd whether the slot still holds the phase it ends.
+ */
+#ifdef OS_FREERTOS_STARTUP_TRACE
+typedef struct
 {
-	vTaskDelete(xTaskGetCurrentTaskHandle());
-}/*end OS_TaskExit_Impl */
+	volatile LONG phase;
+	char name[OS_MAX_API_NAME];
+	LARGE_INTEGER begin;
+	LARGE_INTEGER end;
+} OS_startup_phase_t;
+
+static OS_startup_phase_t OS_startup_phase_table[OS_FREERTOS_STARTUP_TRACE_SLOTS];
+static volatile LONG OS_startup_phase_count = 0;
+#endif
 
 /*----------------------------------------------------------------
  *
- * Function: OS_TaskDelay_Impl
+ * Function: OS_StartupPhaseBegin
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_TaskDelay_Impl(uint32 milli_second)
+uint32 OS_StartupPhaseBegin(const char *name)
 {
-	TickType_t ticks;
+#ifdef OS_FREERTOS_STARTUP_TRACE
+	OS_startup_phase_t *slot;
+	LONG phase;
 
-	ticks = OS_Milli2Ticks(milli_second);
-	vTaskDelay(ticks);
+	if(name == NULL)
+	{
+		return OS_STARTUP_PHASE_NONE;
+	}
 
-	return OS_SUCCESS;
-}/* end OS_TaskDelay_Impl */
+	phase = InterlockedIncrement(&OS_startup_phase_count) - 1;
+	if((uint32) phase == OS_STARTUP_PHASE_NONE)
+	{
+		return OS_STARTUP_PHASE_NONE;
+	}
+
+	/* Take the slot from the phase it held before the ring came round */
+	slot = &OS_startup_phase_table[(ULONG) phase % OS_FREERTOS_STARTUP_TRACE_SLOTS];
+	InterlockedExchange(&slot->phase, (LONG) OS_STARTUP_PHASE_NONE);
+	slot->end.QuadPart = 0;
+	strncpy(slot->name, name, sizeof(slot->name) - 1);
+	slot->name[sizeof(slot->name) - 1] = '\0';
+	QueryPerformanceCounter(&slot->begin);
+	InterlockedExchange(&slot->phase, phase);
+
+	return (uint32) phase;
+#else
+	return OS_STARTUP_PHASE_NONE;
+#endif
+} /* end OS_StartupPhaseBegin */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_TaskSetPriority_Impl
+ * Function: OS_StartupPhaseEnd
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_TaskSetPriority_Impl(uint32 task_id, uint32 new_priority)
+void OS_StartupPhaseEnd(uint32 phase)
 {
-	/* Because all of cFS and OSAL have been written with the assumption that
-	 * priorities range from 0 (highest priority) to 255 (lowest priority)
-	 * Let's normalize that range into FreeRTOS priorities
-	 */
-	new_priority = (255 - new_priority) / (256/configMAX_PRIORITIES);
+#ifdef OS_FREERTOS_STARTUP_TRACE
+	OS_startup_phase_t *slot;
 
-	/* Set Task Priority */
-	vTaskPrioritySet(OS_impl_task_table[task_id].id, new_priority);
+	if(phase == OS_STARTUP_PHASE_NONE)
+	{
+		return;
+	}
 
-	return OS_SUCCESS;
-}/* end OS_TaskSetPriority_Impl */
+	/* The slot may have gone to a later phase in the meantime */
+	slot = &OS_startup_phase_table[phase % OS_FREERTOS_STARTUP_TRACE_SLOTS];
+	if((uint32) slot->phase == phase)
+	{
+		QueryPerformanceCounter(&slot->end);
+	}
+#endif
+} /* end OS_StartupPhaseEnd */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_TaskRegister_Impl
+ * Function: OS_StartupReport
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_TaskRegister_Impl(uint32 global_task_id)
+int32 OS_StartupReport(void)
 {
-	TaskHandle_t currentTask = xTaskGetCurrentTaskHandle();
+#ifdef OS_FREERTOS_STARTUP_TRACE
+	const OS_startup_phase_t *phase;
+	const OS_startup_phase_t *other;
+	LARGE_INTEGER frequency;
+	LONGLONG origin;
+	LONGLONG last;
+	uint32 total;
+	uint32 first;
+	uint32 count;
+	uint32 depth;
+	uint32 i;
+	uint32 j;
 
-	if(currentTask != NULL)
+	/*
+	 ** Only the last OS_FREERTOS_STARTUP_TRACE_SLOTS phases are still in
+	 ** the ring, oldest first from "first" on.
+	 */
+	total = (uint32) OS_startup_phase_count;
+	count = total;
+	if(count > OS_FREERTOS_STARTUP_TRACE_SLOTS)
 	{
-		vTaskSetThreadLocalStoragePointer(currentTask,//current task handle
-										  0,//index
-										  (void *)global_task_id);//value to store
-		return OS_SUCCESS;
+		count = OS_FREERTOS_STARTUP_TRACE_SLOTS;
 	}
-	else
+	if(count == 0)
 	{
-		return OS_ERROR;
+		return OS_SUCCESS;
 	}
-}/* end OS_TaskRegister_Impl */
+	first = total - count;
 
-/*----------------------------------------------------------------
- *
- * Function: OS_TaskGetId_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-uint32 OS_TaskGetId_Impl(void)
-{
-	TaskHandle_t currentTask= xTaskGetCurrentTaskHandle();
+	QueryPerformanceFrequency(&frequency);
+	origin = OS_startup_phase_table[first % OS_FREERTOS_STARTUP_TRACE_SLOTS].begin.QuadPart;
+	last = origin;
+	for(i = 0; i < count; i++)
+	{
+		phase = &OS_startup_phase_table[(first + i) % OS_FREERTOS_STARTUP_TRACE_SLOTS];
+		if(phase->begin.QuadPart < origin)
+		{
+			origin = phase->begin.QuadPart;
+		}
+		if(phase->end.QuadPart > last)
+		{
+			last = phase->end.QuadPart;
+		}
+	}
 
-	if(currentTask != NULL)
+	if(total > count)
 	{
-		uint32 task_id;
-		task_id = (uint32) pvTaskGetThreadLocalStoragePointer(currentTask, 0);
-		return task_id;
+		OS_printf("Startup trace: last %lu of %lu phases over %llu usec\n", (unsigned long) count,
+				(unsigned long) total, (unsigned long long) ((last - origin) * 1000000 / frequency.QuadPart));
 	}
 	else
 	{
-		return OS_ERR_NAME_NOT_FOUND;
+		OS_printf("Startup trace: %lu phases over %llu usec\n", (unsigned long) count,
+				(unsigned long long) ((last - origin) * 1000000 / frequency.QuadPart));
 	}
-}/* end OS_TaskGetId_Impl */
-
-/*----------------------------------------------------------------
- *
- * Function: OS_TaskGetInfo_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-int32 OS_TaskGetInfo_Impl(uint32 task_id, OS_task_prop_t *task_prop)
-{
-	task_prop->OStask_id = (uint32) OS_impl_task_table[task_id].id;
 
-	return OS_SUCCESS;
-} /* end OS_TaskGetInfo_Impl */
+	for(i = 0; i < count; i++)
+	{
+		phase = &OS_startup_phase_table[(first + i) % OS_FREERTOS_STARTUP_TRACE_SLOTS];
 
-/****************************************************************************************
- MESSAGE QUEUE API
- ****************************************************************************************/
+		/* Phases are indented by the number of finished phases they ran in */
+		depth = 0;
+		for(j = 0; j < count; j++)
+		{
+			other = &OS_startup_phase_table[(first + j) % OS_FREERTOS_STARTUP_TRACE_SLOTS];
+			if(j != i && other->end.QuadPart != 0 &&
+			   other->begin.QuadPart <= phase->begin.QuadPart &&
+			   other->end.QuadPart >= phase->end.QuadPart && phase->end.QuadPart != 0)
+			{
+				++depth;
+			}
+		}
 
-/*----------------------------------------------------------------
- *
- * Function: OS_FreeRTOS_QueueAPI_Impl_Init
- *
- *  Purpose: Local helper routine, not part of OSAL API.
- *
- *-----------------------------------------------------------------*/
-int32 OS_FreeRTOS_QueueAPI_Impl_Init(void)
-{
-    memset(OS_impl_queue_table, 0, sizeof(OS_impl_queue_table));
+		if(phase->end.QuadPart == 0)
+		{
+			OS_printf("  %*s%-*s at %10llu usec, not finished\n", (int) (depth * 2), "",
+					(int) (32 - depth * 2), phase->name,
+					(unsigned long long) ((phase->begin.QuadPart - origin) * 1000000 / frequency.QuadPart));
+		}
+		else
+		{
+			OS_printf("  %*s%-*s at %10llu usec took %10llu usec\n", (int) (depth * 2), "",
+					(int) (32 - depth * 2), phase->name,
+					(unsigned long long) ((phase->begin.QuadPart - origin) * 1000000 / frequency.QuadPart),
+					(unsigned long long) ((phase->end.QuadPart - phase->begin.QuadPart) * 1000000 / frequency.QuadPart));
+		}
+	}
 
-    return OS_SUCCESS;
-} /* end OS_FreeRTOS_QueueAPI_Impl_Init */
+	return OS_SUCCESS;
+#else
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_StartupReport */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_QueueCreate_Impl
+ * Function: OS_API_Impl_InitPhaseName
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Name of the startup phase of OS_API_Impl_Init for an idtype.
  *
  *-----------------------------------------------------------------*/
-int32 OS_QueueCreate_Impl(uint32 queue_id, uint32 flags)
+static const char *OS_API_Impl_InitPhaseName(uint32 idtype)
 {
-	/*
-	 ** Create the message queue.
-	 */
-	OS_impl_queue_table[queue_id].id = xQueueCreate(
-			OS_queue_table[queue_id].max_depth,
-			OS_queue_table[queue_id].max_size);
-
-	/*
-	 ** If the operation failed, report the error
-	 */
-	if(OS_impl_queue_table[queue_id].id == NULL)
+	switch(idtype)
 	{
-		OS_impl_queue_table[queue_id].id = 0;
-		return OS_ERROR;
+	case OS_OBJECT_TYPE_OS_TASK:
+		return "TaskAPI_Impl_Init";
+	case OS_OBJECT_TYPE_OS_QUEUE:
+		return "QueueAPI_Impl_Init";
+	case OS_OBJECT_TYPE_OS_BINSEM:
+		return "BinSemAPI_Impl_Init";
+	case OS_OBJECT_TYPE_OS_COUNTSEM:
+		return "CountSemAPI_Impl_Init";
+	case OS_OBJECT_TYPE_OS_MUTEX:
+		return "MutexAPI_Impl_Init";
+	case OS_OBJECT_TYPE_OS_MODULE:
+		return "ModuleAPI_Impl_Init";
+	case OS_OBJECT_TYPE_OS_TIMEBASE:
+		return "TimeBaseAPI_Impl_Init";
+	case OS_OBJECT_TYPE_OS_STREAM:
+		return "StreamAPI_Impl_Init";
+	case OS_OBJECT_TYPE_OS_DIR:
+		return "DirAPI_Impl_Init";
+	case OS_OBJECT_TYPE_OS_FILESYS:
+		return "FileSysAPI_Impl_Init";
+	default:
+		return "API_Impl_Init";
 	}
+} /* end OS_API_Impl_InitPhaseName */
 
-	return OS_SUCCESS;
-} /* end OS_QueueCreate_Impl */
+/****************************************************************************************
+ INITIALIZATION FUNCTION
+ ****************************************************************************************/
 
-/*----------------------------------------------------------------
- *
- * Function: OS_QueueDelete_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-int32 OS_QueueDelete_Impl(uint32 queue_id)
-{
-    /* Try to delete the queue */
-    vQueueDelete(OS_impl_queue_table[queue_id].id);
-    OS_impl_queue_table[queue_id].id = (SemaphoreHandle_t)0xFFFF;
+/*---------------------------------------------------------------------------------------
+ Name: OS_API_Impl_Init
 
-    return OS_SUCCESS;
-} /* end OS_QueueDelete_Impl */
+ Purpose: Initialize the tables that the OS API uses to keep track of information
+ about objects
 
-/*----------------------------------------------------------------
- *
- * Function: OS_QueueGet_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-int32 OS_QueueGet_Impl(uint32 queue_id, void *data, uint32 size, uint32 *size_copied, int32 timeout)
+ returns: OS_SUCCESS or OS_ERROR
+ ---------------------------------------------------------------------------------------*/
+int32 OS_API_Impl_Init(uint32 idtype)
 {
-	/* msecs rounded to the closest system tick count */
-	BaseType_t status;
-	TickType_t ticks;
-	QueueHandle_t os_queue_id;
+	int32 return_code = OS_SUCCESS;
+	uint32 phase;
 
-	os_queue_id = OS_impl_queue_table[queue_id].id;
+	phase = OS_StartupPhaseBegin(OS_API_Impl_InitPhaseName(idtype));
 
-	/* Get Message From Message Queue */
-	if(timeout == OS_PEND)
-	{
-		/*
-		 ** Pend forever until a message arrives.
-		 */
-		status = xQueueReceive(os_queue_id, data, portMAX_DELAY);
-		if(status == pdTRUE)
-		{
-			*size_copied = OS_queue_table[queue_id].max_size;
-		}
-		else
-		{
-			*size_copied = 0;
-		}
-	}
-	else if(timeout == OS_CHECK)
-	{
-		/*
-		 ** Get a message without waiting.  If no message is present,
-		 ** return with a failure indication.
-		 */
-		status = xQueueReceive(os_queue_id, data, 0);
-		if(status == pdTRUE)
-		{
-			*size_copied = OS_queue_table[queue_id].max_size;
-		}
-		else
-		{
-			*size_copied = 0;
-			return OS_QUEUE_EMPTY;
-		}
-	}
-	else
+	do
 	{
-		/*
-		 ** Wait for up to a specified amount of time for a message to arrive.
-		 ** If no message arrives within the timeout interval, return with a
-		 ** failure indication.
-		 */
-		ticks = OS_Milli2Ticks(timeout);
-
-		status = xQueueReceive(os_queue_id, data, ticks);
-		if(status == pdTRUE)
-		{
-			*size_copied = OS_queue_table[queue_id].max_size;
-		}
-		else
-		{
-			*size_copied = 0;
-			return OS_QUEUE_TIMEOUT;
-		}
+	  /* Initialize the table mutex for the given idtype */
+	  if(idtype < MUTEX_TABLE_SIZE && MUTEX_TABLE[idtype] != NULL)
+	  {
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+		  *MUTEX_TABLE[idtype] = xSemaphoreCreateMutexStatic(&OS_table_mutex_cb[idtype]);
+#else
+		  *MUTEX_TABLE[idtype] = xSemaphoreCreateMutex();
+#endif
+		  OS_table_lock[idtype].readers = 0;
+		  OS_table_lock[idtype].writer = NULL;
+		  if(*MUTEX_TABLE[idtype] == NULL)
+		  {
+			  return_code = OS_ERROR;
+			  break;
+		  }
+	  }
 
-	}/* else */
+	  switch(idtype)
+	  {
+	  case OS_OBJECT_TYPE_OS_TASK:
+		 return_code = OS_FreeRTOS_TaskAPI_Impl_Init();
+		 break;
+	  case OS_OBJECT_TYPE_OS_QUEUE:
+		 return_code = OS_FreeRTOS_QueueAPI_Impl_Init();
+		 break;
+	  case OS_OBJECT_TYPE_OS_BINSEM:
+		 return_code = OS_FreeRTOS_BinSemAPI_Impl_Init();
+		 if(return_code == OS_SUCCESS)
+		 {
+			 /* Event flags have no shared layer type, their table comes up with the semaphores */
+			 return_code = OS_FreeRTOS_EventFlagsAPI_Impl_Init();
+		 }
+		 break;
+	  case OS_OBJECT_TYPE_OS_COUNTSEM:
+		 return_code = OS_FreeRTOS_CountSemAPI_Impl_Init();
+		 break;
+	  case OS_OBJECT_TYPE_OS_MUTEX:
+		 return_code = OS_FreeRTOS_MutexAPI_Impl_Init();
+		 break;
+	  case OS_OBJECT_TYPE_OS_MODULE:
+		 return_code = OS_FreeRTOS_ModuleAPI_Impl_Init();
+		 break;
+	  case OS_OBJECT_TYPE_OS_TIMEBASE:
+		 return_code = OS_FreeRTOS_TimeBaseAPI_Impl_Init();
+		 break;
+	  case OS_OBJECT_TYPE_OS_STREAM:
+		 return_code = OS_FreeRTOS_StreamAPI_Impl_Init();
+		 if(return_code == OS_SUCCESS)
+		 {
+			 return_code = OS_FreeRTOS_PipeAPI_Impl_Init();
+		 }
+		 break;
+	  case OS_OBJECT_TYPE_OS_DIR:
+		 return_code = OS_FreeRTOS_DirAPI_Impl_Init();
+		 break;
+	  case OS_OBJECT_TYPE_OS_FILESYS:
+		 return_code = OS_FreeRTOS_FileSysAPI_Impl_Init();
+		 break;
+	  default:
+		 break;
+	  }
+   }
+	while(0);
 
+#ifndef configFREERTOS_RUN_AS_SIM
+#error configFREERTOS_RUN_AS_SIM must be set to 0 or 1 in FreeRTOSConfig.h
+#endif
+#if configFREERTOS_RUN_AS_SIM == 1
 	/*
-	 ** Check the status of the read operation.  If a valid message was
-	 ** obtained, indicate success.
+	 * This is called once per object type, but there is only one pipe.  It is
+	 * opened for overlapped I/O so the tick hook can wait on it without spinning.
 	 */
-	if(status == pdTRUE)
-	{
-		/* Success. */
-		return OS_SUCCESS;
-	}
-	else
-	{
-		*size_copied = 0;
-		return OS_ERROR;
+	if(freertos_sync_pipe == INVALID_HANDLE_VALUE) {
+		OS_StartupPhaseEnd(phase);
+		phase = OS_StartupPhaseBegin("sim sync pipe");
+#if configFREERTOS_SIM_COORDINATED == 1
+		/* Many nodes share one coordinator, so the node is the client */
+		freertos_sync_pipe = xSimSyncRegister();
+#else
+		freertos_sync_pipe = CreateNamedPipeA(configFREERTOS_SYNC_PIPE_NAME,
+				PIPE_ACCESS_DUPLEX | FILE_FLAG_FIRST_PIPE_INSTANCE | FILE_FLAG_OVERLAPPED,
+				PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+				1, 256, 256, 0, NULL);
+#endif
+		if(freertos_sync_pipe == INVALID_HANDLE_VALUE) {
+			OS_StartupPhaseEnd(phase);
+			return_code = OS_ERROR;
+			return return_code;
+		}
 	}
-}/* end OS_QueueGet_Impl */
+#endif
+
+	OS_StartupPhaseEnd(phase);
+
+	return return_code;
+} /* end OS_API_Impl_Init */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_QueuePut_Impl
+ * Function: OS_IdleLoop_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_QueuePut_Impl(uint32 queue_id, const void *data, uint32 size, uint32 flags)
+void OS_IdleLoop_Impl(void)
 {
-	BaseType_t status;
-	QueueHandle_t os_queue_id;
-
-	os_queue_id = OS_impl_queue_table[queue_id].id;
-
-	/* Write the buffer pointer to the queue.  If an error occurred, report it
-	 ** with the corresponding SB status code.
-	 */
-	status = xQueueSend(os_queue_id, data, 0);
-
-	if(status == pdTRUE)
-	{
-		return OS_SUCCESS;
-	}
-	else if(status == errQUEUE_FULL)
-	{
-		/*
-		 ** Queue is full.
-		 */
-		return OS_QUEUE_FULL;
-	}
-	else
-	{
-		/*
-		 ** Unexpected error while writing to queue.
-		 */
-		return OS_ERROR;
-	}
-}/* end OS_QueuePut_Impl */
+	FreeRTOS_GlobalVars.IdleTaskId = xTaskGetCurrentTaskHandle();
+	vTaskSuspend(FreeRTOS_GlobalVars.IdleTaskId);
+} /* end OS_IdleLoop_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_QueueGetInfo_Impl
+ * Function: OS_ApplicationShutdown_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_QueueGetInfo_Impl(uint32 queue_id, OS_queue_prop_t *queue_prop)
+void OS_ApplicationShutdown_Impl(void)
 {
-    return OS_SUCCESS;
-} /* end OS_QueueGetInfo_Impl */
-
-/****************************************************************************************
- BINARY SEMAPHORE API
- ***************************************************************************************/
+	vTaskResume(FreeRTOS_GlobalVars.IdleTaskId);
+} /* end OS_ApplicationShutdown_Impl */
 
+#ifdef OS_FREERTOS_STACK_MONITOR
 /*----------------------------------------------------------------
  *
- * Function: OS_FreeRTOS_BinSemAPI_Impl_Init
+ * Function: OS_FreeRTOS_StackPaint
  *
  *  Purpose: Local helper routine, not part of OSAL API.
+ *           Paints stack_size bytes of the calling thread's stack below this frame
  *
- *-----------------------------------------------------------------*/
-int32 OS_FreeRTOS_BinSemAPI_Impl_Init(void)
-{
-    memset(OS_impl_bin_sem_table, 0, sizeof(OS_impl_bin_sem_table));
-
-    return OS_SUCCESS;
-} /* end OS_FreeRTOS_BinSemAPI_Impl_Init */
-
-/*----------------------------------------------------------------
- *
- * Function: OS_BinSemCreate_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Notes:   Tasks run on the stacks of their Win32 threads, not on the stack
+ *           FreeRTOS allocates, so that is the stack that is painted.
  *
  *-----------------------------------------------------------------*/
-int32 OS_BinSemCreate_Impl(uint32 sem_id, uint32 sem_initial_value, uint32 options)
+static void OS_FreeRTOS_StackPaint(OS_impl_task_internal_record_t *local, uint32 stack_size)
 {
-	/* Check to make sure the sem value is going to be either 0 or 1 */
-	if(sem_initial_value > 1)
+	MEMORY_BASIC_INFORMATION region;
+	volatile uint32 *top;
+	ULONG_PTR avail;
+	uint32 words;
+	uint32 i;
+
+	top = (volatile uint32 *)(((ULONG_PTR)&region - OS_FREERTOS_STACK_PAINT_MARGIN) & ~(ULONG_PTR)(sizeof(uint32) - 1));
+	if(VirtualQuery((LPCVOID)top, &region, sizeof(region)) == 0 ||
+	   (ULONG_PTR)top < (ULONG_PTR)region.AllocationBase + OS_FREERTOS_STACK_PAINT_RESERVE)
 	{
-		sem_initial_value = 1;
+		return;
 	}
 
-	/* Create Semaphore */
-	OS_impl_bin_sem_table[sem_id].id = xSemaphoreCreateBinary();
-
-	/* check if Create failed */
-	if(OS_impl_bin_sem_table[sem_id].id == NULL)
+	avail = ((ULONG_PTR)top - (ULONG_PTR)region.AllocationBase - OS_FREERTOS_STACK_PAINT_RESERVE) / sizeof(uint32);
+	words = stack_size / sizeof(uint32);
+	if(words > avail)
 	{
-		OS_impl_bin_sem_table[sem_id].id = 0;
-		return OS_SEM_FAILURE;
+		words = (uint32)avail;
 	}
 
-	// Initialize the semaphore value
-	for(int i = 0; i < sem_initial_value; i++)
+	/* Downwards one word at a time, so each guard page is met in order and the stack grows */
+	for(i = 1; i <= words; i++)
 	{
-		xSemaphoreGive(OS_impl_bin_sem_table[sem_id].id);
+		top[-(int32)i] = OS_FREERTOS_STACK_PAINT_WORD;
 	}
 
-	return OS_SUCCESS;
-}/* end OS_BinSemCreate_Impl */
+	taskENTER_CRITICAL();
+	local->stack_paint = top - words;
+	local->stack_paint_words = words;
+	local->stack_used_peak = 0;
+	local->stack_reported = 0;
+	taskEXIT_CRITICAL();
+} /* end OS_FreeRTOS_StackPaint */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_BinSemDelete_Impl
+ * Function: OS_FreeRTOS_StackScan
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Updates the peak stack use of a task from its paint
+ *
+ *  Notes:   Call with the scheduler suspended, so the task cannot exit and
+ *           release its stack during the scan.
  *
  *-----------------------------------------------------------------*/
-int32 OS_BinSemDelete_Impl(uint32 sem_id)
+static void OS_FreeRTOS_StackScan(OS_impl_task_internal_record_t *local)
 {
-	vSemaphoreDelete(OS_impl_bin_sem_table[sem_id].id);
-	OS_impl_bin_sem_table[sem_id].id = (SemaphoreHandle_t)0xFFFF;
+	uint32 limit;
+	uint32 untouched = 0;
 
-	return OS_SUCCESS;
-}/* end OS_BinSemDelete_Impl */
+	if(local->stack_paint == NULL)
+	{
+		return;
+	}
 
-/*----------------------------------------------------------------
- *
- * Function: OS_BinSemGive_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-int32 OS_BinSemGive_Impl(uint32 sem_id)
-{
-	xSemaphoreGive(OS_impl_bin_sem_table[sem_id].id);
+	/* The stack grows down into the paint, so only the words below the last peak can change */
+	limit = local->stack_paint_words - local->stack_used_peak / sizeof(uint32);
+	while(untouched < limit && local->stack_paint[untouched] == OS_FREERTOS_STACK_PAINT_WORD)
+	{
+		untouched++;
+	}
 
-	return OS_SUCCESS;
-}/* end OS_BinSemGive_Impl */
+	local->stack_used_peak = (local->stack_paint_words - untouched) * sizeof(uint32);
+} /* end OS_FreeRTOS_StackScan */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_BinSemFlush_Impl
+ * Function: OS_FreeRTOS_StackRelease
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Stops the scans of a task's stack before the task is deleted
  *
  *-----------------------------------------------------------------*/
-int32 OS_BinSemFlush_Impl(uint32 sem_id)
+static void OS_FreeRTOS_StackRelease(TaskHandle_t task)
 {
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_ERR_NOT_IMPLEMENTED;
-}/* end OS_BinSemFlush_Impl */
+	uint32 task_id;
 
-/*----------------------------------------------------------------
- *
- * Function: OS_BinSemTake_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-int32 OS_BinSemTake_Impl(uint32 sem_id)
-{
-	if(xSemaphoreTake(OS_impl_bin_sem_table[sem_id].id, portMAX_DELAY) == pdTRUE)
-	{
-		return OS_SUCCESS;
-	}
-	else
+	taskENTER_CRITICAL();
+	for(task_id = 0; task_id < OS_MAX_TASKS; task_id++)
 	{
-		return OS_SEM_FAILURE;
+		if(OS_impl_task_table[task_id].id == task)
+		{
+			OS_impl_task_table[task_id].stack_paint = NULL;
+		}
 	}
-}/* end OS_BinSemTake_Impl */
+	taskEXIT_CRITICAL();
+} /* end OS_FreeRTOS_StackRelease */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_BinSemTimedWait_Impl
+ * Function: OS_FreeRTOS_StackMonitor_Entry
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Samples the stack use of every task and warns about tasks
+ *           close to or past their OSAL stack size
  *
  *-----------------------------------------------------------------*/
-int32 OS_BinSemTimedWait_Impl(uint32 sem_id, uint32 msecs)
+static void OS_FreeRTOS_StackMonitor_Entry(void *arg)
 {
-	BaseType_t status;
-	uint32 TimeInTicks;
-
-	TimeInTicks = OS_Milli2Ticks(msecs);
+	OS_impl_task_internal_record_t *local;
+	TickType_t wake = xTaskGetTickCount();
+	uint32 task_id;
+	uint32 used;
+	uint32 size;
+	uint8 report;
 
-	status = xSemaphoreTake(OS_impl_bin_sem_table[sem_id].id, TimeInTicks);
+	(void) arg;
 
-	switch(status)
+	for(;;)
 	{
-	case pdFALSE:
-		return OS_SEM_TIMEOUT;
-		break;
+		vTaskDelayUntil(&wake, pdMS_TO_TICKS(OS_FREERTOS_STACK_MONITOR_MSEC));
 
-	case pdTRUE:
-		return OS_SUCCESS;
-		break;
+		for(task_id = 0; task_id < OS_MAX_TASKS; task_id++)
+		{
+			local = &OS_impl_task_table[task_id];
+			report = 0;
+
+			vTaskSuspendAll();
+			OS_FreeRTOS_StackScan(local);
+			used = local->stack_used_peak;
+			size = local->stack_paint_words * sizeof(uint32);
+			if(local->stack_paint != NULL)
+			{
+				if(used >= size && local->stack_reported < 2)
+				{
+					report = local->stack_reported = 2;
+				}
+				else if(used * 100 >= size * OS_FREERTOS_STACK_MONITOR_WARN_PERCENT && local->stack_reported < 1)
+				{
+					report = local->stack_reported = 1;
+				}
+			}
+			xTaskResumeAll();
 
-	default:
-		return OS_SEM_FAILURE;
-		break;
+			if(report == 2)
+			{
+				OS_printf("Stack monitor: task %s overflowed its %lu byte stack\n",
+						OS_task_table[task_id].task_name, (unsigned long)size);
+			}
+			else if(report == 1)
+			{
+				OS_printf("Stack monitor: task %s has used %lu of its %lu byte stack\n",
+						OS_task_table[task_id].task_name, (unsigned long)used, (unsigned long)size);
+			}
+		}
 	}
-}/* end OS_BinSemTimedWait_Impl */
+} /* end OS_FreeRTOS_StackMonitor_Entry */
+#endif
 
-/*----------------------------------------------------------------
- *
- * Function: OS_BinSemGetInfo_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-int32 OS_BinSemGetInfo_Impl(uint32 sem_id, OS_bin_sem_prop_t *bin_prop)
+/*---------------------------------------------------------------------------------------
+   Name: OS_FreeRTOSEntry
+
+   Purpose: A Simple FreeRTOS-compatible entry point that calls the common task entry function
+
+   NOTES: This wrapper function is only used locally by OS_TaskCreate below
+
+          The Win32 thread backing the task can only be reached from the task
+          itself, so core pinning and stack painting are applied here before
+          the OSAL entry runs.
+
+          With OS_FREERTOS_TASK_RECYCLE a parked task comes back to the
+          setjmp below each time it is handed a new OSAL task.
+
+---------------------------------------------------------------------------------------*/
+static void OS_FreeRTOSEntry(int arg)
 {
-	return OS_SUCCESS;
-} /* end OS_BinSemGetInfo_Impl */
+	volatile uint32 task_id = (uint32)arg;
+	uint32 local_id;
+#ifdef OS_FREERTOS_TASK_RECYCLE
+	int32 recycle_slot = -1;
+
+	if(OS_ObjectIdToArrayIndex(OS_OBJECT_TYPE_OS_TASK, task_id, &local_id) == OS_SUCCESS)
+	{
+		recycle_slot = OS_impl_task_table[local_id].recycle_slot;
+	}
+
+	if(recycle_slot >= 0 && setjmp(OS_impl_task_recycle[recycle_slot].restart) != 0)
+	{
+		task_id = OS_impl_task_recycle[recycle_slot].next_id;
+	}
+#endif
+
+	if(OS_ObjectIdToArrayIndex(OS_OBJECT_TYPE_OS_TASK, task_id, &local_id) == OS_SUCCESS)
+	{
+		if((OS_impl_task_table[local_id].flags & OS_TASK_CORE_PINNED) != 0)
+		{
+			uint32 core = (OS_impl_task_table[local_id].flags >> OS_TASK_CORE_SHIFT) & OS_TASK_CORE_MASK;
+
+			if(SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << core) == 0)
+			{
+				OS_DEBUG("SetThreadAffinityMask(core %lu) failed: %lu\n",
+						(unsigned long)core, (unsigned long)GetLastError());
+			}
+		}
+#ifdef OS_FREERTOS_TASK_RECYCLE
+		else if(recycle_slot >= 0)
+		{
+			DWORD_PTR process_mask;
+			DWORD_PTR system_mask;
+
+			/* Undo the pinning of an earlier OSAL task run by this thread */
+			if(GetProcessAffinityMask(GetCurrentProcess(), &process_mask, &system_mask))
+			{
+				SetThreadAffinityMask(GetCurrentThread(), process_mask);
+			}
+		}
+#endif
+
+#ifdef OS_FREERTOS_STACK_MONITOR
+		OS_FreeRTOS_StackPaint(&OS_impl_task_table[local_id], OS_task_table[local_id].stack_size);
+#endif
+	}
+
+	OS_TaskEntryPoint(task_id);
+} /* end OS_FreeRTOSEntry */
 
 /****************************************************************************************
- COUNTING SEMAPHORE API
- ***************************************************************************************/
+ TASK API
+ ****************************************************************************************/
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FreeRTOS_CountSemAPI_Impl_Init
+ * Function: OS_FreeRTOS_TaskAPI_Impl_Init
  *
  *  Purpose: Local helper routine, not part of OSAL API.
  *
  *-----------------------------------------------------------------*/
-int32 OS_FreeRTOS_CountSemAPI_Impl_Init(void)
+int32 OS_FreeRTOS_TaskAPI_Impl_Init(void)
 {
-    memset(OS_impl_count_sem_table, 0, sizeof(OS_impl_count_sem_table));
+	memset(OS_impl_task_table, 0, sizeof(OS_impl_task_table));
 
-    return OS_SUCCESS;
-} /* end OS_FreeRTOS_CountSemAPI_Impl_Init */
+#ifdef OS_FREERTOS_STATIC_TASKS
+	memset(OS_impl_task_pool, 0, sizeof(OS_impl_task_pool));
+#endif
+
+#ifdef OS_FREERTOS_TASK_RECYCLE
+	memset(OS_impl_task_recycle, 0, sizeof(OS_impl_task_recycle));
+#endif
+
+#ifdef OS_FREERTOS_STACK_MONITOR
+	if(OS_impl_stack_monitor == NULL &&
+	   xTaskCreate(OS_FreeRTOS_StackMonitor_Entry, "OS_StackMonitor", OS_FREERTOS_STACK_MONITOR_STACK_SIZE, NULL,
+			OS_FREERTOS_STACK_MONITOR_PRIORITY, &OS_impl_stack_monitor) != pdPASS)
+	{
+		return OS_ERROR;
+	}
+#endif
+
+	return OS_SUCCESS;
+} /* end OS_FreeRTOS_TaskAPI_Impl_Init */
 
+#ifdef OS_FREERTOS_STATIC_TASKS
 /*----------------------------------------------------------------
  *
- * Function: OS_CountSemCreate_Impl
+ * Function: OS_FreeRTOS_TaskPoolAlloc
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns the index of a free task pool slot, or -1 if there is none.
  *
  *-----------------------------------------------------------------*/
-int32 OS_CountSemCreate_Impl(uint32 sem_id, uint32 sem_initial_value, uint32 options)
+static int32 OS_FreeRTOS_TaskPoolAlloc(void)
 {
-	/*
-	 ** Verify that the semaphore maximum value is not too high
-	 */
-	if(sem_initial_value > MAX_SEM_VALUE)
+	int32 slot;
+
+	taskENTER_CRITICAL();
+	for(slot = 0; slot < OS_MAX_TASKS; slot++)
 	{
-		return OS_INVALID_SEM_VALUE;
+		if(!OS_impl_task_pool[slot].in_use)
+		{
+			OS_impl_task_pool[slot].in_use = true;
+			break;
+		}
 	}
+	taskEXIT_CRITICAL();
 
-	OS_impl_count_sem_table[sem_id].id = xSemaphoreCreateCounting(MAX_SEM_VALUE, sem_initial_value);
-
-	/* check if Create failed */
-	if(OS_impl_count_sem_table[sem_id].id == NULL)
+	if(slot >= OS_MAX_TASKS)
 	{
-		return OS_SEM_FAILURE;
+		return -1;
 	}
 
-	return OS_SUCCESS;
-}/* end OS_CountSemCreate_Impl */
+	return slot;
+} /* end OS_FreeRTOS_TaskPoolAlloc */
+#endif
 
+#if defined(OS_FREERTOS_STATIC_TASKS) || defined(OS_FREERTOS_TASK_RECYCLE)
 /*----------------------------------------------------------------
  *
- * Function: OS_CountSemDelete_Impl
+ * Function: OS_FreeRTOS_TaskReap
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Runs in the timer service task on behalf of a task that exits.
+ *
+ *           A task that deletes itself leaves its TCB on the kernel's
+ *           termination list until the idle task gets round to it, and a
+ *           static TCB must not be reused before then.  Deleting the task
+ *           from another task cleans it up straight away, so the pool slot
+ *           can be given back as soon as vTaskDelete returns.
  *
  *-----------------------------------------------------------------*/
-int32 OS_CountSemDelete_Impl(uint32 sem_id)
+static void OS_FreeRTOS_TaskReap(void *task, uint32_t slot)
 {
-	vSemaphoreDelete(OS_impl_count_sem_table[sem_id].id);
-	OS_impl_count_sem_table[sem_id].id = 0;
+	vTaskDelete((TaskHandle_t) task);
 
-	return OS_SUCCESS;
-}/* end OS_CountSemDelete_Impl */
+#ifdef OS_FREERTOS_STATIC_TASKS
+	/* Heap allocated tasks are passed OS_MAX_TASKS */
+	if(slot < OS_MAX_TASKS)
+	{
+		OS_impl_task_pool[slot].in_use = false;
+	}
+#else
+	(void) slot;
+#endif
+} /* end OS_FreeRTOS_TaskReap */
+#endif
 
+#ifdef OS_FREERTOS_TASK_RECYCLE
 /*----------------------------------------------------------------
  *
- * Function: OS_CountSemGive_Impl
+ * Function: OS_FreeRTOS_TaskRecycle
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Hands the new OSAL task to a parked task with a matching stack
+ *           and returns true.  Otherwise takes a free recycle entry, if any,
+ *           for the task about to be created and returns false.
  *
  *-----------------------------------------------------------------*/
-int32 OS_CountSemGive_Impl(uint32 sem_id)
+static bool OS_FreeRTOS_TaskRecycle(uint32 task_id)
 {
-	if(xSemaphoreGive(OS_impl_count_sem_table[sem_id].id) != pdTRUE)
+	OS_impl_task_internal_record_t *local = &OS_impl_task_table[task_id];
+	OS_impl_task_recycle_t *entry;
+	TaskStatus_t status;
+	uint32 stack_size = OS_task_table[task_id].stack_size;
+	int32 free_slot = -1;
+	int32 slot;
+
+	taskENTER_CRITICAL();
+	for(slot = 0; slot < OS_MAX_TASKS + OS_FREERTOS_TASK_RECYCLE_PARKED; slot++)
 	{
-		return OS_SEM_FAILURE;
+		entry = &OS_impl_task_recycle[slot];
+		if(!entry->in_use)
+		{
+			if(free_slot < 0)
+			{
+				free_slot = slot;
+			}
+		}
+		else if(entry->parked && (entry->stack_size == stack_size
+#ifdef OS_FREERTOS_STATIC_TASKS
+				|| (entry->static_slot >= 0 && stack_size <= OS_TASK_STATIC_STACK_SIZE)
+#endif
+				))
+		{
+			/*
+			 * Everything the task reads when it wakes is set before parked is
+			 * cleared, in case a stray notification wakes it before ours.
+			 */
+			local->id = entry->task;
+			local->recycle_slot = slot;
+#ifdef OS_FREERTOS_STATIC_TASKS
+			local->static_slot = entry->static_slot;
+#endif
+			vTaskPrioritySet(entry->task, local->freertos_priority);
+			entry->next_id = OS_global_task_table[task_id].active_id;
+			entry->parked = false;
+			break;
+		}
 	}
-	else
+
+	if(slot >= OS_MAX_TASKS + OS_FREERTOS_TASK_RECYCLE_PARKED)
 	{
-		return OS_SUCCESS;
+		local->recycle_slot = free_slot;
+		if(free_slot >= 0)
+		{
+			OS_impl_task_recycle[free_slot].in_use = true;
+			OS_impl_task_recycle[free_slot].parked = false;
+			OS_impl_task_recycle[free_slot].stack_size = stack_size;
+		}
 	}
-}/* end OS_CountSemGive_Impl */
+	taskEXIT_CRITICAL();
+
+	if(slot >= OS_MAX_TASKS + OS_FREERTOS_TASK_RECYCLE_PARKED)
+	{
+		return false;
+	}
+
+	/*
+	 * The FreeRTOS run time counter of the task carries over from the OSAL
+	 * tasks it ran before, so the new one starts counting from its value now.
+	 */
+	vTaskGetInfo(local->id, &status, pdFALSE, eInvalid);
+	local->run_time_seen = status.ulRunTimeCounter;
+
+	xTaskNotifyGive(local->id);
+
+	return true;
+} /* end OS_FreeRTOS_TaskRecycle */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_CountSemTake_Impl
+ * Function: OS_FreeRTOS_TaskPark
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Parks the calling task, whose OSAL task is exiting, until
+ *           OS_FreeRTOS_TaskRecycle hands it a new one, then restarts it in
+ *           OS_FreeRTOSEntry.  Returns only if the park is already full,
+ *           in which case the caller must delete the task.
  *
  *-----------------------------------------------------------------*/
-int32 OS_CountSemTake_Impl(uint32 sem_id)
+static void OS_FreeRTOS_TaskPark(uint32 task_id)
 {
-	if(xSemaphoreTake(OS_impl_count_sem_table[sem_id].id, portMAX_DELAY) != pdTRUE)
+	OS_impl_task_internal_record_t *local = &OS_impl_task_table[task_id];
+	OS_impl_task_recycle_t *entry = &OS_impl_task_recycle[local->recycle_slot];
+	uint32 parked = 0;
+	uint32 slot;
+
+	taskENTER_CRITICAL();
+	for(slot = 0; slot < OS_MAX_TASKS + OS_FREERTOS_TASK_RECYCLE_PARKED; slot++)
 	{
-		return OS_SEM_FAILURE;
+		if(OS_impl_task_recycle[slot].parked)
+		{
+			parked++;
+		}
 	}
 
-	return OS_SUCCESS;
-}/* end OS_CountSemTake_Impl */
+	if(parked < OS_FREERTOS_TASK_RECYCLE_PARKED)
+	{
+		/* The task pool slot, if any, stays with the task while it is parked */
+		entry->task = local->id;
+#ifdef OS_FREERTOS_STATIC_TASKS
+		entry->static_slot = local->static_slot;
+		local->static_slot = -1;
+#endif
+		entry->parked = true;
+		local->id = (TaskHandle_t)0xFFFF;
+	}
+	else
+	{
+		entry->in_use = false;
+	}
+	local->recycle_slot = -1;
+	taskEXIT_CRITICAL();
+
+	if(parked >= OS_FREERTOS_TASK_RECYCLE_PARKED)
+	{
+		return;
+	}
+
+	vTaskSetThreadLocalStoragePointer(NULL, 0, NULL);
+	vTaskSetThreadLocalStoragePointer(NULL, OS_FREERTOS_TLS_HEAP_CATEGORY, (void *)(uintptr_t) OS_HEAP_CATEGORY_OTHER);
+
+	/* Notifications still on their way to the OSAL task that exited are dropped here */
+	while(entry->parked)
+	{
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+	}
+
+	longjmp(entry->restart, 1);
+} /* end OS_FreeRTOS_TaskPark */
+#endif
 
 /*----------------------------------------------------------------
  *
- * Function: OS_CountSemTimedWait_Impl
+ * Function: OS_TaskCreate_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_CountSemTimedWait_Impl(uint32 sem_id, uint32 msecs)
+int32 OS_TaskCreate_Impl(uint32 task_id, uint32 flags)
 {
 	BaseType_t status;
-	uint32 TimeInTicks;
+	uint32 heap_category;
 
-	TimeInTicks = OS_Milli2Ticks(msecs);
+	OS_FREERTOS_API_ENTER(TaskCreate);
 
-	status = xSemaphoreTake(OS_impl_count_sem_table[sem_id].id, TimeInTicks);
-	switch(status)
+	/* Because all of cFS and OSAL have been written with the assumption that
+	 * priorities range from 0 (highest priority) to 255 (lowest priority)
+	 * Let's normalize that range into FreeRTOS priorities.  The OSAL value
+	 * in OS_task_table is left alone so OS_TaskGetInfo still reports it.
+	 */
+	OS_impl_task_table[task_id].freertos_priority = OS_FreeRTOS_PriorityMap[OS_task_table[task_id].priority & 0xFF];
+	OS_impl_task_table[task_id].flags = flags;
+	OS_impl_task_table[task_id].run_time = 0;
+	OS_impl_task_table[task_id].run_time_seen = 0;
+	OS_impl_task_table[task_id].window_run_time = 0;
+	OS_impl_task_table[task_id].window_start = ulGetRunTimeCounterValue();
+	OS_impl_task_table[task_id].cpu_usage = 0;
+	OS_impl_task_table[task_id].window_len = 0;
+	OS_impl_task_table[task_id].period = 0;
+	OS_impl_task_table[task_id].release_count = 0;
+	OS_impl_task_table[task_id].overrun_count = 0;
+	OS_impl_task_table[task_id].max_lateness = 0;
+#ifdef OS_FREERTOS_STACK_MONITOR
+	OS_impl_task_table[task_id].stack_paint = NULL;
+#endif
+
+#ifdef OS_FREERTOS_TASK_RECYCLE
+	if(OS_FreeRTOS_TaskRecycle(task_id))
 	{
-	case pdFALSE:
-		return OS_SEM_TIMEOUT;
-		break;
+		return OS_FREERTOS_API_EXIT(TaskCreate, OS_SUCCESS);
+	}
+#endif
 
-	case pdTRUE:
-		return OS_SUCCESS;
-		break;
+#ifdef OS_FREERTOS_STATIC_TASKS
+	OS_impl_task_table[task_id].static_slot = -1;
+	if(OS_task_table[task_id].stack_size <= OS_TASK_STATIC_STACK_SIZE)
+	{
+		OS_impl_task_table[task_id].static_slot = OS_FreeRTOS_TaskPoolAlloc();
+	}
 
-	default:
-		return OS_SEM_FAILURE;
-		break;
+	if(OS_impl_task_table[task_id].static_slot >= 0)
+	{
+		OS_impl_task_pool_entry_t *entry = &OS_impl_task_pool[OS_impl_task_table[task_id].static_slot];
+
+		OS_impl_task_table[task_id].id = xTaskCreateStatic((TaskFunction_t) OS_FreeRTOSEntry,
+				OS_task_table[task_id].task_name,
+				OS_TASK_STATIC_STACK_SIZE,
+				(void *)OS_global_task_table[task_id].active_id,
+				OS_impl_task_table[task_id].freertos_priority,
+				entry->stack,
+				&entry->tcb);
+
+		return OS_FREERTOS_API_EXIT(TaskCreate, OS_SUCCESS);
+	}
+#endif
+
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_TASK);
+	status = xTaskCreate((TaskFunction_t) OS_FreeRTOSEntry,
+			OS_task_table[task_id].task_name,
+			OS_task_table[task_id].stack_size,
+			(void *)OS_global_task_table[task_id].active_id,
+			OS_impl_task_table[task_id].freertos_priority,
+			&OS_impl_task_table[task_id].id);
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+
+	if(status != pdPASS)
+	{
+#ifdef OS_FREERTOS_TASK_RECYCLE
+		if(OS_impl_task_table[task_id].recycle_slot >= 0)
+		{
+			OS_impl_task_recycle[OS_impl_task_table[task_id].recycle_slot].in_use = false;
+			OS_impl_task_table[task_id].recycle_slot = -1;
+		}
+#endif
+		return OS_FREERTOS_API_EXIT(TaskCreate, OS_ERROR);
 	}
-}/* end OS_CountSemTimedWait_Impl */
+
+	return OS_FREERTOS_API_EXIT(TaskCreate, OS_SUCCESS);
+} /* end OS_TaskCreate_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_CountSemGetInfo_Impl
+ * Function: OS_TaskMatch_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_CountSemGetInfo_Impl(uint32 sem_id, OS_count_sem_prop_t *count_prop)
+int32 OS_TaskMatch_Impl(uint32 task_id)
 {
-	return OS_SUCCESS;
-} /* end OS_CountSemGetInfo_Impl */
-
-/****************************************************************************************
- MUTEX API
- ****************************************************************************************/
+	OS_FREERTOS_API_ENTER(TaskMatch);
 
-/*----------------------------------------------------------------
- *
- * Function: OS_FreeRTOS_MutexAPI_Impl_Init
- *
- *  Purpose: Local helper routine, not part of OSAL API.
- *
- *-----------------------------------------------------------------*/
-int32 OS_FreeRTOS_MutexAPI_Impl_Init(void)
-{
-    memset(OS_impl_mut_sem_table, 0, sizeof(OS_impl_mut_sem_table));
+	if(xTaskGetCurrentTaskHandle() != OS_impl_task_table[task_id].id)
+	{
+	   return OS_FREERTOS_API_EXIT(TaskMatch, OS_ERROR);
+	}
 
-    return OS_SUCCESS;
-} /* end OS_FreeRTOS_MutexAPI_Impl_Init */
+   return OS_FREERTOS_API_EXIT(TaskMatch, OS_SUCCESS);
+}/* end OS_TaskMatch_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_MutSemCreate_Impl
+ * Function: OS_TaskDelete_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_MutSemCreate_Impl(uint32 sem_id, uint32 options)
+int32 OS_TaskDelete_Impl(uint32 task_id)
 {
+	OS_FREERTOS_API_ENTER(TaskDelete);
+
 	/*
-	 ** Try to create the mutex
-	 */
-	OS_impl_mut_sem_table[sem_id].id = xSemaphoreCreateRecursiveMutex();
-	if(OS_impl_mut_sem_table[sem_id].id == NULL)
+	** Try to delete the task
+	** If this fails, not much recourse - the only potential cause of failure
+	** to cancel here is that the thread ID is invalid because it already exited itself,
+	** and if that is true there is nothing wrong - everything is OK to continue normally.
+	*/
+#ifdef OS_FREERTOS_STACK_MONITOR
+	OS_FreeRTOS_StackRelease(OS_impl_task_table[task_id].id);
+#endif
+
+#ifdef OS_FREERTOS_TASK_RECYCLE
+	/* A deleted task may have been stopped anywhere, so it is never parked */
+	if(OS_impl_task_table[task_id].recycle_slot >= 0)
 	{
-		return OS_SEM_FAILURE;
+		OS_impl_task_recycle[OS_impl_task_table[task_id].recycle_slot].in_use = false;
+		OS_impl_task_table[task_id].recycle_slot = -1;
 	}
+#endif
 
-	return OS_SUCCESS;
-}/* end OS_MutSemCreate_Impl */
+#ifdef OS_FREERTOS_STATIC_TASKS
+	if(OS_impl_task_table[task_id].static_slot >= 0)
+	{
+		if(OS_impl_task_table[task_id].id == xTaskGetCurrentTaskHandle())
+		{
+			xTimerPendFunctionCall(OS_FreeRTOS_TaskReap, OS_impl_task_table[task_id].id,
+					OS_impl_task_table[task_id].static_slot, portMAX_DELAY);
+			vTaskSuspend(NULL);
+		}
 
-/*----------------------------------------------------------------
- *
- * Function: OS_MutSemDelete_Impl
- *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
- *
- *-----------------------------------------------------------------*/
-int32 OS_MutSemDelete_Impl(uint32 sem_id)
-{
-	vSemaphoreDelete(OS_impl_mut_sem_table[sem_id].id);
-	OS_impl_mut_sem_table[sem_id].id = (SemaphoreHandle_t)0xFFFF;
+		OS_FreeRTOS_SocketSetRelease(OS_impl_task_table[task_id].id);
+		OS_FreeRTOS_SemWaitRelease(OS_impl_task_table[task_id].id);
+		vTaskDelete(OS_impl_task_table[task_id].id);
+		OS_impl_task_pool[OS_impl_task_table[task_id].static_slot].in_use = false;
+		OS_impl_task_table[task_id].static_slot = -1;
+		OS_impl_task_table[task_id].id = (TaskHandle_t)0xFFFF;
 
-    return OS_SUCCESS;
-}/* end OS_MutSemDelete_Impl */
+		return OS_FREERTOS_API_EXIT(TaskDelete, OS_SUCCESS);
+	}
+#endif
+
+	OS_FreeRTOS_SocketSetRelease(OS_impl_task_table[task_id].id);
+	OS_FreeRTOS_SemWaitRelease(OS_impl_task_table[task_id].id);
+#ifdef OS_FREERTOS_TASK_RECYCLE
+	if(OS_impl_task_table[task_id].id == xTaskGetCurrentTaskHandle())
+	{
+		/* Free the stack now rather than whenever the idle task runs, see OS_FreeRTOS_TaskReap */
+		xTimerPendFunctionCall(OS_FreeRTOS_TaskReap, OS_impl_task_table[task_id].id, OS_MAX_TASKS, portMAX_DELAY);
+		vTaskSuspend(NULL);
+	}
+#endif
+	vTaskDelete(OS_impl_task_table[task_id].id);
+	OS_impl_task_table[task_id].id = (TaskHandle_t)0xFFFF;
+
+	return OS_FREERTOS_API_EXIT(TaskDelete, OS_SUCCESS);
+}/* end OS_TaskDelete_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_MutSemGive_Impl
+ * Function: OS_TaskExit_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_MutSemGive_Impl(uint32 sem_id)
+void OS_TaskExit_Impl(void)
 {
-	/* Give the mutex */
-	if(xSemaphoreGiveRecursive(OS_impl_mut_sem_table[sem_id].id) != pdTRUE)
+#if defined(OS_FREERTOS_STATIC_TASKS) || defined(OS_FREERTOS_TASK_RECYCLE)
+	TaskHandle_t self = xTaskGetCurrentTaskHandle();
+	uint32 task_id;
+#endif
+
+	OS_FreeRTOS_SocketSetRelease(xTaskGetCurrentTaskHandle());
+#ifdef OS_FREERTOS_STACK_MONITOR
+	OS_FreeRTOS_StackRelease(xTaskGetCurrentTaskHandle());
+#endif
+
+#ifdef OS_FREERTOS_TASK_RECYCLE
+	/* Only returns if the task could not be parked */
+	for(task_id = 0; task_id < OS_MAX_TASKS; task_id++)
 	{
-		return OS_SEM_FAILURE;
+		if(OS_impl_task_table[task_id].id == self && OS_impl_task_table[task_id].recycle_slot >= 0)
+		{
+			OS_FreeRTOS_TaskPark(task_id);
+		}
 	}
-	else
+#endif
+
+#ifdef OS_FREERTOS_STATIC_TASKS
+
+	/*
+	 * The shared layer has already released the OSAL id, so find the slot
+	 * by handle.  Hand the deletion over to the timer service task, see
+	 * OS_FreeRTOS_TaskReap, and wait there to be deleted.
+	 */
+	for(task_id = 0; task_id < OS_MAX_TASKS; task_id++)
 	{
-		return OS_SUCCESS;
+		if(OS_impl_task_table[task_id].id == self && OS_impl_task_table[task_id].static_slot >= 0)
+		{
+			xTimerPendFunctionCall(OS_FreeRTOS_TaskReap, self,
+					OS_impl_task_table[task_id].static_slot, portMAX_DELAY);
+			OS_impl_task_table[task_id].static_slot = -1;
+			vTaskSuspend(NULL);
+		}
 	}
-}/* end OS_MutSemGive_Impl */
+#endif
+
+#ifdef OS_FREERTOS_TASK_RECYCLE
+	/* Free the stack now rather than whenever the idle task runs, see OS_FreeRTOS_TaskReap */
+	xTimerPendFunctionCall(OS_FreeRTOS_TaskReap, self, OS_MAX_TASKS, portMAX_DELAY);
+	vTaskSuspend(NULL);
+#endif
+
+	vTaskDelete(xTaskGetCurrentTaskHandle());
+}/*end OS_TaskExit_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_MutSemTake_Impl
+ * Function: OS_TaskDelay_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_MutSemTake_Impl(uint32 sem_id)
+int32 OS_TaskDelay_Impl(uint32 milli_second)
 {
-	if(xSemaphoreTakeRecursive(OS_impl_mut_sem_table[sem_id].id, portMAX_DELAY) != pdTRUE)
-	{
-		return OS_SEM_FAILURE;
-	}
-	else
-	{
-		return OS_SUCCESS;
-	}
-}/* end OS_MutSemTake_Impl */
+	TickType_t ticks;
+
+	OS_FREERTOS_API_ENTER(TaskDelay);
+
+	ticks = OS_Milli2Ticks(milli_second);
+	vTaskDelay(ticks);
+
+	return OS_FREERTOS_API_EXIT(TaskDelay, OS_SUCCESS);
+}/* end OS_TaskDelay_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_MutSemGetInfo_Impl
+ * Function: OS_TaskSetPriority_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_MutSemGetInfo_Impl(uint32 sem_id, OS_mut_sem_prop_t *mut_prop)
+int32 OS_TaskSetPriority_Impl(uint32 task_id, uint32 new_priority)
 {
-	return OS_SUCCESS;
-} /* end OS_MutSemGetInfo_Impl */
+	OS_FREERTOS_API_ENTER(TaskSetPriority);
 
-/****************************************************************************************
- INT API
- ****************************************************************************************/
+	/* Because all of cFS and OSAL have been written with the assumption that
+	 * priorities range from 0 (highest priority) to 255 (lowest priority)
+	 * Let's normalize that range into FreeRTOS priorities
+	 */
+	OS_impl_task_table[task_id].freertos_priority = OS_FreeRTOS_PriorityMap[new_priority & 0xFF];
+
+	/* Set Task Priority */
+	vTaskPrioritySet(OS_impl_task_table[task_id].id, OS_impl_task_table[task_id].freertos_priority);
+
+	return OS_FREERTOS_API_EXIT(TaskSetPriority, OS_SUCCESS);
+}/* end OS_TaskSetPriority_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_IntAttachHandler_Impl
+ * Function: OS_TaskRegister_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_IntAttachHandler_Impl(uint32 InterruptNumber, osal_task_entry InterruptHandler, int32 parameter)
+int32 OS_TaskRegister_Impl(uint32 global_task_id)
 {
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_ERR_NOT_IMPLEMENTED;
-}/* end OS_IntAttachHandler_Impl */
+	TaskHandle_t currentTask = xTaskGetCurrentTaskHandle();
+
+	OS_FREERTOS_API_ENTER(TaskRegister);
+
+	if(currentTask != NULL)
+	{
+		vTaskSetThreadLocalStoragePointer(currentTask,//current task handle
+										  0,//index
+										  (void *)global_task_id);//value to store
+		return OS_FREERTOS_API_EXIT(TaskRegister, OS_SUCCESS);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(TaskRegister, OS_ERROR);
+	}
+}/* end OS_TaskRegister_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_IntUnlock_Impl
+ * Function: OS_TaskGetId_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_IntUnlock_Impl(int32 IntLevel)
+uint32 OS_TaskGetId_Impl(void)
 {
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_SUCCESS;
-}/* end OS_IntUnlock_Impl */
+	TaskHandle_t currentTask= xTaskGetCurrentTaskHandle();
+
+	if(currentTask != NULL)
+	{
+		uint32 task_id;
+		task_id = (uint32) pvTaskGetThreadLocalStoragePointer(currentTask, 0);
+		return task_id;
+	}
+	else
+	{
+		return OS_ERR_NAME_NOT_FOUND;
+	}
+}/* end OS_TaskGetId_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_IntLock_Impl
+ * Function: OS_TaskGetInfo_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_IntLock_Impl(void)
+int32 OS_TaskGetInfo_Impl(uint32 task_id, OS_task_prop_t *task_prop)
 {
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_SUCCESS;
-}/* end OS_IntLock_Impl */
+	OS_FREERTOS_API_ENTER(TaskGetInfo);
+
+	task_prop->OStask_id = (uint32) OS_impl_task_table[task_id].id;
+
+	return OS_FREERTOS_API_EXIT(TaskGetInfo, OS_SUCCESS);
+} /* end OS_TaskGetInfo_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_IntEnable_Impl
+ * Function: OS_TaskGetStats_Impl
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_IntEnable_Impl(int32 Level)
+int32 OS_TaskGetStats_Impl(uint32 task_id, OS_task_stats_t *task_stats)
 {
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_SUCCESS;
-}/* end OS_IntEnable_Impl */
+	OS_impl_task_internal_record_t *local = &OS_impl_task_table[task_id];
+	TaskStatus_t status;
+	uint32 now;
+	uint32 elapsed;
+	uint64 window_run;
+
+	OS_FREERTOS_API_ENTER(TaskGetStats);
+
+	if(local->id == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(TaskGetStats, OS_ERR_INCORRECT_OBJ_STATE);
+	}
+
+	/* Walks the stack for the high-water mark, so keep it out of the critical section */
+	vTaskGetInfo(local->id, &status, pdTRUE, eInvalid);
+	now = ulGetRunTimeCounterValue();
+
+	taskENTER_CRITICAL();
+
+	/* Unsigned difference copes with one wrap of the raw counter between polls */
+	local->run_time += (uint32)(status.ulRunTimeCounter - local->run_time_seen);
+	local->run_time_seen = status.ulRunTimeCounter;
+
+	elapsed = now - local->window_start;
+	window_run = local->run_time - local->window_run_time;
+	if(elapsed >= OS_FREERTOS_CPU_WINDOW_MSEC * 100)
+	{
+		local->cpu_usage = (uint32)((window_run * 10000) / elapsed);
+		local->window_len = elapsed;
+		local->window_start = now;
+		local->window_run_time = local->run_time;
+	}
+
+	task_stats->run_time_usec = local->run_time * 10;
+	if(local->window_len != 0)
+	{
+		task_stats->cpu_usage = local->cpu_usage;
+		task_stats->window_usec = OS_FreeRTOS_CountsToUsec(local->window_len);
+	}
+	else if(elapsed != 0)
+	{
+		task_stats->cpu_usage = (uint32)((window_run * 10000) / elapsed);
+		task_stats->window_usec = OS_FreeRTOS_CountsToUsec(elapsed);
+	}
+
+	task_stats->period_usec = (uint32)(((uint64) local->period * 1000000) / configTICK_RATE_HZ);
+	task_stats->release_count = local->release_count;
+	task_stats->overrun_count = local->overrun_count;
+	task_stats->max_lateness_usec = (uint32)(((uint64) local->max_lateness * 1000000) / configTICK_RATE_HZ);
+
+	taskEXIT_CRITICAL();
+
+	if(task_stats->cpu_usage > 10000)
+	{
+		task_stats->cpu_usage = 10000;
+	}
+
+#ifdef OS_FREERTOS_STATIC_TASKS
+	if(local->static_slot >= 0)
+	{
+		task_stats->stack_size = OS_TASK_STATIC_STACK_SIZE * sizeof(StackType_t);
+	}
+	else
+#endif
+	{
+		task_stats->stack_size = OS_task_table[task_id].stack_size * sizeof(StackType_t);
+	}
+	task_stats->stack_free_min = (uint32)status.usStackHighWaterMark * sizeof(StackType_t);
+	task_stats->freertos_priority = status.uxCurrentPriority;
+
+#ifdef OS_FREERTOS_STACK_MONITOR
+	vTaskSuspendAll();
+	OS_FreeRTOS_StackScan(local);
+	if(local->stack_paint != NULL)
+	{
+		task_stats->stack_used_peak = local->stack_used_peak;
+		task_stats->stack_overflow = (local->stack_used_peak >= local->stack_paint_words * sizeof(uint32));
+	}
+	xTaskResumeAll();
+#endif
+
+	return OS_FREERTOS_API_EXIT(TaskGetStats, OS_SUCCESS);
+} /* end OS_TaskGetStats_Impl */
+
+/****************************************************************************************
+ TASK EXTENSION API
+ ****************************************************************************************/
 
 /*----------------------------------------------------------------
  *
- * Function: OS_IntDisable_Impl
+ * Function: OS_TaskGetStats
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_IntDisable_Impl(int32 Level)
+int32 OS_TaskGetStats(uint32 task_id, OS_task_stats_t *task_stats)
 {
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_SUCCESS;
-}/* end OS_IntDisable_Impl */
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(task_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(task_stats, 0, sizeof(OS_task_stats_t));
+
+	/* Only reads the table, so a shared hold is enough */
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_TASK);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_TASK, task_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_TaskGetStats_Impl(local_id, task_stats);
+	}
+
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_TASK);
+
+	return return_code;
+} /* end OS_TaskGetStats */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_HeapGetInfo_Impl
+ * Function: OS_TaskPeriod_Self
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns the record of the calling task, or NULL if it is
+ *           not an OSAL task
  *
  *-----------------------------------------------------------------*/
-int32 OS_HeapGetInfo_Impl(OS_heap_prop_t *heap_prop)
+static OS_impl_task_internal_record_t *OS_TaskPeriod_Self(void)
 {
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_ERR_NOT_IMPLEMENTED;
-}/* end OS_HeapGetInfo_Impl */
+	uint32 local_id;
+
+	/* The calling task cannot be deleted under itself, so no lock is needed */
+	if(OS_ObjectIdToArrayIndex(OS_OBJECT_TYPE_OS_TASK, OS_TaskGetId_Impl(), &local_id) != OS_SUCCESS ||
+			OS_impl_task_table[local_id].id != xTaskGetCurrentTaskHandle())
+	{
+		return NULL;
+	}
+
+	return &OS_impl_task_table[local_id];
+} /* end OS_TaskPeriod_Self */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_IntSetMask_Impl
+ * Function: OS_TaskPeriodSet
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_IntSetMask_Impl(uint32 MaskSetting)
+int32 OS_TaskPeriodSet(uint32 period_msec)
 {
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_ERR_NOT_IMPLEMENTED;
-} /* end OS_IntSetMask_Impl */
+	OS_impl_task_internal_record_t *local = OS_TaskPeriod_Self();
+	TickType_t period;
+
+	if(local == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	period = 0;
+	if(period_msec != 0)
+	{
+		period = OS_Milli2Ticks(period_msec);
+		if(period == 0)
+		{
+			period = 1;
+		}
+	}
+
+	taskENTER_CRITICAL();
+	local->period = period;
+	local->last_release = xTaskGetTickCount();
+	local->release_count = 0;
+	local->overrun_count = 0;
+	local->max_lateness = 0;
+	taskEXIT_CRITICAL();
+
+	return OS_SUCCESS;
+} /* end OS_TaskPeriodSet */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_IntGetMask_Impl
+ * Function: OS_TaskPeriodWait
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_IntGetMask_Impl(uint32 * MaskSettingPtr)
+int32 OS_TaskPeriodWait(uint32 *missed)
 {
-    *MaskSettingPtr = 0;
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_ERR_NOT_IMPLEMENTED;
-} /* end OS_IntGetMask_Impl */
+	OS_impl_task_internal_record_t *local = OS_TaskPeriod_Self();
+	TickType_t elapsed;
+	TickType_t skipped;
+
+	if(missed != NULL)
+	{
+		*missed = 0;
+	}
+
+	if(local == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	if(local->period == 0)
+	{
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	/*
+	 ** A release that has already passed is not caught up with.  The task
+	 ** goes on from the latest release that has passed, counted as overruns,
+	 ** so it keeps its phase instead of running several cycles back to back.
+	 */
+	elapsed = xTaskGetTickCount() - local->last_release;
+	if(elapsed > local->period)
+	{
+		skipped = (elapsed - 1) / local->period;
+
+		taskENTER_CRITICAL();
+		local->overrun_count += skipped;
+		if(elapsed - local->period > local->max_lateness)
+		{
+			local->max_lateness = elapsed - local->period;
+		}
+		taskEXIT_CRITICAL();
+
+		local->last_release += skipped * local->period;
+		if(missed != NULL)
+		{
+			*missed = skipped;
+		}
+
+		OS_FreeRTOS_OverrunReport(OS_TaskGetId_Impl(),
+				(uint32)(((uint64) elapsed * 1000000) / configTICK_RATE_HZ),
+				(uint32)(((uint64) local->period * 1000000) / configTICK_RATE_HZ));
+	}
+
+	/* Relative to the previous release, so the time the work took does not add up */
+	vTaskDelayUntil(&local->last_release, local->period);
+
+	taskENTER_CRITICAL();
+	++local->release_count;
+	taskEXIT_CRITICAL();
+
+	return OS_SUCCESS;
+} /* end OS_TaskPeriodWait */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FPUExcAttachHandler_Impl
+ * Function: OS_TaskProfileSnapshot
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_FPUExcAttachHandler_Impl(uint32 ExceptionNumber, void * ExceptionHandler, int32 parameter)
+int32 OS_TaskProfileSnapshot(OS_task_profile_t *records, uint32 max_records, uint32 *count, uint32 *elapsed_usec)
 {
-    /*
-    ** Not implemented in FreeRTOS.
-    */
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_ERR_NOT_IMPLEMENTED;
-} /* end OS_FPUExcAttachHandler_Impl */
+	UBaseType_t ntasks;
+	uint32 total_time;
+	uint32 i;
+	uint32 j;
+	int32 return_code;
+
+	if(records == NULL || count == NULL || elapsed_usec == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*count = 0;
+	*elapsed_usec = 0;
+
+	/* One exclusive hold covers the working storage and the previous snapshot */
+	return_code = OS_Lock_Global_Impl(OS_OBJECT_TYPE_OS_TASK);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	/*
+	 * The thread local pointers are read before the scheduler resumes, so no
+	 * task in the snapshot can be freed by the idle task in the meantime.
+	 */
+	vTaskSuspendAll();
+	ntasks = uxTaskGetSystemState(OS_impl_profile_status, OS_FREERTOS_PROFILE_MAX_TASKS, &total_time);
+	for(i = 0; i < ntasks && i < max_records; i++)
+	{
+		records[i].task_id = (uint32) pvTaskGetThreadLocalStoragePointer(OS_impl_profile_status[i].xHandle, 0);
+	}
+	xTaskResumeAll();
+
+	if(ntasks == 0)
+	{
+		OS_Unlock_Global_Impl(OS_OBJECT_TYPE_OS_TASK);
+		OS_DEBUG("OS_TaskProfileSnapshot: more than %d tasks\n", OS_FREERTOS_PROFILE_MAX_TASKS);
+		return OS_ERROR;
+	}
+
+	for(i = 0; i < ntasks && i < max_records; i++)
+	{
+		uint32 run_time = OS_impl_profile_status[i].ulRunTimeCounter;
+
+		/* The kernel reports tasks in list order, which rarely changes, so start the search at i */
+		for(j = 0; j < OS_impl_profile_prev_count; j++)
+		{
+			OS_impl_task_profile_prev_t *prev = &OS_impl_profile_prev[(i + j) % OS_impl_profile_prev_count];
+
+			if(prev->task_number == OS_impl_profile_status[i].xTaskNumber)
+			{
+				run_time -= prev->run_time;
+				break;
+			}
+		}
+
+		records[i].task_number = OS_impl_profile_status[i].xTaskNumber;
+		records[i].cpu_delta_usec = OS_FreeRTOS_CountsToUsec(run_time);
+		records[i].stack_free_min = OS_impl_profile_status[i].usStackHighWaterMark;
+		records[i].priority = (uint8) OS_impl_profile_status[i].uxCurrentPriority;
+		records[i].state = (uint8) OS_impl_profile_status[i].eCurrentState;
+	}
+	*count = i;
+
+	*elapsed_usec = OS_FreeRTOS_CountsToUsec((uint32)(total_time - OS_impl_profile_prev_time));
+	OS_impl_profile_prev_time = total_time;
+	for(i = 0; i < ntasks; i++)
+	{
+		OS_impl_profile_prev[i].task_number = OS_impl_profile_status[i].xTaskNumber;
+		OS_impl_profile_prev[i].run_time = OS_impl_profile_status[i].ulRunTimeCounter;
+	}
+	OS_impl_profile_prev_count = ntasks;
+
+	OS_Unlock_Global_Impl(OS_OBJECT_TYPE_OS_TASK);
+
+	return OS_SUCCESS;
+} /* end OS_TaskProfileSnapshot */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FPUExcEnable_Impl
+ * Function: OS_FreeRTOS_CpuLoadUpdate
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Closes the CPU load window if it has run its length
  *
  *-----------------------------------------------------------------*/
-int32 OS_FPUExcEnable_Impl(int32 ExceptionNumber)
+static void OS_FreeRTOS_CpuLoadUpdate(void)
 {
-    /*
-    ** Not implemented in FreeRTOS.
-    */
-    return OS_SUCCESS;
-} /* end OS_FPUExcEnable_Impl */
+	OS_impl_cpu_load_t *meter = &OS_impl_cpu_load;
+	TaskStatus_t status;
+	uint32 now;
+	uint32 elapsed;
+	uint32 idle;
+
+	now = ulGetRunTimeCounterValue();
+	if(now - meter->window_start < OS_FREERTOS_CPU_LOAD_WINDOW_MSEC * 100)
+	{
+		return;
+	}
+
+	/* Known state and no stack walk, so this only copies the counters out of the TCB */
+	vTaskGetInfo(xTaskGetIdleTaskHandle(), &status, pdFALSE, eRunning);
+
+	taskENTER_CRITICAL();
+
+	/* The idle hook and a caller may both have seen the window end, only one closes it */
+	elapsed = now - meter->window_start;
+	if(elapsed >= OS_FREERTOS_CPU_LOAD_WINDOW_MSEC * 100)
+	{
+		idle = status.ulRunTimeCounter - meter->idle_start;
+		if(idle > elapsed)
+		{
+			idle = elapsed;
+		}
+
+		meter->load = (uint32)(((uint64)(elapsed - idle) * 10000) / elapsed);
+		meter->window_len = elapsed;
+		meter->history[meter->window_count % OS_FREERTOS_CPU_LOAD_PEAK_WINDOWS] = meter->load;
+		meter->window_count++;
+		meter->window_start = now;
+		meter->idle_start = status.ulRunTimeCounter;
+	}
+
+	taskEXIT_CRITICAL();
+} /* end OS_FreeRTOS_CpuLoadUpdate */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FPUExcDisable_Impl
+ * Function: OS_FreeRTOS_CpuLoadIdleHook
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Called on every pass of the kernel idle task, see vApplicationIdleHook
  *
  *-----------------------------------------------------------------*/
-int32 OS_FPUExcDisable_Impl(int32 ExceptionNumber)
+void OS_FreeRTOS_CpuLoadIdleHook(void)
 {
-    /*
-    ** Not implemented in FreeRTOS.
-    */
-    return OS_SUCCESS;
-} /* end OS_FPUExcDisable_Impl */
+	OS_FreeRTOS_CpuLoadUpdate();
+} /* end OS_FreeRTOS_CpuLoadIdleHook */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FPUExcSetMask_Impl
+ * Function: OS_CpuLoadGet
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_FPUExcSetMask_Impl(uint32 mask)
+int32 OS_CpuLoadGet(OS_cpu_load_t *cpu_load)
 {
-    /*
-    ** Not implemented in FreeRTOS.
-    */
-    return OS_SUCCESS;
-} /* end OS_FPUExcSetMask_Impl */
+	OS_impl_cpu_load_t *meter = &OS_impl_cpu_load;
+	uint32 windows;
+	uint32 i;
+
+	if(cpu_load == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	/* A fully loaded CPU never runs the idle hook, so the window is also closed here */
+	OS_FreeRTOS_CpuLoadUpdate();
+
+	memset(cpu_load, 0, sizeof(OS_cpu_load_t));
+
+	taskENTER_CRITICAL();
+
+	cpu_load->cpu_load = meter->load;
+	cpu_load->window_usec = OS_FreeRTOS_CountsToUsec(meter->window_len);
+	cpu_load->window_count = meter->window_count;
+
+	windows = (meter->window_count < OS_FREERTOS_CPU_LOAD_PEAK_WINDOWS) ?
+			meter->window_count : OS_FREERTOS_CPU_LOAD_PEAK_WINDOWS;
+	for(i = 0; i < windows; i++)
+	{
+		if(meter->history[i] > cpu_load->cpu_load_peak)
+		{
+			cpu_load->cpu_load_peak = meter->history[i];
+		}
+	}
+
+	taskEXIT_CRITICAL();
+
+	return OS_SUCCESS;
+} /* end OS_CpuLoadGet */
+
+/****************************************************************************************
+ MESSAGE QUEUE API
+ ****************************************************************************************/
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FPUExcGetMask_Impl
+ * Function: OS_FreeRTOS_QueueAPI_Impl_Init
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
  *
  *-----------------------------------------------------------------*/
-int32 OS_FPUExcGetMask_Impl(uint32 *mask)
+int32 OS_FreeRTOS_QueueAPI_Impl_Init(void)
 {
-    /*
-    ** Not implemented in FreeRTOS.
-    */
+    memset(OS_impl_queue_table, 0, sizeof(OS_impl_queue_table));
+
     return OS_SUCCESS;
-} /* end OS_FPUExcGetMask_Impl */
+} /* end OS_FreeRTOS_QueueAPI_Impl_Init */
 
-/****************************************************************************************
- CONSOLE OUTPUT
- ****************************************************************************************/
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_QueueTicks
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Converts an OSAL queue timeout (OS_PEND, OS_CHECK or msecs)
+ *           into a FreeRTOS block time.
+ *
+ *-----------------------------------------------------------------*/
+static TickType_t OS_FreeRTOS_QueueTicks(int32 timeout)
+{
+	if(timeout == OS_PEND)
+	{
+		return portMAX_DELAY;
+	}
+	else if(timeout == OS_CHECK)
+	{
+		return 0;
+	}
+
+	return OS_Milli2Ticks(timeout);
+} /* end OS_FreeRTOS_QueueTicks */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_ConsoleOutput_Impl
+ * Function: OS_FreeRTOS_QueuePoolCreate
  *
- *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Allocates the message buffer pool of a zero-copy queue and
+ *           fills the free list with every buffer in the pool.
  *
  *-----------------------------------------------------------------*/
-void  OS_ConsoleOutput_Impl(uint32 local_id)
+static int32 OS_FreeRTOS_QueuePoolCreate(uint32 queue_id, uint32 count)
 {
-    uint32 StartPos;
-    uint32 EndPos;
-    long WriteSize;
-    OS_console_internal_record_t *console;
-    int fd;
+	OS_impl_queue_internal_record_t *local = &OS_impl_queue_table[queue_id];
+	uint8 *buffer;
+	uint32 i;
 
-    console = &OS_console_table[local_id];
-    fd = OS_impl_console_table[local_id].out_fd;
-    StartPos = console->ReadPos;
-    EndPos = console->WritePos;
-    while(StartPos != EndPos)
-    {
-        if(StartPos > EndPos)
-        {
-            /* handle wrap */
-            WriteSize = console->BufSize - StartPos;
-        }
-        else
-        {
-            WriteSize = EndPos - StartPos;
-        }
+	/* Keep every buffer in the pool aligned like a heap allocation would be */
+	local->pool_stride = (OS_queue_table[queue_id].max_size + portBYTE_ALIGNMENT_MASK) & ~((uint32)portBYTE_ALIGNMENT_MASK);
+	if(local->pool_stride == 0)
+	{
+		local->pool_stride = portBYTE_ALIGNMENT;
+	}
 
-        WriteSize = write(fd, &console->BufBase[StartPos], WriteSize);
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	if(local->pool_stride * count > sizeof(OS_impl_queue_pool_storage[queue_id]))
+	{
+		return OS_QUEUE_INVALID_SIZE;
+	}
 
-        if(WriteSize <= 0)
-        {
-            /* write error */
-            /* This debug message _might_ go to the same console,
-             * but might not, so its worth a shot. */
-            OS_DEBUG("%s(): write(): %s\n", __func__, strerror(errno));
-            break;
-        }
+	local->pool_base = (uint8 *) OS_impl_queue_pool_storage[queue_id];
+	local->in_use = local->in_use_storage;
+	local->free_list = xQueueCreateStatic(count, sizeof(void *), (uint8_t *) local->free_list_storage, &local->free_list_cb);
+#else
+	/* The in-use flags follow the buffers in the same allocation */
+	local->pool_base = (uint8 *) pvPortMalloc(local->pool_stride * count + count);
+	if(local->pool_base == NULL)
+	{
+		return OS_ERROR;
+	}
+	local->in_use = &local->pool_base[local->pool_stride * count];
 
-        StartPos += WriteSize;
-        if(StartPos >= console->BufSize)
-        {
-            /* handle wrap */
-            StartPos = 0;
-        }
-    }
+	local->free_list = xQueueCreate(count, sizeof(void *));
+	if(local->free_list == NULL)
+	{
+		vPortFree(local->pool_base);
+		local->pool_base = NULL;
+		local->in_use = NULL;
+		return OS_ERROR;
+	}
+#endif
 
-    /* Update the global with the new read location */
-    console->ReadPos = StartPos;
-} /* end OS_ConsoleOutput_Impl */
+	local->pool_count = count;
+	for(i = 0; i < count; i++)
+	{
+		local->in_use[i] = 0;
+		buffer = &local->pool_base[i * local->pool_stride];
+		xQueueSend(local->free_list, &buffer, 0);
+	}
+
+	return OS_SUCCESS;
+} /* end OS_FreeRTOS_QueuePoolCreate */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_ConsoleWakeup_Impl
+ * Function: OS_FreeRTOS_QueuePoolDelete
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
  *
  *-----------------------------------------------------------------*/
-void  OS_ConsoleWakeup_Impl(uint32 local_id)
+static void OS_FreeRTOS_QueuePoolDelete(uint32 queue_id)
 {
-	OS_impl_console_internal_record_t *local = &OS_impl_console_table[local_id];
+	OS_impl_queue_internal_record_t *local = &OS_impl_queue_table[queue_id];
 
-	if(local->is_async)
+	if(local->free_list != NULL)
 	{
-		/* post the sem for the utility task to run */
-		xSemaphoreGive(local->data_sem);
+		vQueueDelete(local->free_list);
+		local->free_list = NULL;
 	}
-	else
+
+#ifndef OS_FREERTOS_STATIC_OBJECTS
+	if(local->pool_base != NULL)
 	{
-		/* output directly */
-		OS_ConsoleOutput_Impl(local_id);
+		vPortFree(local->pool_base);
 	}
-}/* end OS_ConsoleWakeup_Impl */
+#endif
+	local->pool_base = NULL;
+	local->in_use = NULL;
+
+	local->pool_count = 0;
+	local->pool_stride = 0;
+} /* end OS_FreeRTOS_QueuePoolDelete */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_ConsoleTask_Entry
+ * Function: OS_FreeRTOS_QueueBufferIndex
  *
  *  Purpose: Local helper routine, not part of OSAL API.
+ *           Finds the pool index of a message buffer.  Only pointers to
+ *           the start of one of this queue's buffers are accepted.
  *
  *-----------------------------------------------------------------*/
-static void OS_ConsoleTask_Entry(int arg)
+static int32 OS_FreeRTOS_QueueBufferIndex(const OS_impl_queue_internal_record_t *local, const void *buffer, uint32 *index)
 {
-    uint32 local_id = arg;
-	OS_impl_console_internal_record_t *local;
+	cpuaddr offset;
 
-	local = &OS_impl_console_table[local_id];
-	while(true)
+	if(local->pool_base == NULL || (const uint8 *)buffer < local->pool_base)
 	{
-		OS_ConsoleOutput_Impl(local_id);
-		xSemaphoreTake(local->data_sem, portMAX_DELAY);
+		return OS_ERR_BAD_ADDRESS;
 	}
-} /* end OS_ConsoleTask_Entry */
+
+	offset = (cpuaddr)((const uint8 *)buffer - local->pool_base);
+	if(offset >= (cpuaddr)local->pool_stride * local->pool_count || (offset % local->pool_stride) != 0)
+	{
+		return OS_ERR_BAD_ADDRESS;
+	}
+
+	*index = (uint32)(offset / local->pool_stride);
+
+	return OS_SUCCESS;
+} /* end OS_FreeRTOS_QueueBufferIndex */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_ConsoleCreate_Impl
+ * Function: OS_FreeRTOS_QueueBufferClaim
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Marks a buffer just taken from the free list as in use.
+ *           Only the taker can see the buffer, so no lock is needed.
  *
  *-----------------------------------------------------------------*/
-int32 OS_ConsoleCreate_Impl(uint32 local_id)
+static void OS_FreeRTOS_QueueBufferClaim(OS_impl_queue_internal_record_t *local, void *buffer)
 {
-	OS_impl_console_internal_record_t *local = &OS_impl_console_table[local_id];
-	TaskHandle_t consoletask;
-	int32 return_code = -1;
+	uint32 index;
 
-	if(local_id == 0)
+	if(OS_FreeRTOS_QueueBufferIndex(local, buffer, &index) == OS_SUCCESS)
 	{
-		return_code = OS_SUCCESS;
-		local->is_async = OS_CONSOLE_ASYNC;
-		local->out_fd = OSAL_CONSOLE_FILENO;
+		local->in_use[index] = 1;
+	}
+} /* end OS_FreeRTOS_QueueBufferClaim */
 
-		if(local->is_async)
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_QueueBufferTake
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes a message buffer from the queue's pool.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FreeRTOS_QueueBufferTake(OS_impl_queue_internal_record_t *local, void **buffer, int32 timeout)
+{
+	if(xQueueReceive(local->free_list, buffer, OS_FreeRTOS_QueueTicks(timeout)) != pdTRUE)
+	{
+		*buffer = NULL;
+
+		if(timeout == OS_CHECK)
 		{
-			local->data_sem = xSemaphoreCreateCounting(MAX_SEM_VALUE, 0);
+			return OS_QUEUE_FULL;
+		}
 
-			if(local->data_sem == NULL)
-			{
-				return_code = OS_SEM_FAILURE;
-			}
-			else
+		return OS_QUEUE_TIMEOUT;
+	}
+
+	OS_FreeRTOS_QueueBufferClaim(local, *buffer);
+
+	return OS_SUCCESS;
+} /* end OS_FreeRTOS_QueueBufferTake */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_QueueBufferGive
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns a message buffer to the queue's pool.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FreeRTOS_QueueBufferGive(OS_impl_queue_internal_record_t *local, void *buffer)
+{
+	uint32 index;
+	bool held;
+
+	if(OS_FreeRTOS_QueueBufferIndex(local, buffer, &index) != OS_SUCCESS)
+	{
+		return OS_ERR_BAD_ADDRESS;
+	}
+
+	/*
+	 ** Test and clear the in-use flag together, so of two releases of the
+	 ** same buffer only the first one puts it back on the free list.
+	 */
+	taskENTER_CRITICAL();
+	held = (local->in_use[index] != 0);
+	local->in_use[index] = 0;
+	taskEXIT_CRITICAL();
+
+	if(!held)
+	{
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	/* The free list has room for every buffer, so this cannot fail */
+	xQueueSend(local->free_list, &buffer, 0);
+
+	return OS_SUCCESS;
+} /* end OS_FreeRTOS_QueueBufferGive */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_QueueReceive
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Receives the next message descriptor from the queue.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FreeRTOS_QueueReceive(OS_impl_queue_internal_record_t *local, OS_impl_queue_msg_t *msg, int32 timeout)
+{
+	/*
+	 ** Pend forever (OS_PEND), do not wait at all (OS_CHECK) or wait for up
+	 ** to a specified amount of time for a message to arrive.
+	 */
+	if(xQueueReceive(local->id, msg, OS_FreeRTOS_QueueTicks(timeout)) == pdTRUE)
+	{
+		++local->get_count;
+		return OS_SUCCESS;
+	}
+
+	if(timeout == OS_PEND)
+	{
+		return OS_ERROR;
+	}
+	else if(timeout == OS_CHECK)
+	{
+		return OS_QUEUE_EMPTY;
+	}
+
+	++local->timeout_count;
+	return OS_QUEUE_TIMEOUT;
+} /* end OS_FreeRTOS_QueueReceive */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_QueueNoteSent
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Updates the statistics after a message has been queued.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_QueueNoteSent(OS_impl_queue_internal_record_t *local)
+{
+	UBaseType_t depth;
+
+	++local->put_count;
+
+	/*
+	 ** The depth may already have changed again by the time it is read,
+	 ** which is fine for a high-water mark.
+	 */
+	depth = uxQueueMessagesWaiting(local->id);
+	if(depth > local->peak_depth)
+	{
+		local->peak_depth = depth;
+	}
+} /* end OS_FreeRTOS_QueueNoteSent */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_QueueSend
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Copies a message into a pool buffer and queues it, waiting
+ *           up to the given OSAL timeout for room on the queue.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FreeRTOS_QueueSend(OS_impl_queue_internal_record_t *local, const void *data, uint32 size, int32 timeout)
+{
+	OS_impl_queue_msg_t msg;
+	TimeOut_t time_out;
+	TickType_t ticks;
+	int32 return_code;
+
+	ticks = OS_FreeRTOS_QueueTicks(timeout);
+	vTaskSetTimeOutState(&time_out);
+
+	/*
+	 ** Every buffer the queue has no slot for is a spare, so the pool only
+	 ** runs dry while the queue is full or more than the spares are held
+	 ** for the length of a memcpy by other Puts and Gets.  Either way
+	 ** OS_CHECK reports a full queue, and a timed Put waits for a buffer
+	 ** within its timeout like it waits for a slot.
+	 */
+	return_code = OS_FreeRTOS_QueueBufferTake(local, &msg.buffer, timeout);
+
+	/*
+	 ** Running out of pool buffers is the same as a full queue.
+	 */
+	if(return_code != OS_SUCCESS)
+	{
+		++local->full_count;
+		return return_code;
+	}
+
+	memcpy(msg.buffer, data, size);
+	msg.size = size;
+
+	/*
+	 ** Holding a buffer does not guarantee a free slot, so wait out
+	 ** whatever is left of the timeout for the slot as well.
+	 */
+	if(xTaskCheckForTimeOut(&time_out, &ticks) != pdFALSE)
+	{
+		ticks = 0;
+	}
+
+	if(xQueueSend(local->id, &msg, ticks) != pdTRUE)
+	{
+		OS_FreeRTOS_QueueBufferGive(local, msg.buffer);
+		++local->full_count;
+
+		if(timeout == OS_CHECK)
+		{
+			/*
+			 ** Queue is full.
+			 */
+			return OS_QUEUE_FULL;
+		}
+
+		return OS_QUEUE_TIMEOUT;
+	}
+
+	OS_FreeRTOS_QueueNoteSent(local);
+
+	return OS_SUCCESS;
+} /* end OS_FreeRTOS_QueueSend */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueCreate_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueCreate_Impl(uint32 queue_id, uint32 flags)
+{
+	OS_impl_queue_internal_record_t *local = &OS_impl_queue_table[queue_id];
+	uint32 pool_count;
+	uint32 heap_category;
+	int32 return_code;
+
+	OS_FREERTOS_API_ENTER(QueueCreate);
+
+	local->flags = flags;
+	local->full_count = 0;
+	local->put_count = 0;
+	local->get_count = 0;
+	local->timeout_count = 0;
+	local->peak_depth = 0;
+
+	/*
+	 ** The FreeRTOS queue only carries a {buffer, length} descriptor; the
+	 ** payload lives in the buffer pool.  This way only the bytes actually
+	 ** sent are copied, and the receiver learns the real message length.
+	 **
+	 ** Every queue gets a few buffers beyond its depth, so producers and
+	 ** consumers can hold buffers while the queue itself is full.  For a
+	 ** copy-mode queue this leaves the kernel send to decide whether the
+	 ** queue is full, rather than a consumer still copying out a message.
+	 */
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	local->id = xQueueCreateStatic(OS_queue_table[queue_id].max_depth, sizeof(OS_impl_queue_msg_t),
+	                               (uint8_t *) local->msg_storage, &local->queue_cb);
+#else
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_QUEUE);
+	local->id = xQueueCreate(OS_queue_table[queue_id].max_depth, sizeof(OS_impl_queue_msg_t));
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+#endif
+
+	/*
+	 ** If the operation failed, report the error
+	 */
+	if(local->id == NULL)
+	{
+		local->id = 0;
+		return OS_FREERTOS_API_EXIT(QueueCreate, OS_ERROR);
+	}
+
+	pool_count = OS_queue_table[queue_id].max_depth + OS_QUEUE_SPARE_BUFFERS;
+
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_QUEUE);
+	return_code = OS_FreeRTOS_QueuePoolCreate(queue_id, pool_count);
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+	if(return_code != OS_SUCCESS)
+	{
+		vQueueDelete(local->id);
+		local->id = 0;
+		return OS_FREERTOS_API_EXIT(QueueCreate, return_code);
+	}
+
+	return OS_FREERTOS_API_EXIT(QueueCreate, OS_SUCCESS);
+} /* end OS_QueueCreate_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueDelete_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueDelete_Impl(uint32 queue_id)
+{
+    OS_FREERTOS_API_ENTER(QueueDelete);
+
+    OS_FreeRTOS_WaitSetDetach(OS_OBJECT_TYPE_OS_QUEUE, queue_id);
+
+    /* Try to delete the queue */
+    vQueueDelete(OS_impl_queue_table[queue_id].id);
+    OS_impl_queue_table[queue_id].id = (SemaphoreHandle_t)0xFFFF;
+
+    /*
+     * Any buffer still held by a producer or consumer becomes invalid here,
+     * same as with any other use of a deleted queue.
+     */
+    OS_FreeRTOS_QueuePoolDelete(queue_id);
+    OS_impl_queue_table[queue_id].flags = 0;
+
+    return OS_FREERTOS_API_EXIT(QueueDelete, OS_SUCCESS);
+} /* end OS_QueueDelete_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueGet_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueGet_Impl(uint32 queue_id, void *data, uint32 size, uint32 *size_copied, int32 timeout)
+{
+	OS_impl_queue_internal_record_t *local;
+	OS_impl_queue_msg_t msg;
+	int32 return_code;
+
+	local = &OS_impl_queue_table[queue_id];
+
+	OS_FREERTOS_API_ENTER(QueueGet);
+
+	return_code = OS_FreeRTOS_QueueReceive(local, &msg, timeout);
+	if(return_code != OS_SUCCESS)
+	{
+		*size_copied = 0;
+		return OS_FREERTOS_API_EXIT(QueueGet, return_code);
+	}
+
+	/*
+	 ** The shared layer already made sure the caller's buffer can hold
+	 ** max_size bytes, so any message fits.
+	 */
+	memcpy(data, msg.buffer, msg.size);
+	*size_copied = msg.size;
+
+	OS_FreeRTOS_QueueBufferGive(local, msg.buffer);
+
+	return OS_FREERTOS_API_EXIT(QueueGet, OS_SUCCESS);
+}/* end OS_QueueGet_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueuePut_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueuePut_Impl(uint32 queue_id, const void *data, uint32 size, uint32 flags)
+{
+	OS_FREERTOS_API_ENTER(QueuePut);
+
+	return OS_FREERTOS_API_EXIT(QueuePut, OS_FreeRTOS_QueueSend(&OS_impl_queue_table[queue_id], data, size, OS_CHECK));
+}/* end OS_QueuePut_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueuePutTimed_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueuePutTimed_Impl(uint32 queue_id, const void *data, uint32 size, uint32 flags, int32 timeout)
+{
+	OS_FREERTOS_API_ENTER(QueuePutTimed);
+
+	return OS_FREERTOS_API_EXIT(QueuePutTimed, OS_FreeRTOS_QueueSend(&OS_impl_queue_table[queue_id], data, size, timeout));
+} /* end OS_QueuePutTimed_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueGetInfo_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueGetInfo_Impl(uint32 queue_id, OS_queue_prop_t *queue_prop)
+{
+    OS_FREERTOS_API_ENTER(QueueGetInfo);
+
+    /* The shared layer fills in everything OS_queue_prop_t has room for */
+    return OS_FREERTOS_API_EXIT(QueueGetInfo, OS_SUCCESS);
+} /* end OS_QueueGetInfo_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueGetStats_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueGetStats_Impl(uint32 queue_id, OS_queue_stats_t *queue_stats)
+{
+	OS_impl_queue_internal_record_t *local = &OS_impl_queue_table[queue_id];
+
+	OS_FREERTOS_API_ENTER(QueueGetStats);
+
+	queue_stats->depth         = uxQueueMessagesWaiting(local->id);
+	queue_stats->free_slots    = uxQueueSpacesAvailable(local->id);
+	queue_stats->max_depth     = OS_queue_table[queue_id].max_depth;
+	queue_stats->max_size      = OS_queue_table[queue_id].max_size;
+	queue_stats->peak_depth    = local->peak_depth;
+	queue_stats->put_count     = local->put_count;
+	queue_stats->get_count     = local->get_count;
+	queue_stats->full_count    = local->full_count;
+	queue_stats->timeout_count = local->timeout_count;
+
+	return OS_FREERTOS_API_EXIT(QueueGetStats, OS_SUCCESS);
+} /* end OS_QueueGetStats_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueBufferAlloc_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueBufferAlloc_Impl(uint32 queue_id, void **buffer, int32 timeout)
+{
+	OS_impl_queue_internal_record_t *local = &OS_impl_queue_table[queue_id];
+
+	OS_FREERTOS_API_ENTER(QueueBufferAlloc);
+
+	if((local->flags & OS_QUEUE_ZERO_COPY) == 0)
+	{
+		return OS_FREERTOS_API_EXIT(QueueBufferAlloc, OS_ERR_INCORRECT_OBJ_TYPE);
+	}
+
+	return OS_FREERTOS_API_EXIT(QueueBufferAlloc, OS_FreeRTOS_QueueBufferTake(local, buffer, timeout));
+} /* end OS_QueueBufferAlloc_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueuePutBuffer_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueuePutBuffer_Impl(uint32 queue_id, void *buffer, uint32 size, uint32 flags)
+{
+	OS_impl_queue_internal_record_t *local = &OS_impl_queue_table[queue_id];
+	OS_impl_queue_msg_t msg;
+	uint32 index;
+
+	OS_FREERTOS_API_ENTER(QueuePutBuffer);
+
+	if((local->flags & OS_QUEUE_ZERO_COPY) == 0)
+	{
+		return OS_FREERTOS_API_EXIT(QueuePutBuffer, OS_ERR_INCORRECT_OBJ_TYPE);
+	}
+
+	if(OS_FreeRTOS_QueueBufferIndex(local, buffer, &index) != OS_SUCCESS)
+	{
+		return OS_FREERTOS_API_EXIT(QueuePutBuffer, OS_ERR_BAD_ADDRESS);
+	}
+
+	/* A buffer still on the free list was released or never allocated */
+	if(local->in_use[index] == 0)
+	{
+		return OS_FREERTOS_API_EXIT(QueuePutBuffer, OS_ERR_INCORRECT_OBJ_STATE);
+	}
+
+	msg.buffer = buffer;
+	msg.size = size;
+
+	if(xQueueSend(local->id, &msg, 0) != pdTRUE)
+	{
+		++local->full_count;
+		return OS_FREERTOS_API_EXIT(QueuePutBuffer, OS_QUEUE_FULL);
+	}
+
+	OS_FreeRTOS_QueueNoteSent(local);
+
+	return OS_FREERTOS_API_EXIT(QueuePutBuffer, OS_SUCCESS);
+} /* end OS_QueuePutBuffer_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueGetBuffer_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueGetBuffer_Impl(uint32 queue_id, void **buffer, uint32 *size, int32 timeout)
+{
+	OS_impl_queue_internal_record_t *local = &OS_impl_queue_table[queue_id];
+	OS_impl_queue_msg_t msg;
+	int32 return_code;
+
+	if((local->flags & OS_QUEUE_ZERO_COPY) == 0)
+	{
+		return OS_ERR_INCORRECT_OBJ_TYPE;
+	}
+
+	OS_FREERTOS_API_ENTER(QueueGetBuffer);
+
+	return_code = OS_FreeRTOS_QueueReceive(local, &msg, timeout);
+	if(return_code != OS_SUCCESS)
+	{
+		*buffer = NULL;
+		*size = 0;
+		return OS_FREERTOS_API_EXIT(QueueGetBuffer, return_code);
+	}
+
+	*buffer = msg.buffer;
+	*size = msg.size;
+
+	return OS_FREERTOS_API_EXIT(QueueGetBuffer, OS_SUCCESS);
+} /* end OS_QueueGetBuffer_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueBufferRelease_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueBufferRelease_Impl(uint32 queue_id, void *buffer)
+{
+	OS_impl_queue_internal_record_t *local = &OS_impl_queue_table[queue_id];
+
+	OS_FREERTOS_API_ENTER(QueueBufferRelease);
+
+	if((local->flags & OS_QUEUE_ZERO_COPY) == 0)
+	{
+		return OS_FREERTOS_API_EXIT(QueueBufferRelease, OS_ERR_INCORRECT_OBJ_TYPE);
+	}
+
+	return OS_FREERTOS_API_EXIT(QueueBufferRelease, OS_FreeRTOS_QueueBufferGive(local, buffer));
+} /* end OS_QueueBufferRelease_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueuePutBatch_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueuePutBatch_Impl(uint32 queue_id, const void *data, uint32 size, uint32 count, uint32 *count_put, uint32 flags)
+{
+	OS_impl_queue_internal_record_t *local = &OS_impl_queue_table[queue_id];
+	const uint8 *src = (const uint8 *)data;
+	OS_impl_queue_msg_t msg;
+	uint32 i;
+
+	OS_FREERTOS_API_ENTER(QueuePutBatch);
+
+	/*
+	 ** Nothing blocks in here, so the scheduler can stay suspended for the
+	 ** whole batch.  Waking the consumer is deferred until the end instead
+	 ** of possibly switching to it after every message.
+	 */
+	vTaskSuspendAll();
+
+	for(i = 0; i < count; i++)
+	{
+		if(OS_FreeRTOS_QueueBufferTake(local, &msg.buffer, OS_CHECK) != OS_SUCCESS)
+		{
+			break;
+		}
+
+		memcpy(msg.buffer, src, size);
+		msg.size = size;
+
+		if(xQueueSend(local->id, &msg, 0) != pdTRUE)
+		{
+			OS_FreeRTOS_QueueBufferGive(local, msg.buffer);
+			break;
+		}
+
+		OS_FreeRTOS_QueueNoteSent(local);
+		src += size;
+	}
+
+	xTaskResumeAll();
+
+	*count_put = i;
+
+	if(i < count)
+	{
+		++local->full_count;
+		return OS_FREERTOS_API_EXIT(QueuePutBatch, OS_QUEUE_FULL);
+	}
+
+	return OS_FREERTOS_API_EXIT(QueuePutBatch, OS_SUCCESS);
+} /* end OS_QueuePutBatch_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueGetBatch_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueGetBatch_Impl(uint32 queue_id, void *data, uint32 size, uint32 *sizes, uint32 count, uint32 *count_copied, int32 timeout)
+{
+	OS_impl_queue_internal_record_t *local = &OS_impl_queue_table[queue_id];
+	uint8 *dest = (uint8 *)data;
+	OS_impl_queue_msg_t msg;
+	int32 return_code;
+	uint32 i;
+
+	OS_FREERTOS_API_ENTER(QueueGetBatch);
+
+	*count_copied = 0;
+
+	/*
+	 ** Only the first message is waited for.  Whatever else is already
+	 ** queued is drained afterwards without blocking.
+	 */
+	return_code = OS_FreeRTOS_QueueReceive(local, &msg, timeout);
+	if(return_code != OS_SUCCESS)
+	{
+		return OS_FREERTOS_API_EXIT(QueueGetBatch, return_code);
+	}
+
+	vTaskSuspendAll();
+
+	i = 0;
+	while(1)
+	{
+		memcpy(dest, msg.buffer, msg.size);
+		if(sizes != NULL)
+		{
+			sizes[i] = msg.size;
+		}
+
+		OS_FreeRTOS_QueueBufferGive(local, msg.buffer);
+
+		dest += size;
+		i++;
+
+		if(i >= count || xQueueReceive(local->id, &msg, 0) != pdTRUE)
+		{
+			break;
+		}
+
+		++local->get_count;
+	}
+
+	xTaskResumeAll();
+
+	*count_copied = i;
+
+	return OS_FREERTOS_API_EXIT(QueueGetBatch, OS_SUCCESS);
+} /* end OS_QueueGetBatch_Impl */
+
+/****************************************************************************************
+ MESSAGE QUEUE EXTENSION API
+ ****************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueBufferAlloc
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueBufferAlloc(uint32 queue_id, void **buffer, int32 timeout)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(buffer == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_QUEUE, queue_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_QueueBufferAlloc_Impl(local_id, buffer, timeout);
+	}
+
+	return return_code;
+} /* end OS_QueueBufferAlloc */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueuePutBuffer
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueuePutBuffer(uint32 queue_id, void *buffer, uint32 size, uint32 flags)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(buffer == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_QUEUE, queue_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		if(size > OS_queue_table[local_id].max_size)
+		{
+			return_code = OS_QUEUE_INVALID_SIZE;
+		}
+		else
+		{
+			return_code = OS_QueuePutBuffer_Impl(local_id, buffer, size, flags);
+		}
+	}
+
+	return return_code;
+} /* end OS_QueuePutBuffer */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueGetBuffer
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueGetBuffer(uint32 queue_id, void **buffer, uint32 *size, int32 timeout)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(buffer == NULL || size == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_QUEUE, queue_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_QueueGetBuffer_Impl(local_id, buffer, size, timeout);
+	}
+
+	return return_code;
+} /* end OS_QueueGetBuffer */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueBufferRelease
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueBufferRelease(uint32 queue_id, void *buffer)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(buffer == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_QUEUE, queue_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_QueueBufferRelease_Impl(local_id, buffer);
+	}
+
+	return return_code;
+} /* end OS_QueueBufferRelease */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueuePutTimed
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueuePutTimed(uint32 queue_id, const void *data, uint32 size, uint32 flags, int32 timeout)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(data == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_QUEUE, queue_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		if(size > OS_queue_table[local_id].max_size)
+		{
+			return_code = OS_QUEUE_INVALID_SIZE;
+		}
+		else
+		{
+			return_code = OS_QueuePutTimed_Impl(local_id, data, size, flags, timeout);
+		}
+	}
+
+	return return_code;
+} /* end OS_QueuePutTimed */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueGetStats
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueGetStats(uint32 queue_id, OS_queue_stats_t *queue_stats)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(queue_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(queue_stats, 0, sizeof(OS_queue_stats_t));
+
+	/* Only reads the table, so a shared hold is enough */
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_QUEUE);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_QUEUE, queue_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_QueueGetStats_Impl(local_id, queue_stats);
+	}
+
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_QUEUE);
+
+	return return_code;
+} /* end OS_QueueGetStats */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueuePutBatch
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueuePutBatch(uint32 queue_id, const void *data, uint32 size, uint32 count, uint32 *count_put, uint32 flags)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(data == NULL || count_put == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*count_put = 0;
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_QUEUE, queue_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		if(size > OS_queue_table[local_id].max_size)
+		{
+			return_code = OS_QUEUE_INVALID_SIZE;
+		}
+		else if(count > 0)
+		{
+			return_code = OS_QueuePutBatch_Impl(local_id, data, size, count, count_put, flags);
+		}
+	}
+
+	return return_code;
+} /* end OS_QueuePutBatch */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueueGetBatch
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueueGetBatch(uint32 queue_id, void *data, uint32 size, uint32 *sizes, uint32 count, uint32 *count_copied, int32 timeout)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(data == NULL || count_copied == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*count_copied = 0;
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_QUEUE, queue_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		/* Same rule as OS_QueueGet: every slot must be able to hold a full message */
+		if(size < OS_queue_table[local_id].max_size)
+		{
+			return_code = OS_QUEUE_INVALID_SIZE;
+		}
+		else if(count > 0)
+		{
+			return_code = OS_QueueGetBatch_Impl(local_id, data, size, sizes, count, count_copied, timeout);
+		}
+	}
+
+	return return_code;
+} /* end OS_QueueGetBatch */
+
+/****************************************************************************************
+ BINARY SEMAPHORE API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_BinSemAPI_Impl_Init
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FreeRTOS_BinSemAPI_Impl_Init(void)
+{
+    memset(OS_impl_bin_sem_table, 0, sizeof(OS_impl_bin_sem_table));
+
+    return OS_SUCCESS;
+} /* end OS_FreeRTOS_BinSemAPI_Impl_Init */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_SemStatsStart
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns the time stamp at which a take started to block.
+ *
+ *-----------------------------------------------------------------*/
+static unsigned long OS_FreeRTOS_SemStatsStart(void)
+{
+#ifdef OS_FREERTOS_SEM_STATS
+	return ulGetRunTimeCounterValue();
+#else
+	return 0;
+#endif
+} /* end OS_FreeRTOS_SemStatsStart */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_SemStatsTaken
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Accounts for a take that did not have to wait.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_SemStatsTaken(OS_impl_sem_stats_t *stats)
+{
+#ifdef OS_FREERTOS_SEM_STATS
+	++stats->take_count;
+#endif
+} /* end OS_FreeRTOS_SemStatsTaken */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_SemStatsBlocked
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Accounts for a take that had to wait, whether or not it
+ *           eventually got the semaphore.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_SemStatsBlocked(OS_impl_sem_stats_t *stats, unsigned long start, bool taken)
+{
+#ifdef OS_FREERTOS_SEM_STATS
+	unsigned long wait = ulGetRunTimeCounterValue() - start;
+
+	if(taken)
+	{
+		++stats->take_count;
+	}
+
+	++stats->blocked_count;
+	stats->total_wait += wait;
+	if(wait > stats->max_wait)
+	{
+		stats->max_wait = wait;
+	}
+#endif
+} /* end OS_FreeRTOS_SemStatsBlocked */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_SemStatsGet
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Converts the internal statistics to the public structure.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FreeRTOS_SemStatsGet(const OS_impl_sem_stats_t *stats, OS_sem_stats_t *sem_stats)
+{
+#ifdef OS_FREERTOS_SEM_STATS
+	/* The run time counter counts in 1/100ths of a millisecond */
+	sem_stats->take_count      = stats->take_count;
+	sem_stats->blocked_count   = stats->blocked_count;
+	sem_stats->total_wait_usec = stats->total_wait * 10;
+	sem_stats->max_wait_usec   = OS_FreeRTOS_CountsToUsec(stats->max_wait);
+
+	return OS_SUCCESS;
+#else
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_FreeRTOS_SemStatsGet */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_NotifySemWake
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Wakes a waiter that has just been released.  Called in a
+ *           critical section.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_NotifySemWake(OS_impl_sem_waiter_t *waiter)
+{
+#ifdef OS_FREERTOS_SEM_NOTIFY
+	xTaskNotifyGiveIndexed(waiter->task, OS_FREERTOS_NOTIFY_SEM_INDEX);
+#else
+	xSemaphoreGive(waiter->wake);
+#endif
+} /* end OS_FreeRTOS_NotifySemWake */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_NotifySemWait
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes a notification semaphore, blocking for up to "ticks".
+ *
+ *           A waiter queues a node on its own stack, ordered by priority,
+ *           then sleeps until woken.  Give and flush unlink the node, mark
+ *           it and wake the task, all in one critical section, so a waiter
+ *           that finds its node marked knows it has been released even if
+ *           it woke up for some other reason.  A waiter released by a
+ *           delete of the semaphore fails with OS_SEM_FAILURE.  A task
+ *           deleted while it waits has its node unlinked by
+ *           OS_FreeRTOS_SemWaitRelease.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FreeRTOS_NotifySemWait(OS_impl_notify_sem_t *local, TickType_t ticks, OS_impl_sem_stats_t *stats)
+{
+	OS_impl_sem_waiter_t self;
+	OS_impl_sem_waiter_t **prev;
+	TimeOut_t time_out;
+	unsigned long start;
+	int32 return_code;
+
+	vTaskSetTimeOutState(&time_out);
+
+	taskENTER_CRITICAL();
+	if(local->value != 0)
+	{
+		--local->value;
+		OS_FreeRTOS_SemStatsTaken(stats);
+		taskEXIT_CRITICAL();
+		return OS_SUCCESS;
+	}
+
+	if(ticks == 0)
+	{
+		taskEXIT_CRITICAL();
+		return OS_SEM_TIMEOUT;
+	}
+
+	self.task = xTaskGetCurrentTaskHandle();
+	self.priority = uxTaskPriorityGet(NULL);
+	self.released = false;
+	self.deleted = false;
+#ifndef OS_FREERTOS_SEM_NOTIFY
+	self.wake = xSemaphoreCreateBinaryStatic(&self.wake_cb);
+#endif
+
+	/* Highest priority first, FIFO within a priority, like a FreeRTOS event list */
+	prev = &local->waiters;
+	while(*prev != NULL && (*prev)->priority >= self.priority)
+	{
+		prev = &(*prev)->next;
+	}
+	self.next = *prev;
+	*prev = &self;
+	taskEXIT_CRITICAL();
+
+	start = OS_FreeRTOS_SemStatsStart();
+
+	while(1)
+	{
+#ifdef OS_FREERTOS_SEM_NOTIFY
+		ulTaskNotifyTakeIndexed(OS_FREERTOS_NOTIFY_SEM_INDEX, pdTRUE, ticks);
+#else
+		xSemaphoreTake(self.wake, ticks);
+#endif
+
+		taskENTER_CRITICAL();
+		if(self.released)
+		{
+			taskEXIT_CRITICAL();
+			return_code = self.deleted ? OS_SEM_FAILURE : OS_SUCCESS;
+			break;
+		}
+
+		if(xTaskCheckForTimeOut(&time_out, &ticks) != pdFALSE)
+		{
+			for(prev = &local->waiters; *prev != NULL; prev = &(*prev)->next)
+			{
+				if(*prev == &self)
+				{
+					*prev = self.next;
+					break;
+				}
+			}
+			taskEXIT_CRITICAL();
+			return_code = OS_SEM_TIMEOUT;
+			break;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+#ifdef OS_FREERTOS_SEM_NOTIFY
+	/* Drop the notification in case the last wakeup had another cause */
+	ulTaskNotifyTakeIndexed(OS_FREERTOS_NOTIFY_SEM_INDEX, pdTRUE, 0);
+#else
+	vSemaphoreDelete(self.wake);
+#endif
+
+	OS_FreeRTOS_SemStatsBlocked(stats, start, (return_code == OS_SUCCESS));
+	return return_code;
+} /* end OS_FreeRTOS_NotifySemWait */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_NotifySemGive
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Hands the semaphore straight to the first waiter, if any,
+ *           otherwise increments the value up to max_value.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FreeRTOS_NotifySemGive(OS_impl_notify_sem_t *local)
+{
+	OS_impl_sem_waiter_t *waiter;
+	int32 return_code = OS_SUCCESS;
+
+	taskENTER_CRITICAL();
+	waiter = local->waiters;
+	if(waiter != NULL)
+	{
+		local->waiters = waiter->next;
+		waiter->released = true;
+		OS_FreeRTOS_NotifySemWake(waiter);
+	}
+	else if(local->value < local->max_value)
+	{
+		++local->value;
+	}
+	else
+	{
+		return_code = OS_SEM_FAILURE;
+	}
+	taskEXIT_CRITICAL();
+
+	return return_code;
+} /* end OS_FreeRTOS_NotifySemGive */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_NotifySemFlush
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Releases every waiting task without changing the value.
+ *           With "deleted" set the waits fail instead of succeeding.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_NotifySemFlush(OS_impl_notify_sem_t *local, bool deleted)
+{
+	OS_impl_sem_waiter_t *waiter;
+
+	/*
+	 ** The context switches are held off until the critical section ends,
+	 ** so all the waiters become ready before any of them runs.
+	 */
+	taskENTER_CRITICAL();
+	waiter = local->waiters;
+	local->waiters = NULL;
+	while(waiter != NULL)
+	{
+		waiter->released = true;
+		waiter->deleted = deleted;
+		OS_FreeRTOS_NotifySemWake(waiter);
+		waiter = waiter->next;
+	}
+	taskEXIT_CRITICAL();
+} /* end OS_FreeRTOS_NotifySemFlush */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_NotifySemUnlink
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Removes the waiters of "task" from a semaphore.  Called in a
+ *           critical section.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_NotifySemUnlink(OS_impl_notify_sem_t *local, TaskHandle_t task)
+{
+	OS_impl_sem_waiter_t **prev = &local->waiters;
+
+	while(*prev != NULL)
+	{
+		if((*prev)->task == task)
+		{
+			*prev = (*prev)->next;
+		}
+		else
+		{
+			prev = &(*prev)->next;
+		}
+	}
+} /* end OS_FreeRTOS_NotifySemUnlink */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_SemWaitRelease
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Called before a task is deleted.  A waiter node lives on the
+ *           stack of its task, so one left queued would be freed with the
+ *           task and later woken through a stale handle.
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_SemWaitRelease(TaskHandle_t task)
+{
+	uint32 i;
+
+	taskENTER_CRITICAL();
+	for(i = 0; i < OS_MAX_BIN_SEMAPHORES; i++)
+	{
+		OS_FreeRTOS_NotifySemUnlink(&OS_impl_bin_sem_table[i].sem, task);
+	}
+	for(i = 0; i < OS_MAX_COUNT_SEMAPHORES; i++)
+	{
+		OS_FreeRTOS_NotifySemUnlink(&OS_impl_count_sem_table[i].notify, task);
+	}
+	taskEXIT_CRITICAL();
+} /* end OS_FreeRTOS_SemWaitRelease */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_WaitSetSignal
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Gives the proxy of a semaphore that is in a wait set, so a
+ *           task waiting on the set wakes.  A proxy already given stays
+ *           given, the wait looks at the semaphore itself.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_WaitSetSignal(OS_impl_sem_wait_link_t *wait)
+{
+	if(wait->wait_set != 0)
+	{
+		xSemaphoreGive(wait->proxy);
+	}
+} /* end OS_FreeRTOS_WaitSetSignal */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_BinSemCreate_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_BinSemCreate_Impl(uint32 sem_id, uint32 sem_initial_value, uint32 options)
+{
+	OS_FREERTOS_API_ENTER(BinSemCreate);
+
+	/* Check to make sure the sem value is going to be either 0 or 1 */
+	if(sem_initial_value > 1)
+	{
+		sem_initial_value = 1;
+	}
+
+	/*
+	 ** No kernel object is needed, the semaphore is just its value and the
+	 ** list of waiting tasks.
+	 */
+	OS_impl_bin_sem_table[sem_id].sem.value = sem_initial_value;
+	OS_impl_bin_sem_table[sem_id].sem.max_value = 1;
+	OS_impl_bin_sem_table[sem_id].sem.waiters = NULL;
+	memset(&OS_impl_bin_sem_table[sem_id].stats, 0, sizeof(OS_impl_sem_stats_t));
+
+	return OS_FREERTOS_API_EXIT(BinSemCreate, OS_SUCCESS);
+}/* end OS_BinSemCreate_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_BinSemDelete_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_BinSemDelete_Impl(uint32 sem_id)
+{
+	OS_FREERTOS_API_ENTER(BinSemDelete);
+
+	OS_FreeRTOS_WaitSetDetach(OS_OBJECT_TYPE_OS_BINSEM, sem_id);
+
+	/* Any task still waiting fails rather than being left blocked forever */
+	OS_FreeRTOS_NotifySemFlush(&OS_impl_bin_sem_table[sem_id].sem, true);
+	OS_impl_bin_sem_table[sem_id].sem.value = 0;
+
+	return OS_FREERTOS_API_EXIT(BinSemDelete, OS_SUCCESS);
+}/* end OS_BinSemDelete_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_BinSemGive_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_BinSemGive_Impl(uint32 sem_id)
+{
+	OS_FREERTOS_API_ENTER(BinSemGive);
+
+	/* Giving a binary semaphore that is already full is not an error */
+	OS_FreeRTOS_NotifySemGive(&OS_impl_bin_sem_table[sem_id].sem);
+	OS_FreeRTOS_WaitSetSignal(&OS_impl_bin_sem_table[sem_id].wait);
+
+	return OS_FREERTOS_API_EXIT(BinSemGive, OS_SUCCESS);
+}/* end OS_BinSemGive_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_BinSemFlush_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_BinSemFlush_Impl(uint32 sem_id)
+{
+	OS_FREERTOS_API_ENTER(BinSemFlush);
+
+	/* Release every waiting task in one go, without changing the value */
+	OS_FreeRTOS_NotifySemFlush(&OS_impl_bin_sem_table[sem_id].sem, false);
+
+	return OS_FREERTOS_API_EXIT(BinSemFlush, OS_SUCCESS);
+}/* end OS_BinSemFlush_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_BinSemTake_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_BinSemTake_Impl(uint32 sem_id)
+{
+	OS_FREERTOS_API_ENTER(BinSemTake);
+
+	if(OS_FreeRTOS_NotifySemWait(&OS_impl_bin_sem_table[sem_id].sem, portMAX_DELAY, &OS_impl_bin_sem_table[sem_id].stats) == OS_SUCCESS)
+	{
+		return OS_FREERTOS_API_EXIT(BinSemTake, OS_SUCCESS);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(BinSemTake, OS_SEM_FAILURE);
+	}
+}/* end OS_BinSemTake_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_BinSemTimedWait_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_BinSemTimedWait_Impl(uint32 sem_id, uint32 msecs)
+{
+	OS_FREERTOS_API_ENTER(BinSemTimedWait);
+
+	return OS_FREERTOS_API_EXIT(BinSemTimedWait,
+			OS_FreeRTOS_NotifySemWait(&OS_impl_bin_sem_table[sem_id].sem, OS_Milli2Ticks(msecs), &OS_impl_bin_sem_table[sem_id].stats));
+}/* end OS_BinSemTimedWait_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_BinSemGetInfo_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_BinSemGetInfo_Impl(uint32 sem_id, OS_bin_sem_prop_t *bin_prop)
+{
+	OS_FREERTOS_API_ENTER(BinSemGetInfo);
+
+	bin_prop->value = OS_impl_bin_sem_table[sem_id].sem.value;
+
+	return OS_FREERTOS_API_EXIT(BinSemGetInfo, OS_SUCCESS);
+} /* end OS_BinSemGetInfo_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_BinSemGetStats_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_BinSemGetStats_Impl(uint32 sem_id, OS_sem_stats_t *sem_stats)
+{
+	OS_FREERTOS_API_ENTER(BinSemGetStats);
+
+	return OS_FREERTOS_API_EXIT(BinSemGetStats, OS_FreeRTOS_SemStatsGet(&OS_impl_bin_sem_table[sem_id].stats, sem_stats));
+} /* end OS_BinSemGetStats_Impl */
+
+/****************************************************************************************
+ COUNTING SEMAPHORE API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_CountSemAPI_Impl_Init
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FreeRTOS_CountSemAPI_Impl_Init(void)
+{
+    memset(OS_impl_count_sem_table, 0, sizeof(OS_impl_count_sem_table));
+
+    return OS_SUCCESS;
+} /* end OS_FreeRTOS_CountSemAPI_Impl_Init */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_CountSemTake
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes a kernel counting semaphore, keeping the contention
+ *           statistics when they are enabled.
+ *
+ *-----------------------------------------------------------------*/
+static BaseType_t OS_FreeRTOS_CountSemTake(OS_impl_countsem_internal_record_t *local, TickType_t ticks)
+{
+#ifdef OS_FREERTOS_SEM_STATS
+	BaseType_t status;
+	unsigned long start;
+
+	/* Try without blocking first so only the takes that wait are timed */
+	if(xSemaphoreTake(local->id, 0) == pdTRUE)
+	{
+		OS_FreeRTOS_SemStatsTaken(&local->stats);
+		return pdTRUE;
+	}
+
+	if(ticks == 0)
+	{
+		return pdFALSE;
+	}
+
+	start = OS_FreeRTOS_SemStatsStart();
+	status = xSemaphoreTake(local->id, ticks);
+	OS_FreeRTOS_SemStatsBlocked(&local->stats, start, (status == pdTRUE));
+
+	return status;
+#else
+	return xSemaphoreTake(local->id, ticks);
+#endif
+} /* end OS_FreeRTOS_CountSemTake */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CountSemCreate_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_CountSemCreate_Impl(uint32 sem_id, uint32 sem_initial_value, uint32 options)
+{
+#ifndef OS_FREERTOS_STATIC_OBJECTS
+	uint32 heap_category;
+#endif
+
+	OS_FREERTOS_API_ENTER(CountSemCreate);
+
+	/*
+	 ** Verify that the semaphore maximum value is not too high
+	 */
+	if(sem_initial_value > MAX_SEM_VALUE)
+	{
+		return OS_FREERTOS_API_EXIT(CountSemCreate, OS_INVALID_SEM_VALUE);
+	}
+
+	memset(&OS_impl_count_sem_table[sem_id].stats, 0, sizeof(OS_impl_sem_stats_t));
+
+#ifdef OS_FREERTOS_SEM_NOTIFY
+	if(options & OS_SEM_TASK_NOTIFY)
+	{
+		OS_impl_count_sem_table[sem_id].id = NULL;
+		OS_impl_count_sem_table[sem_id].notify.value = sem_initial_value;
+		OS_impl_count_sem_table[sem_id].notify.max_value = MAX_SEM_VALUE;
+		OS_impl_count_sem_table[sem_id].notify.waiters = NULL;
+		return OS_FREERTOS_API_EXIT(CountSemCreate, OS_SUCCESS);
+	}
+#endif
+
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	OS_impl_count_sem_table[sem_id].id = xSemaphoreCreateCountingStatic(MAX_SEM_VALUE, sem_initial_value, &OS_impl_count_sem_table[sem_id].sem_cb);
+#else
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_SEMAPHORE);
+	OS_impl_count_sem_table[sem_id].id = xSemaphoreCreateCounting(MAX_SEM_VALUE, sem_initial_value);
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+#endif
+
+	/* check if Create failed */
+	if(OS_impl_count_sem_table[sem_id].id == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(CountSemCreate, OS_SEM_FAILURE);
+	}
+
+	return OS_FREERTOS_API_EXIT(CountSemCreate, OS_SUCCESS);
+}/* end OS_CountSemCreate_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CountSemDelete_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_CountSemDelete_Impl(uint32 sem_id)
+{
+	OS_FREERTOS_API_ENTER(CountSemDelete);
+
+	OS_FreeRTOS_WaitSetDetach(OS_OBJECT_TYPE_OS_COUNTSEM, sem_id);
+
+	if(OS_impl_count_sem_table[sem_id].id == NULL)
+	{
+		OS_FreeRTOS_NotifySemFlush(&OS_impl_count_sem_table[sem_id].notify, true);
+		return OS_FREERTOS_API_EXIT(CountSemDelete, OS_SUCCESS);
+	}
+
+	vSemaphoreDelete(OS_impl_count_sem_table[sem_id].id);
+	OS_impl_count_sem_table[sem_id].id = 0;
+
+	return OS_FREERTOS_API_EXIT(CountSemDelete, OS_SUCCESS);
+}/* end OS_CountSemDelete_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CountSemGive_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_CountSemGive_Impl(uint32 sem_id)
+{
+	int32 return_code = OS_SUCCESS;
+
+	OS_FREERTOS_API_ENTER(CountSemGive);
+
+	if(OS_impl_count_sem_table[sem_id].id == NULL)
+	{
+		return_code = OS_FreeRTOS_NotifySemGive(&OS_impl_count_sem_table[sem_id].notify);
+	}
+	else if(xSemaphoreGive(OS_impl_count_sem_table[sem_id].id) != pdTRUE)
+	{
+		return_code = OS_SEM_FAILURE;
+	}
+
+	if(return_code == OS_SUCCESS)
+	{
+		OS_FreeRTOS_WaitSetSignal(&OS_impl_count_sem_table[sem_id].wait);
+	}
+
+	return OS_FREERTOS_API_EXIT(CountSemGive, return_code);
+}/* end OS_CountSemGive_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CountSemTake_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_CountSemTake_Impl(uint32 sem_id)
+{
+	OS_FREERTOS_API_ENTER(CountSemTake);
+
+	if(OS_impl_count_sem_table[sem_id].id == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(CountSemTake,
+				OS_FreeRTOS_NotifySemWait(&OS_impl_count_sem_table[sem_id].notify, portMAX_DELAY, &OS_impl_count_sem_table[sem_id].stats));
+	}
+
+	if(OS_FreeRTOS_CountSemTake(&OS_impl_count_sem_table[sem_id], portMAX_DELAY) != pdTRUE)
+	{
+		return OS_FREERTOS_API_EXIT(CountSemTake, OS_SEM_FAILURE);
+	}
+
+	return OS_FREERTOS_API_EXIT(CountSemTake, OS_SUCCESS);
+}/* end OS_CountSemTake_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CountSemTimedWait_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_CountSemTimedWait_Impl(uint32 sem_id, uint32 msecs)
+{
+	BaseType_t status;
+	uint32 TimeInTicks;
+
+	TimeInTicks = OS_Milli2Ticks(msecs);
+
+	OS_FREERTOS_API_ENTER(CountSemTimedWait);
+
+	if(OS_impl_count_sem_table[sem_id].id == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(CountSemTimedWait,
+				OS_FreeRTOS_NotifySemWait(&OS_impl_count_sem_table[sem_id].notify, TimeInTicks, &OS_impl_count_sem_table[sem_id].stats));
+	}
+
+	status = OS_FreeRTOS_CountSemTake(&OS_impl_count_sem_table[sem_id], TimeInTicks);
+	switch(status)
+	{
+	case pdFALSE:
+		return OS_FREERTOS_API_EXIT(CountSemTimedWait, OS_SEM_TIMEOUT);
+		break;
+
+	case pdTRUE:
+		return OS_FREERTOS_API_EXIT(CountSemTimedWait, OS_SUCCESS);
+		break;
+
+	default:
+		return OS_FREERTOS_API_EXIT(CountSemTimedWait, OS_SEM_FAILURE);
+		break;
+	}
+}/* end OS_CountSemTimedWait_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CountSemGetInfo_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_CountSemGetInfo_Impl(uint32 sem_id, OS_count_sem_prop_t *count_prop)
+{
+	OS_FREERTOS_API_ENTER(CountSemGetInfo);
+
+	if(OS_impl_count_sem_table[sem_id].id == NULL)
+	{
+		count_prop->value = OS_impl_count_sem_table[sem_id].notify.value;
+	}
+	else
+	{
+		count_prop->value = uxSemaphoreGetCount(OS_impl_count_sem_table[sem_id].id);
+	}
+
+	return OS_FREERTOS_API_EXIT(CountSemGetInfo, OS_SUCCESS);
+} /* end OS_CountSemGetInfo_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CountSemGetStats_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_CountSemGetStats_Impl(uint32 sem_id, OS_sem_stats_t *sem_stats)
+{
+	OS_FREERTOS_API_ENTER(CountSemGetStats);
+
+	return OS_FREERTOS_API_EXIT(CountSemGetStats, OS_FreeRTOS_SemStatsGet(&OS_impl_count_sem_table[sem_id].stats, sem_stats));
+} /* end OS_CountSemGetStats_Impl */
+
+/****************************************************************************************
+ SEMAPHORE EXTENSION API
+ ****************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_BinSemGetStats
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_BinSemGetStats(uint32 sem_id, OS_sem_stats_t *sem_stats)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(sem_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(sem_stats, 0, sizeof(OS_sem_stats_t));
+
+	/* Only reads the table, so a shared hold is enough */
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_BINSEM);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_BINSEM, sem_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_BinSemGetStats_Impl(local_id, sem_stats);
+	}
+
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_BINSEM);
+
+	return return_code;
+} /* end OS_BinSemGetStats */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CountSemGetStats
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_CountSemGetStats(uint32 sem_id, OS_sem_stats_t *sem_stats)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(sem_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(sem_stats, 0, sizeof(OS_sem_stats_t));
+
+	/* Only reads the table, so a shared hold is enough */
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_COUNTSEM);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_COUNTSEM, sem_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_CountSemGetStats_Impl(local_id, sem_stats);
+	}
+
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_COUNTSEM);
+
+	return return_code;
+} /* end OS_CountSemGetStats */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MutSemTimedTake
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MutSemTimedTake(uint32 sem_id, uint32 msecs)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_MUTEX, sem_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_MutSemTimedTake_Impl(local_id, msecs);
+	}
+
+	return return_code;
+} /* end OS_MutSemTimedTake */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MutSemGetStats
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MutSemGetStats(uint32 sem_id, OS_mut_sem_stats_t *mut_stats)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(mut_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(mut_stats, 0, sizeof(OS_mut_sem_stats_t));
+
+	/* Only reads the table, so a shared hold is enough */
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_MUTEX);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_MUTEX, sem_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_MutSemGetStats_Impl(local_id, mut_stats);
+	}
+
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_MUTEX);
+
+	return return_code;
+} /* end OS_MutSemGetStats */
+
+/****************************************************************************************
+ WAIT SET EXTENSION API
+ ****************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_WaitSet_Get
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns the wait set of an id, or NULL if there is none
+ *
+ *-----------------------------------------------------------------*/
+static OS_impl_wait_set_t *OS_WaitSet_Get(uint32 set_id)
+{
+	if(set_id == 0 || set_id > OS_FREERTOS_MAX_WAIT_SETS || !OS_impl_wait_set_table[set_id - 1].in_use)
+	{
+		return NULL;
+	}
+
+	return &OS_impl_wait_set_table[set_id - 1];
+} /* end OS_WaitSet_Get */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_WaitSet_Link
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns the wait link of a semaphore, or NULL for a queue
+ *
+ *-----------------------------------------------------------------*/
+static OS_impl_sem_wait_link_t *OS_WaitSet_Link(uint32 idtype, uint32 local_id)
+{
+	if(idtype == OS_OBJECT_TYPE_OS_BINSEM)
+	{
+		return &OS_impl_bin_sem_table[local_id].wait;
+	}
+	else if(idtype == OS_OBJECT_TYPE_OS_COUNTSEM)
+	{
+		return &OS_impl_count_sem_table[local_id].wait;
+	}
+
+	return NULL;
+} /* end OS_WaitSet_Link */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_WaitSet_SemReady
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Whether a semaphore member can be taken right now
+ *
+ *-----------------------------------------------------------------*/
+static bool OS_WaitSet_SemReady(const OS_impl_wait_member_t *member)
+{
+	if(member->idtype == OS_OBJECT_TYPE_OS_BINSEM)
+	{
+		return OS_impl_bin_sem_table[member->local_id].sem.value != 0;
+	}
+
+	if(OS_impl_count_sem_table[member->local_id].id == NULL)
+	{
+		return OS_impl_count_sem_table[member->local_id].notify.value != 0;
+	}
+
+	return uxSemaphoreGetCount(OS_impl_count_sem_table[member->local_id].id) != 0;
+} /* end OS_WaitSet_SemReady */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_WaitSet_Drain
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes the events of one member out of the queue set, keeping
+ *           the others in order.  Called in a critical section, so no
+ *           event is posted or selected meanwhile.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_WaitSet_Drain(OS_impl_wait_set_t *ws, QueueSetMemberHandle_t handle)
+{
+	QueueSetMemberHandle_t event;
+	UBaseType_t n;
+
+	for(n = uxQueueMessagesWaiting(ws->set); n > 0; n--)
+	{
+		if(xQueueReceive(ws->set, &event, 0) == pdPASS && event != handle)
+		{
+			xQueueSend(ws->set, &event, 0);
+		}
+	}
+} /* end OS_WaitSet_Drain */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_WaitSet_RemoveMember
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes member i out of a wait set, with the set lock held.
+ *           Returns OS_ERR_INCORRECT_OBJ_STATE if a queue still holds
+ *           messages, unless force is set.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_WaitSet_RemoveMember(OS_impl_wait_set_t *ws, uint32 i, bool force)
+{
+	OS_impl_wait_member_t *member = &ws->members[i];
+	OS_impl_sem_wait_link_t *link = OS_WaitSet_Link(member->idtype, member->local_id);
+	BaseType_t removed;
+
+	/*
+	 ** The kernel only lets an empty member leave the queue set.  Emptying
+	 ** the proxy and removing it are done in one critical section, so a
+	 ** give cannot fill it again in between.
+	 */
+	taskENTER_CRITICAL();
+	if(link != NULL)
+	{
+		xSemaphoreTake(link->proxy, 0);
+	}
+	removed = xQueueRemoveFromSet(member->handle, ws->set);
+
+	/*
+	 ** A queue being deleted leaves the set with its messages.  Either way
+	 ** the member's events still in the set are dropped now, so the room
+	 ** reserved for them is really free when the count is given back.
+	 */
+	if(removed == pdPASS || force)
+	{
+		OS_WaitSet_Drain(ws, member->handle);
+		if(link != NULL)
+		{
+			link->wait_set = 0;
+		}
+		else
+		{
+			OS_impl_queue_table[member->local_id].wait_set = 0;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if(removed != pdPASS && !force)
+	{
+		return (link != NULL) ? OS_ERROR : OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	ws->reserved -= member->events;
+	--ws->count;
+	ws->members[i] = ws->members[ws->count];
+
+	return OS_SUCCESS;
+} /* end OS_WaitSet_RemoveMember */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_WaitSetDetach
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Removes a queue or semaphore that is being deleted from its
+ *           wait set, and deletes the proxy of a semaphore.
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_WaitSetDetach(uint32 idtype, uint32 local_id)
+{
+	OS_impl_sem_wait_link_t *link = OS_WaitSet_Link(idtype, local_id);
+	OS_impl_wait_set_t *ws;
+	uint32 set_id;
+	uint32 i;
+
+	set_id = (link != NULL) ? link->wait_set : OS_impl_queue_table[local_id].wait_set;
+	ws = OS_WaitSet_Get(set_id);
+	if(ws != NULL)
+	{
+		xSemaphoreTake(ws->lock, portMAX_DELAY);
+		for(i = 0; i < ws->count; i++)
+		{
+			if(ws->members[i].idtype == idtype && ws->members[i].local_id == local_id)
+			{
+				OS_WaitSet_RemoveMember(ws, i, true);
+				break;
+			}
+		}
+		xSemaphoreGive(ws->lock);
+	}
+
+	if(link != NULL && link->proxy != NULL)
+	{
+		vSemaphoreDelete(link->proxy);
+		link->proxy = NULL;
+	}
+} /* end OS_FreeRTOS_WaitSetDetach */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_WaitSetCreate
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_WaitSetCreate(uint32 *set_id, uint32 max_events)
+{
+	OS_impl_wait_set_t *ws;
+	uint32 heap_category;
+	uint32 i;
+
+	if(set_id == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*set_id = 0;
+
+	if(max_events == 0)
+	{
+		return OS_ERROR;
+	}
+
+	ws = NULL;
+	taskENTER_CRITICAL();
+	for(i = 0; i < OS_FREERTOS_MAX_WAIT_SETS; i++)
+	{
+		if(!OS_impl_wait_set_table[i].in_use)
+		{
+			ws = &OS_impl_wait_set_table[i];
+			ws->in_use = true;
+			break;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if(ws == NULL)
+	{
+		return OS_ERR_NO_FREE_IDS;
+	}
+
+	/* The kernel has no static queue sets */
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_QUEUE);
+	ws->set = xQueueCreateSet(max_events);
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	ws->lock = xSemaphoreCreateMutexStatic(&ws->lock_cb);
+#else
+	ws->lock = xSemaphoreCreateMutex();
+#endif
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+
+	if(ws->set == NULL || ws->lock == NULL)
+	{
+		if(ws->set != NULL)
+		{
+			vQueueDelete(ws->set);
+		}
+		if(ws->lock != NULL)
+		{
+			vSemaphoreDelete(ws->lock);
+		}
+		ws->set = NULL;
+		ws->lock = NULL;
+		ws->in_use = false;
+		return OS_ERROR;
+	}
+
+	ws->max_events = max_events;
+	ws->reserved = 0;
+	ws->count = 0;
+	ws->next = 0;
+
+	*set_id = (uint32)(ws - OS_impl_wait_set_table) + 1;
+
+	return OS_SUCCESS;
+} /* end OS_WaitSetCreate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_WaitSetDelete
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_WaitSetDelete(uint32 set_id)
+{
+	OS_impl_wait_set_t *ws = OS_WaitSet_Get(set_id);
+
+	if(ws == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	xSemaphoreTake(ws->lock, portMAX_DELAY);
+	if(ws->count != 0)
+	{
+		xSemaphoreGive(ws->lock);
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	taskENTER_CRITICAL();
+	ws->in_use = false;
+	taskEXIT_CRITICAL();
+	xSemaphoreGive(ws->lock);
+
+	vQueueDelete(ws->set);
+	vSemaphoreDelete(ws->lock);
+	ws->set = NULL;
+	ws->lock = NULL;
+
+	return OS_SUCCESS;
+} /* end OS_WaitSetDelete */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_WaitSetAdd
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_WaitSetAdd(uint32 set_id, uint32 object_id)
+{
+	OS_impl_wait_set_t *ws;
+	OS_impl_wait_member_t *member;
+	OS_impl_sem_wait_link_t *link;
+	OS_common_record_t *record;
+	QueueSetMemberHandle_t handle;
+	uint32 idtype;
+	uint32 local_id;
+	uint32 events;
+#ifndef OS_FREERTOS_STATIC_OBJECTS
+	uint32 heap_category;
+#endif
+	int32 return_code;
+
+	ws = OS_WaitSet_Get(set_id);
+	if(ws == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	idtype = OS_IdentifyObject(object_id);
+	if(idtype != OS_OBJECT_TYPE_OS_QUEUE && idtype != OS_OBJECT_TYPE_OS_BINSEM && idtype != OS_OBJECT_TYPE_OS_COUNTSEM)
+	{
+		return OS_ERR_INCORRECT_OBJ_TYPE;
+	}
+
+	/* Keeps the object from being deleted while it is added */
+	return_code = OS_Lock_Global_Shared_Impl(idtype);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, idtype, object_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		xSemaphoreTake(ws->lock, portMAX_DELAY);
+
+		link = OS_WaitSet_Link(idtype, local_id);
+		if(link != NULL)
+		{
+			if(link->wait_set != 0)
+			{
+				return_code = OS_ERR_INCORRECT_OBJ_STATE;
+			}
+			else if(link->proxy == NULL)
+			{
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+				link->proxy = xSemaphoreCreateBinaryStatic(&link->proxy_cb);
+#else
+				heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_SEMAPHORE);
+				link->proxy = xSemaphoreCreateBinary();
+				OS_FreeRTOS_HeapCategorySet(heap_category);
+#endif
+				if(link->proxy == NULL)
+				{
+					return_code = OS_ERROR;
+				}
+			}
+			else
+			{
+				/* Left given by a give while it was in no set */
+				xSemaphoreTake(link->proxy, 0);
+			}
+			handle = link->proxy;
+			events = 1;
+		}
+		else
+		{
+			if(OS_impl_queue_table[local_id].wait_set != 0)
+			{
+				return_code = OS_ERR_INCORRECT_OBJ_STATE;
+			}
+			handle = OS_impl_queue_table[local_id].id;
+			events = (uint32) uxQueueSpacesAvailable(handle) + (uint32) uxQueueMessagesWaiting(handle);
+		}
+
+		if(return_code == OS_SUCCESS && (ws->count == OS_FREERTOS_WAIT_SET_MAX_MEMBERS || ws->reserved + events > ws->max_events))
+		{
+			return_code = OS_QUEUE_FULL;
+		}
+
+		/* The kernel only adds a queue with no messages */
+		if(return_code == OS_SUCCESS && xQueueAddToSet(handle, ws->set) != pdPASS)
+		{
+			return_code = OS_ERR_INCORRECT_OBJ_STATE;
+		}
+
+		if(return_code == OS_SUCCESS)
+		{
+			member = &ws->members[ws->count];
+			member->object_id = object_id;
+			member->idtype = idtype;
+			member->local_id = local_id;
+			member->handle = handle;
+			member->events = events;
+			ws->reserved += events;
+			++ws->count;
+
+			if(link != NULL)
+			{
+				link->wait_set = set_id;
+
+				/* Already available, so the first wait does not miss it */
+				if(OS_WaitSet_SemReady(member))
+				{
+					xSemaphoreGive(link->proxy);
+				}
+			}
+			else
+			{
+				OS_impl_queue_table[local_id].wait_set = set_id;
+			}
+		}
+
+		xSemaphoreGive(ws->lock);
+	}
+
+	OS_Unlock_Global_Shared_Impl(idtype);
+
+	return return_code;
+} /* end OS_WaitSetAdd */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_WaitSetRemove
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_WaitSetRemove(uint32 set_id, uint32 object_id)
+{
+	OS_impl_wait_set_t *ws;
+	uint32 i;
+	int32 return_code = OS_ERR_NAME_NOT_FOUND;
+
+	ws = OS_WaitSet_Get(set_id);
+	if(ws == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	xSemaphoreTake(ws->lock, portMAX_DELAY);
+	for(i = 0; i < ws->count; i++)
+	{
+		if(ws->members[i].object_id == object_id)
+		{
+			return_code = OS_WaitSet_RemoveMember(ws, i, false);
+			break;
+		}
+	}
+	xSemaphoreGive(ws->lock);
+
+	return return_code;
+} /* end OS_WaitSetRemove */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_WaitSetWait
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_WaitSetWait(uint32 set_id, uint32 *object_id, int32 msecs)
+{
+	OS_impl_wait_set_t *ws;
+	OS_impl_wait_member_t *member;
+	QueueSetMemberHandle_t handle;
+	TimeOut_t time_out;
+	TickType_t ticks;
+	uint32 found;
+	uint32 i;
+	uint32 n;
+
+	if(object_id == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*object_id = 0;
+
+	ws = OS_WaitSet_Get(set_id);
+	if(ws == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	ticks = OS_FreeRTOS_QueueTicks(msecs);
+	vTaskSetTimeOutState(&time_out);
+
+	while(1)
+	{
+		/*
+		 ** Semaphores are reported for as long as they can be taken, so a
+		 ** count given several times is reported until it is used up.  The
+		 ** check starts after the last one reported, so none is starved.
+		 */
+		found = 0;
+		xSemaphoreTake(ws->lock, portMAX_DELAY);
+		for(n = 0; n < ws->count && found == 0; n++)
+		{
+			i = (ws->next + n) % ws->count;
+			member = &ws->members[i];
+			if(member->idtype != OS_OBJECT_TYPE_OS_QUEUE && OS_WaitSet_SemReady(member))
+			{
+				found = member->object_id;
+				ws->next = i + 1;
+			}
+		}
+		xSemaphoreGive(ws->lock);
+
+		if(found != 0)
+		{
+			*object_id = found;
+			return OS_SUCCESS;
+		}
+
+		handle = xQueueSelectFromSet(ws->set, ticks);
+		if(handle == NULL)
+		{
+			return OS_ERROR_TIMEOUT;
+		}
+
+		xSemaphoreTake(ws->lock, portMAX_DELAY);
+		for(i = 0; i < ws->count && found == 0; i++)
+		{
+			if(ws->members[i].handle == handle)
+			{
+				if(ws->members[i].idtype == OS_OBJECT_TYPE_OS_QUEUE)
+				{
+					found = ws->members[i].object_id;
+				}
+				else
+				{
+					/* Consumed so the proxy can be given again, the semaphore is checked above */
+					xSemaphoreTake(handle, 0);
+				}
+			}
+		}
+		xSemaphoreGive(ws->lock);
+
+		/* A queue event is one message, the caller reads it from the queue */
+		if(found != 0)
+		{
+			*object_id = found;
+			return OS_SUCCESS;
+		}
+
+		/* Check the semaphores again, then wait for what is left of the timeout */
+		if(xTaskCheckForTimeOut(&time_out, &ticks) != pdFALSE)
+		{
+			ticks = 0;
+		}
+	}
+} /* end OS_WaitSetWait */
+
+/****************************************************************************************
+ MUTEX API
+ ****************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_MutexAPI_Impl_Init
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FreeRTOS_MutexAPI_Impl_Init(void)
+{
+    memset(OS_impl_mut_sem_table, 0, sizeof(OS_impl_mut_sem_table));
+
+    return OS_SUCCESS;
+} /* end OS_FreeRTOS_MutexAPI_Impl_Init */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_MutSemTake
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes the mutex, blocking for up to "ticks", and keeps the
+ *           holder bookkeeping up to date.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FreeRTOS_MutSemTake(OS_impl_internal_record_t *local, TickType_t ticks)
+{
+	BaseType_t status;
+	unsigned long start;
+
+	/* Try without blocking first so only the takes that wait are timed */
+	status = xSemaphoreTakeRecursive(local->id, 0);
+	if(status == pdTRUE)
+	{
+		OS_FreeRTOS_SemStatsTaken(&local->stats);
+	}
+	else if(ticks != 0)
+	{
+		start = OS_FreeRTOS_SemStatsStart();
+		status = xSemaphoreTakeRecursive(local->id, ticks);
+		OS_FreeRTOS_SemStatsBlocked(&local->stats, start, (status == pdTRUE));
+	}
+
+	if(status != pdTRUE)
+	{
+		return OS_SEM_TIMEOUT;
+	}
+
+	++local->depth;
+	if(local->depth == 1)
+	{
+		local->hold_start = OS_FreeRTOS_SemStatsStart();
+	}
+
+	return OS_SUCCESS;
+} /* end OS_FreeRTOS_MutSemTake */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MutSemCreate_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MutSemCreate_Impl(uint32 sem_id, uint32 options)
+{
+#ifndef OS_FREERTOS_STATIC_OBJECTS
+	uint32 heap_category;
+#endif
+
+	OS_FREERTOS_API_ENTER(MutSemCreate);
+
+	/*
+	 ** Try to create the mutex
+	 */
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	OS_impl_mut_sem_table[sem_id].id = xSemaphoreCreateRecursiveMutexStatic(&OS_impl_mut_sem_table[sem_id].sem_cb);
+#else
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_SEMAPHORE);
+	OS_impl_mut_sem_table[sem_id].id = xSemaphoreCreateRecursiveMutex();
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+#endif
+	if(OS_impl_mut_sem_table[sem_id].id == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(MutSemCreate, OS_SEM_FAILURE);
+	}
+
+	OS_impl_mut_sem_table[sem_id].depth = 0;
+	OS_impl_mut_sem_table[sem_id].hold_count = 0;
+	OS_impl_mut_sem_table[sem_id].total_hold = 0;
+	OS_impl_mut_sem_table[sem_id].max_hold = 0;
+	memset(&OS_impl_mut_sem_table[sem_id].stats, 0, sizeof(OS_impl_sem_stats_t));
+
+	return OS_FREERTOS_API_EXIT(MutSemCreate, OS_SUCCESS);
+}/* end OS_MutSemCreate_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MutSemDelete_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MutSemDelete_Impl(uint32 sem_id)
+{
+	OS_FREERTOS_API_ENTER(MutSemDelete);
+
+	vSemaphoreDelete(OS_impl_mut_sem_table[sem_id].id);
+	OS_impl_mut_sem_table[sem_id].id = (SemaphoreHandle_t)0xFFFF;
+
+    return OS_FREERTOS_API_EXIT(MutSemDelete, OS_SUCCESS);
+}/* end OS_MutSemDelete_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MutSemGive_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MutSemGive_Impl(uint32 sem_id)
+{
+	OS_impl_internal_record_t *local = &OS_impl_mut_sem_table[sem_id];
+#ifdef OS_FREERTOS_SEM_STATS
+	unsigned long hold;
+#endif
+
+	OS_FREERTOS_API_ENTER(MutSemGive);
+
+	/* Only the holder may give the mutex, and only the holder touches depth */
+	if(xSemaphoreGetMutexHolder(local->id) != xTaskGetCurrentTaskHandle())
+	{
+		return OS_FREERTOS_API_EXIT(MutSemGive, OS_SEM_FAILURE);
+	}
+
+	if(local->depth == 1)
+	{
+		++local->hold_count;
+#ifdef OS_FREERTOS_SEM_STATS
+		hold = ulGetRunTimeCounterValue() - local->hold_start;
+		local->total_hold += hold;
+		if(hold > local->max_hold)
+		{
+			local->max_hold = hold;
+		}
+#endif
+	}
+	--local->depth;
+
+	/* Give the mutex */
+	if(xSemaphoreGiveRecursive(local->id) != pdTRUE)
+	{
+		++local->depth;
+		return OS_FREERTOS_API_EXIT(MutSemGive, OS_SEM_FAILURE);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(MutSemGive, OS_SUCCESS);
+	}
+}/* end OS_MutSemGive_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MutSemTake_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MutSemTake_Impl(uint32 sem_id)
+{
+	OS_FREERTOS_API_ENTER(MutSemTake);
+
+	if(OS_FreeRTOS_MutSemTake(&OS_impl_mut_sem_table[sem_id], portMAX_DELAY) != OS_SUCCESS)
+	{
+		return OS_FREERTOS_API_EXIT(MutSemTake, OS_SEM_FAILURE);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(MutSemTake, OS_SUCCESS);
+	}
+}/* end OS_MutSemTake_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MutSemTimedTake_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MutSemTimedTake_Impl(uint32 sem_id, uint32 msecs)
+{
+	OS_FREERTOS_API_ENTER(MutSemTimedTake);
+
+	return OS_FREERTOS_API_EXIT(MutSemTimedTake, OS_FreeRTOS_MutSemTake(&OS_impl_mut_sem_table[sem_id], OS_Milli2Ticks(msecs)));
+}/* end OS_MutSemTimedTake_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MutSemGetInfo_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MutSemGetInfo_Impl(uint32 sem_id, OS_mut_sem_prop_t *mut_prop)
+{
+	OS_FREERTOS_API_ENTER(MutSemGetInfo);
+
+	/* The shared layer fills in everything OS_mut_sem_prop_t has room for */
+	return OS_FREERTOS_API_EXIT(MutSemGetInfo, OS_SUCCESS);
+} /* end OS_MutSemGetInfo_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MutSemGetStats_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MutSemGetStats_Impl(uint32 sem_id, OS_mut_sem_stats_t *mut_stats)
+{
+	OS_impl_internal_record_t *local = &OS_impl_mut_sem_table[sem_id];
+	OS_sem_stats_t sem_stats;
+	TaskHandle_t holder;
+
+	OS_FREERTOS_API_ENTER(MutSemGetStats);
+
+	holder = xSemaphoreGetMutexHolder(local->id);
+	if(holder != NULL)
+	{
+		mut_stats->holder_id = (uint32)pvTaskGetThreadLocalStoragePointer(holder, 0);
+		strncpy(mut_stats->holder_name, pcTaskGetName(holder), sizeof(mut_stats->holder_name) - 1);
+
+		/* Higher than the holder's own priority while it is inheriting */
+		mut_stats->holder_priority = uxTaskPriorityGet(holder);
+		mut_stats->depth = local->depth;
+	}
+
+	mut_stats->hold_count = local->hold_count;
+
+	if(OS_FreeRTOS_SemStatsGet(&local->stats, &sem_stats) == OS_SUCCESS)
+	{
+		mut_stats->take_count      = sem_stats.take_count;
+		mut_stats->blocked_count   = sem_stats.blocked_count;
+		mut_stats->total_wait_usec = sem_stats.total_wait_usec;
+		mut_stats->max_wait_usec   = sem_stats.max_wait_usec;
+		mut_stats->total_hold_usec = local->total_hold * 10;
+		mut_stats->max_hold_usec   = OS_FreeRTOS_CountsToUsec(local->max_hold);
+	}
+
+	return OS_FREERTOS_API_EXIT(MutSemGetStats, OS_SUCCESS);
+} /* end OS_MutSemGetStats_Impl */
+
+/****************************************************************************************
+ INT API
+ ****************************************************************************************/
+
+/*
+ * Simulated interrupt numbers of the Win32 port (portMAX_INTERRUPTS, which is
+ * a sizeof expression and cannot be tested by the preprocessor).  0 and 1 are
+ * the port's own yield and tick interrupts.
+ */
+#define OS_FREERTOS_INT_COUNT           32
+#define OS_FREERTOS_INT_FIRST           2
+
+/* Handlers attached with OS_IntAttachHandler, by simulated interrupt number */
+static osal_task_entry OS_impl_int_handler[OS_FREERTOS_INT_COUNT];
+
+/*
+ * Set by the FromISR calls when the running handler made a task ready that
+ * should run ahead of the interrupted one.  The port runs one simulated
+ * interrupt at a time, so a single flag is enough.
+ */
+BaseType_t OS_impl_int_woken;
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_IntDispatch
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Runs the attached handler and tells the port whether a
+ *           context switch is due once the interrupt returns.
+ *
+ *-----------------------------------------------------------------*/
+static uint32_t OS_FreeRTOS_IntDispatch(uint32 InterruptNumber)
+{
+	osal_task_entry handler = OS_impl_int_handler[InterruptNumber];
+
+	OS_impl_int_woken = pdFALSE;
+	if(handler != NULL)
+	{
+#if configFREERTOS_SIM_EVENT_TRACE
+		OS_FreeRTOS_TraceEvent(OS_FREERTOS_TRACE_ISR_ENTER, NULL, InterruptNumber);
+		handler();
+		OS_FreeRTOS_TraceEvent(OS_FREERTOS_TRACE_ISR_EXIT, NULL, InterruptNumber);
+#else
+		handler();
+#endif
+	}
+
+	return (uint32_t)OS_impl_int_woken;
+} /* end OS_FreeRTOS_IntDispatch */
+
+/*
+ * The port calls a handler without its interrupt number, so every number
+ * gets its own entry that passes it on to OS_FreeRTOS_IntDispatch.
+ */
+#define OS_FREERTOS_INT_ENTRY(n)    static uint32_t OS_FreeRTOS_IntEntry##n(void) { return OS_FreeRTOS_IntDispatch(n); }
+
+OS_FREERTOS_INT_ENTRY(2)  OS_FREERTOS_INT_ENTRY(3)  OS_FREERTOS_INT_ENTRY(4)  OS_FREERTOS_INT_ENTRY(5)
+OS_FREERTOS_INT_ENTRY(6)  OS_FREERTOS_INT_ENTRY(7)  OS_FREERTOS_INT_ENTRY(8)  OS_FREERTOS_INT_ENTRY(9)
+OS_FREERTOS_INT_ENTRY(10) OS_FREERTOS_INT_ENTRY(11) OS_FREERTOS_INT_ENTRY(12) OS_FREERTOS_INT_ENTRY(13)
+OS_FREERTOS_INT_ENTRY(14) OS_FREERTOS_INT_ENTRY(15) OS_FREERTOS_INT_ENTRY(16) OS_FREERTOS_INT_ENTRY(17)
+OS_FREERTOS_INT_ENTRY(18) OS_FREERTOS_INT_ENTRY(19) OS_FREERTOS_INT_ENTRY(20) OS_FREERTOS_INT_ENTRY(21)
+OS_FREERTOS_INT_ENTRY(22) OS_FREERTOS_INT_ENTRY(23) OS_FREERTOS_INT_ENTRY(24) OS_FREERTOS_INT_ENTRY(25)
+OS_FREERTOS_INT_ENTRY(26) OS_FREERTOS_INT_ENTRY(27) OS_FREERTOS_INT_ENTRY(28) OS_FREERTOS_INT_ENTRY(29)
+OS_FREERTOS_INT_ENTRY(30) OS_FREERTOS_INT_ENTRY(31)
+
+static uint32_t (* const OS_impl_int_entry[OS_FREERTOS_INT_COUNT])(void) =
+{
+	NULL,                    NULL,                    OS_FreeRTOS_IntEntry2,   OS_FreeRTOS_IntEntry3,
+	OS_FreeRTOS_IntEntry4,   OS_FreeRTOS_IntEntry5,   OS_FreeRTOS_IntEntry6,   OS_FreeRTOS_IntEntry7,
+	OS_FreeRTOS_IntEntry8,   OS_FreeRTOS_IntEntry9,   OS_FreeRTOS_IntEntry10,  OS_FreeRTOS_IntEntry11,
+	OS_FreeRTOS_IntEntry12,  OS_FreeRTOS_IntEntry13,  OS_FreeRTOS_IntEntry14,  OS_FreeRTOS_IntEntry15,
+	OS_FreeRTOS_IntEntry16,  OS_FreeRTOS_IntEntry17,  OS_FreeRTOS_IntEntry18,  OS_FreeRTOS_IntEntry19,
+	OS_FreeRTOS_IntEntry20,  OS_FreeRTOS_IntEntry21,  OS_FreeRTOS_IntEntry22,  OS_FreeRTOS_IntEntry23,
+	OS_FreeRTOS_IntEntry24,  OS_FreeRTOS_IntEntry25,  OS_FreeRTOS_IntEntry26,  OS_FreeRTOS_IntEntry27,
+	OS_FreeRTOS_IntEntry28,  OS_FreeRTOS_IntEntry29,  OS_FreeRTOS_IntEntry30,  OS_FreeRTOS_IntEntry31
+};
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_IntNumberValid
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Checks that the number is a simulated interrupt the port
+ *           itself does not use.
+ *
+ *-----------------------------------------------------------------*/
+static bool OS_FreeRTOS_IntNumberValid(uint32 InterruptNumber)
+{
+	if(InterruptNumber < OS_FREERTOS_INT_FIRST || InterruptNumber >= OS_FREERTOS_INT_COUNT)
+	{
+		return false;
+	}
+
+#ifdef OS_FREERTOS_TIMEBASE_HIRES
+	if(InterruptNumber == OS_FREERTOS_TIMEBASE_HIRES_INTERRUPT)
+	{
+		return false;
+	}
+#endif
+#ifdef OS_FREERTOS_NET_SHM
+	if(InterruptNumber == OS_FREERTOS_NET_SHM_INTERRUPT)
+	{
+		return false;
+	}
+#endif
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+	if(InterruptNumber == OS_FREERTOS_TIMEBASE_EXTERNAL_INTERRUPT)
+	{
+		return false;
+	}
+#endif
+
+	return (InterruptNumber != OS_FREERTOS_HOSTFILE_INTERRUPT);
+} /* end OS_FreeRTOS_IntNumberValid */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_IntAttachHandler_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *           The handler runs on the port's interrupt thread with the
+ *           scheduler held off, so it may only use the FromISR
+ *           extensions.  An osal_task_entry takes no argument, so
+ *           "parameter" is not passed on.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_IntAttachHandler_Impl(uint32 InterruptNumber, osal_task_entry InterruptHandler, int32 parameter)
+{
+	if(!OS_FreeRTOS_IntNumberValid(InterruptNumber))
+	{
+		return OS_INVALID_INT_NUM;
+	}
+
+	/* Keeps a pending interrupt from seeing a half attached handler */
+	taskENTER_CRITICAL();
+	OS_impl_int_handler[InterruptNumber] = InterruptHandler;
+	vPortSetInterruptHandler(InterruptNumber, OS_impl_int_entry[InterruptNumber]);
+	taskEXIT_CRITICAL();
+
+	return OS_SUCCESS;
+}/* end OS_IntAttachHandler_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_IntUnlock_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_IntUnlock_Impl(int32 IntLevel)
+{
+#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
+	return OS_SUCCESS;
+}/* end OS_IntUnlock_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_IntLock_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_IntLock_Impl(void)
+{
+#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
+	return OS_SUCCESS;
+}/* end OS_IntLock_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_IntEnable_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_IntEnable_Impl(int32 Level)
+{
+#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
+	return OS_SUCCESS;
+}/* end OS_IntEnable_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_IntDisable_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_IntDisable_Impl(int32 Level)
+{
+#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
+	return OS_SUCCESS;
+}/* end OS_IntDisable_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HeapGetInfo_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_HeapGetInfo_Impl(OS_heap_prop_t *heap_prop)
+{
+#if OS_FREERTOS_HEAP_STATS
+	HeapStats_t stats;
+#endif
+
+	OS_FREERTOS_API_ENTER(HeapGetInfo);
+
+#if OS_FREERTOS_HEAP_STATS
+	vPortGetHeapStats(&stats);
+
+	heap_prop->free_bytes = (uint32) stats.xAvailableHeapSpaceInBytes;
+	heap_prop->free_blocks = (uint32) stats.xNumberOfFreeBlocks;
+	heap_prop->largest_free_block = (uint32) stats.xSizeOfLargestFreeBlockInBytes;
+#else
+	/* The free blocks are not known, the largest one is 0 like the count */
+	heap_prop->free_bytes = (uint32) xPortGetFreeHeapSize();
+	heap_prop->free_blocks = 0;
+	heap_prop->largest_free_block = 0;
+#endif
+
+	return OS_FREERTOS_API_EXIT(HeapGetInfo, OS_SUCCESS);
+}/* end OS_HeapGetInfo_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_IntSetMask_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_IntSetMask_Impl(uint32 MaskSetting)
+{
+#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
+	return OS_ERR_NOT_IMPLEMENTED;
+} /* end OS_IntSetMask_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_IntGetMask_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_IntGetMask_Impl(uint32 * MaskSettingPtr)
+{
+    *MaskSettingPtr = 0;
+#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
+	return OS_ERR_NOT_IMPLEMENTED;
+} /* end OS_IntGetMask_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FPUExcAttachHandler_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FPUExcAttachHandler_Impl(uint32 ExceptionNumber, void * ExceptionHandler, int32 parameter)
+{
+    /*
+    ** Not implemented in FreeRTOS.
+    */
+#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
+	return OS_ERR_NOT_IMPLEMENTED;
+} /* end OS_FPUExcAttachHandler_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FPUExcEnable_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FPUExcEnable_Impl(int32 ExceptionNumber)
+{
+    /*
+    ** Not implemented in FreeRTOS.
+    */
+    return OS_SUCCESS;
+} /* end OS_FPUExcEnable_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FPUExcDisable_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FPUExcDisable_Impl(int32 ExceptionNumber)
+{
+    /*
+    ** Not implemented in FreeRTOS.
+    */
+    return OS_SUCCESS;
+} /* end OS_FPUExcDisable_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FPUExcSetMask_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FPUExcSetMask_Impl(uint32 mask)
+{
+    /*
+    ** Not implemented in FreeRTOS.
+    */
+    return OS_SUCCESS;
+} /* end OS_FPUExcSetMask_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FPUExcGetMask_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FPUExcGetMask_Impl(uint32 *mask)
+{
+    /*
+    ** Not implemented in FreeRTOS.
+    */
+    return OS_SUCCESS;
+} /* end OS_FPUExcGetMask_Impl */
+
+/****************************************************************************************
+ INT EXTENSION API
+ ****************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_NotifySemGiveFromISR
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           OS_FreeRTOS_NotifySemGive for interrupt context.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FreeRTOS_NotifySemGiveFromISR(OS_impl_notify_sem_t *local)
+{
+	OS_impl_sem_waiter_t *waiter;
+	UBaseType_t saved;
+	int32 return_code = OS_SUCCESS;
+
+	saved = taskENTER_CRITICAL_FROM_ISR();
+	waiter = local->waiters;
+	if(waiter != NULL)
+	{
+		local->waiters = waiter->next;
+		waiter->released = true;
+#ifdef OS_FREERTOS_SEM_NOTIFY
+		vTaskNotifyGiveIndexedFromISR(waiter->task, OS_FREERTOS_NOTIFY_SEM_INDEX, &OS_impl_int_woken);
+#else
+		xSemaphoreGiveFromISR(waiter->wake, &OS_impl_int_woken);
+#endif
+	}
+	else if(local->value < local->max_value)
+	{
+		++local->value;
+	}
+	else
+	{
+		return_code = OS_SEM_FAILURE;
+	}
+	taskEXIT_CRITICAL_FROM_ISR(saved);
+
+	return return_code;
+} /* end OS_FreeRTOS_NotifySemGiveFromISR */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_BinSemGiveFromISR
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_BinSemGiveFromISR(uint32 sem_id)
+{
+	uint32 local_id;
+
+	/*
+	 ** The global table lock can block, so the id is checked against the
+	 ** table directly.  The semaphore must outlive any handler using it.
+	 */
+	if(OS_ObjectIdToArrayIndex(OS_OBJECT_TYPE_OS_BINSEM, sem_id, &local_id) != OS_SUCCESS ||
+	   OS_global_bin_sem_table[local_id].active_id != sem_id)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	/* Giving a binary semaphore that is already full is not an error */
+	OS_FreeRTOS_NotifySemGiveFromISR(&OS_impl_bin_sem_table[local_id].sem);
+	if(OS_impl_bin_sem_table[local_id].wait.wait_set != 0)
+	{
+		xSemaphoreGiveFromISR(OS_impl_bin_sem_table[local_id].wait.proxy, &OS_impl_int_woken);
+	}
+
+	return OS_SUCCESS;
+} /* end OS_BinSemGiveFromISR */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CountSemGiveFromISR
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_CountSemGiveFromISR(uint32 sem_id)
+{
+	uint32 local_id;
+
+	if(OS_ObjectIdToArrayIndex(OS_OBJECT_TYPE_OS_COUNTSEM, sem_id, &local_id) != OS_SUCCESS ||
+	   OS_global_count_sem_table[local_id].active_id != sem_id)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	if(OS_impl_count_sem_table[local_id].id == NULL)
+	{
+		if(OS_FreeRTOS_NotifySemGiveFromISR(&OS_impl_count_sem_table[local_id].notify) != OS_SUCCESS)
+		{
+			return OS_SEM_FAILURE;
+		}
+	}
+	else if(xSemaphoreGiveFromISR(OS_impl_count_sem_table[local_id].id, &OS_impl_int_woken) != pdTRUE)
+	{
+		return OS_SEM_FAILURE;
+	}
+
+	if(OS_impl_count_sem_table[local_id].wait.wait_set != 0)
+	{
+		xSemaphoreGiveFromISR(OS_impl_count_sem_table[local_id].wait.proxy, &OS_impl_int_woken);
+	}
+
+	return OS_SUCCESS;
+} /* end OS_CountSemGiveFromISR */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_QueuePutFromISR
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_QueuePutFromISR(uint32 queue_id, const void *data, uint32 size)
+{
+	OS_impl_queue_internal_record_t *local;
+	OS_impl_queue_msg_t msg;
+	UBaseType_t depth;
+	uint32 local_id;
+	uint32 buffer_index;
+
+	if(data == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	if(OS_ObjectIdToArrayIndex(OS_OBJECT_TYPE_OS_QUEUE, queue_id, &local_id) != OS_SUCCESS ||
+	   OS_global_queue_table[local_id].active_id != queue_id)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	if(size > OS_queue_table[local_id].max_size)
+	{
+		return OS_QUEUE_INVALID_SIZE;
+	}
+
+	local = &OS_impl_queue_table[local_id];
+
+	/*
+	 ** Same as OS_FreeRTOS_QueueSend with OS_CHECK, an interrupt never waits
+	 ** for a buffer or a slot.
+	 */
+	if(xQueueReceiveFromISR(local->free_list, &msg.buffer, &OS_impl_int_woken) != pdTRUE)
+	{
+		++local->full_count;
+		return OS_QUEUE_FULL;
+	}
+	OS_FreeRTOS_QueueBufferClaim(local, msg.buffer);
+
+	memcpy(msg.buffer, data, size);
+	msg.size = size;
+
+	if(xQueueSendFromISR(local->id, &msg, &OS_impl_int_woken) != pdTRUE)
+	{
+		/* The free list has room for every buffer, so this cannot fail */
+		OS_FreeRTOS_QueueBufferIndex(local, msg.buffer, &buffer_index);
+		local->in_use[buffer_index] = 0;
+		xQueueSendFromISR(local->free_list, &msg.buffer, &OS_impl_int_woken);
+		++local->full_count;
+		return OS_QUEUE_FULL;
+	}
+
+	++local->put_count;
+	depth = uxQueueMessagesWaitingFromISR(local->id);
+	if(depth > local->peak_depth)
+	{
+		local->peak_depth = depth;
+	}
+
+	return OS_SUCCESS;
+} /* end OS_QueuePutFromISR */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_IntRaise
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_IntRaise(uint32 InterruptNumber)
+{
+	if(!OS_FreeRTOS_IntNumberValid(InterruptNumber))
+	{
+		return OS_INVALID_INT_NUM;
+	}
+
+	if(OS_impl_int_handler[InterruptNumber] == NULL)
+	{
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	vPortGenerateSimulatedInterrupt(InterruptNumber);
+
+	return OS_SUCCESS;
+} /* end OS_IntRaise */
+
+/****************************************************************************************
+ HEAP API
+ ****************************************************************************************/
+
+#if configFREERTOS_SIM_HEAP_ATTRIBUTION
+
+#if (OS_FREERTOS_HEAP_TRACK_SLOTS & (OS_FREERTOS_HEAP_TRACK_SLOTS - 1)) != 0
+#error OS_FREERTOS_HEAP_TRACK_SLOTS must be a power of two
+#endif
+
+/*
+ * Heap blocks charged to an object type, an open addressing table keyed by
+ * the block address.  Blocks of OS_HEAP_CATEGORY_OTHER are not entered, their
+ * bytes are whatever is left of the used heap.  The table is only touched
+ * from the trace hooks, which run with the scheduler suspended.
+ */
+static void   *OS_heap_track_addr[OS_FREERTOS_HEAP_TRACK_SLOTS];
+static uint32  OS_heap_track_size[OS_FREERTOS_HEAP_TRACK_SLOTS];
+static uint8   OS_heap_track_category[OS_FREERTOS_HEAP_TRACK_SLOTS];
+static uint32  OS_heap_track_count;
+static uint32  OS_heap_category_bytes[OS_HEAP_CATEGORY_COUNT];
+
+/* Category charged before the scheduler runs, when there is no current task */
+static uint32  OS_heap_category_startup = OS_HEAP_CATEGORY_OTHER;
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_HeapTrackSlot
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Home slot of a block address in the tracking table
+ *
+ *-----------------------------------------------------------------*/
+static uint32 OS_FreeRTOS_HeapTrackSlot(const void *addr)
+{
+	return ((uint32)((uintptr_t) addr >> 3) * 2654435761u) & (OS_FREERTOS_HEAP_TRACK_SLOTS - 1);
+} /* end OS_FreeRTOS_HeapTrackSlot */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_HeapCategoryGet
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Category the calling task's allocations are charged to
+ *
+ *-----------------------------------------------------------------*/
+static uint32 OS_FreeRTOS_HeapCategoryGet(void)
+{
+	if(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+	{
+		return OS_heap_category_startup;
+	}
+
+	return (uint32)(uintptr_t) pvTaskGetThreadLocalStoragePointer(NULL, OS_FREERTOS_TLS_HEAP_CATEGORY);
+} /* end OS_FreeRTOS_HeapCategoryGet */
+
+#endif /* configFREERTOS_SIM_HEAP_ATTRIBUTION */
+
+#if configFREERTOS_SIM_CRASH_RECORD
+
+/*
+ * The last heap operations, oldest overwritten first, and the size of the
+ * last failed request.  Only touched from the trace hooks, which run with the
+ * scheduler suspended, and read by the crash record.
+ */
+typedef struct
+{
+	void       *addr;			/* NULL for a failed allocation */
+	uint32      size;
+	TickType_t  tick;
+	bool        freed;
+	char        task[configMAX_TASK_NAME_LEN];
+} OS_heap_history_t;
+
+static OS_heap_history_t OS_heap_history[OS_FREERTOS_CRASH_HISTORY];
+static uint32            OS_heap_history_count;
+static uint32            OS_heap_failed_size;
+
+/* Text of the record being written; a failure while one is written is not recorded */
+static char              OS_crash_record_buffer[OS_FREERTOS_FILE_BUFFER_SIZE];
+static volatile LONG     OS_crash_record_busy;
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_HeapHistoryAdd
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Adds a heap operation to the history kept for the crash record
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_HeapHistoryAdd(void *addr, size_t size, bool freed)
+{
+	OS_heap_history_t *entry = &OS_heap_history[OS_heap_history_count % OS_FREERTOS_CRASH_HISTORY];
+
+	entry->addr = addr;
+	entry->size = (uint32) size;
+	entry->tick = xTaskGetTickCount();
+	entry->freed = freed;
+	if(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+	{
+		strcpy(entry->task, "startup");
+	}
+	else
+	{
+		strncpy(entry->task, pcTaskGetName(NULL), sizeof(entry->task) - 1);
+		entry->task[sizeof(entry->task) - 1] = 0;
+	}
+	++OS_heap_history_count;
+
+	if(!freed && addr == NULL)
+	{
+		OS_heap_failed_size = (uint32) size;
+	}
+} /* end OS_FreeRTOS_HeapHistoryAdd */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_CrashPrint
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Appends to the crash record text, cutting what does not fit
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_CrashPrint(uint32 *len, const char *format, ...)
+{
+	va_list args;
+	int n;
+
+	if(*len >= sizeof(OS_crash_record_buffer) - 1)
+	{
+		return;
+	}
+
+	va_start(args, format);
+	n = vsnprintf(&OS_crash_record_buffer[*len], sizeof(OS_crash_record_buffer) - *len, format, args);
+	va_end(args);
+
+	if(n < 0 || (uint32)n >= sizeof(OS_crash_record_buffer) - *len)
+	{
+		*len = sizeof(OS_crash_record_buffer) - 1;
+	}
+	else
+	{
+		*len += (uint32)n;
+	}
+} /* end OS_FreeRTOS_CrashPrint */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_CrashRecord
+ *
+ *  Purpose: Called by vApplicationMallocFailedHook and vAssertCalled, see
+ *           FreeRTOSConfig.h.  Prints a crash record and appends it to
+ *           OS_FREERTOS_CRASH_RECORD_PATH if that is on a FS_BASED volume.
+ *
+ *  Notes:   An assertion can fail in a critical section or with the
+ *           scheduler suspended, so only the malloc failed path walks the
+ *           free list, and nothing here blocks on a FreeRTOS object.
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_CrashRecord(const char *pcReason, const char *pcFileName, unsigned long ulLine)
+{
+	OS_heap_stats_t heap_stats;
+	const OS_heap_history_t *entry;
+	TaskHandle_t task;
+	HANDLE file;
+	DWORD written;
+	uint32 len = 0;
+	uint32 first;
+	uint32 i;
+
+	if(InterlockedExchange(&OS_crash_record_busy, 1) != 0)
+	{
+		return;
+	}
+
+	OS_FreeRTOS_CrashPrint(&len, "---- OSAL crash record: %s\n", pcReason);
+	if(pcFileName != NULL)
+	{
+		OS_FreeRTOS_CrashPrint(&len, "location: %s:%lu\n", pcFileName, ulLine);
+	}
+	OS_FreeRTOS_CrashPrint(&len, "tick: %lu  time: %llu ns\n",
+			(unsigned long) xTaskGetTickCount(), (unsigned long long) OS_GetMonotonicNsec());
+
+	task = xTaskGetCurrentTaskHandle();
+	if(xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED && task != NULL)
+	{
+		OS_FreeRTOS_CrashPrint(&len, "task: %s  OSAL id: 0x%lx\n", pcTaskGetName(task),
+				(unsigned long)(uintptr_t) pvTaskGetThreadLocalStoragePointer(task, 0));
+	}
+
+	if(pcFileName == NULL)
+	{
+		/* The hook runs in the failing task after the heap has been released again */
+		OS_FreeRTOS_CrashPrint(&len, "request: %lu bytes, with block header and alignment\n", (unsigned long) OS_heap_failed_size);
+		if(OS_HeapGetStats(&heap_stats) == OS_SUCCESS)
+		{
+			OS_FreeRTOS_CrashPrint(&len, "heap: free %lu  min free %lu  largest free %lu  free blocks %lu  allocs %lu  frees %lu\n",
+					(unsigned long) heap_stats.free_bytes, (unsigned long) heap_stats.min_free_bytes,
+					(unsigned long) heap_stats.largest_free_block, (unsigned long) heap_stats.free_blocks,
+					(unsigned long) heap_stats.alloc_count, (unsigned long) heap_stats.free_count);
+			for(i = 0; i < OS_HEAP_CATEGORY_COUNT; ++i)
+			{
+				OS_FreeRTOS_CrashPrint(&len, "  category %lu: %lu bytes\n", (unsigned long) i, (unsigned long) heap_stats.category_bytes[i]);
+			}
+		}
+	}
+	else
+	{
+		OS_FreeRTOS_CrashPrint(&len, "heap: free %lu  min free %lu\n",
+				(unsigned long) xPortGetFreeHeapSize(), (unsigned long) xPortGetMinimumEverFreeHeapSize());
+	}
+
+	first = (OS_heap_history_count > OS_FREERTOS_CRASH_HISTORY) ? OS_heap_history_count - OS_FREERTOS_CRASH_HISTORY : 0;
+	OS_FreeRTOS_CrashPrint(&len, "last %lu heap operations, oldest first:\n", (unsigned long)(OS_heap_history_count - first));
+	for(i = first; i < OS_heap_history_count; ++i)
+	{
+		entry = &OS_heap_history[i % OS_FREERTOS_CRASH_HISTORY];
+		OS_FreeRTOS_CrashPrint(&len, "  %10lu %-6s %8lu %p %s\n", (unsigned long) entry->tick,
+				entry->freed ? "free" : (entry->addr != NULL) ? "malloc" : "FAILED",
+				(unsigned long) entry->size, entry->addr, entry->task);
+	}
+
+	/* The console task may be the one that failed, so go straight to stdout */
+	fwrite(OS_crash_record_buffer, 1, len, stdout);
+	fflush(stdout);
+
+	if(OS_GetVolumeType(OS_FREERTOS_CRASH_RECORD_PATH) == FS_BASED)
+	{
+		file = CreateFileA(OS_FREERTOS_CRASH_RECORD_PATH, FILE_APPEND_DATA, FILE_SHARE_READ, NULL,
+				OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(file != INVALID_HANDLE_VALUE)
+		{
+			WriteFile(file, OS_crash_record_buffer, len, &written, NULL);
+			FlushFileBuffers(file);
+			CloseHandle(file);
+		}
+	}
+
+	InterlockedExchange(&OS_crash_record_busy, 0);
+} /* end OS_FreeRTOS_CrashRecord */
+
+#endif /* configFREERTOS_SIM_CRASH_RECORD */
+
+#if configFREERTOS_SIM_HEAP_ATTRIBUTION || configFREERTOS_SIM_CRASH_RECORD
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_HeapTraceMalloc
+ *
+ *  Purpose: traceMALLOC hook, see FreeRTOSConfig.h.
+ *           Records the allocation for the crash record and charges a new
+ *           block to the caller's category
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_HeapTraceMalloc(void *pvAddress, size_t xSize)
+{
+#if configFREERTOS_SIM_HEAP_ATTRIBUTION
+	uint32 category;
+	uint32 slot;
+#endif
+
+#if configFREERTOS_SIM_CRASH_RECORD
+	OS_FreeRTOS_HeapHistoryAdd(pvAddress, xSize, false);
+#endif
+
+#if configFREERTOS_SIM_HEAP_ATTRIBUTION
+	if(pvAddress == NULL)
+	{
+		return;
+	}
+
+	category = OS_FreeRTOS_HeapCategoryGet();
+	if(category == OS_HEAP_CATEGORY_OTHER || category >= OS_HEAP_CATEGORY_COUNT)
+	{
+		return;
+	}
+
+	/* Keep the table at most 3/4 full so probes stay short; the rest counts as other */
+	if(OS_heap_track_count >= (OS_FREERTOS_HEAP_TRACK_SLOTS / 4) * 3)
+	{
+		return;
+	}
+
+	slot = OS_FreeRTOS_HeapTrackSlot(pvAddress);
+	while(OS_heap_track_addr[slot] != NULL)
+	{
+		slot = (slot + 1) & (OS_FREERTOS_HEAP_TRACK_SLOTS - 1);
+	}
+
+	OS_heap_track_addr[slot] = pvAddress;
+	OS_heap_track_size[slot] = (uint32) xSize;
+	OS_heap_track_category[slot] = (uint8) category;
+	++OS_heap_track_count;
+	OS_heap_category_bytes[category] += (uint32) xSize;
+#endif
+} /* end OS_FreeRTOS_HeapTraceMalloc */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_HeapTraceFree
+ *
+ *  Purpose: traceFREE hook, see FreeRTOSConfig.h.
+ *           Records the free for the crash record and removes the block
+ *           from the tracking table if it was charged
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_HeapTraceFree(void *pvAddress, size_t xSize)
+{
+#if configFREERTOS_SIM_HEAP_ATTRIBUTION
+	uint32 hole;
+	uint32 slot;
+	uint32 home;
+#endif
+
+#if configFREERTOS_SIM_CRASH_RECORD
+	OS_FreeRTOS_HeapHistoryAdd(pvAddress, xSize, true);
+#endif
+
+#if configFREERTOS_SIM_HEAP_ATTRIBUTION
+	hole = OS_FreeRTOS_HeapTrackSlot(pvAddress);
+	while(OS_heap_track_addr[hole] != pvAddress)
+	{
+		if(OS_heap_track_addr[hole] == NULL)
+		{
+			/* Not charged to any category */
+			return;
+		}
+		hole = (hole + 1) & (OS_FREERTOS_HEAP_TRACK_SLOTS - 1);
+	}
+
+	/* The size recorded at allocation time, in case the block was not split exactly */
+	OS_heap_category_bytes[OS_heap_track_category[hole]] -= OS_heap_track_size[hole];
+	--OS_heap_track_count;
+
+	/*
+	 * Close the hole: move back every following entry of the same probe run
+	 * whose home slot does not lie cyclically between the hole and itself.
+	 */
+	slot = hole;
+	for(;;)
+	{
+		slot = (slot + 1) & (OS_FREERTOS_HEAP_TRACK_SLOTS - 1);
+		if(OS_heap_track_addr[slot] == NULL)
+		{
+			break;
+		}
+
+		home = OS_FreeRTOS_HeapTrackSlot(OS_heap_track_addr[slot]);
+		if(((slot - home) & (OS_FREERTOS_HEAP_TRACK_SLOTS - 1)) >= ((slot - hole) & (OS_FREERTOS_HEAP_TRACK_SLOTS - 1)))
+		{
+			OS_heap_track_addr[hole] = OS_heap_track_addr[slot];
+			OS_heap_track_size[hole] = OS_heap_track_size[slot];
+			OS_heap_track_category[hole] = OS_heap_track_category[slot];
+			hole = slot;
+		}
+	}
+
+	OS_heap_track_addr[hole] = NULL;
+#else
+	(void) pvAddress;
+	(void) xSize;
+#endif
+} /* end OS_FreeRTOS_HeapTraceFree */
+
+#endif /* configFREERTOS_SIM_HEAP_ATTRIBUTION || configFREERTOS_SIM_CRASH_RECORD */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_HeapCategorySet
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Sets the category the calling task's heap allocations are charged
+ *           to and returns the previous one, so a create call can be wrapped
+ *           and the caller's category restored afterwards.
+ *
+ *-----------------------------------------------------------------*/
+uint32 OS_FreeRTOS_HeapCategorySet(uint32 category)
+{
+#if configFREERTOS_SIM_HEAP_ATTRIBUTION
+	uint32 previous = OS_FreeRTOS_HeapCategoryGet();
+
+	if(xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED)
+	{
+		OS_heap_category_startup = category;
+	}
+	else
+	{
+		vTaskSetThreadLocalStoragePointer(NULL, OS_FREERTOS_TLS_HEAP_CATEGORY, (void *)(uintptr_t) category);
+	}
+
+	return previous;
+#else
+	return OS_HEAP_CATEGORY_OTHER;
+#endif
+} /* end OS_FreeRTOS_HeapCategorySet */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HeapGetStats
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_HeapGetStats(OS_heap_stats_t *heap_stats)
+{
+#if OS_FREERTOS_HEAP_STATS
+	HeapStats_t stats;
+#endif
+	uint32 used;
+#if configFREERTOS_SIM_HEAP_ATTRIBUTION
+	uint32 i;
+#endif
+
+	if(heap_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(heap_stats, 0, sizeof(OS_heap_stats_t));
+
+#if OS_FREERTOS_HEAP_STATS
+	/* Walks the free list with the scheduler suspended */
+	vPortGetHeapStats(&stats);
+
+	heap_stats->free_bytes = (uint32) stats.xAvailableHeapSpaceInBytes;
+	heap_stats->free_blocks = (uint32) stats.xNumberOfFreeBlocks;
+	heap_stats->largest_free_block = (uint32) stats.xSizeOfLargestFreeBlockInBytes;
+	heap_stats->smallest_free_block = (uint32) stats.xSizeOfSmallestFreeBlockInBytes;
+	heap_stats->min_free_bytes = (uint32) stats.xMinimumEverFreeBytesRemaining;
+	heap_stats->alloc_count = (uint32) stats.xNumberOfSuccessfulAllocations;
+	heap_stats->free_count = (uint32) stats.xNumberOfSuccessfulFrees;
+#else
+	/* The block and allocation figures stay 0 */
+	heap_stats->free_bytes = (uint32) xPortGetFreeHeapSize();
+	heap_stats->min_free_bytes = (uint32) xPortGetMinimumEverFreeHeapSize();
+#endif
+
+	used = (uint32) configTOTAL_HEAP_SIZE - heap_stats->free_bytes;
+
+#if configFREERTOS_SIM_HEAP_ATTRIBUTION
+	vTaskSuspendAll();
+	for(i = 0; i < OS_HEAP_CATEGORY_COUNT; ++i)
+	{
+		heap_stats->category_bytes[i] = OS_heap_category_bytes[i];
+	}
+	(void) xTaskResumeAll();
+
+	for(i = 1; i < OS_HEAP_CATEGORY_COUNT; ++i)
+	{
+		if(heap_stats->category_bytes[i] > used)
+		{
+			used = 0;
+		}
+		else
+		{
+			used -= heap_stats->category_bytes[i];
+		}
+	}
+#endif
+
+	heap_stats->category_bytes[OS_HEAP_CATEGORY_OTHER] = used;
+
+	return OS_SUCCESS;
+} /* end OS_HeapGetStats */
+
+/****************************************************************************************
+ CONSOLE OUTPUT
+ ****************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Console_RingClaim
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Claims the next free slot of a console ring for a producer.
+ *
+ *           The console rings are bounded multi-producer queues of fixed
+ *           size slots, each starting with its sequence number.  A slot at
+ *           position pos is free when its sequence equals pos and filled
+ *           when it equals pos + 1.  A producer claims a slot by advancing
+ *           the head with a compare-exchange, so no lock is ever held and a
+ *           producer can only be held up by losing the compare-exchange to
+ *           another producer that made progress.
+ *
+ *           Returns the slot, or NULL if the ring is full.
+ *
+ *-----------------------------------------------------------------*/
+static void *OS_Console_RingClaim(volatile LONG *head, void *base, uint32 stride, uint32 slots, LONG *pos_out)
+{
+	volatile LONG *seq;
+	LONG pos;
+	LONG diff;
+
+	pos = *head;
+	while(true)
+	{
+		seq = (volatile LONG *)((uint8 *)base + (pos & (slots - 1)) * stride);
+		diff = (LONG)((ULONG)*seq - (ULONG)pos);
+
+		if(diff == 0)
+		{
+			/* slot is free on this lap, try to claim it */
+			if(InterlockedCompareExchange(head, (LONG)((ULONG)pos + 1), pos) == pos)
+			{
+				break;
+			}
+		}
+		else if(diff < 0)
+		{
+			/* the consumer has not drained this slot from the previous lap, the ring is full */
+			return NULL;
+		}
+
+		/* another producer claimed it first */
+		pos = *head;
+	}
+
+	*pos_out = pos;
+	return (void *)seq;
+} /* end OS_Console_RingClaim */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Console_RingPeek
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns the filled slot at the tail of a console ring, or NULL
+ *           if it is empty or its producer has not finished copying yet.
+ *           Only the single consumer of the ring may call this.
+ *
+ *-----------------------------------------------------------------*/
+static void *OS_Console_RingPeek(LONG tail, void *base, uint32 stride, uint32 slots)
+{
+	volatile LONG *seq;
+
+	seq = (volatile LONG *)((uint8 *)base + (tail & (slots - 1)) * stride);
+	if(*seq != (LONG)((ULONG)tail + 1))
+	{
+		return NULL;
+	}
+
+	return (void *)seq;
+} /* end OS_Console_RingPeek */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleSink_Distribute
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Copies a batch of console output into the ring of every open
+ *           sink and wakes the sink tasks.  Whatever does not fit in a ring
+ *           is counted as dropped for that sink.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_ConsoleSink_Distribute(const char *data, uint32 size)
+{
+	OS_impl_console_sink_t *sink;
+	uint32 i;
+	uint32 space;
+	uint32 copied;
+	uint32 chunk;
+	uint32 off;
+	LONG head;
+
+	xSemaphoreTake(OS_impl_console_sink_mutex, portMAX_DELAY);
+
+	for(i = 0; i < OS_FREERTOS_CONSOLE_MAX_SINKS; i++)
+	{
+		sink = &OS_impl_console_sinks[i];
+		if(sink->type == 0 || sink->closing)
+		{
+			continue;
+		}
+
+		head = sink->head;
+		space = OS_FREERTOS_CONSOLE_SINK_BUFFER - (uint32)((ULONG)head - (ULONG)sink->tail);
+		if(space > size)
+		{
+			space = size;
+		}
+
+		copied = 0;
+		while(copied < space)
+		{
+			off = (ULONG)head & (OS_FREERTOS_CONSOLE_SINK_BUFFER - 1);
+			chunk = OS_FREERTOS_CONSOLE_SINK_BUFFER - off;
+			if(chunk > space - copied)
+			{
+				chunk = space - copied;
+			}
+
+			memcpy(&sink->buffer[off], &data[copied], chunk);
+			copied += chunk;
+			head = (LONG)((ULONG)head + chunk);
+		}
+
+		InterlockedExchange(&sink->head, head);
+		if(copied < size)
+		{
+			InterlockedExchangeAdd(&sink->dropped, (LONG)(size - copied));
+		}
+
+		xSemaphoreGive(sink->wake);
+	}
+
+	xSemaphoreGive(OS_impl_console_sink_mutex);
+} /* end OS_ConsoleSink_Distribute */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Console_Flush
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Writes out the staged console text with as few write()
+ *           calls as the descriptor allows.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Console_Flush(OS_impl_console_internal_record_t *local)
+{
+	uint32 done;
+	long WriteSize;
+
+	if(local->stage_len > 0 && OS_impl_console_sink_mutex != NULL)
+	{
+		OS_ConsoleSink_Distribute(local->stage, local->stage_len);
+	}
+
+	if(!local->stdout_enabled)
+	{
+		local->stage_len = 0;
+		return;
+	}
+
+	done = 0;
+	while(done < local->stage_len)
+	{
+		WriteSize = write(local->out_fd, &local->stage[done], local->stage_len - done);
+
+		if(WriteSize <= 0)
+		{
+			/* write error, the rest of the staged text is dropped */
+			/* This debug message _might_ go to the same console,
+			 * but might not, so its worth a shot. */
+			OS_DEBUG("%s(): write(): %s\n", __func__, strerror(errno));
+			break;
+		}
+
+		done += WriteSize;
+	}
+
+	if(local->stage_len > 0)
+	{
+		taskENTER_CRITICAL();
+		++local->write_count;
+		local->byte_count += done;
+		taskEXIT_CRITICAL();
+	}
+
+	local->stage_len = 0;
+} /* end OS_Console_Flush */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Console_Stage
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Appends text to the staging buffer, flushing it whenever
+ *           it fills up.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Console_Stage(OS_impl_console_internal_record_t *local, const char *data, uint32 size)
+{
+	uint32 chunk;
+
+	while(size > 0)
+	{
+		chunk = sizeof(local->stage) - local->stage_len;
+		if(chunk > size)
+		{
+			chunk = size;
+		}
+
+		memcpy(&local->stage[local->stage_len], data, chunk);
+		local->stage_len += chunk;
+		data += chunk;
+		size -= chunk;
+
+		if(local->stage_len >= sizeof(local->stage))
+		{
+			OS_Console_Flush(local);
+		}
+	}
+} /* end OS_Console_Stage */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Console_FormatLog
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Formats a binary log record into a line of text.  Records
+ *           with a registered format are printed with it, the arguments
+ *           passed as uint32 values; others are dumped in hex.
+ *
+ *           Returns the length of the line.
+ *
+ *-----------------------------------------------------------------*/
+static uint32 OS_Console_FormatLog(const OS_console_log_record_t *record, char *line, uint32 size)
+{
+	const char *format;
+	const uint32 *a = record->args;
+	int len;
+	uint32 i;
+
+	format = NULL;
+	if(record->format_id < OS_FREERTOS_CONSOLE_LOG_FORMATS)
+	{
+		format = OS_impl_console_log_formats[record->format_id];
+	}
+
+	if(format != NULL)
+	{
+		len = snprintf(line, size, format, a[0], a[1], a[2], a[3], a[4], a[5]);
+	}
+	else
+	{
+		len = snprintf(line, size, "LOG %u task 0x%lx @%llu:", (unsigned int)record->format_id,
+				(unsigned long)record->task_id, (unsigned long long)record->timestamp_nsec);
+		for(i = 0; i < record->arg_count && len >= 0 && len < (int)size; i++)
+		{
+			len += snprintf(&line[len], size - len, " 0x%lx", (unsigned long)a[i]);
+		}
+		if(len >= 0 && len < (int)size)
+		{
+			len += snprintf(&line[len], size - len, "\n");
+		}
+	}
+
+	if(len < 0)
+	{
+		len = 0;
+	}
+	else if(len >= (int)size)
+	{
+		/* truncated by snprintf, keep the terminator out of the output */
+		len = size - 1;
+	}
+
+	return len;
+} /* end OS_Console_FormatLog */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleOutput_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *           Both the OSAL console buffer and the fast ring filled by
+ *           OS_ConsoleWriteFast are gathered into the staging buffer,
+ *           so a burst of short messages becomes a single write().
+ *
+ *-----------------------------------------------------------------*/
+void  OS_ConsoleOutput_Impl(uint32 local_id)
+{
+    uint32 StartPos;
+    uint32 EndPos;
+    uint32 CopySize;
+    OS_console_internal_record_t *console;
+    OS_impl_console_internal_record_t *local;
+    OS_impl_console_slot_t *slot;
+#ifndef OS_FREERTOS_CONSOLE_LOG_OFFLINE
+    OS_impl_console_log_slot_t *log_slot;
+    char line[OS_CONSOLE_LOG_LINE_SIZE];
+#endif
+
+    console = &OS_console_table[local_id];
+    local = &OS_impl_console_table[local_id];
+    StartPos = console->ReadPos;
+    EndPos = console->WritePos;
+    while(StartPos != EndPos)
+    {
+        if(StartPos > EndPos)
+        {
+            /* handle wrap */
+            CopySize = console->BufSize - StartPos;
+        }
+        else
+        {
+            CopySize = EndPos - StartPos;
+        }
+
+        OS_Console_Stage(local, &console->BufBase[StartPos], CopySize);
+
+        StartPos += CopySize;
+        if(StartPos >= console->BufSize)
+        {
+            /* handle wrap */
+            StartPos = 0;
+        }
+
+        /* The text is staged, so the space can go back to the producers */
+        console->ReadPos = StartPos;
+    }
+
+    if(local->fast_ready)
+    {
+        while((slot = OS_Console_RingPeek(local->fast_tail, local->fast_ring,
+                sizeof(OS_impl_console_slot_t), OS_FREERTOS_CONSOLE_FAST_SLOTS)) != NULL)
+        {
+            OS_Console_Stage(local, slot->text, slot->len);
+
+            /* hand the slot back for the next lap of the ring */
+            InterlockedExchange(&slot->seq, (LONG)((ULONG)local->fast_tail + OS_FREERTOS_CONSOLE_FAST_SLOTS));
+            local->fast_tail = (LONG)((ULONG)local->fast_tail + 1);
+        }
+
+#ifndef OS_FREERTOS_CONSOLE_LOG_OFFLINE
+        while((log_slot = OS_Console_RingPeek(local->log_tail, local->log_ring,
+                sizeof(OS_impl_console_log_slot_t), OS_FREERTOS_CONSOLE_LOG_SLOTS)) != NULL)
+        {
+            OS_Console_Stage(local, line, OS_Console_FormatLog(&log_slot->record, line, sizeof(line)));
+
+            InterlockedExchange(&log_slot->seq, (LONG)((ULONG)local->log_tail + OS_FREERTOS_CONSOLE_LOG_SLOTS));
+            local->log_tail = (LONG)((ULONG)local->log_tail + 1);
+        }
+#endif
+    }
+
+    OS_Console_Flush(local);
+} /* end OS_ConsoleOutput_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Console_ResetRing
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Console_ResetRing(OS_impl_console_internal_record_t *local)
+{
+	uint32 i;
+
+	local->fast_ready = false;
+	local->stdout_enabled = true;
+	local->fast_head = 0;
+	local->fast_tail = 0;
+	local->fast_count = 0;
+	local->overflow_count = 0;
+	local->truncated_count = 0;
+	local->write_count = 0;
+	local->byte_count = 0;
+	local->stage_len = 0;
+
+	for(i = 0; i < OS_FREERTOS_CONSOLE_FAST_SLOTS; i++)
+	{
+		local->fast_ring[i].seq = (LONG)i;
+		local->fast_ring[i].len = 0;
+	}
+
+	local->log_head = 0;
+	local->log_tail = 0;
+	local->log_count = 0;
+	local->log_overflow_count = 0;
+
+	for(i = 0; i < OS_FREERTOS_CONSOLE_LOG_SLOTS; i++)
+	{
+		local->log_ring[i].seq = (LONG)i;
+	}
+} /* end OS_Console_ResetRing */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Console_Notify
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Wakes the console task if it is not already due to run.
+ *           Only the first wakeup after the task starts a drain sends a
+ *           notification; the messages queued after it are picked up by
+ *           that same drain.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Console_Notify(OS_impl_console_internal_record_t *local)
+{
+	if(InterlockedExchange(&local->wake_pending, 1) == 0)
+	{
+		xTaskNotifyGive(local->task);
+	}
+} /* end OS_Console_Notify */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleWakeup_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+void  OS_ConsoleWakeup_Impl(uint32 local_id)
+{
+	OS_impl_console_internal_record_t *local = &OS_impl_console_table[local_id];
+
+	if(local->is_async)
+	{
+		/* notify the utility task to run */
+		OS_Console_Notify(local);
+	}
+	else
+	{
+		/* output directly */
+		OS_ConsoleOutput_Impl(local_id);
+	}
+}/* end OS_ConsoleWakeup_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleTask_Entry
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_ConsoleTask_Entry(int arg)
+{
+    uint32 local_id = arg;
+	OS_impl_console_internal_record_t *local;
+
+	local = &OS_impl_console_table[local_id];
+	while(true)
+	{
+		/* Clear the flag before draining, so anything queued from here on sends a new notification */
+		InterlockedExchange(&local->wake_pending, 0);
+		OS_ConsoleOutput_Impl(local_id);
+
+		ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+		++local->wake_count;
+
+#if OS_FREERTOS_CONSOLE_FLUSH_MSEC > 0
+		/* let the burst that caused the wakeup build up into one batch */
+		vTaskDelay(pdMS_TO_TICKS(OS_FREERTOS_CONSOLE_FLUSH_MSEC));
+#endif
+	}
+} /* end OS_ConsoleTask_Entry */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleCreate_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ConsoleCreate_Impl(uint32 local_id)
+{
+	OS_impl_console_internal_record_t *local = &OS_impl_console_table[local_id];
+	int32 return_code = -1;
+
+	if(local_id == 0)
+	{
+		return_code = OS_SUCCESS;
+		local->is_async = OS_CONSOLE_ASYNC;
+		local->out_fd = OSAL_CONSOLE_FILENO;
+		OS_Console_ResetRing(local);
+
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+		OS_impl_console_sink_mutex = xSemaphoreCreateMutexStatic(&OS_impl_console_sink_mutex_cb);
+#else
+		OS_impl_console_sink_mutex = xSemaphoreCreateMutex();
+#endif
+
+		if(local->is_async)
+		{
+			BaseType_t status;
+
+			/* The task drains on its first pass, so it must not see itself as already notified */
+			local->wake_pending = 1;
+			local->wake_count = 0;
+			status = xTaskCreate((TaskFunction_t) OS_ConsoleTask_Entry,
+					NULL,
+					OS_CONSOLE_TASK_STACKSIZE,
+					(void *)local_id,
+					OS_CONSOLE_TASK_PRIORITY,
+					&local->task);
+
+			if(status != pdPASS)
+			{
+				local->task = NULL;
+				return_code = OS_ERROR;
+			}
+		}
+	}
+	else
+	{
+		/* only one physical console device is implemented */
+		return_code = OS_ERR_NOT_IMPLEMENTED;
+	}
+
+	if(return_code == OS_SUCCESS)
+	{
+		local->fast_ready = true;
+	}
+
+	return return_code;
+}/* end OS_ConsoleCreate_Impl */
+
+/****************************************************************************************
+ CONSOLE EXTENSION API
+ ****************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleWriteFast
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ConsoleWriteFast(const char *text, uint32 size)
+{
+	OS_impl_console_internal_record_t *local = &OS_impl_console_table[0];
+	OS_impl_console_slot_t *slot;
+	LONG pos;
+
+	if(text == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	if(!local->fast_ready)
+	{
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	if(!local->is_async)
+	{
+		/* no console task to drain the ring, output directly */
+		if(size > 0 && write(local->out_fd, text, size) <= 0)
+		{
+			return OS_ERROR;
+		}
+		return OS_SUCCESS;
+	}
+
+	if(size > OS_CONSOLE_SLOT_TEXT_SIZE)
+	{
+		size = OS_CONSOLE_SLOT_TEXT_SIZE;
+		InterlockedIncrement(&local->truncated_count);
+	}
+
+	slot = OS_Console_RingClaim(&local->fast_head, local->fast_ring,
+			sizeof(OS_impl_console_slot_t), OS_FREERTOS_CONSOLE_FAST_SLOTS, &pos);
+	if(slot == NULL)
+	{
+		InterlockedIncrement(&local->overflow_count);
+		return OS_QUEUE_FULL;
+	}
+
+	memcpy(slot->text, text, size);
+	slot->len = size;
+	InterlockedExchange(&slot->seq, (LONG)((ULONG)pos + 1));
+	InterlockedIncrement(&local->fast_count);
+
+	OS_Console_Notify(local);
+
+	return OS_SUCCESS;
+} /* end OS_ConsoleWriteFast */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleGetStats
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ConsoleGetStats(OS_console_stats_t *console_stats)
+{
+	OS_impl_console_internal_record_t *local = &OS_impl_console_table[0];
+
+	if(console_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(console_stats, 0, sizeof(OS_console_stats_t));
+
+	if(!local->fast_ready)
+	{
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	console_stats->fast_count = local->fast_count;
+	console_stats->overflow_count = local->overflow_count;
+	console_stats->truncated_count = local->truncated_count;
+	console_stats->log_count = local->log_count;
+	console_stats->log_overflow_count = local->log_overflow_count;
+
+	taskENTER_CRITICAL();
+	console_stats->write_count = local->write_count;
+	console_stats->wake_count = local->wake_count;
+	console_stats->byte_count = local->byte_count;
+	taskEXIT_CRITICAL();
+
+	return OS_SUCCESS;
+} /* end OS_ConsoleGetStats */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleLog
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ConsoleLog(uint16 format_id, uint32 arg_count, const uint32 *args)
+{
+	OS_impl_console_internal_record_t *local = &OS_impl_console_table[0];
+	OS_impl_console_log_slot_t *slot;
+	OS_console_log_record_t record;
+#ifndef OS_FREERTOS_CONSOLE_LOG_OFFLINE
+	char line[OS_CONSOLE_LOG_LINE_SIZE];
+#endif
+	LONG pos;
+
+	if(args == NULL && arg_count > 0)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	if(arg_count > OS_CONSOLE_LOG_MAX_ARGS)
+	{
+		return OS_ERROR;
+	}
+
+	if(!local->fast_ready)
+	{
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	memset(&record, 0, sizeof(record));
+	record.timestamp_nsec = OS_GetMonotonicNsec();
+	record.task_id = OS_TaskGetId_Impl();
+	if((int32)record.task_id < 0)
+	{
+		/* logged before the scheduler started */
+		record.task_id = 0;
+	}
+	record.format_id = format_id;
+	record.arg_count = arg_count;
+	if(arg_count > 0)
+	{
+		memcpy(record.args, args, arg_count * sizeof(uint32));
+	}
+
+#ifndef OS_FREERTOS_CONSOLE_LOG_OFFLINE
+	if(!local->is_async)
+	{
+		/* no console task to drain the ring, format and output directly */
+		if(write(local->out_fd, line, OS_Console_FormatLog(&record, line, sizeof(line))) < 0)
+		{
+			return OS_ERROR;
+		}
+		return OS_SUCCESS;
+	}
+#endif
+
+	/*
+	 ** With OS_FREERTOS_CONSOLE_LOG_OFFLINE every record goes to the ring,
+	 ** whether or not there is a console task, since the application
+	 ** reads them back with OS_ConsoleLogRead.
+	 */
+	slot = OS_Console_RingClaim(&local->log_head, local->log_ring,
+			sizeof(OS_impl_console_log_slot_t), OS_FREERTOS_CONSOLE_LOG_SLOTS, &pos);
+	if(slot == NULL)
+	{
+		InterlockedIncrement(&local->log_overflow_count);
+		return OS_QUEUE_FULL;
+	}
+
+	slot->record = record;
+	InterlockedExchange(&slot->seq, (LONG)((ULONG)pos + 1));
+	InterlockedIncrement(&local->log_count);
+
+#ifndef OS_FREERTOS_CONSOLE_LOG_OFFLINE
+	OS_Console_Notify(local);
+#endif
+
+	return OS_SUCCESS;
+} /* end OS_ConsoleLog */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleLogRegisterFormat
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ConsoleLogRegisterFormat(uint16 format_id, const char *format)
+{
+	if(format_id >= OS_FREERTOS_CONSOLE_LOG_FORMATS)
+	{
+		return OS_ERROR;
+	}
+
+	/* a single pointer store, the console task sees either the old or the new format */
+	OS_impl_console_log_formats[format_id] = format;
+
+	return OS_SUCCESS;
+} /* end OS_ConsoleLogRegisterFormat */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleLogRead
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ConsoleLogRead(OS_console_log_record_t *records, uint32 max_records, uint32 *count)
+{
+#ifdef OS_FREERTOS_CONSOLE_LOG_OFFLINE
+	OS_impl_console_internal_record_t *local = &OS_impl_console_table[0];
+	OS_impl_console_log_slot_t *slot;
+	uint32 n;
+
+	if(records == NULL || count == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*count = 0;
+
+	if(!local->fast_ready)
+	{
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	n = 0;
+	while(n < max_records && (slot = OS_Console_RingPeek(local->log_tail, local->log_ring,
+			sizeof(OS_impl_console_log_slot_t), OS_FREERTOS_CONSOLE_LOG_SLOTS)) != NULL)
+	{
+		records[n] = slot->record;
+		++n;
+
+		InterlockedExchange(&slot->seq, (LONG)((ULONG)local->log_tail + OS_FREERTOS_CONSOLE_LOG_SLOTS));
+		local->log_tail = (LONG)((ULONG)local->log_tail + 1);
+	}
+
+	*count = n;
+
+	return OS_SUCCESS;
+#else
+	/* the console task is the reader of the ring */
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_ConsoleLogRead */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleSink_Emit
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Writes a contiguous piece of the sink ring to the sink device.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_ConsoleSink_Emit(OS_impl_console_sink_t *sink, const char *data, uint32 size)
+{
+	OS_console_shm_header_t *view;
+	char *text;
+	uint32 chunk;
+	uint32 off;
+	uint64 written;
+
+	switch(sink->type)
+	{
+	case OS_CONSOLE_SINK_FILE:
+		if(fwrite(data, 1, size, sink->fp) != size)
+		{
+			InterlockedExchangeAdd(&sink->dropped, (LONG)size);
+		}
+		break;
+
+#ifdef OS_INCLUDE_NETWORK
+	case OS_CONSOLE_SINK_UDP:
+		while(size > 0)
+		{
+			chunk = (size > OS_CONSOLE_SINK_UDP_CHUNK) ? OS_CONSOLE_SINK_UDP_CHUNK : size;
+			if(FreeRTOS_sendto(sink->sock, data, chunk, 0, &sink->addr, sizeof(sink->addr)) <= 0)
 			{
-				BaseType_t status;
-				status = xTaskCreate((TaskFunction_t) OS_ConsoleTask_Entry,
-						NULL,
-						OS_CONSOLE_TASK_STACKSIZE,
-						(void *)local_id,
-						OS_CONSOLE_TASK_PRIORITY,
-						&consoletask);
-
-				if(status != pdPASS)
-				{
-					vSemaphoreDelete(local->data_sem);
-					local->data_sem = 0;
-					return_code = OS_ERROR;
-				}
+				/* no network buffer or no route, the datagram is lost either way */
+				InterlockedExchangeAdd(&sink->dropped, (LONG)chunk);
+			}
+			data += chunk;
+			size -= chunk;
+		}
+		break;
+#endif
+
+	case OS_CONSOLE_SINK_SHM:
+		/* The viewer only ever reads, old text is simply overwritten */
+		view = sink->view;
+		text = (char *)(view + 1);
+		written = view->written;
+		while(size > 0)
+		{
+			off = (uint32)(written % view->size);
+			chunk = view->size - off;
+			if(chunk > size)
+			{
+				chunk = size;
+			}
+
+			memcpy(&text[off], data, chunk);
+			data += chunk;
+			size -= chunk;
+			written += chunk;
+		}
+		InterlockedExchange64((volatile LONG64 *)&view->written, (LONG64)written);
+		break;
+
+	default:
+		break;
+	}
+} /* end OS_ConsoleSink_Emit */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleSink_Entry
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Drain task of one console sink.  Closes the device and frees
+ *           the entry once the sink is removed.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_ConsoleSink_Entry(void *arg)
+{
+	OS_impl_console_sink_t *sink = &OS_impl_console_sinks[(uint32)arg];
+	uint32 off;
+	uint32 chunk;
+	LONG tail;
+	LONG head;
+	bool closing;
+
+	do
+	{
+		xSemaphoreTake(sink->wake, portMAX_DELAY);
+		closing = sink->closing;
+
+		tail = sink->tail;
+		head = sink->head;
+		while(tail != head)
+		{
+			off = (ULONG)tail & (OS_FREERTOS_CONSOLE_SINK_BUFFER - 1);
+			chunk = OS_FREERTOS_CONSOLE_SINK_BUFFER - off;
+			if(chunk > (uint32)((ULONG)head - (ULONG)tail))
+			{
+				chunk = (ULONG)head - (ULONG)tail;
+			}
+
+			OS_ConsoleSink_Emit(sink, &sink->buffer[off], chunk);
+			tail = (LONG)((ULONG)tail + chunk);
+			InterlockedExchange(&sink->tail, tail);
+		}
+
+		if(sink->type == OS_CONSOLE_SINK_FILE)
+		{
+			/* the file is written in batches, one flush per batch */
+			fflush(sink->fp);
+		}
+	}
+	while(!closing);
+
+	switch(sink->type)
+	{
+	case OS_CONSOLE_SINK_FILE:
+		fclose(sink->fp);
+		sink->fp = NULL;
+		break;
+#ifdef OS_INCLUDE_NETWORK
+	case OS_CONSOLE_SINK_UDP:
+		FreeRTOS_closesocket(sink->sock);
+		sink->sock = NULL;
+		break;
+#endif
+	case OS_CONSOLE_SINK_SHM:
+		UnmapViewOfFile(sink->view);
+		CloseHandle(sink->map);
+		sink->view = NULL;
+		sink->map = NULL;
+		break;
+	default:
+		break;
+	}
+
+	xSemaphoreTake(OS_impl_console_sink_mutex, portMAX_DELAY);
+	sink->type = 0;
+	xSemaphoreGive(OS_impl_console_sink_mutex);
+
+	vTaskDelete(NULL);
+} /* end OS_ConsoleSink_Entry */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleSink_Open
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Opens the device of a new sink.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_ConsoleSink_Open(OS_impl_console_sink_t *sink, uint32 sink_type, const char *target)
+{
+	char local_path[OS_MAX_LOCAL_PATH_LEN];
+#ifdef OS_INCLUDE_NETWORK
+	char host[16];
+	const char *colon;
+	uint32 port;
+	uint32 len;
+#endif
+	int32 status;
+
+	switch(sink_type)
+	{
+	case OS_CONSOLE_SINK_FILE:
+		status = OS_TranslatePath(target, local_path);
+		if(status != OS_SUCCESS)
+		{
+			return status;
+		}
+
+		sink->fp = fopen(local_path, "ab");
+		if(sink->fp == NULL)
+		{
+			OS_DEBUG("%s(): fopen(%s): %s\n", __func__, local_path, strerror(errno));
+			return OS_ERROR;
+		}
+		return OS_SUCCESS;
+
+#ifdef OS_INCLUDE_NETWORK
+	case OS_CONSOLE_SINK_UDP:
+		/* "a.b.c.d" or "a.b.c.d:port" */
+		port = configPRINT_PORT;
+		colon = strchr(target, ':');
+		len = (colon != NULL) ? (uint32)(colon - target) : strlen(target);
+		if(len >= sizeof(host))
+		{
+			return OS_ERROR;
+		}
+		memcpy(host, target, len);
+		host[len] = 0;
+		if(colon != NULL)
+		{
+			port = strtoul(colon + 1, NULL, 10);
+		}
+
+		memset(&sink->addr, 0, sizeof(sink->addr));
+		sink->addr.sin_family = FREERTOS_AF_INET;
+		sink->addr.sin_addr = FreeRTOS_inet_addr(host);
+		sink->addr.sin_port = FreeRTOS_htons(port);
+		if(sink->addr.sin_addr == 0 || port == 0 || port > 0xFFFF)
+		{
+			return OS_ERROR;
+		}
+
+		sink->sock = FreeRTOS_socket(FREERTOS_AF_INET, FREERTOS_SOCK_DGRAM, FREERTOS_IPPROTO_UDP);
+		if(sink->sock == FREERTOS_INVALID_SOCKET)
+		{
+			sink->sock = NULL;
+			return OS_ERROR;
+		}
+		return OS_SUCCESS;
+#endif
+
+	case OS_CONSOLE_SINK_SHM:
+		sink->map = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0,
+				sizeof(OS_console_shm_header_t) + OS_FREERTOS_CONSOLE_SHM_SIZE, target);
+		if(sink->map == NULL)
+		{
+			return OS_ERROR;
+		}
+
+		sink->view = MapViewOfFile(sink->map, FILE_MAP_WRITE, 0, 0, 0);
+		if(sink->view == NULL)
+		{
+			CloseHandle(sink->map);
+			sink->map = NULL;
+			return OS_ERROR;
+		}
+
+		/* a viewer that attached before keeps following the new stream */
+		sink->view->size = OS_FREERTOS_CONSOLE_SHM_SIZE;
+		sink->view->written = 0;
+		InterlockedExchange((volatile LONG *)&sink->view->magic, OS_CONSOLE_SHM_MAGIC);
+		return OS_SUCCESS;
+
+	default:
+		return OS_ERR_NOT_IMPLEMENTED;
+	}
+} /* end OS_ConsoleSink_Open */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleSinkAdd
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ConsoleSinkAdd(uint32 sink_type, const char *target, uint32 *sink_id)
+{
+	OS_impl_console_sink_t *sink;
+	TaskHandle_t sinktask;
+	uint32 i;
+	int32 return_code;
+
+	if(target == NULL || sink_id == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	if(OS_impl_console_sink_mutex == NULL)
+	{
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	xSemaphoreTake(OS_impl_console_sink_mutex, portMAX_DELAY);
+
+	sink = NULL;
+	for(i = 0; i < OS_FREERTOS_CONSOLE_MAX_SINKS; i++)
+	{
+		if(OS_impl_console_sinks[i].type == 0)
+		{
+			sink = &OS_impl_console_sinks[i];
+			break;
+		}
+	}
+
+	if(sink == NULL)
+	{
+		return_code = OS_ERR_NO_FREE_IDS;
+	}
+	else
+	{
+		if(sink->wake == NULL)
+		{
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+			sink->wake = xSemaphoreCreateBinaryStatic(&sink->wake_cb);
+#else
+			sink->wake = xSemaphoreCreateBinary();
+#endif
+		}
+
+		return_code = (sink->wake != NULL) ? OS_ConsoleSink_Open(sink, sink_type, target) : OS_SEM_FAILURE;
+	}
+
+	if(return_code == OS_SUCCESS)
+	{
+		/* drain whatever a previous user of the entry left behind */
+		xSemaphoreTake(sink->wake, 0);
+		sink->head = 0;
+		sink->tail = 0;
+		sink->dropped = 0;
+		sink->closing = false;
+		sink->type = sink_type;
+
+		if(xTaskCreate((TaskFunction_t) OS_ConsoleSink_Entry,
+				"console sink",
+				OS_CONSOLE_TASK_STACKSIZE,
+				(void *)i,
+				OS_CONSOLE_TASK_PRIORITY,
+				&sinktask) != pdPASS)
+		{
+			/* no task to close it, undo the open here */
+			sink->type = 0;
+			if(sink->fp != NULL)
+			{
+				fclose(sink->fp);
+				sink->fp = NULL;
+			}
+#ifdef OS_INCLUDE_NETWORK
+			if(sink->sock != NULL)
+			{
+				FreeRTOS_closesocket(sink->sock);
+				sink->sock = NULL;
 			}
+#endif
+			if(sink->view != NULL)
+			{
+				UnmapViewOfFile(sink->view);
+				CloseHandle(sink->map);
+				sink->view = NULL;
+				sink->map = NULL;
+			}
+			return_code = OS_ERROR;
+		}
+		else
+		{
+			*sink_id = i;
 		}
 	}
+
+	xSemaphoreGive(OS_impl_console_sink_mutex);
+
+	return return_code;
+} /* end OS_ConsoleSinkAdd */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleSinkRemove
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ConsoleSinkRemove(uint32 sink_id)
+{
+	OS_impl_console_sink_t *sink;
+	int32 return_code;
+
+	if(sink_id >= OS_FREERTOS_CONSOLE_MAX_SINKS || OS_impl_console_sink_mutex == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	sink = &OS_impl_console_sinks[sink_id];
+
+	xSemaphoreTake(OS_impl_console_sink_mutex, portMAX_DELAY);
+
+	if(sink->type == 0 || sink->closing)
+	{
+		return_code = OS_ERR_INVALID_ID;
+	}
 	else
 	{
-		/* only one physical console device is implemented */
-		return_code = OS_ERR_NOT_IMPLEMENTED;
+		/* the sink task drains what is left, closes the device and frees the entry */
+		sink->closing = true;
+		xSemaphoreGive(sink->wake);
+		return_code = OS_SUCCESS;
 	}
 
+	xSemaphoreGive(OS_impl_console_sink_mutex);
+
 	return return_code;
-}/* end OS_ConsoleCreate_Impl */
+} /* end OS_ConsoleSinkRemove */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleSinkGetDropped
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ConsoleSinkGetDropped(uint32 sink_id, uint32 *dropped)
+{
+	if(dropped == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	if(sink_id >= OS_FREERTOS_CONSOLE_MAX_SINKS || OS_impl_console_sinks[sink_id].type == 0)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	*dropped = OS_impl_console_sinks[sink_id].dropped;
+
+	return OS_SUCCESS;
+} /* end OS_ConsoleSinkGetDropped */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ConsoleStdoutEnable
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ConsoleStdoutEnable(bool enable)
+{
+	if(!OS_impl_console_table[0].fast_ready)
+	{
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	OS_impl_console_table[0].stdout_enabled = enable;
+
+	return OS_SUCCESS;
+} /* end OS_ConsoleStdoutEnable */
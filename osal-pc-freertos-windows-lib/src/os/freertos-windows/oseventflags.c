@@ -0,0 +1,544 @@
+/*
+ *  NASA Docket No. GSC-18,370-1, and identified as "Operating System Abstraction Layer"
+ *
+ *  Copyright (c) 2019 United States Government as represented by
+ *  the Administrator of the National Aeronautics and Space Administration.
+ *  All Rights Reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * \file   oseventflags.c
+ *
+ * Purpose: This file contains the event flags, see OS_EventFlagsCreate
+ */
+
+/****************************************************************************************
+ INCLUDE FILES
+ ***************************************************************************************/
+
+#include <string.h>
+
+#include "os-FreeRTOS.h"
+#include "event_groups.h"
+
+/****************************************************************************************
+ GLOBAL DATA
+ ***************************************************************************************/
+
+/*
+ * An event flags object is a FreeRTOS event group.  The table lock is only
+ * held to create, delete and look up objects; setting, clearing and waiting
+ * go straight to the kernel, which keeps the flags and the waiters itself.
+ *
+ * Those calls hold a reference on the entry instead, counted in a critical
+ * section.  Delete marks the entry so no new reference is given out and
+ * keeps releasing waiters until the last reference is dropped.  The group
+ * always lives in the entry, so a late caller never touches freed memory.
+ */
+typedef struct
+{
+	bool               in_use;
+	bool               deleting;		/* OS_EventFlagsDelete is draining the references */
+	uint16             generation;		/* high bits of the id, see OS_FREERTOS_EXT_ID */
+	uint32             refcount;		/* calls using group, under a critical section */
+	EventGroupHandle_t group;
+	char               name[OS_MAX_API_NAME];
+	StaticEventGroup_t group_cb;
+} OS_impl_event_flags_t;
+
+static OS_impl_event_flags_t OS_impl_event_flags_table[OS_FREERTOS_MAX_EVENT_FLAGS];
+static SemaphoreHandle_t     OS_impl_event_flags_mut;
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+static StaticSemaphore_t     OS_impl_event_flags_mut_cb;
+#endif
+
+/****************************************************************************************
+ EVENT FLAGS EXTENSION API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_EventFlagsAPI_Impl_Init
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FreeRTOS_EventFlagsAPI_Impl_Init(void)
+{
+	memset(OS_impl_event_flags_table, 0, sizeof(OS_impl_event_flags_table));
+
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	OS_impl_event_flags_mut = xSemaphoreCreateMutexStatic(&OS_impl_event_flags_mut_cb);
+#else
+	OS_impl_event_flags_mut = xSemaphoreCreateMutex();
+#endif
+	if(OS_impl_event_flags_mut == NULL)
+	{
+		return OS_ERROR;
+	}
+
+	return OS_SUCCESS;
+} /* end OS_FreeRTOS_EventFlagsAPI_Impl_Init */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlags_Lookup
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns the live entry of an id, or NULL if there is none.
+ *           Called in a critical section or with the table lock held.
+ *
+ *-----------------------------------------------------------------*/
+static OS_impl_event_flags_t *OS_EventFlags_Lookup(uint32 flags_id)
+{
+	OS_impl_event_flags_t *local;
+	uint32 index = OS_FREERTOS_EXT_ID_INDEX(flags_id);
+
+	if(index >= OS_FREERTOS_MAX_EVENT_FLAGS)
+	{
+		return NULL;
+	}
+
+	local = &OS_impl_event_flags_table[index];
+	if(!local->in_use || local->deleting || local->generation != OS_FREERTOS_EXT_ID_GEN(flags_id))
+	{
+		return NULL;
+	}
+
+	return local;
+} /* end OS_EventFlags_Lookup */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlags_Acquire
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes a reference on the entry of an id, or returns NULL if
+ *           there is none.  Drop it with OS_EventFlags_Release.
+ *
+ *-----------------------------------------------------------------*/
+static OS_impl_event_flags_t *OS_EventFlags_Acquire(uint32 flags_id)
+{
+	OS_impl_event_flags_t *local;
+
+	taskENTER_CRITICAL();
+	local = OS_EventFlags_Lookup(flags_id);
+	if(local != NULL)
+	{
+		++local->refcount;
+	}
+	taskEXIT_CRITICAL();
+
+	return local;
+} /* end OS_EventFlags_Acquire */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlags_Release
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_EventFlags_Release(OS_impl_event_flags_t *local)
+{
+	taskENTER_CRITICAL();
+	--local->refcount;
+	taskEXIT_CRITICAL();
+} /* end OS_EventFlags_Release */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlagsCreate
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventFlagsCreate(uint32 *flags_id, const char *flags_name)
+{
+	OS_impl_event_flags_t *local;
+	uint32 i;
+	int32 return_code;
+
+	if(flags_id == NULL || flags_name == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*flags_id = 0;
+
+	if(strlen(flags_name) >= OS_MAX_API_NAME)
+	{
+		return OS_ERR_NAME_TOO_LONG;
+	}
+
+	local = NULL;
+	return_code = OS_ERR_NO_FREE_IDS;
+	xSemaphoreTake(OS_impl_event_flags_mut, portMAX_DELAY);
+	for(i = 0; i < OS_FREERTOS_MAX_EVENT_FLAGS; i++)
+	{
+		if(OS_impl_event_flags_table[i].in_use)
+		{
+			if(strcmp(OS_impl_event_flags_table[i].name, flags_name) == 0)
+			{
+				local = NULL;
+				return_code = OS_ERR_NAME_TAKEN;
+				break;
+			}
+		}
+		else if(local == NULL)
+		{
+			local = &OS_impl_event_flags_table[i];
+		}
+	}
+
+	if(local != NULL)
+	{
+		local->group = xEventGroupCreateStatic(&local->group_cb);
+		if(local->group == NULL)
+		{
+			return_code = OS_ERROR;
+		}
+		else
+		{
+			strncpy(local->name, flags_name, sizeof(local->name) - 1);
+			local->name[sizeof(local->name) - 1] = '\0';
+			local->refcount = 0;
+			local->deleting = false;
+			++local->generation;
+			local->in_use = true;
+			*flags_id = OS_FREERTOS_EXT_ID(local - OS_impl_event_flags_table, local->generation);
+			return_code = OS_SUCCESS;
+		}
+	}
+	xSemaphoreGive(OS_impl_event_flags_mut);
+
+	return return_code;
+} /* end OS_EventFlagsCreate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlagsDelete
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventFlagsDelete(uint32 flags_id)
+{
+	OS_impl_event_flags_t *local;
+	bool busy;
+	int32 return_code = OS_ERR_INVALID_ID;
+
+	xSemaphoreTake(OS_impl_event_flags_mut, portMAX_DELAY);
+	taskENTER_CRITICAL();
+	local = OS_EventFlags_Lookup(flags_id);
+	if(local != NULL)
+	{
+		local->deleting = true;
+	}
+	taskEXIT_CRITICAL();
+
+	if(local != NULL)
+	{
+		/*
+		 ** Tasks still waiting are released with the wait unmet.  A caller
+		 ** that took its reference before the mark may only now reach the
+		 ** kernel, so the group is set up again in place and released once
+		 ** more until the last reference is gone.  The scheduler stays
+		 ** suspended from the delete to the set up, so no task can block on
+		 ** the group in between and still be linked to its event list when
+		 ** the list is initialized again.
+		 */
+		for(;;)
+		{
+			vTaskSuspendAll();
+			vEventGroupDelete(local->group);
+
+			taskENTER_CRITICAL();
+			busy = (local->refcount != 0);
+			taskEXIT_CRITICAL();
+			if(busy)
+			{
+				local->group = xEventGroupCreateStatic(&local->group_cb);
+			}
+			xTaskResumeAll();
+
+			if(!busy)
+			{
+				break;
+			}
+
+			vTaskDelay(1);
+		}
+
+		local->group = NULL;
+		local->name[0] = '\0';
+		local->in_use = false;
+		local->deleting = false;
+		return_code = OS_SUCCESS;
+	}
+	xSemaphoreGive(OS_impl_event_flags_mut);
+
+	return return_code;
+} /* end OS_EventFlagsDelete */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlagsGetIdByName
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventFlagsGetIdByName(uint32 *flags_id, const char *flags_name)
+{
+	uint32 i;
+	int32 return_code = OS_ERR_NAME_NOT_FOUND;
+
+	if(flags_id == NULL || flags_name == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*flags_id = 0;
+
+	xSemaphoreTake(OS_impl_event_flags_mut, portMAX_DELAY);
+	for(i = 0; i < OS_FREERTOS_MAX_EVENT_FLAGS; i++)
+	{
+		if(OS_impl_event_flags_table[i].in_use && !OS_impl_event_flags_table[i].deleting &&
+		   strcmp(OS_impl_event_flags_table[i].name, flags_name) == 0)
+		{
+			*flags_id = OS_FREERTOS_EXT_ID(i, OS_impl_event_flags_table[i].generation);
+			return_code = OS_SUCCESS;
+			break;
+		}
+	}
+	xSemaphoreGive(OS_impl_event_flags_mut);
+
+	return return_code;
+} /* end OS_EventFlagsGetIdByName */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlagsSet
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventFlagsSet(uint32 flags_id, uint32 flags)
+{
+	OS_impl_event_flags_t *local = OS_EventFlags_Acquire(flags_id);
+
+	if(local == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	if(flags == 0 || (flags & ~OS_EVENT_FLAGS_ALL) != 0)
+	{
+		OS_EventFlags_Release(local);
+		return OS_ERROR;
+	}
+
+	/* Every task whose wait the new flags satisfy is released by this one call */
+	xEventGroupSetBits(local->group, (EventBits_t) flags);
+
+	OS_EventFlags_Release(local);
+
+	return OS_SUCCESS;
+} /* end OS_EventFlagsSet */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlagsSetFromISR
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventFlagsSetFromISR(uint32 flags_id, uint32 flags)
+{
+	OS_impl_event_flags_t *local;
+	UBaseType_t saved;
+	int32 return_code;
+
+	saved = taskENTER_CRITICAL_FROM_ISR();
+	local = OS_EventFlags_Lookup(flags_id);
+	if(local != NULL)
+	{
+		++local->refcount;
+	}
+	taskEXIT_CRITICAL_FROM_ISR(saved);
+
+	if(local == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	/*
+	 ** Releasing waiters is not bounded in time, so the kernel hands the
+	 ** update to the timer service task.  That fails if its queue is full.
+	 ** The queued update names the group, which stays in the entry even
+	 ** after a delete, so it never lands on freed memory.
+	 */
+	return_code = OS_SUCCESS;
+	if(flags == 0 || (flags & ~OS_EVENT_FLAGS_ALL) != 0)
+	{
+		return_code = OS_ERROR;
+	}
+	else if(xEventGroupSetBitsFromISR(local->group, (EventBits_t) flags, &OS_impl_int_woken) != pdPASS)
+	{
+		return_code = OS_ERROR;
+	}
+
+	saved = taskENTER_CRITICAL_FROM_ISR();
+	--local->refcount;
+	taskEXIT_CRITICAL_FROM_ISR(saved);
+
+	return return_code;
+} /* end OS_EventFlagsSetFromISR */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlagsClear
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventFlagsClear(uint32 flags_id, uint32 flags)
+{
+	OS_impl_event_flags_t *local = OS_EventFlags_Acquire(flags_id);
+
+	if(local == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	if((flags & ~OS_EVENT_FLAGS_ALL) != 0)
+	{
+		OS_EventFlags_Release(local);
+		return OS_ERROR;
+	}
+
+	xEventGroupClearBits(local->group, (EventBits_t) flags);
+
+	OS_EventFlags_Release(local);
+
+	return OS_SUCCESS;
+} /* end OS_EventFlagsClear */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlagsGet
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventFlagsGet(uint32 flags_id, uint32 *flags)
+{
+	OS_impl_event_flags_t *local;
+
+	if(flags == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*flags = 0;
+
+	local = OS_EventFlags_Acquire(flags_id);
+	if(local == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	*flags = (uint32) xEventGroupGetBits(local->group) & OS_EVENT_FLAGS_ALL;
+
+	OS_EventFlags_Release(local);
+
+	return OS_SUCCESS;
+} /* end OS_EventFlagsGet */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventFlagsWait
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventFlagsWait(uint32 flags_id, uint32 flags, uint32 options, int32 msecs, uint32 *flags_out)
+{
+	OS_impl_event_flags_t *local;
+	EventBits_t bits;
+	TickType_t ticks;
+	bool wait_all;
+
+	if(flags_out != NULL)
+	{
+		*flags_out = 0;
+	}
+
+	local = OS_EventFlags_Acquire(flags_id);
+	if(local == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	if(flags == 0 || (flags & ~OS_EVENT_FLAGS_ALL) != 0 ||
+	   (options & ~(OS_EVENT_FLAGS_WAIT_ALL | OS_EVENT_FLAGS_CLEAR)) != 0 ||
+	   (msecs < 0 && msecs != OS_PEND))
+	{
+		OS_EventFlags_Release(local);
+		return OS_ERROR;
+	}
+
+	if(msecs == OS_PEND)
+	{
+		ticks = portMAX_DELAY;
+	}
+	else if(msecs == OS_CHECK)
+	{
+		ticks = 0;
+	}
+	else
+	{
+		ticks = OS_Milli2Ticks(msecs);
+	}
+
+	/* A delete releases this wait with no flags set, see OS_EventFlagsDelete */
+	wait_all = (options & OS_EVENT_FLAGS_WAIT_ALL) != 0;
+	bits = xEventGroupWaitBits(local->group, (EventBits_t) flags,
+			(options & OS_EVENT_FLAGS_CLEAR) ? pdTRUE : pdFALSE,
+			wait_all ? pdTRUE : pdFALSE, ticks);
+
+	OS_EventFlags_Release(local);
+
+	/* The flags as they were when the wait ended, before any were cleared */
+	if(flags_out != NULL)
+	{
+		*flags_out = (uint32) bits & OS_EVENT_FLAGS_ALL;
+	}
+
+	if(wait_all ? ((bits & flags) != flags) : ((bits & flags) == 0))
+	{
+		return OS_ERROR_TIMEOUT;
+	}
+
+	return OS_SUCCESS;
+} /* end OS_EventFlagsWait */
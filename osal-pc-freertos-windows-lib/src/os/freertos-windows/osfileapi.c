@@ -35,6 +35,7 @@
 #include "ff_stdio.h"
 #include "dirent.h"
 #include "sys/stat.h"
+#include <stdarg.h>
 
 /***************************************************************************************
  DATA TYPES
@@ -47,40 +48,213 @@ enum OS_DirTableEntryState
 	DirTableEntryStateAfterFindNext
 };
 
+/*
+ * A RAM disk directory listing, read once and shared by every open
+ * directory on the same path.  The entries and the names are a single heap
+ * block.  A snapshot is dropped from lookups (valid false) as soon as the
+ * directory changes; directories still reading it keep doing so, as with
+ * readdir, until they rewind or close.
+ */
+typedef struct
+{
+	uint32 name;						/* offset in the names */
+	uint32 size;
+	uint32 mode;
+	int32 time;
+} OS_DirSnapshotEntry;
+
+typedef struct
+{
+	char Path[OS_MAX_LOCAL_PATH_LEN];	/* without a trailing '/' */
+	bool valid;
+	uint32 refs;						/* open directories reading it */
+	uint32 last_use;
+	uint32 count;
+	OS_DirSnapshotEntry *entries;
+	char *names;
+} OS_DirSnapshot;
+
+/*
+ * Search state of an open host (FS_BASED) directory, allocated on open.
+ */
+typedef struct
+{
+	HANDLE handle;
+	bool pending;						/* data holds an entry not returned yet */
+	WIN32_FIND_DATAA data;
+	char pattern[OS_MAX_LOCAL_PATH_LEN + 2];
+} OS_HostDir;
+
 typedef struct
 {
 	int32 VolumeType;
 	char Path[OS_MAX_PATH_LEN]; /* The path of the file opened */
 	union
 	{
+#ifndef OS_FREERTOS_DIR_SNAPSHOTS
 		FF_FindData_t xFindData; /* The current state of the directory search */
-		DIR *dp;
+#else
+		OS_DirSnapshot *snapshot;
+#endif
+		OS_HostDir *host;
 	} dir;
+	uint32 position;			/* next snapshot entry */
 	enum OS_DirTableEntryState state;
 } OS_DirTableEntry;
 
+/*
+ * Overlapped I/O state of a host file (FS_BASED) stream.  Overlapped handles
+ * have no file pointer of their own, so the position is kept here.
+ */
+typedef struct
+{
+	OVERLAPPED overlapped;				/* the transfer in flight */
+	uint64 offset;						/* current file position */
+	bool skip_on_success;				/* no completion packet for transfers that finish at once */
+	SemaphoreHandle_t done;				/* given by OS_HostFile_Interrupt */
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	StaticSemaphore_t done_cb;
+#endif
+	volatile LONG done_count;			/* completions seen by OS_HostFile_CompletionThread */
+	DWORD bytes;						/* result of the last completion */
+	DWORD error;
+} OS_HostFileEntry;
+
+/*
+ * One end of a copy made by OS_FileCopy_Chunked: a FreeRTOS+FAT file or a
+ * host file, whichever is not NULL.  A host file is opened for overlapped
+ * I/O, so offset is kept here.
+ */
+typedef struct
+{
+	int32 volume_type;
+	FF_FILE *ff_file;
+	HANDLE host_file;
+	uint64 offset;
+} OS_CopyEnd;
+
+/*
+ * A host to host copy or move, run by OS_FileCopy_HostThread.
+ */
+typedef struct
+{
+	const char *src;
+	const char *dest;
+	bool move;
+	BOOL ok;
+} OS_HostCopyJob;
+
+#ifdef OS_FREERTOS_FILE_CACHE
+/*
+ * The contents of a file, kept for later read-only opens of the same path.
+ * Streams reading an entry hold a reference, and an entry that is no longer
+ * valid goes with the last of them, as a directory snapshot does.  The data
+ * is never changed after the entry is filled.
+ *
+ * An entry being filled is reserved, with its size already counted in
+ * OS_file_cache_bytes, while the file is read without the cache mutex; an
+ * invalidation meanwhile marks it stale so it is not published.
+ */
+typedef struct
+{
+	char Path[OS_MAX_LOCAL_PATH_LEN];
+	uint32 hash;						/* of Path, see OS_FileCache_Hash */
+	bool valid;
+	bool filling;						/* reserved by OS_FileCache_Fill, data not read yet */
+	bool stale;							/* invalidated while filling */
+	uint32 refs;						/* open streams reading it */
+	uint32 last_use;
+	uint32 size;
+	uint64 mtime;						/* as OS_FileCache_Probe reports it */
+	uint8 *data;						/* NULL if the entry is free */
+} OS_FileCacheEntry;
+#endif
+
 /***************************************************************************************
  External FUNCTION PROTOTYPES
  ***************************************************************************************/
 
+static uint32_t OS_HostFile_Interrupt(void);
+#ifdef OS_FREERTOS_FILE_ASYNC
+static void OS_FileAsync_Entry(void *arg);
+#endif
+static DWORD WINAPI OS_HostFile_CompletionThread(LPVOID arg);
+
 /****************************************************************************************
  DEFINES
  ***************************************************************************************/
 
+#if defined(OS_FREERTOS_DIR_SNAPSHOTS) && OS_FREERTOS_DIR_SNAPSHOTS < OS_MAX_NUM_OPEN_DIRS
+#error OS_FREERTOS_DIR_SNAPSHOTS must be at least OS_MAX_NUM_OPEN_DIRS
+#endif
+
+/* Buffered streams hand whole RAM disk sectors to FreeRTOS+FAT */
+#if (OS_FREERTOS_FILE_BUFFER_SIZE % 512) != 0
+#error OS_FREERTOS_FILE_BUFFER_SIZE must be a multiple of the 512 byte sector size
+#endif
+
 /****************************************************************************************
  GLOBAL DATA
  ****************************************************************************************/
 
 /*
- * The file handle table.
+ * The file handle table, shared by all OSAL entities that perform low-level
+ * I/O.  The fields every I/O and select call touches are kept apart in
+ * dense arrays indexed the same way; the socket handles of a whole select
+ * set fit in a few cache lines.
  */
 OS_FreeRTOS_filehandle_entry_t OS_impl_filehandle_table[OS_MAX_NUM_OPEN_FILES];
+void *OS_impl_filehandle_fd[OS_MAX_NUM_OPEN_FILES];
+int8 OS_impl_filehandle_type[OS_MAX_NUM_OPEN_FILES];
+uint8 OS_impl_filehandle_flags[OS_MAX_NUM_OPEN_FILES];
 
 /*
  * The directory handle table.
  */
 OS_DirTableEntry OS_impl_dir_table[OS_MAX_NUM_OPEN_DIRS];
 
+#ifdef OS_FREERTOS_DIR_SNAPSHOTS
+/*
+ * RAM disk directory snapshots and the mutex guarding them.
+ */
+static OS_DirSnapshot OS_dir_snapshot_table[OS_FREERTOS_DIR_SNAPSHOTS];
+static SemaphoreHandle_t OS_dir_snapshot_mutex = NULL;
+static uint32 OS_dir_snapshot_clock = 0;
+#endif
+
+/*
+ * Host file I/O state, the completion port shared by all host files and the
+ * thread serving it.  OS_hostfile_pending flags the handles whose transfer
+ * completed, for OS_HostFile_Interrupt.
+ */
+static OS_HostFileEntry OS_impl_hostfile_table[OS_MAX_NUM_OPEN_FILES];
+static HANDLE OS_hostfile_port = NULL;
+static HANDLE OS_hostfile_thread = NULL;
+static volatile LONG OS_hostfile_pending[(OS_MAX_NUM_OPEN_FILES + 31) / 32];
+
+#ifdef OS_FREERTOS_FILE_CACHE
+/*
+ * The file content cache and the mutex guarding it.  Each stream has a read
+ * position in the cached file it reads, and a stream open for writing holds
+ * the hash of its path, so that the file stays out of the cache until it is
+ * closed.
+ */
+static OS_FileCacheEntry OS_file_cache_table[OS_FREERTOS_FILE_CACHE_ENTRIES];
+static SemaphoreHandle_t OS_file_cache_mutex = NULL;
+static uint32 OS_file_cache_clock = 0;
+static uint32 OS_file_cache_bytes = 0;
+static OS_file_cache_stats_t OS_file_cache_stats;
+static uint32 OS_file_cache_position[OS_MAX_NUM_OPEN_FILES];
+static uint32 OS_file_cache_writer[OS_MAX_NUM_OPEN_FILES];
+#endif
+
+#ifdef OS_FREERTOS_FILE_ASYNC
+/*
+ * Requests waiting for the asynchronous I/O worker, by pointer.
+ */
+static QueueHandle_t OS_file_async_queue = NULL;
+#endif
+
 /****************************************************************************************
  COMMON ROUTINES
  ****************************************************************************************/
@@ -102,12 +276,87 @@ int32 OS_FreeRTOS_StreamAPI_Impl_Init(void)
 
 	for(i = 0; i < OS_MAX_NUM_OPEN_FILES; i++)
 	{
-		OS_impl_filehandle_table[i].VolumeType = -1;
-		OS_impl_filehandle_table[i].fd = NULL;
-		OS_impl_filehandle_table[i].selectable = false;
-		OS_impl_filehandle_table[i].connected = false;
-		OS_impl_filehandle_table[i].disconnected = false;
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+		OS_impl_filehandle_table[i].lock = xSemaphoreCreateMutexStatic(&OS_impl_filehandle_table[i].lock_cb);
+#else
+		OS_impl_filehandle_table[i].lock = xSemaphoreCreateMutex();
+#endif
+		if(OS_impl_filehandle_table[i].lock == NULL)
+		{
+			return OS_ERROR;
+		}
+
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+		OS_impl_hostfile_table[i].done = xSemaphoreCreateBinaryStatic(&OS_impl_hostfile_table[i].done_cb);
+#else
+		OS_impl_hostfile_table[i].done = xSemaphoreCreateBinary();
+#endif
+		if(OS_impl_hostfile_table[i].done == NULL)
+		{
+			return OS_ERROR;
+		}
+
+		OS_impl_filehandle_type[i] = -1;
+		OS_impl_filehandle_fd[i] = NULL;
+		OS_impl_filehandle_table[i].ops = NULL;
+		OS_impl_filehandle_table[i].base_ops = NULL;
+		OS_impl_filehandle_table[i].buffer = NULL;
+		OS_impl_filehandle_table[i].map_addr = NULL;
+		OS_impl_filehandle_table[i].map_copy = NULL;
+		OS_impl_filehandle_flags[i] = 0;
+	}
+
+	if(OS_hostfile_thread == NULL)
+	{
+		OS_hostfile_port = CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, 1);
+		if(OS_hostfile_port == NULL)
+		{
+			return OS_ERROR;
+		}
+
+		vPortSetInterruptHandler(OS_FREERTOS_HOSTFILE_INTERRUPT, OS_HostFile_Interrupt);
+
+		OS_hostfile_thread = CreateThread(NULL, 0, OS_HostFile_CompletionThread, NULL, 0, NULL);
+		if(OS_hostfile_thread == NULL)
+		{
+			return OS_ERROR;
+		}
+		SetThreadPriority(OS_hostfile_thread, THREAD_PRIORITY_ABOVE_NORMAL);
+	}
+
+#ifdef OS_FREERTOS_FILE_CACHE
+	memset(OS_file_cache_position, 0, sizeof(OS_file_cache_position));
+	memset(OS_file_cache_writer, 0, sizeof(OS_file_cache_writer));
+	if(OS_file_cache_mutex == NULL)
+	{
+		memset(OS_file_cache_table, 0, sizeof(OS_file_cache_table));
+		memset(&OS_file_cache_stats, 0, sizeof(OS_file_cache_stats));
+		OS_file_cache_bytes = 0;
+
+		OS_file_cache_mutex = xSemaphoreCreateMutex();
+		if(OS_file_cache_mutex == NULL)
+		{
+			return OS_ERROR;
+		}
+	}
+#endif
+
+#ifdef OS_FREERTOS_FILE_ASYNC
+	if(OS_file_async_queue == NULL)
+	{
+		OS_file_async_queue = xQueueCreate(OS_FREERTOS_FILE_ASYNC_DEPTH, sizeof(OS_file_async_request_t *));
+		if(OS_file_async_queue == NULL)
+		{
+			return OS_ERROR;
+		}
+
+		if(xTaskCreate(OS_FileAsync_Entry, "OS_FileAsync", OS_FREERTOS_FILE_ASYNC_STACK_SIZE, NULL,
+				OS_FREERTOS_FILE_ASYNC_PRIORITY, NULL) != pdPASS)
+		{
+			return OS_ERROR;
+		}
 	}
+#endif
 
 	return OS_SUCCESS;
 } /* end OS_FreeRTOS_StreamAPI_Impl_Init */
@@ -127,677 +376,4550 @@ int32 OS_FreeRTOS_DirAPI_Impl_Init(void)
 	{
 		strcpy(OS_impl_dir_table[i].Path, "\0");
 		OS_impl_dir_table[i].VolumeType = -1;
+		OS_impl_dir_table[i].position = 0;
 		OS_impl_dir_table[i].state = DirTableEntryStateUndefined;
 	}
 
+#ifdef OS_FREERTOS_DIR_SNAPSHOTS
+	memset(OS_dir_snapshot_table, 0, sizeof(OS_dir_snapshot_table));
+	if(OS_dir_snapshot_mutex == NULL)
+	{
+		OS_dir_snapshot_mutex = xSemaphoreCreateMutex();
+		if(OS_dir_snapshot_mutex == NULL)
+		{
+			return OS_ERROR;
+		}
+	}
+#endif
+
 	return OS_SUCCESS;
 } /* end OS_FreeRTOS_DirAPI_Impl_Init */
 
-/* --------------------------------------------------------------------------------------
- Name: OS_ShellOutputToFile_Impl
-
- Purpose: Takes a shell command in and writes the output of that command to the specified file
-
- Returns: OS_FS_ERROR if the command was not executed properly
- OS_FS_ERR_INVALID_FD if the file descriptor passed in is invalid
- OS_SUCCESS if success
- ---------------------------------------------------------------------------------------*/
-int32 OS_ShellOutputToFile_Impl(uint32 stream_id, const char* Cmd)
-{
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_ERR_NOT_IMPLEMENTED;
-}/* end OS_ShellOutputToFile_Impl */
-
 /****************************************************************************************
- I/O API
+ SHELL
  ***************************************************************************************/
 
+/*
+ * A command of OS_ShellOutputToFile_Impl, on the stack of the requesting task
+ * until the worker gives "done".  The worker writes the output into the
+ * stream a chunk at a time as it comes, so it is never all held in memory.
+ */
+typedef struct
+{
+	uint32 local_id;
+	const char *cmd;
+	char *chunk;						/* OS_FREERTOS_SHELL_CHUNK bytes */
+	uint32 chunk_len;
+	volatile bool abort;				/* set by the requesting task on timeout */
+	int32 status;
+	SemaphoreHandle_t done;
+} OS_ShellJob;
+
 /*----------------------------------------------------------------
  *
- * Function: OS_GenericClose_Impl
+ * Function: OS_Shell_Flush
  *
- *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Writes the chunk of a shell command into its stream.  A failed
+ *           write ends the command; its output is dropped from then on.
+ *           Each write is bounded by the command timeout, so a stream that
+ *           stops taking data cannot hold the worker past an abort.
  *
  *-----------------------------------------------------------------*/
-int32 OS_GenericClose_Impl(uint32 local_id)
+static void OS_Shell_Flush(OS_ShellJob *job)
 {
-	int status = 0;
+	uint32 done = 0;
+	int32 status;
 
-	if(OS_impl_filehandle_table[local_id].VolumeType == RAM_DISK)
-	{
-		status = ff_fclose(OS_impl_filehandle_table[local_id].fd);
-	}
-	else if(OS_impl_filehandle_table[local_id].VolumeType == FS_BASED)
-	{
-		status = fclose(OS_impl_filehandle_table[local_id].fd);
-	}
-	else
+	while(done < job->chunk_len && job->status == OS_SUCCESS)
 	{
-		return OS_FS_ERR_PATH_INVALID;
+		status = OS_GenericWrite_Impl(job->local_id, &job->chunk[done], job->chunk_len - done,
+				OS_FREERTOS_SHELL_TIMEOUT_MSEC);
+		if(status <= 0 || job->abort)
+		{
+			job->status = OS_FS_ERROR;
+		}
+		else
+		{
+			done += status;
+		}
 	}
 
-	if(status != 0)
-	{
-		return OS_FS_ERROR;
-	}
-	else
-	{
-		OS_impl_filehandle_table[local_id].VolumeType = -1;
-		OS_impl_filehandle_table[local_id].fd = NULL;
-		OS_impl_filehandle_table[local_id].selectable = false;
-		OS_impl_filehandle_table[local_id].connected = false;
-		OS_impl_filehandle_table[local_id].disconnected = false;
-		return OS_FS_SUCCESS;
-	}
-} /* end OS_GenericClose_Impl */
+	job->chunk_len = 0;
+} /* end OS_Shell_Flush */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_GenericSeek_Impl
+ * Function: OS_Shell_Printf
  *
- *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Appends a line of built-in command output to the chunk,
+ *           writing the chunk out first when the line does not fit.
  *
  *-----------------------------------------------------------------*/
-int32 OS_GenericSeek_Impl(uint32 local_id, int32 offset, uint32 whence)
+static void OS_Shell_Printf(OS_ShellJob *job, const char *format, ...)
 {
-	off_t status;
-	int where;
+	char line[160];
+	va_list args;
+	int len;
 
-	switch(whence)
-	{
-	case OS_SEEK_SET:
-		where = SEEK_SET;
-		break;
-	case OS_SEEK_CUR:
-		where = SEEK_CUR;
-		break;
-	case OS_SEEK_END:
-		where = SEEK_END;
-		break;
-	default:
-		return OS_FS_ERROR;
-	}
+	va_start(args, format);
+	len = vsnprintf(line, sizeof(line), format, args);
+	va_end(args);
 
-	if(OS_impl_filehandle_table[local_id].VolumeType == RAM_DISK)
+	if(len < 0)
 	{
-		status = ff_fseek(OS_impl_filehandle_table[local_id].fd, (off_t) offset, (int) where);
+		return;
 	}
-	else if(OS_impl_filehandle_table[local_id].VolumeType == FS_BASED)
+	if(len >= sizeof(line))
 	{
-		status = fseek(OS_impl_filehandle_table[local_id].fd, (off_t) offset, (int) where);
-	}
-	else
-	{
-		return OS_FS_ERR_PATH_INVALID;
+		len = sizeof(line) - 1;
 	}
 
-	if((int) status == 0)
+	if(job->chunk_len + len > OS_FREERTOS_SHELL_CHUNK)
 	{
-		//Not sure if there should be an ftell option for FS_BASED. Old FreeRTOS code had it the way it currently is.
-		return (int32) ff_ftell(OS_impl_filehandle_table[local_id].fd);
+		OS_Shell_Flush(job);
 	}
-	else
-	{
-		return OS_FS_ERROR;
-	}
-} /* end OS_GenericSeek_Impl */
+	memcpy(&job->chunk[job->chunk_len], line, len);
+	job->chunk_len += len;
+} /* end OS_Shell_Printf */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_GenericRead_Impl
+ * Function: OS_Shell_Tasks
  *
- *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Built-in "tasks": the OSAL tasks with their CPU and stack use.
  *
  *-----------------------------------------------------------------*/
-int32 OS_GenericRead_Impl(uint32 local_id, void *buffer, uint32 nbytes, int32 timeout)
+static void OS_Shell_Tasks(OS_ShellJob *job)
 {
-	int32 return_code;
-	size_t status;
+	OS_task_stats_t stats;
+	uint32 task_id;
+	uint32 i;
 
-	return_code = OS_SUCCESS;
-
-	if(nbytes > 0)
-	{
-	   if(OS_impl_filehandle_table[local_id].VolumeType == RAM_DISK)
-	   {
-		   status = ff_fread(buffer, 1, nbytes, OS_impl_filehandle_table[local_id].fd);
-	   }
-	   else if(OS_impl_filehandle_table[local_id].VolumeType == FS_BASED)
-	   {
-		   status = fread(buffer, 1, nbytes, OS_impl_filehandle_table[local_id].fd);
-	   }
-	   else
-	   {
-		   return OS_FS_ERR_PATH_INVALID;
-	   }
-
-	   if(status <= 0)
-	   {
-		   return_code = OS_ERROR;
-	   }
-	   else
-	   {
-		   return_code = status;
-	   }
-	}
+	OS_Shell_Printf(job, "%-20s %10s %4s %8s %12s %8s %8s\n",
+			"name", "id", "prio", "cpu_%", "run_us", "stack", "free_min");
+	for(i = 0; i < OS_MAX_TASKS; i++)
+	{
+		task_id = OS_global_task_table[i].active_id;
+		if(task_id == 0 || OS_TaskGetStats(task_id, &stats) != OS_SUCCESS)
+		{
+			continue;
+		}
 
-	return return_code;
-} /* end OS_GenericRead_Impl */
+		OS_Shell_Printf(job, "%-20s %10lx %4lu %5lu.%02lu %12llu %8lu %8lu\n",
+				(OS_global_task_table[i].name_entry != NULL) ? OS_global_task_table[i].name_entry : "?",
+				(unsigned long)task_id,
+				(unsigned long)stats.freertos_priority,
+				(unsigned long)(stats.cpu_usage / 100), (unsigned long)(stats.cpu_usage % 100),
+				(unsigned long long)stats.run_time_usec,
+				(unsigned long)stats.stack_size,
+				(unsigned long)stats.stack_free_min);
+	}
+} /* end OS_Shell_Tasks */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_GenericWrite_Impl
+ * Function: OS_Shell_Queues
  *
- *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Built-in "queues": depth and usage counters of every queue.
  *
  *-----------------------------------------------------------------*/
-int32 OS_GenericWrite_Impl(uint32 local_id, const void *buffer, uint32 nbytes, int32 timeout)
+static void OS_Shell_Queues(OS_ShellJob *job)
 {
-	size_t status;
-	int32 return_code;
-
-	return_code = OS_SUCCESS;
+	OS_queue_stats_t stats;
+	uint32 queue_id;
+	uint32 i;
 
-	if(nbytes > 0)
+	OS_Shell_Printf(job, "%-20s %10s %6s %6s %6s %10s %10s %8s\n",
+			"name", "id", "depth", "peak", "max", "puts", "gets", "full");
+	for(i = 0; i < OS_MAX_QUEUES; i++)
 	{
-		if(OS_impl_filehandle_table[local_id].VolumeType == RAM_DISK)
-		{
-			status = ff_fwrite(buffer, 1, nbytes, OS_impl_filehandle_table[local_id].fd);
-		}
-		else if(OS_impl_filehandle_table[local_id].VolumeType == FS_BASED)
-		{
-			status = fwrite(buffer, 1, nbytes, OS_impl_filehandle_table[local_id].fd);
-		}
-		else
+		queue_id = OS_global_queue_table[i].active_id;
+		if(queue_id == 0 || OS_QueueGetStats(queue_id, &stats) != OS_SUCCESS)
 		{
-			return OS_FS_ERR_PATH_INVALID;
+			continue;
 		}
 
-		if(status > 0)
-		{
-		   return_code = status;
-		}
-		else
-		{
-		   return_code = OS_ERROR;
-		}
+		OS_Shell_Printf(job, "%-20s %10lx %6lu %6lu %6lu %10lu %10lu %8lu\n",
+				(OS_global_queue_table[i].name_entry != NULL) ? OS_global_queue_table[i].name_entry : "?",
+				(unsigned long)queue_id,
+				(unsigned long)stats.depth,
+				(unsigned long)stats.peak_depth,
+				(unsigned long)stats.max_depth,
+				(unsigned long)stats.put_count,
+				(unsigned long)stats.get_count,
+				(unsigned long)stats.full_count);
 	}
-
-	return return_code;
-} /* end OS_GenericWrite_Impl */
-
-/****************************************************************************************
- Named File API
- ***************************************************************************************/
+} /* end OS_Shell_Queues */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FileOpen_Impl
+ * Function: OS_Shell_Heap
  *
- *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Built-in "heap": the FreeRTOS heap and its use by object type.
  *
  *-----------------------------------------------------------------*/
-int32 OS_FileOpen_Impl(uint32 local_id, const char *local_path, int32 flags, int32 access)
+static void OS_Shell_Heap(OS_ShellJob *job)
 {
-	char *perm;
-	int32 volume_type;
+	static const char * const CATEGORY_NAME[OS_HEAP_CATEGORY_COUNT] =
+		  {
+				[OS_HEAP_CATEGORY_OTHER] = "other",
+				[OS_HEAP_CATEGORY_TASK] = "task",
+				[OS_HEAP_CATEGORY_QUEUE] = "queue",
+				[OS_HEAP_CATEGORY_SEMAPHORE] = "semaphore",
+				[OS_HEAP_CATEGORY_FILESYS] = "filesys",
+				[OS_HEAP_CATEGORY_NETWORK] = "network",
+				[OS_HEAP_CATEGORY_TIMER] = "timer",
+		  };
+	OS_heap_stats_t stats;
+	uint32 i;
 
-	/*
-	 ** Check for a valid access mode
-	 */
-	switch(access)
+	if(OS_HeapGetStats(&stats) != OS_SUCCESS)
 	{
-	case OS_READ_ONLY:
-		perm = "rb";
-		break;
-	case OS_WRITE_ONLY:
-		perm = "wb";
-		break;
-	case OS_READ_WRITE:
-		perm = "w+b";
-		break;
-	default:
-		return OS_FS_ERROR;
+		job->status = OS_FS_ERROR;
+		return;
 	}
 
-	volume_type = OS_GetVolumeType(local_path);
-
-	if(volume_type == RAM_DISK)
-	{
-		OS_impl_filehandle_table[local_id].fd = ff_fopen(local_path, perm);
-	}
-	else if(volume_type == FS_BASED)
+	OS_Shell_Printf(job, "free %lu in %lu blocks, largest %lu, smallest %lu, lowest %lu\n",
+			(unsigned long)stats.free_bytes,
+			(unsigned long)stats.free_blocks,
+			(unsigned long)stats.largest_free_block,
+			(unsigned long)stats.smallest_free_block,
+			(unsigned long)stats.min_free_bytes);
+	OS_Shell_Printf(job, "allocs %lu, frees %lu\n",
+			(unsigned long)stats.alloc_count,
+			(unsigned long)stats.free_count);
+	for(i = 0; i < OS_HEAP_CATEGORY_COUNT; i++)
 	{
-		OS_impl_filehandle_table[local_id].fd = fopen(local_path, perm);
-	}
-	else
-	{
-		return OS_FS_ERR_PATH_INVALID;
+		OS_Shell_Printf(job, "%-10s %10lu\n", CATEGORY_NAME[i], (unsigned long)stats.category_bytes[i]);
 	}
+} /* end OS_Shell_Heap */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Shell_Cpu
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Built-in "cpu": the CPU load of the system.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Shell_Cpu(OS_ShellJob *job)
+{
+	OS_cpu_load_t load;
 
-	if(OS_impl_filehandle_table[local_id].fd == NULL)
+	if(OS_CpuLoadGet(&load) != OS_SUCCESS)
 	{
-		return OS_FS_ERROR;
+		job->status = OS_FS_ERROR;
+		return;
 	}
 
-	OS_impl_filehandle_table[local_id].VolumeType = volume_type;
+	OS_Shell_Printf(job, "load %lu.%02lu%%, peak %lu.%02lu%%, window %lu us, windows %lu\n",
+			(unsigned long)(load.cpu_load / 100), (unsigned long)(load.cpu_load % 100),
+			(unsigned long)(load.cpu_load_peak / 100), (unsigned long)(load.cpu_load_peak % 100),
+			(unsigned long)load.window_usec,
+			(unsigned long)load.window_count);
+} /* end OS_Shell_Cpu */
 
-	return OS_FS_SUCCESS;
-} /* end OS_FileOpen_Impl */
+static void OS_Shell_Help(OS_ShellJob *job);
+
+/* Built-in commands, matched on the whole command line */
+static const struct
+{
+	const char *name;
+	void (*run)(OS_ShellJob *job);
+	const char *help;
+} OS_shell_builtin[] =
+	{
+		{ "help",	OS_Shell_Help,		"list the built-in commands" },
+		{ "tasks",	OS_Shell_Tasks,		"OSAL tasks with their CPU and stack use" },
+		{ "queues",	OS_Shell_Queues,	"depth and usage counters of the queues" },
+		{ "heap",	OS_Shell_Heap,		"FreeRTOS heap statistics" },
+		{ "cpu",	OS_Shell_Cpu,		"CPU load of the system" },
+	};
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FileStat_Impl
+ * Function: OS_Shell_Help
  *
- *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Built-in "help".
  *
  *-----------------------------------------------------------------*/
-int32 OS_FileStat_Impl(const char *local_path, os_fstat_t *FileStats)
+static void OS_Shell_Help(OS_ShellJob *job)
 {
-	int32 volume_type;
-	int ret_val;
-
-	volume_type = OS_GetVolumeType(local_path);
+	uint32 i;
 
-	if(volume_type == RAM_DISK)
+	for(i = 0; i < sizeof(OS_shell_builtin) / sizeof(OS_shell_builtin[0]); i++)
 	{
-		FF_Stat_t xStatBuffer;
-		ret_val = ff_stat(local_path, &xStatBuffer);
+		OS_Shell_Printf(job, "%-8s %s\n", OS_shell_builtin[i].name, OS_shell_builtin[i].help);
+	}
+#ifdef OS_FREERTOS_SHELL_HOST
+	OS_Shell_Printf(job, "anything else is run by cmd.exe on the host\n");
+#endif
+} /* end OS_Shell_Help */
 
-		if(ret_val != 0)
-		{
+#ifdef OS_FREERTOS_SHELL_HOST
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Shell_Host
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Runs a command with cmd.exe, its stdout and stderr going to a
+ *           pipe.  The pipe is polled rather than read with a blocking
+ *           ReadFile, which would stall the simulated kernel, and only the
+ *           bytes already in it are read.  The process is killed when the
+ *           requesting task gives up waiting.  A non-zero exit code fails
+ *           the command.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Shell_Host(OS_ShellJob *job)
+{
+	SECURITY_ATTRIBUTES sa = { sizeof(sa), NULL, TRUE };
+	STARTUPINFOA si;
+	PROCESS_INFORMATION pi;
+	HANDLE read_end;
+	HANDLE write_end;
+	char cmdline[OS_MAX_CMD_LEN + 16];
+	DWORD avail;
+	DWORD got;
+	DWORD exit_code;
+
+	if(!CreatePipe(&read_end, &write_end, &sa, OS_FREERTOS_SHELL_CHUNK))
+	{
+		job->status = OS_FS_ERROR;
+		return;
+	}
+	SetHandleInformation(read_end, HANDLE_FLAG_INHERIT, 0);
+
+	memset(&si, 0, sizeof(si));
+	si.cb = sizeof(si);
+	si.dwFlags = STARTF_USESTDHANDLES;
+	si.hStdInput = NULL;
+	si.hStdOutput = write_end;
+	si.hStdError = write_end;
+	snprintf(cmdline, sizeof(cmdline), "cmd.exe /c %s", job->cmd);
+
+	if(!CreateProcessA(NULL, cmdline, NULL, NULL, TRUE, CREATE_NO_WINDOW, NULL, NULL, &si, &pi))
+	{
+		OS_DEBUG("OS_ShellOutputToFile: cannot run %s: %lu\n", job->cmd, GetLastError());
+		CloseHandle(read_end);
+		CloseHandle(write_end);
+		job->status = OS_FS_ERROR;
+		return;
+	}
+
+	/* The pipe breaks once the command and everything it started have exited */
+	CloseHandle(write_end);
+	CloseHandle(pi.hThread);
+
+	while(!job->abort && job->status == OS_SUCCESS && PeekNamedPipe(read_end, NULL, 0, NULL, &avail, NULL))
+	{
+		if(avail > 0)
+		{
+			if(avail > OS_FREERTOS_SHELL_CHUNK - job->chunk_len)
+			{
+				avail = OS_FREERTOS_SHELL_CHUNK - job->chunk_len;
+			}
+			if(!ReadFile(read_end, &job->chunk[job->chunk_len], avail, &got, NULL))
+			{
+				break;
+			}
+			job->chunk_len += got;
+			OS_Shell_Flush(job);
+		}
+		else
+		{
+			vTaskDelay(1);
+		}
+	}
+
+	/* The command may close its output a little before it exits */
+	while(!job->abort && job->status == OS_SUCCESS && WaitForSingleObject(pi.hProcess, 0) == WAIT_TIMEOUT)
+	{
+		vTaskDelay(1);
+	}
+
+	if(job->abort || job->status != OS_SUCCESS)
+	{
+		TerminateProcess(pi.hProcess, 1);
+		job->status = OS_FS_ERROR;
+	}
+	else if(!GetExitCodeProcess(pi.hProcess, &exit_code) || exit_code != 0)
+	{
+		job->status = OS_FS_ERROR;
+	}
+
+	CloseHandle(pi.hProcess);
+	CloseHandle(read_end);
+} /* end OS_Shell_Host */
+#endif
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Shell_Entry
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Worker task of one shell command.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Shell_Entry(void *arg)
+{
+	OS_ShellJob *job = arg;
+	uint32 i;
+
+	for(i = 0; i < sizeof(OS_shell_builtin) / sizeof(OS_shell_builtin[0]); i++)
+	{
+		if(strcmp(job->cmd, OS_shell_builtin[i].name) == 0)
+		{
+			break;
+		}
+	}
+
+	if(i < sizeof(OS_shell_builtin) / sizeof(OS_shell_builtin[0]))
+	{
+		OS_shell_builtin[i].run(job);
+		OS_Shell_Flush(job);
+	}
+	else
+	{
+#ifdef OS_FREERTOS_SHELL_HOST
+		OS_Shell_Host(job);
+#else
+		OS_Shell_Printf(job, "%s: not a built-in command, try help\n", job->cmd);
+		OS_Shell_Flush(job);
+		if(job->status == OS_SUCCESS)
+		{
+			job->status = OS_FS_ERROR;
+		}
+#endif
+	}
+
+	/* The job is gone as soon as the requesting task has seen this */
+	xSemaphoreGive(job->done);
+	vTaskDelete(NULL);
+} /* end OS_Shell_Entry */
+
+/* --------------------------------------------------------------------------------------
+ Name: OS_ShellOutputToFile_Impl
+
+ Purpose: Takes a shell command in and writes the output of that command to the specified file
+
+          The command runs in a worker task at OS_FREERTOS_SHELL_PRIORITY, which streams
+          the output into the file as it comes, while the caller pends until it is done
+          or OS_FREERTOS_SHELL_TIMEOUT_MSEC has passed, see osconfig.h.
+
+ Returns: OS_FS_ERROR if the command was not executed properly or a host command
+          exited with a non-zero code
+ OS_FS_ERR_INVALID_FD if the file descriptor passed in is invalid
+ OS_SUCCESS if success
+ ---------------------------------------------------------------------------------------*/
+int32 OS_ShellOutputToFile_Impl(uint32 stream_id, const char* Cmd)
+{
+	OS_ShellJob job;
+	uint32 heap_category;
+	TickType_t timeout;
+	BaseType_t created = pdFAIL;
+
+	if(OS_impl_filehandle_table[stream_id].ops == NULL)
+	{
+		return OS_FS_ERR_INVALID_FD;
+	}
+
+	memset(&job, 0, sizeof(job));
+	job.local_id = stream_id;
+	job.cmd = Cmd;
+	job.status = OS_SUCCESS;
+
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_FILESYS);
+	job.chunk = pvPortMalloc(OS_FREERTOS_SHELL_CHUNK);
+	job.done = xSemaphoreCreateBinary();
+	if(job.chunk != NULL && job.done != NULL)
+	{
+		created = xTaskCreate(OS_Shell_Entry, "OS_Shell", OS_FREERTOS_SHELL_STACK_SIZE, &job,
+				OS_FREERTOS_SHELL_PRIORITY, NULL);
+	}
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+
+	if(created == pdPASS)
+	{
+		timeout = pdMS_TO_TICKS(OS_FREERTOS_SHELL_TIMEOUT_MSEC);
+		if(xSemaphoreTake(job.done, timeout) != pdPASS)
+		{
+			/* The worker uses the job until it gives done, so wait for it to stop */
+			job.abort = true;
+			xSemaphoreTake(job.done, portMAX_DELAY);
+			job.status = OS_FS_ERROR;
+		}
+	}
+	else
+	{
+		job.status = OS_FS_ERROR;
+	}
+
+	if(job.done != NULL)
+	{
+		vSemaphoreDelete(job.done);
+	}
+	if(job.chunk != NULL)
+	{
+		vPortFree(job.chunk);
+	}
+
+	return job.status;
+}/* end OS_ShellOutputToFile_Impl */
+
+/****************************************************************************************
+ STREAM OPERATIONS
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_Read
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Read operation of FreeRTOS+FAT (RAM_DISK) streams.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_RamDisk_Read(uint32 local_id, void *buffer, uint32 nbytes, int32 timeout)
+{
+	size_t status;
+
+	status = ff_fread(buffer, 1, nbytes, OS_impl_filehandle_fd[local_id]);
+	if(status <= 0)
+	{
+		return OS_ERROR;
+	}
+
+	return status;
+} /* end OS_RamDisk_Read */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_Write
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_RamDisk_Write(uint32 local_id, const void *buffer, uint32 nbytes, int32 timeout)
+{
+	size_t status;
+
+	status = ff_fwrite(buffer, 1, nbytes, OS_impl_filehandle_fd[local_id]);
+	if(status <= 0)
+	{
+		return OS_ERROR;
+	}
+
+	return status;
+} /* end OS_RamDisk_Write */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_Seek
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_RamDisk_Seek(uint32 local_id, int32 offset, int whence)
+{
+	FF_FILE *fd = OS_impl_filehandle_fd[local_id];
+
+	if(ff_fseek(fd, (long) offset, whence) != 0)
+	{
+		return OS_FS_ERROR;
+	}
+
+	return (int32) ff_ftell(fd);
+} /* end OS_RamDisk_Seek */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_Close
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_RamDisk_Close(uint32 local_id)
+{
+	if(ff_fclose(OS_impl_filehandle_fd[local_id]) != 0)
+	{
+		return OS_FS_ERROR;
+	}
+
+	return OS_FS_SUCCESS;
+} /* end OS_RamDisk_Close */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_Sync
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_RamDisk_Sync(uint32 local_id)
+{
+	if(ff_fflush(OS_impl_filehandle_fd[local_id]) != 0)
+	{
+		return OS_FS_ERROR;
+	}
+
+	return OS_FS_SUCCESS;
+} /* end OS_RamDisk_Sync */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostFile_CompletionThread
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Win32 thread taking completed host file transfers off the
+ *           completion port.  The result is recorded in the handle and the
+ *           waiting task is released through a simulated interrupt, as a
+ *           FreeRTOS task must not be woken from a Win32 thread directly.
+ *
+ *-----------------------------------------------------------------*/
+static DWORD WINAPI OS_HostFile_CompletionThread(LPVOID arg)
+{
+	OS_HostFileEntry *io;
+	OVERLAPPED *overlapped;
+	ULONG_PTR key;
+	DWORD nbytes;
+	BOOL ok;
+
+	for(;;)
+	{
+		overlapped = NULL;
+		ok = GetQueuedCompletionStatus(OS_hostfile_port, &nbytes, &key, &overlapped, INFINITE);
+		if(overlapped == NULL || key >= OS_MAX_NUM_OPEN_FILES)
+		{
+			continue;
+		}
+
+		io = &OS_impl_hostfile_table[key];
+		io->bytes = nbytes;
+		io->error = ok ? ERROR_SUCCESS : GetLastError();
+		InterlockedIncrement(&io->done_count);
+
+		InterlockedOr(&OS_hostfile_pending[key / 32], (LONG)(1UL << (key % 32)));
+		vPortGenerateSimulatedInterrupt(OS_FREERTOS_HOSTFILE_INTERRUPT);
+	}
+
+	return 0;
+} /* end OS_HostFile_CompletionThread */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostFile_Interrupt
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Simulated interrupt raised by the completion thread.  Releases
+ *           the task waiting on every handle it flagged.
+ *
+ *-----------------------------------------------------------------*/
+static uint32_t OS_HostFile_Interrupt(void)
+{
+	BaseType_t woken = pdFALSE;
+	LONG bits;
+	uint32 word;
+	uint32 bit;
+
+	for(word = 0; word < (OS_MAX_NUM_OPEN_FILES + 31) / 32; word++)
+	{
+		bits = InterlockedExchange(&OS_hostfile_pending[word], 0);
+		for(bit = 0; bits != 0; bit++, bits = (LONG)((ULONG)bits >> 1))
+		{
+			if((bits & 1) != 0)
+			{
+				xSemaphoreGiveFromISR(OS_impl_hostfile_table[word * 32 + bit].done, &woken);
+			}
+		}
+	}
+
+	return (uint32_t)woken;
+} /* end OS_HostFile_Interrupt */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostFile_Transfer
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Reads or writes at the stream position with overlapped I/O.
+ *           The calling task blocks on its handle's semaphore while the
+ *           host does the transfer, so other tasks keep running.  Before
+ *           the scheduler runs the caller just sleeps until completion.
+ *
+ *           A give left over from an earlier transfer is told apart by
+ *           the completion count.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_HostFile_Transfer(uint32 local_id, void *buffer, uint32 nbytes, bool is_write)
+{
+	OS_HostFileEntry *io = &OS_impl_hostfile_table[local_id];
+	HANDLE handle = OS_impl_filehandle_fd[local_id];
+	DWORD done = 0;
+	LONG expected;
+	BOOL ok;
+
+	memset(&io->overlapped, 0, sizeof(io->overlapped));
+	io->overlapped.Offset = (DWORD) io->offset;
+	io->overlapped.OffsetHigh = (DWORD)(io->offset >> 32);
+	expected = io->done_count + 1;
+
+	if(is_write)
+	{
+		ok = WriteFile(handle, buffer, nbytes, &done, &io->overlapped);
+	}
+	else
+	{
+		ok = ReadFile(handle, buffer, nbytes, &done, &io->overlapped);
+	}
+
+	if(!ok && GetLastError() != ERROR_IO_PENDING)
+	{
+		/* includes ERROR_HANDLE_EOF for a read at the end of the file */
+		return OS_ERROR;
+	}
+
+	if(!ok || !io->skip_on_success)
+	{
+		if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		{
+			while(io->done_count != expected)
+			{
+				xSemaphoreTake(io->done, portMAX_DELAY);
+			}
+		}
+		else
+		{
+			while(io->done_count != expected)
+			{
+				Sleep(1);
+			}
+		}
+
+		if(io->error != ERROR_SUCCESS)
+		{
+			return OS_ERROR;
+		}
+		done = io->bytes;
+	}
+
+	if(done == 0)
+	{
+		return OS_ERROR;
+	}
+
+	io->offset += done;
+
+	return (int32) done;
+} /* end OS_HostFile_Transfer */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostFile_Read
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Read operation of host file (FS_BASED) streams.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_HostFile_Read(uint32 local_id, void *buffer, uint32 nbytes, int32 timeout)
+{
+	return OS_HostFile_Transfer(local_id, buffer, nbytes, false);
+} /* end OS_HostFile_Read */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostFile_Write
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_HostFile_Write(uint32 local_id, const void *buffer, uint32 nbytes, int32 timeout)
+{
+	return OS_HostFile_Transfer(local_id, (void *) buffer, nbytes, true);
+} /* end OS_HostFile_Write */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostFile_Seek
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_HostFile_Seek(uint32 local_id, int32 offset, int whence)
+{
+	OS_HostFileEntry *io = &OS_impl_hostfile_table[local_id];
+	LARGE_INTEGER size;
+	int64 position;
+
+	switch(whence)
+	{
+	case SEEK_SET:
+		position = offset;
+		break;
+	case SEEK_CUR:
+		position = (int64) io->offset + offset;
+		break;
+	case SEEK_END:
+		if(!GetFileSizeEx(OS_impl_filehandle_fd[local_id], &size))
+		{
+			return OS_FS_ERROR;
+		}
+		position = size.QuadPart + offset;
+		break;
+	default:
+		return OS_FS_ERROR;
+	}
+
+	if(position < 0 || position > 0x7FFFFFFF)
+	{
+		return OS_FS_ERROR;
+	}
+
+	io->offset = (uint64) position;
+
+	return (int32) position;
+} /* end OS_HostFile_Seek */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostFile_Close
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_HostFile_Close(uint32 local_id)
+{
+	if(!CloseHandle(OS_impl_filehandle_fd[local_id]))
+	{
+		return OS_FS_ERROR;
+	}
+
+	return OS_FS_SUCCESS;
+} /* end OS_HostFile_Close */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostFile_Sync
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Every write has been handed to the host by the time it
+ *           returns, so there is nothing to flush.  Forcing the host cache
+ *           to disk (FlushFileBuffers) would stall the whole scheduler;
+ *           open with OS_FILE_FLAG_UNBUFFERED where that matters.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_HostFile_Sync(uint32 local_id)
+{
+	return OS_FS_SUCCESS;
+} /* end OS_HostFile_Sync */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostFile_Open
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Opens a host file for overlapped I/O and ties it to the
+ *           completion port.  Creation follows the stdio modes used
+ *           before: read-only opens an existing file, the other access
+ *           modes create or truncate it.
+ *
+ *-----------------------------------------------------------------*/
+static HANDLE OS_HostFile_Open(uint32 local_id, const char *local_path, int32 flags, int32 access)
+{
+	OS_HostFileEntry *io = &OS_impl_hostfile_table[local_id];
+	HANDLE handle;
+	DWORD desired;
+	DWORD disposition;
+	DWORD attributes;
+
+	switch(access)
+	{
+	case OS_READ_ONLY:
+		desired = GENERIC_READ;
+		disposition = OPEN_EXISTING;
+		break;
+	case OS_WRITE_ONLY:
+		desired = GENERIC_WRITE;
+		disposition = CREATE_ALWAYS;
+		break;
+	default:
+		desired = GENERIC_READ | GENERIC_WRITE;
+		disposition = CREATE_ALWAYS;
+		break;
+	}
+
+	attributes = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_OVERLAPPED;
+	if((flags & OS_FILE_FLAG_SEQUENTIAL) != 0)
+	{
+		attributes |= FILE_FLAG_SEQUENTIAL_SCAN;
+	}
+	if((flags & OS_FILE_FLAG_UNBUFFERED) != 0)
+	{
+		attributes |= FILE_FLAG_WRITE_THROUGH;
+	}
+
+	handle = CreateFileA(local_path, desired, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, disposition, attributes, NULL);
+	if(handle == INVALID_HANDLE_VALUE)
+	{
+		return NULL;
+	}
+
+	if(CreateIoCompletionPort(handle, OS_hostfile_port, (ULONG_PTR) local_id, 0) == NULL)
+	{
+		CloseHandle(handle);
+		return NULL;
+	}
+
+	io->skip_on_success = SetFileCompletionNotificationModes(handle, FILE_SKIP_COMPLETION_PORT_ON_SUCCESS) != FALSE;
+	io->offset = 0;
+
+	return handle;
+} /* end OS_HostFile_Open */
+
+static const OS_FreeRTOS_stream_ops_t OS_RamDiskStreamOps =
+{
+	.Read = OS_RamDisk_Read,
+	.Write = OS_RamDisk_Write,
+	.Seek = OS_RamDisk_Seek,
+	.Close = OS_RamDisk_Close,
+	.Sync = OS_RamDisk_Sync
+};
+
+static const OS_FreeRTOS_stream_ops_t OS_HostFileStreamOps =
+{
+	.Read = OS_HostFile_Read,
+	.Write = OS_HostFile_Write,
+	.Seek = OS_HostFile_Seek,
+	.Close = OS_HostFile_Close,
+	.Sync = OS_HostFile_Sync
+};
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_RamDiskWriters
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Counts the streams open for writing on the RAM disk of a
+ *           FreeRTOS+FAT IO manager, buffered or not.  Called with the
+ *           stream table lock held.
+ *
+ *-----------------------------------------------------------------*/
+uint32 OS_FreeRTOS_RamDiskWriters(const void *io_manager)
+{
+	FF_FILE *file;
+	uint32 count = 0;
+	uint32 i;
+
+	for(i = 0; i < OS_MAX_NUM_OPEN_FILES; i++)
+	{
+		if(OS_impl_filehandle_table[i].ops != &OS_RamDiskStreamOps &&
+		   OS_impl_filehandle_table[i].base_ops != &OS_RamDiskStreamOps)
+		{
+			continue;
+		}
+
+		file = OS_impl_filehandle_fd[i];
+		if(file != NULL && file->pxIOManager == io_manager && (file->ucMode & FF_MODE_WRITE) != 0)
+		{
+			++count;
+		}
+	}
+
+	return count;
+} /* end OS_FreeRTOS_RamDiskWriters */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Buffered_Flush
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Writes out the pending data of a buffered stream, or drops
+ *           its read-ahead and moves the backend back to the position
+ *           the caller has read up to.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Buffered_Flush(uint32 local_id)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+	uint32 done;
+	int32 status;
+
+	status = OS_FS_SUCCESS;
+
+	if(impl->buffer_state == OS_FREERTOS_BUFFER_WRITING)
+	{
+		done = 0;
+		while(done < impl->buffer_len)
+		{
+			status = impl->base_ops->Write(local_id, &impl->buffer[done], impl->buffer_len - done, OS_PEND);
+			if(status <= 0)
+			{
+				/* keep what could not be written for the next attempt */
+				memmove(impl->buffer, &impl->buffer[done], impl->buffer_len - done);
+				impl->buffer_len -= done;
+				return OS_FS_ERROR;
+			}
+			done += status;
+		}
+		status = OS_FS_SUCCESS;
+	}
+	else if(impl->buffer_state == OS_FREERTOS_BUFFER_READING && impl->buffer_pos < impl->buffer_len)
+	{
+		status = impl->base_ops->Seek(local_id, -(int32)(impl->buffer_len - impl->buffer_pos), SEEK_CUR);
+		if(status >= 0)
+		{
+			status = OS_FS_SUCCESS;
+		}
+	}
+
+	impl->buffer_len = 0;
+	impl->buffer_pos = 0;
+	impl->buffer_state = OS_FREERTOS_BUFFER_IDLE;
+
+	return status;
+} /* end OS_Buffered_Flush */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Buffered_Read
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Read operation of buffered streams.  Small reads are served
+ *           from a read-ahead of OS_FREERTOS_FILE_BUFFER_SIZE bytes.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Buffered_Read(uint32 local_id, void *buffer, uint32 nbytes, int32 timeout)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+	uint32 avail;
+	int32 status;
+
+	if(impl->buffer_state == OS_FREERTOS_BUFFER_WRITING)
+	{
+		status = OS_Buffered_Flush(local_id);
+		if(status != OS_FS_SUCCESS)
+		{
+			return status;
+		}
+	}
+
+	avail = impl->buffer_len - impl->buffer_pos;
+	if(avail == 0)
+	{
+		impl->buffer_len = 0;
+		impl->buffer_pos = 0;
+		impl->buffer_state = OS_FREERTOS_BUFFER_IDLE;
+
+		if(nbytes >= OS_FREERTOS_FILE_BUFFER_SIZE)
+		{
+			/* large reads go straight through */
+			return impl->base_ops->Read(local_id, buffer, nbytes, timeout);
+		}
+
+		status = impl->base_ops->Read(local_id, impl->buffer, OS_FREERTOS_FILE_BUFFER_SIZE, timeout);
+		if(status <= 0)
+		{
+			return status;
+		}
+
+		impl->buffer_len = status;
+		impl->buffer_state = OS_FREERTOS_BUFFER_READING;
+		avail = status;
+	}
+
+	if(nbytes > avail)
+	{
+		/* return what is buffered, like a short read of the backend */
+		nbytes = avail;
+	}
+
+	memcpy(buffer, &impl->buffer[impl->buffer_pos], nbytes);
+	impl->buffer_pos += nbytes;
+
+	return nbytes;
+} /* end OS_Buffered_Read */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Buffered_Write
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Write operation of buffered streams.  Small writes are
+ *           gathered and handed to the backend in whole buffers.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Buffered_Write(uint32 local_id, const void *buffer, uint32 nbytes, int32 timeout)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+	const uint8 *data = buffer;
+	uint32 chunk;
+	uint32 done;
+	int32 status;
+
+	if(impl->buffer_state == OS_FREERTOS_BUFFER_READING)
+	{
+		status = OS_Buffered_Flush(local_id);
+		if(status != OS_FS_SUCCESS)
+		{
+			return status;
+		}
+	}
+
+	if(impl->buffer_len == 0 && nbytes >= OS_FREERTOS_FILE_BUFFER_SIZE)
+	{
+		/* large writes go straight through */
+		return impl->base_ops->Write(local_id, buffer, nbytes, timeout);
+	}
+
+	done = 0;
+	while(done < nbytes)
+	{
+		if(impl->buffer_len >= OS_FREERTOS_FILE_BUFFER_SIZE)
+		{
+			if(OS_Buffered_Flush(local_id) != OS_FS_SUCCESS)
+			{
+				/* what was accepted so far stays buffered for the next flush */
+				return (done > 0) ? (int32)done : OS_ERROR;
+			}
+		}
+
+		chunk = OS_FREERTOS_FILE_BUFFER_SIZE - impl->buffer_len;
+		if(chunk > nbytes - done)
+		{
+			chunk = nbytes - done;
+		}
+
+		memcpy(&impl->buffer[impl->buffer_len], &data[done], chunk);
+		impl->buffer_len += chunk;
+		impl->buffer_state = OS_FREERTOS_BUFFER_WRITING;
+		done += chunk;
+	}
+
+	return nbytes;
+} /* end OS_Buffered_Write */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Buffered_Seek
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Buffered_Seek(uint32 local_id, int32 offset, int whence)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+
+	if(OS_Buffered_Flush(local_id) != OS_FS_SUCCESS)
+	{
+		return OS_FS_ERROR;
+	}
+
+	return impl->base_ops->Seek(local_id, offset, whence);
+} /* end OS_Buffered_Seek */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Buffered_Close
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Buffered_Close(uint32 local_id)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+	int32 flush_status;
+	int32 status;
+
+	flush_status = OS_Buffered_Flush(local_id);
+
+	status = impl->base_ops->Close(local_id);
+	if(status == OS_FS_SUCCESS)
+	{
+		vPortFree(impl->buffer);
+		impl->buffer = NULL;
+		impl->base_ops = NULL;
+
+		/* data lost in the final flush is still reported, the handle is gone either way */
+		status = flush_status;
+	}
+
+	return status;
+} /* end OS_Buffered_Close */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Buffered_Sync
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Buffered_Sync(uint32 local_id)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+
+	if(OS_Buffered_Flush(local_id) != OS_FS_SUCCESS)
+	{
+		return OS_FS_ERROR;
+	}
+
+	return impl->base_ops->Sync(local_id);
+} /* end OS_Buffered_Sync */
+
+static const OS_FreeRTOS_stream_ops_t OS_BufferedStreamOps =
+{
+	.Read = OS_Buffered_Read,
+	.Write = OS_Buffered_Write,
+	.Seek = OS_Buffered_Seek,
+	.Close = OS_Buffered_Close,
+	.Sync = OS_Buffered_Sync
+};
+
+/****************************************************************************************
+ FILE CONTENT CACHE
+ ***************************************************************************************/
+
+#ifdef OS_FREERTOS_FILE_CACHE
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCache_Hash
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           FNV-1a hash of a local path, never 0.
+ *
+ *-----------------------------------------------------------------*/
+static uint32 OS_FileCache_Hash(const char *local_path)
+{
+	uint32 hash = 2166136261u;
+
+	while(*local_path != '\0')
+	{
+		hash = (hash ^ (uint8) *local_path++) * 16777619u;
+	}
+
+	return (hash != 0) ? hash : 1;
+} /* end OS_FileCache_Hash */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCache_Probe
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Gets the size and modification time a cache entry of the file
+ *           is checked against.  RAM disks built without
+ *           ffconfigTIME_SUPPORT report a time of 0; all changes to them
+ *           go through OSAL and invalidate the entry anyway.
+ *
+ *-----------------------------------------------------------------*/
+static bool OS_FileCache_Probe(const char *local_path, int32 volume_type, uint32 *size, uint64 *mtime)
+{
+	if(volume_type == RAM_DISK)
+	{
+		FF_Stat_t xStatBuffer;
+
+		if(ff_stat(local_path, &xStatBuffer) != 0)
+		{
+			return false;
+		}
+
+		*size = xStatBuffer.st_size;
+#if( ffconfigTIME_SUPPORT == 1 )
+		*mtime = xStatBuffer.st_mtime;
+#else
+		*mtime = 0;
+#endif /* ffconfigTIME_SUPPORT */
+	}
+	else
+	{
+		WIN32_FILE_ATTRIBUTE_DATA attributes;
+
+		if(!GetFileAttributesExA(local_path, GetFileExInfoStandard, &attributes) || attributes.nFileSizeHigh != 0)
+		{
+			return false;
+		}
+
+		*size = attributes.nFileSizeLow;
+		*mtime = ((uint64) attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+	}
+
+	return true;
+} /* end OS_FileCache_Probe */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCache_Free
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Called with OS_file_cache_mutex held.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FileCache_Free(OS_FileCacheEntry *entry)
+{
+	if(entry->data != NULL)
+	{
+		vPortFree(entry->data);
+		OS_file_cache_bytes -= entry->size;
+	}
+
+	memset(entry, 0, sizeof(*entry));
+} /* end OS_FileCache_Free */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCache_Invalidate
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Invalidates the entry of path and the entries below it, in
+ *           case it is a directory.  With a NULL path, invalidates the
+ *           entries whose path has the given hash, or all of them when
+ *           the hash is 0.  Called with OS_file_cache_mutex held.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FileCache_Invalidate(const char *path, uint32 hash)
+{
+	OS_FileCacheEntry *entry;
+	size_t len = 0;
+	uint32 i;
+	bool match;
+
+	if(path != NULL)
+	{
+		len = strlen(path);
+		while(len > 1 && path[len - 1] == '/')
+		{
+			--len;
+		}
+	}
+
+	for(i = 0; i < OS_FREERTOS_FILE_CACHE_ENTRIES; i++)
+	{
+		entry = &OS_file_cache_table[i];
+		if(!entry->valid && !entry->filling)
+		{
+			continue;
+		}
+
+		if(path != NULL)
+		{
+			match = (entry->hash == hash && strcmp(entry->Path, path) == 0) ||
+			        (strncmp(entry->Path, path, len) == 0 && entry->Path[len] == '/');
+		}
+		else
+		{
+			match = (hash == 0 || entry->hash == hash);
+		}
+
+		if(match && entry->filling)
+		{
+			/* OS_FileCache_Fill still owns it and drops it when done */
+			entry->stale = true;
+		}
+		else if(match)
+		{
+			entry->valid = false;
+			++OS_file_cache_stats.invalidations;
+			if(entry->refs == 0)
+			{
+				OS_FileCache_Free(entry);
+			}
+		}
+	}
+} /* end OS_FileCache_Invalidate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCache_Usable
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Whether the file may be served from or loaded into the cache,
+ *           which is not the case while a stream has it open for writing.
+ *           Returns the valid entry of the file in *found, if any.
+ *           Called with OS_file_cache_mutex held.
+ *
+ *-----------------------------------------------------------------*/
+static bool OS_FileCache_Usable(const char *local_path, uint32 hash, OS_FileCacheEntry **found)
+{
+	uint32 i;
+
+	*found = NULL;
+
+	for(i = 0; i < OS_MAX_NUM_OPEN_FILES; i++)
+	{
+		if(OS_file_cache_writer[i] == hash)
+		{
+			return false;
+		}
+	}
+
+	for(i = 0; i < OS_FREERTOS_FILE_CACHE_ENTRIES; i++)
+	{
+		if(OS_file_cache_table[i].valid && OS_file_cache_table[i].hash == hash &&
+		   strcmp(OS_file_cache_table[i].Path, local_path) == 0)
+		{
+			*found = &OS_file_cache_table[i];
+			break;
+		}
+	}
+
+	return true;
+} /* end OS_FileCache_Usable */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCache_Get
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns a referenced entry of the file if one is cached with
+ *           the given size and modification time.  An entry that no
+ *           longer matches the file is invalidated.
+ *
+ *-----------------------------------------------------------------*/
+static OS_FileCacheEntry *OS_FileCache_Get(const char *local_path, uint32 hash, uint32 size, uint64 mtime)
+{
+	OS_FileCacheEntry *entry;
+
+	xSemaphoreTake(OS_file_cache_mutex, portMAX_DELAY);
+
+	if(OS_FileCache_Usable(local_path, hash, &entry) && entry != NULL)
+	{
+		if(entry->size != size || entry->mtime != mtime)
+		{
+			/* changed outside OSAL, e.g. a host file edited on the PC */
+			entry->valid = false;
+			++OS_file_cache_stats.invalidations;
+			if(entry->refs == 0)
+			{
+				OS_FileCache_Free(entry);
+			}
+			entry = NULL;
+		}
+		else
+		{
+			++entry->refs;
+			entry->last_use = ++OS_file_cache_clock;
+		}
+	}
+	else
+	{
+		entry = NULL;
+	}
+
+	if(entry != NULL)
+	{
+		++OS_file_cache_stats.hits;
+	}
+	else
+	{
+		++OS_file_cache_stats.misses;
+	}
+
+	xSemaphoreGive(OS_file_cache_mutex);
+
+	return entry;
+} /* end OS_FileCache_Get */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCache_Reserve
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Reserves a free entry and size bytes of the cache for a file,
+ *           making room by dropping the least recently used entries
+ *           nobody reads.  Returns NULL if the file is already cached or
+ *           being loaded, is being written, or does not fit.
+ *           Called with OS_file_cache_mutex held.
+ *
+ *-----------------------------------------------------------------*/
+static OS_FileCacheEntry *OS_FileCache_Reserve(const char *local_path, uint32 hash, uint32 size)
+{
+	OS_FileCacheEntry *entry;
+	OS_FileCacheEntry *victim;
+	uint32 i;
+
+	/* another stream may have loaded the file, or started writing it, meanwhile */
+	if(!OS_FileCache_Usable(local_path, hash, &entry) || entry != NULL)
+	{
+		return NULL;
+	}
+
+	for(i = 0; i < OS_FREERTOS_FILE_CACHE_ENTRIES; i++)
+	{
+		if(OS_file_cache_table[i].filling && OS_file_cache_table[i].hash == hash &&
+		   strcmp(OS_file_cache_table[i].Path, local_path) == 0)
+		{
+			return NULL;
+		}
+	}
+
+	for(;;)
+	{
+		entry = NULL;
+		victim = NULL;
+		for(i = 0; i < OS_FREERTOS_FILE_CACHE_ENTRIES; i++)
+		{
+			if(OS_file_cache_table[i].filling)
+			{
+				continue;
+			}
+
+			if(OS_file_cache_table[i].data == NULL)
+			{
+				entry = &OS_file_cache_table[i];
+			}
+			else if(OS_file_cache_table[i].refs == 0 &&
+			        (victim == NULL || OS_file_cache_table[i].last_use < victim->last_use))
+			{
+				victim = &OS_file_cache_table[i];
+			}
+		}
+
+		if(entry != NULL && OS_file_cache_bytes + size <= OS_FREERTOS_FILE_CACHE_BYTES)
+		{
+			break;
+		}
+
+		if(victim == NULL)
+		{
+			return NULL;
+		}
+
+		OS_FileCache_Free(victim);
+		++OS_file_cache_stats.evictions;
+	}
+
+	memset(entry, 0, sizeof(*entry));
+	strcpy(entry->Path, local_path);
+	entry->hash = hash;
+	entry->size = size;
+	entry->filling = true;
+	OS_file_cache_bytes += size;
+
+	return entry;
+} /* end OS_FileCache_Reserve */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCache_Fill
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Reads the whole of a stream just opened read-only into a new
+ *           entry.  The entry is reserved under the cache mutex, filled
+ *           without it, so other opens are not held up by the read, and
+ *           published under it again.  On success the backend stream is
+ *           closed and a referenced entry is returned.  Otherwise the
+ *           stream is left open at its start and NULL is returned.
+ *
+ *-----------------------------------------------------------------*/
+static OS_FileCacheEntry *OS_FileCache_Fill(uint32 local_id, const char *local_path, uint32 hash,
+		uint32 size, uint64 mtime)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+	OS_FileCacheEntry *entry;
+	uint32 heap_category;
+	uint32 done;
+	uint8 extra;
+	uint8 *data;
+	int32 status;
+	bool complete;
+
+	if(size > OS_FREERTOS_FILE_CACHE_MAX_FILE || size > OS_FREERTOS_FILE_CACHE_BYTES ||
+	   strlen(local_path) >= OS_MAX_LOCAL_PATH_LEN)
+	{
+		return NULL;
+	}
+
+	xSemaphoreTake(OS_file_cache_mutex, portMAX_DELAY);
+	entry = OS_FileCache_Reserve(local_path, hash, size);
+	xSemaphoreGive(OS_file_cache_mutex);
+	if(entry == NULL)
+	{
+		return NULL;
+	}
+
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_FILESYS);
+	data = pvPortMalloc((size > 0) ? size : 1);
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+
+	done = 0;
+	while(data != NULL && done < size)
+	{
+		status = impl->ops->Read(local_id, &data[done], size - done, OS_PEND);
+		if(status <= 0)
+		{
+			break;
+		}
+		done += status;
+	}
+
+	/* the file must end where the probe said, or it changed while being read */
+	complete = (data != NULL && done == size && impl->ops->Read(local_id, &extra, 1, OS_PEND) <= 0);
+
+	xSemaphoreTake(OS_file_cache_mutex, portMAX_DELAY);
+	if(!complete || entry->stale)
+	{
+		OS_file_cache_bytes -= size;
+		memset(entry, 0, sizeof(*entry));
+		xSemaphoreGive(OS_file_cache_mutex);
+
+		vPortFree(data);
+		impl->ops->Seek(local_id, 0, SEEK_SET);
+		return NULL;
+	}
+
+	entry->filling = false;
+	entry->valid = true;
+	entry->refs = 1;
+	entry->last_use = ++OS_file_cache_clock;
+	entry->mtime = mtime;
+	entry->data = data;
+	xSemaphoreGive(OS_file_cache_mutex);
+
+	/*
+	 ** The contents are complete and checked, so the stream is served from
+	 ** the entry whatever the close says; the backend is gone either way
+	 ** and cannot be read or seeked again.
+	 */
+	if(impl->ops->Close(local_id) != OS_FS_SUCCESS)
+	{
+		OS_DEBUG("OS_FileCache_Fill: closing %s after caching it failed\n", local_path);
+	}
+
+	return entry;
+} /* end OS_FileCache_Fill */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCache_Release
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Drops a reference.  An entry that is no longer valid goes
+ *           with its last reader.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FileCache_Release(OS_FileCacheEntry *entry)
+{
+	xSemaphoreTake(OS_file_cache_mutex, portMAX_DELAY);
+
+	if(entry->refs > 0)
+	{
+		--entry->refs;
+	}
+	if(entry->refs == 0 && !entry->valid)
+	{
+		OS_FileCache_Free(entry);
+	}
+
+	xSemaphoreGive(OS_file_cache_mutex);
+} /* end OS_FileCache_Release */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Cached_Read
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Read operation of streams served from the file content cache.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Cached_Read(uint32 local_id, void *buffer, uint32 nbytes, int32 timeout)
+{
+	const OS_FileCacheEntry *entry = OS_impl_filehandle_fd[local_id];
+	uint32 position = OS_file_cache_position[local_id];
+
+	if(position >= entry->size)
+	{
+		/* the end of the file, reported as the backends do */
+		return OS_ERROR;
+	}
+
+	if(nbytes > entry->size - position)
+	{
+		nbytes = entry->size - position;
+	}
+
+	memcpy(buffer, &entry->data[position], nbytes);
+	OS_file_cache_position[local_id] = position + nbytes;
+
+	return nbytes;
+} /* end OS_Cached_Read */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Cached_Write
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Cached streams are opened read-only.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Cached_Write(uint32 local_id, const void *buffer, uint32 nbytes, int32 timeout)
+{
+	return OS_ERROR;
+} /* end OS_Cached_Write */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Cached_Seek
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Cached_Seek(uint32 local_id, int32 offset, int whence)
+{
+	const OS_FileCacheEntry *entry = OS_impl_filehandle_fd[local_id];
+	int64 position;
+
+	switch(whence)
+	{
+	case SEEK_SET:
+		position = offset;
+		break;
+	case SEEK_CUR:
+		position = (int64) OS_file_cache_position[local_id] + offset;
+		break;
+	case SEEK_END:
+		position = (int64) entry->size + offset;
+		break;
+	default:
+		return OS_FS_ERROR;
+	}
+
+	if(position < 0 || position > 0x7FFFFFFF)
+	{
+		return OS_FS_ERROR;
+	}
+
+	OS_file_cache_position[local_id] = (uint32) position;
+
+	return (int32) position;
+} /* end OS_Cached_Seek */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Cached_Close
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Cached_Close(uint32 local_id)
+{
+	OS_FileCache_Release(OS_impl_filehandle_fd[local_id]);
+
+	return OS_FS_SUCCESS;
+} /* end OS_Cached_Close */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Cached_Sync
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Cached_Sync(uint32 local_id)
+{
+	return OS_FS_SUCCESS;
+} /* end OS_Cached_Sync */
+
+static const OS_FreeRTOS_stream_ops_t OS_CachedStreamOps =
+{
+	.Read = OS_Cached_Read,
+	.Write = OS_Cached_Write,
+	.Seek = OS_Cached_Seek,
+	.Close = OS_Cached_Close,
+	.Sync = OS_Cached_Sync
+};
+#endif
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_FileCacheInvalidate
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_FileCacheInvalidate(const char *local_path)
+{
+#ifdef OS_FREERTOS_FILE_CACHE
+	if(OS_file_cache_mutex == NULL)
+	{
+		return;
+	}
+
+	xSemaphoreTake(OS_file_cache_mutex, portMAX_DELAY);
+	OS_FileCache_Invalidate(local_path, (local_path != NULL) ? OS_FileCache_Hash(local_path) : 0);
+	xSemaphoreGive(OS_file_cache_mutex);
+#endif
+} /* end OS_FreeRTOS_FileCacheInvalidate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileHandle_Lock
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes the lock of a seekable stream so that a transfer and
+ *           the position it works on cannot be interleaved with another
+ *           task's.  Sockets are not locked, so that one task can block
+ *           in a read while another writes.
+ *
+ *           Returns whether the lock was taken.
+ *
+ *-----------------------------------------------------------------*/
+static bool OS_FileHandle_Lock(uint32 local_id)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+
+	if(impl->ops == NULL || impl->ops->Seek == NULL)
+	{
+		return false;
+	}
+
+	xSemaphoreTake(impl->lock, portMAX_DELAY);
+	return true;
+} /* end OS_FileHandle_Lock */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileHandle_Unlock
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FileHandle_Unlock(uint32 local_id, bool locked)
+{
+	if(locked)
+	{
+		xSemaphoreGive(OS_impl_filehandle_table[local_id].lock);
+	}
+} /* end OS_FileHandle_Unlock */
+
+/****************************************************************************************
+ I/O API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_GenericClose_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_GenericClose_Impl(uint32 local_id)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+	int32 status;
+	bool locked;
+
+	OS_FREERTOS_API_ENTER(GenericClose);
+
+	if(impl->ops == NULL || impl->ops->Close == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(GenericClose, OS_FS_ERR_PATH_INVALID);
+	}
+
+	locked = OS_FileHandle_Lock(local_id);
+	status = impl->ops->Close(local_id);
+	OS_FileHandle_Unlock(local_id, locked);
+	if(status == OS_FS_SUCCESS)
+	{
+		if(impl->map_copy != NULL)
+		{
+			vPortFree(impl->map_copy);
+		}
+
+		impl->map_addr = NULL;
+		impl->map_copy = NULL;
+		OS_impl_filehandle_type[local_id] = -1;
+		OS_impl_filehandle_fd[local_id] = NULL;
+#ifdef OS_FREERTOS_FILE_CACHE
+		if(OS_file_cache_writer[local_id] != 0)
+		{
+			/* whatever was cached while the file was being written is stale */
+			xSemaphoreTake(OS_file_cache_mutex, portMAX_DELAY);
+			OS_FileCache_Invalidate(NULL, OS_file_cache_writer[local_id]);
+			OS_file_cache_writer[local_id] = 0;
+			xSemaphoreGive(OS_file_cache_mutex);
+		}
+#endif
+		impl->ops = NULL;
+		OS_impl_filehandle_flags[local_id] = 0;
+	}
+
+	return OS_FREERTOS_API_EXIT(GenericClose, status);
+} /* end OS_GenericClose_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_GenericSeek_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_GenericSeek_Impl(uint32 local_id, int32 offset, uint32 whence)
+{
+	const OS_FreeRTOS_stream_ops_t *ops = OS_impl_filehandle_table[local_id].ops;
+	int where;
+	int32 status;
+	bool locked;
+
+	OS_FREERTOS_API_ENTER(GenericSeek);
+
+	switch(whence)
+	{
+	case OS_SEEK_SET:
+		where = SEEK_SET;
+		break;
+	case OS_SEEK_CUR:
+		where = SEEK_CUR;
+		break;
+	case OS_SEEK_END:
+		where = SEEK_END;
+		break;
+	default:
+		return OS_FREERTOS_API_EXIT(GenericSeek, OS_FS_ERROR);
+	}
+
+	if(ops == NULL || ops->Seek == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(GenericSeek, OS_FS_ERR_PATH_INVALID);
+	}
+
+	locked = OS_FileHandle_Lock(local_id);
+	status = ops->Seek(local_id, offset, where);
+	OS_FileHandle_Unlock(local_id, locked);
+
+	return OS_FREERTOS_API_EXIT(GenericSeek, status);
+} /* end OS_GenericSeek_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_GenericRead_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_GenericRead_Impl(uint32 local_id, void *buffer, uint32 nbytes, int32 timeout)
+{
+	const OS_FreeRTOS_stream_ops_t *ops = OS_impl_filehandle_table[local_id].ops;
+	int32 status;
+	bool locked;
+
+	OS_FREERTOS_API_ENTER(GenericRead);
+
+	if(ops == NULL || ops->Read == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(GenericRead, OS_FS_ERR_PATH_INVALID);
+	}
+
+	if(nbytes == 0)
+	{
+		return OS_FREERTOS_API_EXIT(GenericRead, OS_SUCCESS);
+	}
+
+	locked = OS_FileHandle_Lock(local_id);
+	status = ops->Read(local_id, buffer, nbytes, timeout);
+	OS_FileHandle_Unlock(local_id, locked);
+
+	return OS_FREERTOS_API_EXIT(GenericRead, status);
+} /* end OS_GenericRead_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_GenericWrite_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_GenericWrite_Impl(uint32 local_id, const void *buffer, uint32 nbytes, int32 timeout)
+{
+	const OS_FreeRTOS_stream_ops_t *ops = OS_impl_filehandle_table[local_id].ops;
+	int32 status;
+	bool locked;
+
+	OS_FREERTOS_API_ENTER(GenericWrite);
+
+	if(ops == NULL || ops->Write == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(GenericWrite, OS_FS_ERR_PATH_INVALID);
+	}
+
+	if(nbytes == 0)
+	{
+		return OS_FREERTOS_API_EXIT(GenericWrite, OS_SUCCESS);
+	}
+
+	locked = OS_FileHandle_Lock(local_id);
+	status = ops->Write(local_id, buffer, nbytes, timeout);
+	OS_FileHandle_Unlock(local_id, locked);
+
+	return OS_FREERTOS_API_EXIT(GenericWrite, status);
+} /* end OS_GenericWrite_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_GenericWritev_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *           Runs of small elements are gathered into one staging buffer
+ *           so that a header, payload and trailer reach the backend as a
+ *           single write; elements that do not fit are written directly.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_GenericWritev_Impl(uint32 local_id, const OS_iovec_t *iov, uint32 iovcnt, int32 timeout)
+{
+	const OS_FreeRTOS_stream_ops_t *ops = OS_impl_filehandle_table[local_id].ops;
+	uint8 stage[OS_FREERTOS_IOV_STAGE_SIZE];
+	const uint8 *data;
+	uint32 stage_len;
+	uint32 total;
+	uint32 len;
+	uint32 i;
+	int32 status;
+
+	OS_FREERTOS_API_ENTER(GenericWritev);
+
+	if(ops == NULL || ops->Write == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(GenericWritev, OS_FS_ERR_PATH_INVALID);
+	}
+
+	total = 0;
+	stage_len = 0;
+	for(i = 0; i <= iovcnt; i++)
+	{
+		len = (i < iovcnt) ? iov[i].len : 0;
+
+		if(stage_len > 0 && (i == iovcnt || stage_len + len > sizeof(stage)))
+		{
+			status = ops->Write(local_id, stage, stage_len, timeout);
+			if(status < 0)
+			{
+				return OS_FREERTOS_API_EXIT(GenericWritev, (total > 0) ? (int32)total : status);
+			}
+			total += status;
+			if((uint32)status < stage_len)
+			{
+				return OS_FREERTOS_API_EXIT(GenericWritev, total);
+			}
+			stage_len = 0;
+		}
+
+		if(len == 0)
+		{
+			continue;
+		}
+
+		data = iov[i].base;
+		if(len > sizeof(stage))
+		{
+			status = ops->Write(local_id, data, len, timeout);
+			if(status < 0)
+			{
+				return OS_FREERTOS_API_EXIT(GenericWritev, (total > 0) ? (int32)total : status);
+			}
+			total += status;
+			if((uint32)status < len)
+			{
+				return OS_FREERTOS_API_EXIT(GenericWritev, total);
+			}
+		}
+		else
+		{
+			memcpy(&stage[stage_len], data, len);
+			stage_len += len;
+		}
+	}
+
+	return OS_FREERTOS_API_EXIT(GenericWritev, total);
+} /* end OS_GenericWritev_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_GenericReadv_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *           A request that fits the staging buffer is read with a single
+ *           backend call and scattered; larger ones are read element by
+ *           element, stopping at the first short read.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_GenericReadv_Impl(uint32 local_id, const OS_iovec_t *iov, uint32 iovcnt, int32 timeout)
+{
+	const OS_FreeRTOS_stream_ops_t *ops = OS_impl_filehandle_table[local_id].ops;
+	uint8 stage[OS_FREERTOS_IOV_STAGE_SIZE];
+	uint32 total;
+	uint32 done;
+	uint32 len;
+	uint32 i;
+	int32 status;
+
+	OS_FREERTOS_API_ENTER(GenericReadv);
+
+	if(ops == NULL || ops->Read == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(GenericReadv, OS_FS_ERR_PATH_INVALID);
+	}
+
+	total = 0;
+	for(i = 0; i < iovcnt; i++)
+	{
+		total += iov[i].len;
+	}
+
+	if(total == 0)
+	{
+		return OS_FREERTOS_API_EXIT(GenericReadv, OS_SUCCESS);
+	}
+
+	if(total <= sizeof(stage))
+	{
+		status = ops->Read(local_id, stage, total, timeout);
+		if(status <= 0)
+		{
+			return OS_FREERTOS_API_EXIT(GenericReadv, status);
+		}
+
+		done = 0;
+		for(i = 0; i < iovcnt && done < (uint32)status; i++)
+		{
+			len = iov[i].len;
+			if(len > (uint32)status - done)
+			{
+				len = (uint32)status - done;
+			}
+			memcpy(iov[i].base, &stage[done], len);
+			done += len;
+		}
+
+		return OS_FREERTOS_API_EXIT(GenericReadv, status);
+	}
+
+	done = 0;
+	for(i = 0; i < iovcnt; i++)
+	{
+		if(iov[i].len == 0)
+		{
+			continue;
+		}
+
+		status = ops->Read(local_id, iov[i].base, iov[i].len, timeout);
+		if(status <= 0)
+		{
+			return OS_FREERTOS_API_EXIT(GenericReadv, (done > 0) ? (int32)done : status);
+		}
+		done += status;
+		if((uint32)status < iov[i].len)
+		{
+			break;
+		}
+	}
+
+	return OS_FREERTOS_API_EXIT(GenericReadv, done);
+} /* end OS_GenericReadv_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_GenericPositional
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Does a transfer at the given offset and puts the stream position
+ *           back afterwards.  The caller holds the handle lock, so tasks
+ *           sharing the descriptor see neither each other's offsets nor a
+ *           moved position.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_GenericPositional(uint32 local_id, void *buffer, uint32 nbytes, int32 offset, bool is_write)
+{
+	const OS_FreeRTOS_stream_ops_t *ops = OS_impl_filehandle_table[local_id].ops;
+	int32 saved;
+	int32 status;
+
+	if(ops == NULL || ops->Seek == NULL)
+	{
+		/* not a seekable stream */
+		return OS_FS_ERR_PATH_INVALID;
+	}
+
+	if(offset < 0)
+	{
+		return OS_FS_ERROR;
+	}
+
+	saved = ops->Seek(local_id, 0, SEEK_CUR);
+	status = saved;
+	if(saved >= 0)
+	{
+		status = ops->Seek(local_id, offset, SEEK_SET);
+	}
+
+	if(status >= 0)
+	{
+		if(nbytes == 0)
+		{
+			status = OS_SUCCESS;
+		}
+		else if(is_write)
+		{
+			status = ops->Write(local_id, buffer, nbytes, OS_PEND);
+		}
+		else
+		{
+			status = ops->Read(local_id, buffer, nbytes, OS_PEND);
+		}
+
+		if(ops->Seek(local_id, saved, SEEK_SET) < 0 && status >= 0)
+		{
+			status = OS_FS_ERROR;
+		}
+	}
+	else
+	{
+		status = OS_FS_ERROR;
+	}
+
+	return status;
+} /* end OS_GenericPositional */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_GenericPread_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_GenericPread_Impl(uint32 local_id, void *buffer, uint32 nbytes, int32 offset)
+{
+	bool locked;
+	int32 status;
+
+	OS_FREERTOS_API_ENTER(GenericPread);
+
+	locked = OS_FileHandle_Lock(local_id);
+	status = OS_GenericPositional(local_id, buffer, nbytes, offset, false);
+	OS_FileHandle_Unlock(local_id, locked);
+
+	return OS_FREERTOS_API_EXIT(GenericPread, status);
+} /* end OS_GenericPread_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_GenericPwrite_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_GenericPwrite_Impl(uint32 local_id, const void *buffer, uint32 nbytes, int32 offset)
+{
+	bool locked;
+	int32 status;
+
+	OS_FREERTOS_API_ENTER(GenericPwrite);
+
+	locked = OS_FileHandle_Lock(local_id);
+	status = OS_GenericPositional(local_id, (void *)buffer, nbytes, offset, true);
+	OS_FileHandle_Unlock(local_id, locked);
+
+	return OS_FREERTOS_API_EXIT(GenericPwrite, status);
+} /* end OS_GenericPwrite_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileMap_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *           A RAM disk is a single heap buffer, so a file whose cluster
+ *           chain is contiguous can be handed out in place.  Otherwise
+ *           the file is read into a heap snapshot.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileMap_Impl(uint32 local_id, const void **addr, uint32 *size)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+	FF_FILE *file;
+	FF_IOManager_t *io;
+	FF_Error_t error;
+	uint32 cluster;
+	uint32 next;
+	uint32 cluster_bytes;
+	uint32 nclusters;
+	uint32 i;
+	bool contiguous;
+	int32 status;
+
+	OS_FREERTOS_API_ENTER(FileMap);
+
+#ifdef OS_FREERTOS_FILE_CACHE
+	if(impl->ops == &OS_CachedStreamOps)
+	{
+		const OS_FileCacheEntry *entry = OS_impl_filehandle_fd[local_id];
+
+		/* the cached copy does not change while the stream holds it */
+		xSemaphoreTake(impl->lock, portMAX_DELAY);
+		if(impl->map_addr != NULL)
+		{
+			status = OS_ERR_INCORRECT_OBJ_STATE;
+		}
+		else
+		{
+			*size = entry->size;
+			*addr = (entry->size > 0) ? entry->data : NULL;
+			impl->map_addr = *addr;
+			status = OS_SUCCESS;
+		}
+		xSemaphoreGive(impl->lock);
+
+		return OS_FREERTOS_API_EXIT(FileMap, status);
+	}
+#endif
+
+	if(OS_impl_filehandle_type[local_id] != RAM_DISK || impl->ops == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(FileMap, OS_ERR_NOT_IMPLEMENTED);
+	}
+
+	xSemaphoreTake(impl->lock, portMAX_DELAY);
+
+	if(impl->map_addr != NULL)
+	{
+		xSemaphoreGive(impl->lock);
+		return OS_FREERTOS_API_EXIT(FileMap, OS_ERR_INCORRECT_OBJ_STATE);
+	}
+
+	/* write out any buffered data and the FreeRTOS+FAT sector cache */
+	status = impl->ops->Sync(local_id);
+	if(status != OS_FS_SUCCESS)
+	{
+		xSemaphoreGive(impl->lock);
+		return OS_FREERTOS_API_EXIT(FileMap, status);
+	}
+
+	file = OS_impl_filehandle_fd[local_id];
+	io = file->pxIOManager;
+	*size = file->ulFileSize;
+	*addr = NULL;
+
+	if(file->ulFileSize == 0)
+	{
+		xSemaphoreGive(impl->lock);
+		return OS_FREERTOS_API_EXIT(FileMap, OS_SUCCESS);
+	}
+
+	cluster = file->ulObjectCluster;
+	cluster_bytes = io->xPartition.ulSectorsPerCluster * io->xPartition.usBlkSize;
+	nclusters = (file->ulFileSize + cluster_bytes - 1) / cluster_bytes;
+	contiguous = true;
+
+	FF_LockFAT(io);
+	for(i = 1; i < nclusters && contiguous; i++)
+	{
+		error = FF_ERR_NONE;
+		next = FF_getFATEntry(io, cluster, &error, NULL);
+		if(FF_isERR(error) || next != cluster + 1)
+		{
+			contiguous = false;
+		}
+		cluster = next;
+	}
+	FF_UnlockFAT(io);
+
+	if(contiguous)
+	{
+		/* FreeRTOS+FAT addresses the RAM disk in device sectors of the I/O manager's size */
+		impl->map_addr = (const uint8 *) io->xBlkDevice.pxDisk->pvTag +
+		                 (FF_getRealLBA(io, FF_Cluster2LBA(io, file->ulObjectCluster)) * io->usSectorSize);
+	}
+	else
+	{
+		impl->map_copy = pvPortMalloc(file->ulFileSize);
+		if(impl->map_copy == NULL)
+		{
+			xSemaphoreGive(impl->lock);
+			return OS_FREERTOS_API_EXIT(FileMap, OS_ERROR);
+		}
+
+		status = OS_GenericPositional(local_id, impl->map_copy, file->ulFileSize, 0, false);
+		if(status != (int32) file->ulFileSize)
+		{
+			vPortFree(impl->map_copy);
+			impl->map_copy = NULL;
+			xSemaphoreGive(impl->lock);
+			return OS_FREERTOS_API_EXIT(FileMap, OS_FS_ERROR);
+		}
+
+		impl->map_addr = impl->map_copy;
+	}
+
+	*addr = impl->map_addr;
+
+	xSemaphoreGive(impl->lock);
+
+	return OS_FREERTOS_API_EXIT(FileMap, OS_SUCCESS);
+} /* end OS_FileMap_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileUnmap_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileUnmap_Impl(uint32 local_id, const void *addr)
+{
+	OS_FreeRTOS_filehandle_entry_t *impl = &OS_impl_filehandle_table[local_id];
+	int32 status;
+
+	OS_FREERTOS_API_ENTER(FileUnmap);
+
+	if(addr == NULL)
+	{
+		/* the view of an empty file */
+		return OS_FREERTOS_API_EXIT(FileUnmap, OS_SUCCESS);
+	}
+
+	xSemaphoreTake(impl->lock, portMAX_DELAY);
+
+	if(impl->map_addr != addr)
+	{
+		status = OS_ERR_INCORRECT_OBJ_STATE;
+	}
+	else
+	{
+		if(impl->map_copy != NULL)
+		{
+			vPortFree(impl->map_copy);
+		}
+
+		impl->map_addr = NULL;
+		impl->map_copy = NULL;
+		status = OS_SUCCESS;
+	}
+
+	xSemaphoreGive(impl->lock);
+
+	return OS_FREERTOS_API_EXIT(FileUnmap, status);
+} /* end OS_FileUnmap_Impl */
+
+/****************************************************************************************
+ FILE COPY
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCopy_HostThread
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Win32 thread running a host copy or move, so that the task
+ *           that asked for it does not hold up the simulator meanwhile.
+ *
+ *-----------------------------------------------------------------*/
+static DWORD WINAPI OS_FileCopy_HostThread(LPVOID arg)
+{
+	OS_HostCopyJob *job = arg;
+
+	if(job->move)
+	{
+		job->ok = MoveFileExA(job->src, job->dest, MOVEFILE_COPY_ALLOWED | MOVEFILE_REPLACE_EXISTING);
+	}
+	else
+	{
+		job->ok = CopyFileExA(job->src, job->dest, NULL, NULL, NULL, 0);
+	}
+
+	return 0;
+} /* end OS_FileCopy_HostThread */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCopy_Host
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Copies or moves a host file to another host path with
+ *           CopyFileEx or MoveFileEx, which use the host's own fast
+ *           paths, and waits for it tick by tick.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FileCopy_Host(const char *src, const char *dest, bool move)
+{
+	OS_HostCopyJob job;
+	HANDLE thread;
+
+	job.src = src;
+	job.dest = dest;
+	job.move = move;
+	job.ok = FALSE;
+
+	thread = CreateThread(NULL, 0, OS_FileCopy_HostThread, &job, 0, NULL);
+	if(thread == NULL)
+	{
+		return OS_FS_ERROR;
+	}
+
+	if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+	{
+		while(WaitForSingleObject(thread, 0) == WAIT_TIMEOUT)
+		{
+			vTaskDelay(1);
+		}
+	}
+	else
+	{
+		WaitForSingleObject(thread, INFINITE);
+	}
+	CloseHandle(thread);
+
+	return job.ok ? OS_FS_SUCCESS : OS_FS_ERROR;
+} /* end OS_FileCopy_Host */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CopyEnd_Open
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Opens the source or destination of a chunked copy and returns
+ *           its cluster size, or 0 for a host file.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_CopyEnd_Open(OS_CopyEnd *end, const char *path, bool is_dest, uint32 *cluster)
+{
+	FF_IOManager_t *io;
+
+	*cluster = 0;
+
+	if(end->volume_type == RAM_DISK)
+	{
+		end->ff_file = ff_fopen(path, is_dest ? "wb" : "rb");
+		if(end->ff_file == NULL)
+		{
+			return OS_FS_ERROR;
+		}
+
+		io = end->ff_file->pxIOManager;
+		*cluster = io->xPartition.ulSectorsPerCluster * io->xPartition.usBlkSize;
+	}
+	else
+	{
+		end->host_file = CreateFileA(path, is_dest ? GENERIC_WRITE : GENERIC_READ, is_dest ? 0 : FILE_SHARE_READ,
+		                             NULL, is_dest ? CREATE_ALWAYS : OPEN_EXISTING,
+		                             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN | FILE_FLAG_OVERLAPPED, NULL);
+		if(end->host_file == INVALID_HANDLE_VALUE)
+		{
+			end->host_file = NULL;
+			return OS_FS_ERROR;
+		}
+	}
+
+	return OS_FS_SUCCESS;
+} /* end OS_CopyEnd_Open */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CopyEnd_HostTransfer
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Reads or writes the host end of a chunked copy.  The transfer
+ *           is overlapped and its completion polled, as OS_HostFile_Transfer
+ *           does, so the simulated kernel keeps running while the host
+ *           moves the data.  A read at the end of the file gives 0 bytes.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_CopyEnd_HostTransfer(OS_CopyEnd *end, uint8 *buffer, uint32 nbytes, bool is_write, uint32 *done)
+{
+	OVERLAPPED overlapped;
+	DWORD bytes = 0;
+	DWORD error;
+	BOOL ok;
+
+	*done = 0;
+
+	memset(&overlapped, 0, sizeof(overlapped));
+	overlapped.Offset = (DWORD) end->offset;
+	overlapped.OffsetHigh = (DWORD)(end->offset >> 32);
+
+	if(is_write)
+	{
+		ok = WriteFile(end->host_file, buffer, nbytes, NULL, &overlapped);
+	}
+	else
+	{
+		ok = ReadFile(end->host_file, buffer, nbytes, NULL, &overlapped);
+	}
+
+	if(!ok && GetLastError() != ERROR_IO_PENDING)
+	{
+		return (!is_write && GetLastError() == ERROR_HANDLE_EOF) ? OS_FS_SUCCESS : OS_FS_ERROR;
+	}
+
+	while(!GetOverlappedResult(end->host_file, &overlapped, &bytes, FALSE))
+	{
+		error = GetLastError();
+		if(error == ERROR_HANDLE_EOF && !is_write)
+		{
+			bytes = 0;
+			break;
+		}
+		if(error != ERROR_IO_INCOMPLETE)
+		{
+			return OS_FS_ERROR;
+		}
+
+		if(xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+		{
+			vTaskDelay(1);
+		}
+		else
+		{
+			Sleep(1);
+		}
+	}
+
+	end->offset += bytes;
+	*done = bytes;
+
+	return OS_FS_SUCCESS;
+} /* end OS_CopyEnd_HostTransfer */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_CopyEnd_Close
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_CopyEnd_Close(OS_CopyEnd *end)
+{
+	int32 status = OS_FS_SUCCESS;
+
+	if(end->ff_file != NULL && ff_fclose(end->ff_file) != 0)
+	{
+		status = OS_FS_ERROR;
+	}
+	if(end->host_file != NULL && !CloseHandle(end->host_file))
+	{
+		status = OS_FS_ERROR;
+	}
+
+	end->ff_file = NULL;
+	end->host_file = NULL;
+
+	return status;
+} /* end OS_CopyEnd_Close */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileCopy_Chunked
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Copies a file with a RAM disk on either side through one heap
+ *           chunk of whole clusters, so that FreeRTOS+FAT moves it in
+ *           multi-sector transfers past its sector cache.  The copy is
+ *           written under a temporary name and renamed over the
+ *           destination once complete, so an existing destination is only
+ *           replaced by a whole copy.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FileCopy_Chunked(const char *src, int32 src_type, const char *dest, int32 dest_type)
+{
+	OS_CopyEnd in;
+	OS_CopyEnd out;
+	char temp[OS_MAX_LOCAL_PATH_LEN + 2];
+	uint32 src_cluster;
+	uint32 dest_cluster;
+	uint32 chunk;
+	uint32 got;
+	uint32 done;
+	uint32 heap_category;
+	uint8 *buffer;
+	int32 status;
+
+	if(strlen(dest) + 1 >= sizeof(temp))
+	{
+		return OS_FS_ERR_PATH_TOO_LONG;
+	}
+	snprintf(temp, sizeof(temp), "%s~", dest);
+
+	memset(&in, 0, sizeof(in));
+	memset(&out, 0, sizeof(out));
+	in.volume_type = src_type;
+	out.volume_type = dest_type;
+
+	status = OS_CopyEnd_Open(&in, src, false, &src_cluster);
+	if(status != OS_FS_SUCCESS)
+	{
+		return status;
+	}
+
+	status = OS_CopyEnd_Open(&out, temp, true, &dest_cluster);
+	if(status != OS_FS_SUCCESS)
+	{
+		OS_CopyEnd_Close(&in);
+		return status;
+	}
+
+	if(dest_cluster > src_cluster)
+	{
+		src_cluster = dest_cluster;
+	}
+	chunk = OS_FREERTOS_FILE_COPY_CHUNK;
+	if(src_cluster > 0)
+	{
+		chunk = (chunk > src_cluster) ? chunk - (chunk % src_cluster) : src_cluster;
+	}
+
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_FILESYS);
+	buffer = pvPortMalloc(chunk);
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+	if(buffer == NULL)
+	{
+		status = OS_ERROR;
+	}
+
+	while(status == OS_FS_SUCCESS)
+	{
+		if(in.ff_file != NULL)
+		{
+			got = ff_fread(buffer, 1, chunk, in.ff_file);
+		}
+		else
+		{
+			status = OS_CopyEnd_HostTransfer(&in, buffer, chunk, false, &got);
+		}
+
+		if(status != OS_FS_SUCCESS || got == 0)
+		{
+			break;
+		}
+
+		if(out.ff_file != NULL)
+		{
+			if(ff_fwrite(buffer, 1, got, out.ff_file) != got)
+			{
+				status = OS_FS_ERROR;
+			}
+		}
+		else if(OS_CopyEnd_HostTransfer(&out, buffer, got, true, &done) != OS_FS_SUCCESS || done != got)
+		{
+			status = OS_FS_ERROR;
+		}
+	}
+
+	if(buffer != NULL)
+	{
+		vPortFree(buffer);
+	}
+
+	OS_CopyEnd_Close(&in);
+	if(OS_CopyEnd_Close(&out) != OS_FS_SUCCESS)
+	{
+		status = OS_FS_ERROR;
+	}
+
+	if(status == OS_FS_SUCCESS)
+	{
+		if(dest_type == RAM_DISK)
+		{
+			status = (ff_rename(temp, dest, pdTRUE) == 0) ? OS_FS_SUCCESS : OS_FS_ERROR;
+		}
+		else
+		{
+			status = MoveFileExA(temp, dest, MOVEFILE_REPLACE_EXISTING) ? OS_FS_SUCCESS : OS_FS_ERROR;
+		}
+	}
+
+	if(status != OS_FS_SUCCESS)
+	{
+		if(dest_type == RAM_DISK)
+		{
+			ff_remove(temp);
+		}
+		else
+		{
+			DeleteFileA(temp);
+		}
+	}
+
+	return status;
+} /* end OS_FileCopy_Chunked */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_FileCopy
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Copies or moves a file between two local paths on any pair of
+ *           RAM disk and host volumes.  A move that is not a rename on one
+ *           file system is a copy followed by removing the source.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FreeRTOS_FileCopy(const char *src, const char *dest, bool move)
+{
+	int32 src_type;
+	int32 dest_type;
+	int32 status;
+
+	src_type = OS_GetVolumeType(src);
+	dest_type = OS_GetVolumeType(dest);
+	if((src_type != RAM_DISK && src_type != FS_BASED) || (dest_type != RAM_DISK && dest_type != FS_BASED))
+	{
+		return OS_FS_ERR_PATH_INVALID;
+	}
+
+	if(strcmp(src, dest) == 0)
+	{
+		/* would truncate the source before reading it */
+		return OS_FS_ERROR;
+	}
+
+	if(src_type == FS_BASED && dest_type == FS_BASED)
+	{
+		status = OS_FileCopy_Host(src, dest, move);
+	}
+	else if(move && src_type == RAM_DISK && dest_type == RAM_DISK && ff_rename(src, dest, pdTRUE) == 0)
+	{
+		status = OS_FS_SUCCESS;
+	}
+	else
+	{
+		/* two RAM disks are separate FreeRTOS+FAT disks that ff_rename cannot move between */
+		status = OS_FileCopy_Chunked(src, src_type, dest, dest_type);
+		if(status == OS_FS_SUCCESS && move)
+		{
+			if(src_type == RAM_DISK)
+			{
+				status = (ff_remove(src) == 0) ? OS_FS_SUCCESS : OS_FS_ERROR;
+			}
+			else
+			{
+				status = DeleteFileA(src) ? OS_FS_SUCCESS : OS_FS_ERROR;
+			}
+		}
+	}
+
+	if(dest_type == RAM_DISK)
+	{
+		OS_FreeRTOS_DirSnapshotInvalidate(dest);
+	}
+	OS_FreeRTOS_FileCacheInvalidate(dest);
+	if(move)
+	{
+		if(src_type == RAM_DISK)
+		{
+			OS_FreeRTOS_DirSnapshotInvalidate(src);
+		}
+		OS_FreeRTOS_FileCacheInvalidate(src);
+	}
+
+	return status;
+} /* end OS_FreeRTOS_FileCopy */
+
+/****************************************************************************************
+ Named File API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileOpen_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileOpen_Impl(uint32 local_id, const char *local_path, int32 flags, int32 access)
+{
+	char *perm;
+	int32 volume_type;
+	const OS_FreeRTOS_stream_ops_t *ops;
+#ifdef OS_FREERTOS_FILE_CACHE
+	OS_FileCacheEntry *cache_entry = NULL;
+	uint32 cache_hash = 0;
+	uint32 cache_size;
+	uint64 cache_mtime;
+	bool cache_probed = false;
+#endif
+
+	OS_FREERTOS_API_ENTER(FileOpen);
+
+	/*
+	 ** Check for a valid access mode
+	 */
+	switch(access)
+	{
+	case OS_READ_ONLY:
+		perm = "rb";
+		break;
+	case OS_WRITE_ONLY:
+		perm = "wb";
+		break;
+	case OS_READ_WRITE:
+		perm = "w+b";
+		break;
+	default:
+		return OS_FREERTOS_API_EXIT(FileOpen, OS_FS_ERROR);
+	}
+
+	volume_type = OS_GetVolumeType(local_path);
+
+#ifdef OS_FREERTOS_FILE_CACHE
+	OS_file_cache_writer[local_id] = 0;
+	if(volume_type == RAM_DISK || volume_type == FS_BASED)
+	{
+		cache_hash = OS_FileCache_Hash(local_path);
+		if(access == OS_READ_ONLY && OS_FileCache_Probe(local_path, volume_type, &cache_size, &cache_mtime))
+		{
+			cache_probed = true;
+			cache_entry = OS_FileCache_Get(local_path, cache_hash, cache_size, cache_mtime);
+		}
+	}
+
+	if(cache_entry != NULL)
+	{
+		/* served from memory, the file itself is not opened */
+		OS_impl_filehandle_fd[local_id] = cache_entry;
+		OS_impl_filehandle_type[local_id] = volume_type;
+		OS_impl_filehandle_table[local_id].ops = &OS_CachedStreamOps;
+		OS_file_cache_position[local_id] = 0;
+		return OS_FREERTOS_API_EXIT(FileOpen, OS_FS_SUCCESS);
+	}
+#endif
+
+	if(volume_type == RAM_DISK)
+	{
+		OS_impl_filehandle_fd[local_id] = ff_fopen(local_path, perm);
+		ops = &OS_RamDiskStreamOps;
+		if(access != OS_READ_ONLY)
+		{
+			/* the file may have been created */
+			OS_FreeRTOS_DirSnapshotInvalidate(local_path);
+		}
+	}
+	else if(volume_type == FS_BASED)
+	{
+		OS_impl_filehandle_fd[local_id] = OS_HostFile_Open(local_id, local_path, flags, access);
+		ops = &OS_HostFileStreamOps;
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(FileOpen, OS_FS_ERR_PATH_INVALID);
+	}
+
+	if(OS_impl_filehandle_fd[local_id] == NULL)
+	{
+		return OS_FREERTOS_API_EXIT(FileOpen, OS_FS_ERROR);
+	}
+
+	OS_impl_filehandle_type[local_id] = volume_type;
+	OS_impl_filehandle_table[local_id].ops = ops;
+
+#ifdef OS_FREERTOS_FILE_CACHE
+	if(access != OS_READ_ONLY && cache_hash != 0)
+	{
+		/* the file is being rewritten: drop it, and keep it out of the cache until this stream is closed */
+		OS_file_cache_writer[local_id] = cache_hash;
+		OS_FreeRTOS_FileCacheInvalidate(local_path);
+	}
+	else if(cache_probed)
+	{
+		cache_entry = OS_FileCache_Fill(local_id, local_path, cache_hash, cache_size, cache_mtime);
+		if(cache_entry != NULL)
+		{
+			OS_impl_filehandle_fd[local_id] = cache_entry;
+			OS_impl_filehandle_table[local_id].ops = &OS_CachedStreamOps;
+			OS_file_cache_position[local_id] = 0;
+			return OS_FREERTOS_API_EXIT(FileOpen, OS_FS_SUCCESS);
+		}
+	}
+#endif
+
+	if((flags & OS_FILE_FLAG_BUFFERED) != 0)
+	{
+		/* Layer the buffer over the backend; without memory the stream just stays unbuffered */
+		OS_impl_filehandle_table[local_id].buffer = pvPortMalloc(OS_FREERTOS_FILE_BUFFER_SIZE);
+		if(OS_impl_filehandle_table[local_id].buffer != NULL)
+		{
+			OS_impl_filehandle_table[local_id].base_ops = ops;
+			OS_impl_filehandle_table[local_id].buffer_len = 0;
+			OS_impl_filehandle_table[local_id].buffer_pos = 0;
+			OS_impl_filehandle_table[local_id].buffer_state = OS_FREERTOS_BUFFER_IDLE;
+			OS_impl_filehandle_table[local_id].ops = &OS_BufferedStreamOps;
+		}
+		else
+		{
+			OS_DEBUG("OS_FileOpen_Impl: no memory for the stream buffer, opened unbuffered\n");
+		}
+	}
+
+	return OS_FREERTOS_API_EXIT(FileOpen, OS_FS_SUCCESS);
+} /* end OS_FileOpen_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileStat_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileStat_Impl(const char *local_path, os_fstat_t *FileStats)
+{
+	int32 volume_type;
+	int ret_val;
+
+	OS_FREERTOS_API_ENTER(FileStat);
+
+	volume_type = OS_GetVolumeType(local_path);
+
+	if(volume_type == RAM_DISK)
+	{
+		FF_Stat_t xStatBuffer;
+		ret_val = ff_stat(local_path, &xStatBuffer);
+
+		if(ret_val != 0)
+		{
+			return OS_FREERTOS_API_EXIT(FileStat, OS_FS_ERROR);
+		}
+		FileStats->FileModeBits = xStatBuffer.st_mode;
+		FileStats->FileSize = xStatBuffer.st_size;
+#if( ffconfigTIME_SUPPORT == 1 )
+		filestats->FileTime = xStatBuffer.st_ctime;
+#else
+		FileStats->FileTime = 0;
+#endif /* ffconfigTIME_SUPPORT */
+	}
+	else if(volume_type == FS_BASED)
+	{
+		struct stat xStatBuffer;
+		ret_val = stat(local_path, &xStatBuffer);
+
+		if(ret_val != 0)
+		{
+			return OS_FREERTOS_API_EXIT(FileStat, OS_FS_ERROR);
+		}
+		FileStats->FileModeBits = xStatBuffer.st_mode;
+		FileStats->FileSize = xStatBuffer.st_size;
+#if( ffconfigTIME_SUPPORT == 1 )
+		filestats->FileTime = xStatBuffer.st_ctime;
+#else
+		FileStats->FileTime = 0;
+#endif /* ffconfigTIME_SUPPORT */
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(FileStat, OS_FS_ERR_PATH_INVALID);
+	}
+
+	return OS_FREERTOS_API_EXIT(FileStat, OS_FS_SUCCESS);
+} /* end OS_FileStat_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileChmod_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileChmod_Impl(const char *local_path, uint32 access)
+{
+#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
+	return OS_FS_UNIMPLEMENTED;
+} /* end OS_FileChmod_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileRemove_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileRemove_Impl(const char *local_path)
+{
+	int status;
+	int32 volume_type;
+
+	OS_FREERTOS_API_ENTER(FileRemove);
+
+	volume_type = OS_GetVolumeType(local_path);
+
+	/*
+	 ** Call the system to remove the file
+	 */
+	if(volume_type == RAM_DISK)
+	{
+		status = ff_remove(local_path);
+		OS_FreeRTOS_DirSnapshotInvalidate(local_path);
+		OS_FreeRTOS_FileCacheInvalidate(local_path);
+	}
+	else if(volume_type == FS_BASED)
+	{
+		status = unlink(local_path);
+		OS_FreeRTOS_FileCacheInvalidate(local_path);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(FileRemove, OS_FS_ERR_PATH_INVALID);
+	}
+
+	if(status == 0)
+	{
+		return OS_FREERTOS_API_EXIT(FileRemove, OS_SUCCESS);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(FileRemove, OS_ERROR);
+	}
+} /* end OS_FileRemove_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileRename_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileRename_Impl(const char *old_path, const char *new_path)
+{
+	int status;
+	int32 volume_type;
+
+	OS_FREERTOS_API_ENTER(FileRename);
+
+	volume_type = OS_GetVolumeType(old_path);
+
+	if(volume_type != OS_GetVolumeType(new_path) && (volume_type == RAM_DISK || volume_type == FS_BASED))
+	{
+		/* neither file system can rename onto the other, so the file is copied over */
+		return OS_FREERTOS_API_EXIT(FileRename, OS_FreeRTOS_FileCopy(old_path, new_path, true));
+	}
+
+	if(volume_type == RAM_DISK)
+	{
+		status = ff_rename(old_path, new_path, pdTRUE);
+		OS_FreeRTOS_DirSnapshotInvalidate(old_path);
+		OS_FreeRTOS_DirSnapshotInvalidate(new_path);
+		OS_FreeRTOS_FileCacheInvalidate(old_path);
+		OS_FreeRTOS_FileCacheInvalidate(new_path);
+	}
+	else if(volume_type == FS_BASED)
+	{
+		status = rename(old_path, new_path);
+		OS_FreeRTOS_FileCacheInvalidate(old_path);
+		OS_FreeRTOS_FileCacheInvalidate(new_path);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(FileRename, OS_FS_ERR_PATH_INVALID);
+	}
+
+	if(status == 0)
+	{
+		//If this is a directory, there may be a need to update the file path for rewinds.
+		return OS_FREERTOS_API_EXIT(FileRename, OS_FS_SUCCESS);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(FileRename, OS_FS_ERROR);
+	}
+} /* end OS_FileRename_Impl */
+
+/****************************************************************************************
+ DIRECTORY ATTRIBUTES
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Dir_FatAttributes
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Size, mode and modification time of a FreeRTOS+FAT search
+ *           result, in the form OS_FileStat_Impl reports them.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Dir_FatAttributes(const FF_FindData_t *find, uint32 *size, uint32 *mode, int32 *time)
+{
+#if( ffconfigTIME_SUPPORT == 1 )
+	const FF_SystemTime_t *t = &find->xDirectoryEntry.xModifiedTime;
+	int32 year;
+	int32 month;
+	int32 days;
+#endif
+
+	*size = find->ulFileSize;
+	*mode = ((find->ucAttributes & FF_FAT_ATTR_DIR) != 0) ? FF_IFDIR : FF_IFREG;
+
+#if( ffconfigTIME_SUPPORT == 1 )
+	/* days since 1970 of a civil date, March based so that leap days come last */
+	year = t->Year - (t->Month <= 2);
+	month = t->Month + ((t->Month <= 2) ? 9 : -3);
+	days = 365 * year + year / 4 - year / 100 + year / 400 + (153 * month + 2) / 5 + t->Day - 1 - 719468;
+	*time = days * 86400 + t->Hour * 3600 + t->Minute * 60 + t->Second;
+#else
+	*time = 0;
+#endif
+} /* end OS_Dir_FatAttributes */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Dir_HostAttributes
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Size, mode and modification time of a Win32 search result,
+ *           in the form stat() reports them.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Dir_HostAttributes(const WIN32_FIND_DATAA *data, uint32 *size, uint32 *mode, int32 *time)
+{
+	ULARGE_INTEGER ticks;
+
+	*size = data->nFileSizeLow;
+	*mode = ((data->dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0) ? _S_IFDIR : _S_IFREG;
+	*mode |= _S_IREAD;
+	if((data->dwFileAttributes & FILE_ATTRIBUTE_READONLY) == 0)
+	{
+		*mode |= _S_IWRITE;
+	}
+
+	/* 100 nsec ticks since 1601 to seconds since 1970 */
+	ticks.LowPart = data->ftLastWriteTime.dwLowDateTime;
+	ticks.HighPart = data->ftLastWriteTime.dwHighDateTime;
+	*time = (int32) ((ticks.QuadPart - 116444736000000000ULL) / 10000000ULL);
+} /* end OS_Dir_HostAttributes */
+
+/****************************************************************************************
+ DIRECTORY SNAPSHOTS
+ ***************************************************************************************/
+
+#ifdef OS_FREERTOS_DIR_SNAPSHOTS
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirSnapshot_Free
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Called with OS_dir_snapshot_mutex held.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_DirSnapshot_Free(OS_DirSnapshot *snapshot)
+{
+	if(snapshot->entries != NULL)
+	{
+		vPortFree(snapshot->entries);
+	}
+
+	memset(snapshot, 0, sizeof(*snapshot));
+} /* end OS_DirSnapshot_Free */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirSnapshot_Build
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Lists the directory into the snapshot: one pass to size the
+ *           block, one to fill it.  An entry added between the passes is
+ *           left out; such a change invalidates the snapshot anyway.
+ *           Called with OS_dir_snapshot_mutex held.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_DirSnapshot_Build(OS_DirSnapshot *snapshot)
+{
+	FF_FindData_t *find;
+	uint32 count;
+	uint32 bytes;
+	uint32 used;
+	uint32 len;
+	uint8 *block;
+	OS_DirSnapshotEntry *entry;
+
+	/* Only needed while listing, so it does not sit in every directory entry */
+	find = pvPortMalloc(sizeof(*find));
+	if(find == NULL)
+	{
+		return OS_ERROR;
+	}
+
+	count = 0;
+	bytes = 0;
+	memset(find, 0, sizeof(*find));
+	if(ff_findfirst(snapshot->Path, find) != 0)
+	{
+		vPortFree(find);
+		return OS_FS_ERROR;
+	}
+	do
+	{
+		++count;
+		bytes += strlen(find->pcFileName) + 1;
+	}
+	while(ff_findnext(find) == 0);
+
+	block = pvPortMalloc(count * sizeof(OS_DirSnapshotEntry) + bytes);
+	if(block == NULL)
+	{
+		vPortFree(find);
+		return OS_ERROR;
+	}
+
+	snapshot->entries = (OS_DirSnapshotEntry *) block;
+	snapshot->names = (char *) &block[count * sizeof(OS_DirSnapshotEntry)];
+	snapshot->count = 0;
+	used = 0;
+
+	memset(find, 0, sizeof(*find));
+	if(ff_findfirst(snapshot->Path, find) == 0)
+	{
+		do
+		{
+			len = strlen(find->pcFileName) + 1;
+			if(snapshot->count == count || used + len > bytes)
+			{
+				break;
+			}
+
+			memcpy(&snapshot->names[used], find->pcFileName, len);
+			entry = &snapshot->entries[snapshot->count++];
+			entry->name = used;
+			OS_Dir_FatAttributes(find, &entry->size, &entry->mode, &entry->time);
+			used += len;
+		}
+		while(ff_findnext(find) == 0);
+	}
+
+	vPortFree(find);
+
+	return OS_FS_SUCCESS;
+} /* end OS_DirSnapshot_Build */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirSnapshot_Get
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns a referenced, valid snapshot of the directory, reusing
+ *           one when it exists.  Otherwise takes a free slot or the least
+ *           recently used unreferenced one and lists the directory into it.
+ *
+ *-----------------------------------------------------------------*/
+static OS_DirSnapshot *OS_DirSnapshot_Get(const char *local_path)
+{
+	OS_DirSnapshot *snapshot;
+	OS_DirSnapshot *victim;
+	size_t len;
+	uint32 i;
+
+	len = strlen(local_path);
+	while(len > 1 && local_path[len - 1] == '/')
+	{
+		--len;
+	}
+	if(len >= OS_MAX_LOCAL_PATH_LEN)
+	{
+		return NULL;
+	}
+
+	xSemaphoreTake(OS_dir_snapshot_mutex, portMAX_DELAY);
+
+	victim = NULL;
+	for(i = 0; i < OS_FREERTOS_DIR_SNAPSHOTS; i++)
+	{
+		snapshot = &OS_dir_snapshot_table[i];
+		if(snapshot->valid && strncmp(snapshot->Path, local_path, len) == 0 && snapshot->Path[len] == '\0')
+		{
+			++snapshot->refs;
+			snapshot->last_use = ++OS_dir_snapshot_clock;
+			xSemaphoreGive(OS_dir_snapshot_mutex);
+			return snapshot;
+		}
+
+		if(snapshot->refs == 0 &&
+		   (victim == NULL || !snapshot->valid || (victim->valid && snapshot->last_use < victim->last_use)))
+		{
+			victim = snapshot;
+		}
+	}
+
+	snapshot = victim;
+	if(snapshot != NULL)
+	{
+		OS_DirSnapshot_Free(snapshot);
+		memcpy(snapshot->Path, local_path, len);
+		snapshot->Path[len] = '\0';
+
+		if(OS_DirSnapshot_Build(snapshot) == OS_FS_SUCCESS)
+		{
+			snapshot->valid = true;
+			snapshot->refs = 1;
+			snapshot->last_use = ++OS_dir_snapshot_clock;
+		}
+		else
+		{
+			OS_DirSnapshot_Free(snapshot);
+			snapshot = NULL;
+		}
+	}
+
+	xSemaphoreGive(OS_dir_snapshot_mutex);
+
+	return snapshot;
+} /* end OS_DirSnapshot_Get */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirSnapshot_Release
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Drops a reference.  A snapshot that is no longer valid goes
+ *           with its last reader.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_DirSnapshot_Release(OS_DirSnapshot *snapshot)
+{
+	xSemaphoreTake(OS_dir_snapshot_mutex, portMAX_DELAY);
+
+	if(snapshot->refs > 0)
+	{
+		--snapshot->refs;
+	}
+	if(snapshot->refs == 0 && !snapshot->valid)
+	{
+		OS_DirSnapshot_Free(snapshot);
+	}
+
+	xSemaphoreGive(OS_dir_snapshot_mutex);
+} /* end OS_DirSnapshot_Release */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirSnapshot_Invalidate
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Invalidates the snapshot of the first len characters of path,
+ *           all of them when path is NULL.  Called with
+ *           OS_dir_snapshot_mutex held.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_DirSnapshot_Invalidate(const char *path, size_t len)
+{
+	OS_DirSnapshot *snapshot;
+	uint32 i;
+
+	for(i = 0; i < OS_FREERTOS_DIR_SNAPSHOTS; i++)
+	{
+		snapshot = &OS_dir_snapshot_table[i];
+		if(!snapshot->valid)
+		{
+			continue;
+		}
+
+		if(path == NULL || (strncmp(snapshot->Path, path, len) == 0 && snapshot->Path[len] == '\0'))
+		{
+			snapshot->valid = false;
+			if(snapshot->refs == 0)
+			{
+				OS_DirSnapshot_Free(snapshot);
+			}
+		}
+	}
+} /* end OS_DirSnapshot_Invalidate */
+#endif
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_DirSnapshotInvalidate
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_DirSnapshotInvalidate(const char *local_path)
+{
+#ifdef OS_FREERTOS_DIR_SNAPSHOTS
+	size_t len;
+	size_t parent;
+
+	if(OS_dir_snapshot_mutex == NULL)
+	{
+		return;
+	}
+
+	xSemaphoreTake(OS_dir_snapshot_mutex, portMAX_DELAY);
+
+	if(local_path == NULL)
+	{
+		OS_DirSnapshot_Invalidate(NULL, 0);
+	}
+	else
+	{
+		len = strlen(local_path);
+		while(len > 1 && local_path[len - 1] == '/')
+		{
+			--len;
+		}
+
+		/* the path itself, in case it is a directory, and the directory holding it */
+		OS_DirSnapshot_Invalidate(local_path, len);
+		parent = len;
+		while(parent > 0 && local_path[parent - 1] != '/')
+		{
+			--parent;
+		}
+		if(parent > 1)
+		{
+			--parent;
+		}
+		OS_DirSnapshot_Invalidate(local_path, parent);
+	}
+
+	xSemaphoreGive(OS_dir_snapshot_mutex);
+#endif
+} /* end OS_FreeRTOS_DirSnapshotInvalidate */
+
+/****************************************************************************************
+ Directory API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirCreate_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_DirCreate_Impl(const char *local_path, uint32 access)
+{
+    int status;
+	int32 volume_type;
+
+    OS_FREERTOS_API_ENTER(DirCreate);
+
+	volume_type = OS_GetVolumeType(local_path);
+
+	if(volume_type == RAM_DISK)
+	{
+		status = ff_mkdir(local_path);
+		OS_FreeRTOS_DirSnapshotInvalidate(local_path);
+	}
+	else if(volume_type == FS_BASED)
+	{
+		status = mkdir(local_path);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(DirCreate, OS_FS_ERR_PATH_INVALID);
+	}
+
+	if(status == 0)
+	{
+		return OS_FREERTOS_API_EXIT(DirCreate, OS_FS_SUCCESS);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(DirCreate, OS_FS_ERROR);
+	}
+} /* end OS_DirCreate_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostDir_Open
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Starts a Win32 search of a host directory.  The first entry
+ *           is kept pending for the first read.
+ *
+ *-----------------------------------------------------------------*/
+static OS_HostDir *OS_HostDir_Open(const char *local_path)
+{
+	OS_HostDir *host;
+	size_t len;
+
+	len = strlen(local_path);
+	if(len + 2 >= sizeof(host->pattern))
+	{
+		return NULL;
+	}
+
+	host = pvPortMalloc(sizeof(*host));
+	if(host == NULL)
+	{
+		return NULL;
+	}
+
+	memcpy(host->pattern, local_path, len);
+	if(len > 0 && local_path[len - 1] != '/' && local_path[len - 1] != '\\')
+	{
+		host->pattern[len++] = '/';
+	}
+	host->pattern[len++] = '*';
+	host->pattern[len] = '\0';
+
+	host->handle = FindFirstFileA(host->pattern, &host->data);
+	if(host->handle == INVALID_HANDLE_VALUE)
+	{
+		vPortFree(host);
+		return NULL;
+	}
+	host->pending = true;
+
+	return host;
+} /* end OS_HostDir_Open */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_HostDir_Next
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns the next search result, or NULL at the end.
+ *
+ *-----------------------------------------------------------------*/
+static const WIN32_FIND_DATAA *OS_HostDir_Next(OS_HostDir *host)
+{
+	if(host->pending)
+	{
+		host->pending = false;
+		return &host->data;
+	}
+
+	if(host->handle == INVALID_HANDLE_VALUE || !FindNextFileA(host->handle, &host->data))
+	{
+		return NULL;
+	}
+
+	return &host->data;
+} /* end OS_HostDir_Next */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Dir_Next
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Reads the next entry of an open directory: its name and,
+ *           when attr is not NULL, its attributes.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Dir_Next(uint32 local_id, char *name, OS_dirent_attr_t *attr)
+{
+	OS_DirTableEntry *impl = &OS_impl_dir_table[local_id];
+	const char *found;
+	uint32 size;
+	uint32 mode;
+	int32 time;
+
+	if(impl->VolumeType == RAM_DISK)
+	{
+#ifdef OS_FREERTOS_DIR_SNAPSHOTS
+		const OS_DirSnapshotEntry *entry;
+
+		if(impl->position >= impl->dir.snapshot->count)
+		{
 			return OS_FS_ERROR;
 		}
-		FileStats->FileModeBits = xStatBuffer.st_mode;
-		FileStats->FileSize = xStatBuffer.st_size;
-#if( ffconfigTIME_SUPPORT == 1 )
-		filestats->FileTime = xStatBuffer.st_ctime;
+
+		entry = &impl->dir.snapshot->entries[impl->position++];
+		found = &impl->dir.snapshot->names[entry->name];
+		size = entry->size;
+		mode = entry->mode;
+		time = entry->time;
 #else
-		FileStats->FileTime = 0;
-#endif /* ffconfigTIME_SUPPORT */
+		switch(impl->state)
+		{
+		case DirTableEntryStateAfterFindFirst:
+			/* do nothing */
+			break;
+
+		case DirTableEntryStateAfterFindNext:
+			/* read the next entry */
+			if(ff_findnext(&impl->dir.xFindData) != 0)
+			{
+				return OS_FS_ERROR;
+			}
+			break;
+
+		case DirTableEntryStateUndefined:
+		default:
+			return OS_FS_ERROR;
+		}
+
+		impl->state = DirTableEntryStateAfterFindNext;
+		found = impl->dir.xFindData.pcFileName;
+		OS_Dir_FatAttributes(&impl->dir.xFindData, &size, &mode, &time);
+#endif
+	}
+	else if(impl->VolumeType == FS_BASED)
+	{
+		const WIN32_FIND_DATAA *data;
+
+		data = OS_HostDir_Next(impl->dir.host);
+		if(data == NULL)
+		{
+			return OS_FS_ERROR;
+		}
+
+		found = data->cFileName;
+		OS_Dir_HostAttributes(data, &size, &mode, &time);
+	}
+	else
+	{
+		return OS_FS_ERROR;
+	}
+
+	strncpy(name, found, OS_MAX_PATH_LEN);
+	name[OS_MAX_PATH_LEN - 1] = '\0';
+
+	if(attr != NULL)
+	{
+		attr->FileSize = size;
+		attr->FileModeBits = mode;
+		attr->FileTime = time;
+	}
+
+	return OS_FS_SUCCESS;
+} /* end OS_Dir_Next */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirOpen_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_DirOpen_Impl(uint32 local_id, const char *local_path)
+{
+	int32 volume_type;
+	bool opened;
+
+	OS_FREERTOS_API_ENTER(DirOpen);
+
+	volume_type = OS_GetVolumeType(local_path);
+
+	if(volume_type == RAM_DISK)
+	{
+#ifdef OS_FREERTOS_DIR_SNAPSHOTS
+		OS_impl_dir_table[local_id].dir.snapshot = OS_DirSnapshot_Get(local_path);
+		OS_impl_dir_table[local_id].position = 0;
+		opened = (OS_impl_dir_table[local_id].dir.snapshot != NULL);
+#else
+		opened = (ff_findfirst(local_path, &OS_impl_dir_table[local_id].dir.xFindData) == 0);
+#endif
+	}
+	else if(volume_type == FS_BASED)
+	{
+		OS_impl_dir_table[local_id].dir.host = OS_HostDir_Open(local_path);
+		opened = (OS_impl_dir_table[local_id].dir.host != NULL);
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(DirOpen, OS_FS_ERROR);
+	}
+
+	if(opened)
+	{
+		strncpy(OS_impl_dir_table[local_id].Path, local_path, OS_MAX_PATH_LEN);
+		OS_impl_dir_table[local_id].VolumeType = volume_type;
+		OS_impl_dir_table[local_id].state = DirTableEntryStateAfterFindFirst;
+		return OS_FREERTOS_API_EXIT(DirOpen, OS_FS_SUCCESS);
 	}
-	else if(volume_type == FS_BASED)
+	else
 	{
-		struct stat xStatBuffer;
-		ret_val = stat(local_path, &xStatBuffer);
+		strcpy(OS_impl_dir_table[local_id].Path, "\0");
+		OS_impl_dir_table[local_id].state = DirTableEntryStateUndefined;
+		return OS_FREERTOS_API_EXIT(DirOpen, OS_FS_ERROR);
+	}
+} /* end OS_DirOpen_Impl */
 
-		if(ret_val != 0)
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirClose_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_DirClose_Impl(uint32 local_id)
+{
+	OS_FREERTOS_API_ENTER(DirClose);
+
+	if(OS_impl_dir_table[local_id].VolumeType == RAM_DISK)
+	{
+#ifdef OS_FREERTOS_DIR_SNAPSHOTS
+		OS_DirSnapshot_Release(OS_impl_dir_table[local_id].dir.snapshot);
+		OS_impl_dir_table[local_id].dir.snapshot = NULL;
+#endif
+	}
+	else if(OS_impl_dir_table[local_id].VolumeType == FS_BASED)
+	{
+		if(OS_impl_dir_table[local_id].dir.host->handle != INVALID_HANDLE_VALUE &&
+		   !FindClose(OS_impl_dir_table[local_id].dir.host->handle))
 		{
-			return OS_FS_ERROR;
+			return OS_FREERTOS_API_EXIT(DirClose, OS_FS_ERROR);
 		}
-		FileStats->FileModeBits = xStatBuffer.st_mode;
-		FileStats->FileSize = xStatBuffer.st_size;
-#if( ffconfigTIME_SUPPORT == 1 )
-		filestats->FileTime = xStatBuffer.st_ctime;
-#else
-		FileStats->FileTime = 0;
-#endif /* ffconfigTIME_SUPPORT */
+		vPortFree(OS_impl_dir_table[local_id].dir.host);
+		OS_impl_dir_table[local_id].dir.host = NULL;
 	}
 	else
 	{
-		return OS_FS_ERR_PATH_INVALID;
+		return OS_FREERTOS_API_EXIT(DirClose, OS_FS_ERR_PATH_INVALID);
 	}
 
-	return OS_FS_SUCCESS;
-} /* end OS_FileStat_Impl */
+	strcpy(OS_impl_dir_table[local_id].Path, "\0");
+	OS_impl_dir_table[local_id].VolumeType = -1;
+	OS_impl_dir_table[local_id].state = DirTableEntryStateUndefined;
+
+	return OS_FREERTOS_API_EXIT(DirClose, OS_FS_SUCCESS);
+} /* end OS_DirClose_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FileChmod_Impl
+ * Function: OS_DirRead_Impl
  *
  *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_FileChmod_Impl(const char *local_path, uint32 access)
+int32 OS_DirRead_Impl(uint32 local_id, os_dirent_t *dirent)
 {
-#warning OS_ERR_NOT_IMPLEMENTED: This function must be implemented on the specific hardware platform
-	return OS_FS_UNIMPLEMENTED;
-} /* end OS_FileChmod_Impl */
+	OS_FREERTOS_API_ENTER(DirRead);
+
+	return OS_FREERTOS_API_EXIT(DirRead, OS_Dir_Next(local_id, dirent->FileName, NULL));
+} /* end OS_DirRead_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FileRemove_Impl
+ * Function: OS_DirReadAttributes_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_DirReadAttributes_Impl(uint32 local_id, OS_dirent_attr_t *entries, uint32 max_entries, uint32 *count)
+{
+	OS_FREERTOS_API_ENTER(DirReadAttributes);
+
+	*count = 0;
+	while(*count < max_entries)
+	{
+		if(OS_Dir_Next(local_id, entries[*count].FileName, &entries[*count]) != OS_FS_SUCCESS)
+		{
+			break;
+		}
+		++(*count);
+	}
+
+	/* Like OS_DirRead, the end of the directory is an error when nothing was read */
+	if(*count == 0 && max_entries > 0)
+	{
+		return OS_FREERTOS_API_EXIT(DirReadAttributes, OS_FS_ERROR);
+	}
+
+	return OS_FREERTOS_API_EXIT(DirReadAttributes, OS_FS_SUCCESS);
+} /* end OS_DirReadAttributes_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirRewind_Impl
  *
  *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *           See prototype in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_FileRemove_Impl(const char *local_path)
+int32 OS_DirRewind_Impl(uint32 local_id)
+{
+	OS_FREERTOS_API_ENTER(DirRewind);
+
+	if(OS_impl_dir_table[local_id].VolumeType == RAM_DISK)
+	{
+#ifdef OS_FREERTOS_DIR_SNAPSHOTS
+		OS_DirSnapshot *snapshot = OS_impl_dir_table[local_id].dir.snapshot;
+
+		/* Still current: just start over, otherwise list the directory again */
+		if(!snapshot->valid)
+		{
+			snapshot = OS_DirSnapshot_Get(OS_impl_dir_table[local_id].Path);
+			if(snapshot == NULL)
+			{
+				return OS_FREERTOS_API_EXIT(DirRewind, OS_FS_ERROR);
+			}
+
+			OS_DirSnapshot_Release(OS_impl_dir_table[local_id].dir.snapshot);
+			OS_impl_dir_table[local_id].dir.snapshot = snapshot;
+		}
+
+		OS_impl_dir_table[local_id].position = 0;
+#else
+		char path[OS_MAX_LOCAL_PATH_LEN];
+		strncpy(path, OS_impl_dir_table[local_id].Path, OS_MAX_PATH_LEN);
+
+		if(OS_DirClose_Impl(local_id) != OS_FS_SUCCESS)
+		{
+			return OS_FREERTOS_API_EXIT(DirRewind, OS_FS_ERROR);
+		}
+
+		//This may fail if there are multiple levels of directories and
+		//higher directories get renamed without the lower directories
+		//getting their path updated.
+		if(OS_DirOpen_Impl(local_id, path) != OS_FS_SUCCESS)
+		{
+			return OS_FREERTOS_API_EXIT(DirRewind, OS_FS_ERROR);
+		}
+#endif
+	}
+	else if(OS_impl_dir_table[local_id].VolumeType == FS_BASED)
+	{
+		OS_HostDir *host = OS_impl_dir_table[local_id].dir.host;
+
+		if(host->handle != INVALID_HANDLE_VALUE)
+		{
+			FindClose(host->handle);
+		}
+
+		/* On failure the directory just reads as empty from here on */
+		host->handle = FindFirstFileA(host->pattern, &host->data);
+		host->pending = (host->handle != INVALID_HANDLE_VALUE);
+		if(!host->pending)
+		{
+			return OS_FREERTOS_API_EXIT(DirRewind, OS_FS_ERROR);
+		}
+	}
+	else
+	{
+		return OS_FREERTOS_API_EXIT(DirRewind, OS_FS_ERROR);
+	}
+
+	return OS_FREERTOS_API_EXIT(DirRewind, OS_FS_SUCCESS);
+} /* end OS_DirRewind_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirRemove_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_DirRemove_Impl(const char *local_path)
 {
 	int status;
 	int32 volume_type;
 
+	OS_FREERTOS_API_ENTER(DirRemove);
+
 	volume_type = OS_GetVolumeType(local_path);
 
-	/*
-	 ** Call the system to remove the file
-	 */
 	if(volume_type == RAM_DISK)
 	{
-		status = ff_remove(local_path);
+		status = ff_rmdir(local_path);
+		OS_FreeRTOS_DirSnapshotInvalidate(local_path);
 	}
 	else if(volume_type == FS_BASED)
 	{
-		status = unlink(local_path);
+		status = rmdir(local_path);
 	}
 	else
 	{
-		return OS_FS_ERR_PATH_INVALID;
+		return OS_FREERTOS_API_EXIT(DirRemove, OS_FS_ERR_PATH_INVALID);
 	}
 
 	if(status == 0)
 	{
-		return OS_SUCCESS;
+		return OS_FREERTOS_API_EXIT(DirRemove, OS_FS_SUCCESS);
 	}
 	else
+	{
+		return OS_FREERTOS_API_EXIT(DirRemove, OS_FS_ERROR);
+	}
+} /* end OS_DirRemove_Impl */
+
+#ifdef OS_FREERTOS_FILE_ASYNC
+/****************************************************************************************
+ ASYNCHRONOUS FILE I/O
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileAsync_Execute
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Carries out one request in the worker task.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FileAsync_Execute(OS_file_async_request_t *request)
+{
+	OS_common_record_t *record;
+	const OS_FreeRTOS_stream_ops_t *ops;
+	uint32 local_id;
+	int32 return_code;
+	bool locked;
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_REFCOUNT, OS_OBJECT_TYPE_OS_STREAM, request->filedes, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		switch(request->op)
+		{
+		case OS_FILE_ASYNC_READ:
+			if(request->offset < 0)
+			{
+				return_code = OS_GenericRead_Impl(local_id, request->buffer, request->nbytes, OS_PEND);
+			}
+			else
+			{
+				return_code = OS_GenericPread_Impl(local_id, request->buffer, request->nbytes, request->offset);
+			}
+			break;
+		case OS_FILE_ASYNC_WRITE:
+			if(request->offset < 0)
+			{
+				return_code = OS_GenericWrite_Impl(local_id, request->buffer, request->nbytes, OS_PEND);
+			}
+			else
+			{
+				return_code = OS_GenericPwrite_Impl(local_id, request->buffer, request->nbytes, request->offset);
+			}
+			break;
+		case OS_FILE_ASYNC_FLUSH:
+			ops = OS_impl_filehandle_table[local_id].ops;
+			if(ops == NULL || ops->Sync == NULL)
+			{
+				return_code = OS_ERR_NOT_IMPLEMENTED;
+			}
+			else
+			{
+				locked = OS_FileHandle_Lock(local_id);
+				return_code = ops->Sync(local_id);
+				OS_FileHandle_Unlock(local_id, locked);
+			}
+			break;
+		default:
+			return_code = OS_ERR_NOT_IMPLEMENTED;
+			break;
+		}
+		OS_ObjectIdRefcountDecr(record);
+	}
+
+	return return_code;
+} /* end OS_FileAsync_Execute */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileAsync_Entry
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           The asynchronous I/O worker.  Serves requests in submission
+ *           order and signals each one's completion as it asked.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FileAsync_Entry(void *arg)
+{
+	OS_file_async_request_t *request;
+	void *submitter;
+	uint32 notify;
+	uint32 notify_id;
+	int32 status;
+
+	for(;;)
+	{
+		if(xQueueReceive(OS_file_async_queue, &request, portMAX_DELAY) != pdPASS)
+		{
+			continue;
+		}
+
+		status = OS_FileAsync_Execute(request);
+
+		if(request->notify == OS_FILE_ASYNC_NOTIFY_CALLBACK)
+		{
+			/* The callback is the completion, done is set for pollers only */
+			request->status = status;
+			request->done = true;
+			request->callback(request);
+			continue;
+		}
+
+		/* A poller may reuse the request as soon as done is seen, so signal from copies */
+		notify = request->notify;
+		notify_id = request->notify_id;
+		submitter = request->submitter;
+
+		request->status = status;
+		request->done = true;
+
+		if(notify == OS_FILE_ASYNC_NOTIFY_SEMAPHORE)
+		{
+			OS_BinSemGive(notify_id);
+		}
+		else if(notify == OS_FILE_ASYNC_NOTIFY_TASK)
+		{
+			xTaskNotifyGive((TaskHandle_t) submitter);
+		}
+	}
+} /* end OS_FileAsync_Entry */
+#endif
+
+/****************************************************************************************
+ FILE EXTENSION API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileFlush
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileFlush(uint32 filedes)
+{
+	OS_common_record_t *record;
+	const OS_FreeRTOS_stream_ops_t *ops;
+	uint32 local_id;
+	int32 return_code;
+	bool locked;
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_REFCOUNT, OS_OBJECT_TYPE_OS_STREAM, filedes, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		ops = OS_impl_filehandle_table[local_id].ops;
+		if(ops == NULL || ops->Sync == NULL)
+		{
+			return_code = OS_ERR_NOT_IMPLEMENTED;
+		}
+		else
+		{
+			locked = OS_FileHandle_Lock(local_id);
+			return_code = ops->Sync(local_id);
+			OS_FileHandle_Unlock(local_id, locked);
+		}
+		OS_ObjectIdRefcountDecr(record);
+	}
+
+	return return_code;
+} /* end OS_FileFlush */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileVectorIo
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Common part of OS_readv and OS_writev.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FileVectorIo(uint32 filedes, const OS_iovec_t *iov, uint32 iovcnt, bool is_write)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	uint32 i;
+	int32 return_code;
+	bool locked;
+
+	if(iov == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	if(iovcnt > OS_IOV_MAX)
 	{
 		return OS_ERROR;
 	}
-} /* end OS_FileRemove_Impl */
+
+	for(i = 0; i < iovcnt; i++)
+	{
+		if(iov[i].base == NULL && iov[i].len > 0)
+		{
+			return OS_INVALID_POINTER;
+		}
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_REFCOUNT, OS_OBJECT_TYPE_OS_STREAM, filedes, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		locked = OS_FileHandle_Lock(local_id);
+		if(is_write)
+		{
+			return_code = OS_GenericWritev_Impl(local_id, iov, iovcnt, OS_PEND);
+		}
+		else
+		{
+			return_code = OS_GenericReadv_Impl(local_id, iov, iovcnt, OS_PEND);
+		}
+		OS_FileHandle_Unlock(local_id, locked);
+		OS_ObjectIdRefcountDecr(record);
+	}
+
+	return return_code;
+} /* end OS_FileVectorIo */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_writev
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_writev(uint32 filedes, const OS_iovec_t *iov, uint32 iovcnt)
+{
+	return OS_FileVectorIo(filedes, iov, iovcnt, true);
+} /* end OS_writev */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FileRename_Impl
+ * Function: OS_readv
  *
- *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_FileRename_Impl(const char *old_path, const char *new_path)
+int32 OS_readv(uint32 filedes, const OS_iovec_t *iov, uint32 iovcnt)
 {
-	int status;
-	int32 volume_type;
+	return OS_FileVectorIo(filedes, iov, iovcnt, false);
+} /* end OS_readv */
 
-	volume_type = OS_GetVolumeType(old_path);
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FilePositionalIo
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Common part of OS_pread and OS_pwrite.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_FilePositionalIo(uint32 filedes, void *buffer, uint32 nbytes, int32 offset, bool is_write)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
 
-	if(volume_type == RAM_DISK)
-	{
-		status = ff_rename(old_path, new_path, pdTRUE);
-	}
-	else if(volume_type == FS_BASED)
-	{
-		status = rename(old_path, new_path);
-	}
-	else
+	if(buffer == NULL)
 	{
-		return OS_FS_ERR_PATH_INVALID;
+		return OS_INVALID_POINTER;
 	}
 
-	if(status == 0)
-	{
-		//If this is a directory, there may be a need to update the file path for rewinds.
-		return OS_FS_SUCCESS;
-	}
-	else
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_REFCOUNT, OS_OBJECT_TYPE_OS_STREAM, filedes, &local_id, &record);
+	if(return_code == OS_SUCCESS)
 	{
-		return OS_FS_ERROR;
+		if(is_write)
+		{
+			return_code = OS_GenericPwrite_Impl(local_id, buffer, nbytes, offset);
+		}
+		else
+		{
+			return_code = OS_GenericPread_Impl(local_id, buffer, nbytes, offset);
+		}
+		OS_ObjectIdRefcountDecr(record);
 	}
-} /* end OS_FileRename_Impl */
 
-/****************************************************************************************
- Directory API
- ***************************************************************************************/
+	return return_code;
+} /* end OS_FilePositionalIo */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_DirCreate_Impl
+ * Function: OS_pread
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_DirCreate_Impl(const char *local_path, uint32 access)
+int32 OS_pread(uint32 filedes, void *buffer, uint32 nbytes, int32 offset)
 {
-    int status;
-	int32 volume_type;
+	return OS_FilePositionalIo(filedes, buffer, nbytes, offset, false);
+} /* end OS_pread */
 
-	volume_type = OS_GetVolumeType(local_path);
+/*----------------------------------------------------------------
+ *
+ * Function: OS_pwrite
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_pwrite(uint32 filedes, const void *buffer, uint32 nbytes, int32 offset)
+{
+	return OS_FilePositionalIo(filedes, (void *)buffer, nbytes, offset, true);
+} /* end OS_pwrite */
 
-	if(volume_type == RAM_DISK)
-	{
-		status = ff_mkdir(local_path);
-	}
-	else if(volume_type == FS_BASED)
-	{
-		status = mkdir(local_path);
-	}
-	else
-	{
-		return OS_FS_ERR_PATH_INVALID;
-	}
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileMap
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileMap(uint32 filedes, const void **addr, uint32 *size)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
 
-	if(status == 0)
+	if(addr == NULL || size == NULL)
 	{
-		return OS_FS_SUCCESS;
+		return OS_INVALID_POINTER;
 	}
-	else
+
+	*addr = NULL;
+	*size = 0;
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_REFCOUNT, OS_OBJECT_TYPE_OS_STREAM, filedes, &local_id, &record);
+	if(return_code == OS_SUCCESS)
 	{
-		return OS_FS_ERROR;
+		return_code = OS_FileMap_Impl(local_id, addr, size);
+		OS_ObjectIdRefcountDecr(record);
 	}
-} /* end OS_DirCreate_Impl */
+
+	return return_code;
+} /* end OS_FileMap */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_DirOpen_Impl
+ * Function: OS_FileUnmap
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_DirOpen_Impl(uint32 local_id, const char *local_path)
+int32 OS_FileUnmap(uint32 filedes, const void *addr)
 {
-	int status;
-	int32 volume_type;
-
-	volume_type = OS_GetVolumeType(local_path);
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
 
-	if(volume_type == RAM_DISK)
-	{
-		status = ff_findfirst(local_path, &OS_impl_dir_table[local_id].dir.xFindData);
-		if(status == 0)
-		{
-			OS_impl_dir_table[local_id].dir.dp = (void *) &OS_impl_dir_table[local_id].dir.xFindData;
-		}
-	}
-	else if(volume_type == FS_BASED)
-	{
-		OS_impl_dir_table[local_id].dir.dp = opendir((char*) local_path);
-	}
-	else
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_REFCOUNT, OS_OBJECT_TYPE_OS_STREAM, filedes, &local_id, &record);
+	if(return_code == OS_SUCCESS)
 	{
-		return OS_FS_ERROR;
+		return_code = OS_FileUnmap_Impl(local_id, addr);
+		OS_ObjectIdRefcountDecr(record);
 	}
 
-	if(OS_impl_dir_table[local_id].dir.dp != NULL)
-	{
-		strncpy(OS_impl_dir_table[local_id].Path, local_path, OS_MAX_PATH_LEN);
-		OS_impl_dir_table[local_id].VolumeType = volume_type;
-		OS_impl_dir_table[local_id].state = DirTableEntryStateAfterFindFirst;
-		return OS_FS_SUCCESS;
-	}
-	else
-	{
-		strcpy(OS_impl_dir_table[local_id].Path, "\0");
-		OS_impl_dir_table[local_id].state = DirTableEntryStateUndefined;
-		return OS_FS_ERROR;
-	}
-} /* end OS_DirOpen_Impl */
+	return return_code;
+} /* end OS_FileUnmap */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_DirClose_Impl
+ * Function: OS_FileCacheGetStats
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_DirClose_Impl(uint32 local_id)
+int32 OS_FileCacheGetStats(OS_file_cache_stats_t *stats)
 {
-	if(OS_impl_dir_table[local_id].VolumeType == RAM_DISK)
+#ifdef OS_FREERTOS_FILE_CACHE
+	uint32 i;
+
+	if(stats == NULL)
 	{
-		//Nothing special to do here.
+		return OS_INVALID_POINTER;
 	}
-	else if(OS_impl_dir_table[local_id].VolumeType == FS_BASED)
+
+	xSemaphoreTake(OS_file_cache_mutex, portMAX_DELAY);
+
+	*stats = OS_file_cache_stats;
+	stats->entries = 0;
+	for(i = 0; i < OS_FREERTOS_FILE_CACHE_ENTRIES; i++)
 	{
-		int status;
-		status = closedir(OS_impl_dir_table[local_id].dir.dp);
-		if(status != 0)
+		if(OS_file_cache_table[i].valid)
 		{
-			return OS_FS_ERROR;
+			++stats->entries;
 		}
 	}
-	else
-	{
-		return OS_FS_ERR_PATH_INVALID;
-	}
+	stats->bytes = OS_file_cache_bytes;
+	stats->budget = OS_FREERTOS_FILE_CACHE_BYTES;
 
-	strcpy(OS_impl_dir_table[local_id].Path, "\0");
-	OS_impl_dir_table[local_id].dir.dp = NULL;
-	OS_impl_dir_table[local_id].VolumeType = -1;
-	OS_impl_dir_table[local_id].state = DirTableEntryStateUndefined;
+	xSemaphoreGive(OS_file_cache_mutex);
 
-	return OS_FS_SUCCESS;
-} /* end OS_DirClose_Impl */
+	return OS_SUCCESS;
+#else
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_FileCacheGetStats */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_DirRead_Impl
+ * Function: OS_FileCopyMove
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Translates the paths of OS_FileCopy and OS_FileMove.
  *
  *-----------------------------------------------------------------*/
-int32 OS_DirRead_Impl(uint32 local_id, os_dirent_t *dirent)
+static int32 OS_FileCopyMove(const char *src, const char *dest, bool move)
 {
-	int status;
+	char local_src[OS_MAX_LOCAL_PATH_LEN];
+	char local_dest[OS_MAX_LOCAL_PATH_LEN];
+	int32 return_code;
 
-	if(OS_impl_dir_table[local_id].VolumeType == RAM_DISK)
+	if(src == NULL || dest == NULL)
 	{
-		switch(OS_impl_dir_table[local_id].state)
-		{
-		case DirTableEntryStateAfterFindFirst:
-			/* do nothing */
-			break;
-
-		case DirTableEntryStateAfterFindNext:
-			/* read the next entry */
-			status = ff_findnext(&OS_impl_dir_table[local_id].dir.xFindData);
-			if(status != 0)
-			{
-				return OS_FS_ERROR;
-			}
-			break;
-
-		case DirTableEntryStateUndefined:
-		default:
-			return OS_FS_ERROR;
-		}
-
-		OS_impl_dir_table[local_id].state = DirTableEntryStateAfterFindNext;
-		strncpy(dirent->FileName, OS_impl_dir_table[local_id].dir.xFindData.pcFileName, OS_MAX_PATH_LEN);
+		return OS_INVALID_POINTER;
 	}
-	else if(OS_impl_dir_table[local_id].VolumeType == FS_BASED)
-	{
-		struct dirent* de;
-		de = readdir(OS_impl_dir_table[local_id].dir.dp);
-		if(de == NULL)
-		{
-			return OS_FS_ERROR;
-		}
 
-		strncpy(dirent->FileName, de->d_name, OS_MAX_PATH_LEN);
-	}
-	else
+	return_code = OS_TranslatePath(src, local_src);
+	if(return_code == OS_SUCCESS)
 	{
-		return OS_FS_ERROR;
+		return_code = OS_TranslatePath(dest, local_dest);
 	}
 
-	dirent->FileName[OS_MAX_PATH_LEN-1] = '\0';
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_FreeRTOS_FileCopy(local_src, local_dest, move);
+	}
 
-	return OS_FS_SUCCESS;
-} /* end OS_DirRead_Impl */
+	return return_code;
+} /* end OS_FileCopyMove */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_DirRewind_Impl
+ * Function: OS_FileCopy
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_DirRewind_Impl(uint32 local_id)
+int32 OS_FileCopy(const char *src, const char *dest)
 {
-	if(OS_impl_dir_table[local_id].VolumeType == RAM_DISK)
-	{
-		char path[OS_MAX_LOCAL_PATH_LEN];
-		strncpy(path, OS_impl_dir_table[local_id].Path, OS_MAX_PATH_LEN);
+	return OS_FileCopyMove(src, dest, false);
+} /* end OS_FileCopy */
 
-		if(OS_DirClose_Impl(local_id) != OS_FS_SUCCESS)
-		{
-			return OS_FS_ERROR;
-		}
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileMove
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileMove(const char *src, const char *dest)
+{
+	return OS_FileCopyMove(src, dest, true);
+} /* end OS_FileMove */
 
-		//This may fail if there are multiple levels of directories and
-		//higher directories get renamed without the lower directories
-		//getting their path updated.
-		if(OS_DirOpen_Impl(local_id, path) != OS_FS_SUCCESS)
-		{
-			return OS_FS_ERROR;
-		}
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileAsyncSubmit
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileAsyncSubmit(OS_file_async_request_t *request)
+{
+#ifdef OS_FREERTOS_FILE_ASYNC
+	if(request == NULL)
+	{
+		return OS_INVALID_POINTER;
 	}
-	else if(OS_impl_dir_table[local_id].VolumeType == FS_BASED)
+
+	if((request->op != OS_FILE_ASYNC_FLUSH && request->buffer == NULL) ||
+	   (request->notify == OS_FILE_ASYNC_NOTIFY_CALLBACK && request->callback == NULL))
 	{
-		rewinddir(OS_impl_dir_table[local_id].dir.dp);
+		return OS_INVALID_POINTER;
 	}
-	else
+
+	request->status = OS_SUCCESS;
+	request->done = false;
+	request->submitter = xTaskGetCurrentTaskHandle();
+
+	/* Never blocks: a time-critical caller gets OS_QUEUE_FULL instead */
+	if(xQueueSend(OS_file_async_queue, &request, 0) != pdPASS)
 	{
-		return OS_FS_ERROR;
+		return OS_QUEUE_FULL;
 	}
 
-	return OS_FS_SUCCESS;
-} /* end OS_DirRewind_Impl */
+	return OS_SUCCESS;
+#else
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_FileAsyncSubmit */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_DirRemove_Impl
+ * Function: OS_FileAsyncWait
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_DirRemove_Impl(const char *local_path)
+int32 OS_FileAsyncWait(OS_file_async_request_t *request, int32 msecs)
 {
-	int status;
-	int32 volume_type;
+#ifdef OS_FREERTOS_FILE_ASYNC
+	TickType_t start;
+	TickType_t limit;
+	TickType_t elapsed;
 
-	volume_type = OS_GetVolumeType(local_path);
+	if(request == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
 
-	if(volume_type == RAM_DISK)
+	if(request->notify != OS_FILE_ASYNC_NOTIFY_TASK ||
+	   request->submitter != xTaskGetCurrentTaskHandle())
 	{
-		status = ff_rmdir(local_path);
+		return OS_ERR_INCORRECT_OBJ_STATE;
 	}
-	else if(volume_type == FS_BASED)
+
+	limit = (msecs < 0) ? portMAX_DELAY : pdMS_TO_TICKS(msecs);
+	start = xTaskGetTickCount();
+
+	while(!request->done)
 	{
-		status = rmdir(local_path);
+		elapsed = xTaskGetTickCount() - start;
+		if(limit != portMAX_DELAY && elapsed >= limit)
+		{
+			return OS_ERROR_TIMEOUT;
+		}
+
+		ulTaskNotifyTake(pdTRUE, (limit == portMAX_DELAY) ? portMAX_DELAY : limit - elapsed);
 	}
-	else
+
+	return request->status;
+#else
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_FileAsyncWait */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_DirReadAttributes
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_DirReadAttributes(uint32 dir_id, OS_dirent_attr_t *entries, uint32 max_entries, uint32 *count)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(entries == NULL || count == NULL)
 	{
-		return OS_FS_ERR_PATH_INVALID;
+		return OS_INVALID_POINTER;
 	}
 
-	if(status == 0)
+	*count = 0;
+
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_DIR);
+	if(return_code != OS_SUCCESS)
 	{
-		return OS_FS_SUCCESS;
+		return return_code;
 	}
-	else
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_DIR, dir_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
 	{
-		return OS_FS_ERROR;
+		return_code = OS_DirReadAttributes_Impl(local_id, entries, max_entries, count);
 	}
-} /* end OS_DirRemove_Impl */
+
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_DIR);
+
+	return return_code;
+} /* end OS_DirReadAttributes */
@@ -32,7 +32,6 @@
 
 #include "os-FreeRTOS.h"
 #include "ff_stdio.h"
-#include "ff_ramdisk.h"
 #include "osconfig.h"
 #include "osapi-os-filesys.h"
 
@@ -40,6 +39,48 @@
  Data Types
  ****************************************************************************************/
 
+/*
+ * A RAM disk.  The FreeRTOS+FAT disk comes first so the block driver can get
+ * back to the rest from the FF_Disk_t it is handed; pvTag is the storage.
+ */
+typedef struct
+{
+	FF_Disk_t disk;
+	uint32 sector_size;
+	OS_filesys_cache_stats_t stats;
+	HANDLE image_file;					/* image the storage is mapped from, if any */
+	HANDLE image_mapping;
+	uint32 written_extent;				/* one past the highest sector written */
+} OS_impl_ramdisk_t;
+
+/*
+ * RAM disk parameters set with OS_FileSysRamDiskConfigure, by device name.
+ */
+typedef struct
+{
+	char device_name[OS_FS_DEV_NAME_LEN];
+	OS_ramdisk_params_t params;
+} OS_impl_ramdisk_config_t;
+
+/*
+ * A freshly formatted RAM disk, see OS_FREERTOS_RAMDISK_TEMPLATES.  Of the
+ * first "extent" sectors, the ones the format wrote into, only those that are
+ * not all zero are kept: "sectors" holds their numbers in ascending order and
+ * "data" their contents back to back.  Everything else on the disk is zero.
+ */
+typedef struct
+{
+	bool in_use;
+	uint32 numblocks;
+	uint32 sector_size;
+	bool small_clusters;
+	bool prefer_fat16;
+	uint32 extent;
+	uint32 count;
+	uint32 *sectors;
+	uint8 *data;
+} OS_impl_ramdisk_template_t;
+
 /***************************************************************************************
  FUNCTION PROTOTYPES
  ***************************************************************************************/
@@ -53,6 +94,533 @@
  */
 extern OS_VolumeInfo_t OS_VolumeTable[NUM_TABLE_ENTRIES];
 
+/*
+ * Index of the volume table device names used by OS_GetVolumeType, sorted
+ * by name length and then name.  Protected by a critical section.
+ */
+typedef struct
+{
+	const char *name;
+	uint32      name_len;
+	int32       volume_type;
+} OS_volume_index_entry_t;
+
+static OS_volume_index_entry_t	OS_volume_index[NUM_TABLE_ENTRIES];
+static uint32					OS_volume_index_count;
+static bool						OS_volume_index_valid;
+
+static OS_impl_ramdisk_t			OS_impl_ramdisk_table[OS_MAX_FILE_SYSTEMS];
+static OS_impl_ramdisk_config_t		OS_impl_ramdisk_config[OS_MAX_FILE_SYSTEMS];
+
+#if OS_FREERTOS_RAMDISK_TEMPLATES > 0
+/* Only used from OS_FileSysStartVolume_Impl, which the shared layer serializes */
+static OS_impl_ramdisk_template_t	OS_impl_ramdisk_template[OS_FREERTOS_RAMDISK_TEMPLATES];
+#endif
+
+#ifdef OS_FREERTOS_FS_ARENA_SIZE
+/* Bytes of the file system arena handed out */
+static size_t						OS_fs_arena_used;
+#endif
+
+/****************************************************************************************
+ File system arena
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FsArena_Alloc
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Allocates RAM disk storage.  With OS_FREERTOS_FS_ARENA_SIZE the
+ *           storage is taken from the host with VirtualAlloc, up to that
+ *           many bytes in all, so RAM disks neither use nor fragment the
+ *           FreeRTOS heap.  *size is set to the size actually taken.
+ *
+ *-----------------------------------------------------------------*/
+static void *OS_FsArena_Alloc(size_t *size)
+{
+#ifdef OS_FREERTOS_FS_ARENA_SIZE
+	void *storage = NULL;
+	size_t granule;
+
+#ifdef OS_FREERTOS_FS_ARENA_LARGE_PAGES
+	/* Needs SeLockMemoryPrivilege; without it this falls back to normal pages */
+	granule = GetLargePageMinimum();
+	if(granule != 0)
+	{
+		size_t large = ((*size + granule - 1) / granule) * granule;
+
+		if(OS_fs_arena_used + large <= OS_FREERTOS_FS_ARENA_SIZE)
+		{
+			storage = VirtualAlloc(NULL, large, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+			if(storage != NULL)
+			{
+				*size = large;
+			}
+		}
+	}
+#endif
+
+	if(storage == NULL)
+	{
+		granule = 4096;
+		*size = ((*size + granule - 1) / granule) * granule;
+		if(OS_fs_arena_used + *size > OS_FREERTOS_FS_ARENA_SIZE)
+		{
+			return NULL;
+		}
+
+		storage = VirtualAlloc(NULL, *size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+	}
+
+	if(storage != NULL)
+	{
+		OS_fs_arena_used += *size;
+	}
+
+	return storage;
+#else
+	return pvPortMalloc(*size);
+#endif
+} /* end OS_FsArena_Alloc */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FsArena_Free
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FsArena_Free(void *storage, size_t size)
+{
+#ifdef OS_FREERTOS_FS_ARENA_SIZE
+	VirtualFree(storage, 0, MEM_RELEASE);
+	OS_fs_arena_used -= size;
+#else
+	vPortFree(storage);
+#endif
+} /* end OS_FsArena_Free */
+
+/****************************************************************************************
+ RAM disk driver
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_ReadBlocks
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           FreeRTOS+FAT block read.  It is only called when the sectors
+ *           are not in the I/O manager's cache, so the counts are the
+ *           cache misses.
+ *
+ *-----------------------------------------------------------------*/
+static int32_t OS_RamDisk_ReadBlocks(uint8_t *buffer, uint32_t sector, uint32_t count, FF_Disk_t *disk)
+{
+	OS_impl_ramdisk_t *ramdisk = (OS_impl_ramdisk_t *) disk;
+
+	if(sector + count > disk->ulNumberOfSectors)
+	{
+		return FF_ERR_IOMAN_OUT_OF_BOUNDS_READ | FF_ERRFLAG;
+	}
+
+	memcpy(buffer, (uint8 *) disk->pvTag + (sector * ramdisk->sector_size), count * ramdisk->sector_size);
+	++ramdisk->stats.read_requests;
+	ramdisk->stats.read_sectors += count;
+
+	return FF_ERR_NONE;
+} /* end OS_RamDisk_ReadBlocks */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_WriteBlocks
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           FreeRTOS+FAT block write, i.e. a cache write-back.
+ *
+ *-----------------------------------------------------------------*/
+static int32_t OS_RamDisk_WriteBlocks(uint8_t *buffer, uint32_t sector, uint32_t count, FF_Disk_t *disk)
+{
+	OS_impl_ramdisk_t *ramdisk = (OS_impl_ramdisk_t *) disk;
+
+	if(sector + count > disk->ulNumberOfSectors)
+	{
+		return FF_ERR_IOMAN_OUT_OF_BOUNDS_WRITE | FF_ERRFLAG;
+	}
+
+	memcpy((uint8 *) disk->pvTag + (sector * ramdisk->sector_size), buffer, count * ramdisk->sector_size);
+	++ramdisk->stats.write_requests;
+	ramdisk->stats.write_sectors += count;
+	if(sector + count > ramdisk->written_extent)
+	{
+		ramdisk->written_extent = sector + count;
+	}
+
+	return FF_ERR_NONE;
+} /* end OS_RamDisk_WriteBlocks */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_GetParams
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           The parameters configured for a device, or the defaults.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_RamDisk_GetParams(const char *device_name, OS_ramdisk_params_t *params)
+{
+	uint32 i;
+
+	memset(params, 0, sizeof(*params));
+	params->cache_size = OS_FREERTOS_RAMDISK_CACHE_SIZE;
+	params->small_clusters = true;
+	params->prefer_fat16 = true;
+
+	for(i = 0; i < OS_MAX_FILE_SYSTEMS; i++)
+	{
+		if(OS_impl_ramdisk_config[i].device_name[0] != '\0' &&
+		   strcmp(OS_impl_ramdisk_config[i].device_name, device_name) == 0)
+		{
+			*params = OS_impl_ramdisk_config[i].params;
+			break;
+		}
+	}
+} /* end OS_RamDisk_GetParams */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_MapImage
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Maps a host image file as the storage of a RAM disk.  The view
+ *           is copy-on-write unless the image is to be kept up to date, so
+ *           a prebuilt image is never changed by a run using it.
+ *
+ *-----------------------------------------------------------------*/
+static uint8 *OS_RamDisk_MapImage(uint32 filesys_id, const OS_ramdisk_params_t *params, uint32 size)
+{
+	OS_impl_ramdisk_t *ramdisk = &OS_impl_ramdisk_table[filesys_id];
+	LARGE_INTEGER file_size;
+	DWORD access;
+	uint8 *view;
+
+	access = params->image_write_back ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ;
+	ramdisk->image_file = CreateFileA(params->image_path, access, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+	if(ramdisk->image_file == INVALID_HANDLE_VALUE)
+	{
+		OS_DEBUG("OS_RamDisk_MapImage: cannot open %s\n", params->image_path);
+		ramdisk->image_file = NULL;
+		return NULL;
+	}
+
+	if(!GetFileSizeEx(ramdisk->image_file, &file_size) || file_size.QuadPart < size)
+	{
+		OS_DEBUG("OS_RamDisk_MapImage: %s is smaller than the volume\n", params->image_path);
+		CloseHandle(ramdisk->image_file);
+		ramdisk->image_file = NULL;
+		return NULL;
+	}
+
+	ramdisk->image_mapping = CreateFileMappingA(ramdisk->image_file, NULL,
+			params->image_write_back ? PAGE_READWRITE : PAGE_WRITECOPY, 0, size, NULL);
+	view = NULL;
+	if(ramdisk->image_mapping != NULL)
+	{
+		view = MapViewOfFile(ramdisk->image_mapping, params->image_write_back ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, size);
+	}
+
+	if(view == NULL)
+	{
+		if(ramdisk->image_mapping != NULL)
+		{
+			CloseHandle(ramdisk->image_mapping);
+		}
+		CloseHandle(ramdisk->image_file);
+		ramdisk->image_mapping = NULL;
+		ramdisk->image_file = NULL;
+	}
+
+	return view;
+} /* end OS_RamDisk_MapImage */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_UnmapImage
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_RamDisk_UnmapImage(uint32 filesys_id, void *view)
+{
+	OS_impl_ramdisk_t *ramdisk = &OS_impl_ramdisk_table[filesys_id];
+
+	UnmapViewOfFile(view);
+	CloseHandle(ramdisk->image_mapping);
+	CloseHandle(ramdisk->image_file);
+	ramdisk->image_mapping = NULL;
+	ramdisk->image_file = NULL;
+} /* end OS_RamDisk_UnmapImage */
+
+#if OS_FREERTOS_RAMDISK_TEMPLATES > 0
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_FindTemplate
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           The template of a geometry, NULL if there is none yet.
+ *
+ *-----------------------------------------------------------------*/
+static OS_impl_ramdisk_template_t *OS_RamDisk_FindTemplate(uint32 numblocks, uint32 sector_size,
+		const OS_ramdisk_params_t *params)
+{
+	OS_impl_ramdisk_template_t *template;
+	uint32 i;
+
+	for(i = 0; i < OS_FREERTOS_RAMDISK_TEMPLATES; i++)
+	{
+		template = &OS_impl_ramdisk_template[i];
+		if(template->in_use && template->numblocks == numblocks && template->sector_size == sector_size &&
+		   template->small_clusters == params->small_clusters && template->prefer_fat16 == params->prefer_fat16)
+		{
+			return template;
+		}
+	}
+
+	return NULL;
+} /* end OS_RamDisk_FindTemplate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_SaveTemplate
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Keep the sectors a format just wrote as the template of the
+ *           disk's geometry, if there is a free template slot.  The cache
+ *           must have been flushed.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_RamDisk_SaveTemplate(OS_impl_ramdisk_t *ramdisk, const OS_ramdisk_params_t *params)
+{
+	OS_impl_ramdisk_template_t *template = NULL;
+	const uint8 *storage = ramdisk->disk.pvTag;
+	const uint8 *sector;
+	uint32 sector_size = ramdisk->sector_size;
+	uint32 count;
+	uint32 heap_category;
+	uint32 i;
+	uint32 j;
+
+	for(i = 0; i < OS_FREERTOS_RAMDISK_TEMPLATES; i++)
+	{
+		if(!OS_impl_ramdisk_template[i].in_use)
+		{
+			template = &OS_impl_ramdisk_template[i];
+			break;
+		}
+	}
+	if(template == NULL)
+	{
+		return;
+	}
+
+	/* Most of what a format writes is the zeroed FAT, which need not be kept */
+	count = 0;
+	for(i = 0; i < ramdisk->written_extent; i++)
+	{
+		sector = storage + ((size_t) i * sector_size);
+		for(j = 0; j < sector_size && sector[j] == 0; j++);
+		if(j < sector_size)
+		{
+			++count;
+		}
+	}
+
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_FILESYS);
+	template->sectors = pvPortMalloc(count * sizeof(uint32));
+	template->data = pvPortMalloc((size_t) count * sector_size);
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+	if(template->sectors == NULL || template->data == NULL)
+	{
+		vPortFree(template->sectors);
+		vPortFree(template->data);
+		template->sectors = NULL;
+		template->data = NULL;
+		return;
+	}
+
+	count = 0;
+	for(i = 0; i < ramdisk->written_extent; i++)
+	{
+		sector = storage + ((size_t) i * sector_size);
+		for(j = 0; j < sector_size && sector[j] == 0; j++);
+		if(j < sector_size)
+		{
+			template->sectors[count] = i;
+			memcpy(template->data + ((size_t) count * sector_size), sector, sector_size);
+			++count;
+		}
+	}
+
+	template->numblocks = ramdisk->disk.ulNumberOfSectors;
+	template->sector_size = sector_size;
+	template->small_clusters = params->small_clusters;
+	template->prefer_fat16 = params->prefer_fat16;
+	template->extent = ramdisk->written_extent;
+	template->count = count;
+	template->in_use = true;
+} /* end OS_RamDisk_SaveTemplate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_StampTemplate
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Write a template into RAM disk storage, in place of a format.
+ *           Storage that is known to be zero only gets the kept sectors.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_RamDisk_StampTemplate(const OS_impl_ramdisk_template_t *template, uint8 *storage, bool zeroed)
+{
+	uint32 i;
+
+	if(!zeroed)
+	{
+		memset(storage, 0, (size_t) template->extent * template->sector_size);
+	}
+
+	for(i = 0; i < template->count; i++)
+	{
+		memcpy(storage + ((size_t) template->sectors[i] * template->sector_size),
+		       template->data + ((size_t) i * template->sector_size), template->sector_size);
+	}
+} /* end OS_RamDisk_StampTemplate */
+#endif
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_RamDisk_Create
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Creates the I/O manager of a RAM disk over the given storage,
+ *           partitions and formats it unless it holds an image, mounts it
+ *           and adds it under the volume name.  The sector size is the
+ *           volume's block size.  "zeroed" tells the storage is known to be
+ *           all zero, see OS_RamDisk_StampTemplate.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_RamDisk_Create(uint32 filesys_id, uint8 *storage, uint32 sector_size, bool format, bool zeroed)
+{
+	OS_filesys_internal_record_t *local = &OS_filesys_table[filesys_id];
+	OS_impl_ramdisk_t *ramdisk = &OS_impl_ramdisk_table[filesys_id];
+	FF_CreationParameters_t parameters;
+	FF_PartitionParameters_t partition;
+	OS_ramdisk_params_t params;
+	FF_Error_t error;
+	uint32 cache_size;
+#if OS_FREERTOS_RAMDISK_TEMPLATES > 0
+	const OS_impl_ramdisk_template_t *template = NULL;
+#endif
+
+	OS_RamDisk_GetParams(local->device_name, &params);
+
+#if OS_FREERTOS_RAMDISK_TEMPLATES > 0
+	/* A disk stamped from a template is already formatted, before the cache sees any of it */
+	if(format)
+	{
+		template = OS_RamDisk_FindTemplate(local->numblocks, sector_size, &params);
+		if(template != NULL)
+		{
+			OS_RamDisk_StampTemplate(template, storage, zeroed);
+			format = false;
+		}
+	}
+#endif
+
+	/* The I/O manager wants whole sectors, and at least two of them */
+	cache_size = ((params.cache_size + sector_size - 1) / sector_size) * sector_size;
+	if(cache_size < 2 * sector_size)
+	{
+		cache_size = 2 * sector_size;
+	}
+
+	ramdisk->sector_size = sector_size;
+	ramdisk->written_extent = 0;
+	memset(&ramdisk->stats, 0, sizeof(ramdisk->stats));
+	memset(&ramdisk->disk, 0, sizeof(ramdisk->disk));
+	ramdisk->stats.sector_size = sector_size;
+	ramdisk->stats.cache_size = cache_size;
+	ramdisk->disk.pvTag = storage;
+	ramdisk->disk.ulNumberOfSectors = local->numblocks;
+
+	memset(&parameters, 0, sizeof(parameters));
+	parameters.pucCacheMemory = NULL;
+	parameters.ulMemorySize = cache_size;
+	parameters.ulSectorSize = sector_size;
+	parameters.fnWriteBlocks = OS_RamDisk_WriteBlocks;
+	parameters.fnReadBlocks = OS_RamDisk_ReadBlocks;
+	parameters.pxDisk = &ramdisk->disk;
+	parameters.pvSemaphore = (void *) xSemaphoreCreateRecursiveMutex();
+	parameters.xBlockDeviceIsReentrant = pdFALSE;
+	if(parameters.pvSemaphore == NULL)
+	{
+		return OS_FS_ERR_DRIVE_NOT_CREATED;
+	}
+
+	ramdisk->disk.pxIOManager = FF_CreateIOManager(&parameters, &error);
+	if(ramdisk->disk.pxIOManager == NULL || FF_isERR(error))
+	{
+		vSemaphoreDelete((SemaphoreHandle_t) parameters.pvSemaphore);
+		ramdisk->disk.pxIOManager = NULL;
+		return OS_FS_ERR_DRIVE_NOT_CREATED;
+	}
+	ramdisk->disk.xStatus.bIsInitialised = pdTRUE;
+
+	memset(&partition, 0, sizeof(partition));
+	partition.ulSectorCount = local->numblocks;
+	partition.ulHiddenSectors = 8;
+	partition.ulInterSpace = 0;
+	partition.xPrimaryCount = 1;
+	partition.eSizeType = eSizeIsQuota;
+
+	error = FF_ERR_NONE;
+	if(format)
+	{
+		error = FF_Partition(&ramdisk->disk, &partition);
+		if(!FF_isERR(error))
+		{
+			FF_FlushCache(ramdisk->disk.pxIOManager);
+			error = FF_Format(&ramdisk->disk, 0, params.prefer_fat16 ? pdTRUE : pdFALSE, params.small_clusters ? pdTRUE : pdFALSE);
+		}
+#if OS_FREERTOS_RAMDISK_TEMPLATES > 0
+		if(!FF_isERR(error))
+		{
+			FF_FlushCache(ramdisk->disk.pxIOManager);
+			OS_RamDisk_SaveTemplate(ramdisk, &params);
+		}
+#endif
+	}
+	if(!FF_isERR(error))
+	{
+		error = FF_Mount(&ramdisk->disk, 0);
+	}
+	if(FF_isERR(error) || FF_FS_Add(local->volume_name, &ramdisk->disk) == pdFALSE)
+	{
+		FF_DeleteIOManager(ramdisk->disk.pxIOManager);
+		ramdisk->disk.pxIOManager = NULL;
+		return OS_FS_ERR_DRIVE_NOT_CREATED;
+	}
+	ramdisk->disk.xStatus.bIsMounted = pdTRUE;
+
+	/*
+	 * Count the free clusters once now.  FreeRTOS+FAT keeps the count up to
+	 * date from then on, so OS_FileSysStatVolume_Impl need not scan the FAT.
+	 */
+	FF_GetFreeSize(ramdisk->disk.pxIOManager, &error);
+
+	return OS_SUCCESS;
+} /* end OS_RamDisk_Create */
+
 /****************************************************************************************
  Filesys API
  ***************************************************************************************/
@@ -71,18 +639,24 @@ int32 OS_FreeRTOS_FileSysAPI_Impl_Init(void)
 
 /*----------------------------------------------------------------
  *
- * Function: OS_FileSysStartVolume_Impl
+ * Function: OS_FileSys_StartVolume
  *
- *  Purpose: Implemented per internal OSAL API
- *           See prototype in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Body of OS_FileSysStartVolume_Impl, which times it.
  *
  *-----------------------------------------------------------------*/
-int32 OS_FileSysStartVolume_Impl(uint32 filesys_id)
+static int32 OS_FileSys_StartVolume(uint32 filesys_id)
 {
 	OS_filesys_internal_record_t  *local = &OS_filesys_table[filesys_id];
     int32  return_code = OS_ERR_NOT_IMPLEMENTED;
-	FF_Disk_t *disk;
+	OS_ramdisk_params_t params;
+	uint32 sector_size;
+	size_t storage_size = 0;
 	int allocated_space = 0;
+	bool mapped = false;
+	bool zeroed = false;
+	uint32 heap_category;
+	uint32 phase;
 
 	/*
 	 * Take action based on the type of volume
@@ -104,9 +678,31 @@ int32 OS_FileSysStartVolume_Impl(uint32 filesys_id)
 	}
 	case OS_FILESYS_TYPE_VOLATILE_DISK:
 	{
+		/* The block size given to OS_mkfs is the sector size, if FreeRTOS+FAT can use it */
+		sector_size = local->blocksize;
+		if(sector_size < 512 || sector_size > 4096 || (sector_size & (sector_size - 1)) != 0)
+		{
+			sector_size = 512;
+		}
+
+		OS_RamDisk_GetParams(local->device_name, &params);
+		if(local->address == 0 && params.image_path[0] != '\0')
+		{
+			/* Load a prebuilt file system instead of formatting a fresh one */
+			local->address = (char *) OS_RamDisk_MapImage(filesys_id, &params, local->numblocks * sector_size);
+			if(local->address == NULL)
+			{
+				return OS_FS_ERR_DRIVE_NOT_CREATED;
+			}
+			mapped = true;
+		}
+
 		if(local->address == 0)
 		{
-			local->address = (char *) pvPortMalloc(local->numblocks * 512);
+			storage_size = (size_t) local->numblocks * sector_size;
+			heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_FILESYS);
+			local->address = (char *) OS_FsArena_Alloc(&storage_size);
+			OS_FreeRTOS_HeapCategorySet(heap_category);
 			if(local->address == NULL)
 			{
 				return OS_FS_ERR_DRIVE_NOT_CREATED;
@@ -114,25 +710,30 @@ int32 OS_FileSysStartVolume_Impl(uint32 filesys_id)
 			else
 			{
 				allocated_space = 1;
+#ifdef OS_FREERTOS_FS_ARENA_SIZE
+				/* VirtualAlloc hands out zeroed pages */
+				zeroed = true;
+#endif
 			}
 		}
 
 		/*
 		 ** Create the RAM disk device
 		 */
-		disk = FF_RAMDiskInit(local->volume_name, (uint8_t *) local->address, local->numblocks, 1024); /* The 4th parameter must be a multiple of the block size */
-		if(disk == NULL)
+		phase = OS_StartupPhaseBegin(mapped ? "RAM disk mount" : "RAM disk create");
+		heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_FILESYS);
+		return_code = OS_RamDisk_Create(filesys_id, (uint8 *) local->address, sector_size, !mapped, zeroed);
+		OS_FreeRTOS_HeapCategorySet(heap_category);
+		OS_StartupPhaseEnd(phase);
+		if(return_code != OS_SUCCESS && mapped)
 		{
-			if(allocated_space)
-			{
-				vPortFree(local->address);
-			}
-			return_code = OS_FS_ERR_DRIVE_NOT_CREATED;
+			OS_RamDisk_UnmapImage(filesys_id, local->address);
+			local->address = 0;
 		}
-		else
+		else if(return_code != OS_SUCCESS && allocated_space)
 		{
-
-			return_code = OS_SUCCESS;
+			OS_FsArena_Free(local->address, storage_size);
+			local->address = 0;
 		}
 		break;
 	}
@@ -157,6 +758,32 @@ int32 OS_FileSysStartVolume_Impl(uint32 filesys_id)
 		snprintf(local->system_mountpt, sizeof(local->system_mountpt), "/%s", local->volume_name);
 	}
 
+	OS_FreeRTOS_VolumeIndexInvalidate();
+	OS_FreeRTOS_DirSnapshotInvalidate(NULL);
+	OS_FreeRTOS_FileCacheInvalidate(NULL);
+
+	return return_code;
+} /* end OS_FileSys_StartVolume */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileSysStartVolume_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See prototype in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileSysStartVolume_Impl(uint32 filesys_id)
+{
+	char name[OS_MAX_API_NAME];
+	uint32 phase;
+	int32 return_code;
+
+	snprintf(name, sizeof(name), "start %s", OS_filesys_table[filesys_id].volume_name);
+	phase = OS_StartupPhaseBegin(name);
+	return_code = OS_FileSys_StartVolume(filesys_id);
+	OS_StartupPhaseEnd(phase);
+
 	return return_code;
 } /* end OS_FileSysStartVolume_Impl */
 
@@ -170,6 +797,10 @@ int32 OS_FileSysStartVolume_Impl(uint32 filesys_id)
  *-----------------------------------------------------------------*/
 int32 OS_FileSysStopVolume_Impl(uint32 filesys_id)
 {
+    OS_FreeRTOS_VolumeIndexInvalidate();
+    OS_FreeRTOS_DirSnapshotInvalidate(NULL);
+    OS_FreeRTOS_FileCacheInvalidate(NULL);
+
     /*
      * This is a no-op.
      *
@@ -211,6 +842,10 @@ int32 OS_FileSysMountVolume_Impl(uint32 filesys_id)
 {
 	OS_filesys_internal_record_t  *local = &OS_filesys_table[filesys_id];
 
+	OS_FreeRTOS_VolumeIndexInvalidate();
+	OS_FreeRTOS_DirSnapshotInvalidate(NULL);
+	OS_FreeRTOS_FileCacheInvalidate(NULL);
+
 	/*
 	 * For volatile filesystems (ramdisk) these were created within
      * a temp filesystem, so all that is needed is to ensure the
@@ -236,6 +871,10 @@ int32 OS_FileSysMountVolume_Impl(uint32 filesys_id)
  *-----------------------------------------------------------------*/
 int32 OS_FileSysUnmountVolume_Impl(uint32 filesys_id)
 {
+    OS_FreeRTOS_VolumeIndexInvalidate();
+    OS_FreeRTOS_DirSnapshotInvalidate(NULL);
+    OS_FreeRTOS_FileCacheInvalidate(NULL);
+
     /*
      * NOTE: Mounting/Unmounting on FreeRTOS is not implemented.
      * For backward compatibility this call must return success.
@@ -256,18 +895,46 @@ int32 OS_FileSysUnmountVolume_Impl(uint32 filesys_id)
  *-----------------------------------------------------------------*/
 int32 OS_FileSysStatVolume_Impl(uint32 filesys_id, OS_statvfs_t *result)
 {
-	int32_t status;
 	OS_filesys_internal_record_t  *local = &OS_filesys_table[filesys_id];
+	FF_IOManager_t *io;
+	FF_Error_t error;
+	ULARGE_INTEGER host_free;
+	ULARGE_INTEGER host_total;
 
-	status = ff_diskfree(local->system_mountpt, NULL);
-	if(status == 0)
+	if(local->fstype == OS_FILESYS_TYPE_VOLATILE_DISK)
 	{
-	   return OS_FS_ERROR;
+		io = OS_impl_ramdisk_table[filesys_id].disk.pxIOManager;
+		if(io == NULL)
+		{
+			return OS_FS_ERROR;
+		}
+
+		/*
+		 * The free cluster count is maintained by FreeRTOS+FAT as clusters
+		 * are allocated and freed.  0 means it is not known, and is also the
+		 * count of a full disk, which is then recounted on every call.
+		 */
+		if(io->xPartition.ulFreeClusterCount == 0)
+		{
+			FF_GetFreeSize(io, &error);
+		}
+
+		result->block_size = io->xPartition.ulSectorsPerCluster * io->xPartition.usBlkSize;
+		result->total_blocks = io->xPartition.ulNumClusters;
+		result->blocks_free = io->xPartition.ulFreeClusterCount;
 	}
+	else
+	{
+		if(!GetDiskFreeSpaceExA(local->system_mountpt, &host_free, NULL, &host_total))
+		{
+			return OS_FS_ERROR;
+		}
 
-	result->block_size = 511;
-	result->blocks_free = status;
-	result->total_blocks = status; //Writing free blocks here because unsure what is required
+		/* Host disks are reported in 4 KiB blocks, which keeps the counts within 32 bits */
+		result->block_size = 4096;
+		result->total_blocks = host_total.QuadPart / 4096;
+		result->blocks_free = host_free.QuadPart / 4096;
+	}
 
 	return OS_FS_SUCCESS;
 } /* end OS_FileSysStatVolume_Impl */
@@ -286,19 +953,129 @@ int32 OS_FileSysCheckVolume_Impl(uint32 filesys_id, bool repair)
 	return OS_ERR_NOT_IMPLEMENTED;
 } /* end OS_FileSysCheckVolume_Impl */
 
+/*----------------------------------------------------------------
+ *
+ * Function: OS_VolumeIndex_Compare
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Orders volume index entries by name length, then by name.
+ *
+ *-----------------------------------------------------------------*/
+static int OS_VolumeIndex_Compare(const char *name_a, uint32 len_a, const char *name_b, uint32 len_b)
+{
+	if(len_a != len_b)
+	{
+		return (len_a < len_b) ? -1 : 1;
+	}
+
+	return memcmp(name_a, name_b, len_a);
+} /* end OS_VolumeIndex_Compare */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_VolumeIndex_Rebuild
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Builds the sorted index of the volume table device names.
+ *           Must be called in a critical section.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_VolumeIndex_Rebuild(void)
+{
+	OS_volume_index_entry_t entry;
+	const char *name;
+	uint32 len;
+	uint32 i;
+	uint32 j;
+	int order;
+
+	OS_volume_index_count = 0;
+
+	for(i = 0; i < NUM_TABLE_ENTRIES; i++)
+	{
+		name = OS_VolumeTable[i].PhysDevName;
+		len = strlen(name);
+
+		/* a trailing '/' is not part of the device name */
+		while(len > 1 && name[len - 1] == '/')
+		{
+			--len;
+		}
+
+		if(len == 0 || len >= OS_FS_PHYS_NAME_LEN)
+		{
+			continue;
+		}
+
+		entry.name = name;
+		entry.name_len = len;
+		entry.volume_type = OS_VolumeTable[i].VolumeType;
+
+		/* insertion sort; the first table entry with a given name wins, as with the old linear scan */
+		j = OS_volume_index_count;
+		order = 1;
+		while(j > 0)
+		{
+			order = OS_VolumeIndex_Compare(name, len, OS_volume_index[j - 1].name, OS_volume_index[j - 1].name_len);
+			if(order >= 0)
+			{
+				break;
+			}
+			OS_volume_index[j] = OS_volume_index[j - 1];
+			--j;
+		}
+
+		if(j > 0 && order == 0)
+		{
+			/* duplicate, undo the shift */
+			memmove(&OS_volume_index[j], &OS_volume_index[j + 1], (OS_volume_index_count - j) * sizeof(entry));
+			continue;
+		}
+
+		OS_volume_index[j] = entry;
+		++OS_volume_index_count;
+	}
+
+	OS_volume_index_valid = true;
+} /* end OS_VolumeIndex_Rebuild */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_VolumeIndexInvalidate
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_VolumeIndexInvalidate(void)
+{
+	taskENTER_CRITICAL();
+	OS_volume_index_valid = false;
+	taskEXIT_CRITICAL();
+} /* end OS_FreeRTOS_VolumeIndexInvalidate */
+
 /*----------------------------------------------------------------
  *
  * Function: OS_GetVolumeType
  *
  *  Purpose: Returns the volume type of a file based on its path
  *
+ *           The first component of the path ("/name" or "./name") is
+ *           looked up in a sorted index of the volume table device names,
+ *           without copying the path.  The index is rebuilt on the first
+ *           lookup after a volume is started, stopped, mounted or
+ *           unmounted.
+ *
  *-----------------------------------------------------------------*/
 int32 OS_GetVolumeType(const char *LocalPath)
 {
-	char devname[OS_MAX_PATH_LEN];
-	char filename[OS_MAX_PATH_LEN];
-	int NumChars;
-	int i = 0;
+	uint32 NumChars;
+	uint32 PathLen;
+	uint32 lo;
+	uint32 hi;
+	uint32 mid;
+	int order;
+	int32 volume_type;
 
 	/*
 	 ** Check to see if the path pointers are NULL
@@ -311,7 +1088,8 @@ int32 OS_GetVolumeType(const char *LocalPath)
 	/*
 	 ** Check to see if the path is too long
 	 */
-	if(strlen(LocalPath) >= OS_MAX_PATH_LEN)
+	PathLen = strlen(LocalPath);
+	if(PathLen >= OS_MAX_PATH_LEN)
 	{
 		return OS_FS_ERR_PATH_TOO_LONG;
 	}
@@ -319,74 +1097,258 @@ int32 OS_GetVolumeType(const char *LocalPath)
 	/*
 	 ** All valid physical device names must start with either a '/' or "./"
 	 */
-	if(LocalPath[0] != '/' && strncmp(LocalPath,"./",2) != 0)
+	if(LocalPath[0] == '/')
+	{
+		NumChars = 1;
+	}
+	else if(strncmp(LocalPath, "./", 2) == 0)
+	{
+		NumChars = 2;
+	}
+	else
 	{
 		return OS_FS_ERR_PATH_INVALID;
 	}
 
 	/*
-	 ** Fill the file and device name to be sure they do not have garbage
+	 ** The device name runs up to the next '/' (if there is one)
 	 */
-	memset((void *) devname, 0, OS_MAX_PATH_LEN);
-	memset((void *) filename, 0, OS_MAX_PATH_LEN);
+	while(NumChars < PathLen && LocalPath[NumChars] != '/')
+	{
+		NumChars++;
+	}
 
-	/*
-	 ** We want to find the number of chars to where the second "/" is (if there is one).
-	 ** Since we know the first one is in spot 0, we start looking at 1, and go until
-	 ** we find it.
-	 */
-	if(LocalPath[0] == '/') //If starts with '/'
+	volume_type = OS_FS_ERR_PATH_INVALID;
+
+	taskENTER_CRITICAL();
+
+	if(!OS_volume_index_valid)
 	{
-		NumChars = 1;
+		OS_VolumeIndex_Rebuild();
 	}
-	else //If starts with "./"
+
+	lo = 0;
+	hi = OS_volume_index_count;
+	while(lo < hi)
 	{
-		NumChars = 2;
+		mid = (lo + hi) / 2;
+		order = OS_VolumeIndex_Compare(LocalPath, NumChars, OS_volume_index[mid].name, OS_volume_index[mid].name_len);
+		if(order == 0)
+		{
+			volume_type = OS_volume_index[mid].volume_type;
+			break;
+		}
+		else if(order < 0)
+		{
+			hi = mid;
+		}
+		else
+		{
+			lo = mid + 1;
+		}
 	}
 
-	while((NumChars <= strlen(LocalPath)) && (LocalPath[NumChars] != '/'))
+	taskEXIT_CRITICAL();
+
+	return volume_type;
+} /* end OS_GetVolumeType */
+
+/****************************************************************************************
+ FILE SYSTEM EXTENSION API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileSysRamDiskConfigure
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileSysRamDiskConfigure(const char *devname, const OS_ramdisk_params_t *params)
+{
+	OS_impl_ramdisk_config_t *slot;
+	int32 return_code;
+	uint32 i;
+
+	if(devname == NULL || params == NULL)
 	{
-		NumChars++;
+		return OS_INVALID_POINTER;
 	}
 
-	/*
-	 ** Don't let it overflow to cause a segfault when trying to get the highest level
-	 ** directory
-	 */
-	if(NumChars > strlen(LocalPath))
+	if(strlen(devname) >= OS_FS_DEV_NAME_LEN)
 	{
-		NumChars = strlen(LocalPath);
+		return OS_FS_ERR_PATH_TOO_LONG;
 	}
 
-	/*
-	 ** copy over only the part that is the device name
-	 */
-	strncpy(devname, LocalPath, NumChars);
-	devname[NumChars] = '\0';
+	/* Writes the table, so readers under the shared lock are kept out */
+	return_code = OS_Lock_Global_Impl(OS_OBJECT_TYPE_OS_FILESYS);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
 
-	/*
-	 ** Copy everything after the devname as the path/filename
-	 */
-	snprintf(filename, OS_MAX_PATH_LEN, "%s", LocalPath + NumChars);
+	slot = NULL;
+	for(i = 0; i < OS_MAX_FILE_SYSTEMS; i++)
+	{
+		if(strcmp(OS_impl_ramdisk_config[i].device_name, devname) == 0)
+		{
+			slot = &OS_impl_ramdisk_config[i];
+			break;
+		}
+		if(slot == NULL && OS_impl_ramdisk_config[i].device_name[0] == '\0')
+		{
+			slot = &OS_impl_ramdisk_config[i];
+		}
+	}
 
-	/*
-	 ** look for the dev name we found in the VolumeTable
-	 */
-	for(i = 0; i < NUM_TABLE_ENTRIES; i++)
+	if(slot == NULL)
+	{
+		return_code = OS_ERR_NO_FREE_IDS;
+	}
+	else
+	{
+		strcpy(slot->device_name, devname);
+		slot->params = *params;
+	}
+
+	OS_Unlock_Global_Impl(OS_OBJECT_TYPE_OS_FILESYS);
+
+	return return_code;
+} /* end OS_FileSysRamDiskConfigure */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileSysGetCacheStats
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileSysGetCacheStats(const char *devname, OS_filesys_cache_stats_t *stats)
+{
+	int32 return_code;
+	uint32 i;
+
+	if(devname == NULL || stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(stats, 0, sizeof(*stats));
+
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_FILESYS);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	return_code = OS_FS_ERR_DRIVE_NOT_CREATED;
+	for(i = 0; i < OS_MAX_FILE_SYSTEMS; i++)
 	{
-		if(strncmp(OS_VolumeTable[i].PhysDevName, devname, NumChars) == 0)
+		if(OS_impl_ramdisk_table[i].disk.pxIOManager != NULL &&
+		   strcmp(OS_filesys_table[i].device_name, devname) == 0)
 		{
+			*stats = OS_impl_ramdisk_table[i].stats;
+			return_code = OS_SUCCESS;
 			break;
 		}
 	}
 
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_FILESYS);
+
+	return return_code;
+} /* end OS_FileSysGetCacheStats */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FileSysRamDiskSave
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FileSysRamDiskSave(const char *devname, const char *host_path)
+{
+	OS_impl_ramdisk_t *ramdisk;
+	HANDLE file;
+	DWORD written;
+	uint32 size;
+	int32 return_code;
+	uint32 i;
+
+	if(devname == NULL || host_path == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
 	/*
-	 ** Make sure we found a valid drive
+	 ** The exclusive lock holds off every path lookup, so nothing new is
+	 ** opened, created or removed while the image is copied.  The stream
+	 ** table lock keeps the open streams as they are while they are checked.
 	 */
-	if(i >= NUM_TABLE_ENTRIES)
+	return_code = OS_Lock_Global_Impl(OS_OBJECT_TYPE_OS_FILESYS);
+	if(return_code != OS_SUCCESS)
 	{
-		return OS_FS_ERR_PATH_INVALID;
+		return return_code;
 	}
 
-	return OS_VolumeTable[i].VolumeType;
-} /* end OS_GetVolumeType */
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_STREAM);
+	if(return_code != OS_SUCCESS)
+	{
+		OS_Unlock_Global_Impl(OS_OBJECT_TYPE_OS_FILESYS);
+		return return_code;
+	}
+
+	ramdisk = NULL;
+	for(i = 0; i < OS_MAX_FILE_SYSTEMS; i++)
+	{
+		if(OS_impl_ramdisk_table[i].disk.pxIOManager != NULL &&
+		   strcmp(OS_filesys_table[i].device_name, devname) == 0)
+		{
+			ramdisk = &OS_impl_ramdisk_table[i];
+			break;
+		}
+	}
+
+	if(ramdisk == NULL)
+	{
+		return_code = OS_FS_ERR_DRIVE_NOT_CREATED;
+	}
+	else if(OS_FreeRTOS_RamDiskWriters(ramdisk->disk.pxIOManager) != 0)
+	{
+		/* A file half written would be saved as it stands */
+		return_code = OS_ERR_INCORRECT_OBJ_STATE;
+	}
+	else
+	{
+		/*
+		 ** Everything the cache holds back has to be in the storage first.
+		 ** The IO manager lock is held from the flush to the end of the copy,
+		 ** so no block is written into the storage in between.
+		 */
+		FF_PendSemaphore(ramdisk->disk.pxIOManager->pvSemaphore);
+		FF_FlushCache(ramdisk->disk.pxIOManager);
+		size = ramdisk->disk.ulNumberOfSectors * ramdisk->sector_size;
+
+		file = CreateFileA(host_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if(file == INVALID_HANDLE_VALUE)
+		{
+			return_code = OS_FS_ERROR;
+		}
+		else
+		{
+			if(!WriteFile(file, ramdisk->disk.pvTag, size, &written, NULL) || written != size)
+			{
+				return_code = OS_FS_ERROR;
+			}
+			CloseHandle(file);
+		}
+		FF_ReleaseSemaphore(ramdisk->disk.pxIOManager->pvSemaphore);
+	}
+
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_STREAM);
+	OS_Unlock_Global_Impl(OS_OBJECT_TYPE_OS_FILESYS);
+
+	return return_code;
+} /* end OS_FileSysRamDiskSave */
@@ -39,17 +39,32 @@
  TYPEDEFS
  ****************************************************************************************/
 
+/*
+ * Symbol table dump records are packed back to back without padding:
+ *
+ *    uint16   name length in bytes (host byte order)
+ *    char     name[length], not NUL terminated
+ *    cpuaddr  symbol address
+ *
+ * They are gathered in a buffer by OS_SymbolDump_Write and written to the
+ * file OS_FREERTOS_FILE_BUFFER_SIZE bytes, a whole number of sectors, at a time.
+ */
 typedef struct
 {
-	char SymbolName[OS_MAX_SYM_LEN];
-	cpuaddr SymbolAddress;
-} SymbolRecord_t;
+	int32 VolumeType;
+	FF_FILE *ff_file;			/* RAM_DISK */
+	HANDLE host_file;			/* FS_BASED */
+	uint8 *buffer;
+	uint32 buffer_len;
+	uint32 total;
+	uint32 limit;
+} OS_SymbolDumpStream_t;
 
 /****************************************************************************************
  DEFINES
  ****************************************************************************************/
 
-#define OS_SYMBOL_RECORD_SIZE sizeof(SymbolRecord_t)
+#define OS_SYMBOL_RECORD_HEADER_SIZE	sizeof(uint16)
 
 /****************************************************************************************
  GLOBAL DATA
@@ -111,6 +126,11 @@ int32 OS_FreeRTOS_ModuleAPI_Impl_Init(void)
 	 */
 	memset(&(OS_symbol_table[0]), 0, sizeof(static_load_file_header_t) * OS_MAX_MODULES);
 
+	/*
+	 ** Build the static loader's module and symbol name indexes
+	 */
+	SimpleStaticLoaderInit();
+
 	return OS_SUCCESS;
 } /* end OS_FreeRTOS_ModuleAPI_Impl_Init */
 
@@ -129,21 +149,92 @@ int32 OS_FreeRTOS_ModuleAPI_Impl_Init(void)
 int32 OS_SymbolLookup_Impl(cpuaddr *SymbolAddress, const char *SymbolName)
 {
 	/*
-	 ** Lookup the symbol
+	 ** Lookup the symbol in the static loader's symbol index, only the
+	 ** symbols of loaded modules are found
 	 */
-	for(int i = 0; i < OS_MAX_MODULES; i++)
+	if(SimpleStaticLookupSymbol(SymbolName, SymbolAddress))
 	{
-		if((OS_impl_module_table[i].free == FALSE) && (strcmp((char*) SymbolName, OS_symbol_table[i].entry_point_name) == 0))
-		{
-			*SymbolAddress = (cpuaddr) OS_symbol_table[i].entry_point;
-			return OS_SUCCESS;
-		}
+		return OS_SUCCESS;
 	}
 
 	return OS_ERROR;
 } /* end OS_SymbolLookup_Impl */
 
 
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SymbolDump_Flush
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Write the buffered part of a symbol dump to the file.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_SymbolDump_Flush(OS_SymbolDumpStream_t *stream)
+{
+	DWORD written;
+	int32 return_code = OS_SUCCESS;
+
+	if(stream->buffer_len == 0)
+	{
+		return OS_SUCCESS;
+	}
+
+	if(stream->VolumeType == RAM_DISK)
+	{
+		if(ff_fwrite(stream->buffer, 1, stream->buffer_len, stream->ff_file) != stream->buffer_len)
+		{
+			return_code = OS_ERROR;
+		}
+	}
+	else
+	{
+		if(!WriteFile(stream->host_file, stream->buffer, stream->buffer_len, &written, NULL) || written != stream->buffer_len)
+		{
+			return_code = OS_ERROR;
+		}
+	}
+
+	stream->buffer_len = 0;
+
+	return return_code;
+} /* end OS_SymbolDump_Flush */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SymbolDump_Write
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Append bytes to a symbol dump, the file is written a full
+ *           buffer at a time.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_SymbolDump_Write(OS_SymbolDumpStream_t *stream, const void *data, uint32 size)
+{
+	const uint8 *src = data;
+	uint32 chunk;
+
+	while(size > 0)
+	{
+		if(stream->buffer_len == OS_FREERTOS_FILE_BUFFER_SIZE && OS_SymbolDump_Flush(stream) != OS_SUCCESS)
+		{
+			return OS_ERROR;
+		}
+
+		chunk = OS_FREERTOS_FILE_BUFFER_SIZE - stream->buffer_len;
+		if(chunk > size)
+		{
+			chunk = size;
+		}
+
+		memcpy(&stream->buffer[stream->buffer_len], src, chunk);
+		stream->buffer_len += chunk;
+		src += chunk;
+		size -= chunk;
+	}
+
+	return OS_SUCCESS;
+} /* end OS_SymbolDump_Write */
+
 /*----------------------------------------------------------------
  *
  * Function: OS_SymbolTableDump_Impl
@@ -151,62 +242,107 @@ int32 OS_SymbolLookup_Impl(cpuaddr *SymbolAddress, const char *SymbolName)
  *  Purpose: Implemented per internal OSAL API
  *           See prototype in os-impl.h for argument/return detail
  *
+ *           Dumps every symbol known to the static loader.  Only whole
+ *           records are written and the file never grows beyond
+ *           SizeLimit; OS_ERROR is returned when the table did not fit.
+ *
  *-----------------------------------------------------------------*/
 int32 OS_SymbolTableDump_Impl(const char *local_filename, uint32 SizeLimit)
 {
-	FF_FILE *sym_table_file_fd;
+	OS_SymbolDumpStream_t stream;
 	int32 return_status;
-	int status;
-	SymbolRecord_t symRecord;
-	int i;
-
-	if(SizeLimit < OS_SYMBOL_RECORD_SIZE)
+	const char *name;
+	cpuaddr address;
+	uint16 name_len;
+	uint32 record_size;
+	uint32 heap_category;
+	uint32 i;
+
+	memset(&stream, 0, sizeof(stream));
+	stream.limit = SizeLimit;
+	stream.VolumeType = OS_GetVolumeType(local_filename);
+
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_FILESYS);
+	stream.buffer = pvPortMalloc(OS_FREERTOS_FILE_BUFFER_SIZE);
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+	if(stream.buffer == NULL)
 	{
 		return OS_ERROR;
 	}
 
 	/*
-	 ** Open file. "open" returns -1 on error.
+	 ** Open the file on the volume it belongs to
 	 */
-	sym_table_file_fd = ff_fopen(local_filename, "w");
-	if(sym_table_file_fd != NULL)
+	return_status = OS_SUCCESS;
+	if(stream.VolumeType == RAM_DISK)
 	{
-		/*
-		 ** Lookup the symbol
-		 */
-		for(i = 0; i < OS_MAX_MODULES; i++)
+		stream.ff_file = ff_fopen(local_filename, "w");
+		if(stream.ff_file == NULL)
 		{
-			if(OS_impl_module_table[i].free == FALSE)
-			{
-				/*
-				 ** Copy symbol name
-				 */
-				strncpy(symRecord.SymbolName, OS_symbol_table[i].entry_point_name, OS_MAX_SYM_LEN);
-
-				/*
-				 ** Save symbol address
-				 */
-				symRecord.SymbolAddress = (cpuaddr) OS_symbol_table[i].entry_point;
-
-				/*
-				 ** Write entry in file
-				 */
-				status = ff_fwrite(&symRecord, 1, sizeof(symRecord), sym_table_file_fd);
-				if(status == -1)
-				{
-					ff_fclose(sym_table_file_fd);
-					return OS_ERROR;
-				}
-			} /* end if */
-		} /* end for */
-		return_status = OS_SUCCESS;
+			return_status = OS_ERROR;
+		}
+		else
+		{
+			OS_FreeRTOS_DirSnapshotInvalidate(local_filename);
+		}
+	}
+	else if(stream.VolumeType == FS_BASED)
+	{
+		stream.host_file = CreateFileA(local_filename, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+		                               FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if(stream.host_file == INVALID_HANDLE_VALUE)
+		{
+			return_status = OS_ERROR;
+		}
 	}
 	else
 	{
 		return_status = OS_ERROR;
 	}
 
-	ff_fclose(sym_table_file_fd);
+	if(return_status != OS_SUCCESS)
+	{
+		vPortFree(stream.buffer);
+		return return_status;
+	}
+
+	/*
+	 ** Stream the records
+	 */
+	for(i = 0; return_status == OS_SUCCESS && SimpleStaticGetSymbol(i, &name, &address); i++)
+	{
+		name_len = (uint16) strnlen(name, OS_MAX_SYM_LEN);
+		record_size = OS_SYMBOL_RECORD_HEADER_SIZE + name_len + sizeof(address);
+		if(record_size > stream.limit - stream.total)
+		{
+			return_status = OS_ERROR;
+			break;
+		}
+
+		if(OS_SymbolDump_Write(&stream, &name_len, sizeof(name_len)) != OS_SUCCESS ||
+		   OS_SymbolDump_Write(&stream, name, name_len) != OS_SUCCESS ||
+		   OS_SymbolDump_Write(&stream, &address, sizeof(address)) != OS_SUCCESS)
+		{
+			return_status = OS_ERROR;
+		}
+		stream.total += record_size;
+	}
+
+	if(OS_SymbolDump_Flush(&stream) != OS_SUCCESS)
+	{
+		return_status = OS_ERROR;
+	}
+
+	if(stream.VolumeType == RAM_DISK)
+	{
+		ff_fclose(stream.ff_file);
+	}
+	else
+	{
+		CloseHandle(stream.host_file);
+	}
+	vPortFree(stream.buffer);
+	OS_FreeRTOS_FileCacheInvalidate(local_filename);
 
 	return return_status;
 } /* end OS_SymbolTableDump_Impl */
@@ -258,6 +394,7 @@ int32 OS_ModuleLoad_Impl(uint32 local_id, char *translated_path)
  *-----------------------------------------------------------------*/
 int32 OS_ModuleUnload_Impl(uint32 local_id)
 {
+	SimpleStaticUnloadFile(OS_symbol_table[local_id].module_name);
 	OS_impl_module_table[local_id].free = TRUE;
 
 	return OS_SUCCESS;
@@ -285,4 +422,376 @@ int32 OS_ModuleGetInfo_Impl(uint32 local_id, OS_module_prop_t *module_prop)
 	return OS_SUCCESS;
 } /* end OS_ModuleGetInfo_Impl */
 
+/****************************************************************************************
+ Module Startup API
+ ****************************************************************************************/
+
+/*
+ * Marks the end of work in the ready queue and a stopped worker in the done queue
+ */
+#define OS_MODULE_STARTUP_STOP		0xFFFFFFFF
+
+/*
+ * State of one entry of the startup table during OS_ModuleStartup
+ */
+typedef struct
+{
+	uint32 depends[SIMPLE_STATIC_MAX_DEPENDS];	/* startup table indexes */
+	uint32 depend_count;
+	uint32 waiting;			/* dependencies not started yet */
+	bool dispatched;
+	bool done;
+	bool blocked;			/* a dependency failed */
+	int32 status;
+	uint32 worker;
+	uint64 start_nsec;
+	uint64 end_nsec;
+} OS_module_startup_entry_t;
+
+typedef struct
+{
+	const static_startup_entry_t *table;
+	OS_module_startup_entry_t *entries;
+	uint32 count;
+	QueueHandle_t ready;	/* table indexes for the workers */
+	QueueHandle_t done;		/* table indexes the workers finished */
+} OS_module_startup_t;
+
+typedef struct
+{
+	OS_module_startup_t *startup;
+	uint32 worker;
+} OS_module_startup_worker_t;
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ModuleStartup_Worker
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Worker task of OS_ModuleStartup, runs init functions until
+ *           it is told to stop.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_ModuleStartup_Worker(void *arg)
+{
+	OS_module_startup_worker_t *worker = arg;
+	OS_module_startup_t *startup = worker->startup;
+	OS_module_startup_entry_t *entry;
+	const static_startup_entry_t *desc;
+	uint32 index;
+	cpuaddr init;
+
+	for(;;)
+	{
+		xQueueReceive(startup->ready, &index, portMAX_DELAY);
+		if(index == OS_MODULE_STARTUP_STOP)
+		{
+			break;
+		}
+
+		entry = &startup->entries[index];
+		desc = &startup->table[index];
+		entry->worker = worker->worker;
+		entry->start_nsec = OS_GetMonotonicNsec();
+		if(SimpleStaticFindSymbol(desc->module_name, desc->init_symbol, &init))
+		{
+			entry->status = ((int32 (*)(void)) init)();
+		}
+		else
+		{
+			entry->status = OS_ERR_NAME_NOT_FOUND;
+		}
+		entry->end_nsec = OS_GetMonotonicNsec();
+
+		xQueueSend(startup->done, &index, portMAX_DELAY);
+	}
+
+	index = OS_MODULE_STARTUP_STOP;
+	xQueueSend(startup->done, &index, portMAX_DELAY);
+	vTaskDelete(NULL);
+} /* end OS_ModuleStartup_Worker */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ModuleStartup_Complete
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Record a finished entry and release the entries waiting on it.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_ModuleStartup_Complete(OS_module_startup_t *startup, uint32 index)
+{
+	uint32 i;
+	uint32 d;
+
+	startup->entries[index].done = true;
+
+	for(i = 0; i < startup->count; i++)
+	{
+		for(d = 0; d < startup->entries[i].depend_count; d++)
+		{
+			if(startup->entries[i].depends[d] == index)
+			{
+				--startup->entries[i].waiting;
+				if(startup->entries[index].status != OS_SUCCESS)
+				{
+					startup->entries[i].blocked = true;
+				}
+			}
+		}
+	}
+} /* end OS_ModuleStartup_Complete */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ModuleStartup_Dispatch
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Hand every entry whose dependencies are all started to the
+ *           workers, lowest priority number first.  Entries behind a
+ *           failed dependency are completed without running.
+ *
+ *  Returns: The number of entries handed to the workers
+ *
+ *-----------------------------------------------------------------*/
+static uint32 OS_ModuleStartup_Dispatch(OS_module_startup_t *startup)
+{
+	uint32 dispatched = 0;
+	uint32 best;
+	uint32 i;
+
+	for(;;)
+	{
+		best = startup->count;
+		for(i = 0; i < startup->count; i++)
+		{
+			if(!startup->entries[i].dispatched && startup->entries[i].waiting == 0 &&
+			   (best == startup->count || startup->table[i].priority < startup->table[best].priority))
+			{
+				best = i;
+			}
+		}
+
+		if(best == startup->count)
+		{
+			break;
+		}
+
+		startup->entries[best].dispatched = true;
+		if(startup->entries[best].blocked)
+		{
+			startup->entries[best].status = OS_ERROR;
+			OS_ModuleStartup_Complete(startup, best);
+		}
+		else
+		{
+			xQueueSend(startup->ready, &best, portMAX_DELAY);
+			++dispatched;
+		}
+	}
+
+	return dispatched;
+} /* end OS_ModuleStartup_Dispatch */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ModuleStartup_Report
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Print the startup timing of every entry.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_ModuleStartup_Report(const OS_module_startup_t *startup, uint64 begin_nsec, uint64 end_nsec)
+{
+	const OS_module_startup_entry_t *entry;
+	uint64 busy_nsec = 0;
+	uint32 i;
+
+	OS_printf("Module startup: %u modules in %u usec\n", (unsigned int) startup->count,
+	          (unsigned int) ((end_nsec - begin_nsec) / 1000));
+
+	for(i = 0; i < startup->count; i++)
+	{
+		entry = &startup->entries[i];
+		if(entry->start_nsec == 0)
+		{
+			OS_printf("  %-32s not run, status %d\n", startup->table[i].module_name, (int) entry->status);
+			continue;
+		}
+
+		busy_nsec += entry->end_nsec - entry->start_nsec;
+		OS_printf("  %-32s worker %u start %8u usec took %8u usec status %d\n", startup->table[i].module_name,
+		          (unsigned int) entry->worker, (unsigned int) ((entry->start_nsec - begin_nsec) / 1000),
+		          (unsigned int) ((entry->end_nsec - entry->start_nsec) / 1000), (int) entry->status);
+	}
+
+	OS_printf("Module startup: %u usec of init functions\n", (unsigned int) (busy_nsec / 1000));
+} /* end OS_ModuleStartup_Report */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ModuleStartup
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ModuleStartup(uint32 worker_count)
+{
+	OS_module_startup_t startup;
+	OS_module_startup_worker_t workers[OS_FREERTOS_STARTUP_MAX_WORKERS];
+	uint32 started_workers;
+	uint32 in_flight;
+	uint32 heap_category;
+	uint32 index;
+	uint32 i;
+	uint32 j;
+	uint32 d;
+	uint64 begin_nsec;
+	int32 return_code = OS_SUCCESS;
+
+	memset(&startup, 0, sizeof(startup));
+	startup.count = SimpleStaticGetStartup(&startup.table);
+	if(startup.count == 0)
+	{
+		return OS_SUCCESS;
+	}
+
+	if(worker_count == 0 || worker_count > OS_FREERTOS_STARTUP_MAX_WORKERS)
+	{
+		worker_count = OS_FREERTOS_STARTUP_MAX_WORKERS;
+	}
+	if(worker_count > startup.count)
+	{
+		worker_count = startup.count;
+	}
+
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_TASK);
+	startup.entries = pvPortMalloc(startup.count * sizeof(OS_module_startup_entry_t));
+	startup.ready = xQueueCreate(startup.count + worker_count, sizeof(uint32));
+	startup.done = xQueueCreate(startup.count + worker_count, sizeof(uint32));
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+
+	if(startup.entries == NULL || startup.ready == NULL || startup.done == NULL)
+	{
+		return_code = OS_ERROR;
+	}
+	else
+	{
+		/*
+		 ** Resolve the dependencies by module name
+		 */
+		memset(startup.entries, 0, startup.count * sizeof(OS_module_startup_entry_t));
+		for(i = 0; i < startup.count && return_code == OS_SUCCESS; i++)
+		{
+			for(d = 0; d < SIMPLE_STATIC_MAX_DEPENDS && startup.table[i].depends_on[d] != NULL; d++)
+			{
+				for(j = 0; j < startup.count; j++)
+				{
+					if(strcmp(startup.table[i].depends_on[d], startup.table[j].module_name) == 0)
+					{
+						break;
+					}
+				}
+				if(j == startup.count || j == i)
+				{
+					OS_DEBUG("OS_ModuleStartup: %s depends on unknown module %s\n", startup.table[i].module_name,
+					         startup.table[i].depends_on[d]);
+					return_code = OS_ERROR;
+					break;
+				}
+				startup.entries[i].depends[startup.entries[i].depend_count++] = j;
+				++startup.entries[i].waiting;
+			}
+		}
+	}
+
+	started_workers = 0;
+	if(return_code == OS_SUCCESS)
+	{
+		heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_TASK);
+		for(i = 0; i < worker_count; i++)
+		{
+			workers[i].startup = &startup;
+			workers[i].worker = i;
+			if(xTaskCreate(OS_ModuleStartup_Worker, "OS_Startup", OS_FREERTOS_STARTUP_STACK_SIZE, &workers[i],
+			               uxTaskPriorityGet(NULL), NULL) != pdPASS)
+			{
+				break;
+			}
+			++started_workers;
+		}
+		OS_FreeRTOS_HeapCategorySet(heap_category);
+
+		if(started_workers == 0)
+		{
+			return_code = OS_ERROR;
+		}
+	}
+
+	if(return_code == OS_SUCCESS)
+	{
+		/*
+		 ** Keep the workers busy until every entry is done.  Nothing in
+		 ** flight with entries left over means a dependency cycle.
+		 */
+		begin_nsec = OS_GetMonotonicNsec();
+		in_flight = OS_ModuleStartup_Dispatch(&startup);
+		while(in_flight > 0)
+		{
+			xQueueReceive(startup.done, &index, portMAX_DELAY);
+			--in_flight;
+			OS_ModuleStartup_Complete(&startup, index);
+			in_flight += OS_ModuleStartup_Dispatch(&startup);
+		}
+
+		for(i = 0; i < startup.count; i++)
+		{
+			if(!startup.entries[i].done)
+			{
+				OS_DEBUG("OS_ModuleStartup: %s is in a dependency cycle\n", startup.table[i].module_name);
+				startup.entries[i].status = OS_ERROR;
+			}
+			if(startup.entries[i].status != OS_SUCCESS)
+			{
+				return_code = OS_ERROR;
+			}
+		}
+
+		OS_ModuleStartup_Report(&startup, begin_nsec, OS_GetMonotonicNsec());
+	}
+
+	/*
+	 ** Stop the workers, they use the queues up to the end
+	 */
+	index = OS_MODULE_STARTUP_STOP;
+	for(i = 0; i < started_workers; i++)
+	{
+		xQueueSend(startup.ready, &index, portMAX_DELAY);
+	}
+	while(started_workers > 0)
+	{
+		xQueueReceive(startup.done, &index, portMAX_DELAY);
+		if(index == OS_MODULE_STARTUP_STOP)
+		{
+			--started_workers;
+		}
+	}
+
+	if(startup.ready != NULL)
+	{
+		vQueueDelete(startup.ready);
+	}
+	if(startup.done != NULL)
+	{
+		vQueueDelete(startup.done);
+	}
+	if(startup.entries != NULL)
+	{
+		vPortFree(startup.entries);
+	}
+
+	return return_code;
+} /* end OS_ModuleStartup */
+
 #endif /* OS_INCLUDE_MODULE_LOADER */
@@ -0,0 +1,383 @@
+/*
+ *  NASA Docket No. GSC-18,370-1, and identified as "Operating System Abstraction Layer"
+ *
+ *  Copyright (c) 2019 United States Government as represented by
+ *  the Administrator of the National Aeronautics and Space Administration.
+ *  All Rights Reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * \file   osmempool.c
+ *
+ * Purpose: This file contains the fixed size block pools, see OS_MemPoolCreate
+ */
+
+/****************************************************************************************
+ INCLUDE FILES
+ ***************************************************************************************/
+
+#include <string.h>
+
+#include "os-FreeRTOS.h"
+
+/****************************************************************************************
+ GLOBAL DATA
+ ***************************************************************************************/
+
+/*
+ * A memory pool.  The free blocks are kept on a Win32 interlocked singly
+ * linked list, whose link lives in the first bytes of each free block, so
+ * allocating and freeing is one interlocked push or pop with no lock and no
+ * search.  The list header is versioned by Windows, so a block taken and put
+ * back between another caller's read and swap cannot corrupt it.
+ *
+ * state has one entry per block, set while the block is allocated, so a
+ * block freed twice is caught before it is pushed a second time.
+ *
+ * reserved claims the entry while it is set up or torn down; in_use is only
+ * set once the pool is complete, so a lookup never sees a half built pool.
+ */
+typedef struct
+{
+	SLIST_HEADER    free_list;
+	bool            reserved;
+	volatile bool   in_use;
+	uint16          generation;		/* high bits of the id, see OS_FREERTOS_EXT_ID */
+	uint8          *storage;		/* as returned by pvPortMalloc */
+	uint8          *base;			/* first block, aligned for the list links */
+	uint32          stride;
+	uint32          block_size;
+	uint32          block_count;
+	volatile LONG  *state;
+	volatile LONG   free_count;
+	volatile LONG   min_free;
+	volatile LONG   alloc_count;
+	volatile LONG   fail_count;
+} OS_impl_mempool_t;
+
+static OS_impl_mempool_t OS_impl_mempool_table[OS_FREERTOS_MAX_MEMPOOLS];
+
+/****************************************************************************************
+ MEMORY POOL EXTENSION API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MemPool_Get
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns the pool of an id, or NULL if there is none
+ *
+ *-----------------------------------------------------------------*/
+static OS_impl_mempool_t *OS_MemPool_Get(uint32 pool_id)
+{
+	OS_impl_mempool_t *pool;
+	uint32 index = OS_FREERTOS_EXT_ID_INDEX(pool_id);
+
+	if(index >= OS_FREERTOS_MAX_MEMPOOLS)
+	{
+		return NULL;
+	}
+
+	pool = &OS_impl_mempool_table[index];
+	if(!pool->in_use || pool->generation != OS_FREERTOS_EXT_ID_GEN(pool_id))
+	{
+		return NULL;
+	}
+
+	return pool;
+} /* end OS_MemPool_Get */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MemPoolCreate
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MemPoolCreate(uint32 *pool_id, uint32 block_size, uint32 block_count)
+{
+	OS_impl_mempool_t *pool;
+	uint32 stride;
+	uint32 i;
+
+	if(pool_id == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*pool_id = 0;
+
+	/* Checked before rounding, which would otherwise wrap a huge size to 0 */
+	if(block_size == 0 || block_count == 0 || block_size > 0x7FFFFFFF - MEMORY_ALLOCATION_ALIGNMENT)
+	{
+		return OS_ERROR;
+	}
+
+	/* Keep every block aligned for its list link while it is free */
+	stride = (block_size < sizeof(SLIST_ENTRY)) ? sizeof(SLIST_ENTRY) : block_size;
+	stride = (stride + MEMORY_ALLOCATION_ALIGNMENT - 1) & ~((uint32)MEMORY_ALLOCATION_ALIGNMENT - 1);
+	if(block_count > 0x7FFFFFFF / stride)
+	{
+		return OS_ERROR;
+	}
+
+	pool = NULL;
+	taskENTER_CRITICAL();
+	for(i = 0; i < OS_FREERTOS_MAX_MEMPOOLS; i++)
+	{
+		if(!OS_impl_mempool_table[i].reserved)
+		{
+			pool = &OS_impl_mempool_table[i];
+			pool->reserved = true;
+			break;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if(pool == NULL)
+	{
+		return OS_ERR_NO_FREE_IDS;
+	}
+
+	pool->storage = (uint8 *) pvPortMalloc(stride * block_count + MEMORY_ALLOCATION_ALIGNMENT);
+	pool->state = (volatile LONG *) pvPortMalloc(block_count * sizeof(LONG));
+	if(pool->storage == NULL || pool->state == NULL)
+	{
+		vPortFree(pool->storage);
+		vPortFree((void *) pool->state);
+		pool->storage = NULL;
+		pool->state = NULL;
+		taskENTER_CRITICAL();
+		pool->reserved = false;
+		taskEXIT_CRITICAL();
+		return OS_ERROR;
+	}
+
+	pool->base = (uint8 *)(((cpuaddr) pool->storage + MEMORY_ALLOCATION_ALIGNMENT - 1) &
+			~((cpuaddr)MEMORY_ALLOCATION_ALIGNMENT - 1));
+	pool->stride = stride;
+	pool->block_size = block_size;
+	pool->block_count = block_count;
+	pool->free_count = (LONG) block_count;
+	pool->min_free = (LONG) block_count;
+	pool->alloc_count = 0;
+	pool->fail_count = 0;
+
+	/* Pushed last to first, so the first allocations come out in address order */
+	InitializeSListHead(&pool->free_list);
+	for(i = block_count; i > 0; i--)
+	{
+		pool->state[i - 1] = 0;
+		InterlockedPushEntrySList(&pool->free_list, (PSLIST_ENTRY) &pool->base[(i - 1) * stride]);
+	}
+
+	/* Published last, once everything a lookup can reach is in place */
+	taskENTER_CRITICAL();
+	++pool->generation;
+	pool->in_use = true;
+	taskEXIT_CRITICAL();
+
+	*pool_id = OS_FREERTOS_EXT_ID(pool - OS_impl_mempool_table, pool->generation);
+
+	return OS_SUCCESS;
+} /* end OS_MemPoolCreate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MemPoolDelete
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MemPoolDelete(uint32 pool_id)
+{
+	OS_impl_mempool_t *pool;
+	int32 return_code = OS_ERR_INVALID_ID;
+
+	/* Withdrawn from lookups before the storage goes */
+	taskENTER_CRITICAL();
+	pool = OS_MemPool_Get(pool_id);
+	if(pool != NULL)
+	{
+		return_code = OS_SUCCESS;
+		if(pool->free_count != (LONG) pool->block_count)
+		{
+			return_code = OS_ERR_INCORRECT_OBJ_STATE;
+		}
+		else
+		{
+			pool->in_use = false;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	InterlockedFlushSList(&pool->free_list);
+	vPortFree(pool->storage);
+	vPortFree((void *) pool->state);
+	pool->storage = NULL;
+	pool->base = NULL;
+	pool->state = NULL;
+
+	taskENTER_CRITICAL();
+	pool->reserved = false;
+	taskEXIT_CRITICAL();
+
+	return OS_SUCCESS;
+} /* end OS_MemPoolDelete */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MemPoolAlloc
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MemPoolAlloc(uint32 pool_id, void **block)
+{
+	OS_impl_mempool_t *pool;
+	PSLIST_ENTRY entry;
+	LONG free_count;
+	LONG min_free;
+
+	if(block == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*block = NULL;
+
+	pool = OS_MemPool_Get(pool_id);
+	if(pool == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	entry = InterlockedPopEntrySList(&pool->free_list);
+	if(entry == NULL)
+	{
+		InterlockedIncrement(&pool->fail_count);
+		return OS_QUEUE_EMPTY;
+	}
+
+	pool->state[((uint8 *) entry - pool->base) / pool->stride] = 1;
+	InterlockedIncrement(&pool->alloc_count);
+
+	free_count = InterlockedDecrement(&pool->free_count);
+	min_free = pool->min_free;
+	while(free_count < min_free)
+	{
+		LONG seen = InterlockedCompareExchange(&pool->min_free, free_count, min_free);
+		if(seen == min_free)
+		{
+			break;
+		}
+		min_free = seen;
+	}
+
+	*block = entry;
+
+	return OS_SUCCESS;
+} /* end OS_MemPoolAlloc */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MemPoolFree
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MemPoolFree(uint32 pool_id, void *block)
+{
+	OS_impl_mempool_t *pool;
+	cpuaddr offset;
+
+	pool = OS_MemPool_Get(pool_id);
+	if(pool == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	/*
+	 ** Only accept pointers to the start of one of this pool's blocks
+	 */
+	if((uint8 *) block < pool->base)
+	{
+		return OS_ERR_BAD_ADDRESS;
+	}
+
+	offset = (cpuaddr)((uint8 *) block - pool->base);
+	if(offset >= (cpuaddr) pool->stride * pool->block_count || (offset % pool->stride) != 0)
+	{
+		return OS_ERR_BAD_ADDRESS;
+	}
+
+	if(InterlockedExchange(&pool->state[offset / pool->stride], 0) == 0)
+	{
+		/* Already free */
+		return OS_ERR_INCORRECT_OBJ_STATE;
+	}
+
+	/* Counted before it is pushed, so an allocation of it can never take the count below 0 */
+	InterlockedIncrement(&pool->free_count);
+	InterlockedPushEntrySList(&pool->free_list, (PSLIST_ENTRY) block);
+
+	return OS_SUCCESS;
+} /* end OS_MemPoolFree */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_MemPoolGetStats
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_MemPoolGetStats(uint32 pool_id, OS_mempool_stats_t *pool_stats)
+{
+	OS_impl_mempool_t *pool;
+
+	if(pool_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(pool_stats, 0, sizeof(OS_mempool_stats_t));
+
+	pool = OS_MemPool_Get(pool_id);
+	if(pool == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	/* The counters are read one by one, an allocation made meanwhile may be half counted */
+	pool_stats->block_size = pool->block_size;
+	pool_stats->block_count = pool->block_count;
+	pool_stats->free_blocks = (uint32) pool->free_count;
+	pool_stats->min_free_blocks = (uint32) pool->min_free;
+	pool_stats->alloc_count = (uint32) pool->alloc_count;
+	pool_stats->fail_count = (uint32) pool->fail_count;
+
+	return OS_SUCCESS;
+} /* end OS_MemPoolGetStats */
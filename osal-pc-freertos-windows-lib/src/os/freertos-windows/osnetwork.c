@@ -36,6 +36,9 @@
  DEFINES
  ****************************************************************************************/
 
+/* Listen backlog of stream sockets unless set with OS_SOCKET_OPT_BACKLOG */
+#define OS_SOCKET_DEFAULT_BACKLOG   10
+
 typedef union
 {
    struct freertos_sockaddr freertos_sockaddr;
@@ -45,16 +48,147 @@ typedef union
  GLOBAL DATA
  ***************************************************************************************/
 
-/*
- * The file handle table.
- * This is shared by all OSAL entities that perform low-level I/O.
- */
-OS_FreeRTOS_filehandle_entry_t OS_impl_filehandle_table[OS_MAX_NUM_OPEN_FILES];
-
 /****************************************************************************************
  EXTERNAL DECLARATIONS
  ***************************************************************************************/
 
+/****************************************************************************************
+ Socket stream operations
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Socket_Ticks
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Converts an OSAL timeout in milliseconds to a FreeRTOS block time
+ *
+ *-----------------------------------------------------------------*/
+static TickType_t OS_Socket_Ticks(int32 timeout)
+{
+   if (timeout < 0)
+   {
+      return portMAX_DELAY;
+   }
+
+   return (TickType_t) OS_Milli2Ticks(timeout);
+} /* end OS_Socket_Ticks */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Socket_SetRecvTimeout
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Sets the receive timeout of a socket, which FreeRTOS+TCP also
+ *           uses as the connect timeout.  The value is cached so repeated
+ *           calls with the same timeout cost nothing.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Socket_SetRecvTimeout(uint32 local_id, TickType_t ticks)
+{
+   if (OS_impl_filehandle_table[local_id].recv_timeout != ticks)
+   {
+      FreeRTOS_setsockopt(OS_impl_filehandle_fd[local_id], 0, FREERTOS_SO_RCVTIMEO, &ticks, sizeof(ticks));
+      OS_impl_filehandle_table[local_id].recv_timeout = ticks;
+   }
+} /* end OS_Socket_SetRecvTimeout */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Socket_Read
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Read operation of socket streams, used by OS_read on a
+ *           connected socket.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Socket_Read(uint32 local_id, void *buffer, uint32 nbytes, int32 timeout)
+{
+   int32 return_code;
+   int os_result;
+   uint32 operation;
+
+   operation = OS_STREAM_STATE_READABLE;
+   return_code = OS_SelectSingle_Impl(local_id, &operation, timeout);
+   if (return_code == OS_SUCCESS)
+   {
+      if ((operation & OS_STREAM_STATE_READABLE) == 0)
+      {
+         return_code = OS_ERROR_TIMEOUT;
+      }
+      else
+      {
+         os_result = FreeRTOS_recv(OS_impl_filehandle_fd[local_id], buffer, nbytes, 0);
+         if (os_result < 0)
+         {
+            return_code = OS_ERROR;
+         }
+         else
+         {
+            return_code = os_result;
+         }
+      }
+   }
+
+   return return_code;
+} /* end OS_Socket_Read */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Socket_Write
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Socket_Write(uint32 local_id, const void *buffer, uint32 nbytes, int32 timeout)
+{
+   int os_result;
+
+   os_result = FreeRTOS_send(OS_impl_filehandle_fd[local_id], buffer, nbytes, 0);
+   if (os_result <= 0)
+   {
+      return OS_ERROR;
+   }
+
+   return os_result;
+} /* end OS_Socket_Write */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Socket_Close
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Socket_Close(uint32 local_id)
+{
+   /* Detach the socket from its select sets first, the IP task may still look at it while closing */
+   OS_FreeRTOS_EventSetDetach(local_id);
+   if (OS_impl_filehandle_table[local_id].select_set != NULL)
+   {
+      FreeRTOS_FD_CLR(OS_impl_filehandle_fd[local_id], OS_impl_filehandle_table[local_id].select_set, eSELECT_ALL);
+   }
+
+   FreeRTOS_closesocket(OS_impl_filehandle_fd[local_id]);
+
+   if (OS_impl_filehandle_table[local_id].select_set != NULL)
+   {
+      FreeRTOS_DeleteSocketSet(OS_impl_filehandle_table[local_id].select_set);
+      OS_impl_filehandle_table[local_id].select_set = NULL;
+   }
+
+   return OS_SUCCESS;
+} /* end OS_Socket_Close */
+
+const OS_FreeRTOS_stream_ops_t OS_FreeRTOS_SocketStreamOps =
+{
+   .Read = OS_Socket_Read,
+   .Write = OS_Socket_Write,
+   .Seek = NULL,
+   .Close = OS_Socket_Close,
+   .Sync = NULL
+};
+
 /****************************************************************************************
  Network API
  ***************************************************************************************/
@@ -102,6 +236,9 @@ int32 OS_SocketOpen_Impl(uint32 sock_id)
 	BaseType_t os_domain;
 	BaseType_t os_type;
 	BaseType_t os_proto;
+	uint32 heap_category;
+
+	OS_FREERTOS_API_ENTER(SocketOpen);
 
 	os_proto = 0;
 
@@ -115,7 +252,7 @@ int32 OS_SocketOpen_Impl(uint32 sock_id)
 	  break;
 
 	default:
-	  return OS_ERR_NOT_IMPLEMENTED;
+	  return OS_FREERTOS_API_EXIT(SocketOpen, OS_ERR_NOT_IMPLEMENTED);
 	}
 
 	switch(OS_stream_table[sock_id].socket_domain)
@@ -124,7 +261,7 @@ int32 OS_SocketOpen_Impl(uint32 sock_id)
 	  os_domain = FREERTOS_AF_INET;
 	  break;
 	default:
-	  return OS_ERR_NOT_IMPLEMENTED;
+	  return OS_FREERTOS_API_EXIT(SocketOpen, OS_ERR_NOT_IMPLEMENTED);
 	}
 
 	switch(OS_stream_table[sock_id].socket_domain)
@@ -147,16 +284,21 @@ int32 OS_SocketOpen_Impl(uint32 sock_id)
 	  break;
 	}
 
-	OS_impl_filehandle_table[sock_id].fd = FreeRTOS_socket(os_domain, os_type, os_proto);
-	if (OS_impl_filehandle_table[sock_id].fd == FREERTOS_INVALID_SOCKET)
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_NETWORK);
+	OS_impl_filehandle_fd[sock_id] = FreeRTOS_socket(os_domain, os_type, os_proto);
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+	if (OS_impl_filehandle_fd[sock_id] == FREERTOS_INVALID_SOCKET)
 	{
 	   //Insufficient FreeRTOS heap memory
-		OS_impl_filehandle_table[sock_id].fd = NULL;
-		return OS_ERROR;
+		OS_impl_filehandle_fd[sock_id] = NULL;
+		return OS_FREERTOS_API_EXIT(SocketOpen, OS_ERROR);
 	}
-	OS_impl_filehandle_table[sock_id].selectable = true;
+	OS_impl_filehandle_table[sock_id].ops = &OS_FreeRTOS_SocketStreamOps;
+	OS_impl_filehandle_flags[sock_id] = OS_FREERTOS_STREAM_SELECTABLE;
+	OS_impl_filehandle_table[sock_id].recv_timeout = ipconfigSOCK_DEFAULT_RECEIVE_BLOCK_TIME;
+	OS_impl_filehandle_table[sock_id].listen_backlog = 0;
 
-	return OS_SUCCESS;
+	return OS_FREERTOS_API_EXIT(SocketOpen, OS_SUCCESS);
 } /* end OS_SocketOpen_Impl */
 
 /*----------------------------------------------------------------
@@ -172,6 +314,9 @@ int32 OS_SocketBind_Impl(uint32 sock_id, const OS_SockAddr_t *Addr)
    int os_result;
    socklen_t addrlen;
    struct freertos_sockaddr *sa;
+   uint32 backlog;
+
+   OS_FREERTOS_API_ENTER(SocketBind);
 
    sa = (struct freertos_sockaddr *)Addr->AddrData;
 
@@ -187,25 +332,31 @@ int32 OS_SocketBind_Impl(uint32 sock_id, const OS_SockAddr_t *Addr)
 
    if (addrlen == 0 || addrlen > OS_SOCKADDR_MAX_LEN)
    {
-      return OS_ERR_BAD_ADDRESS;
+      return OS_FREERTOS_API_EXIT(SocketBind, OS_ERR_BAD_ADDRESS);
    }
 
-   os_result = FreeRTOS_bind(OS_impl_filehandle_table[sock_id].fd, sa, addrlen);
+   os_result = FreeRTOS_bind(OS_impl_filehandle_fd[sock_id], sa, addrlen);
    if (os_result < 0)
    {
-      return OS_ERROR;
+      return OS_FREERTOS_API_EXIT(SocketBind, OS_ERROR);
    }
 
    /* Start listening on the socket (implied for stream sockets) */
    if (OS_stream_table[sock_id].socket_type == OS_SocketType_STREAM)
    {
-      os_result = FreeRTOS_listen(OS_impl_filehandle_table[sock_id].fd, 10);
+      backlog = OS_impl_filehandle_table[sock_id].listen_backlog;
+      if (backlog == 0)
+      {
+         backlog = OS_SOCKET_DEFAULT_BACKLOG;
+      }
+
+      os_result = FreeRTOS_listen(OS_impl_filehandle_fd[sock_id], (BaseType_t) backlog);
       if (os_result < 0)
       {
-         return OS_ERROR;
+         return OS_FREERTOS_API_EXIT(SocketBind, OS_ERROR);
       }
    }
-   return OS_SUCCESS;
+   return OS_FREERTOS_API_EXIT(SocketBind, OS_SUCCESS);
 } /* end OS_SocketBind_Impl */
 
 /*----------------------------------------------------------------
@@ -222,6 +373,9 @@ int32 OS_SocketConnect_Impl(uint32 sock_id, const OS_SockAddr_t *Addr, int32 tim
    int os_status;
    socklen_t slen;
    struct freertos_sockaddr *sa;
+   TickType_t previous;
+
+   OS_FREERTOS_API_ENTER(SocketConnect);
 
    sa = (struct freertos_sockaddr *)Addr->AddrData;
    switch(sa->sin_family)
@@ -240,40 +394,36 @@ int32 OS_SocketConnect_Impl(uint32 sock_id, const OS_SockAddr_t *Addr, int32 tim
    }
    else
    {
-       return_code = OS_SUCCESS;
-       os_status = FreeRTOS_connect(OS_impl_filehandle_table[sock_id].fd, sa, slen);
-       if (os_status < 0)
+       /*
+        * FreeRTOS_connect waits on the socket's own event group until the
+        * 3-way handshake completes, the peer refuses or the receive timeout
+        * runs out, so the task sleeps for exactly as long as needed.  The
+        * caller's receive timeout is put back afterwards.
+        */
+       previous = OS_impl_filehandle_table[sock_id].recv_timeout;
+       OS_Socket_SetRecvTimeout(sock_id, OS_Socket_Ticks(timeout));
+
+       os_status = FreeRTOS_connect(OS_impl_filehandle_fd[sock_id], sa, slen);
+
+       OS_Socket_SetRecvTimeout(sock_id, previous);
+
+       if (os_status == 0 || os_status == -pdFREERTOS_ERRNO_EISCONN)
+       {
+           OS_impl_filehandle_flags[sock_id] |= OS_FREERTOS_STREAM_CONNECTED;
+           return_code = OS_SUCCESS;
+       }
+       else if (os_status == -pdFREERTOS_ERRNO_ETIMEDOUT ||
+                os_status == -pdFREERTOS_ERRNO_EINPROGRESS ||
+                os_status == -pdFREERTOS_ERRNO_EWOULDBLOCK)
+       {
+           return_code = OS_ERROR_TIMEOUT;
+       }
+       else
        {
-           if (os_status != -pdFREERTOS_ERRNO_EINPROGRESS && os_status != -pdFREERTOS_ERRNO_EWOULDBLOCK)
-           {
-               return_code = OS_ERROR;
-           }
-           else
-           {
-				//Checking if it is writable does not guarantee that the 3-Way handshake has been completed
-				//Check the connection every 1 millisecond to see when it has been connected
-				uint32 elapsedTime = 0;
-				TickType_t ticks = OS_Milli2Ticks(1);
-				while(elapsedTime<=timeout)
-				{
-					if(FreeRTOS_issocketconnected(OS_impl_filehandle_table[sock_id].fd))
-					{
-					OS_impl_filehandle_table[sock_id].connected = true;
-					return_code = OS_SUCCESS;
-					break;
-					}
-
-					vTaskDelay(ticks);
-					elapsedTime++;
-				}
-				if(elapsedTime>timeout)
-				{
-					return_code = OS_ERROR_TIMEOUT;
-				}
-           }
+           return_code = OS_ERROR;
        }
    }
-   return return_code;
+   return OS_FREERTOS_API_EXIT(SocketConnect, return_code);
 } /* end OS_SocketConnect_Impl */
 
 /*----------------------------------------------------------------
@@ -290,6 +440,8 @@ int32 OS_SocketAccept_Impl(uint32 sock_id, uint32 connsock_id, OS_SockAddr_t *Ad
    uint32 operation;
    socklen_t addrlen;
 
+   OS_FREERTOS_API_ENTER(SocketAccept);
+
    operation = OS_STREAM_STATE_READABLE;
    return_code = OS_SelectSingle_Impl(sock_id, &operation, timeout);
    if (return_code == OS_SUCCESS)
@@ -301,36 +453,38 @@ int32 OS_SocketAccept_Impl(uint32 sock_id, uint32 connsock_id, OS_SockAddr_t *Ad
       else
       {
          addrlen = Addr->ActualLength;
-         OS_impl_filehandle_table[connsock_id].fd = FreeRTOS_accept(OS_impl_filehandle_table[sock_id].fd, (struct freertos_sockaddr *)Addr->AddrData, &addrlen);
-         if (OS_impl_filehandle_table[connsock_id].fd == NULL || OS_impl_filehandle_table[connsock_id].fd == FREERTOS_INVALID_SOCKET )
+         OS_impl_filehandle_fd[connsock_id] = FreeRTOS_accept(OS_impl_filehandle_fd[sock_id], (struct freertos_sockaddr *)Addr->AddrData, &addrlen);
+         if (OS_impl_filehandle_fd[connsock_id] == NULL || OS_impl_filehandle_fd[connsock_id] == FREERTOS_INVALID_SOCKET )
          {
             return_code = OS_ERROR;
          }
          else
          {
              Addr->ActualLength = addrlen;
-             OS_impl_filehandle_table[connsock_id].selectable = true;
-             OS_impl_filehandle_table[connsock_id].connected = true;
+             OS_impl_filehandle_table[connsock_id].ops = &OS_FreeRTOS_SocketStreamOps;
+             OS_impl_filehandle_flags[connsock_id] = OS_FREERTOS_STREAM_SELECTABLE | OS_FREERTOS_STREAM_CONNECTED;
+             /* The child socket inherits the block times of the listening socket */
+             OS_impl_filehandle_table[connsock_id].recv_timeout = OS_impl_filehandle_table[sock_id].recv_timeout;
          }
       }
    }
 
-   return return_code;
+   return OS_FREERTOS_API_EXIT(SocketAccept, return_code);
 } /* end OS_SocketAccept_Impl */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_SocketRecvFrom_Impl
+ * Function: OS_Socket_RecvFrom
  *
- *  Purpose: Implemented per internal OSAL API
- *           See description in os-impl.h for argument/return detail
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Common part of OS_SocketRecvFrom_Impl and OS_SocketRecvFromBuffer_Impl,
+ *           "flags" are extra FreeRTOS_recvfrom flags such as FREERTOS_ZERO_COPY.
  *
  *-----------------------------------------------------------------*/
-int32 OS_SocketRecvFrom_Impl(uint32 sock_id, void *buffer, uint32 buflen, OS_SockAddr_t *RemoteAddr, int32 timeout)
+static int32 OS_Socket_RecvFrom(uint32 sock_id, void *buffer, uint32 buflen, OS_SockAddr_t *RemoteAddr, int32 timeout, BaseType_t flags)
 {
    int32 return_code;
    int os_result;
-   uint32 operation;
    struct freertos_sockaddr *sa;
    socklen_t addrlen;
 
@@ -349,45 +503,65 @@ int32 OS_SocketRecvFrom_Impl(uint32 sock_id, void *buffer, uint32 buflen, OS_Soc
       sa = (struct freertos_sockaddr *)RemoteAddr->AddrData;
    }
 
-   operation = OS_STREAM_STATE_READABLE;
-   return_code = OS_SelectSingle_Impl(sock_id, &operation, timeout);
-   if (return_code == OS_SUCCESS)
+   /*
+    * Try without blocking first, a queued datagram is returned without
+    * touching the socket options.  Otherwise block in FreeRTOS_recvfrom on
+    * the socket's own receive timeout instead of a separate select.
+    */
+   os_result = FreeRTOS_recvfrom(OS_impl_filehandle_fd[sock_id], buffer, buflen, flags | FREERTOS_MSG_DONTWAIT, sa, &addrlen);
+   if ((os_result == 0 || os_result == -pdFREERTOS_ERRNO_EWOULDBLOCK) && timeout != OS_CHECK)
    {
-      if ((operation & OS_STREAM_STATE_READABLE) == 0)
-      {
-         return_code = OS_ERROR_TIMEOUT;
-      }
-      else
-      {
-         os_result = FreeRTOS_recvfrom(OS_impl_filehandle_table[sock_id].fd, buffer, buflen, 0, sa, &addrlen);
-         if (os_result < 0)
-         {
-		   return_code = OS_ERROR;
-         }
-         else
-         {
-            return_code = os_result;
+      OS_Socket_SetRecvTimeout(sock_id, OS_Socket_Ticks(timeout));
+      addrlen = (RemoteAddr == NULL) ? 0 : OS_SOCKADDR_MAX_LEN;
+      os_result = FreeRTOS_recvfrom(OS_impl_filehandle_fd[sock_id], buffer, buflen, flags, sa, &addrlen);
+   }
 
-            if (RemoteAddr != NULL)
-            {
-               RemoteAddr->ActualLength = addrlen;
-            }
-         }
+   if (os_result > 0)
+   {
+      return_code = os_result;
+
+      if (RemoteAddr != NULL)
+      {
+         RemoteAddr->ActualLength = addrlen;
       }
    }
+   else if (os_result == 0 || os_result == -pdFREERTOS_ERRNO_EWOULDBLOCK || os_result == -pdFREERTOS_ERRNO_ETIMEDOUT)
+   {
+      return_code = OS_ERROR_TIMEOUT;
+   }
+   else
+   {
+      return_code = OS_ERROR;
+   }
 
    return return_code;
-} /* end OS_SocketRecvFrom_Impl */
+} /* end OS_Socket_RecvFrom */
 
 /*----------------------------------------------------------------
  *
- * Function: OS_SocketSendTo_Impl
+ * Function: OS_SocketRecvFrom_Impl
  *
  *  Purpose: Implemented per internal OSAL API
  *           See description in os-impl.h for argument/return detail
  *
  *-----------------------------------------------------------------*/
-int32 OS_SocketSendTo_Impl(uint32 sock_id, const void *buffer, uint32 buflen, const OS_SockAddr_t *RemoteAddr)
+int32 OS_SocketRecvFrom_Impl(uint32 sock_id, void *buffer, uint32 buflen, OS_SockAddr_t *RemoteAddr, int32 timeout)
+{
+   OS_FREERTOS_API_ENTER(SocketRecvFrom);
+
+   return OS_FREERTOS_API_EXIT(SocketRecvFrom, OS_Socket_RecvFrom(sock_id, buffer, buflen, RemoteAddr, timeout, 0));
+} /* end OS_SocketRecvFrom_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Socket_SendTo
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Common part of OS_SocketSendTo_Impl and OS_SocketSendToBuffer_Impl,
+ *           "flags" are extra FreeRTOS_sendto flags such as FREERTOS_ZERO_COPY.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Socket_SendTo(uint32 sock_id, const void *buffer, uint32 buflen, const OS_SockAddr_t *RemoteAddr, BaseType_t flags)
 {
    int os_result;
    socklen_t addrlen;
@@ -409,15 +583,286 @@ int32 OS_SocketSendTo_Impl(uint32 sock_id, const void *buffer, uint32 buflen, co
       return OS_ERR_BAD_ADDRESS;
    }
 
-   os_result = FreeRTOS_sendto(OS_impl_filehandle_table[sock_id].fd, buffer, buflen, 0, sa, addrlen);
+   os_result = FreeRTOS_sendto(OS_impl_filehandle_fd[sock_id], buffer, buflen, flags, sa, addrlen);
    if (os_result == 0)
    {
       return OS_ERROR;
    }
 
    return os_result;
+} /* end OS_Socket_SendTo */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketSendTo_Impl
+ *
+ *  Purpose: Implemented per internal OSAL API
+ *           See description in os-impl.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketSendTo_Impl(uint32 sock_id, const void *buffer, uint32 buflen, const OS_SockAddr_t *RemoteAddr)
+{
+   OS_FREERTOS_API_ENTER(SocketSendTo);
+
+   return OS_FREERTOS_API_EXIT(SocketSendTo, OS_Socket_SendTo(sock_id, buffer, buflen, RemoteAddr, 0));
 } /* end OS_SocketSendTo_Impl */
 
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketBufferAlloc_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketBufferAlloc_Impl(uint32 sock_id, void **buffer, uint32 size, int32 timeout)
+{
+   TickType_t ticks;
+
+   OS_FREERTOS_API_ENTER(SocketBufferAlloc);
+
+   ticks = (timeout == OS_CHECK) ? 0 : OS_Socket_Ticks(timeout);
+
+   *buffer = FreeRTOS_GetUDPPayloadBuffer(size, ticks);
+   if (*buffer == NULL)
+   {
+      return OS_FREERTOS_API_EXIT(SocketBufferAlloc, OS_ERROR_TIMEOUT);
+   }
+
+   return OS_FREERTOS_API_EXIT(SocketBufferAlloc, OS_SUCCESS);
+} /* end OS_SocketBufferAlloc_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketSendToBuffer_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketSendToBuffer_Impl(uint32 sock_id, void *buffer, uint32 size, const OS_SockAddr_t *RemoteAddr)
+{
+   OS_FREERTOS_API_ENTER(SocketSendToBuffer);
+
+   /* With FREERTOS_ZERO_COPY the stack takes the buffer itself, unless the send fails */
+   return OS_FREERTOS_API_EXIT(SocketSendToBuffer, OS_Socket_SendTo(sock_id, buffer, size, RemoteAddr, FREERTOS_ZERO_COPY));
+} /* end OS_SocketSendToBuffer_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketRecvFromBuffer_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketRecvFromBuffer_Impl(uint32 sock_id, void **buffer, OS_SockAddr_t *RemoteAddr, int32 timeout)
+{
+   OS_FREERTOS_API_ENTER(SocketRecvFromBuffer);
+
+   /* With FREERTOS_ZERO_COPY the buffer argument receives a pointer to the payload */
+   *buffer = NULL;
+   return OS_FREERTOS_API_EXIT(SocketRecvFromBuffer, OS_Socket_RecvFrom(sock_id, buffer, 0, RemoteAddr, timeout, FREERTOS_ZERO_COPY));
+} /* end OS_SocketRecvFromBuffer_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketBufferRelease_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketBufferRelease_Impl(uint32 sock_id, void *buffer)
+{
+   OS_FREERTOS_API_ENTER(SocketBufferRelease);
+
+   FreeRTOS_ReleaseUDPPayloadBuffer(buffer);
+
+   return OS_FREERTOS_API_EXIT(SocketBufferRelease, OS_SUCCESS);
+} /* end OS_SocketBufferRelease_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketRecvFromBatch_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketRecvFromBatch_Impl(uint32 sock_id, OS_socket_msg_t *msgs, uint32 count, uint32 *count_received, int32 timeout)
+{
+   int32 return_code;
+   uint32 i;
+
+   OS_FREERTOS_API_ENTER(SocketRecvFromBatch);
+
+   return_code = OS_SUCCESS;
+   for (i = 0; i < count; ++i)
+   {
+      /* Only the first datagram is waited for, the rest must already be queued */
+      return_code = OS_Socket_RecvFrom(sock_id, msgs[i].buffer, msgs[i].size, &msgs[i].addr,
+                                       (i == 0) ? timeout : OS_CHECK, 0);
+      if (return_code < 0)
+      {
+         break;
+      }
+
+      msgs[i].size = (uint32) return_code;
+   }
+
+   *count_received = i;
+
+   if (i > 0)
+   {
+      return_code = OS_SUCCESS;
+   }
+
+   return OS_FREERTOS_API_EXIT(SocketRecvFromBatch, return_code);
+} /* end OS_SocketRecvFromBatch_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketSendToBatch_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketSendToBatch_Impl(uint32 sock_id, const OS_socket_msg_t *msgs, uint32 count, uint32 *count_sent)
+{
+   int32 return_code;
+   uint32 i;
+
+   OS_FREERTOS_API_ENTER(SocketSendToBatch);
+
+   return_code = OS_SUCCESS;
+   for (i = 0; i < count; ++i)
+   {
+      return_code = OS_Socket_SendTo(sock_id, msgs[i].buffer, msgs[i].size, &msgs[i].addr, 0);
+      if (return_code < 0)
+      {
+         break;
+      }
+   }
+
+   *count_sent = i;
+
+   if (i == count)
+   {
+      return_code = OS_SUCCESS;
+   }
+
+   return OS_FREERTOS_API_EXIT(SocketSendToBatch, return_code);
+} /* end OS_SocketSendToBatch_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketSetOption_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketSetOption_Impl(uint32 sock_id, uint32 option, const void *value, uint32 size)
+{
+   Socket_t fd;
+   BaseType_t os_result;
+   BaseType_t int_value;
+   TickType_t ticks;
+   WinProperties_t win;
+   const OS_socket_window_t *window;
+   bool is_stream;
+
+   OS_FREERTOS_API_ENTER(SocketSetOption);
+
+   fd = OS_impl_filehandle_fd[sock_id];
+   is_stream = (OS_stream_table[sock_id].socket_type == OS_SocketType_STREAM);
+
+   if (option == OS_SOCKET_OPT_WINDOW)
+   {
+      if (size != sizeof(OS_socket_window_t))
+      {
+         return OS_FREERTOS_API_EXIT(SocketSetOption, OS_ERROR);
+      }
+   }
+   else if (size != sizeof(uint32))
+   {
+      return OS_FREERTOS_API_EXIT(SocketSetOption, OS_ERROR);
+   }
+
+   switch (option)
+   {
+   case OS_SOCKET_OPT_RCVBUF:
+   case OS_SOCKET_OPT_SNDBUF:
+      /* FreeRTOS+TCP keeps stream buffers per TCP socket, UDP sockets only queue whole packets */
+      if (!is_stream)
+      {
+         return OS_FREERTOS_API_EXIT(SocketSetOption, OS_ERR_NOT_IMPLEMENTED);
+      }
+      int_value = (BaseType_t) *(const uint32 *)value;
+      os_result = FreeRTOS_setsockopt(fd, 0, (option == OS_SOCKET_OPT_RCVBUF) ? FREERTOS_SO_RCVBUF : FREERTOS_SO_SNDBUF,
+                                      &int_value, sizeof(int_value));
+      break;
+
+   case OS_SOCKET_OPT_WINDOW:
+      if (!is_stream)
+      {
+         return OS_FREERTOS_API_EXIT(SocketSetOption, OS_ERR_NOT_IMPLEMENTED);
+      }
+      window = (const OS_socket_window_t *)value;
+      win.lTxBufSize = (int32_t) window->tx_buffer_size;
+      win.lTxWinSize = (int32_t) window->tx_window_size;
+      win.lRxBufSize = (int32_t) window->rx_buffer_size;
+      win.lRxWinSize = (int32_t) window->rx_window_size;
+      os_result = FreeRTOS_setsockopt(fd, 0, FREERTOS_SO_WIN_PROPERTIES, &win, sizeof(win));
+      break;
+
+   case OS_SOCKET_OPT_BACKLOG:
+      if (!is_stream)
+      {
+         return OS_FREERTOS_API_EXIT(SocketSetOption, OS_ERR_NOT_IMPLEMENTED);
+      }
+      /*
+       * Binding a stream socket starts it listening, see OS_SocketBind_Impl,
+       * and FreeRTOS+TCP will not listen again on a listening socket.  So the
+       * backlog is only taken before the bind, which uses it.
+       */
+      if (OS_stream_table[sock_id].stream_state & (OS_STREAM_STATE_BOUND | OS_STREAM_STATE_CONNECTED))
+      {
+         return OS_FREERTOS_API_EXIT(SocketSetOption, OS_ERR_INCORRECT_OBJ_STATE);
+      }
+      OS_impl_filehandle_table[sock_id].listen_backlog = *(const uint32 *)value;
+      os_result = 0;
+      break;
+
+   case OS_SOCKET_OPT_NODELAY:
+      if (!is_stream)
+      {
+         return OS_FREERTOS_API_EXIT(SocketSetOption, OS_ERR_NOT_IMPLEMENTED);
+      }
+      /* There is no Nagle algorithm in FreeRTOS+TCP, the closest is not holding back partial segments */
+      int_value = (*(const uint32 *)value == 0) ? pdTRUE : pdFALSE;
+      os_result = FreeRTOS_setsockopt(fd, 0, FREERTOS_SO_SET_FULL_SIZE, &int_value, sizeof(int_value));
+      break;
+
+   case OS_SOCKET_OPT_SNDTIMEO:
+      ticks = OS_Socket_Ticks((int32) *(const uint32 *)value);
+      os_result = FreeRTOS_setsockopt(fd, 0, FREERTOS_SO_SNDTIMEO, &ticks, sizeof(ticks));
+      break;
+
+   default:
+      return OS_FREERTOS_API_EXIT(SocketSetOption, OS_ERR_NOT_IMPLEMENTED);
+   }
+
+   if (os_result != 0)
+   {
+      return OS_FREERTOS_API_EXIT(SocketSetOption, OS_ERROR);
+   }
+
+   return OS_FREERTOS_API_EXIT(SocketSetOption, OS_SUCCESS);
+} /* end OS_SocketSetOption_Impl */
+
 /*----------------------------------------------------------------
  *
  * Function: OS_SocketGetInfo_Impl
@@ -445,6 +890,8 @@ int32 OS_SocketAddrInit_Impl(OS_SockAddr_t *Addr, OS_SocketDomain_t Domain)
    socklen_t addrlen;
    OS_freertos_sockaddr_Accessor_t *Accessor;
 
+   OS_FREERTOS_API_ENTER(SocketAddrInit);
+
    memset(Addr, 0, sizeof(OS_SockAddr_t));
    Accessor = (OS_freertos_sockaddr_Accessor_t *)Addr->AddrData;
 
@@ -461,13 +908,13 @@ int32 OS_SocketAddrInit_Impl(OS_SockAddr_t *Addr, OS_SocketDomain_t Domain)
 
    if (addrlen == 0 || addrlen > OS_SOCKADDR_MAX_LEN)
    {
-      return OS_ERR_NOT_IMPLEMENTED;
+      return OS_FREERTOS_API_EXIT(SocketAddrInit, OS_ERR_NOT_IMPLEMENTED);
    }
 
    Addr->ActualLength = addrlen;
    Accessor->freertos_sockaddr.sin_family = sin_family;
 
-   return OS_SUCCESS;
+   return OS_FREERTOS_API_EXIT(SocketAddrInit, OS_SUCCESS);
 } /* end OS_SocketAddrInit_Impl */
 
 /*----------------------------------------------------------------
@@ -482,6 +929,8 @@ int32 OS_SocketAddrToString_Impl(char *buffer, uint32 buflen, const OS_SockAddr_
 {
    const OS_freertos_sockaddr_Accessor_t *Accessor;
 
+   OS_FREERTOS_API_ENTER(SocketAddrToString);
+
    Accessor = (const OS_freertos_sockaddr_Accessor_t *)Addr->AddrData;
 
    switch(Accessor->freertos_sockaddr.sin_family)
@@ -489,13 +938,13 @@ int32 OS_SocketAddrToString_Impl(char *buffer, uint32 buflen, const OS_SockAddr_
    case FREERTOS_AF_INET:
       break;
    default:
-      return OS_ERR_BAD_ADDRESS;
+      return OS_FREERTOS_API_EXIT(SocketAddrToString, OS_ERR_BAD_ADDRESS);
       break;
    }
 
    FreeRTOS_inet_ntoa(Accessor->freertos_sockaddr.sin_addr, buffer);
 
-   return OS_SUCCESS;
+   return OS_FREERTOS_API_EXIT(SocketAddrToString, OS_SUCCESS);
 } /* end OS_SocketAddrToString_Impl */
 
 /*----------------------------------------------------------------
@@ -510,6 +959,8 @@ int32 OS_SocketAddrFromString_Impl(OS_SockAddr_t *Addr, const char *string)
 {
    OS_freertos_sockaddr_Accessor_t *Accessor;
 
+   OS_FREERTOS_API_ENTER(SocketAddrFromString);
+
    Accessor = (OS_freertos_sockaddr_Accessor_t *)Addr->AddrData;
 
    switch(Accessor->freertos_sockaddr.sin_family)
@@ -517,7 +968,7 @@ int32 OS_SocketAddrFromString_Impl(OS_SockAddr_t *Addr, const char *string)
    case FREERTOS_AF_INET:
       break;
    default:
-      return OS_ERR_BAD_ADDRESS;
+      return OS_FREERTOS_API_EXIT(SocketAddrFromString, OS_ERR_BAD_ADDRESS);
       break;
    }
 
@@ -525,10 +976,10 @@ int32 OS_SocketAddrFromString_Impl(OS_SockAddr_t *Addr, const char *string)
 
    if(Accessor->freertos_sockaddr.sin_addr == 0)
    {
-	  return OS_ERROR;
+	  return OS_FREERTOS_API_EXIT(SocketAddrFromString, OS_ERROR);
    }
 
-   return OS_SUCCESS;
+   return OS_FREERTOS_API_EXIT(SocketAddrFromString, OS_SUCCESS);
 } /* end OS_SocketAddrFromString_Impl */
 
 /*----------------------------------------------------------------
@@ -544,6 +995,8 @@ int32 OS_SocketAddrGetPort_Impl(uint16 *PortNum, const OS_SockAddr_t *Addr)
    uint16 sa_port;
    const OS_freertos_sockaddr_Accessor_t *Accessor;
 
+   OS_FREERTOS_API_ENTER(SocketAddrGetPort);
+
    Accessor = (const OS_freertos_sockaddr_Accessor_t *)Addr->AddrData;
 
    switch(Accessor->freertos_sockaddr.sin_family)
@@ -552,13 +1005,13 @@ int32 OS_SocketAddrGetPort_Impl(uint16 *PortNum, const OS_SockAddr_t *Addr)
       sa_port = Accessor->freertos_sockaddr.sin_port;
       break;
    default:
-      return OS_ERR_BAD_ADDRESS;
+      return OS_FREERTOS_API_EXIT(SocketAddrGetPort, OS_ERR_BAD_ADDRESS);
       break;
    }
 
    *PortNum = FreeRTOS_ntohs(sa_port);
 
-   return OS_SUCCESS;
+   return OS_FREERTOS_API_EXIT(SocketAddrGetPort, OS_SUCCESS);
 } /* end OS_SocketAddrGetPort_Impl */
 
 /*----------------------------------------------------------------
@@ -574,6 +1027,8 @@ int32 OS_SocketAddrSetPort_Impl(OS_SockAddr_t *Addr, uint16 PortNum)
    uint16 sa_port;
    OS_freertos_sockaddr_Accessor_t *Accessor;
 
+   OS_FREERTOS_API_ENTER(SocketAddrSetPort);
+
    sa_port = FreeRTOS_htons(PortNum);
    Accessor = (OS_freertos_sockaddr_Accessor_t *)Addr->AddrData;
 
@@ -583,10 +1038,265 @@ int32 OS_SocketAddrSetPort_Impl(OS_SockAddr_t *Addr, uint16 PortNum)
       Accessor->freertos_sockaddr.sin_port = sa_port;
       break;
    default:
-      return OS_ERR_BAD_ADDRESS;
+      return OS_FREERTOS_API_EXIT(SocketAddrSetPort, OS_ERR_BAD_ADDRESS);
    }
 
-   return OS_SUCCESS;
+   return OS_FREERTOS_API_EXIT(SocketAddrSetPort, OS_SUCCESS);
 } /* end OS_SocketAddrSetPort_Impl */
 
+/****************************************************************************************
+ SOCKET EXTENSION API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Socket_AcquireDatagram
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Looks up a datagram socket for the extension API and takes a
+ *           reference to it, like the shared layer's OS_read, so no table
+ *           lock is held while the call blocks.  On success the caller
+ *           drops the reference with OS_ObjectIdRefcountDecr when done.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Socket_AcquireDatagram(uint32 sock_id, uint32 *local_id, OS_common_record_t **record)
+{
+   int32 return_code;
+
+   return_code = OS_ObjectIdGetById(OS_LOCK_MODE_REFCOUNT, OS_OBJECT_TYPE_OS_STREAM, sock_id, local_id, record);
+   if (return_code == OS_SUCCESS && OS_stream_table[*local_id].socket_type != OS_SocketType_DATAGRAM)
+   {
+      OS_ObjectIdRefcountDecr(*record);
+      return_code = OS_ERR_INCORRECT_OBJ_STATE;
+   }
+
+   return return_code;
+} /* end OS_Socket_AcquireDatagram */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketBufferAlloc
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketBufferAlloc(uint32 sock_id, void **buffer, uint32 size, int32 timeout)
+{
+   OS_common_record_t *record;
+   uint32 local_id;
+   int32 return_code;
+
+   if (buffer == NULL)
+   {
+      return OS_INVALID_POINTER;
+   }
+
+   *buffer = NULL;
+
+   return_code = OS_Socket_AcquireDatagram(sock_id, &local_id, &record);
+   if (return_code == OS_SUCCESS)
+   {
+      return_code = OS_SocketBufferAlloc_Impl(local_id, buffer, size, timeout);
+      OS_ObjectIdRefcountDecr(record);
+   }
+
+   return return_code;
+} /* end OS_SocketBufferAlloc */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketSendToBuffer
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketSendToBuffer(uint32 sock_id, void *buffer, uint32 size, const OS_SockAddr_t *RemoteAddr)
+{
+   OS_common_record_t *record;
+   uint32 local_id;
+   int32 return_code;
+
+   if (buffer == NULL || RemoteAddr == NULL)
+   {
+      return OS_INVALID_POINTER;
+   }
+
+   return_code = OS_Socket_AcquireDatagram(sock_id, &local_id, &record);
+   if (return_code == OS_SUCCESS)
+   {
+      return_code = OS_SocketSendToBuffer_Impl(local_id, buffer, size, RemoteAddr);
+      OS_ObjectIdRefcountDecr(record);
+   }
+
+   return return_code;
+} /* end OS_SocketSendToBuffer */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketRecvFromBuffer
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketRecvFromBuffer(uint32 sock_id, void **buffer, OS_SockAddr_t *RemoteAddr, int32 timeout)
+{
+   OS_common_record_t *record;
+   uint32 local_id;
+   int32 return_code;
+
+   if (buffer == NULL)
+   {
+      return OS_INVALID_POINTER;
+   }
+
+   *buffer = NULL;
+
+   return_code = OS_Socket_AcquireDatagram(sock_id, &local_id, &record);
+   if (return_code == OS_SUCCESS)
+   {
+      return_code = OS_SocketRecvFromBuffer_Impl(local_id, buffer, RemoteAddr, timeout);
+      OS_ObjectIdRefcountDecr(record);
+   }
+
+   return return_code;
+} /* end OS_SocketRecvFromBuffer */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketBufferRelease
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketBufferRelease(uint32 sock_id, void *buffer)
+{
+   OS_common_record_t *record;
+   uint32 local_id;
+   int32 return_code;
+
+   if (buffer == NULL)
+   {
+      return OS_INVALID_POINTER;
+   }
+
+   return_code = OS_Socket_AcquireDatagram(sock_id, &local_id, &record);
+   if (return_code == OS_SUCCESS)
+   {
+      return_code = OS_SocketBufferRelease_Impl(local_id, buffer);
+      OS_ObjectIdRefcountDecr(record);
+   }
+
+   return return_code;
+} /* end OS_SocketBufferRelease */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketRecvFromBatch
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketRecvFromBatch(uint32 sock_id, OS_socket_msg_t *msgs, uint32 count, uint32 *count_received, int32 timeout)
+{
+   OS_common_record_t *record;
+   uint32 local_id;
+   int32 return_code;
+
+   if (msgs == NULL || count_received == NULL)
+   {
+      return OS_INVALID_POINTER;
+   }
+
+   *count_received = 0;
+
+   return_code = OS_Socket_AcquireDatagram(sock_id, &local_id, &record);
+   if (return_code == OS_SUCCESS)
+   {
+      return_code = OS_SocketRecvFromBatch_Impl(local_id, msgs, count, count_received, timeout);
+      OS_ObjectIdRefcountDecr(record);
+   }
+
+   return return_code;
+} /* end OS_SocketRecvFromBatch */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketSendToBatch
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketSendToBatch(uint32 sock_id, const OS_socket_msg_t *msgs, uint32 count, uint32 *count_sent)
+{
+   OS_common_record_t *record;
+   uint32 local_id;
+   int32 return_code;
+
+   if (msgs == NULL || count_sent == NULL)
+   {
+      return OS_INVALID_POINTER;
+   }
+
+   *count_sent = 0;
+
+   return_code = OS_Socket_AcquireDatagram(sock_id, &local_id, &record);
+   if (return_code == OS_SUCCESS)
+   {
+      return_code = OS_SocketSendToBatch_Impl(local_id, msgs, count, count_sent);
+      OS_ObjectIdRefcountDecr(record);
+   }
+
+   return return_code;
+} /* end OS_SocketSendToBatch */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_SocketSetOption
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_SocketSetOption(uint32 sock_id, uint32 option, const void *value, uint32 size)
+{
+   OS_common_record_t *record;
+   uint32 local_id;
+   int32 return_code;
+
+   if (value == NULL)
+   {
+      return OS_INVALID_POINTER;
+   }
+
+   return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_STREAM);
+   if (return_code != OS_SUCCESS)
+   {
+      return return_code;
+   }
+
+   return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_STREAM, sock_id, &local_id, &record);
+   if (return_code == OS_SUCCESS)
+   {
+      if (OS_stream_table[local_id].socket_type == OS_SocketType_INVALID)
+      {
+         /* Not a socket */
+         return_code = OS_ERR_INCORRECT_OBJ_STATE;
+      }
+      else
+      {
+         return_code = OS_SocketSetOption_Impl(local_id, option, value, size);
+      }
+   }
+
+   OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_STREAM);
+
+   return return_code;
+} /* end OS_SocketSetOption */
+
 #endif
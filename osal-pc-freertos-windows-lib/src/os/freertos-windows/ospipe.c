@@ -0,0 +1,729 @@
+/*
+ *  NASA Docket No. GSC-18,370-1, and identified as "Operating System Abstraction Layer"
+ *
+ *  Copyright (c) 2019 United States Government as represented by
+ *  the Administrator of the National Aeronautics and Space Administration.
+ *  All Rights Reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * \file   ospipe.c
+ *
+ * Purpose: This file contains the byte stream pipes, see OS_PipeCreate
+ */
+
+/****************************************************************************************
+ INCLUDE FILES
+ ***************************************************************************************/
+
+#include <string.h>
+
+#include "os-FreeRTOS.h"
+#include "stream_buffer.h"
+
+/****************************************************************************************
+ DEFINES
+ ***************************************************************************************/
+
+/* The select masks hold one bit per pipe table entry in a uint32 */
+#if OS_FREERTOS_MAX_PIPES > 32
+#error OS_FREERTOS_MAX_PIPES must be at most 32
+#endif
+
+/****************************************************************************************
+ GLOBAL DATA
+ ***************************************************************************************/
+
+/*
+ * A pipe.  The bytes are held in a FreeRTOS stream buffer, which is only safe
+ * with one reader and one writer at a time, so each side has its own lock.
+ * A reader and a writer never wait for each other's lock.  The shared layer
+ * does not lock pipe streams, so OS_Pipe_Close takes both locks itself
+ * before it deletes the buffer.
+ *
+ * A pipe is an OSAL stream: local_id is its entry in the stream table, whose
+ * fd points back here.
+ */
+typedef struct
+{
+	volatile bool        in_use;
+	volatile bool        closed;		/* set by OS_Pipe_Close before it tears the pipe down */
+	uint32               local_id;
+	StreamBufferHandle_t buffer;
+	uint32               size;
+	uint32               trigger_level;
+	SemaphoreHandle_t    read_lock;
+	SemaphoreHandle_t    write_lock;
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	StaticStreamBuffer_t buffer_cb;
+	StaticSemaphore_t    read_lock_cb;
+	StaticSemaphore_t    write_lock_cb;
+	uint8                storage[OS_FREERTOS_PIPE_STATIC_MAX_SIZE + 1];
+#endif
+} OS_impl_pipe_t;
+
+/*
+ * A task selecting on pipes.  The node lives on the waiting task's stack and
+ * names the pipes it waits for as a bit mask of pipe table indexes.  A read or
+ * write on one of them notifies the task, which then checks the pipes again.
+ */
+typedef struct OS_impl_pipe_waiter
+{
+	TaskHandle_t               task;
+	uint32                     mask;
+	struct OS_impl_pipe_waiter *next;
+} OS_impl_pipe_waiter_t;
+
+static OS_impl_pipe_t         OS_impl_pipe_table[OS_FREERTOS_MAX_PIPES];
+static OS_impl_pipe_waiter_t *OS_impl_pipe_waiters;
+
+/****************************************************************************************
+ HELPER FUNCTIONS
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Pipe_Ticks
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Converts an OSAL stream timeout (OS_PEND, OS_CHECK or msecs)
+ *           into a FreeRTOS block time.
+ *
+ *-----------------------------------------------------------------*/
+static TickType_t OS_Pipe_Ticks(int32 timeout)
+{
+	if(timeout < 0)
+	{
+		return portMAX_DELAY;
+	}
+	else if(timeout == 0)
+	{
+		return 0;
+	}
+
+	return OS_Milli2Ticks(timeout);
+} /* end OS_Pipe_Ticks */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Pipe_Wake
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Notifies the tasks selecting on a pipe that its state changed.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Pipe_Wake(const OS_impl_pipe_t *pipe)
+{
+	OS_impl_pipe_waiter_t *waiter;
+	uint32 bit = 1UL << (pipe - OS_impl_pipe_table);
+
+	taskENTER_CRITICAL();
+	for(waiter = OS_impl_pipe_waiters; waiter != NULL; waiter = waiter->next)
+	{
+		if(waiter->mask & bit)
+		{
+			xTaskNotifyGive(waiter->task);
+		}
+	}
+	taskEXIT_CRITICAL();
+} /* end OS_Pipe_Wake */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Pipe_Poll
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Returns the pipes of a mask that are readable (at least the
+ *           trigger level buffered) or writable (any room), as a mask.
+ *           A pipe closed meanwhile counts as ready, so the select
+ *           returns and the next transfer reports the error.  The buffer
+ *           is only looked at in a critical section with closed clear,
+ *           OS_Pipe_Close sets closed before it deletes the buffer, and
+ *           a pipe still being created has none yet.
+ *
+ *-----------------------------------------------------------------*/
+static uint32 OS_Pipe_Poll(uint32 read_mask, uint32 write_mask, uint32 *ready_read, uint32 *ready_write)
+{
+	OS_impl_pipe_t *pipe;
+	uint32 mask;
+	uint32 i;
+
+	*ready_read = 0;
+	*ready_write = 0;
+
+	for(mask = read_mask; mask != 0; mask &= mask - 1)
+	{
+		i = __builtin_ctz(mask);
+		pipe = &OS_impl_pipe_table[i];
+		taskENTER_CRITICAL();
+		if(!pipe->in_use || pipe->closed || pipe->buffer == NULL ||
+		   xStreamBufferBytesAvailable(pipe->buffer) >= pipe->trigger_level)
+		{
+			*ready_read |= 1UL << i;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+	for(mask = write_mask; mask != 0; mask &= mask - 1)
+	{
+		i = __builtin_ctz(mask);
+		pipe = &OS_impl_pipe_table[i];
+		taskENTER_CRITICAL();
+		if(!pipe->in_use || pipe->closed || pipe->buffer == NULL ||
+		   xStreamBufferSpacesAvailable(pipe->buffer) != 0)
+		{
+			*ready_write |= 1UL << i;
+		}
+		taskEXIT_CRITICAL();
+	}
+
+	return *ready_read | *ready_write;
+} /* end OS_Pipe_Poll */
+
+/****************************************************************************************
+ PIPE STREAM OPERATIONS
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Pipe_Read
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Read operation of pipe streams.  Returns as soon as any bytes
+ *           are buffered; a reader that has to wait is woken once the
+ *           trigger level is reached.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Pipe_Read(uint32 local_id, void *buffer, uint32 nbytes, int32 timeout)
+{
+	OS_impl_pipe_t *pipe = (OS_impl_pipe_t *) OS_impl_filehandle_fd[local_id];
+	TimeOut_t time_out;
+	TickType_t ticks;
+	size_t got = 0;
+
+	ticks = OS_Pipe_Ticks(timeout);
+	vTaskSetTimeOutState(&time_out);
+
+	if(xSemaphoreTake(pipe->read_lock, ticks) != pdTRUE)
+	{
+		return OS_ERROR_TIMEOUT;
+	}
+
+	/* Leaves ticks at what remains of the timeout after waiting for the lock */
+	(void) xTaskCheckForTimeOut(&time_out, &ticks);
+	while(!pipe->closed)
+	{
+		/*
+		 ** A notification left over from a select can end the kernel's wait
+		 ** with nothing read, and OS_Pipe_Close aborts the wait.
+		 */
+		got = xStreamBufferReceive(pipe->buffer, buffer, nbytes, ticks);
+		if(got != 0 || xTaskCheckForTimeOut(&time_out, &ticks) != pdFALSE)
+		{
+			break;
+		}
+	}
+	xSemaphoreGive(pipe->read_lock);
+
+	if(got == 0)
+	{
+		return pipe->closed ? OS_ERROR : OS_ERROR_TIMEOUT;
+	}
+
+	OS_Pipe_Wake(pipe);
+
+	return (int32) got;
+} /* end OS_Pipe_Read */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Pipe_Write
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Write operation of pipe streams.  Fills whatever room there
+ *           is and waits for more until every byte is written or the
+ *           timeout expires, so a write larger than the pipe streams
+ *           through it as the reader drains it.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Pipe_Write(uint32 local_id, const void *buffer, uint32 nbytes, int32 timeout)
+{
+	OS_impl_pipe_t *pipe = (OS_impl_pipe_t *) OS_impl_filehandle_fd[local_id];
+	const uint8 *data = (const uint8 *) buffer;
+	TimeOut_t time_out;
+	TickType_t ticks;
+	size_t room;
+	size_t sent;
+	bool timed_out;
+	uint32 total = 0;
+
+	ticks = OS_Pipe_Ticks(timeout);
+	vTaskSetTimeOutState(&time_out);
+
+	if(xSemaphoreTake(pipe->write_lock, ticks) != pdTRUE)
+	{
+		return OS_ERROR_TIMEOUT;
+	}
+
+	(void) xTaskCheckForTimeOut(&time_out, &ticks);
+	while(!pipe->closed)
+	{
+		/*
+		 ** The kernel waits until the whole request fits, so only ask it
+		 ** to wait for one byte when the pipe is full.  OS_Pipe_Close
+		 ** aborts the wait.
+		 */
+		room = xStreamBufferSpacesAvailable(pipe->buffer);
+		if(room == 0)
+		{
+			sent = xStreamBufferSend(pipe->buffer, &data[total], 1, ticks);
+		}
+		else
+		{
+			sent = xStreamBufferSend(pipe->buffer, &data[total],
+					(nbytes - total < room) ? nbytes - total : room, 0);
+		}
+
+		total += (uint32) sent;
+		if(sent != 0 && xStreamBufferBytesAvailable(pipe->buffer) >= pipe->trigger_level)
+		{
+			OS_Pipe_Wake(pipe);
+		}
+
+		/* Keeps ticks at what remains, the write only gives up when nothing more fits in time */
+		timed_out = (xTaskCheckForTimeOut(&time_out, &ticks) != pdFALSE);
+		if(total == nbytes || (sent == 0 && timed_out))
+		{
+			break;
+		}
+	}
+	xSemaphoreGive(pipe->write_lock);
+
+	if(total == 0)
+	{
+		return pipe->closed ? OS_ERROR : OS_ERROR_TIMEOUT;
+	}
+
+	return (int32) total;
+} /* end OS_Pipe_Write */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Pipe_CloseLock
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes one side's lock for OS_Pipe_Close.  A holder blocked in
+ *           the stream buffer has its wait aborted, then finds the pipe
+ *           closed and lets go.  Tasks queued for the lock do the same
+ *           once they get it.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Pipe_CloseLock(SemaphoreHandle_t lock)
+{
+	TaskHandle_t holder;
+
+	while(xSemaphoreTake(lock, 0) != pdTRUE)
+	{
+		holder = xSemaphoreGetMutexHolder(lock);
+		if(holder != NULL)
+		{
+			xTaskAbortDelay(holder);
+		}
+		vTaskDelay(1);
+	}
+} /* end OS_Pipe_CloseLock */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Pipe_Close
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Bytes still buffered are discarded.  A transfer in progress
+ *           returns OS_ERROR, and a select on the pipe returns.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_Pipe_Close(uint32 local_id)
+{
+	OS_impl_pipe_t *pipe = (OS_impl_pipe_t *) OS_impl_filehandle_fd[local_id];
+	StreamBufferHandle_t buffer;
+
+	taskENTER_CRITICAL();
+	pipe->closed = true;
+	taskEXIT_CRITICAL();
+
+	OS_Pipe_Wake(pipe);
+
+	OS_Pipe_CloseLock(pipe->read_lock);
+	OS_Pipe_CloseLock(pipe->write_lock);
+
+	taskENTER_CRITICAL();
+	buffer = pipe->buffer;
+	pipe->buffer = NULL;
+	taskEXIT_CRITICAL();
+
+	vStreamBufferDelete(buffer);
+
+	/* The locks are left free for the next pipe in this slot */
+	xSemaphoreGive(pipe->write_lock);
+	xSemaphoreGive(pipe->read_lock);
+
+	taskENTER_CRITICAL();
+	pipe->in_use = false;
+	taskEXIT_CRITICAL();
+
+	return OS_SUCCESS;
+} /* end OS_Pipe_Close */
+
+const OS_FreeRTOS_stream_ops_t OS_FreeRTOS_PipeStreamOps =
+{
+	.Read = OS_Pipe_Read,
+	.Write = OS_Pipe_Write,
+	.Seek = NULL,
+	.Close = OS_Pipe_Close,
+	.Sync = NULL
+};
+
+/****************************************************************************************
+ PIPE SELECT
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_PipeSetMask
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+uint32 OS_FreeRTOS_PipeSetMask(const OS_FdSet *set)
+{
+	uint32 mask = 0;
+	uint32 id;
+	uint32 i;
+
+	if(set == NULL)
+	{
+		return 0;
+	}
+
+	for(i = 0; i < OS_FREERTOS_MAX_PIPES; i++)
+	{
+		id = OS_impl_pipe_table[i].local_id;
+		if(OS_impl_pipe_table[i].in_use && (set->object_ids[id / 8] & (1 << (id % 8))) != 0)
+		{
+			mask |= 1UL << i;
+		}
+	}
+
+	return mask;
+} /* end OS_FreeRTOS_PipeSetMask */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_PipeSetUpdate
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_PipeSetUpdate(OS_FdSet *set, uint32 mask, uint32 ready)
+{
+	uint32 id;
+
+	for(mask &= ~ready; mask != 0; mask &= mask - 1)
+	{
+		id = OS_impl_pipe_table[__builtin_ctz(mask)].local_id;
+		set->object_ids[id / 8] &= ~(1 << (id % 8));
+	}
+} /* end OS_FreeRTOS_PipeSetUpdate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_PipeWait
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *           The waiter is registered before the pipes are checked, so a
+ *           transfer between the check and the wait still notifies it.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FreeRTOS_PipeWait(uint32 read_mask, uint32 write_mask, uint32 *ready_read, uint32 *ready_write, TickType_t ticks)
+{
+	OS_impl_pipe_waiter_t self;
+	OS_impl_pipe_waiter_t **prev;
+	TimeOut_t time_out;
+
+	if(OS_Pipe_Poll(read_mask, write_mask, ready_read, ready_write) != 0)
+	{
+		return OS_SUCCESS;
+	}
+
+	if(ticks == 0)
+	{
+		return OS_ERROR_TIMEOUT;
+	}
+
+	vTaskSetTimeOutState(&time_out);
+
+	self.task = xTaskGetCurrentTaskHandle();
+	self.mask = read_mask | write_mask;
+	taskENTER_CRITICAL();
+	self.next = OS_impl_pipe_waiters;
+	OS_impl_pipe_waiters = &self;
+	taskEXIT_CRITICAL();
+
+	while(OS_Pipe_Poll(read_mask, write_mask, ready_read, ready_write) == 0 &&
+	      xTaskCheckForTimeOut(&time_out, &ticks) == pdFALSE)
+	{
+		ulTaskNotifyTake(pdTRUE, ticks);
+	}
+
+	taskENTER_CRITICAL();
+	for(prev = &OS_impl_pipe_waiters; *prev != &self; prev = &(*prev)->next)
+	{
+	}
+	*prev = self.next;
+	taskEXIT_CRITICAL();
+
+	/* Drop a notification that arrived after the last check */
+	ulTaskNotifyTake(pdTRUE, 0);
+
+	return ((*ready_read | *ready_write) != 0) ? OS_SUCCESS : OS_ERROR_TIMEOUT;
+} /* end OS_FreeRTOS_PipeWait */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_PipeSelectSingle
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FreeRTOS_PipeSelectSingle(uint32 local_id, uint32 *SelectFlags, TickType_t ticks)
+{
+	OS_impl_pipe_t *pipe = (OS_impl_pipe_t *) OS_impl_filehandle_fd[local_id];
+	uint32 bit = 1UL << (pipe - OS_impl_pipe_table);
+	uint32 ready_read;
+	uint32 ready_write;
+	int32 return_code;
+
+	if(*SelectFlags == 0)
+	{
+		/* Nothing to check for, return immediately. */
+		return OS_SUCCESS;
+	}
+
+	return_code = OS_FreeRTOS_PipeWait((*SelectFlags & OS_STREAM_STATE_READABLE) ? bit : 0,
+			(*SelectFlags & OS_STREAM_STATE_WRITABLE) ? bit : 0, &ready_read, &ready_write, ticks);
+
+	if(ready_read == 0)
+	{
+		*SelectFlags &= ~OS_STREAM_STATE_READABLE;
+	}
+	if(ready_write == 0)
+	{
+		*SelectFlags &= ~OS_STREAM_STATE_WRITABLE;
+	}
+
+	return return_code;
+} /* end OS_FreeRTOS_PipeSelectSingle */
+
+/****************************************************************************************
+ PIPE EXTENSION API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_PipeAPI_Impl_Init
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FreeRTOS_PipeAPI_Impl_Init(void)
+{
+	uint32 i;
+
+	memset(OS_impl_pipe_table, 0, sizeof(OS_impl_pipe_table));
+	OS_impl_pipe_waiters = NULL;
+
+	for(i = 0; i < OS_FREERTOS_MAX_PIPES; i++)
+	{
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+		OS_impl_pipe_table[i].read_lock = xSemaphoreCreateMutexStatic(&OS_impl_pipe_table[i].read_lock_cb);
+		OS_impl_pipe_table[i].write_lock = xSemaphoreCreateMutexStatic(&OS_impl_pipe_table[i].write_lock_cb);
+#else
+		OS_impl_pipe_table[i].read_lock = xSemaphoreCreateMutex();
+		OS_impl_pipe_table[i].write_lock = xSemaphoreCreateMutex();
+#endif
+		if(OS_impl_pipe_table[i].read_lock == NULL || OS_impl_pipe_table[i].write_lock == NULL)
+		{
+			return OS_ERROR;
+		}
+	}
+
+	return OS_SUCCESS;
+} /* end OS_FreeRTOS_PipeAPI_Impl_Init */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_PipeCreate
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_PipeCreate(uint32 *pipe_id, const char *pipe_name, uint32 size, uint32 trigger_level)
+{
+	OS_common_record_t *record;
+	OS_impl_pipe_t *pipe;
+	uint32 local_id;
+	uint32 heap_category;
+	uint32 i;
+	int32 return_code;
+
+	if(pipe_id == NULL || pipe_name == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	if(strlen(pipe_name) >= OS_MAX_PATH_LEN)
+	{
+		return OS_ERR_NAME_TOO_LONG;
+	}
+
+	if(trigger_level == 0)
+	{
+		trigger_level = 1;
+	}
+
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	if(size == 0 || size > OS_FREERTOS_PIPE_STATIC_MAX_SIZE || trigger_level > size)
+#else
+	if(size == 0 || trigger_level > size)
+#endif
+	{
+		return OS_ERROR;
+	}
+
+	pipe = NULL;
+	taskENTER_CRITICAL();
+	for(i = 0; i < OS_FREERTOS_MAX_PIPES; i++)
+	{
+		if(!OS_impl_pipe_table[i].in_use && OS_impl_pipe_table[i].buffer == NULL)
+		{
+			pipe = &OS_impl_pipe_table[i];
+			pipe->in_use = true;
+			pipe->closed = false;
+			break;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if(pipe == NULL)
+	{
+		return OS_ERR_NO_FREE_IDS;
+	}
+
+#ifdef OS_FREERTOS_STATIC_OBJECTS
+	pipe->buffer = xStreamBufferCreateStatic(size, trigger_level, pipe->storage, &pipe->buffer_cb);
+#else
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_QUEUE);
+	pipe->buffer = xStreamBufferCreate(size, trigger_level);
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+#endif
+	(void) heap_category;
+
+	if(pipe->buffer == NULL)
+	{
+		pipe->in_use = false;
+		return OS_ERROR;
+	}
+
+	pipe->size = size;
+	pipe->trigger_level = trigger_level;
+
+	/* A pipe is a stream, the shared layer hands out its id and checks the name */
+	return_code = OS_ObjectIdAllocateNew(OS_OBJECT_TYPE_OS_STREAM, pipe_name, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		memset(&OS_stream_table[local_id], 0, sizeof(OS_stream_internal_record_t));
+		strcpy(OS_stream_table[local_id].stream_name, pipe_name);
+		record->name_entry = OS_stream_table[local_id].stream_name;
+
+		pipe->local_id = local_id;
+		OS_impl_filehandle_fd[local_id] = pipe;
+		OS_impl_filehandle_type[local_id] = -1;
+		OS_impl_filehandle_table[local_id].ops = &OS_FreeRTOS_PipeStreamOps;
+		OS_impl_filehandle_flags[local_id] = OS_FREERTOS_STREAM_PIPE;
+
+		return_code = OS_ObjectIdFinalizeNew(return_code, record, pipe_id);
+	}
+
+	if(return_code != OS_SUCCESS)
+	{
+		vStreamBufferDelete(pipe->buffer);
+		pipe->buffer = NULL;
+		pipe->in_use = false;
+	}
+
+	return return_code;
+} /* end OS_PipeCreate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_PipeGetInfo
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_PipeGetInfo(uint32 pipe_id, OS_pipe_prop_t *pipe_prop)
+{
+	OS_common_record_t *record;
+	OS_impl_pipe_t *pipe;
+	uint32 local_id;
+	int32 return_code;
+
+	if(pipe_prop == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(pipe_prop, 0, sizeof(OS_pipe_prop_t));
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_STREAM, pipe_id, &local_id, &record);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	if(OS_impl_filehandle_table[local_id].ops != &OS_FreeRTOS_PipeStreamOps)
+	{
+		return OS_ERR_INCORRECT_OBJ_TYPE;
+	}
+
+	pipe = (OS_impl_pipe_t *) OS_impl_filehandle_fd[local_id];
+	pipe_prop->size = pipe->size;
+	pipe_prop->trigger_level = pipe->trigger_level;
+	taskENTER_CRITICAL();
+	if(!pipe->closed)
+	{
+		pipe_prop->bytes_available = (uint32) xStreamBufferBytesAvailable(pipe->buffer);
+	}
+	taskEXIT_CRITICAL();
+
+	return OS_SUCCESS;
+} /* end OS_PipeGetInfo */
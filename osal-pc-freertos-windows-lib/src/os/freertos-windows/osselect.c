@@ -30,8 +30,34 @@
  INCLUDE FILES
  ***************************************************************************************/
 
+#include <string.h>
+
 #include "os-FreeRTOS.h"
 
+/*----------------------------------------------------------------
+ * Function: OS_SelectTicks
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Converts a select timeout in msecs, negative to pend forever,
+ *          into a FreeRTOS block time.
+ *-----------------------------------------------------------------*/
+static TickType_t OS_SelectTicks(int32 msecs)
+{
+   TickType_t ticks;
+
+   if(msecs>=0)
+   {
+	   OS_UsecsToTicks(msecs*1000, &ticks);
+   }
+   else
+   {
+	   ticks = portMAX_DELAY;
+   }
+
+   return ticks;
+} /* end OS_SelectTicks */
+
 #ifdef OS_INCLUDE_NETWORK
 
 /****************************************************************************************
@@ -39,32 +65,204 @@
  ***************************************************************************************/
 
 /*
- * The socket table.
+ * Persistent event sets, see OS_EventSetCreate.  The member list is dense so a
+ * wait only looks at the registered sockets; "lock" protects it but is not
+ * held while waiting.
  *
- * This is shared by all OSAL entities that perform low-level I/O.
+ * A call using the set holds a reference on the entry, counted in a critical
+ * section like the event flags.  Delete marks the entry, takes the members
+ * out and frees the socket set only when the last reference is dropped.
  */
-OS_FreeRTOS_filehandle_entry_t OS_impl_filehandle_table[OS_MAX_NUM_OPEN_FILES];
+typedef struct
+{
+	bool              in_use;
+	bool              deleting;							/* OS_EventSetDelete is draining the references */
+	uint16            generation;						/* high bits of the id, see OS_FREERTOS_EXT_ID */
+	uint32            refcount;							/* calls using set and lock, under a critical section */
+	SocketSet_t       set;
+	SemaphoreHandle_t lock;
+	uint32            count;
+	uint32            next;								/* member to report first, for fairness */
+	uint32            members[OS_MAX_NUM_OPEN_FILES];	/* local stream ids */
+	uint32            member_ids[OS_MAX_NUM_OPEN_FILES];	/* OSAL stream ids */
+} OS_impl_event_set_t;
+
+static OS_impl_event_set_t OS_impl_event_set_table[OS_FREERTOS_MAX_EVENT_SETS];
 
 /****************************************************************************************
  HELPER FUNCTION
  ***************************************************************************************/
-void UpdateConnectionStatus(uint32);
-void UpdateConnectionStatus(uint32 stream_id)
+
+/*----------------------------------------------------------------
+ * Function: OS_Socket_UpdateStatus
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Every socket is selected with eSELECT_EXCEPT as well, which
+ *          FreeRTOS+TCP raises when a TCP connection moves to CLOSE_WAIT or
+ *          CLOSED.  Record the disconnect from the bits select returned, so
+ *          no socket has to be polled for its connection state.
+ *-----------------------------------------------------------------*/
+static void OS_Socket_UpdateStatus(uint32 stream_id, BaseType_t returnedBits)
 {
-	bool isConnected = FreeRTOS_issocketconnected(OS_impl_filehandle_table[stream_id].fd);
-	if(isConnected)
+	if(returnedBits & eSELECT_EXCEPT)
 	{
-		OS_impl_filehandle_table[stream_id].disconnected = false;
+		if(OS_impl_filehandle_flags[stream_id] & OS_FREERTOS_STREAM_CONNECTED)
+		{
+			OS_impl_filehandle_flags[stream_id] |= OS_FREERTOS_STREAM_DISCONNECTED;
+		}
+		OS_impl_filehandle_flags[stream_id] &= ~OS_FREERTOS_STREAM_CONNECTED;
 	}
-	else
+} /* end OS_Socket_UpdateStatus */
+
+/*----------------------------------------------------------------
+ * Function: OS_EventSet_Lookup
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Event set of an id, or NULL if there is none.  Called in a
+ *          critical section.
+ *-----------------------------------------------------------------*/
+static OS_impl_event_set_t *OS_EventSet_Lookup(uint32 set_id)
+{
+	OS_impl_event_set_t *es;
+	uint32 index = OS_FREERTOS_EXT_ID_INDEX(set_id);
+
+	if(set_id == 0 || index >= OS_FREERTOS_MAX_EVENT_SETS)
 	{
-		if(OS_impl_filehandle_table[stream_id].connected)
+		return NULL;
+	}
+
+	es = &OS_impl_event_set_table[index];
+	if(!es->in_use || es->generation != OS_FREERTOS_EXT_ID_GEN(set_id))
+	{
+		return NULL;
+	}
+
+	return es;
+} /* end OS_EventSet_Lookup */
+
+/*----------------------------------------------------------------
+ * Function: OS_EventSet_Hold
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Takes a reference on the event set of an id, even one being
+ *          deleted, so a member can still be taken out of it.  Returns
+ *          NULL if there is none.  Drop it with OS_EventSet_Release.
+ *-----------------------------------------------------------------*/
+static OS_impl_event_set_t *OS_EventSet_Hold(uint32 set_id)
+{
+	OS_impl_event_set_t *es;
+
+	taskENTER_CRITICAL();
+	es = OS_EventSet_Lookup(set_id);
+	if(es != NULL)
+	{
+		++es->refcount;
+	}
+	taskEXIT_CRITICAL();
+
+	return es;
+} /* end OS_EventSet_Hold */
+
+/*----------------------------------------------------------------
+ * Function: OS_EventSet_Acquire
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Takes a reference on the event set of an id, or returns NULL
+ *          if there is none or it is being deleted.  Drop it with
+ *          OS_EventSet_Release.
+ *-----------------------------------------------------------------*/
+static OS_impl_event_set_t *OS_EventSet_Acquire(uint32 set_id)
+{
+	OS_impl_event_set_t *es;
+
+	taskENTER_CRITICAL();
+	es = OS_EventSet_Lookup(set_id);
+	if(es != NULL && es->deleting)
+	{
+		es = NULL;
+	}
+	if(es != NULL)
+	{
+		++es->refcount;
+	}
+	taskEXIT_CRITICAL();
+
+	return es;
+} /* end OS_EventSet_Acquire */
+
+/*----------------------------------------------------------------
+ * Function: OS_EventSet_Release
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *-----------------------------------------------------------------*/
+static void OS_EventSet_Release(OS_impl_event_set_t *es)
+{
+	taskENTER_CRITICAL();
+	--es->refcount;
+	taskEXIT_CRITICAL();
+} /* end OS_EventSet_Release */
+
+/*----------------------------------------------------------------
+ * Function: OS_EventSet_Restore
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          A FreeRTOS socket is only in one socket set at a time.  Put a
+ *          socket back into its event set after a select used another set.
+ *-----------------------------------------------------------------*/
+static void OS_EventSet_Restore(uint32 local_id)
+{
+	OS_impl_event_set_t *es;
+	uint32 event_set = OS_impl_filehandle_table[local_id].event_set;
+
+	es = OS_EventSet_Hold(event_set);
+	if(es != NULL)
+	{
+		xSemaphoreTake(es->lock, portMAX_DELAY);
+		if(OS_impl_filehandle_table[local_id].event_set == event_set)
 		{
-			OS_impl_filehandle_table[stream_id].disconnected = true;
+			FreeRTOS_FD_SET(OS_impl_filehandle_fd[local_id], es->set,
+			                OS_impl_filehandle_table[local_id].event_bits);
 		}
+		xSemaphoreGive(es->lock);
+		OS_EventSet_Release(es);
 	}
-	OS_impl_filehandle_table[stream_id].connected = isConnected;
-}
+} /* end OS_EventSet_Restore */
+
+/*
+ * The OS_FdSet bitmap is scanned a 32 bit word at a time, lowest set bit
+ * first, so empty stretches of the set cost one compare per word.  Byte 0
+ * holds ids 0-7, which on the (little endian) x86 host are the low bits of
+ * the word.
+ */
+#define OS_FDSET_WORD_BYTES     sizeof(uint32)
+
+/*----------------------------------------------------------------
+ * Function: OS_FdSet_GetWord
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Read the word of an OS_FdSet starting at byte "offset", the
+ *          last word may be partial.
+ *-----------------------------------------------------------------*/
+static uint32 OS_FdSet_GetWord(const OS_FdSet *OSAL_set, uint32 offset)
+{
+   uint32 word = 0;
+   uint32 len = sizeof(OSAL_set->object_ids) - offset;
+
+   if (len > OS_FDSET_WORD_BYTES)
+   {
+      len = OS_FDSET_WORD_BYTES;
+   }
+
+   memcpy(&word, &OSAL_set->object_ids[offset], len);
+
+   return word;
+} /* end OS_FdSet_GetWord */
 
 /*----------------------------------------------------------------
  * Function: OS_FdSet_ConvertIn_Impl
@@ -73,35 +271,40 @@ void UpdateConnectionStatus(uint32 stream_id)
  *
  *          Convert an OS_FdSet (OSAL) structure into an SocketSet_t (FreeRTOS)
  *          which can then be passed to the FreeRTOS_select function.
+ *          Returns the number of sockets added.
  *
  *-----------------------------------------------------------------*/
-static void OS_FdSet_ConvertIn_Impl(SocketSet_t *os_set, OS_FdSet *OSAL_set, BaseType_t xSelectBits)
+static uint32 OS_FdSet_ConvertIn_Impl(SocketSet_t *os_set, OS_FdSet *OSAL_set, BaseType_t xSelectBits)
 {
    uint32 offset;
-   uint32 bit;
+   uint32 word;
    uint32 id;
-   uint8 objids;
+   uint32 count = 0;
    Socket_t osfd;
 
-   for (offset = 0; offset < sizeof(OSAL_set->object_ids); ++offset)
+   for (offset = 0; offset < sizeof(OSAL_set->object_ids); offset += OS_FDSET_WORD_BYTES)
    {
-      objids = OSAL_set->object_ids[offset];
-      bit = 0;
-      while (objids != 0)
+      word = OS_FdSet_GetWord(OSAL_set, offset);
+      while (word != 0)
       {
-         if (objids & 0x01)
+         id = (offset * 8) + __builtin_ctz(word);
+         word &= word - 1;
+         if (id >= OS_MAX_NUM_OPEN_FILES)
          {
-            id = (offset * 8) + bit;
-            osfd = OS_impl_filehandle_table[id].fd;
-            if (osfd != NULL)
-            {
-               FreeRTOS_FD_SET(osfd, os_set, xSelectBits);
-            }
+            break;
+         }
+
+         /* Pipes are not FreeRTOS sockets, OS_FreeRTOS_PipeWait checks them */
+         osfd = OS_impl_filehandle_fd[id];
+         if (osfd != NULL && !(OS_impl_filehandle_flags[id] & OS_FREERTOS_STREAM_PIPE))
+         {
+            FreeRTOS_FD_SET(osfd, os_set, xSelectBits | eSELECT_EXCEPT);
+            ++count;
          }
-         ++bit;
-         objids >>= 1;
       }
    }
+
+   return count;
 } /* end OS_FdSet_ConvertIn_Impl */
 
 /*----------------------------------------------------------------
@@ -118,70 +321,152 @@ static void OS_FdSet_ConvertIn_Impl(SocketSet_t *os_set, OS_FdSet *OSAL_set, Bas
 static void OS_FdSet_ConvertOut_Impl(SocketSet_t *output, OS_FdSet *Input, BaseType_t xSelectBits, bool *disconn)
 {
    uint32 offset;
-   uint32 bit;
+   uint32 word;
    uint32 id;
-   uint8 objids;
    Socket_t osfd;
+   BaseType_t returnedBits;
 
-   for (offset = 0; offset < sizeof(Input->object_ids); ++offset)
+   for (offset = 0; offset < sizeof(Input->object_ids); offset += OS_FDSET_WORD_BYTES)
    {
-      objids = Input->object_ids[offset];
-      bit = 0;
-      while (objids != 0)
+      word = OS_FdSet_GetWord(Input, offset);
+      while (word != 0)
       {
-         if (objids & 0x01)
+         id = (offset * 8) + __builtin_ctz(word);
+         word &= word - 1;
+         if (id >= OS_MAX_NUM_OPEN_FILES)
          {
-            id = (offset * 8) + bit;
-            osfd = OS_impl_filehandle_table[id].fd;
-            if(osfd == NULL)
+            break;
+         }
+
+         osfd = OS_impl_filehandle_fd[id];
+         if(osfd == NULL)
+         {
+            Input->object_ids[id / 8] &= ~(1 << (id % 8));
+         }
+         else if(OS_impl_filehandle_flags[id] & OS_FREERTOS_STREAM_PIPE)
+         {
+            /* Left to OS_FreeRTOS_PipeSetUpdate */
+         }
+         else
+         {
+            returnedBits = FreeRTOS_FD_ISSET(osfd, output);
+            OS_Socket_UpdateStatus(id, returnedBits);
+            //Disconnected sockets should always be selected. They either have an event pending or they need to signal that they are done
+            if((returnedBits & eSELECT_EXCEPT) || (OS_impl_filehandle_flags[id] & OS_FREERTOS_STREAM_DISCONNECTED))
             {
-        		Input->object_ids[offset] &= ~(1 << bit);
+               *disconn = true;
             }
-            else
+            else if(!(returnedBits & xSelectBits))
             {
-				UpdateConnectionStatus(id);
-				//Disconnected sockets should always be selected. They either have an event pending or they need to signal that they are done
-				if(OS_impl_filehandle_table[id].disconnected)
-				{
-					*disconn = true;
-				}
-				else if(!FreeRTOS_FD_ISSET(osfd, output))
-				{
-					Input->object_ids[offset] &= ~(1 << bit);
-				}
-
-                FreeRTOS_FD_CLR(osfd, output, xSelectBits);
+               Input->object_ids[id / 8] &= ~(1 << (id % 8));
             }
+
+            FreeRTOS_FD_CLR(osfd, output, xSelectBits | eSELECT_EXCEPT);
+            OS_EventSet_Restore(id);
          }
-         ++bit;
-         objids >>= 1;
       }
    }
 } /* end OS_FdSet_ConvertOut_Impl */
 
 /*----------------------------------------------------------------
- * Function: OS_DoSelect
+ * Function: OS_FdSet_Clear_Impl
  *
  *  Purpose: Local helper routine, not part of OSAL API.
  *
- *          Actual implementation of FreeRTOS_select() call
- *          Used by SelectSingle and SelectMultiple implementations (below)
+ *          Remove every socket of an OS_FdSet from a FreeRTOS SocketSet_t,
+ *          without touching the OS_FdSet itself.
  *-----------------------------------------------------------------*/
-static int32 OS_DoSelect(SocketSet_t set, int32 msecs)
+static void OS_FdSet_Clear_Impl(SocketSet_t os_set, const OS_FdSet *OSAL_set)
 {
-   int os_status;
-   int32 return_code;
-   TickType_t ticks;
+   uint32 offset;
+   uint32 word;
+   uint32 id;
+   Socket_t osfd;
 
-   if(msecs>=0)
+   for (offset = 0; offset < sizeof(OSAL_set->object_ids); offset += OS_FDSET_WORD_BYTES)
    {
-	   OS_UsecsToTicks(msecs*1000, &ticks);
+      word = OS_FdSet_GetWord(OSAL_set, offset);
+      while (word != 0)
+      {
+         id = (offset * 8) + __builtin_ctz(word);
+         word &= word - 1;
+         if (id >= OS_MAX_NUM_OPEN_FILES)
+         {
+            break;
+         }
+
+         osfd = OS_impl_filehandle_fd[id];
+         if (osfd != NULL && !(OS_impl_filehandle_flags[id] & OS_FREERTOS_STREAM_PIPE))
+         {
+            FreeRTOS_FD_CLR(osfd, os_set, eSELECT_ALL);
+            OS_EventSet_Restore(id);
+         }
+      }
    }
-   else
+} /* end OS_FdSet_Clear_Impl */
+
+/*----------------------------------------------------------------
+ * Function: OS_FreeRTOS_TaskSocketSet
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Socket set of the calling task for OS_SelectMultiple, created
+ *          on first use and kept in a thread local storage slot until the
+ *          task is deleted, see OS_FreeRTOS_SocketSetRelease.
+ *-----------------------------------------------------------------*/
+static SocketSet_t OS_FreeRTOS_TaskSocketSet(void)
+{
+   SocketSet_t set;
+   uint32 heap_category;
+
+   set = (SocketSet_t) pvTaskGetThreadLocalStoragePointer(NULL, OS_FREERTOS_TLS_SOCKET_SET);
+   if (set == NULL)
    {
-	   ticks = portMAX_DELAY;
+      heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_NETWORK);
+      set = FreeRTOS_CreateSocketSet();
+      OS_FreeRTOS_HeapCategorySet(heap_category);
+      if (set != NULL)
+      {
+         vTaskSetThreadLocalStoragePointer(NULL, OS_FREERTOS_TLS_SOCKET_SET, set);
+      }
    }
 
+   return set;
+} /* end OS_FreeRTOS_TaskSocketSet */
+
+/*----------------------------------------------------------------
+ * Function: OS_FreeRTOS_SocketSetRelease
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Delete the OS_SelectMultiple socket set of a task that is about
+ *          to be deleted.
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_SocketSetRelease(TaskHandle_t task)
+{
+   SocketSet_t set;
+
+   set = (SocketSet_t) pvTaskGetThreadLocalStoragePointer(task, OS_FREERTOS_TLS_SOCKET_SET);
+   if (set != NULL)
+   {
+      vTaskSetThreadLocalStoragePointer(task, OS_FREERTOS_TLS_SOCKET_SET, NULL);
+      FreeRTOS_DeleteSocketSet(set);
+   }
+} /* end OS_FreeRTOS_SocketSetRelease */
+
+/*----------------------------------------------------------------
+ * Function: OS_DoSelect
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Actual implementation of FreeRTOS_select() call
+ *          Used by SelectSingle and SelectMultiple implementations (below)
+ *-----------------------------------------------------------------*/
+static int32 OS_DoSelect(SocketSet_t set, TickType_t ticks)
+{
+   int os_status;
+   int32 return_code;
+
    do
    {
       os_status = FreeRTOS_select(set, ticks);
@@ -222,10 +507,31 @@ int32 OS_SelectSingle_Impl(uint32 stream_id, uint32 *SelectFlags, int32 msecs)
 	SocketSet_t set;
 	BaseType_t xSelectBits = 0;
 	BaseType_t returnedBits;
+	uint32 heap_category;
+
+	if(OS_impl_filehandle_flags[stream_id] & OS_FREERTOS_STREAM_PIPE)
+	{
+		return OS_FreeRTOS_PipeSelectSingle(stream_id, SelectFlags, OS_SelectTicks(msecs));
+	}
 
 	if (*SelectFlags != 0)
 	{
-		set = FreeRTOS_CreateSocketSet();
+		/*
+		 * Every socket keeps its own set for single selects, created on
+		 * first use and deleted when the socket is closed.
+		 */
+		set = OS_impl_filehandle_table[stream_id].select_set;
+		if(set == NULL)
+		{
+			heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_NETWORK);
+			set = FreeRTOS_CreateSocketSet();
+			OS_FreeRTOS_HeapCategorySet(heap_category);
+			if(set == NULL)
+			{
+				return OS_ERROR;
+			}
+			OS_impl_filehandle_table[stream_id].select_set = set;
+		}
 
 		if(*SelectFlags & OS_STREAM_STATE_READABLE)
 		{
@@ -236,33 +542,29 @@ int32 OS_SelectSingle_Impl(uint32 stream_id, uint32 *SelectFlags, int32 msecs)
 			xSelectBits |= eSELECT_WRITE;
 		}
 
-		FreeRTOS_FD_SET(OS_impl_filehandle_table[stream_id].fd, set, xSelectBits);
+		/*
+		 * eSELECT_EXCEPT makes a peer close wake the select right away, even
+		 * when the caller pends forever on a readable or writable state.
+		 */
+		FreeRTOS_FD_SET(OS_impl_filehandle_fd[stream_id], set, xSelectBits | eSELECT_EXCEPT);
 
-		return_code = OS_DoSelect(set, msecs);
-
-		UpdateConnectionStatus(stream_id);
+		return_code = OS_DoSelect(set, OS_SelectTicks(msecs));
 
 		if (return_code == OS_SUCCESS)
 		{
-			returnedBits = FreeRTOS_FD_ISSET(OS_impl_filehandle_table[stream_id].fd, set);
-			if(!(returnedBits & eSELECT_READ))
-			{
-				*SelectFlags &= ~OS_STREAM_STATE_READABLE;
-			}
-			if(!(returnedBits & eSELECT_WRITE))
+			returnedBits = FreeRTOS_FD_ISSET(OS_impl_filehandle_fd[stream_id], set);
+			OS_Socket_UpdateStatus(stream_id, returnedBits);
+
+			/* A closed connection reports every requested state, the next read or write returns its status */
+			if(returnedBits & eSELECT_EXCEPT)
 			{
-				*SelectFlags &= ~OS_STREAM_STATE_WRITABLE;
+				returnedBits |= xSelectBits;
 			}
-		}
-		else if (return_code == OS_ERROR_TIMEOUT && OS_impl_filehandle_table[stream_id].disconnected)
-		{
-			//This will be a problem if OS_PEND is used!
-			return_code = OS_SUCCESS;
-			if(!(xSelectBits & eSELECT_READ))
+			if(!(returnedBits & eSELECT_READ))
 			{
 				*SelectFlags &= ~OS_STREAM_STATE_READABLE;
 			}
-			if(!(xSelectBits & eSELECT_WRITE))
+			if(!(returnedBits & eSELECT_WRITE))
 			{
 				*SelectFlags &= ~OS_STREAM_STATE_WRITABLE;
 			}
@@ -272,7 +574,8 @@ int32 OS_SelectSingle_Impl(uint32 stream_id, uint32 *SelectFlags, int32 msecs)
 			*SelectFlags = 0;
 		}
 
-		FreeRTOS_FD_CLR(OS_impl_filehandle_table[stream_id].fd, set, xSelectBits);
+		FreeRTOS_FD_CLR(OS_impl_filehandle_fd[stream_id], set, xSelectBits | eSELECT_EXCEPT);
+		OS_EventSet_Restore(stream_id);
 	}
 	else
 	{
@@ -297,19 +600,80 @@ int32 OS_SelectMultiple_Impl(OS_FdSet *ReadSet, OS_FdSet *WriteSet, int32 msecs)
 	int32 return_code = OS_SUCCESS;
 	bool wr_disconn = false;
 	bool rd_disconn = false;
+	uint32 sockets = 0;
+	uint32 pipe_read;
+	uint32 pipe_write;
+	uint32 ready_read = 0;
+	uint32 ready_write = 0;
+	TickType_t ticks;
+	TickType_t slice;
+	TimeOut_t time_out;
 
-	set = FreeRTOS_CreateSocketSet();
+	set = OS_FreeRTOS_TaskSocketSet();
+	if(set == NULL)
+	{
+		return OS_ERROR;
+	}
 
 	if (ReadSet != NULL)
 	{
-		OS_FdSet_ConvertIn_Impl(set, ReadSet, eSELECT_READ);
+		sockets += OS_FdSet_ConvertIn_Impl(set, ReadSet, eSELECT_READ);
 	}
 	if (WriteSet != NULL)
 	{
-		OS_FdSet_ConvertIn_Impl(set, WriteSet, eSELECT_WRITE);
+		sockets += OS_FdSet_ConvertIn_Impl(set, WriteSet, eSELECT_WRITE);
+	}
+
+	pipe_read = OS_FreeRTOS_PipeSetMask(ReadSet);
+	pipe_write = OS_FreeRTOS_PipeSetMask(WriteSet);
+	ticks = OS_SelectTicks(msecs);
+
+	if(pipe_read == 0 && pipe_write == 0)
+	{
+		return_code = OS_DoSelect(set, ticks);
+	}
+	else if(sockets == 0)
+	{
+		return_code = OS_FreeRTOS_PipeWait(pipe_read, pipe_write, &ready_read, &ready_write, ticks);
+	}
+	else
+	{
+		/*
+		 * FreeRTOS_select only wakes for sockets, so with pipes in the sets
+		 * as well it waits in slices and the pipes are checked in between.
+		 */
+		vTaskSetTimeOutState(&time_out);
+		while(1)
+		{
+			OS_FreeRTOS_PipeWait(pipe_read, pipe_write, &ready_read, &ready_write, 0);
+			slice = ((ready_read | ready_write) != 0) ? 0 : OS_Milli2Ticks(OS_FREERTOS_PIPE_SELECT_POLL_MSEC);
+			if(slice > ticks)
+			{
+				slice = ticks;
+			}
+
+			return_code = OS_DoSelect(set, slice);
+			if(return_code != OS_ERROR_TIMEOUT || (ready_read | ready_write) != 0 ||
+			   xTaskCheckForTimeOut(&time_out, &ticks) != pdFALSE)
+			{
+				break;
+			}
+		}
+
+		if(return_code == OS_ERROR_TIMEOUT && (ready_read | ready_write) != 0)
+		{
+			return_code = OS_SUCCESS;
+		}
 	}
 
-	return_code = OS_DoSelect(set, msecs);
+	if (ReadSet != NULL)
+	{
+		OS_FreeRTOS_PipeSetUpdate(ReadSet, pipe_read, ready_read);
+	}
+	if (WriteSet != NULL)
+	{
+		OS_FreeRTOS_PipeSetUpdate(WriteSet, pipe_write, ready_write);
+	}
 
 	if(return_code != OS_ERROR)
 	{
@@ -327,12 +691,540 @@ int32 OS_SelectMultiple_Impl(OS_FdSet *ReadSet, OS_FdSet *WriteSet, int32 msecs)
 			return_code = OS_SUCCESS;
 		}
 	}
+	else
+	{
+		/* Leave the reused set empty for the next call */
+		if (ReadSet != NULL)
+		{
+			OS_FdSet_Clear_Impl(set, ReadSet);
+		}
+		if (WriteSet != NULL)
+		{
+			OS_FdSet_Clear_Impl(set, WriteSet);
+		}
+	}
 
 	return return_code;
 } /* end OS_SelectMultiple_Impl */
 
+/****************************************************************************************
+ EVENT SET API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ * Function: OS_EventSet_RemoveMember
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Take a socket out of its event set, with the set locked
+ *-----------------------------------------------------------------*/
+static void OS_EventSet_RemoveMember(OS_impl_event_set_t *es, uint32 local_id)
+{
+	uint32 i;
+
+	FreeRTOS_FD_CLR(OS_impl_filehandle_fd[local_id], es->set, eSELECT_ALL);
+	OS_impl_filehandle_table[local_id].event_set = 0;
+	OS_impl_filehandle_table[local_id].event_bits = 0;
+
+	for(i = 0; i < es->count; i++)
+	{
+		if(es->members[i] == local_id)
+		{
+			/* Keep the list dense, order does not matter */
+			--es->count;
+			es->members[i] = es->members[es->count];
+			es->member_ids[i] = es->member_ids[es->count];
+			break;
+		}
+	}
+} /* end OS_EventSet_RemoveMember */
+
+/*----------------------------------------------------------------
+ * Function: OS_FreeRTOS_EventSetDetach
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Remove a socket that is being closed from its event set
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_EventSetDetach(uint32 local_id)
+{
+	OS_impl_event_set_t *es;
+	uint32 event_set = OS_impl_filehandle_table[local_id].event_set;
+
+	es = OS_EventSet_Hold(event_set);
+	if(es != NULL)
+	{
+		xSemaphoreTake(es->lock, portMAX_DELAY);
+		if(OS_impl_filehandle_table[local_id].event_set == event_set)
+		{
+			OS_EventSet_RemoveMember(es, local_id);
+		}
+		xSemaphoreGive(es->lock);
+		OS_EventSet_Release(es);
+	}
+} /* end OS_FreeRTOS_EventSetDetach */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventSetCreate
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventSetCreate(uint32 *set_id)
+{
+	OS_impl_event_set_t *es;
+	uint32 heap_category;
+	uint32 i;
+
+	if(set_id == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*set_id = 0;
+
+	es = NULL;
+	taskENTER_CRITICAL();
+	for(i = 0; i < OS_FREERTOS_MAX_EVENT_SETS; i++)
+	{
+		if(!OS_impl_event_set_table[i].in_use)
+		{
+			/* Marked as deleting, so the id is not usable until the set is built */
+			es = &OS_impl_event_set_table[i];
+			es->in_use = true;
+			es->deleting = true;
+			es->refcount = 0;
+			++es->generation;
+			break;
+		}
+	}
+	taskEXIT_CRITICAL();
+
+	if(es == NULL)
+	{
+		return OS_ERR_NO_FREE_IDS;
+	}
+
+	heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_NETWORK);
+	es->set = FreeRTOS_CreateSocketSet();
+	es->lock = xSemaphoreCreateMutex();
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+
+	if(es->set == NULL || es->lock == NULL)
+	{
+		if(es->set != NULL)
+		{
+			FreeRTOS_DeleteSocketSet(es->set);
+		}
+		if(es->lock != NULL)
+		{
+			vSemaphoreDelete(es->lock);
+		}
+		taskENTER_CRITICAL();
+		es->in_use = false;
+		es->deleting = false;
+		taskEXIT_CRITICAL();
+		return OS_ERROR;
+	}
+
+	es->count = 0;
+	es->next = 0;
+	*set_id = OS_FREERTOS_EXT_ID(i, es->generation);
+
+	taskENTER_CRITICAL();
+	es->deleting = false;
+	taskEXIT_CRITICAL();
+
+	return OS_SUCCESS;
+} /* end OS_EventSetCreate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventSetDelete
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventSetDelete(uint32 set_id)
+{
+	OS_impl_event_set_t *es;
+	bool busy;
+
+	es = OS_EventSet_Acquire(set_id);
+	if(es == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	/*
+	 * Mark the set under its lock, so an OS_EventSetAdd either sees the
+	 * mark or adds its socket before the members are taken out.
+	 */
+	xSemaphoreTake(es->lock, portMAX_DELAY);
+	taskENTER_CRITICAL();
+	busy = es->deleting;
+	es->deleting = true;
+	taskEXIT_CRITICAL();
+	while(!busy && es->count > 0)
+	{
+		OS_EventSet_RemoveMember(es, es->members[0]);
+	}
+	xSemaphoreGive(es->lock);
+
+	OS_EventSet_Release(es);
+	if(busy)
+	{
+		/* Another delete got there first */
+		return OS_ERR_INVALID_ID;
+	}
+
+	/*
+	 * Waiters see the mark within OS_FREERTOS_EVENT_SET_POLL_MSEC.  Once the
+	 * last reference is gone the generation moves on, so the old id finds
+	 * nothing while the set is freed.
+	 */
+	for(;;)
+	{
+		taskENTER_CRITICAL();
+		busy = (es->refcount != 0);
+		if(!busy)
+		{
+			++es->generation;
+		}
+		taskEXIT_CRITICAL();
+		if(!busy)
+		{
+			break;
+		}
+
+		vTaskDelay(1);
+	}
+
+	FreeRTOS_DeleteSocketSet(es->set);
+	vSemaphoreDelete(es->lock);
+	es->set = NULL;
+	es->lock = NULL;
+
+	taskENTER_CRITICAL();
+	es->in_use = false;
+	es->deleting = false;
+	taskEXIT_CRITICAL();
+
+	return OS_SUCCESS;
+} /* end OS_EventSetDelete */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventSetAdd
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventSetAdd(uint32 set_id, uint32 stream_id, uint32 events)
+{
+	OS_impl_event_set_t *es;
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+	BaseType_t xSelectBits;
+
+	es = OS_EventSet_Acquire(set_id);
+	if(es == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	/* A closed connection shows up as an exception, it is reported as readable */
+	xSelectBits = eSELECT_EXCEPT;
+	if(events & OS_STREAM_STATE_READABLE)
+	{
+		xSelectBits |= eSELECT_READ;
+	}
+	if(events & OS_STREAM_STATE_WRITABLE)
+	{
+		xSelectBits |= eSELECT_WRITE;
+	}
+
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_STREAM);
+	if(return_code != OS_SUCCESS)
+	{
+		OS_EventSet_Release(es);
+		return return_code;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_STREAM, stream_id, &local_id, &record);
+	if(return_code == OS_SUCCESS && !(OS_impl_filehandle_flags[local_id] & OS_FREERTOS_STREAM_SELECTABLE))
+	{
+		return_code = OS_ERR_INCORRECT_OBJ_STATE;
+	}
+	if(return_code == OS_SUCCESS)
+	{
+		xSemaphoreTake(es->lock, portMAX_DELAY);
+		if(es->deleting)
+		{
+			return_code = OS_ERR_INVALID_ID;
+		}
+		else if(OS_impl_filehandle_table[local_id].event_set == 0)
+		{
+			es->members[es->count] = local_id;
+			es->member_ids[es->count] = stream_id;
+			++es->count;
+			OS_impl_filehandle_table[local_id].event_set = set_id;
+		}
+		else if(OS_impl_filehandle_table[local_id].event_set != set_id)
+		{
+			return_code = OS_ERR_INCORRECT_OBJ_STATE;
+		}
+
+		if(return_code == OS_SUCCESS)
+		{
+			/* Replace the registered events */
+			FreeRTOS_FD_CLR(OS_impl_filehandle_fd[local_id], es->set, eSELECT_ALL);
+			OS_impl_filehandle_table[local_id].event_bits = xSelectBits;
+			FreeRTOS_FD_SET(OS_impl_filehandle_fd[local_id], es->set, xSelectBits);
+		}
+		xSemaphoreGive(es->lock);
+	}
+
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_STREAM);
+	OS_EventSet_Release(es);
+
+	return return_code;
+} /* end OS_EventSetAdd */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventSetRemove
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventSetRemove(uint32 set_id, uint32 stream_id)
+{
+	OS_impl_event_set_t *es;
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	es = OS_EventSet_Acquire(set_id);
+	if(es == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_STREAM);
+	if(return_code != OS_SUCCESS)
+	{
+		OS_EventSet_Release(es);
+		return return_code;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_STREAM, stream_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		xSemaphoreTake(es->lock, portMAX_DELAY);
+		if(OS_impl_filehandle_table[local_id].event_set == set_id)
+		{
+			OS_EventSet_RemoveMember(es, local_id);
+		}
+		else
+		{
+			return_code = OS_ERR_INCORRECT_OBJ_STATE;
+		}
+		xSemaphoreGive(es->lock);
+	}
+
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_STREAM);
+	OS_EventSet_Release(es);
+
+	return return_code;
+} /* end OS_EventSetRemove */
+
+/*----------------------------------------------------------------
+ * Function: OS_EventSet_Scan
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Collect the ready members after a select, starting after the
+ *          last member reported so no socket is starved.  Returns the
+ *          number of entries filled in.
+ *-----------------------------------------------------------------*/
+static uint32 OS_EventSet_Scan(OS_impl_event_set_t *es, OS_stream_ready_t *ready, uint32 max_ready)
+{
+	uint32 local_id;
+	uint32 events;
+	uint32 n;
+	uint32 i;
+	uint32 first;
+	BaseType_t returnedBits;
+
+	n = 0;
+	xSemaphoreTake(es->lock, portMAX_DELAY);
+	first = (es->count > 0) ? (es->next % es->count) : 0;
+	for(i = 0; i < es->count && n < max_ready; i++)
+	{
+		local_id = es->members[(first + i) % es->count];
+		returnedBits = FreeRTOS_FD_ISSET(OS_impl_filehandle_fd[local_id], es->set);
+		if(returnedBits == 0)
+		{
+			continue;
+		}
+
+		OS_Socket_UpdateStatus(local_id, returnedBits);
+
+		events = 0;
+		if(returnedBits & (eSELECT_READ | eSELECT_EXCEPT))
+		{
+			events |= OS_STREAM_STATE_READABLE;
+		}
+		if(returnedBits & eSELECT_WRITE)
+		{
+			events |= OS_STREAM_STATE_WRITABLE;
+		}
+
+		ready[n].stream_id = es->member_ids[(first + i) % es->count];
+		ready[n].events = events;
+		++n;
+	}
+	es->next = first + i;
+	xSemaphoreGive(es->lock);
+
+	return n;
+} /* end OS_EventSet_Scan */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_EventSetWait
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_EventSetWait(uint32 set_id, OS_stream_ready_t *ready, uint32 max_ready, uint32 *count, int32 msecs)
+{
+	OS_impl_event_set_t *es;
+	int32 return_code;
+	uint32 n;
+	TickType_t ticks;
+	TickType_t slice;
+	TimeOut_t time_out;
+
+	if(ready == NULL || count == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	*count = 0;
+
+	es = OS_EventSet_Acquire(set_id);
+	if(es == NULL)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	/*
+	 * The set is already built, there is nothing to convert before waiting.
+	 * Nothing wakes FreeRTOS_select when the set is deleted, so it waits in
+	 * slices and a delete ends the wait in between.
+	 */
+	ticks = OS_SelectTicks(msecs);
+	vTaskSetTimeOutState(&time_out);
+	while(1)
+	{
+		slice = OS_Milli2Ticks(OS_FREERTOS_EVENT_SET_POLL_MSEC);
+		if(slice > ticks)
+		{
+			slice = ticks;
+		}
+
+		return_code = OS_DoSelect(es->set, slice);
+		if(return_code != OS_ERROR_TIMEOUT || es->deleting ||
+		   xTaskCheckForTimeOut(&time_out, &ticks) != pdFALSE)
+		{
+			break;
+		}
+	}
+
+	if(return_code == OS_ERROR)
+	{
+		OS_EventSet_Release(es);
+		return return_code;
+	}
+
+	n = 0;
+	if(return_code == OS_SUCCESS)
+	{
+		n = OS_EventSet_Scan(es, ready, max_ready);
+	}
+
+	/*
+	 * A socket may have become ready just as the wait ran out, or the
+	 * socket the select woke up for may have been removed before the scan.
+	 * Poll the set once more before reporting a timeout.
+	 */
+	if(n == 0 && !es->deleting && OS_DoSelect(es->set, 0) == OS_SUCCESS)
+	{
+		n = OS_EventSet_Scan(es, ready, max_ready);
+	}
+
+	OS_EventSet_Release(es);
+
+	*count = n;
+	if(n == 0)
+	{
+		return OS_ERROR_TIMEOUT;
+	}
+
+	return OS_SUCCESS;
+} /* end OS_EventSetWait */
+
 #else
 
+/*----------------------------------------------------------------
+ * Function: OS_FdSet_OnlyPipes
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Whether every open stream of an OS_FdSet is a pipe.
+ *-----------------------------------------------------------------*/
+static bool OS_FdSet_OnlyPipes(const OS_FdSet *OSAL_set)
+{
+   uint32 id;
+
+   if (OSAL_set == NULL)
+   {
+      return true;
+   }
+
+   for (id = 0; id < OS_MAX_NUM_OPEN_FILES && id / 8 < sizeof(OSAL_set->object_ids); id++)
+   {
+      if ((OSAL_set->object_ids[id / 8] & (1 << (id % 8))) != 0 &&
+          OS_impl_filehandle_fd[id] != NULL &&
+          !(OS_impl_filehandle_flags[id] & OS_FREERTOS_STREAM_PIPE))
+      {
+         return false;
+      }
+   }
+
+   return true;
+} /* end OS_FdSet_OnlyPipes */
+
+/*----------------------------------------------------------------
+ * Function: OS_FreeRTOS_SocketSetRelease
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *
+ *          Nothing to release without networking.
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_SocketSetRelease(TaskHandle_t task)
+{
+} /* end OS_FreeRTOS_SocketSetRelease */
+
 /****************************************************************************************
  SELECT API
  ***************************************************************************************/
@@ -347,7 +1239,13 @@ int32 OS_SelectMultiple_Impl(OS_FdSet *ReadSet, OS_FdSet *WriteSet, int32 msecs)
  *-----------------------------------------------------------------*/
 int32 OS_SelectSingle_Impl(uint32 stream_id, uint32 *SelectFlags, int32 msecs)
 {
-	return OS_ERR_NOT_IMPLEMENTED;
+	/* Without networking only pipes can be selected */
+	if(!(OS_impl_filehandle_flags[stream_id] & OS_FREERTOS_STREAM_PIPE))
+	{
+		return OS_ERR_NOT_IMPLEMENTED;
+	}
+
+	return OS_FreeRTOS_PipeSelectSingle(stream_id, SelectFlags, OS_SelectTicks(msecs));
 } /* end OS_SelectSingle_Impl */
 
 
@@ -361,7 +1259,33 @@ int32 OS_SelectSingle_Impl(uint32 stream_id, uint32 *SelectFlags, int32 msecs)
  *-----------------------------------------------------------------*/
 int32 OS_SelectMultiple_Impl(OS_FdSet *ReadSet, OS_FdSet *WriteSet, int32 msecs)
 {
-	return OS_ERR_NOT_IMPLEMENTED;
+	uint32 pipe_read;
+	uint32 pipe_write;
+	uint32 ready_read;
+	uint32 ready_write;
+	int32 return_code;
+
+	/* Without networking only pipes can be selected */
+	if(!OS_FdSet_OnlyPipes(ReadSet) || !OS_FdSet_OnlyPipes(WriteSet))
+	{
+		return OS_ERR_NOT_IMPLEMENTED;
+	}
+
+	pipe_read = OS_FreeRTOS_PipeSetMask(ReadSet);
+	pipe_write = OS_FreeRTOS_PipeSetMask(WriteSet);
+
+	return_code = OS_FreeRTOS_PipeWait(pipe_read, pipe_write, &ready_read, &ready_write, OS_SelectTicks(msecs));
+
+	if (ReadSet != NULL)
+	{
+		OS_FreeRTOS_PipeSetUpdate(ReadSet, pipe_read, ready_read);
+	}
+	if (WriteSet != NULL)
+	{
+		OS_FreeRTOS_PipeSetUpdate(WriteSet, pipe_write, ready_write);
+	}
+
+	return return_code;
 } /* end OS_SelectMultiple_Impl */
 
 #endif
@@ -38,6 +38,7 @@
 
 TickType_t getElapsedSeconds();
 TickType_t getElapsedMicroseconds();
+BaseType_t xGetMonotonicNanoseconds(unsigned long long *pullNanoseconds);
 
 /****************************************************************************************
  INTERNAL FUNCTION PROTOTYPES
@@ -55,9 +56,45 @@ int32 OS_TimerGetIdByHostId(uint32 *timer_id, TimerHandle_t host_timer_id);
  *
  * This should run at the highest priority to reduce latency.
  */
-#define OSAL_TIMEBASE_TASK_STACK_SIZE       configTIMER_TASK_STACK_DEPTH
+#define OSAL_TIMEBASE_TASK_STACK_SIZE       OS_FREERTOS_TIMEBASE_STACK_SIZE
 #define OSAL_TIMEBASE_TASK_PRIORITY         configTIMER_TASK_PRIORITY
 
+/* The shared dispatch task runs alongside the timebase tasks it releases */
+#define OSAL_TIMEBASE_DISPATCH_STACK_SIZE   configTIMER_TASK_STACK_DEPTH
+#define OSAL_TIMEBASE_DISPATCH_PRIORITY     configTIMER_TASK_PRIORITY
+
+#if defined(OS_FREERTOS_TIMEBASE_HIRES) && defined(OS_FREERTOS_TIMEBASE_DISPATCH)
+#error OS_FREERTOS_TIMEBASE_HIRES and OS_FREERTOS_TIMEBASE_DISPATCH cannot both be defined
+#endif
+#if defined(OS_FREERTOS_TIMEBASE_HIRES) && configFREERTOS_RUN_AS_SIM == 1
+#error OS_FREERTOS_TIMEBASE_HIRES cannot be used when synchronizing with a simulation driver
+#endif
+
+/*
+ * The external thread waits on its wake event and on the event of every
+ * external timebase with one WaitForMultipleObjects, which takes at most
+ * MAXIMUM_WAIT_OBJECTS (64) handles and fails outright beyond that.
+ */
+#define OS_TIMEBASE_EXT_WAIT_HANDLES	(OS_MAX_TIMEBASES + 1)
+
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+#ifndef MAXIMUM_WAIT_OBJECTS
+#error MAXIMUM_WAIT_OBJECTS must come from windows.h before OS_FREERTOS_TIMEBASE_EXTERNAL is checked
+#endif
+#if OS_TIMEBASE_EXT_WAIT_HANDLES > MAXIMUM_WAIT_OBJECTS
+#error OS_FREERTOS_TIMEBASE_EXTERNAL supports at most MAXIMUM_WAIT_OBJECTS - 1 (63) in OS_MAX_TIMEBASES
+#endif
+#endif
+
+/* ext_state of a timebase created with OS_TimeBaseCreateExternal */
+#define OS_TIMEBASE_EXT_IDLE		0
+#define OS_TIMEBASE_EXT_ACTIVE		1	/* the external thread watches the source */
+#define OS_TIMEBASE_EXT_CLOSING		2	/* the external thread is to close the source */
+
+#ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+#define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION	0x00000002
+#endif
+
 /****************************************************************************************
  LOCAL TYPEDEFS
  ****************************************************************************************/
@@ -70,7 +107,53 @@ typedef struct
 	TaskHandle_t         		handler_task;
     uint8						simulate_flag;
     uint8		        	    reset_flag;
+    TickType_t					start_ticks;		/* requested by OS_TimeBaseSet_Impl */
     TickType_t					interval_ticks;
+    uint8						reload_pending;		/* timer daemon only: next expiry switches to reload_ticks */
+    TickType_t					reload_ticks;		/* timer daemon only */
+    uint64						start_ns;			/* nominal start time and interval, for the statistics */
+    uint64						interval_ns;
+    uint64						callback_start_ns;	/* servicing task only: when the callbacks were released, 0 = not yet */
+    uint64						callback_budget_ns;	/* servicing task only: time until the next expiry is due */
+    volatile uint32				dropped_count;		/* expiries lost because the previous one was not taken yet */
+    uint32						overrun_count;
+    uint32						last_callback_usec;
+    uint32						max_callback_usec;
+#ifdef OS_FREERTOS_TIMEBASE_HIRES
+    volatile LONG				hires_seq;			/* odd while OS_TimeBaseSet_Impl updates the request */
+    volatile uint64				hires_due;			/* requested first expiry, monotonic nsec, 0 = stopped */
+    volatile uint64				hires_period;		/* requested interval, nsec */
+    volatile uint8				hires_armed;		/* checked by the interrupt handler */
+    LONG						hires_seen_seq;		/* timer thread only */
+    uint64						hires_next;			/* timer thread only: next expiry, 0 = stopped */
+    uint64						hires_step;			/* timer thread only */
+#endif
+#ifdef OS_FREERTOS_TIMEBASE_STATS
+    uint64						expected_ns;		/* nominal time of the expiry being waited for */
+    uint8						stats_restart;		/* set by OS_TimeBaseSet_Impl */
+    uint64						set_ns;				/* time of the last OS_TimeBaseSet_Impl */
+    volatile uint32				coalesced_pending;	/* expiries merged since the last wake up */
+    uint32						expiry_count;
+    uint32						coalesced_count;
+    int32						min_latency;		/* usec */
+    int32						max_latency;		/* usec */
+    int64						total_latency;		/* usec */
+    uint32						histogram[OS_TIMEBASE_LATENCY_BINS];
+#endif
+#ifdef OS_FREERTOS_TIMEBASE_DISPATCH
+    uint8						armed;				/* on the dispatch list */
+    TickType_t					expiry;				/* tick count of the next expiry */
+    int32						next_armed;			/* next local id on the dispatch list, -1 at the end */
+#endif
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+    uint8						external_flag;		/* created with OS_TimeBaseCreateExternal */
+    volatile LONG				ext_state;			/* OS_TIMEBASE_EXT_xxx */
+    HANDLE						ext_handle;			/* event or file mapping of the source */
+    volatile LONG				*ext_counter;		/* mapped tick counter, NULL for an event */
+    LONG						ext_seen;			/* external thread only: counter value accounted for */
+    volatile LONG				ext_ticks;			/* ticks not yet taken by the servicing task */
+    uint32						ext_tick_usec;
+#endif
 } OS_impl_timebase_internal_record_t;
 
 /****************************************************************************************
@@ -79,9 +162,39 @@ typedef struct
 
 OS_impl_timebase_internal_record_t OS_impl_timebase_table[OS_MAX_TIMEBASES];
 
+#ifdef OS_FREERTOS_TIMEBASE_DISPATCH
+/* Armed timebases in expiry order, protected by suspending the scheduler */
+static int32        OS_timebase_dispatch_head = -1;
+static TaskHandle_t OS_timebase_dispatch_task = NULL;
+#endif
+
+#ifdef OS_FREERTOS_TIMEBASE_HIRES
+/* Timebases with an expiry for the interrupt handler to release, one bit each */
+static volatile LONG OS_timebase_hires_pending[(OS_MAX_TIMEBASES + 31) / 32];
+static HANDLE        OS_timebase_hires_thread = NULL;
+static HANDLE        OS_timebase_hires_event = NULL;
+static HANDLE        OS_timebase_hires_timer = NULL;
+#endif
+
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+/* Timebases with ticks for the interrupt handler to release, one bit each */
+static volatile LONG     OS_timebase_external_pending[(OS_MAX_TIMEBASES + 31) / 32];
+static HANDLE            OS_timebase_external_thread = NULL;
+static HANDLE            OS_timebase_external_wake = NULL;
+
+/* Source handed from OS_TimeBaseCreateExternal to OS_TimeBaseCreate_Impl */
+static SemaphoreHandle_t OS_timebase_external_mutex = NULL;
+static HANDLE            OS_timebase_external_source = NULL;
+static volatile LONG     *OS_timebase_external_view = NULL;
+static uint32            OS_timebase_external_tick_usec = 0;
+#endif
+
 static int32 adjust_seconds = 0;
 static int32 adjust_microseconds = 0;
 
+/* Called for every overrun of a timebase or a periodic task, see OS_OverrunHookSet */
+static OS_overrun_hook_t OS_timebase_overrun_hook = NULL;
+
 /*----------------------------------------------------------------
  *
  * Function: OS_TimeBaseLock_Impl
@@ -108,16 +221,103 @@ void OS_TimeBaseUnlock_Impl(uint32 local_id)
 	xSemaphoreGive(OS_impl_timebase_table[local_id].handler_mutex);
 } /* end OS_TimeBaseUnlock_Impl */
 
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_Release
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Releases the servicing task of a simulated timebase for one
+ *           expiry.  If the previous expiry has not been taken yet the two
+ *           are merged, which is counted when statistics are kept.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_Release(OS_impl_timebase_internal_record_t *local)
+{
+	if(xSemaphoreGive(local->tick_sem) != pdPASS)
+	{
+		++local->dropped_count;
+#ifdef OS_FREERTOS_TIMEBASE_STATS
+		++local->coalesced_pending;
+#endif
+	}
+} /* end OS_TimeBase_Release */
+
+#ifdef OS_FREERTOS_TIMEBASE_STATS
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_StatsWake
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Accounts the wake up of the servicing task against the nominal
+ *           expiry time, then moves on to the next nominal expiry.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_StatsWake(OS_impl_timebase_internal_record_t *local, uint64 now)
+{
+	uint32 coalesced;
+	int64 latency;
+	uint32 bin;
+
+	taskENTER_CRITICAL();
+	coalesced = local->coalesced_pending;
+	local->coalesced_pending = 0;
+	taskEXIT_CRITICAL();
+
+	if(local->stats_restart)
+	{
+		local->stats_restart = 0;
+		local->expiry_count = 0;
+		local->coalesced_count = 0;
+		local->total_latency = 0;
+		memset(local->histogram, 0, sizeof(local->histogram));
+		local->expected_ns = local->set_ns + local->start_ns;
+		local->expected_ns += (uint64)coalesced * local->interval_ns;
+	}
+	else
+	{
+		/* Merged expiries were never seen, so skip over their nominal times */
+		local->expected_ns += (uint64)(coalesced + 1) * local->interval_ns;
+	}
+
+	latency = ((int64)now - (int64)local->expected_ns) / 1000;
+	if(local->expiry_count == 0 || latency < local->min_latency)
+	{
+		local->min_latency = (int32)latency;
+	}
+	if(local->expiry_count == 0 || latency > local->max_latency)
+	{
+		local->max_latency = (int32)latency;
+	}
+
+	bin = 0;
+	while(latency >= 1 && bin < OS_TIMEBASE_LATENCY_BINS - 1)
+	{
+		latency >>= 1;
+		++bin;
+	}
+	++local->histogram[bin];
+
+	local->total_latency += ((int64)now - (int64)local->expected_ns) / 1000;
+	local->coalesced_count += coalesced;
+	++local->expiry_count;
+} /* end OS_TimeBase_StatsWake */
+#endif
+
 /*----------------------------------------------------------------
  *
  * Function: OS_Callback
  *
  *  Purpose: Local helper routine, not part of OSAL API.
  *
+ *           Runs in the timer service task.  Simulated timebases use
+ *           auto-reload timers, so the kernel re-arms the timer relative
+ *           to its previous expiry and there is no drift from period to
+ *           period.  The timer only needs reprogramming once, when the
+ *           start time has expired and the interval takes over.
+ *
  *-----------------------------------------------------------------*/
 void OS_Callback(TimerHandle_t xTimer)
 {
-	BaseType_t status;
 	/* Find the id of the timer */
 	uint32 local_id;
 	OS_impl_timebase_internal_record_t *local;
@@ -125,28 +325,633 @@ void OS_Callback(TimerHandle_t xTimer)
 	{
 		local = &OS_impl_timebase_table[local_id];
 
-		/*
-		 * Reset the timer, but only if an interval was selected
-		 */
-		if(local->interval_ticks > 0)
-		{
-			status = xTimerChangePeriod(local->host_timer_id, local->interval_ticks, portMAX_DELAY);
-			if(status == pdPASS)
-			{
-				xTimerStart(local->host_timer_id, portMAX_DELAY);
-			}
-		}
+		if(local->reload_pending)
+		{
+			local->reload_pending = 0;
+
+			/*
+			 * This is the timer service task, so it must not block on its own
+			 * command queue.
+			 */
+			if(local->reload_ticks > 0)
+			{
+				xTimerChangePeriod(local->host_timer_id, local->reload_ticks, 0);
+			}
+			else
+			{
+				xTimerStop(local->host_timer_id, 0);
+			}
+		}
+
+		/*
+		 * FreeRTOS OS timers implemented with an ISR callback
+		 * this must be downgraded to an ordinary task context
+		 *
+		 * This is accomplished by just releasing a semaphore here.
+		 */
+		OS_TimeBase_Release(local);
+	}
+
+} /* end OS_Callback */
+
+#if !defined(OS_FREERTOS_TIMEBASE_DISPATCH) && !defined(OS_FREERTOS_TIMEBASE_HIRES)
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_Program
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Applies the times set by OS_TimeBaseSet_Impl to the timer.
+ *
+ *           This is pended to the timer service task, so it is serialized
+ *           with OS_Callback and an expiry of the old setting can never
+ *           consume the reprogramming meant for the new one.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_Program(void *unused, uint32_t local_id)
+{
+	OS_impl_timebase_internal_record_t *local = &OS_impl_timebase_table[local_id];
+	BaseType_t status;
+
+	if(local->start_ticks == 0)
+	{
+		local->reload_pending = 0;
+		status = xTimerStop(local->host_timer_id, 0);
+	}
+	else
+	{
+		local->reload_ticks = local->interval_ticks;
+		local->reload_pending = (local->interval_ticks != local->start_ticks);
+		status = xTimerChangePeriod(local->host_timer_id, local->start_ticks, 0);
+	}
+
+	if(status != pdPASS)
+	{
+		OS_DEBUG("OS_TimeBase_Program: timer command queue full\n");
+	}
+} /* end OS_TimeBase_Program */
+#endif
+
+#ifdef OS_FREERTOS_TIMEBASE_DISPATCH
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_DispatchRemove
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes a timebase off the dispatch list.
+ *           Must be called with the scheduler suspended.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_DispatchRemove(uint32 local_id)
+{
+	int32 *link = &OS_timebase_dispatch_head;
+
+	if(!OS_impl_timebase_table[local_id].armed)
+	{
+		return;
+	}
+
+	while(*link >= 0 && *link != (int32)local_id)
+	{
+		link = &OS_impl_timebase_table[*link].next_armed;
+	}
+
+	if(*link >= 0)
+	{
+		*link = OS_impl_timebase_table[local_id].next_armed;
+	}
+
+	OS_impl_timebase_table[local_id].armed = 0;
+} /* end OS_TimeBase_DispatchRemove */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_DispatchInsert
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Puts a timebase on the dispatch list in expiry order, after any
+ *           timebase due at the same tick so equal periods keep their order.
+ *           Must be called with the scheduler suspended.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_DispatchInsert(uint32 local_id, TickType_t now)
+{
+	OS_impl_timebase_internal_record_t *local = &OS_impl_timebase_table[local_id];
+	int32 *link = &OS_timebase_dispatch_head;
+
+	/* Compare times relative to now so the tick count may wrap */
+	while(*link >= 0 &&
+		  (OS_impl_timebase_table[*link].expiry - now) <= (local->expiry - now))
+	{
+		link = &OS_impl_timebase_table[*link].next_armed;
+	}
+
+	local->next_armed = *link;
+	*link = (int32)local_id;
+	local->armed = 1;
+} /* end OS_TimeBase_DispatchInsert */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_DispatchTask
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Releases the servicing task of every simulated timebase as it
+ *           falls due.  OS_TimeBaseSet_Impl notifies this task whenever it
+ *           changes the list, so the sleep is recomputed.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_DispatchTask(void *unused)
+{
+	OS_impl_timebase_internal_record_t *local;
+	TickType_t now;
+	TickType_t wait;
+	TickType_t skipped;
+	int32 local_id;
+
+	while(1)
+	{
+		vTaskSuspendAll();
+		now = xTaskGetTickCount();
+		while(OS_timebase_dispatch_head >= 0 &&
+			  (TickType_t)(now - OS_impl_timebase_table[OS_timebase_dispatch_head].expiry) < (portMAX_DELAY / 2))
+		{
+			local_id = OS_timebase_dispatch_head;
+			local = &OS_impl_timebase_table[local_id];
+
+			OS_timebase_dispatch_head = local->next_armed;
+			local->armed = 0;
+
+			/* Reload from the previous expiry, not from now, so periods do not drift */
+			if(local->interval_ticks > 0)
+			{
+				local->expiry += local->interval_ticks;
+
+				/*
+				 * Serviced more than a period late, the next expiry is already past.
+				 * It would sort behind every other timebase, so skip the periods
+				 * that were missed and merge them into this expiry.
+				 */
+				if((TickType_t)(now - local->expiry) < (portMAX_DELAY / 2))
+				{
+					skipped = (now - local->expiry) / local->interval_ticks + 1;
+					local->expiry += skipped * local->interval_ticks;
+					local->dropped_count += skipped;
+#ifdef OS_FREERTOS_TIMEBASE_STATS
+					local->coalesced_pending += skipped;
+#endif
+				}
+
+				OS_TimeBase_DispatchInsert(local_id, now);
+			}
+
+			OS_TimeBase_Release(local);
+		}
+
+		wait = portMAX_DELAY;
+		if(OS_timebase_dispatch_head >= 0)
+		{
+			wait = OS_impl_timebase_table[OS_timebase_dispatch_head].expiry - now;
+		}
+		xTaskResumeAll();
+
+		ulTaskNotifyTake(pdTRUE, wait);
+	}
+} /* end OS_TimeBase_DispatchTask */
+#endif
+
+#ifdef OS_FREERTOS_TIMEBASE_HIRES
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_HiresInterrupt
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Simulated interrupt raised by the high resolution timer thread.
+ *           Releases the servicing task of every timebase it flagged.
+ *
+ *-----------------------------------------------------------------*/
+static uint32_t OS_TimeBase_HiresInterrupt(void)
+{
+	OS_impl_timebase_internal_record_t *local;
+	BaseType_t woken = pdFALSE;
+	LONG bits;
+	uint32 word;
+	uint32 bit;
+
+	for(word = 0; word < (OS_MAX_TIMEBASES + 31) / 32; word++)
+	{
+		bits = InterlockedExchange(&OS_timebase_hires_pending[word], 0);
+		for(bit = 0; bits != 0; bit++, bits = (LONG)((ULONG)bits >> 1))
+		{
+			if((bits & 1) == 0)
+			{
+				continue;
+			}
+
+			local = &OS_impl_timebase_table[word * 32 + bit];
+			if(local->hires_armed && xSemaphoreGiveFromISR(local->tick_sem, &woken) != pdPASS)
+			{
+				++local->dropped_count;
+#ifdef OS_FREERTOS_TIMEBASE_STATS
+				++local->coalesced_pending;
+#endif
+			}
+		}
+	}
+
+	return (uint32_t)woken;
+} /* end OS_TimeBase_HiresInterrupt */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_HiresRead
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Picks up a new request from OS_TimeBaseSet_Impl, if there is one.
+ *           The request is guarded by a sequence count rather than a lock,
+ *           since a FreeRTOS task must not hold a Win32 lock this thread
+ *           could wait on.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_HiresRead(OS_impl_timebase_internal_record_t *local)
+{
+	LONG seq;
+	uint64 due;
+	uint64 period;
+
+	do
+	{
+		seq = InterlockedCompareExchange(&local->hires_seq, 0, 0);
+		if(seq == local->hires_seen_seq || (seq & 1) != 0)
+		{
+			return;
+		}
+		due = local->hires_due;
+		period = local->hires_period;
+	}
+	while(InterlockedCompareExchange(&local->hires_seq, 0, 0) != seq);
+
+	local->hires_seen_seq = seq;
+	local->hires_next = due;
+	local->hires_step = period;
+} /* end OS_TimeBase_HiresRead */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_HiresThread
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Win32 thread, outside of FreeRTOS, that times every simulated
+ *           timebase on the performance counter.  It sleeps on a high
+ *           resolution waitable timer until shortly before the next expiry,
+ *           spins for the rest and raises the simulated interrupt.
+ *
+ *           It only runs once a timebase has been set, by which time the
+ *           scheduler is up and OS_GetMonotonicNsec reads the performance
+ *           counter without entering the kernel.
+ *
+ *-----------------------------------------------------------------*/
+static DWORD WINAPI OS_TimeBase_HiresThread(LPVOID unused)
+{
+	OS_impl_timebase_internal_record_t *local;
+	HANDLE handles[2];
+	LARGE_INTEGER due_time;
+	uint64 now;
+	uint64 next;
+	uint32 local_id;
+	BOOL fire;
+
+	handles[0] = OS_timebase_hires_event;
+	handles[1] = OS_timebase_hires_timer;
+
+	while(1)
+	{
+		now = OS_GetMonotonicNsec();
+		next = 0;
+		fire = FALSE;
+
+		for(local_id = 0; local_id < OS_MAX_TIMEBASES; local_id++)
+		{
+			local = &OS_impl_timebase_table[local_id];
+			OS_TimeBase_HiresRead(local);
+
+			if(local->hires_next == 0)
+			{
+				continue;
+			}
+
+			if(local->hires_next <= now)
+			{
+				InterlockedOr(&OS_timebase_hires_pending[local_id / 32], (LONG)(1UL << (local_id % 32)));
+				fire = TRUE;
+
+				/* A late expiry is still signalled; the next one follows straight away */
+				local->hires_next = (local->hires_step > 0) ? local->hires_next + local->hires_step : 0;
+				if(local->hires_next == 0)
+				{
+					continue;
+				}
+			}
+
+			if(next == 0 || local->hires_next < next)
+			{
+				next = local->hires_next;
+			}
+		}
+
+		if(fire)
+		{
+			vPortGenerateSimulatedInterrupt(OS_FREERTOS_TIMEBASE_HIRES_INTERRUPT);
+		}
+
+		now = OS_GetMonotonicNsec();
+		if(next == 0)
+		{
+			WaitForSingleObject(OS_timebase_hires_event, INFINITE);
+		}
+		else if(next > now + OS_FREERTOS_TIMEBASE_HIRES_SPIN_USEC * 1000ULL)
+		{
+			/* Relative due time, in 100 nsec units */
+			due_time.QuadPart = -(LONGLONG)((next - now - OS_FREERTOS_TIMEBASE_HIRES_SPIN_USEC * 1000ULL) / 100);
+			SetWaitableTimer(OS_timebase_hires_timer, &due_time, 0, NULL, NULL, FALSE);
+			WaitForMultipleObjects(2, handles, FALSE, INFINITE);
+		}
+		else
+		{
+			while(OS_GetMonotonicNsec() < next &&
+				  WaitForSingleObject(OS_timebase_hires_event, 0) == WAIT_TIMEOUT)
+			{
+				YieldProcessor();
+			}
+		}
+	}
+
+	return 0;
+} /* end OS_TimeBase_HiresThread */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_HiresRequest
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Hands a new first expiry (monotonic nsec, 0 to stop) and interval
+ *           to the high resolution timer thread.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_HiresRequest(uint32 local_id, uint64 due, uint64 period)
+{
+	OS_impl_timebase_internal_record_t *local = &OS_impl_timebase_table[local_id];
+
+	InterlockedIncrement(&local->hires_seq);
+	local->hires_due = due;
+	local->hires_period = period;
+	InterlockedIncrement(&local->hires_seq);
+
+	/* Drop an expiry of the old setting that has not been handled yet */
+	taskENTER_CRITICAL();
+	local->hires_armed = (due != 0);
+	InterlockedAnd(&OS_timebase_hires_pending[local_id / 32], ~(LONG)(1UL << (local_id % 32)));
+	taskEXIT_CRITICAL();
+
+	SetEvent(OS_timebase_hires_event);
+} /* end OS_TimeBase_HiresRequest */
+#endif
+
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_ExternalInterrupt
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Simulated interrupt raised by the external tick thread.
+ *           Releases the servicing task of every timebase it flagged.  The
+ *           ticks themselves are counted in ext_ticks, so none is lost when
+ *           the task has not taken the previous release yet.
+ *
+ *-----------------------------------------------------------------*/
+static uint32_t OS_TimeBase_ExternalInterrupt(void)
+{
+	OS_impl_timebase_internal_record_t *local;
+	BaseType_t woken = pdFALSE;
+	LONG bits;
+	uint32 word;
+	uint32 bit;
+
+	for(word = 0; word < (OS_MAX_TIMEBASES + 31) / 32; word++)
+	{
+		bits = InterlockedExchange(&OS_timebase_external_pending[word], 0);
+		for(bit = 0; bits != 0; bit++, bits = (LONG)((ULONG)bits >> 1))
+		{
+			if((bits & 1) == 0)
+			{
+				continue;
+			}
+
+			local = &OS_impl_timebase_table[word * 32 + bit];
+			if(local->ext_state == OS_TIMEBASE_EXT_ACTIVE)
+			{
+				xSemaphoreGiveFromISR(local->tick_sem, &woken);
+			}
+		}
+	}
+
+	return (uint32_t)woken;
+} /* end OS_TimeBase_ExternalInterrupt */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_ExternalTick
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Runs in the external tick thread.  Adds ticks of a source to
+ *           its timebase and flags it for the interrupt handler.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_ExternalTick(uint32 local_id, LONG ticks)
+{
+	InterlockedExchangeAdd(&OS_impl_timebase_table[local_id].ext_ticks, ticks);
+	InterlockedOr(&OS_timebase_external_pending[local_id / 32], (LONG)(1UL << (local_id % 32)));
+} /* end OS_TimeBase_ExternalTick */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_ExternalThread
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Win32 thread, outside of FreeRTOS, that waits on the event of
+ *           every event driven timebase and reads the shared counter of
+ *           every counter driven one, each OS_FREERTOS_TIMEBASE_EXTERNAL_POLL_MSEC
+ *           while there are any.  A servicing task must not block in a
+ *           Win32 wait itself, since that would stall the simulated kernel.
+ *
+ *           The thread owns the sources once they are active and closes
+ *           them when OS_TimeBase_ExternalDetach asks it to, so a handle is
+ *           never closed while it waits on it.
+ *
+ *-----------------------------------------------------------------*/
+static DWORD WINAPI OS_TimeBase_ExternalThread(LPVOID unused)
+{
+	OS_impl_timebase_internal_record_t *local;
+	HANDLE handles[OS_TIMEBASE_EXT_WAIT_HANDLES];
+	uint32 ids[OS_TIMEBASE_EXT_WAIT_HANDLES];
+	DWORD count;
+	DWORD result;
+	uint32 local_id;
+	LONG counter;
+	LONG delta;
+	BOOL poll;
+	BOOL fire;
+
+	while(1)
+	{
+		handles[0] = OS_timebase_external_wake;
+		count = 1;
+		poll = FALSE;
+		fire = FALSE;
+
+		for(local_id = 0; local_id < OS_MAX_TIMEBASES; local_id++)
+		{
+			local = &OS_impl_timebase_table[local_id];
+
+			switch(InterlockedCompareExchange(&local->ext_state, 0, 0))
+			{
+			case OS_TIMEBASE_EXT_CLOSING:
+				if(local->ext_counter != NULL)
+				{
+					UnmapViewOfFile((LPCVOID)local->ext_counter);
+					local->ext_counter = NULL;
+				}
+				CloseHandle(local->ext_handle);
+				local->ext_handle = NULL;
+				InterlockedExchange(&local->ext_state, OS_TIMEBASE_EXT_IDLE);
+				break;
+
+			case OS_TIMEBASE_EXT_ACTIVE:
+				if(local->ext_counter == NULL)
+				{
+					handles[count] = local->ext_handle;
+					ids[count] = local_id;
+					++count;
+					break;
+				}
+
+				/* Mapped read only, so a plain aligned read rather than an interlocked one */
+				counter = *local->ext_counter;
+				delta = (LONG)((ULONG)counter - (ULONG)local->ext_seen);
+				local->ext_seen = counter;
+
+				/* A counter that went back was restarted by the driver: resync only */
+				if(delta > 0)
+				{
+					OS_TimeBase_ExternalTick(local_id, delta);
+					fire = TRUE;
+				}
+				poll = TRUE;
+				break;
+
+			default:
+				break;
+			}
+		}
+
+		if(fire)
+		{
+			vPortGenerateSimulatedInterrupt(OS_FREERTOS_TIMEBASE_EXTERNAL_INTERRUPT);
+		}
+
+		result = WaitForMultipleObjects(count, handles, FALSE,
+				poll ? OS_FREERTOS_TIMEBASE_EXTERNAL_POLL_MSEC : INFINITE);
+		if(result > WAIT_OBJECT_0 && result < WAIT_OBJECT_0 + count)
+		{
+			OS_TimeBase_ExternalTick(ids[result - WAIT_OBJECT_0], 1);
+			vPortGenerateSimulatedInterrupt(OS_FREERTOS_TIMEBASE_EXTERNAL_INTERRUPT);
+		}
+	}
+
+	return 0;
+} /* end OS_TimeBase_ExternalThread */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_ExternalDetach
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Has the external tick thread close the source of a timebase
+ *           and waits until it has.  The thread only waits on the wake up
+ *           event in between, so this takes a tick or so.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_ExternalDetach(uint32 local_id)
+{
+	OS_impl_timebase_internal_record_t *local = &OS_impl_timebase_table[local_id];
+
+	taskENTER_CRITICAL();
+	InterlockedExchange(&local->ext_state, OS_TIMEBASE_EXT_CLOSING);
+	InterlockedAnd(&OS_timebase_external_pending[local_id / 32], ~(LONG)(1UL << (local_id % 32)));
+	taskEXIT_CRITICAL();
+
+	SetEvent(OS_timebase_external_wake);
+	while(InterlockedCompareExchange(&local->ext_state, 0, 0) != OS_TIMEBASE_EXT_IDLE)
+	{
+		vTaskDelay(1);
+	}
+} /* end OS_TimeBase_ExternalDetach */
+#endif
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_OverrunReport
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Passes an overrun of a timebase or periodic task to the hook
+ *           set with OS_OverrunHookSet, if there is one.
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_OverrunReport(uint32 object_id, uint32 elapsed_usec, uint32 period_usec)
+{
+	OS_overrun_hook_t hook = OS_timebase_overrun_hook;
+
+	if(hook != NULL)
+	{
+		hook(object_id, elapsed_usec, period_usec);
+	}
+} /* end OS_FreeRTOS_OverrunReport */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_MonitorCallbacks
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Accounts the time the callbacks of the previous expiry took,
+ *           from the servicing task being released until it comes back to
+ *           wait.  Callbacks still running when the next expiry is due are
+ *           an overrun: that expiry is serviced late, and dropped when a
+ *           further one falls due meanwhile.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_TimeBase_MonitorCallbacks(uint32 local_id, uint64 now)
+{
+	OS_impl_timebase_internal_record_t *local = &OS_impl_timebase_table[local_id];
+	uint64 elapsed;
+
+	if(local->callback_start_ns == 0)
+	{
+		return;
+	}
 
-		/*
-		 * FreeRTOS OS timers implemented with an ISR callback
-		 * this must be downgraded to an ordinary task context
-		 *
-		 * This is accomplished by just releasing a semaphore here.
-		 */
-		xSemaphoreGive(local->tick_sem);
+	elapsed = now - local->callback_start_ns;
+	local->last_callback_usec = (uint32)(elapsed / 1000);
+	if(local->last_callback_usec > local->max_callback_usec)
+	{
+		local->max_callback_usec = local->last_callback_usec;
 	}
 
-} /* end OS_Callback */
+	if(local->callback_budget_ns != 0 && elapsed > local->callback_budget_ns)
+	{
+		++local->overrun_count;
+		OS_FreeRTOS_OverrunReport(OS_global_timebase_table[local_id].active_id,
+				local->last_callback_usec, (uint32)(local->callback_budget_ns / 1000));
+	}
+} /* end OS_TimeBase_MonitorCallbacks */
 
 /*----------------------------------------------------------------
  *
@@ -160,9 +965,12 @@ static uint32 OS_TimeBase_WaitImpl(uint32 local_id)
 {
     OS_impl_timebase_internal_record_t *local;
     uint32 interval_time;
+    uint64 now;
 
     local = &OS_impl_timebase_table[local_id];
 
+    OS_TimeBase_MonitorCallbacks(local_id, OS_GetMonotonicNsec());
+
     /*
      * Determine how long this tick was.
      * Note that there are plenty of ways this become wrong if the timer
@@ -184,10 +992,126 @@ static uint32 OS_TimeBase_WaitImpl(uint32 local_id)
      * Pend for the tick arrival
      */
     xSemaphoreTake(local->tick_sem, portMAX_DELAY);
+    now = OS_GetMonotonicNsec();
+
+#ifdef OS_FREERTOS_TIMEBASE_STATS
+    OS_TimeBase_StatsWake(local, now);
+#endif
+
+    /* The callbacks of this expiry have until the next one is due */
+    local->callback_start_ns = now;
+    local->callback_budget_ns = (uint64)OS_timebase_table[local_id].nominal_interval_time * 1000;
 
     return interval_time;
 } /* end OS_TimeBase_WaitImpl */
 
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_ExternalWait
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Sync function of the timebases of OS_TimeBaseCreateExternal.
+ *           Pends until the source ticked and returns the time of all the
+ *           ticks since the previous call.
+ *
+ *-----------------------------------------------------------------*/
+static uint32 OS_TimeBase_ExternalWait(uint32 local_id)
+{
+    OS_impl_timebase_internal_record_t *local;
+    LONG ticks;
+    uint64 now;
+
+    local = &OS_impl_timebase_table[local_id];
+
+    OS_TimeBase_MonitorCallbacks(local_id, OS_GetMonotonicNsec());
+
+    /* A release can be left over from ticks the previous call already took */
+    do
+    {
+        xSemaphoreTake(local->tick_sem, portMAX_DELAY);
+        ticks = InterlockedExchange(&local->ext_ticks, 0);
+    }
+    while(ticks <= 0);
+
+    /* Ticks that came in before the previous callbacks were done are merged */
+    local->dropped_count += (uint32)(ticks - 1);
+#ifdef OS_FREERTOS_TIMEBASE_STATS
+    ++local->expiry_count;
+    local->coalesced_count += (uint32)(ticks - 1);
+#endif
+
+    now = OS_GetMonotonicNsec();
+    local->callback_start_ns = now;
+    local->callback_budget_ns = (uint64)local->ext_tick_usec * 1000;
+
+    return (uint32)ticks * local->ext_tick_usec;
+} /* end OS_TimeBase_ExternalWait */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBase_ExternalAttach
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes over the source handed over by OS_TimeBaseCreateExternal
+ *           and has the external tick thread watch it.
+ *
+ *-----------------------------------------------------------------*/
+static int32 OS_TimeBase_ExternalAttach(uint32 local_id)
+{
+	OS_impl_timebase_internal_record_t *local = &OS_impl_timebase_table[local_id];
+
+	local->tick_sem = xSemaphoreCreateBinary();
+	local->handler_mutex = xSemaphoreCreateMutex();
+	if(local->tick_sem == NULL || local->handler_mutex == NULL)
+	{
+		if(local->tick_sem != NULL)
+		{
+			vSemaphoreDelete(local->tick_sem);
+		}
+		if(local->handler_mutex != NULL)
+		{
+			vSemaphoreDelete(local->handler_mutex);
+		}
+		return OS_TIMER_ERR_INTERNAL;
+	}
+
+	local->host_timer_id = NULL;
+	local->callback_start_ns = 0;
+	local->callback_budget_ns = 0;
+	local->dropped_count = 0;
+	local->overrun_count = 0;
+	local->last_callback_usec = 0;
+	local->max_callback_usec = 0;
+#ifdef OS_FREERTOS_TIMEBASE_STATS
+	/* There is no nominal expiry time, so the latency fields stay 0 */
+	local->stats_restart = 0;
+	local->expiry_count = 0;
+	local->coalesced_count = 0;
+	local->min_latency = 0;
+	local->max_latency = 0;
+	local->total_latency = 0;
+	memset(local->histogram, 0, sizeof(local->histogram));
+#endif
+
+	local->ext_handle = OS_timebase_external_source;
+	local->ext_counter = OS_timebase_external_view;
+	local->ext_seen = (local->ext_counter != NULL) ? *local->ext_counter : 0;
+	local->ext_ticks = 0;
+	local->ext_tick_usec = OS_timebase_external_tick_usec;
+	OS_timebase_table[local_id].accuracy_usec = local->ext_tick_usec;
+
+	/* The source belongs to the timebase from here on */
+	OS_timebase_external_source = NULL;
+	OS_timebase_external_view = NULL;
+
+	InterlockedExchange(&local->ext_state, OS_TIMEBASE_EXT_ACTIVE);
+	SetEvent(OS_timebase_external_wake);
+
+	return OS_SUCCESS;
+} /* end OS_TimeBase_ExternalAttach */
+#endif
+
 /****************************************************************************************
  INITIALIZATION FUNCTION
  ***************************************************************************************/
@@ -227,6 +1151,66 @@ int32 OS_FreeRTOS_TimeBaseAPI_Impl_Init(void)
 	*/
 	OS_SharedGlobalVars.MicroSecPerTick = (FreeRTOS_GlobalVars.ClockAccuracyNsec + 500) / 1000;
 
+#ifdef OS_FREERTOS_TIMEBASE_DISPATCH
+	if(OS_timebase_dispatch_task == NULL &&
+	   xTaskCreate(OS_TimeBase_DispatchTask,
+				   "OS_TimeBaseDispatch",
+				   OSAL_TIMEBASE_DISPATCH_STACK_SIZE,
+				   NULL,
+				   OSAL_TIMEBASE_DISPATCH_PRIORITY,
+				   &OS_timebase_dispatch_task) != pdPASS)
+	{
+		return OS_ERROR;
+	}
+#endif
+
+#ifdef OS_FREERTOS_TIMEBASE_HIRES
+	if(OS_timebase_hires_thread == NULL)
+	{
+		OS_timebase_hires_event = CreateEvent(NULL, FALSE, FALSE, NULL);
+		OS_timebase_hires_timer = CreateWaitableTimerExW(NULL, NULL, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+		if(OS_timebase_hires_timer == NULL)
+		{
+			/* Older hosts: plain waitable timer, the spin covers the difference */
+			OS_timebase_hires_timer = CreateWaitableTimer(NULL, FALSE, NULL);
+		}
+		if(OS_timebase_hires_event == NULL || OS_timebase_hires_timer == NULL)
+		{
+			return OS_ERROR;
+		}
+
+		vPortSetInterruptHandler(OS_FREERTOS_TIMEBASE_HIRES_INTERRUPT, OS_TimeBase_HiresInterrupt);
+
+		OS_timebase_hires_thread = CreateThread(NULL, 0, OS_TimeBase_HiresThread, NULL, 0, NULL);
+		if(OS_timebase_hires_thread == NULL)
+		{
+			return OS_ERROR;
+		}
+		SetThreadPriority(OS_timebase_hires_thread, THREAD_PRIORITY_TIME_CRITICAL);
+	}
+#endif
+
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+	if(OS_timebase_external_thread == NULL)
+	{
+		OS_timebase_external_mutex = xSemaphoreCreateMutex();
+		OS_timebase_external_wake = CreateEvent(NULL, FALSE, FALSE, NULL);
+		if(OS_timebase_external_mutex == NULL || OS_timebase_external_wake == NULL)
+		{
+			return OS_ERROR;
+		}
+
+		vPortSetInterruptHandler(OS_FREERTOS_TIMEBASE_EXTERNAL_INTERRUPT, OS_TimeBase_ExternalInterrupt);
+
+		OS_timebase_external_thread = CreateThread(NULL, 0, OS_TimeBase_ExternalThread, NULL, 0, NULL);
+		if(OS_timebase_external_thread == NULL)
+		{
+			return OS_ERROR;
+		}
+		SetThreadPriority(OS_timebase_external_thread, THREAD_PRIORITY_TIME_CRITICAL);
+	}
+#endif
+
 	return OS_SUCCESS;
 } /* end OS_FreeRTOS_TimeBaseAPI_Impl_Init */
 
@@ -270,30 +1254,33 @@ void  OS_UsecsToTicks(uint32 usecs, TickType_t *ticks)
  *  Purpose:  This function tries to find a Timer Id given the host-specific id
  *             The id is returned through timer_id
  *
+ *            The local id is stored as the FreeRTOS timer ID when the timer
+ *            is created, so this is a constant time lookup no matter how
+ *            many timebases there are.  The table entry is still checked
+ *            in case the timer fires while its timebase is being deleted.
+ *
  *-----------------------------------------------------------------*/
 int32 OS_TimerGetIdByHostId(uint32 *timer_id, TimerHandle_t host_timer_id)
 {
-	uint32 i;
+	uint32 local_id;
 
 	if(timer_id == NULL || host_timer_id == NULL)
 	{
 		return OS_INVALID_POINTER;
 	}
 
-	for(i = 0; i < OS_MAX_TIMEBASES; i++)
+	local_id = (uint32) pvTimerGetTimerID(host_timer_id);
+	if(local_id < OS_MAX_TIMEBASES && OS_impl_timebase_table[local_id].host_timer_id == host_timer_id)
 	{
-		if(OS_impl_timebase_table[i].host_timer_id == host_timer_id)
-		{
-			*timer_id = i;
-			return OS_SUCCESS;
-		}
+		*timer_id = local_id;
+		return OS_SUCCESS;
 	}
 
 	/*
 	 ** The name was not found in the table
 	 */
 	return OS_ERR_NAME_NOT_FOUND;
-}/* end OS_TimerGetIdByName */
+}/* end OS_TimerGetIdByHostId */
 
 /****************************************************************************************
  Time Base API
@@ -313,10 +1300,12 @@ int32 OS_TimeBaseCreate_Impl(uint32 timer_id)
 	OS_impl_timebase_internal_record_t *local;
 	OS_common_record_t *global;
 	char * dummy = "";
+	uint32 heap_category;
 
     return_code = OS_SUCCESS;
     local = &OS_impl_timebase_table[timer_id];
     global = &OS_global_timebase_table[timer_id];
+    heap_category = OS_FreeRTOS_HeapCategorySet(OS_HEAP_CATEGORY_TIMER);
 
     /*
 	 * Set up the necessary OS constructs
@@ -328,6 +1317,18 @@ int32 OS_TimeBaseCreate_Impl(uint32 timer_id)
 	 * timer to locally simulate the timer tick using the CPU clock.
 	 */
 	local->simulate_flag = (OS_timebase_table[timer_id].external_sync == NULL);
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+	/* Sources of OS_TimeBaseCreateExternal are watched by the external tick thread */
+	local->external_flag = (OS_timebase_table[timer_id].external_sync == OS_TimeBase_ExternalWait);
+	if(local->external_flag)
+	{
+		return_code = OS_TimeBase_ExternalAttach(timer_id);
+		if(return_code != OS_SUCCESS)
+		{
+			local->external_flag = 0;
+		}
+	}
+#endif
 	if(local->simulate_flag)
 	{
 		OS_timebase_table[timer_id].external_sync = OS_TimeBase_WaitImpl;
@@ -355,13 +1356,36 @@ int32 OS_TimeBaseCreate_Impl(uint32 timer_id)
 
 		//Set interval_ticks to 1 to start
 		local->interval_ticks = 1;
+		local->start_ticks = 0;
+		local->reload_pending = 0;
+		local->callback_start_ns = 0;
+		local->callback_budget_ns = 0;
+		local->dropped_count = 0;
+		local->overrun_count = 0;
+		local->last_callback_usec = 0;
+		local->max_callback_usec = 0;
+#if defined(OS_FREERTOS_TIMEBASE_DISPATCH)
+		/*
+		 ** The dispatch task generates the ticks, no timer is needed
+		 */
+		local->armed = 0;
+		local->host_timer_id = NULL;
+#elif defined(OS_FREERTOS_TIMEBASE_HIRES)
+		/*
+		 ** The high resolution timer thread generates the ticks
+		 */
+		local->hires_armed = 0;
+		local->hires_next = 0;
+		local->hires_seen_seq = local->hires_seq;
+		local->host_timer_id = NULL;
+#else
 		/*
 		 ** Create an interval timer
 		 */
 		local->host_timer_id = xTimerCreate(dummy,
 									local->interval_ticks,
-									pdFALSE,
-									0,
+									pdTRUE,
+									(void *)timer_id,
 									OS_Callback);
 
 		if(local->host_timer_id == NULL)
@@ -370,6 +1394,7 @@ int32 OS_TimeBaseCreate_Impl(uint32 timer_id)
 			vSemaphoreDelete (local->tick_sem);
 			return_code = OS_TIMER_ERR_UNAVAILABLE;
 		}
+#endif
 	}
 
 	/*
@@ -396,12 +1421,24 @@ int32 OS_TimeBaseCreate_Impl(uint32 timer_id)
 		{
 			return_code = OS_TIMER_ERR_INTERNAL;
 			/* Also delete the resources we allocated earlier */
-			xTimerDelete(local->host_timer_id, portMAX_DELAY);
+			if(local->host_timer_id != NULL)
+			{
+				xTimerDelete(local->host_timer_id, portMAX_DELAY);
+			}
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+			if(local->external_flag)
+			{
+				OS_TimeBase_ExternalDetach(timer_id);
+				local->external_flag = 0;
+			}
+#endif
 			vSemaphoreDelete(local->handler_mutex);
 			vSemaphoreDelete (local->tick_sem);
 		}
 	}
 
+	OS_FreeRTOS_HeapCategorySet(heap_category);
+
 	return return_code;
 } /* end OS_TimeBaseCreate_Impl */
 
@@ -454,30 +1491,69 @@ int32 OS_TimeBaseSet_Impl(uint32 timer_id, int32 start_time, int32 interval_time
 			** Convert from Microseconds to the timeout
 			*/
 			OS_UsecsToTicks(start_time, &start_ticks);
+		}
+		else
+		{
+			start_ticks = 0;
+		}
 
-			status = xTimerChangePeriod(local->host_timer_id, start_ticks, portMAX_DELAY);
-			if(status == pdPASS)
-			{
-				status = xTimerStart(local->host_timer_id, portMAX_DELAY);
-				if(status == pdPASS)
-				{
-					if(local->interval_ticks > 0)
-					{
-					   start_ticks = local->interval_ticks;
-					}
+		local->start_ticks = start_ticks;
+#ifdef OS_FREERTOS_TIMEBASE_HIRES
+		/* Exact times, not rounded to ticks */
+		local->start_ns = (start_time > 0) ? (uint64)start_time * 1000 : 0;
+		local->interval_ns = (interval_time > 0) ? (uint64)interval_time * 1000 : 0;
+#else
+		local->start_ns = (uint64)start_ticks * FreeRTOS_GlobalVars.ClockAccuracyNsec;
+		local->interval_ns = (uint64)local->interval_ticks * FreeRTOS_GlobalVars.ClockAccuracyNsec;
+#endif
+		local->dropped_count = 0;
+		local->overrun_count = 0;
+		local->max_callback_usec = 0;
+#ifdef OS_FREERTOS_TIMEBASE_STATS
+		local->set_ns = OS_GetMonotonicNsec();
+		local->stats_restart = 1;
+		local->coalesced_pending = 0;
+#endif
+#if defined(OS_FREERTOS_TIMEBASE_HIRES)
+		if(start_ticks > 0)
+		{
+			OS_TimeBase_HiresRequest(timer_id, OS_GetMonotonicNsec() + local->start_ns, local->interval_ns);
+		}
+		else
+		{
+			OS_TimeBase_HiresRequest(timer_id, 0, 0);
+		}
+		status = pdPASS;
+#elif defined(OS_FREERTOS_TIMEBASE_DISPATCH)
+		vTaskSuspendAll();
+		OS_TimeBase_DispatchRemove(timer_id);
+		if(start_ticks > 0)
+		{
+			TickType_t now = xTaskGetTickCount();
 
-					OS_timebase_table[timer_id].accuracy_usec = (start_ticks * 100000) / OS_SharedGlobalVars.TicksPerSecond;
-					OS_timebase_table[timer_id].accuracy_usec *= 10;
-				}
-				else
-				{
-					return_code = OS_TIMER_ERR_INTERNAL;
-				}
-			}
-			else
-			{
-				return_code = OS_TIMER_ERR_INTERNAL;
-			}
+			local->expiry = now + start_ticks;
+			OS_TimeBase_DispatchInsert(timer_id, now);
+		}
+		xTaskResumeAll();
+		xTaskNotifyGive(OS_timebase_dispatch_task);
+		status = pdPASS;
+#else
+		status = xTimerPendFunctionCall(OS_TimeBase_Program, NULL, timer_id, portMAX_DELAY);
+#endif
+		if(status != pdPASS)
+		{
+			return_code = OS_TIMER_ERR_INTERNAL;
+		}
+		else if(local->start_ns > 0)
+		{
+			/*
+			 * Report the period actually achieved: the requested interval
+			 * (or start time) rounded to whole ticks, or as requested with
+			 * the high resolution timer.
+			 */
+			uint64 period_ns = (local->interval_ns > 0) ? local->interval_ns : local->start_ns;
+
+			OS_timebase_table[timer_id].accuracy_usec = (uint32)((period_ns + 500) / 1000);
 		}
 	}
 
@@ -512,13 +1588,26 @@ int32 OS_TimeBaseDelete_Impl(uint32 timer_id)
 	*/
 	if(local->simulate_flag)
 	{
+#if defined(OS_FREERTOS_TIMEBASE_DISPATCH)
+		vTaskSuspendAll();
+		OS_TimeBase_DispatchRemove(timer_id);
+		xTaskResumeAll();
+#elif defined(OS_FREERTOS_TIMEBASE_HIRES)
+		OS_TimeBase_HiresRequest(timer_id, 0, 0);
+#else
 		status = xTimerDelete(local->host_timer_id, portMAX_DELAY);
 		if(status != pdPASS)
 		{
 			return OS_TIMER_ERR_INTERNAL;
 		}
-
+#endif
+	}
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+	if(local->external_flag)
+	{
+		OS_TimeBase_ExternalDetach(timer_id);
 	}
+#endif
 
 	vTaskDelete(local->handler_task);
 
@@ -534,6 +1623,13 @@ int32 OS_TimeBaseDelete_Impl(uint32 timer_id)
 			vSemaphoreDelete(local->tick_sem);
             local->simulate_flag = 0;
 		}
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+		if(local->external_flag)
+		{
+			vSemaphoreDelete(local->tick_sem);
+			local->external_flag = 0;
+		}
+#endif
 	}
 
 	return return_code;
@@ -552,10 +1648,253 @@ int32 OS_TimeBaseGetInfo_Impl(uint32 timer_id, OS_timebase_prop_t *timer_prop)
     return OS_SUCCESS;
 } /* end OS_TimeBaseGetInfo_Impl */
 
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBaseGetStats_Impl
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           See prototype in os-FreeRTOS.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_TimeBaseGetStats_Impl(uint32 timer_id, OS_timebase_stats_t *timebase_stats)
+{
+	OS_impl_timebase_internal_record_t *local = &OS_impl_timebase_table[timer_id];
+
+	/* Only an application sync function is outside of what the port sees */
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+	if(!local->simulate_flag && !local->external_flag)
+#else
+	if(!local->simulate_flag)
+#endif
+	{
+		return OS_ERR_NOT_IMPLEMENTED;
+	}
+
+	/* Updated by the servicing task; a snapshot is good enough for reporting */
+	timebase_stats->overrun_count = local->overrun_count;
+	timebase_stats->dropped_count = local->dropped_count;
+	timebase_stats->last_callback_usec = local->last_callback_usec;
+	timebase_stats->max_callback_usec = local->max_callback_usec;
+
+#ifdef OS_FREERTOS_TIMEBASE_STATS
+	if(!local->stats_restart)
+	{
+		timebase_stats->expiry_count = local->expiry_count;
+		timebase_stats->coalesced_count = local->coalesced_count;
+		timebase_stats->min_latency_usec = local->min_latency;
+		timebase_stats->max_latency_usec = local->max_latency;
+		if(local->expiry_count > 0)
+		{
+			timebase_stats->mean_latency_usec = (int32)(local->total_latency / local->expiry_count);
+		}
+		memcpy(timebase_stats->histogram, local->histogram, sizeof(timebase_stats->histogram));
+	}
+#endif
+
+	return OS_SUCCESS;
+} /* end OS_TimeBaseGetStats_Impl */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBaseGetStats
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_TimeBaseGetStats(uint32 timebase_id, OS_timebase_stats_t *timebase_stats)
+{
+	OS_common_record_t *record;
+	uint32 local_id;
+	int32 return_code;
+
+	if(timebase_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	memset(timebase_stats, 0, sizeof(OS_timebase_stats_t));
+
+	/* Only reads the table, so a shared hold is enough */
+	return_code = OS_Lock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_TIMEBASE);
+	if(return_code != OS_SUCCESS)
+	{
+		return return_code;
+	}
+
+	return_code = OS_ObjectIdGetById(OS_LOCK_MODE_NONE, OS_OBJECT_TYPE_OS_TIMEBASE, timebase_id, &local_id, &record);
+	if(return_code == OS_SUCCESS)
+	{
+		return_code = OS_TimeBaseGetStats_Impl(local_id, timebase_stats);
+	}
+
+	OS_Unlock_Global_Shared_Impl(OS_OBJECT_TYPE_OS_TIMEBASE);
+
+	return return_code;
+} /* end OS_TimeBaseGetStats */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TimeBaseCreateExternal
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *           The source is opened here and handed to OS_TimeBaseCreate_Impl
+ *           through static variables, since OS_TimeBaseCreate only passes
+ *           on the sync function; OS_timebase_external_mutex keeps
+ *           concurrent calls apart.
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_TimeBaseCreateExternal(uint32 *timebase_id, const char *timebase_name, uint32 source_type,
+                                const char *source_name, uint32 tick_usec)
+{
+#ifdef OS_FREERTOS_TIMEBASE_EXTERNAL
+	HANDLE source;
+	volatile LONG *view = NULL;
+	int32 return_code;
+
+	if(timebase_id == NULL || timebase_name == NULL || source_name == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	if(tick_usec == 0 || (source_type != OS_TIMEBASE_SOURCE_EVENT && source_type != OS_TIMEBASE_SOURCE_COUNTER))
+	{
+		return OS_TIMER_ERR_INVALID_ARGS;
+	}
+
+	/* Created if the driver has not done so yet, otherwise opened */
+	if(source_type == OS_TIMEBASE_SOURCE_EVENT)
+	{
+		source = CreateEventA(NULL, FALSE, FALSE, source_name);
+	}
+	else
+	{
+		source = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, 0, sizeof(LONG), source_name);
+		if(source != NULL)
+		{
+			view = (volatile LONG *)MapViewOfFile(source, FILE_MAP_READ, 0, 0, sizeof(LONG));
+			if(view == NULL)
+			{
+				CloseHandle(source);
+				source = NULL;
+			}
+		}
+	}
+
+	if(source == NULL)
+	{
+		OS_DEBUG("OS_TimeBaseCreateExternal: cannot open %s: %lu\n", source_name, GetLastError());
+		return OS_TIMER_ERR_INTERNAL;
+	}
+
+	xSemaphoreTake(OS_timebase_external_mutex, portMAX_DELAY);
+
+	OS_timebase_external_source = source;
+	OS_timebase_external_view = view;
+	OS_timebase_external_tick_usec = tick_usec;
+
+	return_code = OS_TimeBaseCreate(timebase_id, timebase_name, OS_TimeBase_ExternalWait);
+
+	/* Still set if OS_TimeBaseCreate failed before the timebase took the source */
+	if(OS_timebase_external_source != NULL)
+	{
+		if(OS_timebase_external_view != NULL)
+		{
+			UnmapViewOfFile((LPCVOID)OS_timebase_external_view);
+			OS_timebase_external_view = NULL;
+		}
+		CloseHandle(OS_timebase_external_source);
+		OS_timebase_external_source = NULL;
+	}
+
+	xSemaphoreGive(OS_timebase_external_mutex);
+
+	return return_code;
+#else
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_TimeBaseCreateExternal */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_OverrunHookSet
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_OverrunHookSet(OS_overrun_hook_t hook)
+{
+	OS_timebase_overrun_hook = hook;
+
+	return OS_SUCCESS;
+} /* end OS_OverrunHookSet */
+
 /****************************************************************************************
  Other Time-Related API Implementation
  ***************************************************************************************/
 
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_ElapsedTime
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Time since the scheduler started, from the performance counter
+ *           when it is available and the tick count otherwise.
+ *
+ *           When the application runs in lockstep with a simulation driver the
+ *           tick is the simulated time base, so the host clock is not used.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_ElapsedTime(uint32 *seconds, uint32 *microsecs)
+{
+#if configFREERTOS_RUN_AS_SIM == 0
+	unsigned long long nsecs;
+
+	if(xGetMonotonicNanoseconds(&nsecs) == pdTRUE)
+	{
+		*seconds = (uint32)(nsecs / 1000000000ULL);
+		*microsecs = (uint32)((nsecs % 1000000000ULL) / 1000);
+		return;
+	}
+#endif
+
+	/* Both counters move on in the tick interrupt, so read them together */
+	taskENTER_CRITICAL();
+	*seconds = getElapsedSeconds();
+	*microsecs = getElapsedMicroseconds();
+	taskEXIT_CRITICAL();
+} /* end OS_FreeRTOS_ElapsedTime */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_GetMonotonicNsec
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+uint64 OS_GetMonotonicNsec(void)
+{
+	uint32 seconds;
+	uint32 microsecs;
+
+#if configFREERTOS_RUN_AS_SIM == 0
+	unsigned long long nsecs;
+
+	if(xGetMonotonicNanoseconds(&nsecs) == pdTRUE)
+	{
+		return nsecs;
+	}
+#endif
+
+	OS_FreeRTOS_ElapsedTime(&seconds, &microsecs);
+
+	return ((uint64)seconds * 1000000000ULL) + ((uint64)microsecs * 1000);
+} /* end OS_GetMonotonicNsec */
+
 /*---------------------------------------------------------------------------------------
  * Name: OS_GetLocalTime_Impl
  *
@@ -563,13 +1902,23 @@ int32 OS_TimeBaseGetInfo_Impl(uint32 timer_id, OS_timebase_prop_t *timer_prop)
  * ------------------------------------------------------------------------------------*/
 int32 OS_GetLocalTime_Impl(OS_time_t *time_struct)
 {
-	time_struct->seconds = getElapsedSeconds() + adjust_seconds;
-	time_struct->microsecs = getElapsedMicroseconds() + adjust_microseconds;
+	uint32 seconds;
+	uint32 microsecs;
+
+	OS_FreeRTOS_ElapsedTime(&seconds, &microsecs);
+
+	time_struct->seconds = seconds + adjust_seconds;
+	time_struct->microsecs = microsecs + adjust_microseconds;
 	while(time_struct->microsecs < 0)
 	{
-		time_struct->microsecs += 1000;
+		time_struct->microsecs += 1000000;
 		time_struct->seconds--;
 	}
+	while(time_struct->microsecs >= 1000000)
+	{
+		time_struct->microsecs -= 1000000;
+		time_struct->seconds++;
+	}
 
 	return OS_SUCCESS;
 } /* end OS_GetLocalTime_Impl */
@@ -581,11 +1930,16 @@ int32 OS_GetLocalTime_Impl(OS_time_t *time_struct)
  * ------------------------------------------------------------------------------------*/
 int32 OS_SetLocalTime_Impl(const OS_time_t *time_struct)
 {
-	adjust_seconds = time_struct->seconds - getElapsedSeconds();
-	adjust_microseconds = time_struct->microsecs - getElapsedMicroseconds();
+	uint32 seconds;
+	uint32 microsecs;
+
+	OS_FreeRTOS_ElapsedTime(&seconds, &microsecs);
+
+	adjust_seconds = time_struct->seconds - seconds;
+	adjust_microseconds = time_struct->microsecs - microsecs;
 	while(adjust_microseconds < 0)
 	{
-		adjust_microseconds += 1000;
+		adjust_microseconds += 1000000;
 		adjust_seconds--;
 	}
 
@@ -0,0 +1,952 @@
+/*
+ *  NASA Docket No. GSC-18,370-1, and identified as "Operating System Abstraction Layer"
+ *
+ *  Copyright (c) 2019 United States Government as represented by
+ *  the Administrator of the National Aeronautics and Space Administration.
+ *  All Rights Reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * \file   ostrace.c
+ *
+ * Purpose: This file contains the event tracer fed by the FreeRTOS trace
+ *          hooks, see configFREERTOS_SIM_EVENT_TRACE in FreeRTOSConfig.h,
+ *          and the OSAL call probes, see OS_FREERTOS_API_STATS in osconfig.h
+ */
+
+/****************************************************************************************
+ INCLUDE FILES
+ ***************************************************************************************/
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "os-FreeRTOS.h"
+
+#if configFREERTOS_SIM_EVENT_TRACE
+
+#if configUSE_TRACE_FACILITY != 1
+#error configFREERTOS_SIM_EVENT_TRACE needs configUSE_TRACE_FACILITY set to 1
+#endif
+#if (OS_FREERTOS_TRACE_EVENTS & (OS_FREERTOS_TRACE_EVENTS - 1)) != 0
+#error OS_FREERTOS_TRACE_EVENTS must be a power of two
+#endif
+#if (OS_FREERTOS_TRACE_TASK_NAMES & (OS_FREERTOS_TRACE_TASK_NAMES - 1)) != 0
+#error OS_FREERTOS_TRACE_TASK_NAMES must be a power of two
+#endif
+
+/****************************************************************************************
+ DEFINES
+ ***************************************************************************************/
+
+/*
+ * Tracks of the dump that are not tasks.  Task tracks are numbered with the
+ * kernel's task number, which starts at 1; 0 collects what happens before the
+ * scheduler runs the first task.
+ */
+#define OS_FREERTOS_TRACE_CPU_TRACK     0x10000
+#define OS_FREERTOS_TRACE_ISR_TRACK     0x10001
+
+/* Room kept in the dump buffer for one event, longer events are cut */
+#define OS_FREERTOS_TRACE_LINE_MAX      256
+
+/****************************************************************************************
+ GLOBAL DATA
+ ***************************************************************************************/
+
+/*
+ * One trace event.  A writer claims the next slot with an interlocked
+ * increment of OS_trace_head, so the hooks never block and may run in a task,
+ * in a simulated interrupt or in the kernel with interrupts masked.  seq is
+ * written last; a slot whose seq is not its index + 1 is still being written
+ * or was overwritten, and is skipped by the dump.
+ */
+typedef struct
+{
+	LONGLONG    timestamp;		/* host performance counter */
+	const void *object;			/* TCB, queue handle or name, depending on type */
+	uint32      value;
+	uint32      task;			/* track the event belongs to */
+	uint32      type;			/* OS_FREERTOS_TRACE_xxx */
+	uint32      seq;
+} OS_trace_event_t;
+
+/* Names of the tasks, looked up by task number when the trace is dumped */
+typedef struct
+{
+	const void *tcb;
+	uint32      number;
+	char        name[configMAX_TASK_NAME_LEN];
+} OS_trace_task_name_t;
+
+/*
+ * The simulator runs the kernel on one core, so one ring and one running
+ * task are all the per-core state there is.
+ */
+static OS_trace_event_t OS_trace_ring[OS_FREERTOS_TRACE_EVENTS];
+static volatile LONG OS_trace_head = 0;
+static volatile LONG OS_trace_first = 0;
+static volatile LONG OS_trace_enabled = 1;
+static volatile LONG OS_trace_dumping = 0;
+static volatile uint32 OS_trace_task = 0;
+static volatile uint32 OS_trace_in_isr = 0;
+
+static OS_trace_task_name_t OS_trace_task_names[OS_FREERTOS_TRACE_TASK_NAMES];
+
+/* Output state of OS_TraceDump, only one dump runs at a time */
+typedef struct
+{
+	HANDLE   file;
+	uint32   len;
+	bool     failed;
+	bool     first;
+	LONGLONG origin;
+	double   usec_per_count;
+} OS_trace_dump_t;
+
+static char OS_trace_dump_buffer[OS_FREERTOS_FILE_BUFFER_SIZE];
+
+/* Names of the queue types the kernel keeps in ucQueueType */
+static const char * const OS_trace_queue_kind[] =
+{
+	"queue", "mutex", "count sem", "bin sem", "recursive mutex"
+};
+
+/****************************************************************************************
+ KERNEL HOOKS
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceEvent
+ *
+ *  Purpose: trace hook, see FreeRTOSConfig.h.
+ *           Appends one event to the ring
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_TraceEvent(unsigned int uiType, const void *pvObject, unsigned long ulValue)
+{
+	OS_trace_event_t *event;
+	LARGE_INTEGER now;
+	uint32 index;
+
+	if(!OS_trace_enabled)
+	{
+		return;
+	}
+
+	index = (uint32) InterlockedIncrement(&OS_trace_head) - 1;
+	event = &OS_trace_ring[index & (OS_FREERTOS_TRACE_EVENTS - 1)];
+	event->seq = 0;
+	MemoryBarrier();
+
+	QueryPerformanceCounter(&now);
+	event->timestamp = now.QuadPart;
+	event->object = pvObject;
+	event->value = (uint32) ulValue;
+	event->type = uiType;
+
+	/* Events of the OSAL interrupt handlers, enter and exit included, go on the interrupt track */
+	if(uiType == OS_FREERTOS_TRACE_ISR_ENTER)
+	{
+		OS_trace_in_isr = 1;
+	}
+	event->task = OS_trace_in_isr ? OS_FREERTOS_TRACE_ISR_TRACK : OS_trace_task;
+	if(uiType == OS_FREERTOS_TRACE_ISR_EXIT)
+	{
+		OS_trace_in_isr = 0;
+	}
+
+	MemoryBarrier();
+	event->seq = index + 1;
+} /* end OS_FreeRTOS_TraceEvent */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceTaskSwitch
+ *
+ *  Purpose: traceTASK_SWITCHED_IN hook, see FreeRTOSConfig.h.
+ *           Records the task that runs from now on
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_TraceTaskSwitch(void *pxTCB, unsigned long ulTaskNumber)
+{
+	OS_trace_task = (uint32) ulTaskNumber;
+	OS_FreeRTOS_TraceEvent(OS_FREERTOS_TRACE_TASK_SWITCH, pxTCB, ulTaskNumber);
+} /* end OS_FreeRTOS_TraceTaskSwitch */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceTaskCreate
+ *
+ *  Purpose: traceTASK_CREATE hook, see FreeRTOSConfig.h.
+ *           Remembers the name of a new task, also while not recording
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_TraceTaskCreate(void *pxTCB, unsigned long ulTaskNumber, const char *pcName)
+{
+	OS_trace_task_name_t *entry = &OS_trace_task_names[ulTaskNumber & (OS_FREERTOS_TRACE_TASK_NAMES - 1)];
+
+	entry->tcb = pxTCB;
+	entry->number = (uint32) ulTaskNumber;
+	strncpy(entry->name, pcName, sizeof(entry->name) - 1);
+	entry->name[sizeof(entry->name) - 1] = '\0';
+
+	OS_FreeRTOS_TraceEvent(OS_FREERTOS_TRACE_TASK_CREATE, pxTCB, ulTaskNumber);
+} /* end OS_FreeRTOS_TraceTaskCreate */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceSave
+ *
+ *  Purpose: Called by vAssertCalled, see FreeRTOSConfig.h.
+ *           Keeps the trace leading up to a failed assertion
+ *
+ *-----------------------------------------------------------------*/
+void OS_FreeRTOS_TraceSave(void)
+{
+	if(OS_TraceDump("Trace.json") == OS_SUCCESS)
+	{
+		printf("\r\nTrace output saved to Trace.json\r\n");
+	}
+	else
+	{
+		printf("\r\nFailed to create trace dump file\r\n");
+	}
+} /* end OS_FreeRTOS_TraceSave */
+
+/****************************************************************************************
+ TRACE DUMP
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceFlush
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Write the buffered part of the dump to the file
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_TraceFlush(OS_trace_dump_t *dump)
+{
+	DWORD written;
+
+	if(dump->len > 0 &&
+	   (!WriteFile(dump->file, OS_trace_dump_buffer, dump->len, &written, NULL) || written != dump->len))
+	{
+		dump->failed = true;
+	}
+
+	dump->len = 0;
+} /* end OS_FreeRTOS_TraceFlush */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceWrite
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Append formatted text to the dump
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_TraceWrite(OS_trace_dump_t *dump, const char *format, ...)
+{
+	va_list va;
+	uint32 room;
+	int len;
+
+	if(sizeof(OS_trace_dump_buffer) - dump->len < OS_FREERTOS_TRACE_LINE_MAX)
+	{
+		OS_FreeRTOS_TraceFlush(dump);
+	}
+
+	room = sizeof(OS_trace_dump_buffer) - dump->len;
+
+	va_start(va, format);
+	len = vsnprintf(&OS_trace_dump_buffer[dump->len], room, format, va);
+	va_end(va);
+
+	if(len > 0)
+	{
+		dump->len += ((uint32) len < room) ? (uint32) len : room - 1;
+	}
+} /* end OS_FreeRTOS_TraceWrite */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceName
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Copy a name, replacing what JSON would need escaped
+ *
+ *-----------------------------------------------------------------*/
+static const char *OS_FreeRTOS_TraceName(char *dest, uint32 size, const char *src)
+{
+	uint32 i;
+
+	for(i = 0; i + 1 < size && src[i] != '\0'; i++)
+	{
+		dest[i] = (src[i] == '"' || src[i] == '\\' || (unsigned char) src[i] < ' ') ? '_' : src[i];
+	}
+	dest[i] = '\0';
+
+	return dest;
+} /* end OS_FreeRTOS_TraceName */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceTaskName
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Name of a task by task number or, if number is 0, by TCB
+ *
+ *-----------------------------------------------------------------*/
+static const char *OS_FreeRTOS_TraceTaskName(char *dest, uint32 size, uint32 number, const void *tcb)
+{
+	const OS_trace_task_name_t *entry;
+	uint32 i;
+
+	if(number == 0)
+	{
+		for(i = 0; i < OS_FREERTOS_TRACE_TASK_NAMES; i++)
+		{
+			if(tcb != NULL && OS_trace_task_names[i].tcb == tcb)
+			{
+				return OS_FreeRTOS_TraceName(dest, size, OS_trace_task_names[i].name);
+			}
+		}
+
+		return "unknown";
+	}
+
+	entry = &OS_trace_task_names[number & (OS_FREERTOS_TRACE_TASK_NAMES - 1)];
+	if(entry->number != number)
+	{
+		snprintf(dest, size, "task %lu", (unsigned long) number);
+		return dest;
+	}
+
+	return OS_FreeRTOS_TraceName(dest, size, entry->name);
+} /* end OS_FreeRTOS_TraceTaskName */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceWriteEvent
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Append one trace event object; extra holds further members,
+ *           each with a leading comma
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_TraceWriteEvent(OS_trace_dump_t *dump, const char *ph, const char *name, uint32 tid,
+		LONGLONG timestamp, const char *extra)
+{
+	OS_FreeRTOS_TraceWrite(dump, "%s\n{\"ph\":\"%s\",\"name\":\"%s\",\"pid\":1,\"tid\":%lu,\"ts\":%.3f%s}",
+			dump->first ? "" : ",", ph, name, (unsigned long) tid,
+			(double) (timestamp - dump->origin) * dump->usec_per_count, extra);
+	dump->first = false;
+} /* end OS_FreeRTOS_TraceWriteEvent */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceWriteTrack
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Append the metadata naming one track
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_TraceWriteTrack(OS_trace_dump_t *dump, uint32 tid, const char *name, int sort_index)
+{
+	OS_FreeRTOS_TraceWrite(dump, "%s\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%lu,\"args\":{\"name\":\"%s\"}}"
+			",\n{\"ph\":\"M\",\"name\":\"thread_sort_index\",\"pid\":1,\"tid\":%lu,\"args\":{\"sort_index\":%d}}",
+			dump->first ? "" : ",", (unsigned long) tid, name, (unsigned long) tid, sort_index);
+	dump->first = false;
+} /* end OS_FreeRTOS_TraceWriteTrack */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_TraceWriteQueueOp
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Append a queue, semaphore or mutex operation as an instant
+ *
+ *-----------------------------------------------------------------*/
+static void OS_FreeRTOS_TraceWriteQueueOp(OS_trace_dump_t *dump, const OS_trace_event_t *event)
+{
+	const char *kind;
+	const char *op;
+	const char *outcome;
+	char name[64];
+	char extra[64];
+	bool is_queue;
+
+	kind = (event->value < sizeof(OS_trace_queue_kind) / sizeof(OS_trace_queue_kind[0])) ?
+			OS_trace_queue_kind[event->value] : "queue";
+	is_queue = (event->value == 0);
+
+	switch(event->type)
+	{
+	case OS_FREERTOS_TRACE_QUEUE_SEND:
+	case OS_FREERTOS_TRACE_QUEUE_SEND_FAIL:
+	case OS_FREERTOS_TRACE_QUEUE_SEND_BLOCK:
+		op = is_queue ? "send" : "give";
+		break;
+	default:
+		op = is_queue ? "receive" : "take";
+		break;
+	}
+
+	switch(event->type)
+	{
+	case OS_FREERTOS_TRACE_QUEUE_SEND_FAIL:
+	case OS_FREERTOS_TRACE_QUEUE_RECV_FAIL:
+		outcome = " failed";
+		break;
+	case OS_FREERTOS_TRACE_QUEUE_SEND_BLOCK:
+	case OS_FREERTOS_TRACE_QUEUE_RECV_BLOCK:
+		outcome = " blocked";
+		break;
+	default:
+		outcome = "";
+		break;
+	}
+
+	snprintf(name, sizeof(name), "%s %s%s", kind, op, outcome);
+	snprintf(extra, sizeof(extra), ",\"s\":\"t\",\"args\":{\"handle\":\"0x%llx\"}",
+			(unsigned long long) (uintptr_t) event->object);
+	OS_FreeRTOS_TraceWriteEvent(dump, "i", name, event->task, event->timestamp, extra);
+} /* end OS_FreeRTOS_TraceWriteQueueOp */
+
+/****************************************************************************************
+ TRACE EXTENSION API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TraceStart
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_TraceStart(void)
+{
+	InterlockedExchange(&OS_trace_enabled, 0);
+	InterlockedExchange(&OS_trace_first, OS_trace_head);
+	InterlockedExchange(&OS_trace_enabled, 1);
+
+	return OS_SUCCESS;
+} /* end OS_TraceStart */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TraceStop
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_TraceStop(void)
+{
+	InterlockedExchange(&OS_trace_enabled, 0);
+
+	return OS_SUCCESS;
+} /* end OS_TraceStop */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TraceMark
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+void OS_TraceMark(const char *name)
+{
+	if(name != NULL)
+	{
+		OS_FreeRTOS_TraceEvent(OS_FREERTOS_TRACE_MARK, name, 0);
+	}
+} /* end OS_TraceMark */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_TraceDump
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_TraceDump(const char *host_path)
+{
+	OS_trace_dump_t dump;
+	const OS_trace_event_t *event;
+	LARGE_INTEGER frequency;
+	LONG enabled;
+	LONGLONG running_since = 0;
+	LONGLONG last = 0;
+	uint32 running_task = 0;
+	bool running = false;
+	uint32 head;
+	uint32 first;
+	uint32 index;
+	uint32 i;
+	char name[OS_MAX_API_NAME + configMAX_TASK_NAME_LEN];
+	char task_name[configMAX_TASK_NAME_LEN];
+	char extra[96];
+
+	if(host_path == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	if(InterlockedCompareExchange(&OS_trace_dumping, 1, 0) != 0)
+	{
+		return OS_ERROR;
+	}
+
+	memset(&dump, 0, sizeof(dump));
+	dump.file = CreateFileA(host_path, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+	                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if(dump.file == INVALID_HANDLE_VALUE)
+	{
+		InterlockedExchange(&OS_trace_dumping, 0);
+		return OS_ERROR;
+	}
+
+	enabled = InterlockedExchange(&OS_trace_enabled, 0);
+
+	/* The events still in the ring, oldest first */
+	head = (uint32) OS_trace_head;
+	first = (uint32) OS_trace_first;
+	if(head - first > OS_FREERTOS_TRACE_EVENTS)
+	{
+		first = head - OS_FREERTOS_TRACE_EVENTS;
+	}
+
+	QueryPerformanceFrequency(&frequency);
+	dump.usec_per_count = 1000000.0 / (double) frequency.QuadPart;
+	dump.origin = OS_trace_ring[first & (OS_FREERTOS_TRACE_EVENTS - 1)].timestamp;
+	dump.first = true;
+
+	OS_FreeRTOS_TraceWrite(&dump, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+	OS_FreeRTOS_TraceWrite(&dump, "\n{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"args\":{\"name\":\"FreeRTOS\"}}");
+	dump.first = false;
+	OS_FreeRTOS_TraceWriteTrack(&dump, OS_FREERTOS_TRACE_CPU_TRACK, "CPU 0", -2);
+	OS_FreeRTOS_TraceWriteTrack(&dump, OS_FREERTOS_TRACE_ISR_TRACK, "Interrupts", -1);
+	OS_FreeRTOS_TraceWriteTrack(&dump, 0, "startup", 0);
+	for(i = 0; i < OS_FREERTOS_TRACE_TASK_NAMES; i++)
+	{
+		if(OS_trace_task_names[i].number != 0)
+		{
+			OS_FreeRTOS_TraceWriteTrack(&dump, OS_trace_task_names[i].number,
+					OS_FreeRTOS_TraceName(task_name, sizeof(task_name), OS_trace_task_names[i].name),
+					(int) OS_trace_task_names[i].number);
+		}
+	}
+
+	for(index = first; index != head && !dump.failed; index++)
+	{
+		event = &OS_trace_ring[index & (OS_FREERTOS_TRACE_EVENTS - 1)];
+		if(event->seq != index + 1)
+		{
+			continue;
+		}
+
+		switch(event->type)
+		{
+		case OS_FREERTOS_TRACE_TASK_SWITCH:
+			/* The CPU track has one slice per run of a task */
+			if(running)
+			{
+				snprintf(extra, sizeof(extra), ",\"dur\":%.3f",
+						(event->timestamp > running_since) ?
+								(double) (event->timestamp - running_since) * dump.usec_per_count : 0.0);
+				OS_FreeRTOS_TraceWriteEvent(&dump, "X",
+						OS_FreeRTOS_TraceTaskName(task_name, sizeof(task_name), running_task, NULL),
+						OS_FREERTOS_TRACE_CPU_TRACK, running_since, extra);
+			}
+			running = true;
+			running_task = event->value;
+			running_since = event->timestamp;
+			break;
+
+		case OS_FREERTOS_TRACE_TASK_CREATE:
+		case OS_FREERTOS_TRACE_TASK_DELETE:
+			snprintf(name, sizeof(name), "%s %s", (event->type == OS_FREERTOS_TRACE_TASK_CREATE) ? "create" : "delete",
+					OS_FreeRTOS_TraceTaskName(task_name, sizeof(task_name), event->value, NULL));
+			OS_FreeRTOS_TraceWriteEvent(&dump, "i", name, event->task, event->timestamp, ",\"s\":\"t\"");
+			break;
+
+		case OS_FREERTOS_TRACE_TASK_DELAY:
+			snprintf(extra, sizeof(extra), ",\"s\":\"t\",\"args\":{\"ticks\":%lu}", (unsigned long) event->value);
+			OS_FreeRTOS_TraceWriteEvent(&dump, "i", "delay", event->task, event->timestamp, extra);
+			break;
+
+		case OS_FREERTOS_TRACE_QUEUE_SEND:
+		case OS_FREERTOS_TRACE_QUEUE_SEND_FAIL:
+		case OS_FREERTOS_TRACE_QUEUE_SEND_BLOCK:
+		case OS_FREERTOS_TRACE_QUEUE_RECV:
+		case OS_FREERTOS_TRACE_QUEUE_RECV_FAIL:
+		case OS_FREERTOS_TRACE_QUEUE_RECV_BLOCK:
+			OS_FreeRTOS_TraceWriteQueueOp(&dump, event);
+			break;
+
+		case OS_FREERTOS_TRACE_NOTIFY_GIVE:
+			snprintf(extra, sizeof(extra), ",\"s\":\"t\",\"args\":{\"task\":\"%s\"}",
+					OS_FreeRTOS_TraceTaskName(task_name, sizeof(task_name), 0, event->object));
+			OS_FreeRTOS_TraceWriteEvent(&dump, "i", event->value ? "notify give from isr" : "notify give",
+					event->task, event->timestamp, extra);
+			break;
+
+		case OS_FREERTOS_TRACE_NOTIFY_TAKE:
+		case OS_FREERTOS_TRACE_NOTIFY_TAKE_BLOCK:
+			OS_FreeRTOS_TraceWriteEvent(&dump, "i",
+					(event->type == OS_FREERTOS_TRACE_NOTIFY_TAKE) ? "notify take" : "notify take blocked",
+					event->task, event->timestamp, ",\"s\":\"t\"");
+			break;
+
+		case OS_FREERTOS_TRACE_ISR_ENTER:
+		case OS_FREERTOS_TRACE_ISR_EXIT:
+			snprintf(name, sizeof(name), "interrupt %lu", (unsigned long) event->value);
+			OS_FreeRTOS_TraceWriteEvent(&dump, (event->type == OS_FREERTOS_TRACE_ISR_ENTER) ? "B" : "E",
+					name, event->task, event->timestamp, "");
+			break;
+
+		case OS_FREERTOS_TRACE_API_ENTER:
+			OS_FreeRTOS_TraceWriteEvent(&dump, "B", OS_FreeRTOS_TraceName(name, sizeof(name), event->object),
+					event->task, event->timestamp, "");
+			break;
+
+		case OS_FREERTOS_TRACE_API_EXIT:
+			snprintf(extra, sizeof(extra), ",\"args\":{\"status\":%ld}", (long) (int32) event->value);
+			OS_FreeRTOS_TraceWriteEvent(&dump, "E", OS_FreeRTOS_TraceName(name, sizeof(name), event->object),
+					event->task, event->timestamp, extra);
+			break;
+
+		case OS_FREERTOS_TRACE_MARK:
+			OS_FreeRTOS_TraceWriteEvent(&dump, "i", OS_FreeRTOS_TraceName(name, sizeof(name), event->object),
+					event->task, event->timestamp, ",\"s\":\"t\"");
+			break;
+
+		default:
+			break;
+		}
+
+		last = event->timestamp;
+	}
+
+	/* The task still running at the end gets a slice up to the last event */
+	if(running)
+	{
+		snprintf(extra, sizeof(extra), ",\"dur\":%.3f",
+				(last > running_since) ? (double) (last - running_since) * dump.usec_per_count : 0.0);
+		OS_FreeRTOS_TraceWriteEvent(&dump, "X",
+				OS_FreeRTOS_TraceTaskName(task_name, sizeof(task_name), running_task, NULL),
+				OS_FREERTOS_TRACE_CPU_TRACK, running_since, extra);
+	}
+
+	OS_FreeRTOS_TraceWrite(&dump, "\n]}\n");
+	OS_FreeRTOS_TraceFlush(&dump);
+	CloseHandle(dump.file);
+
+	InterlockedExchange(&OS_trace_enabled, enabled);
+	InterlockedExchange(&OS_trace_dumping, 0);
+
+	return dump.failed ? OS_ERROR : OS_SUCCESS;
+} /* end OS_TraceDump */
+
+#else
+
+/****************************************************************************************
+ TRACE EXTENSION API
+ ***************************************************************************************/
+
+/*
+ * Without configFREERTOS_SIM_EVENT_TRACE no hooks are compiled in and there is
+ * nothing to record.
+ */
+
+int32 OS_TraceStart(void)
+{
+	return OS_ERR_NOT_IMPLEMENTED;
+} /* end OS_TraceStart */
+
+int32 OS_TraceStop(void)
+{
+	return OS_ERR_NOT_IMPLEMENTED;
+} /* end OS_TraceStop */
+
+void OS_TraceMark(const char *name)
+{
+	(void) name;
+} /* end OS_TraceMark */
+
+int32 OS_TraceDump(const char *host_path)
+{
+	(void) host_path;
+	return OS_ERR_NOT_IMPLEMENTED;
+} /* end OS_TraceDump */
+
+#endif
+
+/****************************************************************************************
+ API PROBES
+ ***************************************************************************************/
+
+#if defined(OS_FREERTOS_API_STATS) || configFREERTOS_SIM_EVENT_TRACE
+
+#define OS_FREERTOS_API_NAME(api)		#api,
+static const char * const OS_api_name[OS_FREERTOS_API_COUNT] =
+{
+	OS_FREERTOS_API_LIST(OS_FREERTOS_API_NAME)
+};
+
+#ifdef OS_FREERTOS_API_STATS
+/*
+ * Counters of one call.  The probes run in every task that makes an OSAL call,
+ * so the counters are only ever changed with interlocked operations and no
+ * lock is taken on the way in or out.  An error code slot is claimed by
+ * swapping its code in while it is still 0.
+ */
+typedef struct
+{
+	volatile LONG     call_count;
+	volatile LONG     error_count;
+	volatile LONGLONG total_nsec;
+	volatile LONGLONG max_nsec;
+	volatile LONG     error_code[OS_FREERTOS_API_STATS_ERRORS];
+	volatile LONG     error_code_count[OS_FREERTOS_API_STATS_ERRORS];
+} OS_api_counters_t;
+
+static OS_api_counters_t OS_api_counters[OS_FREERTOS_API_COUNT];
+#endif
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_ApiEnter
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Entry probe of OS_FREERTOS_API_ENTER, returns the start time
+ *
+ *-----------------------------------------------------------------*/
+uint64 OS_FreeRTOS_ApiEnter(uint32 api)
+{
+#if configFREERTOS_SIM_EVENT_TRACE
+	OS_FreeRTOS_TraceEvent(OS_FREERTOS_TRACE_API_ENTER, OS_api_name[api], 0);
+#endif
+
+	(void) api;
+#ifdef OS_FREERTOS_API_STATS
+	return OS_GetMonotonicNsec();
+#else
+	return 0;
+#endif
+} /* end OS_FreeRTOS_ApiEnter */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_FreeRTOS_ApiExit
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Exit probe of OS_FREERTOS_API_EXIT, passes the status on
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_FreeRTOS_ApiExit(uint32 api, uint64 start, int32 status)
+{
+#ifdef OS_FREERTOS_API_STATS
+	OS_api_counters_t *counters = &OS_api_counters[api];
+	LONGLONG elapsed = (LONGLONG) (OS_GetMonotonicNsec() - start);
+	LONGLONG max;
+	uint32 i;
+
+	InterlockedIncrement(&counters->call_count);
+	InterlockedExchangeAdd64(&counters->total_nsec, elapsed);
+
+	max = counters->max_nsec;
+	while(elapsed > max)
+	{
+		LONGLONG seen = InterlockedCompareExchange64(&counters->max_nsec, elapsed, max);
+		if(seen == max)
+		{
+			break;
+		}
+		max = seen;
+	}
+
+	if(status < 0)
+	{
+		InterlockedIncrement(&counters->error_count);
+
+		/* Codes past the last slot are only counted in error_count */
+		for(i = 0; i < OS_FREERTOS_API_STATS_ERRORS; i++)
+		{
+			if(counters->error_code[i] == status ||
+			   InterlockedCompareExchange(&counters->error_code[i], status, 0) == 0 ||
+			   counters->error_code[i] == status)
+			{
+				InterlockedIncrement(&counters->error_code_count[i]);
+				break;
+			}
+		}
+	}
+#else
+	(void) start;
+#endif
+
+#if configFREERTOS_SIM_EVENT_TRACE
+	OS_FreeRTOS_TraceEvent(OS_FREERTOS_TRACE_API_EXIT, OS_api_name[api], (unsigned long) status);
+#endif
+
+	(void) api;
+	return status;
+} /* end OS_FreeRTOS_ApiExit */
+
+#endif
+
+/****************************************************************************************
+ CALL STATISTICS EXTENSION API
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ApiStatsGet
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ApiStatsGet(uint32 index, OS_api_stats_t *api_stats)
+{
+#ifdef OS_FREERTOS_API_STATS
+	OS_api_counters_t *counters;
+	uint32 i;
+
+	if(api_stats == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	if(index >= OS_FREERTOS_API_COUNT)
+	{
+		return OS_ERR_INVALID_ID;
+	}
+
+	/* The counters are read one by one, a call made meanwhile may be half counted */
+	counters = &OS_api_counters[index];
+	memset(api_stats, 0, sizeof(*api_stats));
+	strncpy(api_stats->name, OS_api_name[index], sizeof(api_stats->name) - 1);
+	api_stats->call_count = (uint32) counters->call_count;
+	api_stats->error_count = (uint32) counters->error_count;
+	api_stats->total_nsec = (uint64) counters->total_nsec;
+	api_stats->max_nsec = (uint64) counters->max_nsec;
+	for(i = 0; i < OS_FREERTOS_API_STATS_ERRORS; i++)
+	{
+		api_stats->error_code[i] = (int32) counters->error_code[i];
+		api_stats->error_code_count[i] = (uint32) counters->error_code_count[i];
+	}
+
+	return OS_SUCCESS;
+#else
+	(void) index;
+	(void) api_stats;
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_ApiStatsGet */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ApiStatsReset
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ApiStatsReset(void)
+{
+#ifdef OS_FREERTOS_API_STATS
+	uint32 api;
+	uint32 i;
+
+	for(api = 0; api < OS_FREERTOS_API_COUNT; api++)
+	{
+		OS_api_counters_t *counters = &OS_api_counters[api];
+
+		InterlockedExchange(&counters->call_count, 0);
+		InterlockedExchange(&counters->error_count, 0);
+		InterlockedExchange64(&counters->total_nsec, 0);
+		InterlockedExchange64(&counters->max_nsec, 0);
+		for(i = 0; i < OS_FREERTOS_API_STATS_ERRORS; i++)
+		{
+			InterlockedExchange(&counters->error_code_count[i], 0);
+			InterlockedExchange(&counters->error_code[i], 0);
+		}
+	}
+
+	return OS_SUCCESS;
+#else
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_ApiStatsReset */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_ApiStatsDump
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_ApiStatsDump(void)
+{
+#ifdef OS_FREERTOS_API_STATS
+	OS_api_stats_t api_stats;
+	char codes[OS_FREERTOS_API_STATS_ERRORS * 24 + 1];
+	uint32 len;
+	uint32 api;
+	uint32 i;
+
+	OS_printf("%-20s %10s %10s %14s %10s %10s %s\n",
+			"call", "calls", "errors", "total_us", "avg_us", "max_us", "error codes");
+	for(api = 0; OS_ApiStatsGet(api, &api_stats) == OS_SUCCESS; api++)
+	{
+		if(api_stats.call_count == 0)
+		{
+			continue;
+		}
+
+		len = 0;
+		codes[0] = 0;
+		for(i = 0; i < OS_FREERTOS_API_STATS_ERRORS && api_stats.error_code[i] != 0; i++)
+		{
+			len += snprintf(&codes[len], sizeof(codes) - len, " %ld:%lu",
+					(long)api_stats.error_code[i], (unsigned long)api_stats.error_code_count[i]);
+		}
+
+		OS_printf("%-20s %10lu %10lu %14llu %10llu %10llu%s\n",
+				api_stats.name,
+				(unsigned long)api_stats.call_count,
+				(unsigned long)api_stats.error_count,
+				(unsigned long long)(api_stats.total_nsec / 1000),
+				(unsigned long long)(api_stats.total_nsec / 1000 / api_stats.call_count),
+				(unsigned long long)(api_stats.max_nsec / 1000),
+				codes);
+	}
+
+	return OS_SUCCESS;
+#else
+	return OS_ERR_NOT_IMPLEMENTED;
+#endif
+} /* end OS_ApiStatsDump */
@@ -0,0 +1,689 @@
+/*
+ *  NASA Docket No. GSC-18,370-1, and identified as "Operating System Abstraction Layer"
+ *
+ *  Copyright (c) 2019 United States Government as represented by
+ *  the Administrator of the National Aeronautics and Space Administration.
+ *  All Rights Reserved.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+/**
+ * \file   osvnic.c
+ *
+ * Purpose: This file contains the shared memory virtual network interface,
+ *          a FreeRTOS+TCP network interface driver that exchanges Ethernet
+ *          frames with the other instances on the same host, and the
+ *          address parsing used to give each instance its own addresses.
+ */
+
+/****************************************************************************************
+ INCLUDE FILES
+ ***************************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "os-FreeRTOS.h"
+
+#ifdef OS_FREERTOS_NET_SHM
+#include "task.h"
+#include "FreeRTOS_IP.h"
+#include "FreeRTOS_IP_Private.h"
+#include "NetworkInterface.h"
+#include "NetworkBufferManagement.h"
+#endif
+
+/****************************************************************************************
+ ADDRESS PARSING
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_NetAddressParse
+ *
+ *  Purpose: FreeRTOS port extension to the OSAL API
+ *           See description in osapi-os-freertos.h for argument/return detail
+ *
+ *-----------------------------------------------------------------*/
+int32 OS_NetAddressParse(const char *text, uint8 *bytes, uint32 count)
+{
+	uint8 parsed[6];
+	unsigned long value;
+	char *end;
+	char separator;
+	int base;
+	uint32 i;
+
+	if(text == NULL || bytes == NULL)
+	{
+		return OS_INVALID_POINTER;
+	}
+
+	/* Dotted decimal for an IP address, colon separated hex for a MAC address */
+	if(count == 4)
+	{
+		separator = '.';
+		base = 10;
+	}
+	else if(count == 6)
+	{
+		separator = ':';
+		base = 16;
+	}
+	else
+	{
+		return OS_ERROR;
+	}
+
+	for(i = 0; i < count; i++)
+	{
+		/* strtoul would also take spaces and a sign */
+		if((base == 10) ? !isdigit((unsigned char) *text) : !isxdigit((unsigned char) *text))
+		{
+			return OS_ERROR;
+		}
+
+		value = strtoul(text, &end, base);
+		if(end == text || value > 255 || *end != ((i + 1 < count) ? separator : '\0'))
+		{
+			return OS_ERROR;
+		}
+
+		parsed[i] = (uint8) value;
+		text = end + 1;
+	}
+
+	memcpy(bytes, parsed, count);
+
+	return OS_SUCCESS;
+} /* end OS_NetAddressParse */
+
+#ifdef OS_FREERTOS_NET_SHM
+
+/****************************************************************************************
+ DEFINES
+ ***************************************************************************************/
+
+/* Largest Ethernet frame a ring cell holds, without the FCS */
+#define OS_VNIC_FRAME_MAX       1536
+
+#define OS_VNIC_MAGIC           0x43494E56		/* "VNIC" */
+#define OS_VNIC_VERSION         2
+
+/* A slot claimed but not published for this long is taken to belong to a dead sender */
+#define OS_VNIC_STALE_MSEC      500
+
+#define OS_VNIC_RX_TASK_STACK   (configMINIMAL_STACK_SIZE * 2)
+#define OS_VNIC_RX_TASK_PRIO    ipconfigIP_TASK_PRIORITY
+
+/****************************************************************************************
+ LOCAL TYPEDEFS
+ ***************************************************************************************/
+
+/*
+ * One frame slot of a receive ring.  Each ring is a bounded multi-producer,
+ * single-consumer queue: the senders claim a slot by advancing enqueue_pos
+ * and publish the frame with the slot sequence, so no lock is held across
+ * processes.  The receiver takes the slots in order, so a sender that dies
+ * between claiming and publishing would hold up every frame behind its
+ * slot.  The receiver skips such a slot once it has been pending for
+ * OS_VNIC_STALE_MSEC, see OS_Vnic_SkipStale, and a sender publishes only
+ * if its slot was not skipped meanwhile.
+ */
+typedef struct
+{
+	volatile LONG sequence;
+	uint32        length;
+	uint8         data[OS_VNIC_FRAME_MAX];
+} OS_vnic_cell_t;
+
+/* One instance on the virtual segment, with the ring it receives on */
+typedef struct
+{
+	volatile LONG  owner;			/* process id of the instance, 0 if the node is free */
+	uint8          mac[6];
+	volatile LONG  enqueue_pos;
+	volatile LONG  dequeue_pos;		/* only changed by the owner */
+	volatile LONG  dropped;			/* frames lost because the ring was full or a slot was skipped */
+	volatile LONG  senders;			/* senders inside OS_Vnic_Enqueue, see OS_Vnic_Attach */
+	OS_vnic_cell_t cells[OS_FREERTOS_NET_SHM_RING_FRAMES];
+} OS_vnic_node_t;
+
+/* The shared memory section */
+typedef struct
+{
+	volatile LONG  magic;
+	uint32         version;
+	uint32         max_nodes;
+	uint32         ring_frames;
+	OS_vnic_node_t nodes[OS_FREERTOS_NET_SHM_MAX_NODES];
+} OS_vnic_shared_t;
+
+/****************************************************************************************
+ GLOBAL DATA
+ ***************************************************************************************/
+
+static HANDLE            OS_vnic_mapping = NULL;
+static OS_vnic_shared_t *OS_vnic_shared = NULL;
+static uint32            OS_vnic_self;
+static HANDLE            OS_vnic_events[OS_FREERTOS_NET_SHM_MAX_NODES];
+static HANDLE            OS_vnic_rx_thread = NULL;
+static TaskHandle_t      OS_vnic_rx_task = NULL;
+
+/****************************************************************************************
+ LOCAL FUNCTIONS
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Vnic_RingReset
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Empties the receive ring of a node
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Vnic_RingReset(OS_vnic_node_t *node)
+{
+	uint32 i;
+
+	for(i = 0; i < OS_FREERTOS_NET_SHM_RING_FRAMES; i++)
+	{
+		node->cells[i].sequence = (LONG) i;
+	}
+	node->enqueue_pos = 0;
+	node->dequeue_pos = 0;
+	node->dropped = 0;
+} /* end OS_Vnic_RingReset */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Vnic_OwnerAlive
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Whether the process that claimed a node is still running,
+ *           so the node of an instance that was killed can be reused.
+ *
+ *-----------------------------------------------------------------*/
+static bool OS_Vnic_OwnerAlive(LONG owner)
+{
+	HANDLE process;
+	bool alive;
+
+	if(owner == 0)
+	{
+		return false;
+	}
+
+	process = OpenProcess(SYNCHRONIZE, FALSE, (DWORD) owner);
+	if(process == NULL)
+	{
+		/* Access denied still means there is such a process */
+		return (GetLastError() == ERROR_ACCESS_DENIED);
+	}
+
+	alive = (WaitForSingleObject(process, 0) == WAIT_TIMEOUT);
+	CloseHandle(process);
+
+	return alive;
+} /* end OS_Vnic_OwnerAlive */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Vnic_Enqueue
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Copies a frame into the receive ring of a node and wakes it.
+ *           The frame is dropped, and counted, if the ring is full, or if
+ *           the receiver skipped the slot as stale before it was published.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Vnic_Enqueue(uint32 index, const uint8 *frame, uint32 length)
+{
+	OS_vnic_node_t *node = &OS_vnic_shared->nodes[index];
+	OS_vnic_cell_t *cell;
+	LONG pos;
+	LONG diff;
+
+	/* Counted before the owner is checked, so a node being reclaimed can wait for us */
+	InterlockedIncrement(&node->senders);
+	if(node->owner == 0)
+	{
+		InterlockedDecrement(&node->senders);
+		return;
+	}
+
+	pos = node->enqueue_pos;
+	while(1)
+	{
+		cell = &node->cells[(ULONG) pos % OS_FREERTOS_NET_SHM_RING_FRAMES];
+		diff = cell->sequence - pos;
+		if(diff == 0)
+		{
+			if(InterlockedCompareExchange(&node->enqueue_pos, pos + 1, pos) == pos)
+			{
+				break;
+			}
+			pos = node->enqueue_pos;
+		}
+		else if(diff < 0)
+		{
+			InterlockedIncrement(&node->dropped);
+			InterlockedDecrement(&node->senders);
+			return;
+		}
+		else
+		{
+			pos = node->enqueue_pos;
+		}
+	}
+
+	memcpy(cell->data, frame, length);
+	cell->length = length;
+
+	/*
+	 * Publishes the frame, the interlocked write orders it after the copy.
+	 * It fails if the receiver gave up on the slot in the meantime.
+	 */
+	if(InterlockedCompareExchange(&cell->sequence, pos + 1, pos) != pos)
+	{
+		InterlockedIncrement(&node->dropped);
+	}
+	InterlockedDecrement(&node->senders);
+
+	SetEvent(OS_vnic_events[index]);
+} /* end OS_Vnic_Enqueue */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Vnic_RingReady
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Whether the own receive ring holds a frame
+ *
+ *-----------------------------------------------------------------*/
+static bool OS_Vnic_RingReady(void)
+{
+	OS_vnic_node_t *node = &OS_vnic_shared->nodes[OS_vnic_self];
+	LONG pos = node->dequeue_pos;
+
+	return (node->cells[(ULONG) pos % OS_FREERTOS_NET_SHM_RING_FRAMES].sequence == pos + 1);
+} /* end OS_Vnic_RingReady */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Vnic_SkipStale
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Gives up on the head slot of the own ring, claimed by a sender
+ *           that never published it.  Returns false if the frame was
+ *           published after all, in which case it is taken as usual.
+ *
+ *-----------------------------------------------------------------*/
+static bool OS_Vnic_SkipStale(OS_vnic_node_t *node)
+{
+	LONG pos = node->dequeue_pos;
+	OS_vnic_cell_t *cell = &node->cells[(ULONG) pos % OS_FREERTOS_NET_SHM_RING_FRAMES];
+
+	if(InterlockedCompareExchange(&cell->sequence, pos + OS_FREERTOS_NET_SHM_RING_FRAMES, pos) != pos)
+	{
+		return false;
+	}
+
+	node->dequeue_pos = pos + 1;
+	InterlockedIncrement(&node->dropped);
+
+	return true;
+} /* end OS_Vnic_SkipStale */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Vnic_Interrupt
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Simulated interrupt raised by the receive thread, releases the
+ *           receive task.
+ *
+ *-----------------------------------------------------------------*/
+static uint32_t OS_Vnic_Interrupt(void)
+{
+	BaseType_t woken = pdFALSE;
+
+	vTaskNotifyGiveFromISR(OS_vnic_rx_task, &woken);
+
+	return (uint32_t)woken;
+} /* end OS_Vnic_Interrupt */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Vnic_RxThread
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Win32 thread, outside of FreeRTOS, that waits for the senders
+ *           to signal the own node and raises the simulated interrupt.
+ *           A FreeRTOS task must not wait on a Win32 event itself.
+ *
+ *-----------------------------------------------------------------*/
+static DWORD WINAPI OS_Vnic_RxThread(LPVOID unused)
+{
+	while(1)
+	{
+		WaitForSingleObject(OS_vnic_events[OS_vnic_self], INFINITE);
+		if(OS_Vnic_RingReady())
+		{
+			vPortGenerateSimulatedInterrupt(OS_FREERTOS_NET_SHM_INTERRUPT);
+		}
+	}
+
+	return 0;
+} /* end OS_Vnic_RxThread */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Vnic_RxTask
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Takes the frames off the own receive ring and hands them to
+ *           the IP task.
+ *
+ *-----------------------------------------------------------------*/
+static void OS_Vnic_RxTask(void *unused)
+{
+	OS_vnic_node_t *node = &OS_vnic_shared->nodes[OS_vnic_self];
+	OS_vnic_cell_t *cell;
+	NetworkBufferDescriptor_t *buffer;
+	IPStackEvent_t rx_event;
+	TickType_t wait;
+	LONG pos;
+
+	wait = portMAX_DELAY;
+	while(1)
+	{
+		/*
+		 ** A slot still claimed but unpublished after a whole wait of
+		 ** OS_VNIC_STALE_MSEC is skipped, the frames behind it go on.
+		 */
+		if(ulTaskNotifyTake(pdTRUE, wait) == 0 && wait != portMAX_DELAY &&
+				node->dequeue_pos != node->enqueue_pos && !OS_Vnic_RingReady())
+		{
+			OS_Vnic_SkipStale(node);
+		}
+
+		while(OS_Vnic_RingReady())
+		{
+			pos = node->dequeue_pos;
+			cell = &node->cells[(ULONG) pos % OS_FREERTOS_NET_SHM_RING_FRAMES];
+
+			buffer = pxGetNetworkBufferWithDescriptor(cell->length, 0);
+			if(buffer != NULL)
+			{
+				memcpy(buffer->pucEthernetBuffer, cell->data, cell->length);
+				buffer->xDataLength = cell->length;
+			}
+
+			/* Hands the slot back to the senders */
+			node->dequeue_pos = pos + 1;
+			InterlockedExchange(&cell->sequence, pos + OS_FREERTOS_NET_SHM_RING_FRAMES);
+
+			if(buffer == NULL)
+			{
+				iptraceETHERNET_RX_EVENT_LOST();
+				continue;
+			}
+
+			if(eConsiderFrameForProcessing(buffer->pucEthernetBuffer) != eProcessBuffer)
+			{
+				vReleaseNetworkBufferAndDescriptor(buffer);
+				continue;
+			}
+
+			rx_event.eEventType = eNetworkRxEvent;
+			rx_event.pvData = (void *) buffer;
+			if(xSendEventStructToIPTask(&rx_event, 0) == pdFAIL)
+			{
+				vReleaseNetworkBufferAndDescriptor(buffer);
+				iptraceETHERNET_RX_EVENT_LOST();
+			}
+			else
+			{
+				iptraceNETWORK_INTERFACE_RECEIVE();
+			}
+		}
+
+		/* Wake up again to check on a slot that is claimed but not published yet */
+		wait = (node->dequeue_pos != node->enqueue_pos) ? pdMS_TO_TICKS(OS_VNIC_STALE_MSEC) : portMAX_DELAY;
+	}
+} /* end OS_Vnic_RxTask */
+
+/*----------------------------------------------------------------
+ *
+ * Function: OS_Vnic_Attach
+ *
+ *  Purpose: Local helper routine, not part of OSAL API.
+ *           Maps the shared section, creating it for the first instance,
+ *           and claims a node for the own MAC address.  Serialized between
+ *           the instances by a named mutex.
+ *
+ *-----------------------------------------------------------------*/
+static bool OS_Vnic_Attach(const uint8 *mac)
+{
+	char name[sizeof(OS_FREERTOS_NET_SHM_NAME) + 16];
+	HANDLE lock;
+	OS_vnic_node_t *node;
+	bool created;
+	int32 free_node;
+	uint32 i;
+
+	snprintf(name, sizeof(name), "%s_lock", OS_FREERTOS_NET_SHM_NAME);
+	lock = CreateMutexA(NULL, FALSE, name);
+	if(lock == NULL)
+	{
+		return false;
+	}
+	WaitForSingleObject(lock, INFINITE);
+
+	OS_vnic_mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+			0, sizeof(OS_vnic_shared_t), OS_FREERTOS_NET_SHM_NAME);
+	created = (GetLastError() != ERROR_ALREADY_EXISTS);
+	if(OS_vnic_mapping != NULL)
+	{
+		OS_vnic_shared = (OS_vnic_shared_t *) MapViewOfFile(OS_vnic_mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(OS_vnic_shared_t));
+	}
+
+	free_node = -1;
+	if(OS_vnic_shared != NULL)
+	{
+		if(created || OS_vnic_shared->magic != OS_VNIC_MAGIC)
+		{
+			memset(OS_vnic_shared, 0, sizeof(OS_vnic_shared_t));
+			OS_vnic_shared->version = OS_VNIC_VERSION;
+			OS_vnic_shared->max_nodes = OS_FREERTOS_NET_SHM_MAX_NODES;
+			OS_vnic_shared->ring_frames = OS_FREERTOS_NET_SHM_RING_FRAMES;
+			OS_vnic_shared->magic = OS_VNIC_MAGIC;
+		}
+
+		/* Every instance has to be built with the same layout */
+		if(OS_vnic_shared->version != OS_VNIC_VERSION ||
+				OS_vnic_shared->max_nodes != OS_FREERTOS_NET_SHM_MAX_NODES ||
+				OS_vnic_shared->ring_frames != OS_FREERTOS_NET_SHM_RING_FRAMES)
+		{
+			OS_DEBUG("OS_Vnic_Attach: %s has another layout\n", OS_FREERTOS_NET_SHM_NAME);
+		}
+		else
+		{
+			for(i = 0; i < OS_FREERTOS_NET_SHM_MAX_NODES; i++)
+			{
+				node = &OS_vnic_shared->nodes[i];
+				if(!OS_Vnic_OwnerAlive(node->owner))
+				{
+					node->owner = 0;
+					if(free_node < 0)
+					{
+						free_node = (int32) i;
+					}
+				}
+				else if(memcmp(node->mac, mac, 6) == 0)
+				{
+					OS_printf("Virtual NIC: MAC address %02x:%02x:%02x:%02x:%02x:%02x already in use\n",
+							mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+					free_node = -1;
+					break;
+				}
+			}
+		}
+
+		if(free_node >= 0)
+		{
+			/*
+			 ** Senders of the other instances may still be in the ring of
+			 ** the previous owner.  Its owner is already 0, so no new one
+			 ** enters; wait for those inside to leave before the reset, but
+			 ** not forever, as one may have died in there.
+			 */
+			node = &OS_vnic_shared->nodes[free_node];
+			MemoryBarrier();
+			for(i = 0; node->senders > 0 && i < OS_VNIC_STALE_MSEC; i++)
+			{
+				Sleep(1);
+			}
+			node->senders = 0;
+			OS_Vnic_RingReset(node);
+			memcpy(node->mac, mac, 6);
+			node->owner = (LONG) GetCurrentProcessId();
+			OS_vnic_self = (uint32) free_node;
+		}
+	}
+
+	ReleaseMutex(lock);
+	CloseHandle(lock);
+
+	if(free_node < 0)
+	{
+		if(OS_vnic_shared != NULL)
+		{
+			UnmapViewOfFile(OS_vnic_shared);
+			OS_vnic_shared = NULL;
+		}
+		if(OS_vnic_mapping != NULL)
+		{
+			CloseHandle(OS_vnic_mapping);
+			OS_vnic_mapping = NULL;
+		}
+		return false;
+	}
+
+	/* The events of every node are opened once, whichever instance owns it later */
+	for(i = 0; i < OS_FREERTOS_NET_SHM_MAX_NODES; i++)
+	{
+		snprintf(name, sizeof(name), "%s_rx%u", OS_FREERTOS_NET_SHM_NAME, (unsigned int) i);
+		OS_vnic_events[i] = CreateEventA(NULL, FALSE, FALSE, name);
+		if(OS_vnic_events[i] == NULL)
+		{
+			return false;
+		}
+	}
+
+	return true;
+} /* end OS_Vnic_Attach */
+
+/****************************************************************************************
+ NETWORK INTERFACE
+ ***************************************************************************************/
+
+/*----------------------------------------------------------------
+ *
+ * Function: xNetworkInterfaceInitialise
+ *
+ *  Purpose: FreeRTOS+TCP network interface, called by the IP task
+ *
+ *-----------------------------------------------------------------*/
+BaseType_t xNetworkInterfaceInitialise(void)
+{
+	/* Called again whenever the IP task restarts the link, once is enough */
+	if(OS_vnic_rx_task != NULL)
+	{
+		return pdPASS;
+	}
+
+	if(!OS_Vnic_Attach(FreeRTOS_GetMACAddress()))
+	{
+		OS_printf("Virtual NIC: cannot attach to %s\n", OS_FREERTOS_NET_SHM_NAME);
+		return pdFAIL;
+	}
+
+	if(xTaskCreate(OS_Vnic_RxTask, "VNIC Rx", OS_VNIC_RX_TASK_STACK, NULL, OS_VNIC_RX_TASK_PRIO, &OS_vnic_rx_task) != pdPASS)
+	{
+		return pdFAIL;
+	}
+
+	vPortSetInterruptHandler(OS_FREERTOS_NET_SHM_INTERRUPT, OS_Vnic_Interrupt);
+
+	OS_vnic_rx_thread = CreateThread(NULL, 0, OS_Vnic_RxThread, NULL, 0, NULL);
+	if(OS_vnic_rx_thread == NULL)
+	{
+		return pdFAIL;
+	}
+	SetThreadPriority(OS_vnic_rx_thread, THREAD_PRIORITY_ABOVE_NORMAL);
+
+	OS_printf("Virtual NIC: node %u of %s\n", (unsigned int) OS_vnic_self, OS_FREERTOS_NET_SHM_NAME);
+
+	return pdPASS;
+} /* end xNetworkInterfaceInitialise */
+
+/*----------------------------------------------------------------
+ *
+ * Function: xNetworkInterfaceOutput
+ *
+ *  Purpose: FreeRTOS+TCP network interface, called by the IP task
+ *           Delivers the frame to the node with its destination MAC
+ *           address, or to every other node for broadcast and multicast,
+ *           as a switch that knows every port would.
+ *
+ *-----------------------------------------------------------------*/
+BaseType_t xNetworkInterfaceOutput(NetworkBufferDescriptor_t * const pxNetworkBuffer, BaseType_t bReleaseAfterSend)
+{
+	const uint8 *frame = pxNetworkBuffer->pucEthernetBuffer;
+	uint32 length = (uint32) pxNetworkBuffer->xDataLength;
+	OS_vnic_node_t *node;
+	uint32 i;
+
+	if(OS_vnic_shared != NULL && length <= OS_VNIC_FRAME_MAX)
+	{
+		for(i = 0; i < OS_FREERTOS_NET_SHM_MAX_NODES; i++)
+		{
+			node = &OS_vnic_shared->nodes[i];
+			if(i == OS_vnic_self || node->owner == 0)
+			{
+				continue;
+			}
+
+			if((frame[0] & 0x01) != 0 || memcmp(node->mac, frame, 6) == 0)
+			{
+				OS_Vnic_Enqueue(i, frame, length);
+			}
+		}
+
+		iptraceNETWORK_INTERFACE_TRANSMIT();
+	}
+
+	if(bReleaseAfterSend != pdFALSE)
+	{
+		vReleaseNetworkBufferAndDescriptor(pxNetworkBuffer);
+	}
+
+	return pdTRUE;
+} /* end xNetworkInterfaceOutput */
+
+#endif /* OS_FREERTOS_NET_SHM */
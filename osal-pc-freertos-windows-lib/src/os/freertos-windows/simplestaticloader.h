@@ -25,7 +25,28 @@ typedef struct
 	uint32 flags;
 } static_load_file_header_t;
 
+#define SIMPLE_STATIC_MAX_DEPENDS	4
+
+/*
+ * Optional startup table of simplestaticloader.inc, see OS_ModuleStartup.
+ * A .inc with a startup table defines SIMPLE_STATIC_STARTUP and
+ * known_startup[], one entry per module to start.
+ */
+typedef struct
+{
+	const char *module_name;	/* module path, as in known_symbols[] */
+	const char *init_symbol;	/* int32 (*)(void) of the module, OS_SUCCESS when started */
+	uint32 priority;			/* lower numbers are started first among the ready modules */
+	const char *depends_on[SIMPLE_STATIC_MAX_DEPENDS];	/* modules that have to be started before, NULL terminated */
+} static_startup_entry_t;
+
+void SimpleStaticLoaderInit(void);
 uint32 GetSymbolCount();
 unsigned char SimpleStaticLoadFile(char *translated_path, static_load_file_header_t *symbol_entry);
+void SimpleStaticUnloadFile(const char *module_name);
+unsigned char SimpleStaticLookupSymbol(const char *symbol_name, cpuaddr *symbol_address);
+unsigned char SimpleStaticGetSymbol(uint32 index, const char **symbol_name, cpuaddr *symbol_address);
+unsigned char SimpleStaticFindSymbol(const char *module_name, const char *symbol_name, cpuaddr *symbol_address);
+uint32 SimpleStaticGetStartup(const static_startup_entry_t **entries);
 
 #endif /* OSAL_CORE_SRC_OS_FREERTOS_WINDOWS_FREERTOS_SOURCE_SIMPLESTATICLOADER_H_ */
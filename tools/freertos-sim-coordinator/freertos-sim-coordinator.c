@@ -0,0 +1,374 @@
+/*
+ * Coordinator for multi-node FreeRTOS simulations.
+ *
+ * Every node is a FreeRTOS application built with configFREERTOS_RUN_AS_SIM
+ * and configFREERTOS_SIM_COORDINATED set to 1.  The nodes connect to the
+ * coordinator's named pipe, possibly from other hosts, and register with a
+ * SimSyncHello_t.  Once the expected number of nodes has registered the
+ * coordinator advances all of them in lockstep windows of simulated time: a
+ * window is only granted once every node has reached the end of the previous
+ * one, so no node ever runs ahead of another by more than one window.
+ *
+ * For each window the coordinator measures how long every node took, in host
+ * time, to reach the barrier, and reports the slowest node, which is the one
+ * that limits the whole simulation.
+ *
+ * Build with any Windows C compiler, for example
+ *     gcc -O2 -o freertos-sim-coordinator.exe freertos-sim-coordinator.c
+ *         -I ../../osal-pc-freertos-windows-lib/src/os/freertos-windows
+ *
+ * Usage:
+ *     freertos-sim-coordinator -n nodes [-w window ms] [-r report every]
+ *                              [-e end ms] [-p pipe name]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <windows.h>
+
+#include "freertos-sim-sync.h"
+
+#define COORDINATOR_PIPE_NAME     "\\\\.\\pipe\\freertos_sim_coordinator"
+#define COORDINATOR_MAX_NODES     MAXIMUM_WAIT_OBJECTS
+
+/* Pipe creation failures in a row, a second apart, before giving up */
+#define COORDINATOR_CREATE_RETRIES  10
+
+typedef enum {
+	eAcceptRegistered,
+	eAcceptRejected,		/* a client connected but did not register */
+	eAcceptFailed			/* the pipe could not be created */
+} AcceptResult_t;
+
+typedef struct {
+	HANDLE pipe;
+	HANDLE event;
+	OVERLAPPED overlapped;
+	SimSyncStatus_t status;
+	char name[sizeof(((SimSyncHello_t *) 0)->node_name)];
+	BOOL alive;
+	BOOL arrived;
+	LONGLONG arrival;		/* performance counter when the node reached the barrier */
+	uint32_t slowest_count;	/* windows the node was the last to arrive */
+	double total_ms;		/* host time spent running windows */
+} Node_t;
+
+static Node_t nodes[COORDINATOR_MAX_NODES];
+static uint32_t node_count = 0;
+static uint32_t alive_count = 0;
+static double counter_ms = 0.0;
+
+/*
+ * Synchronous transfer on an overlapped pipe, as in FreeRTOS.c.
+ */
+static BOOL prvTransfer(Node_t *pxNode, BOOL xWrite, void *pvBuffer, DWORD dwSize) {
+	OVERLAPPED xOverlapped;
+	DWORD dwTransferred;
+	BOOL xStarted;
+
+	memset(&xOverlapped, 0, sizeof(xOverlapped));
+	xOverlapped.hEvent = pxNode->event;
+
+	if (xWrite) {
+		xStarted = WriteFile(pxNode->pipe, pvBuffer, dwSize, NULL, &xOverlapped);
+	} else {
+		xStarted = ReadFile(pxNode->pipe, pvBuffer, dwSize, NULL, &xOverlapped);
+	}
+
+	if (!xStarted && GetLastError() != ERROR_IO_PENDING) {
+		return FALSE;
+	}
+
+	return GetOverlappedResult(pxNode->pipe, &xOverlapped, &dwTransferred, TRUE)
+			&& dwTransferred == dwSize;
+}
+
+static void prvDropNode(Node_t *pxNode, const char *pcReason) {
+	printf("Node %s dropped: %s\n", pxNode->name, pcReason);
+	CancelIo(pxNode->pipe);
+	CloseHandle(pxNode->pipe);
+	CloseHandle(pxNode->event);
+	pxNode->alive = FALSE;
+	alive_count--;
+}
+
+static void prvCloseNode(Node_t *pxNode) {
+	if (pxNode->pipe != INVALID_HANDLE_VALUE) {
+		CloseHandle(pxNode->pipe);
+		pxNode->pipe = INVALID_HANDLE_VALUE;
+	}
+	if (pxNode->event != NULL) {
+		CloseHandle(pxNode->event);
+		pxNode->event = NULL;
+	}
+}
+
+/*
+ * Wait for the next node to connect and read its registration.  Nothing
+ * of the node is left open unless it registered.
+ */
+static AcceptResult_t prvAcceptNode(const char *pcPipeName, Node_t *pxNode) {
+	SimSyncHello_t xHello;
+	OVERLAPPED xOverlapped;
+	DWORD dwTransferred;
+	BOOL xConnected;
+
+	/* Nodes may be on other hosts, so remote clients are accepted */
+	pxNode->pipe = CreateNamedPipeA(pcPipeName,
+			PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED,
+			PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_ACCEPT_REMOTE_CLIENTS,
+			PIPE_UNLIMITED_INSTANCES, 256, 256, 0, NULL);
+	pxNode->event = CreateEvent(NULL, TRUE, FALSE, NULL);
+	if (pxNode->pipe == INVALID_HANDLE_VALUE || pxNode->event == NULL) {
+		printf("Cannot create %s, error %lu\n", pcPipeName, GetLastError());
+		prvCloseNode(pxNode);
+		return eAcceptFailed;
+	}
+
+	memset(&xOverlapped, 0, sizeof(xOverlapped));
+	xOverlapped.hEvent = pxNode->event;
+	xConnected = ConnectNamedPipe(pxNode->pipe, &xOverlapped);
+	if (!xConnected) {
+		if (GetLastError() == ERROR_PIPE_CONNECTED) {
+			xConnected = TRUE;
+		} else if (GetLastError() == ERROR_IO_PENDING) {
+			xConnected = GetOverlappedResult(pxNode->pipe, &xOverlapped, &dwTransferred, TRUE);
+		}
+	}
+
+	if (!xConnected || !prvTransfer(pxNode, FALSE, &xHello, sizeof(xHello))
+			|| xHello.magic != SIM_SYNC_HELLO_MAGIC || xHello.version != SIM_SYNC_VERSION) {
+		printf("Rejected a node that did not register\n");
+		CancelIo(pxNode->pipe);
+		prvCloseNode(pxNode);
+		return eAcceptRejected;
+	}
+
+	xHello.node_name[sizeof(xHello.node_name) - 1] = '\0';
+	strcpy(pxNode->name, xHello.node_name);
+	pxNode->alive = TRUE;
+
+	printf("Node %u registered: %s, period %lu ms, warm up %lu ms\n",
+			(unsigned int) node_count, pxNode->name,
+			(unsigned long) xHello.sync_period_ms, (unsigned long) xHello.warmup_ms);
+
+	return eAcceptRegistered;
+}
+
+static BOOL prvStartRead(Node_t *pxNode) {
+	memset(&pxNode->overlapped, 0, sizeof(pxNode->overlapped));
+	pxNode->overlapped.hEvent = pxNode->event;
+	ResetEvent(pxNode->event);
+
+	return ReadFile(pxNode->pipe, &pxNode->status, sizeof(pxNode->status), NULL, &pxNode->overlapped)
+			|| GetLastError() == ERROR_IO_PENDING;
+}
+
+/*
+ * Wait until every node has reached the barrier, that is sent a status
+ * asking for a grant.  Streamed statuses on the way are skipped.  Returns
+ * the highest execution time reported.
+ */
+static uint32_t prvBarrier(void) {
+	HANDLE xEvents[COORDINATOR_MAX_NODES];
+	uint32_t ulIndex[COORDINATOR_MAX_NODES];
+	uint32_t ulPending = 0;
+	uint32_t ulHighest = 0;
+	LARGE_INTEGER xNow;
+	DWORD dwTransferred;
+	DWORD dwWait;
+	Node_t *pxNode;
+	uint32_t i;
+
+	for (i = 0; i < node_count; i++) {
+		nodes[i].arrived = FALSE;
+		if (nodes[i].alive && !prvStartRead(&nodes[i])) {
+			prvDropNode(&nodes[i], "read failed");
+		}
+	}
+
+	while (1) {
+		ulPending = 0;
+		for (i = 0; i < node_count; i++) {
+			if (nodes[i].alive && !nodes[i].arrived) {
+				xEvents[ulPending] = nodes[i].event;
+				ulIndex[ulPending++] = i;
+			}
+		}
+		if (ulPending == 0) {
+			break;
+		}
+
+		dwWait = WaitForMultipleObjects(ulPending, xEvents, FALSE, INFINITE);
+		QueryPerformanceCounter(&xNow);
+		if (dwWait >= WAIT_OBJECT_0 + ulPending) {
+			printf("Wait failed, error %lu\n", GetLastError());
+			exit(EXIT_FAILURE);
+		}
+
+		pxNode = &nodes[ulIndex[dwWait - WAIT_OBJECT_0]];
+		if (!GetOverlappedResult(pxNode->pipe, &pxNode->overlapped, &dwTransferred, FALSE)
+				|| dwTransferred != sizeof(pxNode->status)) {
+			prvDropNode(pxNode, "disconnected");
+			continue;
+		}
+		if (pxNode->status.magic != SIM_SYNC_MAGIC || pxNode->status.version != SIM_SYNC_VERSION) {
+			prvDropNode(pxNode, "bad status");
+			continue;
+		}
+
+		if ((pxNode->status.flags & SIM_SYNC_STATUS_WAITING) == 0) {
+			if (!prvStartRead(pxNode)) {
+				prvDropNode(pxNode, "read failed");
+			}
+			continue;
+		}
+
+		pxNode->arrived = TRUE;
+		pxNode->arrival = xNow.QuadPart;
+		if (pxNode->status.execution_ms > ulHighest) {
+			ulHighest = pxNode->status.execution_ms;
+		}
+	}
+
+	return ulHighest;
+}
+
+int main(int argc, char *argv[]) {
+	const char *pcPipeName = COORDINATOR_PIPE_NAME;
+	uint32_t ulExpected = 0;
+	uint32_t ulWindowMs = 10;
+	uint32_t ulReportEvery = 100;
+	uint32_t ulEndMs = 0;
+	uint32_t ulUntilMs;
+	uint32_t ulWindow;
+	uint32_t ulSlowest;
+	double dSlowestMs;
+	double dTotalSlowestMs = 0.0;
+	LARGE_INTEGER xFrequency;
+	LARGE_INTEGER xReleased;
+	SimSyncGrant_t xGrant;
+	AcceptResult_t xAccepted;
+	uint32_t ulCreateFailures = 0;
+	double dMs;
+	int i;
+
+	for (i = 1; i + 1 < argc; i += 2) {
+		if (strcmp(argv[i], "-n") == 0) {
+			ulExpected = (uint32_t) atoi(argv[i + 1]);
+		} else if (strcmp(argv[i], "-w") == 0) {
+			ulWindowMs = (uint32_t) atoi(argv[i + 1]);
+		} else if (strcmp(argv[i], "-r") == 0) {
+			ulReportEvery = (uint32_t) atoi(argv[i + 1]);
+		} else if (strcmp(argv[i], "-e") == 0) {
+			ulEndMs = (uint32_t) atoi(argv[i + 1]);
+		} else if (strcmp(argv[i], "-p") == 0) {
+			pcPipeName = argv[i + 1];
+		} else {
+			break;
+		}
+	}
+	if (i != argc || ulExpected == 0 || ulExpected > COORDINATOR_MAX_NODES || ulWindowMs == 0) {
+		fprintf(stderr, "Usage: %s -n nodes (1 to %u) [-w window ms] [-r report every] [-e end ms] [-p pipe name]\n",
+				argv[0], (unsigned int) COORDINATOR_MAX_NODES);
+		return EXIT_FAILURE;
+	}
+
+	QueryPerformanceFrequency(&xFrequency);
+	counter_ms = 1000.0 / (double) xFrequency.QuadPart;
+
+	printf("Waiting for %u nodes on %s\n", (unsigned int) ulExpected, pcPipeName);
+	while (node_count < ulExpected) {
+		xAccepted = prvAcceptNode(pcPipeName, &nodes[node_count]);
+		if (xAccepted == eAcceptRegistered) {
+			node_count++;
+			alive_count++;
+		}
+
+		/* A bad pipe name or a lack of resources does not go away by itself */
+		if (xAccepted != eAcceptFailed) {
+			ulCreateFailures = 0;
+		} else if (++ulCreateFailures >= COORDINATOR_CREATE_RETRIES) {
+			printf("Giving up on %s\n", pcPipeName);
+			return EXIT_FAILURE;
+		} else {
+			Sleep(1000);
+		}
+	}
+
+	/* The nodes start syncing after their warm up, the first window starts from the latest */
+	ulUntilMs = prvBarrier();
+	QueryPerformanceCounter(&xReleased);
+
+	for (ulWindow = 0; alive_count > 0; ulWindow++) {
+		if (ulEndMs != 0 && ulUntilMs >= ulEndMs) {
+			break;
+		}
+		ulUntilMs += ulWindowMs;
+
+		/* Every node gets the same window and sync period */
+		memset(&xGrant, 0, sizeof(xGrant));
+		xGrant.magic = SIM_SYNC_MAGIC;
+		xGrant.version = SIM_SYNC_VERSION;
+		xGrant.grant_until_ms = ulUntilMs;
+		xGrant.report_every = 0;
+		xGrant.sync_period_ms = ulWindowMs;
+
+		QueryPerformanceCounter(&xReleased);
+		for (i = 0; i < (int) node_count; i++) {
+			if (nodes[i].alive) {
+				xGrant.sequence = nodes[i].status.sequence;
+				if (!prvTransfer(&nodes[i], TRUE, &xGrant, sizeof(xGrant))) {
+					prvDropNode(&nodes[i], "grant failed");
+				}
+			}
+		}
+
+		prvBarrier();
+		if (alive_count == 0) {
+			break;
+		}
+
+		/* The last node to arrive held up the window */
+		ulSlowest = 0;
+		dSlowestMs = -1.0;
+		for (i = 0; i < (int) node_count; i++) {
+			if (nodes[i].alive) {
+				dMs = (double) (nodes[i].arrival - xReleased.QuadPart) * counter_ms;
+				nodes[i].total_ms += dMs;
+				if (dMs > dSlowestMs) {
+					dSlowestMs = dMs;
+					ulSlowest = (uint32_t) i;
+				}
+			}
+		}
+		nodes[ulSlowest].slowest_count++;
+		dTotalSlowestMs += dSlowestMs;
+
+		if (ulReportEvery != 0 && (ulWindow % ulReportEvery) == 0) {
+			printf("Window %lu, to %lu ms: slowest %s, %.3f ms\n",
+					(unsigned long) ulWindow, (unsigned long) ulUntilMs,
+					nodes[ulSlowest].name, dSlowestMs);
+		}
+	}
+
+	printf("%lu windows of %lu ms, %.3f ms of host time per window\n",
+			(unsigned long) ulWindow, (unsigned long) ulWindowMs,
+			(ulWindow > 0) ? dTotalSlowestMs / ulWindow : 0.0);
+	for (i = 0; i < (int) node_count; i++) {
+		printf("  %-32s slowest in %lu windows, %.3f ms per window%s\n",
+				nodes[i].name, (unsigned long) nodes[i].slowest_count,
+				(ulWindow > 0) ? nodes[i].total_ms / ulWindow : 0.0,
+				nodes[i].alive ? "" : " (dropped)");
+	}
+
+	/* The nodes run on unsynchronized once their pipes close */
+	for (i = 0; i < (int) node_count; i++) {
+		if (nodes[i].alive) {
+			CloseHandle(nodes[i].pipe);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}